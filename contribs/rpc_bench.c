@@ -0,0 +1,374 @@
+/*****************************************************************************\
+ *  This program generates a configurable mix of RPCs against slurmctld from
+ *  many concurrent client threads and reports the throughput and latency
+ *  percentiles observed for each RPC type. It is intended to be run against
+ *  a test controller (e.g. with front-end or multiple-slurmd nodes) to catch
+ *  performance regressions in the controller before an upgrade.
+ *
+ *  Usage: rpc_bench [-t threads] [-d seconds] [-m op[,op...]]
+ *  where op is one of: ping, jobs, nodes, parts, submit, sacct, assocs
+ *  The "submit" operation submits a held job and cancels it again.
+ *  The "sacct" and "assocs" operations query slurmdbd for the last day of
+ *  jobs and for all associations, as sacct and sshare style tools do.
+ *
+ *  Run "sdiag -r" before and "sdiag" after a run to see the controller's
+ *  view of the same load (RPC times, server thread counts, agent queue).
+ *
+ *  Build with "gcc -o rpc_bench rpc_bench.c -lslurm -lpthread", adding
+ *  -I and -L options for the Slurm installation as needed.
+ *****************************************************************************
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <slurm/slurm.h>
+#include <slurm/slurm_errno.h>
+#include <slurm/slurmdb.h>
+
+enum {
+	OP_PING,
+	OP_JOBS,
+	OP_NODES,
+	OP_PARTS,
+	OP_SUBMIT,
+	OP_SACCT,
+	OP_ASSOCS,
+	OP_CNT
+};
+
+static const char *op_names[OP_CNT] = {
+	"ping", "jobs", "nodes", "parts", "submit", "sacct", "assocs"
+};
+
+/* Latencies of one operation type, in usec */
+typedef struct {
+	long *lat;
+	int cnt;
+	int size;
+	int errors;
+} op_stats_t;
+
+typedef struct {
+	pthread_t tid;
+	int id;
+	void *db_conn;		/* slurmdbd connection of this thread */
+	op_stats_t stats[OP_CNT];
+} thread_info_t;
+
+static int op_list[OP_CNT];
+static int op_list_cnt = 0;
+static int duration = 10;
+static int thread_cnt = 8;
+static struct timeval end_time;
+
+static long _tv_diff(struct timeval *start, struct timeval *end)
+{
+	return ((end->tv_sec - start->tv_sec) * 1000000L) +
+		(end->tv_usec - start->tv_usec);
+}
+
+static void _add_sample(op_stats_t *stats, long usec, int rc)
+{
+	if (rc != SLURM_SUCCESS) {
+		stats->errors++;
+		return;
+	}
+	if (stats->cnt >= stats->size) {
+		stats->size = stats->size ? (stats->size * 2) : 1024;
+		stats->lat = realloc(stats->lat, sizeof(long) * stats->size);
+		if (!stats->lat) {
+			perror("realloc");
+			exit(1);
+		}
+	}
+	stats->lat[stats->cnt++] = usec;
+}
+
+static int _submit_held_job(void)
+{
+	job_desc_msg_t desc;
+	submit_response_msg_t *resp = NULL;
+	char *env[] = { "PATH=/bin:/usr/bin", NULL };
+	int rc;
+
+	slurm_init_job_desc_msg(&desc);
+	desc.name = "rpc_bench";
+	desc.script = "#!/bin/sh\ntrue\n";
+	desc.environment = env;
+	desc.env_size = 1;
+	desc.min_nodes = 1;
+	desc.priority = 0;	/* held */
+	desc.time_limit = 1;
+	desc.user_id = getuid();
+	desc.group_id = getgid();
+	desc.work_dir = "/tmp";
+	desc.std_out = "/dev/null";
+
+	if ((rc = slurm_submit_batch_job(&desc, &resp)) != SLURM_SUCCESS)
+		return rc;
+	(void) slurm_kill_job(resp->job_id, SIGKILL, 0);
+	slurm_free_submit_response_response_msg(resp);
+
+	return SLURM_SUCCESS;
+}
+
+static int _query_dbd(thread_info_t *info, int op)
+{
+	slurmdb_job_cond_t job_cond;
+	slurmdb_assoc_cond_t assoc_cond;
+	List list = NULL;
+
+	if (!info->db_conn && !(info->db_conn = slurmdb_connection_get()))
+		return SLURM_ERROR;
+
+	if (op == OP_SACCT) {
+		memset(&job_cond, 0, sizeof(job_cond));
+		job_cond.usage_start = time(NULL) - (24 * 60 * 60);
+		job_cond.usage_end = time(NULL);
+		list = slurmdb_jobs_get(info->db_conn, &job_cond);
+	} else {
+		memset(&assoc_cond, 0, sizeof(assoc_cond));
+		list = slurmdb_associations_get(info->db_conn, &assoc_cond);
+	}
+	if (!list)
+		return SLURM_ERROR;
+	slurm_list_destroy(list);
+
+	return SLURM_SUCCESS;
+}
+
+static int _run_op(thread_info_t *info, int op)
+{
+	job_info_msg_t *jobs = NULL;
+	node_info_msg_t *nodes = NULL;
+	partition_info_msg_t *parts = NULL;
+	int rc = SLURM_ERROR;
+
+	switch (op) {
+	case OP_PING:
+		rc = slurm_ping(0);
+		break;
+	case OP_JOBS:
+		if ((rc = slurm_load_jobs(0, &jobs, SHOW_ALL)) ==
+		    SLURM_SUCCESS)
+			slurm_free_job_info_msg(jobs);
+		break;
+	case OP_NODES:
+		if ((rc = slurm_load_node(0, &nodes, SHOW_ALL)) ==
+		    SLURM_SUCCESS)
+			slurm_free_node_info_msg(nodes);
+		break;
+	case OP_PARTS:
+		if ((rc = slurm_load_partitions(0, &parts, SHOW_ALL)) ==
+		    SLURM_SUCCESS)
+			slurm_free_partition_info_msg(parts);
+		break;
+	case OP_SUBMIT:
+		rc = _submit_held_job();
+		break;
+	case OP_SACCT:
+	case OP_ASSOCS:
+		rc = _query_dbd(info, op);
+		break;
+	}
+
+	return rc;
+}
+
+static void *_client(void *arg)
+{
+	thread_info_t *info = arg;
+	struct timeval t1, t2;
+	int i = info->id, op, rc;
+
+	while (1) {
+		op = op_list[i++ % op_list_cnt];
+		gettimeofday(&t1, NULL);
+		if (_tv_diff(&t1, &end_time) <= 0)
+			break;
+		rc = _run_op(info, op);
+		gettimeofday(&t2, NULL);
+		_add_sample(&info->stats[op], _tv_diff(&t1, &t2), rc);
+	}
+	if (info->db_conn)
+		slurmdb_connection_close(&info->db_conn);
+
+	return NULL;
+}
+
+static int _cmp_long(const void *a, const void *b)
+{
+	long x = *(const long *) a, y = *(const long *) b;
+
+	return (x > y) - (x < y);
+}
+
+static double _percentile_msec(op_stats_t *stats, double pct)
+{
+	int i;
+
+	if (!stats->cnt)
+		return 0.0;
+	i = (int) (pct / 100.0 * (stats->cnt - 1) + 0.5);
+	return stats->lat[i] / 1000.0;
+}
+
+static void _report(thread_info_t *threads, double elapsed)
+{
+	op_stats_t total;
+	int op, t;
+
+	printf("%-8s %10s %10s %8s %9s %9s %9s %9s\n", "op", "count",
+	       "per_sec", "errors", "p50_ms", "p90_ms", "p99_ms", "max_ms");
+
+	for (op = 0; op < OP_CNT; op++) {
+		memset(&total, 0, sizeof(total));
+		for (t = 0; t < thread_cnt; t++) {
+			op_stats_t *stats = &threads[t].stats[op];
+			int i;
+
+			total.errors += stats->errors;
+			for (i = 0; i < stats->cnt; i++)
+				_add_sample(&total, stats->lat[i],
+					    SLURM_SUCCESS);
+		}
+		if (!total.cnt && !total.errors)
+			continue;
+
+		qsort(total.lat, total.cnt, sizeof(long), _cmp_long);
+		printf("%-8s %10d %10.1f %8d %9.2f %9.2f %9.2f %9.2f\n",
+		       op_names[op], total.cnt, total.cnt / elapsed,
+		       total.errors, _percentile_msec(&total, 50),
+		       _percentile_msec(&total, 90),
+		       _percentile_msec(&total, 99),
+		       _percentile_msec(&total, 100));
+		free(total.lat);
+	}
+}
+
+static void _parse_ops(char *arg)
+{
+	char *tok, *save_ptr = NULL;
+	int op;
+
+	op_list_cnt = 0;
+	for (tok = strtok_r(arg, ",", &save_ptr); tok;
+	     tok = strtok_r(NULL, ",", &save_ptr)) {
+		for (op = 0; op < OP_CNT; op++) {
+			if (!strcmp(tok, op_names[op]))
+				break;
+		}
+		if (op == OP_CNT) {
+			fprintf(stderr, "Invalid operation: %s\n", tok);
+			exit(1);
+		}
+		if (op_list_cnt < OP_CNT)
+			op_list[op_list_cnt++] = op;
+	}
+}
+
+static void _usage(void)
+{
+	fprintf(stderr, "Usage: rpc_bench [-t threads] [-d seconds] "
+		"[-m op[,op...]]\n"
+		"  op: ping, jobs, nodes, parts, submit, sacct, assocs "
+		"(default: ping,jobs,nodes,parts)\n");
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	thread_info_t *threads;
+	struct timeval start_time, now;
+	int c, t;
+
+	op_list[op_list_cnt++] = OP_PING;
+	op_list[op_list_cnt++] = OP_JOBS;
+	op_list[op_list_cnt++] = OP_NODES;
+	op_list[op_list_cnt++] = OP_PARTS;
+
+	while ((c = getopt(argc, argv, "d:m:t:")) != -1) {
+		switch (c) {
+		case 'd':
+			duration = atoi(optarg);
+			break;
+		case 'm':
+			_parse_ops(optarg);
+			break;
+		case 't':
+			thread_cnt = atoi(optarg);
+			break;
+		default:
+			_usage();
+		}
+	}
+	if ((duration < 1) || (thread_cnt < 1) || (op_list_cnt < 1))
+		_usage();
+
+	threads = calloc(thread_cnt, sizeof(thread_info_t));
+	if (!threads) {
+		perror("calloc");
+		exit(1);
+	}
+
+	printf("Running %d client threads for %d seconds\n",
+	       thread_cnt, duration);
+	gettimeofday(&start_time, NULL);
+	end_time = start_time;
+	end_time.tv_sec += duration;
+	for (t = 0; t < thread_cnt; t++) {
+		threads[t].id = t;
+		if (pthread_create(&threads[t].tid, NULL, _client,
+				   &threads[t])) {
+			perror("pthread_create");
+			exit(1);
+		}
+	}
+	for (t = 0; t < thread_cnt; t++)
+		pthread_join(threads[t].tid, NULL);
+	gettimeofday(&now, NULL);
+
+	_report(threads, _tv_diff(&start_time, &now) / 1000000.0);
+
+	for (t = 0; t < thread_cnt; t++) {
+		for (c = 0; c < OP_CNT; c++)
+			free(threads[t].stats[c].lat);
+	}
+	free(threads);
+
+	return 0;
+}
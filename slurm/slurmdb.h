@@ -585,6 +585,9 @@ struct slurmdb_assoc_usage {
 	uint64_t *grp_used_tres_run_secs; /* array of running tres secs
 					   * (DON'T PACK for state file) */
 
+	bool grp_tres_unlimited; /* no GrpTRES, GrpTRESMins or GrpTRESRunMins
+				  * limit is set on the association
+				  * set in slurmctld (DON'T PACK) */
 	double grp_used_wall;   /* group count of time used in running jobs */
 	double fs_factor;	/* Fairshare factor. Not used by all algorithms
 				 * (DON'T PACK for state file) */
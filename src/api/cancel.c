@@ -176,3 +176,52 @@ extern int slurm_kill_job_msg(uint16_t msg_type, job_step_kill_msg_t *kill_msg)
 
 	return SLURM_SUCCESS;
 }
+
+/*
+ * slurm_kill_jobs - send the same signal to many jobs in a single RPC
+ *
+ * IN kill_msg - jobs to signal, and the signal and KILL_* flags to use
+ * OUT resp - result code for each job, in the order of kill_msg->jobs_array
+ * RET SLURM_SUCCESS if the request was processed, otherwise return
+ *     SLURM_ERROR with errno set
+ */
+extern int slurm_kill_jobs(kill_jobs_msg_t *kill_msg,
+			   kill_jobs_resp_msg_t **resp)
+{
+	int rc = SLURM_SUCCESS;
+	slurm_msg_t req_msg, resp_msg;
+
+	slurm_msg_t_init(&req_msg);
+	slurm_msg_t_init(&resp_msg);
+
+	req_msg.msg_type = REQUEST_KILL_JOBS;
+	req_msg.data     = kill_msg;
+
+	if (slurm_send_recv_controller_msg(&req_msg, &resp_msg,
+					   working_cluster_rec) < 0)
+		return SLURM_ERROR;
+
+	switch (resp_msg.msg_type) {
+	case RESPONSE_KILL_JOBS:
+		*resp = (kill_jobs_resp_msg_t *) resp_msg.data;
+		if ((*resp)->jobs_cnt != kill_msg->jobs_cnt) {
+			slurm_free_kill_jobs_response_msg(*resp);
+			*resp = NULL;
+			slurm_seterrno(SLURM_UNEXPECTED_MSG_ERROR);
+			rc = SLURM_ERROR;
+		}
+		break;
+	case RESPONSE_SLURM_RC:
+		rc = ((return_code_msg_t *) resp_msg.data)->return_code;
+		slurm_free_return_code_msg(resp_msg.data);
+		if (rc)
+			slurm_seterrno_ret(rc);
+		/* A bare success is not a valid answer to this request */
+		slurm_seterrno_ret(SLURM_UNEXPECTED_MSG_ERROR);
+	default:
+		slurm_free_msg_data(resp_msg.msg_type, resp_msg.data);
+		slurm_seterrno_ret(SLURM_UNEXPECTED_MSG_ERROR);
+	}
+
+	return rc;
+}
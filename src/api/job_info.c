@@ -1398,6 +1398,230 @@ extern int slurm_load_job_user (job_info_msg_t **job_info_msg_pptr,
 	return rc;
 }
 
+/*
+ * slurm_load_job_list - issue RPC to get slurm information about specific
+ *	jobs, including the tasks of job arrays and the components of
+ *	heterogeneous jobs identified by those IDs
+ * IN/OUT job_info_msg_pptr - place to store a job configuration pointer
+ * IN job_ids - array of job IDs we want information for
+ * IN job_id_cnt - number of entries in job_ids, must be greater than zero
+ * IN show_flags - job filtering options
+ * RET 0 or -1 on error
+ * NOTE: free the response using slurm_free_job_info_msg
+ */
+extern int slurm_load_job_list(job_info_msg_t **job_info_msg_pptr,
+			       uint32_t *job_ids, int job_id_cnt,
+			       uint16_t show_flags)
+{
+	slurm_msg_t req_msg;
+	job_info_request_msg_t req;
+	char *cluster_name = NULL;
+	void *ptr = NULL;
+	slurmdb_federation_rec_t *fed;
+	uint32_t *job_id_ptr;
+	int i, rc;
+
+	if (!job_ids || (job_id_cnt <= 0)) {
+		slurm_seterrno(EINVAL);
+		return SLURM_ERROR;
+	}
+
+	if (working_cluster_rec)
+		cluster_name = xstrdup(working_cluster_rec->name);
+	else
+		cluster_name = slurm_get_cluster_name();
+	if ((show_flags & SHOW_FEDERATION) && !(show_flags & SHOW_LOCAL) &&
+	    (slurm_load_federation(&ptr) == SLURM_SUCCESS) &&
+	    cluster_in_federation(ptr, cluster_name)) {
+		/* In federation. Need info from all clusters */
+		show_flags &= (~SHOW_LOCAL);
+	} else {
+		/* Report local cluster info only */
+		show_flags |= SHOW_LOCAL;
+		show_flags &= (~SHOW_FEDERATION);
+	}
+
+	slurm_msg_t_init(&req_msg);
+	memset(&req, 0, sizeof(req));
+	req.show_flags   = show_flags;
+	req.job_ids      = list_create(xfree_ptr);
+	for (i = 0; i < job_id_cnt; i++) {
+		job_id_ptr = xmalloc(sizeof(uint32_t));
+		*job_id_ptr = job_ids[i];
+		list_append(req.job_ids, job_id_ptr);
+	}
+	req_msg.msg_type = REQUEST_JOB_INFO;
+	req_msg.data     = &req;
+
+	if (show_flags & SHOW_FEDERATION) {
+		fed = (slurmdb_federation_rec_t *) ptr;
+		rc = _load_fed_jobs(&req_msg, job_info_msg_pptr, show_flags,
+				    cluster_name, fed);
+	} else {
+		rc = _load_cluster_jobs(&req_msg, job_info_msg_pptr,
+					working_cluster_rec);
+	}
+
+	FREE_NULL_LIST(req.job_ids);
+	if (ptr)
+		slurm_destroy_federation_rec(ptr);
+	xfree(cluster_name);
+
+	return rc;
+}
+
+/*
+ * slurm_load_jobs_delta - issue RPC to get information about jobs which
+ *	changed or were purged since a prior call
+ * IN epoch - epoch from the prior response or 0
+ * IN seq - sequence number from the prior response or 0 to load all jobs
+ * IN show_flags - job filtering options
+ * OUT delta_pptr - place to store the response
+ * RET 0 or -1 on error
+ * NOTE: free the response using slurm_free_job_info_delta_msg
+ */
+extern int slurm_load_jobs_delta(time_t epoch, uint64_t seq,
+				 uint16_t show_flags,
+				 job_info_delta_msg_t **delta_pptr)
+{
+	slurm_msg_t req_msg, resp_msg;
+	job_info_delta_request_msg_t req;
+	int rc = SLURM_SUCCESS;
+
+	*delta_pptr = NULL;
+
+	slurm_msg_t_init(&req_msg);
+	slurm_msg_t_init(&resp_msg);
+	memset(&req, 0, sizeof(req));
+	req.epoch        = epoch;
+	req.seq          = seq;
+	req.show_flags   = show_flags | SHOW_LOCAL;
+	req_msg.msg_type = REQUEST_JOB_INFO_DELTA;
+	req_msg.data     = &req;
+
+	if (slurm_send_recv_controller_msg(&req_msg, &resp_msg,
+					   working_cluster_rec) < 0)
+		return SLURM_ERROR;
+
+	switch (resp_msg.msg_type) {
+	case RESPONSE_JOB_INFO_DELTA:
+		*delta_pptr = (job_info_delta_msg_t *) resp_msg.data;
+		resp_msg.data = NULL;
+		break;
+	case RESPONSE_SLURM_RC:
+		rc = ((return_code_msg_t *) resp_msg.data)->return_code;
+		slurm_free_return_code_msg(resp_msg.data);
+		break;
+	default:
+		rc = SLURM_UNEXPECTED_MSG_ERROR;
+		break;
+	}
+	if (rc) {
+		slurm_seterrno(rc);
+		return SLURM_ERROR;
+	}
+
+	return SLURM_SUCCESS;
+}
+
+static int _cmp_job_info_id(const void *x, const void *y)
+{
+	const slurm_job_info_t *job1 = x, *job2 = y;
+
+	if (job1->job_id < job2->job_id)
+		return -1;
+	return (job1->job_id > job2->job_id);
+}
+
+static int _cmp_uint32(const void *x, const void *y)
+{
+	uint32_t a = *(const uint32_t *) x, b = *(const uint32_t *) y;
+
+	if (a < b)
+		return -1;
+	return (a > b);
+}
+
+/*
+ * slurm_job_info_apply_delta - update a local copy of the job table with
+ *	a response from slurm_load_jobs_delta()
+ * IN/OUT job_info_msg_pptr - local copy of job information, may point to
+ *	NULL initially. Records are kept sorted by job ID.
+ * IN/OUT delta - changes to apply, job records are moved out of this message
+ * RET SLURM_SUCCESS or SLURM_ERROR
+ */
+extern int slurm_job_info_apply_delta(job_info_msg_t **job_info_msg_pptr,
+				      job_info_delta_msg_t *delta)
+{
+	job_info_msg_t *old_msg, *new_msg;
+	slurm_job_info_t *merged;
+	uint32_t i = 0, j = 0, r = 0, cnt = 0;
+
+	if (!job_info_msg_pptr || !delta || !delta->jobs) {
+		slurm_seterrno(EINVAL);
+		return SLURM_ERROR;
+	}
+
+	new_msg = delta->jobs;
+	qsort(new_msg->job_array, new_msg->record_count,
+	      sizeof(slurm_job_info_t), _cmp_job_info_id);
+
+	if (delta->full || !*job_info_msg_pptr) {
+		slurm_free_job_info_msg(*job_info_msg_pptr);
+		*job_info_msg_pptr = new_msg;
+		delta->jobs = NULL;
+		return SLURM_SUCCESS;
+	}
+
+	old_msg = *job_info_msg_pptr;
+	qsort(delta->removed_ids, delta->removed_cnt, sizeof(uint32_t),
+	      _cmp_uint32);
+	merged = xcalloc(old_msg->record_count + new_msg->record_count,
+			 sizeof(slurm_job_info_t));
+
+	/* Both arrays are sorted by job ID, merge them */
+	while ((i < old_msg->record_count) || (j < new_msg->record_count)) {
+		slurm_job_info_t *old_job = NULL, *new_job = NULL;
+
+		if (i < old_msg->record_count)
+			old_job = &old_msg->job_array[i];
+		if (j < new_msg->record_count)
+			new_job = &new_msg->job_array[j];
+
+		if (new_job &&
+		    (!old_job || (new_job->job_id <= old_job->job_id))) {
+			if (old_job && (new_job->job_id == old_job->job_id)) {
+				slurm_free_job_info_members(old_job);
+				i++;
+			}
+			merged[cnt++] = *new_job;
+			j++;
+			continue;
+		}
+
+		while ((r < delta->removed_cnt) &&
+		       (delta->removed_ids[r] < old_job->job_id))
+			r++;
+		if ((r < delta->removed_cnt) &&
+		    (delta->removed_ids[r] == old_job->job_id))
+			slurm_free_job_info_members(old_job);
+		else
+			merged[cnt++] = *old_job;
+		i++;
+	}
+
+	xfree(old_msg->job_array);
+	old_msg->job_array = merged;
+	old_msg->record_count = cnt;
+	old_msg->last_update = new_msg->last_update;
+
+	/* Job records are now owned by *job_info_msg_pptr */
+	xfree(new_msg->job_array);
+	new_msg->record_count = 0;
+
+	return SLURM_SUCCESS;
+}
+
 /*
  * slurm_load_job - issue RPC to get job information for one job ID
  * IN job_info_msg_pptr - place to store a job configuration pointer
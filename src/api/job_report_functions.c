@@ -184,7 +184,11 @@ static List _process_grouped_report(
 		tmp_acct_list = job_cond->acct_list;
 		job_cond->acct_list = NULL;
 	}
-	job_cond->flags |= JOBCOND_FLAG_DUP;
+	/*
+	 * Only job records are grouped, so don't make the storage plugin run
+	 * a step query for every job in the period.
+	 */
+	job_cond->flags |= JOBCOND_FLAG_DUP | JOBCOND_FLAG_NO_STEP;
 	job_cond->db_flags = SLURMDB_JOB_FLAG_NOTSET;
 
 	job_list = jobacct_storage_g_get_jobs_cond(db_conn, my_uid, job_cond);
@@ -28,7 +28,6 @@
 #include <arpa/inet.h>
 #include <errno.h>
 #include <fcntl.h>
-#include <poll.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -60,6 +59,7 @@
 #include "src/api/step_launch.h"
 
 #define STDIO_MAX_FREE_BUF 1024
+#define MAX_IO_ACCEPTS 64	/* IO connections accepted per wakeup */
 
 struct io_buf {
 	int ref_count;
@@ -886,40 +886,24 @@ _read_io_init_msg(int fd, client_io_t *cio, char *host)
 }
 
 
-static bool
-_is_fd_ready(int fd)
-{
-	struct pollfd pfd[1];
-	int    rc;
-
-	pfd[0].fd     = fd;
-	pfd[0].events = POLLIN;
-
-	rc = poll(pfd, 1, 10);
-
-	return ((rc == 1) && (pfd[0].revents & POLLIN));
-}
-
-
 static void
 _handle_io_init_msg(int fd, client_io_t *cio)
 {
 	int j;
 	debug2("Activity on IO listening socket %d", fd);
 
-	for (j = 0; j < 15; j++) {
+	/*
+	 * The listening socket is nonblocking, so accept() returns EAGAIN
+	 * once no connection is pending. Accept what is queued without
+	 * waiting for more, the eio mainloop calls back when there is.
+	 */
+	for (j = 0; j < MAX_IO_ACCEPTS; j++) {
 		int sd;
 		struct sockaddr addr;
 		struct sockaddr_in *sin;
 		socklen_t size = sizeof(addr);
 		char buf[INET_ADDRSTRLEN];
 
-		/*
-		 * Return early if fd is not now ready
-		 */
-		if (!_is_fd_ready(fd))
-			return;
-
 		while ((sd = accept(fd, &addr, &size)) < 0) {
 			if (errno == EINTR)
 				continue;
@@ -1109,7 +1093,7 @@ client_io_t *client_io_handler_create(slurm_step_io_fds_t fds, int num_tasks,
 	memcpy(cio->io_key, sig, siglen);
 	/* no need to free "sig", it is just a pointer into the credential */
 
-	cio->eio = eio_handle_create(slurm_conf.eio_timeout);
+	cio->eio = eio_handle_create_epoll(slurm_conf.eio_timeout);
 
 	/* Compute number of listening sockets needed to allow
 	 * all of the slurmds to establish IO streams with srun, without
@@ -153,3 +153,70 @@ extern int slurm_submit_batch_het_job(List job_req_list,
 
 	return SLURM_SUCCESS;
 }
+
+/*
+ * slurm_submit_batch_jobs - issue RPC to submit several independent batch
+ *			     jobs for later execution in a single request
+ * NOTE: free the response list using slurm_list_destroy()
+ * IN job_req_list - List of batch job requests, type job_desc_msg_t,
+ *		     at most 65534 entries
+ * OUT resp_list - List of submit_response_msg_t, one per job_req_list entry
+ *		   and in the same order. A job_id of zero means the job was
+ *		   rejected, with the reason in error_code
+ * RET SLURM_SUCCESS on success, otherwise return SLURM_ERROR with errno set
+ */
+extern int slurm_submit_batch_jobs(List job_req_list, List *resp_list)
+{
+	int rc, req_cnt;
+	job_desc_msg_t *req;
+	slurm_msg_t req_msg;
+	slurm_msg_t resp_msg;
+	ListIterator iter;
+
+	*resp_list = NULL;
+	req_cnt = job_req_list ? list_count(job_req_list) : 0;
+	if ((req_cnt == 0) || (req_cnt >= NO_VAL16))
+		slurm_seterrno_ret(EINVAL);
+
+	slurm_msg_t_init(&req_msg);
+	slurm_msg_t_init(&resp_msg);
+
+	/*
+	 * set session id for this request
+	 */
+	iter = list_iterator_create(job_req_list);
+	while ((req = (job_desc_msg_t *) list_next(iter))) {
+		if (req->alloc_sid == NO_VAL)
+			req->alloc_sid = getsid(0);
+	}
+	list_iterator_destroy(iter);
+
+	req_msg.msg_type = REQUEST_SUBMIT_BATCH_JOBS;
+	req_msg.data     = job_req_list;
+
+	rc = slurm_send_recv_controller_msg(&req_msg, &resp_msg,
+					    working_cluster_rec);
+	if (rc == SLURM_ERROR)
+		return SLURM_ERROR;
+	switch (resp_msg.msg_type) {
+	case RESPONSE_SLURM_RC:
+		rc = ((return_code_msg_t *) resp_msg.data)->return_code;
+		slurm_free_return_code_msg(resp_msg.data);
+		if (rc)
+			slurm_seterrno_ret(rc);
+		/* A bare success is not a valid answer to this request */
+		slurm_seterrno_ret(SLURM_UNEXPECTED_MSG_ERROR);
+	case RESPONSE_SUBMIT_BATCH_JOBS:
+		*resp_list = (List) resp_msg.data;
+		if (!*resp_list || (list_count(*resp_list) != req_cnt)) {
+			FREE_NULL_LIST(*resp_list);
+			slurm_seterrno_ret(SLURM_UNEXPECTED_MSG_ERROR);
+		}
+		break;
+	default:
+		slurm_free_msg_data(resp_msg.msg_type, resp_msg.data);
+		slurm_seterrno_ret(SLURM_UNEXPECTED_MSG_ERROR);
+	}
+
+	return SLURM_SUCCESS;
+}
@@ -77,6 +77,18 @@
 
 #define MAX_THREADS      8	/* These can be huge messages, so
 				 * only run MAX_THREADS at one time */
+#define COMPRESS_THREADS 4	/* zlib blocks compressed at one time */
+
+typedef struct {
+	struct bcast_parameters *params;
+	char *buffer;			/* block data, possibly compressed */
+	int32_t block_len;		/* size of data in buffer */
+	int32_t orig_len;		/* uncompressed size of the block */
+	uint16_t compress;		/* compression used for the block */
+	int64_t offset;			/* file offset, zlib only */
+	bool more;			/* set if more blocks follow */
+	uint32_t usec;			/* time spent reading the block */
+} bcast_block_t;
 
 int block_len;				/* block size */
 int fd;					/* source file descriptor */
@@ -228,10 +240,11 @@ static int _get_block_none(char **buffer, int *orig_len, bool *more)
 	int size;
 
 	if (remaining < 0) {
-		*buffer = xmalloc(block_len);
 		remaining = f_stat.st_size;
 		position = src;
 	}
+	if (!*buffer)
+		*buffer = xmalloc(block_len);
 
 	size = MIN(block_len, remaining);
 	memcpy(*buffer, position, size);
@@ -243,19 +256,24 @@ static int _get_block_none(char **buffer, int *orig_len, bool *more)
 	return size;
 }
 
+/*
+ * Compress the block starting at offset in the file. Blocks are independent
+ * of each other so several of them may be compressed at once.
+ */
 static int _get_block_zlib(struct bcast_parameters *params,
+			   int64_t offset,
 			   char **buffer,
 			   int *orig_len,
 			   bool *more)
 {
 #if HAVE_LIBZ
-	static z_stream strm;
+	z_stream strm;
 	int chunk = (256 * 1024);
 	int flush = Z_NO_FLUSH;
 
-	static int64_t remaining = -1;
-	static int max_out;
-	static void *position;
+	int64_t remaining = f_stat.st_size - offset;
+	int max_out;
+	void *position = src + offset;
 	int chunk_remaining, out_remaining, chunk_bite, size = 0;
 
 	/* allocate deflate state, compress each block independently */
@@ -264,20 +282,12 @@ static int _get_block_zlib(struct bcast_parameters *params,
 	strm.opaque = Z_NULL;
 	strm.avail_in = 0;
 	strm.next_in = Z_NULL;
-	if (deflateInit(&strm, Z_DEFAULT_COMPRESSION) != Z_OK) {
-		error("File compression configuration error,"
-		      "sending uncompressed file.");
-		params->compress = 0;
-		return _get_block_none(buffer, orig_len, more);
-	}
+	if (deflateInit(&strm, Z_DEFAULT_COMPRESSION) != Z_OK)
+		fatal("File compression configuration error");
 
-	/* first pass through, initialize */
-	if (remaining < 0) {
-		remaining = f_stat.st_size;
-		max_out = deflateBound(&strm, block_len);
+	max_out = deflateBound(&strm, block_len);
+	if (!*buffer)
 		*buffer = xmalloc(max_out);
-		position = src;
-	}
 
 	chunk_remaining = MIN(block_len, remaining);
 	out_remaining = max_out;
@@ -332,8 +342,9 @@ static int _get_block_lz4(struct bcast_parameters *params,
 	if (remaining < 0) {
 		position = src;
 		remaining = f_stat.st_size;
-		*buffer = xmalloc(block_len);
 	}
+	if (!*buffer)
+		*buffer = xmalloc(block_len);
 
 	/* intentionally limit decompressed size to 10x compressed
 	 * to avoid problems on receive size when decompressed */
@@ -358,6 +369,7 @@ static int _get_block_lz4(struct bcast_parameters *params,
 }
 
 static int _next_block(struct bcast_parameters *params,
+		       int64_t offset,
 		       char **buffer,
 		       int32_t *orig_len,
 		       bool *more)
@@ -366,7 +378,8 @@ static int _next_block(struct bcast_parameters *params,
 	case COMPRESS_OFF:
 		return _get_block_none(buffer, orig_len, more);
 	case COMPRESS_ZLIB:
-		return _get_block_zlib(params, buffer, orig_len, more);
+		return _get_block_zlib(params, offset, buffer, orig_len,
+				       more);
 	case COMPRESS_LZ4:
 		return _get_block_lz4(params, buffer, orig_len, more);
 	}
@@ -378,17 +391,33 @@ static int _next_block(struct bcast_parameters *params,
 	return _get_block_none(buffer, orig_len, more);
 }
 
+/* Load the next block of the file, run in its own thread */
+static void *_read_block(void *arg)
+{
+	bcast_block_t *block = arg;
+	DEF_TIMERS;
+
+	START_TIMER;
+	block->block_len = _next_block(block->params, block->offset,
+				       &block->buffer, &block->orig_len,
+				       &block->more);
+	END_TIMER;
+	block->compress = block->params->compress;
+	block->usec = DELTA_TIMER;
+
+	return NULL;
+}
+
 /* read and broadcast the file */
 static int _bcast_file(struct bcast_parameters *params)
 {
 	int rc = SLURM_SUCCESS;
 	file_bcast_msg_t bcast_msg;
-	char *buffer = NULL;
-	int32_t orig_len = 0;
+	bcast_block_t *blocks, *cur;
+	pthread_t *tids;
+	int nthreads, nslots, inx = 0, next_inx;
 	uint64_t size_uncompressed = 0, size_compressed = 0;
 	uint32_t time_compression = 0;
-	bool more = true;
-	DEF_TIMERS;
 
 	if (params->block_size)
 		block_len = MIN(params->block_size, f_stat.st_size);
@@ -415,20 +444,62 @@ static int _bcast_file(struct bcast_parameters *params)
 		params->fanout = MAX_THREADS;
 	slurm_conf.tree_width = MIN(MAX_THREADS, params->fanout);
 
-	while (more) {
-		START_TIMER;
-		bcast_msg.block_len = _next_block(params, &buffer, &orig_len,
-						  &more);
-		END_TIMER;
-		time_compression += DELTA_TIMER;
-		size_uncompressed += orig_len;
-		size_compressed += bcast_msg.block_len;
+	/*
+	 * Read ahead of the broadcast: upcoming blocks are read and compressed
+	 * by helper threads while the current one is being sent, so the
+	 * compression time is hidden behind the network transfer. zlib blocks
+	 * start at fixed offsets and are compressed COMPRESS_THREADS at a
+	 * time. Other blocks depend on how much input the previous block
+	 * consumed, so only the next one is prepared.
+	 */
+#if HAVE_LIBZ
+	if (params->compress == COMPRESS_ZLIB)
+		nthreads = COMPRESS_THREADS;
+	else
+#endif
+		nthreads = 1;
+	nslots = nthreads + 1;
+	blocks = xcalloc(nslots, sizeof(bcast_block_t));
+	tids = xcalloc(nslots, sizeof(pthread_t));
+	for (int i = 0; i < nslots; i++)
+		blocks[i].params = params;
+
+	for (next_inx = 0; next_inx < nthreads; next_inx++) {
+		if (next_inx &&
+		    ((nthreads == 1) ||
+		     (((int64_t) next_inx * block_len) >= f_stat.st_size)))
+			break;
+		blocks[next_inx].offset = (int64_t) next_inx * block_len;
+		slurm_thread_create(&tids[next_inx], _read_block,
+				    &blocks[next_inx]);
+	}
+
+	while (true) {
+		cur = &blocks[inx % nslots];
+		pthread_join(tids[inx % nslots], NULL);
+		tids[inx % nslots] = 0;
+
+		/* start on a later block before sending this one */
+		if (cur->more &&
+		    ((nthreads == 1) ||
+		     (((int64_t) next_inx * block_len) < f_stat.st_size))) {
+			bcast_block_t *next = &blocks[next_inx % nslots];
+			next->offset = (int64_t) next_inx * block_len;
+			slurm_thread_create(&tids[next_inx % nslots],
+					    _read_block, next);
+			next_inx++;
+		}
+
+		time_compression += cur->usec;
+		size_uncompressed += cur->orig_len;
+		size_compressed += cur->block_len;
+		bcast_msg.block_len = cur->block_len;
 		debug("block %u, size %u", bcast_msg.block_no,
 		      bcast_msg.block_len);
-		bcast_msg.compress = params->compress;
-		bcast_msg.uncomp_len = orig_len;
-		bcast_msg.block = buffer;
-		if (!more)
+		bcast_msg.compress = cur->compress;
+		bcast_msg.uncomp_len = cur->orig_len;
+		bcast_msg.block = cur->buffer;
+		if (!cur->more)
 			bcast_msg.last_block = 1;
 
 		rc = _file_bcast(params, &bcast_msg, sbcast_cred);
@@ -437,10 +508,17 @@ static int _bcast_file(struct bcast_parameters *params)
 		if (bcast_msg.last_block)
 			break;	/* end of file */
 		bcast_msg.block_no++;
-		bcast_msg.block_offset += orig_len;
+		bcast_msg.block_offset += cur->orig_len;
+		inx++;
+	}
+	for (int i = 0; i < nslots; i++) {
+		if (tids[i])
+			pthread_join(tids[i], NULL);
+		xfree(blocks[i].buffer);
 	}
+	xfree(blocks);
+	xfree(tids);
 	xfree(bcast_msg.user_name);
-	xfree(buffer);
 
 	if (size_uncompressed && (params->compress != 0)) {
 		int64_t pct = (int64_t) size_uncompressed - size_compressed;
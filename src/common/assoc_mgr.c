@@ -895,6 +895,28 @@ static int _set_assoc_parent_and_user(slurmdb_assoc_rec_t *assoc,
 	return SLURM_SUCCESS;
 }
 
+/*
+ * Remember if the association has no group TRES limits at all so
+ * acct_policy can skip it when walking up the tree for every pending job.
+ */
+static void _set_assoc_grp_tres_unlimited(slurmdb_assoc_rec_t *assoc)
+{
+	int i;
+
+	if (!assoc->usage)
+		return;
+
+	assoc->usage->grp_tres_unlimited = true;
+	for (i = 0; i < g_tres_count; i++) {
+		if ((assoc->grp_tres_ctld[i] != INFINITE64) ||
+		    (assoc->grp_tres_mins_ctld[i] != INFINITE64) ||
+		    (assoc->grp_tres_run_mins_ctld[i] != INFINITE64)) {
+			assoc->usage->grp_tres_unlimited = false;
+			break;
+		}
+	}
+}
+
 static void _set_assoc_norm_priority(slurmdb_assoc_rec_t *assoc)
 {
 	if (!assoc)
@@ -1490,21 +1512,19 @@ static int _get_assoc_mgr_tres_list(void *db_conn, int enforce)
 
 	memset(&tres_q, 0, sizeof(slurmdb_tres_cond_t));
 
-	assoc_mgr_lock(&locks);
-
 	/* If this exists we only want/care about tracking/caching these TRES */
 	if ((tres_req_str = slurm_get_accounting_storage_tres())) {
 		tres_q.type_list = list_create(xfree_ptr);
 		slurm_addto_char_list(tres_q.type_list, tres_req_str);
 		xfree(tres_req_str);
 	}
+	/* Don't hold the locks while waiting on the database */
 	new_list = acct_storage_g_get_tres(
 		db_conn, uid, &tres_q);
 
 	FREE_NULL_LIST(tres_q.type_list);
 
 	if (!new_list) {
-		assoc_mgr_unlock(&locks);
 		if (enforce & ACCOUNTING_ENFORCE_ASSOCS) {
 			error("_get_assoc_mgr_tres_list: "
 			      "no list was made.");
@@ -1514,8 +1534,8 @@ static int _get_assoc_mgr_tres_list(void *db_conn, int enforce)
 		}
 	}
 
+	assoc_mgr_lock(&locks);
 	changed = assoc_mgr_post_tres_list(new_list);
-
 	assoc_mgr_unlock(&locks);
 
 	if (changed && !_running_cache() && init_setup.update_cluster_tres) {
@@ -1745,7 +1765,7 @@ static int _refresh_assoc_mgr_tres_list(void *db_conn, int enforce)
 static int _refresh_assoc_mgr_assoc_list(void *db_conn, int enforce)
 {
 	slurmdb_assoc_cond_t assoc_q;
-	List current_assocs = NULL;
+	List current_assocs = NULL, new_assocs;
 	uid_t uid = getuid();
 	ListIterator curr_itr = NULL;
 	slurmdb_assoc_rec_t *curr_assoc = NULL, *assoc = NULL;
@@ -1763,26 +1783,27 @@ static int _refresh_assoc_mgr_assoc_list(void *db_conn, int enforce)
 		      "all associations.");
 	}
 
-	assoc_mgr_lock(&locks);
-
-	current_assocs = assoc_mgr_assoc_list;
-
+	/*
+	 * Large association trees can take seconds to come back from the
+	 * database, so get them before locking like the other lists.
+	 */
 //	START_TIMER;
-	assoc_mgr_assoc_list =
-		acct_storage_g_get_assocs(db_conn, uid, &assoc_q);
+	new_assocs = acct_storage_g_get_assocs(db_conn, uid, &assoc_q);
 //	END_TIMER2("get_assocs");
 
 	FREE_NULL_LIST(assoc_q.cluster_list);
 
-	if (!assoc_mgr_assoc_list) {
-		assoc_mgr_assoc_list = current_assocs;
-		assoc_mgr_unlock(&locks);
-
+	if (!new_assocs) {
 		error("_refresh_assoc_mgr_assoc_list: "
 		      "no new list given back keeping cached one.");
 		return SLURM_ERROR;
 	}
 
+	assoc_mgr_lock(&locks);
+
+	current_assocs = assoc_mgr_assoc_list;
+	assoc_mgr_assoc_list = new_assocs;
+
 	_post_assoc_list();
 
 	if (!current_assocs) {
@@ -3753,6 +3774,10 @@ extern int assoc_mgr_update_assocs(slurmdb_update_object_t *update, bool locked)
 					rec->grp_tres_run_mins, INFINITE64, 1);
 			}
 
+			if (object->grp_tres || object->grp_tres_mins ||
+			    object->grp_tres_run_mins)
+				_set_assoc_grp_tres_unlimited(rec);
+
 			if (object->grp_jobs != NO_VAL)
 				rec->grp_jobs = object->grp_jobs;
 			if (object->grp_jobs_accrue != NO_VAL)
@@ -6377,6 +6402,8 @@ extern void assoc_mgr_set_assoc_tres_cnt(slurmdb_assoc_rec_t *assoc)
 				     assoc->max_tres_mins_pj, INFINITE64, 1);
 	assoc_mgr_set_tres_cnt_array(&assoc->max_tres_run_mins_ctld,
 				     assoc->max_tres_run_mins, INFINITE64, 1);
+
+	_set_assoc_grp_tres_unlimited(assoc);
 }
 
 /* tres read lock needs to be locked before this is called. */
@@ -77,6 +77,9 @@
 #define	_bitstr_words(nbits)	\
 	((((nbits) + BITSTR_MAXPOS) >> BITSTR_SHIFT) + BITSTR_OVERHEAD)
 
+/* bits used in the last word of name, 0 if that word is full */
+#define _bitstr_tail_bits(name)	(_bitstr_bits(name) & BITSTR_MAXPOS)
+
 /* check signature */
 #define _assert_bitstr_valid(name) do { \
 	xassert((name) != NULL); \
@@ -97,6 +100,24 @@
 	xassert((bit) <= 0x40000000); 	\
 } while (0)
 
+/* mask for the bits at position pos and above within a word */
+static inline uint64_t _bit_mask_from(int pos)
+{
+#ifdef SLURM_BIGENDIAN
+	return BITSTR_MAXVAL >> pos;
+#else
+	return BITSTR_MAXVAL << pos;
+#endif
+}
+
+/* mask for the bits below position pos within a word, 0 < pos <= word size */
+static inline uint64_t _bit_mask_below(int pos)
+{
+	if (pos > BITSTR_MAXPOS)
+		return BITSTR_MAXVAL;
+	return ~_bit_mask_from(pos);
+}
+
 /*
  * external macros
  */
@@ -120,6 +141,7 @@ strong_alias(bit_set_all,	slurm_bit_set_all);
 strong_alias(bit_clear_all,	slurm_bit_clear_all);
 strong_alias(bit_ffc,		slurm_bit_ffc);
 strong_alias(bit_ffs,		slurm_bit_ffs);
+strong_alias(bit_ffs_from_bit,	slurm_bit_ffs_from_bit);
 strong_alias(bit_free,		slurm_bit_free);
 strong_alias(bit_realloc,	slurm_bit_realloc);
 strong_alias(bit_size,		slurm_bit_size);
@@ -368,10 +390,33 @@ bit_nffc(bitstr_t *b, int32_t n)
 	bitoff_t bit;
 	int32_t cnt = 0;
 
+	bitoff_t nbits;
+	const int32_t word_size = sizeof(bitstr_t) * 8;
+
 	_assert_bitstr_valid(b);
 	xassert(n > 0 && n < _bitstr_bits(b));
 
-	for (bit = 0; bit < _bitstr_bits(b); bit++) {
+	nbits = _bitstr_bits(b);
+	for (bit = 0; bit < nbits; ) {
+		/* Whole words that are all clear or all set */
+		if (!(bit & BITSTR_MAXPOS) && ((bit + word_size) <= nbits)) {
+			bitstr_t word = b[_bit_word(bit)];
+
+			if (word == 0) {
+				cnt += word_size;
+				bit += word_size;
+				if (cnt >= n) {
+					value = bit - cnt;
+					break;
+				}
+				continue;
+			}
+			if (word == BITSTR_MAXVAL) {
+				cnt = 0;
+				bit += word_size;
+				continue;
+			}
+		}
 		if (bit_test(b, bit)) {		/* fail */
 			cnt = 0;
 		} else {
@@ -381,6 +426,7 @@ bit_nffc(bitstr_t *b, int32_t n)
 				break;
 			}
 		}
+		bit++;
 	}
 
 	return value;
@@ -504,6 +550,49 @@ bit_ffs(bitstr_t *b)
 		return -1;
 }
 
+/*
+ * Find first bit set in b at or after a given position. Words with no bits
+ * set past that position are skipped in one test each.
+ *   b (IN)		bitstring to search
+ *   bit (IN)		position at which to begin search
+ *   RETURN 		resulting bit position (-1 if none found)
+ */
+bitoff_t
+bit_ffs_from_bit(bitstr_t *b, bitoff_t bit)
+{
+	bitoff_t value = -1;
+
+	_assert_bitstr_valid(b);
+	xassert(bit >= 0);
+
+	while (bit < _bitstr_bits(b) && value == -1) {
+		int32_t word = _bit_word(bit);
+		uint64_t masked = b[word] & _bit_mask_from(bit & BITSTR_MAXPOS);
+
+		if (masked == 0) {
+			bit = (bit | BITSTR_MAXPOS) + 1;	/* next word */
+			continue;
+		}
+#if HAVE___BUILTIN_CLZLL && (defined SLURM_BIGENDIAN)
+		value = (bit & ~BITSTR_MAXPOS) + __builtin_clzll(masked);
+#elif HAVE___BUILTIN_CTZLL && (!defined SLURM_BIGENDIAN)
+		value = (bit & ~BITSTR_MAXPOS) + __builtin_ctzll(masked);
+#else
+		while (bit < _bitstr_bits(b) && _bit_word(bit) == word) {
+			if (bit_test(b, bit)) {
+				value = bit;
+				break;
+			}
+			bit++;
+		}
+#endif
+	}
+	if (value < _bitstr_bits(b))
+		return value;
+	else
+		return -1;
+}
+
 /*
  * Find last bit set in b.
  *   b (IN)		bitstring to search
@@ -580,15 +669,15 @@ bit_fill_gaps(bitstr_t *b)
 int
 bit_super_set(bitstr_t *b1, bitstr_t *b2)
 {
-	bitoff_t bit;
+	bitoff_t word, nwords;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	xassert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
-	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8) {
-		if (b1[_bit_word(bit)] != (b1[_bit_word(bit)] &
-		                           b2[_bit_word(bit)]))
+	nwords = _bitstr_words(_bitstr_bits(b1));
+	for (word = BITSTR_OVERHEAD; word < nwords; word++) {
+		if (b1[word] & ~b2[word])
 			return 0;
 	}
 
@@ -601,7 +690,7 @@ bit_super_set(bitstr_t *b1, bitstr_t *b2)
 extern int
 bit_equal(bitstr_t *b1, bitstr_t *b2)
 {
-	bitoff_t bit;
+	bitoff_t word, nwords;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
@@ -609,8 +698,9 @@ bit_equal(bitstr_t *b1, bitstr_t *b2)
 	if (_bitstr_bits(b1) != _bitstr_bits(b2))
 		return 0;
 
-	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8) {
-		if (b1[_bit_word(bit)] != b2[_bit_word(bit)])
+	nwords = _bitstr_words(_bitstr_bits(b1));
+	for (word = BITSTR_OVERHEAD; word < nwords; word++) {
+		if (b1[word] != b2[word])
 			return 0;
 	}
 
@@ -627,14 +717,15 @@ bit_equal(bitstr_t *b1, bitstr_t *b2)
 void
 bit_and(bitstr_t *b1, bitstr_t *b2)
 {
-	bitoff_t bit;
+	bitoff_t word, nwords;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	xassert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
-	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8)
-		b1[_bit_word(bit)] &= b2[_bit_word(bit)];
+	nwords = _bitstr_words(_bitstr_bits(b1));
+	for (word = BITSTR_OVERHEAD; word < nwords; word++)
+		b1[word] &= b2[word];
 }
 
 /*
@@ -644,14 +735,15 @@ bit_and(bitstr_t *b1, bitstr_t *b2)
  */
 void bit_and_not(bitstr_t *b1, bitstr_t *b2)
 {
-	bitoff_t bit;
+	bitoff_t word, nwords;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	xassert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
-	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8)
-		b1[_bit_word(bit)] &= ~b2[_bit_word(bit)];
+	nwords = _bitstr_words(_bitstr_bits(b1));
+	for (word = BITSTR_OVERHEAD; word < nwords; word++)
+		b1[word] &= ~b2[word];
 }
 
 /*
@@ -661,12 +753,13 @@ void bit_and_not(bitstr_t *b1, bitstr_t *b2)
 void
 bit_not(bitstr_t *b)
 {
-	bitoff_t bit;
+	bitoff_t word, nwords;
 
 	_assert_bitstr_valid(b);
 
-	for (bit = 0; bit < _bitstr_bits(b); bit += sizeof(bitstr_t)*8)
-		b[_bit_word(bit)] = ~b[_bit_word(bit)];
+	nwords = _bitstr_words(_bitstr_bits(b));
+	for (word = BITSTR_OVERHEAD; word < nwords; word++)
+		b[word] = ~b[word];
 }
 
 /*
@@ -677,14 +770,15 @@ bit_not(bitstr_t *b)
 void
 bit_or(bitstr_t *b1, bitstr_t *b2)
 {
-	bitoff_t bit;
+	bitoff_t word, nwords;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	xassert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
-	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8)
-		b1[_bit_word(bit)] |= b2[_bit_word(bit)];
+	nwords = _bitstr_words(_bitstr_bits(b1));
+	for (word = BITSTR_OVERHEAD; word < nwords; word++)
+		b1[word] |= b2[word];
 }
 
 /*
@@ -694,14 +788,15 @@ bit_or(bitstr_t *b1, bitstr_t *b2)
  */
 void bit_or_not(bitstr_t *b1, bitstr_t *b2)
 {
-	bitoff_t bit;
+	bitoff_t word, nwords;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	xassert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
-	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8)
-		b1[_bit_word(bit)] |= ~b2[_bit_word(bit)];
+	nwords = _bitstr_words(_bitstr_bits(b1));
+	for (word = BITSTR_OVERHEAD; word < nwords; word++)
+		b1[word] |= ~b2[word];
 }
 
 /*
@@ -764,19 +859,16 @@ int32_t
 bit_set_count(bitstr_t *b)
 {
 	int32_t count = 0;
-	bitoff_t bit, bit_cnt;
-	int32_t word_size = sizeof(bitstr_t) * 8;
+	bitoff_t word, nwords;
 
 	_assert_bitstr_valid(b);
 
-	bit_cnt = _bitstr_bits(b);
-	for (bit = 0; (bit + word_size) <= bit_cnt; bit += word_size) {
-		count += hweight(b[_bit_word(bit)]);
-	}
-	for ( ; bit < bit_cnt; bit++) {
-		if (bit_test(b, bit))
-			count++;
-	}
+	nwords = _bit_word(_bitstr_bits(b));	/* full words */
+	for (word = BITSTR_OVERHEAD; word < nwords; word++)
+		count += hweight(b[word]);
+	if (_bitstr_tail_bits(b))
+		count += hweight(b[word] & _bit_mask_below(_bitstr_tail_bits(b)));
+
 	return count;
 }
 
@@ -790,26 +882,28 @@ bit_set_count(bitstr_t *b)
 int32_t
 bit_set_count_range(bitstr_t *b, int32_t start, int32_t end)
 {
-	int32_t count = 0, eow;
-	bitoff_t bit;
-	const int32_t word_size = sizeof(bitstr_t) * 8;
+	int32_t count;
+	bitoff_t word, last;
+	uint64_t first_mask, last_mask;
 
 	_assert_bitstr_valid(b);
 	_assert_bit_valid(b,start);
 
 	end = MIN(end, _bitstr_bits(b));
-	eow = ((start+word_size-1)/word_size) * word_size;  /* end of word */
-	for ( bit = start; bit < end && bit < eow; bit++) {
-		if (bit_test(b, bit))
-			count++;
-	}
-	for (; (bit + word_size) <= end ; bit += word_size) {
-		count += hweight(b[_bit_word(bit)]);
-	}
-	for ( ; bit < end; bit++) {
-		if (bit_test(b, bit))
-			count++;
-	}
+	if (start >= end)
+		return 0;
+
+	word = _bit_word(start);
+	last = _bit_word(end - 1);
+	first_mask = _bit_mask_from(start & BITSTR_MAXPOS);
+	last_mask = _bit_mask_below(((end - 1) & BITSTR_MAXPOS) + 1);
+	if (word == last)
+		return hweight(b[word] & first_mask & last_mask);
+
+	count = hweight(b[word] & first_mask);
+	for (word++; word < last; word++)
+		count += hweight(b[word]);
+	count += hweight(b[last] & last_mask);
 
 	return count;
 }
@@ -818,31 +912,30 @@ static int32_t _bit_overlap_internal(bitstr_t *b1, bitstr_t *b2, bool count_it)
 {
 	int32_t count = 0;
 	int64_t anded;
-	bitoff_t bit, bit_cnt;
-	int32_t word_size = sizeof(bitstr_t) * 8;
+	bitoff_t word, nwords;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	xassert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
-	bit_cnt = _bitstr_bits(b1);
-	for (bit = 0; bit < bit_cnt; bit += word_size) {
-		if ((bit + word_size - 1) >= bit_cnt)
-			break;
-		anded = b1[_bit_word(bit)] & b2[_bit_word(bit)];
+	nwords = _bit_word(_bitstr_bits(b1));	/* full words */
+	if (count_it) {
+		for (word = BITSTR_OVERHEAD; word < nwords; word++)
+			count += hweight(b1[word] & b2[word]);
+	} else {
+		for (word = BITSTR_OVERHEAD; word < nwords; word++) {
+			if (b1[word] & b2[word])
+				return 1;
+		}
+	}
+	if (_bitstr_tail_bits(b1)) {
+		anded = b1[word] & b2[word] &
+			_bit_mask_below(_bitstr_tail_bits(b1));
 		if (count_it)
 			count += hweight(anded);
 		else if (anded)
 			return 1;
 	}
-	for ( ; bit < bit_cnt; bit++) {
-		if (bit_test(b1, bit) && bit_test(b2, bit)) {
-			if (count_it)
-				count++;
-			else
-				return 1;
-		}
-	}
 
 	return count;
 }
@@ -1385,11 +1478,20 @@ static char *_bit_fmt_hexmask(bitstr_t *bitmap, bool trim_output)
 	retstr[charsize + 2] = '\0';
 	ptr = &retstr[charsize + 1];
 	for (i=0; i < bitsize;) {
+#ifdef SLURM_BIGENDIAN
 		current = 0;
 		if (                 bit_test(bitmap,i++)) current |= 0x1;
 		if ((i < bitsize) && bit_test(bitmap,i++)) current |= 0x2;
 		if ((i < bitsize) && bit_test(bitmap,i++)) current |= 0x4;
 		if ((i < bitsize) && bit_test(bitmap,i++)) current |= 0x8;
+#else
+		/* A nibble never spans two words, take it with one shift */
+		current = (((uint64_t) bitmap[_bit_word(i)]) >>
+			   (i & BITSTR_MAXPOS)) & 0xf;
+		if ((bitsize - i) < 4)
+			current &= (1 << (bitsize - i)) - 1;
+		i += 4;
+#endif
 		if (current <= 9) {
 			current += '0';
 		} else {
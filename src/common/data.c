@@ -36,8 +36,8 @@
 
 #include "config.h"
 
+#include <ctype.h>
 #include <math.h>
-#include <regex.h>
 
 #include "slurm/slurm.h"
 
@@ -50,21 +50,6 @@
 
 #include "src/common/data.h"
 
-/*
- * Regex matches based on YAML 1.1 section 5.5.
- * Honors ~ as YAML 1.1 allows for null fields.
- */
-static const char *bool_pattern_null = "^(\\~|[Nn][uU][lL][lL])$";
-static regex_t bool_pattern_null_re;
-static const char *bool_pattern_true = "^([Yy](|[eE][sS])|[tT]([rR][uU][eE]|)|[Oo][nN])$";
-static regex_t bool_pattern_true_re;
-static const char *bool_pattern_false = "^([nN]([Oo]|)|[fF](|[aA][lL][sS][eE])|[oO][fF][fF])$";
-static regex_t bool_pattern_false_re;
-static const char *bool_pattern_int = "^([+-]?[0-9]+)$";
-static regex_t bool_pattern_int_re;
-static const char *bool_pattern_float = "^([+-]?[0-9]*[.][0-9]*(|[eE][+-]?[0-9]+))$";
-static regex_t bool_pattern_float_re;
-
 static pthread_mutex_t init_mutex = PTHREAD_MUTEX_INITIALIZER;
 static bool initialized = false; /* protected by init_mutex */
 
@@ -94,106 +79,94 @@ static void _check_magic(const data_t *data);
 static void _release(data_t *data);
 static void _release_data_list_node(data_list_t *dl, data_list_node_t *dn);
 
-static int _dump_regex_error(int rc, const regex_t *preg)
+/*
+ * Scalar matches based on YAML 1.1 section 5.5.
+ * Honors ~ as YAML 1.1 allows for null fields.
+ *
+ * Matched by hand instead of with regexec() since every scalar of a parsed
+ * JSON or YAML document is run through these during type detection.
+ */
+static const char *null_words[] = { "~", "null", NULL };
+static const char *true_words[] = { "y", "yes", "t", "true", "on", NULL };
+static const char *false_words[] = { "n", "no", "f", "false", "off", NULL };
+
+static bool _match_word(const char *str, const char **words)
 {
-	char *buffer = NULL;
-	size_t len = regerror(rc, preg, NULL, 0);
+	/* not possible to match a NULL string */
+	if (!str)
+		return false;
 
-	if (len == 0) {
-		error("%s: unknown regex error code: %d", __func__, rc);
-		return SLURM_ERROR;
-	}
+	for (; *words; words++)
+		if (!xstrcasecmp(str, *words))
+			return true;
 
-	buffer = xmalloc(len);
-	len = regerror(rc, preg, buffer, len);
+	return false;
+}
 
-	if (len)
-		error("%s: regex error: %s", __func__, buffer);
-	else
-		error("%s: unexpected failure to get regex error", __func__);
+/* skip over [+-]?[0-9]* and return pointer to the following character */
+static const char *_skip_digits(const char *str, bool sign, size_t *count)
+{
+	*count = 0;
 
-	xfree(buffer);
-	return SLURM_ERROR;
+	if (sign && ((*str == '+') || (*str == '-')))
+		str++;
+
+	for (; isdigit((unsigned char) *str); str++)
+		(*count)++;
+
+	return str;
 }
 
-static bool _regex_quick_match(const char *str, const regex_t *preg)
+/* match ^[+-]?[0-9]+$ */
+static bool _match_int(const char *str)
 {
-	int rc;
+	size_t digits;
 
-	// TODO: nmatch may safely be able to be 0 for this function
-	size_t nmatch = 1;
-	regmatch_t pmatch[nmatch];
+	if (!str)
+		return false;
+
+	str = _skip_digits(str, true, &digits);
+
+	return (digits && !*str);
+}
+
+/* match ^[+-]?[0-9]*[.][0-9]*(|[eE][+-]?[0-9]+)$ */
+static bool _match_float(const char *str)
+{
+	size_t digits;
 
-	/* not possible to match a NULL string */
 	if (!str)
 		return false;
 
-	rc = regexec(preg, str, nmatch, pmatch, 0);
-	if (!rc) { /* matched */
-		return true;
-	} else if (rc == REG_NOMATCH) {
+	str = _skip_digits(str, true, &digits);
+	if (*str != '.')
 		return false;
-	} else { /* other error */
-		_dump_regex_error(rc, preg);
+	str = _skip_digits(str + 1, false, &digits);
+
+	if (!*str)
+		return true;
+	if ((*str != 'e') && (*str != 'E'))
 		return false;
-	}
+
+	str = _skip_digits(str + 1, true, &digits);
+
+	return (digits && !*str);
 }
 
 extern void data_destroy_static(void)
 {
 	slurm_mutex_lock(&init_mutex);
-
-	if (initialized) {
-		regfree(&bool_pattern_null_re);
-		regfree(&bool_pattern_true_re);
-		regfree(&bool_pattern_false_re);
-		regfree(&bool_pattern_int_re);
-		regfree(&bool_pattern_float_re);
-	}
-
+	initialized = false;
 	slurm_mutex_unlock(&init_mutex);
 }
 
 extern int data_init_static(void)
 {
-	int rc = SLURM_SUCCESS;
-	int reg_rc; /* regex rc */
-
 	slurm_mutex_lock(&init_mutex);
-
-	if (initialized)
-		goto cleanup;
 	initialized = true;
-
-	if (!rc && (reg_rc = regcomp(&bool_pattern_null_re, bool_pattern_null,
-			      REG_EXTENDED)) != 0) {
-		rc = _dump_regex_error(reg_rc, &bool_pattern_null_re);
-	}
-
-	if (!rc && (reg_rc = regcomp(&bool_pattern_true_re, bool_pattern_true,
-			      REG_EXTENDED)) != 0) {
-		rc = _dump_regex_error(reg_rc, &bool_pattern_true_re);
-	}
-
-	if (!rc && (reg_rc = regcomp(&bool_pattern_false_re, bool_pattern_false,
-			      REG_EXTENDED)) != 0) {
-		rc = _dump_regex_error(reg_rc, &bool_pattern_false_re);
-	}
-
-	if (!rc && (reg_rc = regcomp(&bool_pattern_int_re, bool_pattern_int,
-			      REG_EXTENDED)) != 0) {
-		rc = _dump_regex_error(reg_rc, &bool_pattern_int_re);
-	}
-
-	if (!rc && (reg_rc = regcomp(&bool_pattern_float_re, bool_pattern_float,
-			      REG_EXTENDED)) != 0) {
-		rc = _dump_regex_error(reg_rc, &bool_pattern_float_re);
-	}
-
-cleanup:
 	slurm_mutex_unlock(&init_mutex);
 
-	return rc;
+	return SLURM_SUCCESS;
 }
 
 static data_list_t *_data_list_new(void)
@@ -1161,8 +1134,7 @@ static int _convert_data_force_bool(data_t *data)
 		if (data->data.string_u == NULL ||
 		    data->data.string_u[0] == '\0')
 			data_set_bool(data, false);
-		else if (_regex_quick_match(data->data.string_u,
-					    &bool_pattern_true_re))
+		else if (_match_word(data->data.string_u, true_words))
 			data_set_bool(data, true);
 		else { /* try to auto detect the type and try again */
 			if (data_convert_type(data, DATA_TYPE_NONE)
@@ -1201,8 +1173,7 @@ static int _convert_data_null(data_t *data)
 
 	switch (data->type) {
 	case DATA_TYPE_STRING:
-		if (_regex_quick_match(data->data.string_u,
-				       &bool_pattern_null_re)) {
+		if (_match_word(data->data.string_u, null_words)) {
 			log_flag(DATA, "%s: convert data (0x%"PRIXPTR") to null: %s->null",
 				 __func__, (uintptr_t) data,
 				 data->data.string_u);
@@ -1226,15 +1197,14 @@ static int _convert_data_bool(data_t *data)
 
 	switch (data->type) {
 	case DATA_TYPE_STRING:
-		if (_regex_quick_match(data->data.string_u,
-				       &bool_pattern_true_re)) {
+		if (_match_word(data->data.string_u, true_words)) {
 			log_flag(DATA, "%s: convert data (0x%"PRIXPTR") to bool: %s->true",
 				 __func__, (uintptr_t) data,
 				 data->data.string_u);
 			data_set_bool(data, true);
 			return SLURM_SUCCESS;
-		} else if (_regex_quick_match(data->data.string_u,
-					      &bool_pattern_false_re)) {
+		} else if (_match_word(data->data.string_u,
+				       false_words)) {
 			log_flag(DATA, "%s: convert data (0x%"PRIXPTR") to bool: %s->false",
 				 __func__, (uintptr_t) data,
 				 data->data.string_u);
@@ -1258,8 +1228,7 @@ static int _convert_data_int(data_t *data)
 
 	switch (data->type) {
 	case DATA_TYPE_STRING:
-		if (_regex_quick_match(data->data.string_u,
-				       &bool_pattern_int_re)) {
+		if (_match_int(data->data.string_u)) {
 			int64_t x;
 			if (sscanf(data->data.string_u, "%"SCNd64, &x) == 1) {
 				log_flag(DATA, "%s: converted data (0x%"PRIXPTR") to int: %s->%"PRId64,
@@ -1290,8 +1259,7 @@ static int _convert_data_float(data_t *data)
 
 	switch (data->type) {
 	case DATA_TYPE_STRING:
-		if (_regex_quick_match(data->data.string_u,
-				       &bool_pattern_float_re)) {
+		if (_match_float(data->data.string_u)) {
 			double x;
 			if (sscanf(data->data.string_u, "%lf", &x) == 1) {
 				log_flag(DATA, "%s: convert data (0x%"PRIXPTR") to float: %s->%lf",
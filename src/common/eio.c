@@ -42,12 +42,18 @@
 #include <poll.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #if defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__)
 #define POLLRDHUP POLLHUP
 #endif
 
+#ifdef __linux__
+#  include <sys/epoll.h>
+#  define EIO_HAVE_EPOLL 1
+#endif
+
 #include "src/common/fd.h"
 #include "src/common/eio.h"
 #include "src/common/log.h"
@@ -62,6 +68,7 @@
  * for details.
  */
 strong_alias(eio_handle_create,		slurm_eio_handle_create);
+strong_alias(eio_handle_create_epoll,	slurm_eio_handle_create_epoll);
 strong_alias(eio_handle_destroy,	slurm_eio_handle_destroy);
 strong_alias(eio_handle_mainloop,	slurm_eio_handle_mainloop);
 strong_alias(eio_message_socket_readable, slurm_eio_message_socket_readable);
@@ -80,6 +87,28 @@ strong_alias(eio_signal_wakeup,		slurm_eio_signal_wakeup);
  * it wakes up.
  */
 #define EIO_MAGIC 0xe1e10
+
+/* epoll registration of one eio_obj_t, see eio_handle_create_epoll() */
+typedef struct {
+	eio_obj_t *obj;		/* NULL if the slot is free */
+	uint32_t gen;		/* bumped every time the slot is freed */
+	int fd;			/* fd registered with epoll, -1 if none */
+	dev_t dev;		/* identity of the file registered */
+	ino_t ino;
+	short events;		/* poll() events registered */
+	bool always;		/* fd can't be used with epoll (regular file),
+				 * it is always ready like with poll() */
+} eio_slot_t;
+
+typedef struct {
+	int slot;
+	uint32_t gen;
+	short revents;
+} eio_ready_t;
+
+#define EIO_WAKEUP_SLOT	NO_VAL64
+#define EIO_USE_POLL	1	/* _epoll_mainloop() gave up on epoll */
+
 struct eio_handle_components {
 	int  magic;
 	int  fds[2];
@@ -88,6 +117,10 @@ struct eio_handle_components {
 	uint16_t shutdown_wait;
 	List obj_list;
 	List new_objs;
+	int epfd;		/* -1 when using poll() */
+	eio_slot_t *slots;
+	int slot_cnt;
+	bool ep_rebuild;	/* epoll set may hold a stale registration */
 };
 
 /* Function prototypes */
@@ -99,12 +132,18 @@ static void         _poll_dispatch(struct pollfd *, unsigned int, eio_obj_t **,
 		                   List objList);
 static void         _poll_handle_event(short revents, eio_obj_t *obj,
 		                       List objList);
+#ifdef EIO_HAVE_EPOLL
+static void         _epoll_close(eio_handle_t *eio);
+static int          _epoll_mainloop(eio_handle_t *eio);
+static int          _epoll_open(eio_handle_t *eio);
+#endif
 
 eio_handle_t *eio_handle_create(uint16_t shutdown_wait)
 {
 	eio_handle_t *eio = xmalloc(sizeof(*eio));
 
 	eio->magic = EIO_MAGIC;
+	eio->epfd = -1;
 
 	if (pipe(eio->fds) < 0) {
 		error("%s: pipe: %m", __func__);
@@ -127,6 +166,18 @@ eio_handle_t *eio_handle_create(uint16_t shutdown_wait)
 	return eio;
 }
 
+eio_handle_t *eio_handle_create_epoll(uint16_t shutdown_wait)
+{
+	eio_handle_t *eio = eio_handle_create(shutdown_wait);
+
+#ifdef EIO_HAVE_EPOLL
+	if (eio && (_epoll_open(eio) < 0))
+		debug("%s: using poll() instead", __func__);
+#endif
+
+	return eio;
+}
+
 void eio_handle_destroy(eio_handle_t *eio)
 {
 	xassert(eio != NULL);
@@ -135,6 +186,9 @@ void eio_handle_destroy(eio_handle_t *eio)
 	close(eio->fds[1]);
 	FREE_NULL_LIST(eio->obj_list);
 	FREE_NULL_LIST(eio->new_objs);
+#ifdef EIO_HAVE_EPOLL
+	_epoll_close(eio);
+#endif
 	slurm_mutex_destroy(&eio->shutdown_mutex);
 
 	eio->magic = ~EIO_MAGIC;
@@ -292,6 +346,15 @@ int eio_handle_mainloop(eio_handle_t *eio)
 	xassert (eio != NULL);
 	xassert (eio->magic == EIO_MAGIC);
 
+#ifdef EIO_HAVE_EPOLL
+	if (eio->epfd >= 0) {
+		if ((retval = _epoll_mainloop(eio)) != EIO_USE_POLL)
+			return retval;
+		/* epoll can't handle these objects, go on with poll() */
+		retval = 0;
+	}
+#endif
+
 	while (1) {
 		/* Alloc memory for pfds and map if needed */
 		n = list_count(eio->obj_list);
@@ -499,6 +562,357 @@ static void _poll_handle_event(short revents, eio_obj_t *obj, List objList)
 	}
 }
 
+#ifdef EIO_HAVE_EPOLL
+/**********************************************************************
+ * epoll backend, see eio_handle_create_epoll()
+ *
+ * This only saves system calls: every iteration still walks all objects
+ * and calls their readable() and writable() callbacks, as poll() does,
+ * and the registrations are level triggered. What is saved is passing
+ * every fd to the kernel on each iteration.
+ *
+ * Registrations are keyed by a slot index plus generation rather than the
+ * object pointer. An fd closed by an object may stay registered if the
+ * file is still open elsewhere, so events for slots that have since been
+ * freed are ignored and the epoll set is rebuilt from scratch.
+ **********************************************************************/
+static int _epoll_open(eio_handle_t *eio)
+{
+	struct epoll_event ev = {
+		.events = EPOLLIN,
+		.data.u64 = EIO_WAKEUP_SLOT,
+	};
+
+	if ((eio->epfd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+		error("%s: epoll_create1: %m", __func__);
+		return -1;
+	}
+	if (epoll_ctl(eio->epfd, EPOLL_CTL_ADD, eio->fds[0], &ev) < 0) {
+		error("%s: epoll_ctl: %m", __func__);
+		close(eio->epfd);
+		eio->epfd = -1;
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Drop the epoll set and forget all registrations */
+static void _epoll_close(eio_handle_t *eio)
+{
+	int i;
+
+	for (i = 0; i < eio->slot_cnt; i++) {
+		if (eio->slots[i].obj)
+			eio->slots[i].obj->ep_handle = NULL;
+	}
+	xfree(eio->slots);
+	eio->slot_cnt = 0;
+
+	if (eio->epfd >= 0) {
+		close(eio->epfd);
+		eio->epfd = -1;
+	}
+}
+
+/* Start over with an empty epoll set, objects keep their slots */
+static int _epoll_rebuild(eio_handle_t *eio)
+{
+	int i;
+
+	close(eio->epfd);
+	eio->ep_rebuild = false;
+	for (i = 0; i < eio->slot_cnt; i++) {
+		eio->slots[i].fd = -1;
+		eio->slots[i].events = 0;
+		eio->slots[i].always = false;
+	}
+
+	return _epoll_open(eio);
+}
+
+/*
+ * Drop the slot's registration. epoll keys registrations on the open file,
+ * so if the object closed its fd and the number now belongs to some other
+ * file (maybe registered by another object) a DEL would remove the wrong
+ * one. Only issue it when the fd still refers to the file registered,
+ * otherwise leave the set alone. If the slot stays in use, a leftover
+ * registration would still carry its generation, so rebuild the set then.
+ */
+static void _epoll_del(eio_handle_t *eio, eio_slot_t *slot, bool freeing)
+{
+	struct epoll_event ev = { 0 };
+	struct stat st;
+
+	if ((slot->fd >= 0) && !slot->always) {
+		if ((fstat(slot->fd, &st) == 0) &&
+		    (st.st_dev == slot->dev) && (st.st_ino == slot->ino))
+			(void) epoll_ctl(eio->epfd, EPOLL_CTL_DEL, slot->fd,
+					 &ev);
+		else if (!freeing)
+			eio->ep_rebuild = true;
+	}
+
+	slot->fd = -1;
+	slot->events = 0;
+	slot->always = false;
+}
+
+static void _epoll_slot_alloc(eio_handle_t *eio, eio_obj_t *obj)
+{
+	eio_slot_t *slot;
+	int i;
+
+	for (i = 0; i < eio->slot_cnt; i++) {
+		if (!eio->slots[i].obj)
+			break;
+	}
+	if (i == eio->slot_cnt) {
+		eio->slot_cnt = MAX(64, eio->slot_cnt * 2);
+		/* Note: xrealloc() zeroes the new slots */
+		xrealloc(eio->slots, eio->slot_cnt * sizeof(eio_slot_t));
+	}
+
+	slot = &eio->slots[i];
+	slot->obj = obj;
+	slot->fd = -1;
+	slot->events = 0;
+	slot->always = false;
+
+	obj->ep_handle = eio;
+	obj->ep_slot = i;
+}
+
+static void _epoll_slot_free(eio_handle_t *eio, int i)
+{
+	eio_slot_t *slot = &eio->slots[i];
+
+	_epoll_del(eio, slot, true);
+	slot->obj = NULL;
+	slot->gen++;
+}
+
+/*
+ * Bring the epoll registrations in line with the objects' readable() and
+ * writable() state. Every object is still asked each time, only changes
+ * cost a system call.
+ * RET number of objects to wait on, or -1 if epoll can't be used for them
+ */
+static int _epoll_setup(eio_handle_t *eio)
+{
+	ListIterator itr = list_iterator_create(eio->obj_list);
+	struct epoll_event ev;
+	eio_slot_t *slot;
+	eio_obj_t *obj;
+	bool readable, writable;
+	short events;
+	struct stat st;
+	int op, cnt = 0, rc = 0;
+
+	if (eio->ep_rebuild && (_epoll_rebuild(eio) < 0)) {
+		list_iterator_destroy(itr);
+		return -1;
+	}
+
+	while ((obj = list_next(itr))) {
+		writable = _is_writable(obj);
+		readable = _is_readable(obj);
+		if (writable && readable)
+			events = POLLOUT | POLLIN | POLLHUP | POLLRDHUP;
+		else if (readable)
+			events = POLLIN | POLLRDHUP;
+		else if (writable)
+			events = POLLOUT | POLLHUP;
+		else
+			events = 0;
+
+		if (!obj->ep_handle)
+			_epoll_slot_alloc(eio, obj);
+		xassert(obj->ep_handle == eio);
+		slot = &eio->slots[obj->ep_slot];
+
+		if (!events) {
+			_epoll_del(eio, slot, false);
+			continue;
+		}
+		cnt++;
+
+		/* poll() ignores negative fds too */
+		if (obj->fd < 0) {
+			_epoll_del(eio, slot, false);
+			continue;
+		}
+
+		if (slot->fd == obj->fd) {
+			if ((slot->events == events) || slot->always) {
+				slot->events = events;
+				continue;
+			}
+			op = EPOLL_CTL_MOD;
+		} else {
+			_epoll_del(eio, slot, false);
+			op = EPOLL_CTL_ADD;
+		}
+
+		/* poll() and epoll() event bits are the same */
+		ev.events = (uint16_t) events;
+		ev.data.u64 = ((uint64_t) slot->gen << 32) | obj->ep_slot;
+		if (epoll_ctl(eio->epfd, op, obj->fd, &ev) < 0) {
+			if ((op == EPOLL_CTL_ADD) && (errno == EPERM)) {
+				/* Regular file, poll() says always ready */
+				slot->always = true;
+			} else {
+				debug("%s: epoll_ctl on fd %d: %m",
+				      __func__, obj->fd);
+				rc = -1;
+				break;
+			}
+		} else if (op == EPOLL_CTL_ADD) {
+			if (fstat(obj->fd, &st) == 0) {
+				slot->dev = st.st_dev;
+				slot->ino = st.st_ino;
+			} else {
+				slot->dev = 0;
+				slot->ino = 0;
+			}
+		}
+		slot->fd = obj->fd;
+		slot->events = events;
+	}
+	list_iterator_destroy(itr);
+
+	/* A DEL above was skipped, start over with a clean set */
+	if (!rc && eio->ep_rebuild)
+		return _epoll_setup(eio);
+
+	return rc ? rc : cnt;
+}
+
+static int _epoll_mainloop(eio_handle_t *eio)
+{
+	struct epoll_event *events = NULL;
+	eio_ready_t *ready = NULL;
+	eio_slot_t *slot;
+	int max_events = 0, ready_cnt, nobjs, n, i, timeout;
+	bool stale, wakeup;
+	time_t shutdown_time;
+	uint64_t data;
+	int rc = 0;
+
+	while (1) {
+		if ((nobjs = _epoll_setup(eio)) < 0) {
+			rc = EIO_USE_POLL;
+			break;
+		}
+		if (!nobjs)
+			break;
+
+		debug4("eio: handling events for %d objects", nobjs);
+
+		/* Room for every slot plus the wakeup fd */
+		if (max_events < (eio->slot_cnt + 1)) {
+			max_events = eio->slot_cnt + 1;
+			xrealloc(events, max_events * sizeof(*events));
+			xrealloc(ready, max_events * sizeof(*ready));
+		}
+
+		ready_cnt = 0;
+		for (i = 0; i < eio->slot_cnt; i++) {
+			slot = &eio->slots[i];
+			if (!slot->always || !slot->events)
+				continue;
+			ready[ready_cnt].slot = i;
+			ready[ready_cnt].gen = slot->gen;
+			ready[ready_cnt].revents =
+				slot->events & (POLLIN | POLLOUT);
+			ready_cnt++;
+		}
+
+		slurm_mutex_lock(&eio->shutdown_mutex);
+		shutdown_time = eio->shutdown_time;
+		slurm_mutex_unlock(&eio->shutdown_mutex);
+		if (ready_cnt)
+			timeout = 0;
+		else if (shutdown_time)
+			timeout = 1000;	/* Return every 1000 msec during shutdown */
+		else
+			timeout = -1;
+
+		while ((n = epoll_wait(eio->epfd, events, max_events,
+				       timeout)) < 0) {
+			if (errno == EINTR) {
+				n = 0;
+				break;
+			}
+			error("epoll_wait: %m");
+			rc = -1;
+			goto done;
+		}
+
+		wakeup = false;
+		stale = false;
+		for (i = 0; i < n; i++) {
+			data = events[i].data.u64;
+			if (data == EIO_WAKEUP_SLOT) {
+				wakeup = true;
+				continue;
+			}
+			ready[ready_cnt].slot = data & 0xffffffff;
+			ready[ready_cnt].gen = data >> 32;
+			if ((ready[ready_cnt].slot >= eio->slot_cnt) ||
+			    !eio->slots[ready[ready_cnt].slot].obj ||
+			    (eio->slots[ready[ready_cnt].slot].gen !=
+			     ready[ready_cnt].gen)) {
+				stale = true;
+				continue;
+			}
+			ready[ready_cnt].revents = events[i].events;
+			ready_cnt++;
+		}
+
+		/* See if we've been told to shut down by eio_signal_shutdown */
+		if (wakeup)
+			_eio_wakeup_handler(eio);
+
+		for (i = 0; i < ready_cnt; i++) {
+			slot = &eio->slots[ready[i].slot];
+			/* An earlier handler may have removed this object */
+			if (!slot->obj || (slot->gen != ready[i].gen))
+				continue;
+			_poll_handle_event(ready[i].revents, slot->obj,
+					   eio->obj_list);
+		}
+
+		if (stale) {
+			debug("%s: stale epoll registration, rebuilding",
+			      __func__);
+			if (_epoll_rebuild(eio) < 0) {
+				rc = EIO_USE_POLL;
+				break;
+			}
+		}
+
+		slurm_mutex_lock(&eio->shutdown_mutex);
+		shutdown_time = eio->shutdown_time;
+		slurm_mutex_unlock(&eio->shutdown_mutex);
+		if (shutdown_time &&
+		    (difftime(time(NULL), shutdown_time)>=eio->shutdown_wait)) {
+			error("%s: Abandoning IO %d secs after job shutdown initiated",
+			      __func__, eio->shutdown_wait);
+			rc = -1;
+			break;
+		}
+	}
+
+done:
+	if (rc == EIO_USE_POLL)
+		_epoll_close(eio);
+	xfree(events);
+	xfree(ready);
+	return rc;
+}
+#endif
+
 static struct io_operations *_ops_copy(struct io_operations *ops)
 {
 	struct io_operations *ret = xmalloc(sizeof(*ops));
@@ -522,6 +936,10 @@ void eio_obj_destroy(void *arg)
 {
 	eio_obj_t *obj = (eio_obj_t *)arg;
 	if (obj) {
+#ifdef EIO_HAVE_EPOLL
+		if (obj->ep_handle)
+			_epoll_slot_free(obj->ep_handle, obj->ep_slot);
+#endif
 		/* If the obj->fd is still open we need it to be to be
 		   sure we get the possible extra output that may be
 		   on the port.  see test7.11.
@@ -67,9 +67,23 @@ struct eio_obj {
 	void *arg;                        /* application-specific data       */
 	struct io_operations *ops;        /* pointer to ops struct for obj   */
 	bool shutdown;
+	eio_handle_t *ep_handle;          /* eio internal, epoll registration */
+	int ep_slot;                      /* eio internal, epoll registration */
 };
 
 eio_handle_t *eio_handle_create(uint16_t);
+
+/*
+ * Same as eio_handle_create() but use epoll() instead of poll() where
+ * available. The fds stay registered between iterations of the mainloop
+ * and only changes of the objects' readable()/writable() state are passed
+ * to the kernel, which saves system calls for handles with many objects.
+ * Every object's readable()/writable() callbacks are still called on each
+ * iteration, as with poll().
+ * Falls back to poll() if epoll is not available or can't be used with
+ * the objects given.
+ */
+eio_handle_t *eio_handle_create_epoll(uint16_t);
 void eio_handle_destroy(eio_handle_t *eio);
 
 /*
@@ -67,6 +67,7 @@
 #include "src/common/slurmdb_defs.h"
 #include "src/common/strlcpy.h"
 #include "src/common/xassert.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
@@ -1577,14 +1578,71 @@ int env_array_overwrite(char ***array_ptr, const char *name,
 	return _env_array_update(array_ptr, name, value, true);
 }
 
+/*
+ * Return length of the name of an environment variable "name=value" entry
+ * which env_array_merge() would accept, or -1 otherwise.
+ */
+static int _env_entry_name_len(const char *entry)
+{
+	char *ptr = strchr(entry, '=');
+
+	if (!ptr || ((ptr - entry + 1) > 256) ||
+	    ((strlen(ptr + 1) + 1) > ENV_BUFSIZE))
+		return -1;
+	return (ptr - entry);
+}
+
+static void _env_entry_id(void *item, const char **key, uint32_t *key_len)
+{
+	const char **entry = (const char **) item;
+
+	*key = *entry;
+	*key_len = _env_entry_name_len(*entry);
+}
+
 /*
  * Copy env_array must be freed by env_array_free
+ *
+ * Same result as env_array_merge() into an empty array, but names are
+ * looked up in a hash table rather than by scanning the copy for each entry.
+ * This runs for every task launched, with environments of hundreds of
+ * variables.
  */
 char **env_array_copy(const char **array)
 {
 	char **ptr = NULL;
+	const char **first, **latest;
+	xhash_t *names;
+	int cnt = 0, i, j, len;
 
-	env_array_merge(&ptr, array);
+	if (!array)
+		return NULL;
+	while (array[cnt])
+		cnt++;
+
+	/* latest value of each name, at the position of its first entry */
+	latest = xcalloc(cnt + 1, sizeof(char *));
+	names = xhash_init(_env_entry_id, NULL);
+	for (i = 0; i < cnt; i++) {
+		if ((len = _env_entry_name_len(array[i])) < 0)
+			continue;
+		if ((first = xhash_get(names, array[i], len)))
+			latest[first - array] = array[i];
+		else {
+			xhash_add(names, (void *) &array[i]);
+			latest[i] = array[i];
+		}
+	}
+	xhash_free(names);
+
+	for (i = 0, j = 0; i < cnt; i++) {
+		if (!latest[i])
+			continue;
+		if (!ptr)
+			ptr = xcalloc(cnt + 1, sizeof(char *));
+		ptr[j++] = xstrdup(latest[i]);
+	}
+	xfree(latest);
 
 	return ptr;
 }
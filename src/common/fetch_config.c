@@ -295,6 +295,22 @@ static void _init_minimal_conf_server_config(List controllers)
 	xfree(filename);
 }
 
+/* Return true if the file already holds exactly this content */
+static bool _conf_unchanged(char *file, const char *content)
+{
+	buf_t *config;
+	bool unchanged = false;
+
+	if (!(config = create_mmap_buf(file)))
+		return false;
+	if ((config->size == strlen(content)) &&
+	    !memcmp(config->head, content, config->size))
+		unchanged = true;
+	free_buf(config);
+
+	return unchanged;
+}
+
 static int _write_conf(const char *dir, const char *name, const char *content)
 {
 	char *file = NULL, *file_final = NULL;
@@ -308,6 +324,12 @@ static int _write_conf(const char *dir, const char *name, const char *content)
 		goto cleanup;
 	}
 
+	/* Leave an identical file alone, most reconfigures change one file */
+	if (_conf_unchanged(file_final, content)) {
+		debug2("%s: %s unchanged", __func__, name);
+		goto cleanup;
+	}
+
 	if ((fd = open(file, O_CREAT|O_WRONLY|O_TRUNC|O_CLOEXEC, 0644)) < 0) {
 		error("%s: could not open config file `%s`", __func__, file);
 		goto rwfail;
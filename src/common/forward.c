@@ -52,9 +52,25 @@
 #include "src/common/slurm_route.h"
 #include "src/common/read_config.h"
 #include "src/common/slurm_protocol_interface.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
+/*
+ * With CommunicationParameters=AdaptiveForward, nodes which could not be
+ * reached within this many seconds are not used to forward messages.
+ */
+#define FWD_FAIL_WINDOW 300
+
+typedef struct {
+	char *name;
+	time_t fail_time;
+} fwd_fail_t;
+
+/* Nodes we recently failed to reach, see _fwd_split_failed() */
+static xhash_t *fwd_fail_hash = NULL;
+static pthread_mutex_t fwd_fail_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 typedef struct {
 	pthread_cond_t *notify;
 	int            *p_thr_count;
@@ -73,6 +89,130 @@ static void _forward_msg_internal(hostlist_t hl, hostlist_t* sp_hl,
 				  header_t *header, int timeout,
 				  int hl_count);
 
+static bool _fwd_adaptive(void)
+{
+	return (xstrcasestr(slurm_conf.comm_params, "AdaptiveForward") !=
+		NULL);
+}
+
+static void _fwd_fail_id(void *item, const char **key, uint32_t *key_len)
+{
+	fwd_fail_t *fwd_fail = item;
+
+	*key = fwd_fail->name;
+	*key_len = strlen(fwd_fail->name);
+}
+
+static void _fwd_fail_free(void *item)
+{
+	fwd_fail_t *fwd_fail = item;
+
+	xfree(fwd_fail->name);
+	xfree(fwd_fail);
+}
+
+/* Remember that node_name could not be reached. */
+static void _fwd_note_fail(char *node_name)
+{
+	fwd_fail_t *fwd_fail;
+
+	if (!node_name || !_fwd_adaptive())
+		return;
+
+	slurm_mutex_lock(&fwd_fail_mutex);
+	if (!fwd_fail_hash)
+		fwd_fail_hash = xhash_init(_fwd_fail_id, _fwd_fail_free);
+	if (!(fwd_fail = xhash_get_str(fwd_fail_hash, node_name))) {
+		fwd_fail = xmalloc(sizeof(*fwd_fail));
+		fwd_fail->name = xstrdup(node_name);
+		xhash_add(fwd_fail_hash, fwd_fail);
+	}
+	fwd_fail->fail_time = time(NULL);
+	slurm_mutex_unlock(&fwd_fail_mutex);
+}
+
+/*
+ * Update the failed node history from the responses of one branch, nodes
+ * which answered no longer need to be avoided.
+ */
+static void _fwd_note_results(List ret_list)
+{
+	ret_data_info_t *ret_data_info;
+	ListIterator itr;
+
+	if (!ret_list || !_fwd_adaptive())
+		return;
+
+	itr = list_iterator_create(ret_list);
+	while ((ret_data_info = list_next(itr))) {
+		if (!ret_data_info->node_name)
+			continue;
+		if (ret_data_info->type == RESPONSE_FORWARD_FAILED) {
+			_fwd_note_fail(ret_data_info->node_name);
+			continue;
+		}
+		slurm_mutex_lock(&fwd_fail_mutex);
+		if (fwd_fail_hash && xhash_count(fwd_fail_hash))
+			xhash_delete_str(fwd_fail_hash,
+					 ret_data_info->node_name);
+		slurm_mutex_unlock(&fwd_fail_mutex);
+	}
+	list_iterator_destroy(itr);
+}
+
+/*
+ * Remove the nodes we failed to reach within FWD_FAIL_WINDOW from hl.
+ * They are still sent the message, but each directly and without anything
+ * to forward, so a node which is still down can not stall a whole branch
+ * until its timeout.
+ * RET hostlist of the removed nodes or NULL if none, caller must destroy
+ */
+static hostlist_t _fwd_split_failed(hostlist_t hl)
+{
+	hostlist_t failed_hl = NULL;
+	hostlist_iterator_t itr;
+	char name[HOSTLIST_NAME_LEN];
+	time_t cutoff;
+
+	if (!_fwd_adaptive())
+		return NULL;
+
+	slurm_mutex_lock(&fwd_fail_mutex);
+	if (!fwd_fail_hash || !xhash_count(fwd_fail_hash)) {
+		slurm_mutex_unlock(&fwd_fail_mutex);
+		return NULL;
+	}
+
+	cutoff = time(NULL) - FWD_FAIL_WINDOW;
+	itr = hostlist_iterator_create(hl);
+	while (hostlist_next_buf(itr, name, sizeof(name))) {
+		fwd_fail_t *fwd_fail = xhash_get_str(fwd_fail_hash, name);
+
+		if (!fwd_fail)
+			continue;
+		if (fwd_fail->fail_time < cutoff) {
+			xhash_delete_str(fwd_fail_hash, name);
+			continue;
+		}
+		if (!failed_hl)
+			failed_hl = hostlist_create(NULL);
+		hostlist_push_host(failed_hl, name);
+	}
+	hostlist_iterator_destroy(itr);
+	slurm_mutex_unlock(&fwd_fail_mutex);
+
+	if (failed_hl) {
+		itr = hostlist_iterator_create(failed_hl);
+		while (hostlist_next_buf(itr, name, sizeof(name)))
+			hostlist_delete_host(hl, name);
+		hostlist_iterator_destroy(itr);
+		debug2("%s: sending directly to %d recently unreachable nodes",
+		       __func__, hostlist_count(failed_hl));
+	}
+
+	return failed_hl;
+}
+
 void _destroy_tree_fwd(fwd_tree_t *fwd_tree)
 {
 	if (fwd_tree) {
@@ -318,6 +458,7 @@ void *_forward_thread(void *arg)
 		}
 		break;
 	}
+	_fwd_note_results(ret_list);
 	slurm_mutex_lock(&fwd_struct->forward_mutex);
 	if (ret_list) {
 		while ((ret_data_info = list_pop(ret_list)) != NULL) {
@@ -423,6 +564,7 @@ void *_fwd_tree_thread(void *arg)
 				}
 			}
 
+			_fwd_note_results(ret_list);
 			slurm_mutex_lock(fwd_tree->tree_mutex);
 			list_transfer(fwd_tree->ret_list, ret_list);
 			slurm_cond_signal(fwd_tree->notify);
@@ -594,8 +736,8 @@ extern void forward_init(forward_t *forward)
  */
 extern int forward_msg(forward_struct_t *forward_struct, header_t *header)
 {
-	hostlist_t hl = NULL;
-	hostlist_t* sp_hl;
+	hostlist_t hl = NULL, failed_hl;
+	hostlist_t *sp_hl = NULL;
 	int hl_count = 0;
 
 	if (!forward_struct->ret_list) {
@@ -604,16 +746,25 @@ extern int forward_msg(forward_struct_t *forward_struct, header_t *header)
 	}
 	hl = hostlist_create(header->forward.nodelist);
 	hostlist_uniq(hl);
+	failed_hl = _fwd_split_failed(hl);
 
-	if (route_g_split_hostlist(
+	if (hostlist_count(hl) &&
+	    route_g_split_hostlist(
 		    hl, &sp_hl, &hl_count, header->forward.tree_width)) {
 		error("unable to split forward hostlist");
 		hostlist_destroy(hl);
+		FREE_NULL_HOSTLIST(failed_hl);
 		return SLURM_ERROR;
 	}
 
 	_forward_msg_internal(NULL, sp_hl, forward_struct, header,
 			      forward_struct->timeout, hl_count);
+	if (failed_hl) {
+		_forward_msg_internal(failed_hl, NULL, forward_struct, header,
+				      forward_struct->timeout,
+				      hostlist_count(failed_hl));
+		hostlist_destroy(failed_hl);
+	}
 
 	xfree(sp_hl);
 	hostlist_destroy(hl);
@@ -641,7 +792,7 @@ extern List start_msg_tree(hostlist_t hl, slurm_msg_t *msg, int timeout)
 	List ret_list = NULL;
 	int thr_count = 0;
 	int host_count = 0;
-	hostlist_t* sp_hl;
+	hostlist_t *sp_hl = NULL, failed_hl = NULL, split_hl = hl;
 	int hl_count = 0;
 
 	xassert(hl);
@@ -650,11 +801,23 @@ extern List start_msg_tree(hostlist_t hl, slurm_msg_t *msg, int timeout)
 	hostlist_uniq(hl);
 	host_count = hostlist_count(hl);
 
-	if (route_g_split_hostlist(hl, &sp_hl, &hl_count,
+	/* Leave the caller's hostlist alone */
+	if (_fwd_adaptive()) {
+		split_hl = hostlist_copy(hl);
+		failed_hl = _fwd_split_failed(split_hl);
+	}
+
+	if (hostlist_count(split_hl) &&
+	    route_g_split_hostlist(split_hl, &sp_hl, &hl_count,
 				   msg->forward.tree_width)) {
 		error("unable to split forward hostlist");
+		if (split_hl != hl)
+			hostlist_destroy(split_hl);
+		FREE_NULL_HOSTLIST(failed_hl);
 		return NULL;
 	}
+	if (split_hl != hl)
+		hostlist_destroy(split_hl);
 	slurm_mutex_init(&tree_mutex);
 	slurm_cond_init(&notify, NULL);
 
@@ -668,7 +831,13 @@ extern List start_msg_tree(hostlist_t hl, slurm_msg_t *msg, int timeout)
 	fwd_tree.p_thr_count = &thr_count;
 	fwd_tree.tree_mutex = &tree_mutex;
 
-	_start_msg_tree_internal(NULL, sp_hl, &fwd_tree, hl_count);
+	if (sp_hl)
+		_start_msg_tree_internal(NULL, sp_hl, &fwd_tree, hl_count);
+	if (failed_hl) {
+		_start_msg_tree_internal(failed_hl, NULL, &fwd_tree,
+					 hostlist_count(failed_hl));
+		hostlist_destroy(failed_hl);
+	}
 
 	xfree(sp_hl);
 
@@ -704,6 +873,7 @@ extern void mark_as_failed_forward(List *ret_list, char *node_name, int err)
 	ret_data_info_t *ret_data_info = NULL;
 
 	debug3("problems with %s", node_name);
+	_fwd_note_fail(node_name);
 	if (!*ret_list)
 		*ret_list = list_create(destroy_data_info);
 
@@ -7290,16 +7290,10 @@ static sock_gres_t *_build_sock_gres_by_topo(gres_job_state_t *job_gres_ptr,
 		    node_gres_ptr->topo_core_bitmap[i]) {
 			use_all_sockets = true;
 			for (s = 0; s < sockets; s++) {
-				bool use_this_socket = false;
-				for (c = 0; c < cores_per_sock; c++) {
-					j = (s * cores_per_sock) + c;
-					if (bit_test(node_gres_ptr->
-						     topo_core_bitmap[i], j)) {
-						use_this_socket = true;
-						break;
-					}
-				}
-				if (!use_this_socket) {
+				j = s * cores_per_sock;
+				if (!bit_set_count_range(
+					    node_gres_ptr->topo_core_bitmap[i],
+					    j, j + cores_per_sock)) {
 					use_all_sockets = false;
 					break;
 				}
@@ -7336,44 +7330,36 @@ static sock_gres_t *_build_sock_gres_by_topo(gres_job_state_t *job_gres_ptr,
 						 topo_core_bitmap[i]));
 		}
 		for (s = 0; ((s < sockets) && avail_gres); s++) {
-			if (enforce_binding && core_bitmap) {
-				for (c = 0; c < cores_per_sock; c++) {
-					j = (s * cores_per_sock) + c;
-					if (bit_test(core_bitmap, j))
-						break;
-				}
-				if (c >= cores_per_sock) {
-					/* No available cores on this socket */
-					continue;
-				}
+			j = s * cores_per_sock;
+			if (j >= tot_cores)
+				break;	/* Off end of core bitmap */
+			if (enforce_binding && core_bitmap &&
+			    !bit_set_count_range(core_bitmap, j,
+						 j + cores_per_sock)) {
+				/* No available cores on this socket */
+				continue;
 			}
-			for (c = 0; c < cores_per_sock; c++) {
-				j = (s * cores_per_sock) + c;
-				if (j >= tot_cores)
-					break;	/* Off end of core bitmap */
-				if (node_gres_ptr->topo_core_bitmap[i] &&
-				    !bit_test(node_gres_ptr->topo_core_bitmap[i],
-					      j))
-					continue;
-				if (!node_gres_ptr->topo_gres_bitmap[i]) {
-					error("%s: topo_gres_bitmap NULL on node %s",
-					      __func__, node_name);
-					continue;
-				}
-				if (!sock_gres->bits_by_sock[s]) {
-					sock_gres->bits_by_sock[s] =
-						bit_copy(node_gres_ptr->
-							 topo_gres_bitmap[i]);
-				} else {
-					bit_or(sock_gres->bits_by_sock[s],
-					       node_gres_ptr->topo_gres_bitmap[i]);
-				}
-				sock_gres->cnt_by_sock[s] += avail_gres;
-				sock_gres->total_cnt += avail_gres;
-				avail_gres = 0;
-				match = true;
-				break;
+			if (!bit_set_count_range(
+				    node_gres_ptr->topo_core_bitmap[i], j,
+				    MIN(j + cores_per_sock, tot_cores)))
+				continue;
+			if (!node_gres_ptr->topo_gres_bitmap[i]) {
+				error("%s: topo_gres_bitmap NULL on node %s",
+				      __func__, node_name);
+				continue;
+			}
+			if (!sock_gres->bits_by_sock[s]) {
+				sock_gres->bits_by_sock[s] =
+					bit_copy(node_gres_ptr->
+						 topo_gres_bitmap[i]);
+			} else {
+				bit_or(sock_gres->bits_by_sock[s],
+				       node_gres_ptr->topo_gres_bitmap[i]);
 			}
+			sock_gres->cnt_by_sock[s] += avail_gres;
+			sock_gres->total_cnt += avail_gres;
+			avail_gres = 0;
+			match = true;
 		}
 	}
 
@@ -7419,14 +7405,12 @@ static sock_gres_t *_build_sock_gres_by_topo(gres_job_state_t *job_gres_ptr,
 		for (s = 0; s < sockets; s++) {
 			if (sock_gres->cnt_by_sock[s] == 0)
 				continue;
-			for (c = 0; c < cores_per_sock; c++) {
-				i = (s * cores_per_sock) + c;
-				if (!bit_test(core_bitmap, i))
-					continue;
-				avail_sock++;
-				avail_sock_flag[s] = true;
-				break;
-			}
+			i = s * cores_per_sock;
+			if (!bit_set_count_range(core_bitmap, i,
+						 i + cores_per_sock))
+				continue;
+			avail_sock++;
+			avail_sock_flag[s] = true;
 		}
 		while (avail_sock > s_p_n) {
 			int low_gres_sock_inx = -1;
@@ -7475,18 +7459,16 @@ static sock_gres_t *_build_sock_gres_by_topo(gres_job_state_t *job_gres_ptr,
 		for (s = 0; s < sockets; s++) {
 			if (sock_gres->cnt_by_sock[s] == 0)
 				continue;
-			for (c = 0; c < cores_per_sock; c++) {
-				i = (s * cores_per_sock) + c;
-				if (!bit_test(core_bitmap, i))
-					continue;
-				avail_sock++;
-				avail_sock_flag[s] = true;
-				if ((best_sock_inx == -1) ||
-				    (sock_gres->cnt_by_sock[s] >
-				     sock_gres->cnt_by_sock[best_sock_inx])) {
-					best_sock_inx = s;
-				}
-				break;
+			i = s * cores_per_sock;
+			if (!bit_set_count_range(core_bitmap, i,
+						 i + cores_per_sock))
+				continue;
+			avail_sock++;
+			avail_sock_flag[s] = true;
+			if ((best_sock_inx == -1) ||
+			    (sock_gres->cnt_by_sock[s] >
+			     sock_gres->cnt_by_sock[best_sock_inx])) {
+				best_sock_inx = s;
 			}
 		}
 		while ((best_sock_inx != -1) && (add_gres > 0)) {
@@ -7800,19 +7782,15 @@ static bool *_build_avail_cores_by_sock(bitstr_t *core_bitmap,
 					uint16_t cores_per_sock)
 {
 	bool *avail_cores_by_sock = xcalloc(sockets, sizeof(bool));
-	int s, c, i, lim = 0;
+	int s, i, lim = 0;
 
 	lim = bit_size(core_bitmap);
 	for (s = 0; s < sockets; s++) {
-		for (c = 0; c < cores_per_sock; c++) {
-			i = (s * cores_per_sock) + c;
-			if (i >= lim)
-				goto fini;	/* should never happen */
-			if (bit_test(core_bitmap, i)) {
-				avail_cores_by_sock[s] = true;
-				break;
-			}
-		}
+		i = s * cores_per_sock;
+		if (i >= lim)
+			goto fini;	/* should never happen */
+		if (bit_set_count_range(core_bitmap, i, i + cores_per_sock))
+			avail_cores_by_sock[s] = true;
 	}
 
 fini:	return avail_cores_by_sock;
@@ -8076,11 +8054,9 @@ extern void gres_plugin_job_core_filter3(gres_mc_data_t *mc_ptr,
 	xassert(avail_core);
 	avail_cores_per_sock = xcalloc(sockets, sizeof(uint16_t));
 	for (s = 0; s < sockets; s++) {
-		for (c = 0; c < cores_per_socket; c++) {
-			i = (s * cores_per_socket) + c;
-			if (bit_test(avail_core, i))
-				avail_cores_per_sock[s]++;
-		}
+		i = s * cores_per_socket;
+		avail_cores_per_sock[s] =
+			bit_set_count_range(avail_core, i, i + cores_per_socket);
 		tot_core_cnt += avail_cores_per_sock[s];
 	}
 
@@ -8468,7 +8444,7 @@ static int _get_sock_cnt(struct job_resources *job_res, int node_inx,
 {
 	int core_offset, used_sock_cnt = 0;
 	uint16_t sock_cnt = 0, cores_per_socket_cnt = 0;
-	int c, i, rc, s;
+	int i, rc, s;
 
 	rc = get_job_resources_cnt(job_res, job_node_inx, &sock_cnt,
 				   &cores_per_socket_cnt);
@@ -8482,11 +8458,9 @@ static int _get_sock_cnt(struct job_resources *job_res, int node_inx,
 		return 1;
 	}
 	for (s = 0; s < sock_cnt; s++) {
-		for (c = 0; c < cores_per_socket_cnt; c++) {
-			i = (s * cores_per_socket_cnt) + c;
-			if (bit_test(job_res->core_bitmap, (core_offset + i)))
-				used_sock_cnt++;
-		}
+		i = core_offset + (s * cores_per_socket_cnt);
+		used_sock_cnt += bit_set_count_range(job_res->core_bitmap, i,
+						     i + cores_per_socket_cnt);
 	}
 	if (used_sock_cnt == 0) {
 		error("%s: No allocated cores found", __func__);
@@ -8517,7 +8491,7 @@ static int _set_job_bits1(struct job_resources *job_res, int node_inx,
 {
 	int core_offset, gres_cnt;
 	uint16_t sock_cnt = 0, cores_per_socket_cnt = 0;
-	int c, i, g, rc, s;
+	int i, g, rc, s;
 	gres_job_state_t *job_specs;
 	gres_node_state_t *node_specs;
 	int *cores_on_sock = NULL, alloc_gres_cnt = 0;
@@ -8555,13 +8529,10 @@ static int _set_job_bits1(struct job_resources *job_res, int node_inx,
 	cores_on_sock = xcalloc(sock_cnt, sizeof(int));
 	gres_cnt = bit_size(job_specs->gres_bit_select[node_inx]);
 	for (s = 0; s < sock_cnt; s++) {
-		for (c = 0; c < cores_per_socket_cnt; c++) {
-			i = (s * cores_per_socket_cnt) + c;
-			if (bit_test(job_res->core_bitmap, (core_offset + i))) {
-				cores_on_sock[s]++;
-				total_cores++;
-			}
-		}
+		i = core_offset + (s * cores_per_socket_cnt);
+		cores_on_sock[s] = bit_set_count_range(job_res->core_bitmap, i,
+						       i + cores_per_socket_cnt);
+		total_cores += cores_on_sock[s];
 	}
 	if (job_specs->cpus_per_gres) {
 		max_gres = MIN(max_gres,
@@ -8813,7 +8784,7 @@ static void _set_node_bits(struct job_resources *job_res, int node_inx,
 {
 	int core_offset, gres_cnt;
 	uint16_t sock_cnt = 0, cores_per_socket_cnt = 0;
-	int c, i, g, l, rc, s;
+	int i, g, l, rc, s;
 	gres_job_state_t *job_specs;
 	gres_node_state_t *node_specs;
 	int *used_sock = NULL, alloc_gres_cnt = 0;
@@ -8846,13 +8817,10 @@ static void _set_node_bits(struct job_resources *job_res, int node_inx,
 	used_sock = xcalloc(sock_cnt, sizeof(int));
 	gres_cnt = bit_size(job_specs->gres_bit_select[node_inx]);
 	for (s = 0; s < sock_cnt; s++) {
-		for (c = 0; c < cores_per_socket_cnt; c++) {
-			i = (s * cores_per_socket_cnt) + c;
-			if (bit_test(job_res->core_bitmap, (core_offset + i))) {
-				used_sock[s]++;
-				break;
-			}
-		}
+		i = core_offset + (s * cores_per_socket_cnt);
+		if (bit_set_count_range(job_res->core_bitmap, i,
+					i + cores_per_socket_cnt))
+			used_sock[s]++;
 	}
 
 	/*
@@ -9005,7 +8973,7 @@ static void _pick_specific_topo(struct job_resources *job_res, int node_inx,
 {
 	int core_offset;
 	uint16_t sock_cnt = 0, cores_per_socket_cnt = 0;
-	int c, i, rc, s, t;
+	int i, rc, s, t;
 	gres_job_state_t *job_specs;
 	gres_node_state_t *node_specs;
 	int *used_sock = NULL, alloc_gres_cnt = 0;
@@ -9038,13 +9006,10 @@ static void _pick_specific_topo(struct job_resources *job_res, int node_inx,
 	xassert(job_res->core_bitmap);
 	used_sock = xcalloc(sock_cnt, sizeof(int));
 	for (s = 0; s < sock_cnt; s++) {
-		for (c = 0; c < cores_per_socket_cnt; c++) {
-			i = (s * cores_per_socket_cnt) + c;
-			if (bit_test(job_res->core_bitmap, (core_offset + i))) {
-				used_sock[s]++;
-				break;
-			}
-		}
+		i = core_offset + (s * cores_per_socket_cnt);
+		if (bit_set_count_range(job_res->core_bitmap, i,
+					i + cores_per_socket_cnt))
+			used_sock[s]++;
 	}
 
 	if ((sock_gres->plugin_id == mps_plugin_id) &&
@@ -9140,7 +9105,7 @@ static void _set_sock_bits(struct job_resources *job_res, int node_inx,
 {
 	int core_offset, gres_cnt;
 	uint16_t sock_cnt = 0, cores_per_socket_cnt = 0;
-	int c, i, g, l, rc, s;
+	int i, g, l, rc, s;
 	gres_job_state_t *job_specs;
 	gres_node_state_t *node_specs;
 	int *used_sock = NULL, used_sock_cnt = 0;
@@ -9172,13 +9137,11 @@ static void _set_sock_bits(struct job_resources *job_res, int node_inx,
 	used_sock = xcalloc(sock_cnt, sizeof(int));
 	gres_cnt = bit_size(job_specs->gres_bit_select[node_inx]);
 	for (s = 0; s < sock_cnt; s++) {
-		for (c = 0; c < cores_per_socket_cnt; c++) {
-			i = (s * cores_per_socket_cnt) + c;
-			if (bit_test(job_res->core_bitmap, (core_offset + i))) {
-				used_sock[s]++;
-				used_sock_cnt++;
-				break;
-			}
+		i = core_offset + (s * cores_per_socket_cnt);
+		if (bit_set_count_range(job_res->core_bitmap, i,
+					i + cores_per_socket_cnt)) {
+			used_sock[s]++;
+			used_sock_cnt++;
 		}
 	}
 	if (tres_mc_ptr && tres_mc_ptr->sockets_per_node     &&
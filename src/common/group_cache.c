@@ -48,6 +48,7 @@
  */
 
 #include <grp.h>
+#include <pwd.h>
 
 #include "src/common/group_cache.h"
 #include "src/common/list.h"
@@ -76,9 +77,31 @@ typedef struct gids_cache_needle {
 	time_t now;		/* automatically filled in */
 } gids_cache_needle_t;
 
+typedef struct pw_cache {
+	uid_t uid;
+	char *pw_name;
+	char *pw_gecos;
+	char *pw_dir;
+	char *pw_shell;
+	time_t expiration;
+} pw_cache_t;
+
 static pthread_mutex_t gids_mutex = PTHREAD_MUTEX_INITIALIZER;
 static List gids_cache_list = NULL;
 
+static pthread_mutex_t pw_mutex = PTHREAD_MUTEX_INITIALIZER;
+static List pw_cache_list = NULL;
+
+static void _pw_cache_list_delete(void *x)
+{
+	pw_cache_t *entry = (pw_cache_t *) x;
+	xfree(entry->pw_name);
+	xfree(entry->pw_gecos);
+	xfree(entry->pw_dir);
+	xfree(entry->pw_shell);
+	xfree(entry);
+}
+
 static void _group_cache_list_delete(void *x)
 {
 	gids_cache_t *entry = (gids_cache_t *) x;
@@ -95,6 +118,10 @@ void group_cache_purge(void)
 		list_destroy(gids_cache_list);
 	gids_cache_list = NULL;
 	slurm_mutex_unlock(&gids_mutex);
+
+	slurm_mutex_lock(&pw_mutex);
+	FREE_NULL_LIST(pw_cache_list);
+	slurm_mutex_unlock(&pw_mutex);
 }
 
 static int _find_entry(void *x, void *key)
@@ -215,6 +242,67 @@ extern int group_cache_lookup(uid_t uid, gid_t gid, char *username, gid_t **gids
 	return _group_cache_lookup_internal(&needle, gids);
 }
 
+static int _find_pw_entry(void *x, void *key)
+{
+	pw_cache_t *entry = (pw_cache_t *) x;
+	uid_t *uid = (uid_t *) key;
+
+	return (entry->uid == *uid);
+}
+
+extern int group_cache_getpw(uid_t uid, char **pw_name, char **pw_gecos,
+			     char **pw_dir, char **pw_shell)
+{
+	pw_cache_t *entry;
+	time_t now = time(NULL);
+	int rc = SLURM_SUCCESS;
+
+	slurm_mutex_lock(&pw_mutex);
+	if (!pw_cache_list)
+		pw_cache_list = list_create(_pw_cache_list_delete);
+
+	entry = list_find_first(pw_cache_list, _find_pw_entry, &uid);
+	if (!entry || (entry->expiration <= now)) {
+		struct passwd pwd, *result;
+		char buffer[PW_BUF_SIZE];
+
+		if (slurm_getpwuid_r(uid, &pwd, buffer, PW_BUF_SIZE, &result) ||
+		    !result) {
+			/* Do not cache failures, the name service may recover */
+			if (entry) {
+				list_remove_first(pw_cache_list,
+						  _find_pw_entry, &uid);
+				_pw_cache_list_delete(entry);
+			}
+			rc = SLURM_ERROR;
+			goto out;
+		}
+		if (!entry) {
+			entry = xmalloc(sizeof(pw_cache_t));
+			entry->uid = uid;
+			list_prepend(pw_cache_list, entry);
+		}
+		xfree(entry->pw_name);
+		xfree(entry->pw_gecos);
+		xfree(entry->pw_dir);
+		xfree(entry->pw_shell);
+		entry->pw_name = xstrdup(result->pw_name);
+		entry->pw_gecos = xstrdup(result->pw_gecos);
+		entry->pw_dir = xstrdup(result->pw_dir);
+		entry->pw_shell = xstrdup(result->pw_shell);
+		entry->expiration = now + slurm_conf.group_time;
+	}
+
+	*pw_name = xstrdup(entry->pw_name);
+	*pw_gecos = xstrdup(entry->pw_gecos);
+	*pw_dir = xstrdup(entry->pw_dir);
+	*pw_shell = xstrdup(entry->pw_shell);
+
+out:
+	slurm_mutex_unlock(&pw_mutex);
+	return rc;
+}
+
 static int _cleanup_search(void *x, void *key)
 {
 	gids_cache_t *cached = (gids_cache_t *) x;
@@ -49,6 +49,16 @@
  */
 extern int group_cache_lookup(uid_t uid, gid_t gid, char *username, gid_t **gids);
 
+/*
+ * Look up the passwd fields for a uid, caching them for GroupUpdateTime
+ * like the extended groups.
+ * IN: uid
+ * OUT: pw_name, pw_gecos, pw_dir, pw_shell - xmalloc'd strings
+ * RET: SLURM_SUCCESS, or SLURM_ERROR if the uid could not be resolved
+ */
+extern int group_cache_getpw(uid_t uid, char **pw_name, char **pw_gecos,
+			     char **pw_dir, char **pw_shell);
+
 /* call on daemon shutdown to cleanup properly */
 void group_cache_purge(void);
 
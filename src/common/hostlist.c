@@ -41,6 +41,7 @@
 #include <ctype.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <limits.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -88,6 +89,7 @@ strong_alias(hostlist_iterator_create,	slurm_hostlist_iterator_create);
 strong_alias(hostlist_iterator_destroy,	slurm_hostlist_iterator_destroy);
 strong_alias(hostlist_iterator_reset,	slurm_hostlist_iterator_reset);
 strong_alias(hostlist_next,		slurm_hostlist_next);
+strong_alias(hostlist_next_buf,	slurm_hostlist_next_buf);
 strong_alias(hostlist_next_range,	slurm_hostlist_next_range);
 strong_alias(hostlist_nth,		slurm_hostlist_nth);
 strong_alias(hostlist_pop,		slurm_hostlist_pop);
@@ -2163,6 +2165,40 @@ int hostlist_pop_range_values(
 	return 1;
 }
 
+int hostlist_shift_range_values(hostlist_t hl, char **prefix,
+				unsigned long *lo, unsigned long *hi,
+				int *width)
+{
+	hostrange_t head;
+
+	if (!hl || !prefix || !lo || !hi || !width)
+		return 0;
+
+	LOCK_HOSTLIST(hl);
+	if (hl->nranges < 1) {
+		UNLOCK_HOSTLIST(hl);
+		return 0;
+	}
+
+	head = hl->hr[0];
+	if (!(*prefix = strdup(head->prefix)))
+		out_of_memory("hostlist_shift_range_values");
+	if (head->singlehost) {
+		*lo = *hi = 0;
+		*width = -1;
+	} else {
+		*lo = head->lo;
+		*hi = head->hi;
+		*width = head->width;
+	}
+	hl->nhosts -= hostrange_count(head);
+	hostlist_delete_range(hl, 0);
+
+	UNLOCK_HOSTLIST(hl);
+
+	return 1;
+}
+
 char *hostlist_shift_range(hostlist_t hl)
 {
 	int i;
@@ -2401,6 +2437,18 @@ int _cmp(const void *hr1, const void *hr2)
 }
 
 
+/* Return true if the ranges of hl are already in sort order, lock held */
+static bool _hostlist_sorted(hostlist_t hl)
+{
+	int i;
+
+	for (i = 1; i < hl->nranges; i++) {
+		if (hostrange_cmp(hl->hr[i - 1], hl->hr[i]) > 0)
+			return false;
+	}
+	return true;
+}
+
 void hostlist_sort(hostlist_t hl)
 {
 	hostlist_iterator_t i;
@@ -2411,7 +2459,8 @@ void hostlist_sort(hostlist_t hl)
 		return;
 	}
 
-	qsort(hl->hr, hl->nranges, sizeof(hostrange_t), &_cmp);
+	if (!_hostlist_sorted(hl))
+		qsort(hl->hr, hl->nranges, sizeof(hostrange_t), &_cmp);
 
 	/* reset all iterators */
 	for (i = hl->ilist; i; i = i->next)
@@ -2527,7 +2576,8 @@ void hostlist_uniq(hostlist_t hl)
 		UNLOCK_HOSTLIST(hl);
 		return;
 	}
-	qsort(hl->hr, hl->nranges, sizeof(hostrange_t), &_cmp);
+	if (!_hostlist_sorted(hl))
+		qsort(hl->hr, hl->nranges, sizeof(hostrange_t), &_cmp);
 
 	while (i < hl->nranges) {
 		if (_attempt_range_join(hl, i) < 0) /* No range join occurred */
@@ -3350,10 +3400,9 @@ static void _iterator_advance_range(hostlist_iterator_t i)
 	}
 }
 
-char *hostlist_next_dims(hostlist_iterator_t i, int dims)
+static char *_hostlist_next_buf(hostlist_iterator_t i, int dims, char *buf,
+				int size)
 {
-	char buf[MAXHOSTNAMELEN + 16];
-	const int size = sizeof(buf);
 	int len = 0;
 
 	xassert(i);
@@ -3382,19 +3431,28 @@ char *hostlist_next_dims(hostlist_iterator_t i, int dims)
 				buf[len++] = alpha_num[coord[i2++]];
 			buf[len] = '\0';
 		} else {
-			len = snprintf(buf + len, size - len, "%0*lu",
-				       i->hr->width, i->hr->lo + i->depth);
-			if (len < 0 || len >= size)
+			int n = snprintf(buf + len, size - len, "%0*lu",
+					 i->hr->width, i->hr->lo + i->depth);
+			if (n < 0 || len + n >= size)
 				goto no_next;
 		}
 	}
 	UNLOCK_HOSTLIST(i->hl);
-	return strdup(buf);
+	return buf;
 no_next:
 	UNLOCK_HOSTLIST(i->hl);
 	return NULL;
 }
 
+char *hostlist_next_dims(hostlist_iterator_t i, int dims)
+{
+	char buf[HOSTLIST_NAME_LEN];
+
+	if (!_hostlist_next_buf(i, dims, buf, sizeof(buf)))
+		return NULL;
+	return strdup(buf);
+}
+
 char *hostlist_next(hostlist_iterator_t i)
 {
 	int dims = slurmdb_setup_cluster_name_dims();
@@ -3402,6 +3460,14 @@ char *hostlist_next(hostlist_iterator_t i)
 	return hostlist_next_dims(i, dims);
 }
 
+char *hostlist_next_buf(hostlist_iterator_t i, char *buf, size_t size)
+{
+	if (!buf || !size)
+		return NULL;
+	return _hostlist_next_buf(i, slurmdb_setup_cluster_name_dims(), buf,
+				  MIN(size, INT_MAX));
+}
+
 char *hostlist_next_range(hostlist_iterator_t i)
 {
 	int j, buf_size;
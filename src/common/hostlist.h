@@ -41,6 +41,7 @@
 
 #include "config.h"
 
+#include <sys/param.h>		/* MAXHOSTNAMELEN */
 #include <unistd.h>		/* load ssize_t definition */
 
 /* Since users can specify a numeric range in the prefix, we need to prevent
@@ -55,6 +56,13 @@
 #define HOSTLIST_BASE 10
 #endif
 
+#ifndef MAXHOSTNAMELEN
+#  define MAXHOSTNAMELEN 64
+#endif
+
+/* size of a buffer that fits any host name, see hostlist_next_buf() */
+#define HOSTLIST_NAME_LEN	(MAXHOSTNAMELEN + 16)
+
 /* largest configured system dimensions */
 #ifndef HIGHEST_DIMENSIONS
 #  define HIGHEST_DIMENSIONS 5
@@ -234,6 +242,20 @@ int hostlist_cmp_first(hostlist_t hl1, hostlist_t hl2);
  */
 char * hostlist_pop_range(hostlist_t hl);
 
+/* hostlist_shift_range_values():
+ *
+ * Shift the first range of hosts off of the hostlist hl without expanding it.
+ * prefix is set to the range prefix, lo and hi to the first and last numeric
+ * suffix and width to the zero padded suffix width, so each host in the range
+ * is "%s%0*lu" of prefix, width and a value from lo to hi. A host without a
+ * numeric suffix is returned whole in prefix with width set to -1.
+ * Caller is responsible for freeing prefix with free().
+ * Returns 0 if no ranges exist 1 otherwise.
+ */
+int hostlist_shift_range_values(hostlist_t hl, char **prefix,
+				unsigned long *lo, unsigned long *hi,
+				int *width);
+
 /* hostlist_pop_range_values():
  *
  * Pop the last range of hosts of the hostlist hl and fill in lo and hi with the
@@ -439,6 +461,15 @@ void hostlist_iterator_reset(hostlist_iterator_t i);
 char * hostlist_next_dims(hostlist_iterator_t i, int dims);
 char * hostlist_next(hostlist_iterator_t i);
 
+/* hostlist_next_buf():
+ *
+ * Same as hostlist_next(), but the hostname is written into buf of size bytes
+ * instead of newly allocated memory. A buffer of HOSTLIST_NAME_LEN bytes fits
+ * any hostname hostlist_next() could return.
+ * Returns buf, or NULL at the end of the list or if the name does not fit.
+ */
+char * hostlist_next_buf(hostlist_iterator_t i, char *buf, size_t size);
+
 
 /* hostlist_next_range():
  *
@@ -88,6 +88,12 @@ strong_alias(list_delete_item,	slurm_list_delete_item);
 #define LIST_MAGIC 0xDEADBEEF
 #define LIST_ITR_MAGIC 0xDEADBEFF
 
+/*
+ * Number of freed nodes each list keeps for reuse, so that queues with a
+ * steady push/pop rate do not allocate and free a node for every item.
+ */
+#define LIST_NODE_CACHE_MAX 16
+
 #define list_alloc() xmalloc(sizeof(struct xlist))
 #define list_free(_l) xfree(l)
 #define list_node_alloc() xmalloc(sizeof(struct listNode))
@@ -119,6 +125,9 @@ struct xlist {
 	struct listIterator  *iNext;        /* iterator chain for list_destroy() */
 	ListDelF              fDel;         /* function to delete node data      */
 	int                   count;        /* number of nodes in list           */
+	struct listNode      *free_nodes;   /* cache of unused nodes for reuse   */
+	int                   free_count;   /* number of nodes in the cache      */
+	struct listIterator  *free_itr;     /* unused iterator kept for reuse    */
 	pthread_mutex_t       mutex;        /* mutex to protect access to list   */
 };
 
@@ -155,6 +164,9 @@ list_create (ListDelF f)
 	l->iNext = NULL;
 	l->fDel = f;
 	l->count = 0;
+	l->free_nodes = NULL;
+	l->free_count = 0;
+	l->free_itr = NULL;
 	slurm_mutex_init(&l->mutex);
 
 	return l;
@@ -188,6 +200,14 @@ list_destroy (List l)
 		list_node_free(p);
 		p = pTmp;
 	}
+	p = l->free_nodes;
+	while (p) {
+		pTmp = p->next;
+		list_node_free(p);
+		p = pTmp;
+	}
+	if (l->free_itr)
+		list_iterator_free(l->free_itr);
 	l->magic = ~LIST_MAGIC;
 	slurm_mutex_unlock(&l->mutex);
 	slurm_mutex_destroy(&l->mutex);
@@ -657,13 +677,15 @@ list_iterator_create (List l)
 	ListIterator i;
 
 	xassert(l != NULL);
-	i = list_iterator_alloc();
-
-	i->magic = LIST_ITR_MAGIC;
-	i->list = l;
 	slurm_mutex_lock(&l->mutex);
 	xassert(l->magic == LIST_MAGIC);
 
+	if ((i = l->free_itr))
+		l->free_itr = NULL;
+	else
+		i = list_iterator_alloc();
+	i->magic = LIST_ITR_MAGIC;
+	i->list = l;
 	i->pos = l->head;
 	i->prev = &l->head;
 	i->iNext = l->iNext;
@@ -696,23 +718,31 @@ void
 list_iterator_destroy (ListIterator i)
 {
 	ListIterator *pi;
+	List l;
 
 	xassert(i != NULL);
 	xassert(i->magic == LIST_ITR_MAGIC);
-	slurm_mutex_lock(&i->list->mutex);
-	xassert(i->list->magic == LIST_MAGIC);
+	l = i->list;
+	slurm_mutex_lock(&l->mutex);
+	xassert(l->magic == LIST_MAGIC);
 
-	for (pi = &i->list->iNext; *pi; pi = &(*pi)->iNext) {
+	for (pi = &l->iNext; *pi; pi = &(*pi)->iNext) {
 		xassert((*pi)->magic == LIST_ITR_MAGIC);
 		if (*pi == i) {
 			*pi = (*pi)->iNext;
 			break;
 		}
 	}
-	slurm_mutex_unlock(&i->list->mutex);
-
 	i->magic = ~LIST_ITR_MAGIC;
-	list_iterator_free(i);
+	if (!l->free_itr) {
+		/* Keep one iterator around for the next walk of this list */
+		l->free_itr = i;
+		i = NULL;
+	}
+	slurm_mutex_unlock(&l->mutex);
+
+	if (i)
+		list_iterator_free(i);
 }
 
 /* list_next()
@@ -847,7 +877,11 @@ static void *_list_node_create(List l, ListNode *pp, void *x)
 	xassert(pp != NULL);
 	xassert(x != NULL);
 
-	p = list_node_alloc();
+	if ((p = l->free_nodes)) {
+		l->free_nodes = p->next;
+		l->free_count--;
+	} else
+		p = list_node_alloc();
 
 	p->data = x;
 	if (!(p->next = *pp))
@@ -903,7 +937,12 @@ static void *_list_node_destroy(List l, ListNode *pp)
 		xassert((i->pos == *i->prev) ||
 		       ((*i->prev) && (i->pos == (*i->prev)->next)));
 	}
-	list_node_free(p);
+	if (l->free_count < LIST_NODE_CACHE_MAX) {
+		p->next = l->free_nodes;
+		l->free_nodes = p;
+		l->free_count++;
+	} else
+		list_node_free(p);
 
 	return v;
 }
@@ -1123,6 +1123,16 @@ static void _log_msg(log_level_t level, bool sched, bool spank, const char *fmt,
 	char *msgbuf = NULL;
 	int priority = LOG_INFO;
 
+	if ((level > highest_log_level) &&
+	    (!sched || (highest_sched_log_level <= LOG_LEVEL_QUIET)))
+		return;
+
+	/*
+	 * Format the basic message before taking log_lock so that threads
+	 * logging at the same time only serialize on the actual writes.
+	 */
+	buf = vxstrfmt(fmt, args);
+
 	slurm_mutex_lock(&log_lock);
 
 	if (!LOG_INITIALIZED) {
@@ -1132,7 +1142,6 @@ static void _log_msg(log_level_t level, bool sched, bool spank, const char *fmt,
 
 	if (SCHED_LOG_INITIALIZED && sched &&
 	    (highest_sched_log_level > LOG_LEVEL_QUIET)) {
-		buf = vxstrfmt(fmt, args);
 		xlogfmtcat(&msgbuf, "[%M] %s%s%s", sched_log->fpfx, pfx, buf);
 		_log_printf(sched_log, sched_log->fbuf, sched_log->logfp,
 			    "sched: %s\n", msgbuf);
@@ -1198,12 +1207,6 @@ static void _log_msg(log_level_t level, bool sched, bool spank, const char *fmt,
 
 	}
 
-	if (!buf) {
-		/* format the basic message,
-		 * if not already done for scheduling log */
-		buf = vxstrfmt(fmt, args);
-	}
-
 	if (level <= log->opt.stderr_level) {
 
 		fflush(stdout);
@@ -56,12 +56,13 @@
 typedef struct {
 	pthread_mutex_t	aggr_mutex;
 	pthread_cond_t	cond;
-	bool		max_msgs;
+	bool		max_msgs;	/* msg_list is full, adders wait */
 	uint64_t        max_msg_cnt;
 	List            msg_aggr_list;
 	List            msg_list;
 	pthread_mutex_t	mutex;
 	slurm_addr_t    node_addr;
+	pthread_cond_t	resume_cond;	/* msg_list is no longer full */
 	bool            running;
 	pthread_t       thread_id;
 	uint64_t        window;
@@ -192,7 +193,12 @@ static int _send_to_next_collector(slurm_msg_t *msg)
  *
  *  Start and terminate message collection windows.
  *  Send collected msgs to next collector node or final destination
- *  at window expiration.
+ *  at window expiration, or as soon as max_msg_cnt msgs are collected.
+ *
+ *  The collection is swapped out before the composite msg is sent, so new
+ *  msgs, including composite msgs from nodes for which this node is the
+ *  collector, keep being collected while it is in flight. Adders only wait
+ *  if the next collection fills up before the send completes.
  */
 static void * _msg_aggregation_sender(void *arg)
 {
@@ -200,18 +206,21 @@ static void * _msg_aggregation_sender(void *arg)
 	struct timespec timeout;
 	slurm_msg_t msg;
 	composite_msg_t cmp;
+	int rc;
 
 	slurm_mutex_lock(&msg_collection.mutex);
 	msg_collection.running = 1;
 	slurm_cond_signal(&msg_collection.cond);
 
-	while (msg_collection.running) {
+	while (1) {
 		/* Wait for a new msg to be collected */
-		slurm_cond_wait(&msg_collection.cond, &msg_collection.mutex);
+		while (msg_collection.running &&
+		       !list_count(msg_collection.msg_list))
+			slurm_cond_wait(&msg_collection.cond,
+					&msg_collection.mutex);
 
-		if (!msg_collection.running &&
-		    !list_count(msg_collection.msg_list))
-			break;
+		if (!list_count(msg_collection.msg_list))
+			break;	/* Shutting down with nothing left */
 
 		/* A msg has been collected; start new window */
 		gettimeofday(&now, NULL);
@@ -222,17 +231,16 @@ static void * _msg_aggregation_sender(void *arg)
 		timeout.tv_sec += timeout.tv_nsec / NSEC_IN_SEC;
 		timeout.tv_nsec %= NSEC_IN_SEC;
 
-		slurm_cond_timedwait(&msg_collection.cond,
-				     &msg_collection.mutex, &timeout);
-
-		if (!msg_collection.running &&
-		    !list_count(msg_collection.msg_list))
-			break;
-
-		msg_collection.max_msgs = true;
+		while (msg_collection.running && !msg_collection.max_msgs) {
+			rc = pthread_cond_timedwait(&msg_collection.cond,
+						    &msg_collection.mutex,
+						    &timeout);
+			if (rc == ETIMEDOUT)
+				break;
+		}
 
-		/* Msg collection window has expired and message collection
-		 * is suspended; now build and send composite msg */
+		/* Msg collection window has expired; now build and send
+		 * composite msg while the next window collects */
 		memset(&msg, 0, sizeof(slurm_msg_t));
 		memset(&cmp, 0, sizeof(composite_msg_t));
 
@@ -243,20 +251,23 @@ static void * _msg_aggregation_sender(void *arg)
 		msg_collection.msg_list =
 			list_create(slurm_free_comp_msg_list);
 		msg_collection.max_msgs = false;
+		slurm_cond_broadcast(&msg_collection.resume_cond);
+		slurm_mutex_unlock(&msg_collection.mutex);
 
 		slurm_msg_t_init(&msg);
 		msg.msg_type = MESSAGE_COMPOSITE;
 		msg.protocol_version = SLURM_PROTOCOL_VERSION;
 		msg.data = &cmp;
 
+		log_flag(ROUTE, "msg aggr: %s: sending composite msg with %d msgs",
+			 __func__, list_count(cmp.msg_list));
 		if (_send_to_next_collector(&msg) != SLURM_SUCCESS) {
 			error("_msg_aggregation_engine: Unable to send "
 			      "composite msg: %m");
 		}
 		FREE_NULL_LIST(cmp.msg_list);
 
-		/* Resume message collection */
-		slurm_cond_broadcast(&msg_collection.cond);
+		slurm_mutex_lock(&msg_collection.mutex);
 	}
 
 	slurm_mutex_unlock(&msg_collection.mutex);
@@ -278,6 +289,7 @@ extern void msg_aggr_sender_init(char *host, uint16_t port, uint64_t window,
 	slurm_mutex_lock(&msg_collection.mutex);
 	slurm_mutex_lock(&msg_collection.aggr_mutex);
 	slurm_cond_init(&msg_collection.cond, NULL);
+	slurm_cond_init(&msg_collection.resume_cond, NULL);
 	slurm_set_addr(&msg_collection.node_addr, port, host);
 	msg_collection.window = window;
 	msg_collection.max_msg_cnt = max_msg_cnt;
@@ -316,12 +328,14 @@ extern void msg_aggr_sender_fini(void)
 	slurm_mutex_lock(&msg_collection.mutex);
 
 	slurm_cond_signal(&msg_collection.cond);
+	slurm_cond_broadcast(&msg_collection.resume_cond);
 	slurm_mutex_unlock(&msg_collection.mutex);
 
 	pthread_join(msg_collection.thread_id, NULL);
 	msg_collection.thread_id = (pthread_t) 0;
 
 	slurm_cond_destroy(&msg_collection.cond);
+	slurm_cond_destroy(&msg_collection.resume_cond);
 	/* signal and clear the waiting list */
 	slurm_mutex_lock(&msg_collection.aggr_mutex);
 	_handle_msg_aggr_ret(0, 1);
@@ -342,9 +356,9 @@ extern void msg_aggr_add_msg(slurm_msg_t *msg, bool wait,
 		return;
 
 	slurm_mutex_lock(&msg_collection.mutex);
-	if (msg_collection.max_msgs == true) {
-		slurm_cond_wait(&msg_collection.cond, &msg_collection.mutex);
-	}
+	while (msg_collection.max_msgs && msg_collection.running)
+		slurm_cond_wait(&msg_collection.resume_cond,
+				&msg_collection.mutex);
 
 	msg->msg_index = msg_index++;
 
@@ -49,6 +49,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <inttypes.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -68,6 +69,7 @@
 #include "src/common/slurm_acct_gather_energy.h"
 #include "src/common/slurm_ext_sensors.h"
 #include "src/common/slurm_topology.h"
+#include "src/common/working_cluster.h"
 #include "src/common/xassert.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
@@ -79,6 +81,20 @@ strong_alias(build_all_nodeline_info, slurm_build_all_nodeline_info);
 strong_alias(rehash_node, slurm_rehash_node);
 strong_alias(hostlist2bitmap, slurm_hostlist2bitmap);
 
+/*
+ * Run of node records with a common name prefix and consecutive numeric
+ * suffixes, lets node_name2bitmap() map a hostlist range straight to a range
+ * of bits instead of looking up every name in the range.
+ */
+typedef struct {
+	char *prefix;		/* node name up to the numeric suffix */
+	int len;		/* digits in the suffix */
+	bool padded;		/* suffix has leading zeros */
+	unsigned long lo;	/* suffix of the first node of the run */
+	unsigned long hi;	/* suffix of the last node of the run */
+	int inx;		/* node_record_table_ptr index of the first node */
+} node_range_t;
+
 /* Global variables */
 List config_list  = NULL;	/* list of config_record entries */
 List front_end_list = NULL;	/* list of slurm_conf_frontend_t entries */
@@ -89,6 +105,15 @@ int node_record_count = 0;		/* count in node_record_table_ptr */
 uint16_t *cr_node_num_cores = NULL;
 uint32_t *cr_node_cores_offset = NULL;
 
+static pthread_mutex_t node_range_mutex = PTHREAD_MUTEX_INITIALIZER;
+static node_range_t *node_ranges = NULL;
+static int node_range_cnt = -1;		/* -1 until built */
+
+/* last host list parsed by find_hostname() */
+static pthread_mutex_t find_host_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char *find_host_str = NULL;
+static hostlist_t find_host_list = NULL;
+
 /* Local function definitions */
 static int	_delete_config_record (void);
 #if _DEBUG
@@ -97,6 +122,7 @@ static void	_dump_hash (void);
 static node_record_t *_find_node_record(char *name, bool test_alias,
 					bool log_missing);
 static void	_list_delete_config (void *config_entry);
+static void	_node_ranges_free(void);
 static void _node_record_hash_identity (void* item, const char** key,
 					uint32_t* key_len);
 
@@ -665,6 +691,7 @@ extern node_record_t *create_node_record(config_record_t *config_ptr,
 	if (!node_hash_table)
 		node_hash_table = xhash_init(_node_record_hash_identity, NULL);
 	xhash_add(node_hash_table, node_ptr);
+	_node_ranges_free();
 
 	node_ptr->config_ptr = config_ptr;
 	/* these values will be overwritten when the node actually registers */
@@ -799,6 +826,7 @@ extern int init_node_conf (void)
 	node_record_count = 0;
 	xfree(node_record_table_ptr);
 	xhash_free(node_hash_table);
+	_node_ranges_free();
 
 	if (config_list)	/* delete defunct configuration entries */
 		(void) _delete_config_record ();
@@ -823,6 +851,7 @@ extern void node_fini2 (void)
 	}
 
 	xhash_free(node_hash_table);
+	_node_ranges_free();
 	node_ptr = node_record_table_ptr;
 	for (i = 0; i < node_record_count; i++, node_ptr++)
 		purge_node_rec(node_ptr);
@@ -832,6 +861,193 @@ extern void node_fini2 (void)
 }
 
 
+static void _node_ranges_free(void)
+{
+	int i;
+
+	slurm_mutex_lock(&node_range_mutex);
+	for (i = 0; i < node_range_cnt; i++)
+		xfree(node_ranges[i].prefix);
+	xfree(node_ranges);
+	node_range_cnt = -1;
+	slurm_mutex_unlock(&node_range_mutex);
+}
+
+static int _node_range_sort(const void *x, const void *y)
+{
+	const node_range_t *r1 = x, *r2 = y;
+	int diff;
+
+	if ((diff = xstrcmp(r1->prefix, r2->prefix)))
+		return diff;
+	if (r1->len != r2->len)
+		return (r1->len - r2->len);
+	if (r1->lo < r2->lo)
+		return -1;
+	if (r1->lo > r2->lo)
+		return 1;
+	return 0;
+}
+
+/* Split the node records into node_ranges, node_range_mutex must be locked */
+static void _node_ranges_build(void)
+{
+	node_record_t *node_ptr = node_record_table_ptr;
+	node_range_t *range = NULL;
+	char *suffix;
+	unsigned long num;
+	int i, len, prefix_len;
+	bool padded;
+
+	node_range_cnt = 0;
+	if (node_record_count <= 0)
+		return;
+	node_ranges = xcalloc(node_record_count, sizeof(node_range_t));
+	for (i = 0; i < node_record_count; i++, node_ptr++) {
+		if (!node_ptr->name || !node_ptr->name[0])
+			continue;	/* vestigial record */
+		prefix_len = strlen(node_ptr->name);
+		suffix = node_ptr->name + prefix_len;
+		while ((suffix > node_ptr->name) && isdigit((int) suffix[-1]))
+			suffix--;
+		len = prefix_len - (suffix - node_ptr->name);
+		if (!len || (len > 18)) {
+			range = NULL;
+			continue;
+		}
+		prefix_len -= len;
+		num = strtoul(suffix, NULL, 10);
+		padded = ((len > 1) && (suffix[0] == '0'));
+
+		if (range && (range->len == len) && (range->padded == padded) &&
+		    (num == (range->hi + 1)) &&
+		    (i == (range->inx + (range->hi - range->lo) + 1)) &&
+		    !strncmp(range->prefix, node_ptr->name, prefix_len) &&
+		    !range->prefix[prefix_len]) {
+			range->hi = num;
+			continue;
+		}
+		range = &node_ranges[node_range_cnt++];
+		range->prefix = xstrndup(node_ptr->name, prefix_len);
+		range->len = len;
+		range->padded = padded;
+		range->lo = range->hi = num;
+		range->inx = i;
+	}
+	qsort(node_ranges, node_range_cnt, sizeof(node_range_t),
+	      _node_range_sort);
+}
+
+/*
+ * Set the bits of the nodes named prefix[lo-hi] with width digits, without
+ * expanding the names.
+ * RET true if every name in the range was found in node_ranges
+ */
+static bool _node_range_set(bitstr_t *bitmap, char *prefix,
+			    unsigned long lo, unsigned long hi, int width)
+{
+	node_range_t *ranges;
+	unsigned long found = 0, first, last;
+	int cnt, len, low, high, mid, diff, i;
+
+	/* Held until done, _node_ranges_free() may run concurrently */
+	slurm_mutex_lock(&node_range_mutex);
+	if (node_range_cnt < 0)
+		_node_ranges_build();
+	ranges = node_ranges;
+	cnt = node_range_cnt;
+
+	/*
+	 * Host "%s%0*lu" matches a node with len suffix digits if len equals
+	 * the width, or if len is wider and the node is not zero padded.
+	 */
+	for (len = MAX(width, 1); len <= 18; len++) {
+		low = 0;
+		high = cnt;
+		while (low < high) {
+			mid = (low + high) / 2;
+			if (!(diff = xstrcmp(ranges[mid].prefix, prefix)))
+				diff = ranges[mid].len - len;
+			if (!diff)
+				diff = (ranges[mid].hi < lo) ? -1 : 1;
+			if (diff < 0)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+		for (i = low; (i < cnt) && (ranges[i].len == len) &&
+			     (ranges[i].lo <= hi) &&
+			     !xstrcmp(ranges[i].prefix, prefix); i++) {
+			if ((len != width) && ranges[i].padded)
+				continue;
+			first = MAX(lo, ranges[i].lo);
+			last = MIN(hi, ranges[i].hi);
+			bit_nset(bitmap, ranges[i].inx + (first - ranges[i].lo),
+				 ranges[i].inx + (last - ranges[i].lo));
+			found += last - first + 1;
+		}
+	}
+	slurm_mutex_unlock(&node_range_mutex);
+
+	return (found == (hi - lo + 1));
+}
+
+static void _node_name_set(bitstr_t *bitmap, char *name, bool best_effort,
+			   int *rc, const char *caller)
+{
+	node_record_t *node_ptr;
+
+	node_ptr = _find_node_record(name, best_effort, true);
+	if (node_ptr) {
+		bit_set(bitmap, (bitoff_t) (node_ptr - node_record_table_ptr));
+	} else {
+		error("%s: invalid node specified %s", caller, name);
+		if (!best_effort)
+			*rc = EINVAL;
+	}
+}
+
+/*
+ * Set the bits for all hosts in host_list, consuming it. Ranges with numeric
+ * suffixes are mapped with _node_range_set(), names are only expanded and
+ * looked up one at a time if the range is not entirely known.
+ */
+static int _hostlist_set_bits(hostlist_t host_list, bool best_effort,
+			      bitstr_t *bitmap, const char *caller)
+{
+	int rc = SLURM_SUCCESS;
+	char *prefix, *name;
+	unsigned long lo, hi, num;
+	int width;
+
+	if (slurmdb_setup_cluster_name_dims() > 1) {
+		while ((name = hostlist_shift(host_list))) {
+			_node_name_set(bitmap, name, best_effort, &rc, caller);
+			free(name);
+		}
+		return rc;
+	}
+
+	while (hostlist_shift_range_values(host_list, &prefix, &lo, &hi,
+					   &width)) {
+		if (width < 0) {
+			_node_name_set(bitmap, prefix, best_effort, &rc,
+				       caller);
+		} else if (!_node_range_set(bitmap, prefix, lo, hi, width)) {
+			for (num = lo; num <= hi; num++) {
+				name = xstrdup_printf("%s%0*lu", prefix, width,
+						      num);
+				_node_name_set(bitmap, name, best_effort, &rc,
+					       caller);
+				xfree(name);
+			}
+		}
+		free(prefix);
+	}
+
+	return rc;
+}
+
 /*
  * node_name2bitmap - given a node name regular expression, build a bitmap
  *	representation
@@ -845,7 +1061,6 @@ extern int node_name2bitmap (char *node_names, bool best_effort,
 			     bitstr_t **bitmap)
 {
 	int rc = SLURM_SUCCESS;
-	char *this_node_name;
 	bitstr_t *my_bitmap;
 	hostlist_t host_list;
 
@@ -865,20 +1080,8 @@ extern int node_name2bitmap (char *node_names, bool best_effort,
 		return rc;
 	}
 
-	while ( (this_node_name = hostlist_shift (host_list)) ) {
-		node_record_t *node_ptr;
-		node_ptr = _find_node_record(this_node_name, best_effort, true);
-		if (node_ptr) {
-			bit_set (my_bitmap, (bitoff_t) (node_ptr -
-							node_record_table_ptr));
-		} else {
-			error ("node_name2bitmap: invalid node specified %s",
-			       this_node_name);
-			if (!best_effort)
-				rc = EINVAL;
-		}
-		free (this_node_name);
-	}
+	rc = _hostlist_set_bits(host_list, best_effort, my_bitmap,
+				"node_name2bitmap");
 	hostlist_destroy (host_list);
 
 	return rc;
@@ -893,34 +1096,20 @@ extern int node_name2bitmap (char *node_names, bool best_effort,
  */
 extern int hostlist2bitmap (hostlist_t hl, bool best_effort, bitstr_t **bitmap)
 {
-	int rc = SLURM_SUCCESS;
+	int rc;
 	bitstr_t *my_bitmap;
-	char *name;
-	hostlist_iterator_t hi;
+	hostlist_t host_list;
 
 	FREE_NULL_BITMAP(*bitmap);
 	my_bitmap = (bitstr_t *) bit_alloc (node_record_count);
 	*bitmap = my_bitmap;
 
-	hi = hostlist_iterator_create(hl);
-	while ((name = hostlist_next(hi))) {
-		node_record_t *node_ptr;
-		node_ptr = _find_node_record(name, best_effort, true);
-		if (node_ptr) {
-			bit_set (my_bitmap, (bitoff_t) (node_ptr -
-							node_record_table_ptr));
-		} else {
-			error ("hostlist2bitmap: invalid node specified %s",
-			       name);
-			if (!best_effort)
-				rc = EINVAL;
-		}
-		free (name);
-	}
+	host_list = hostlist_copy(hl);
+	rc = _hostlist_set_bits(host_list, best_effort, my_bitmap,
+				"hostlist2bitmap");
+	hostlist_destroy(host_list);
 
-	hostlist_iterator_destroy(hi);
 	return rc;
-
 }
 
 /* Purge the contents of a node record */
@@ -959,6 +1148,7 @@ extern void rehash_node (void)
 	node_record_t *node_ptr = node_record_table_ptr;
 
 	xhash_free (node_hash_table);
+	_node_ranges_free();
 	node_hash_table = xhash_init(_node_record_hash_identity, NULL);
 	for (i = 0; i < node_record_count; i++, node_ptr++) {
 		if ((node_ptr->name == NULL) ||
@@ -1093,18 +1283,28 @@ extern int adjust_cpus_nppcu(uint16_t ntasks_per_core, int cpus_per_task,
 
 extern char *find_hostname(uint32_t pos, char *hosts)
 {
-	hostlist_t hostlist = NULL;
 	char *temp = NULL, *host = NULL;
 
 	if (!hosts || (pos == NO_VAL) || (pos == INFINITE))
 		return NULL;
 
-	hostlist = hostlist_create(hosts);
-	temp = hostlist_nth(hostlist, pos);
+	/*
+	 * Callers (e.g. sacct and sstat) look up several positions in the same
+	 * host list in a row, only parse it when it changes.
+	 */
+	slurm_mutex_lock(&find_host_mutex);
+	if (!find_host_list || xstrcmp(hosts, find_host_str)) {
+		FREE_NULL_HOSTLIST(find_host_list);
+		xfree(find_host_str);
+		find_host_list = hostlist_create(hosts);
+		find_host_str = xstrdup(hosts);
+	}
+	temp = hostlist_nth(find_host_list, pos);
+	slurm_mutex_unlock(&find_host_mutex);
+
 	if (temp) {
 		host = xstrdup(temp);
 		free(temp);
 	}
-	hostlist_destroy(hostlist);
 	return host;
 }
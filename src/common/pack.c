@@ -162,6 +162,15 @@ Buf create_mmap_buf(char *file)
 		return NULL;
 	}
 
+	/*
+	 * State files are unpacked start to end. Have the kernel read the
+	 * whole file ahead rather than fault it in a page at a time, which
+	 * is slow with large files on shared file systems.
+	 */
+	if (madvise(data, f_stat.st_size, MADV_SEQUENTIAL) ||
+	    madvise(data, f_stat.st_size, MADV_WILLNEED))
+		debug2("%s: madvise(`%s`): %m", __func__, file);
+
 	my_buf = xmalloc_nz(sizeof(struct slurm_buf));
 	my_buf->magic = BUF_MAGIC;
 	my_buf->size = f_stat.st_size;
@@ -189,6 +198,26 @@ void free_buf(Buf my_buf)
 	xfree(my_buf);
 }
 
+/*
+ * Make room for size more bytes in buffer, growing it if needed.
+ * Used by the array packers so they check the buffer once per array rather
+ * than once per element.
+ * RET false if the buffer would exceed MAX_BUF_SIZE
+ */
+static bool _buf_reserve(Buf buffer, uint64_t size, const char *caller)
+{
+	if (remaining_buf(buffer) >= size)
+		return true;
+	if ((buffer->size + size + BUF_SIZE) > MAX_BUF_SIZE) {
+		error("%s: Buffer size limit exceeded (%"PRIu64" > %u)",
+		      caller, (buffer->size + size + BUF_SIZE), MAX_BUF_SIZE);
+		return false;
+	}
+	buffer->size += size + BUF_SIZE;
+	xrealloc_nz(buffer->head, buffer->size);
+	return true;
+}
+
 /* Grow a buffer by the specified amount */
 void grow_buf (Buf buffer, uint32_t size)
 {
@@ -500,13 +529,20 @@ int unpack32(uint32_t * valp, Buf buffer)
 void pack16_array(uint16_t * valp, uint32_t size_val, Buf buffer)
 {
 	uint32_t i = 0;
+	uint16_t ns;
 
 	xassert(valp || !size_val);
 
+	if (!_buf_reserve(buffer, sizeof(uint32_t) +
+			  ((uint64_t) size_val * sizeof(ns)), __func__))
+		return;
+
 	pack32(size_val, buffer);
 
 	for (i = 0; i < size_val; i++) {
-		pack16(*(valp + i), buffer);
+		ns = htons(valp[i]);
+		memcpy(&buffer->head[buffer->processed], &ns, sizeof(ns));
+		buffer->processed += sizeof(ns);
 	}
 }
 
@@ -522,10 +558,16 @@ int unpack16_array(uint16_t ** valp, uint32_t * size_val, Buf buffer)
 	if ((*size_val) > MAX_ARRAY_LEN_MEDIUM)
 		return SLURM_ERROR;
 
+	if (remaining_buf(buffer) < ((*size_val) * sizeof(uint16_t)))
+		return SLURM_ERROR;
+
 	*valp = xmalloc_nz((*size_val) * sizeof(uint16_t));
 	for (i = 0; i < *size_val; i++) {
-		if (unpack16((*valp) + i, buffer))
-			return SLURM_ERROR;
+		uint16_t ns;
+
+		memcpy(&ns, &buffer->head[buffer->processed], sizeof(ns));
+		buffer->processed += sizeof(ns);
+		(*valp)[i] = ntohs(ns);
 	}
 	return SLURM_SUCCESS;
 }
@@ -536,13 +578,20 @@ int unpack16_array(uint16_t ** valp, uint32_t * size_val, Buf buffer)
 void pack32_array(uint32_t * valp, uint32_t size_val, Buf buffer)
 {
 	uint32_t i = 0;
+	uint32_t nl;
 
 	xassert(valp || !size_val);
 
+	if (!_buf_reserve(buffer, sizeof(nl) +
+			  ((uint64_t) size_val * sizeof(nl)), __func__))
+		return;
+
 	pack32(size_val, buffer);
 
 	for (i = 0; i < size_val; i++) {
-		pack32(*(valp + i), buffer);
+		nl = htonl(valp[i]);
+		memcpy(&buffer->head[buffer->processed], &nl, sizeof(nl));
+		buffer->processed += sizeof(nl);
 	}
 }
 
@@ -558,10 +607,16 @@ int unpack32_array(uint32_t ** valp, uint32_t * size_val, Buf buffer)
 	if ((*size_val) > MAX_ARRAY_LEN_LARGE)
 		return SLURM_ERROR;
 
+	if (remaining_buf(buffer) < ((*size_val) * sizeof(uint32_t)))
+		return SLURM_ERROR;
+
 	*valp = xmalloc_nz((*size_val) * sizeof(uint32_t));
 	for (i = 0; i < *size_val; i++) {
-		if (unpack32((*valp) + i, buffer))
-			return SLURM_ERROR;
+		uint32_t nl;
+
+		memcpy(&nl, &buffer->head[buffer->processed], sizeof(nl));
+		buffer->processed += sizeof(nl);
+		(*valp)[i] = ntohl(nl);
 	}
 	return SLURM_SUCCESS;
 }
@@ -572,13 +627,20 @@ int unpack32_array(uint32_t ** valp, uint32_t * size_val, Buf buffer)
 void pack64_array(uint64_t * valp, uint32_t size_val, Buf buffer)
 {
 	uint32_t i = 0;
+	uint64_t nl;
 
 	xassert(valp || !size_val);
 
+	if (!_buf_reserve(buffer, sizeof(uint32_t) +
+			  ((uint64_t) size_val * sizeof(nl)), __func__))
+		return;
+
 	pack32(size_val, buffer);
 
 	for (i = 0; i < size_val; i++) {
-		pack64(*(valp + i), buffer);
+		nl = HTON_uint64(valp[i]);
+		memcpy(&buffer->head[buffer->processed], &nl, sizeof(nl));
+		buffer->processed += sizeof(nl);
 	}
 }
 
@@ -610,10 +672,16 @@ int unpack64_array(uint64_t ** valp, uint32_t * size_val, Buf buffer)
 	if ((*size_val) > MAX_ARRAY_LEN_MEDIUM)
 		return SLURM_ERROR;
 
+	if (remaining_buf(buffer) < ((*size_val) * sizeof(uint64_t)))
+		return SLURM_ERROR;
+
 	*valp = xmalloc_nz((*size_val) * sizeof(uint64_t));
 	for (i = 0; i < *size_val; i++) {
-		if (unpack64((*valp) + i, buffer))
-			return SLURM_ERROR;
+		uint64_t nl;
+
+		memcpy(&nl, &buffer->head[buffer->processed], sizeof(nl));
+		buffer->processed += sizeof(nl);
+		(*valp)[i] = NTOH_uint64(nl);
 	}
 	return SLURM_SUCCESS;
 }
@@ -1017,32 +1085,34 @@ int unpackstr_xmalloc_escaped(char **valp, uint32_t *size_valp, Buf buffer)
 		      __func__, *size_valp, MAX_PACK_MEM_LEN);
 		return SLURM_ERROR;
 	} else if (*size_valp > 0) {
-		uint32_t cnt = *size_valp;
+		uint32_t cnt = *size_valp, len, esc = 0;
+		char *copy, *str, tmp;
+		uint32_t i;
 
 		if (remaining_buf(buffer) < cnt)
 			return SLURM_ERROR;
 
-		/* make a buffer 2 times the size just to be safe */
-		*valp = xmalloc_nz((cnt * 2) + 1);
-		if (*valp) {
-			char *copy = NULL, *str, tmp;
-			uint32_t i;
-			copy = *valp;
-			str = &buffer->head[buffer->processed];
-
-			for (i = 0; i < cnt && *str; i++) {
-				tmp = *str++;
-				if ((tmp == '\\') || (tmp == '\'')) {
-					*copy++ = '\\';
-					(*size_valp)++;
-				}
-
-				*copy++ = tmp;
-			}
-
-			/* Since we used xmalloc_nz, terminate the string. */
-			*copy++ = '\0';
+		/*
+		 * Size the copy exactly rather than doubling it, this runs
+		 * for every string slurmdbd unpacks.
+		 */
+		str = &buffer->head[buffer->processed];
+		for (len = 0; (len < cnt) && str[len]; len++) {
+			if ((str[len] == '\\') || (str[len] == '\''))
+				esc++;
+		}
+
+		copy = *valp = xmalloc_nz(len + esc + 1);
+		for (i = 0; i < len; i++) {
+			tmp = *str++;
+			if ((tmp == '\\') || (tmp == '\''))
+				*copy++ = '\\';
+			*copy++ = tmp;
 		}
+		*size_valp += esc;
+
+		/* Since we used xmalloc_nz, terminate the string. */
+		*copy = '\0';
 
 		/* add the original value since that is what we processed */
 		buffer->processed += cnt;
@@ -1117,7 +1187,8 @@ int unpackstr_array(char ***valp, uint32_t * size_valp, Buf buffer)
 		return SLURM_ERROR;
 	}
 	else if (*size_valp > 0) {
-		*valp = xmalloc_nz(sizeof(char *) * (*size_valp + 1));
+		/* zeroed so a partial unpack can be freed by the caller */
+		*valp = xcalloc(*size_valp + 1, sizeof(char *));
 		for (i = 0; i < *size_valp; i++) {
 			if (unpackmem_xmalloc(&(*valp)[i], &uint32_tmp, buffer))
 				return SLURM_ERROR;
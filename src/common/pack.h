@@ -291,7 +291,7 @@ int	unpackmem_array(char *valp, uint32_t size_valp, Buf buffer);
 	if (bitmap) {					\
 		char *_tmp_str;				\
 		uint32_t _size;				\
-		_tmp_str = bit_fmt_hexmask(bitmap);	\
+		_tmp_str = bit_fmt_hexmask_trim(bitmap);\
 		_size = bit_size(bitmap);               \
 		pack32(_size, buf);              	\
 		_size = strlen(_tmp_str)+1;		\
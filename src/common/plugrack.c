@@ -38,6 +38,7 @@
 \*****************************************************************************/
 
 #include <dirent.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
@@ -88,6 +89,23 @@ struct _plugrack {
 	const char *major_type;
 };
 
+/*
+ * Result of scanning one plugin directory for one major type. Scanning
+ * stat()s and dlopen()s every matching file, and is repeated for every rack
+ * that falls back to it (e.g. one for every GRES name lacking a plugin of its
+ * own), so scan results are kept for the life of the process.
+ *
+ * paths is a list of plugrack_entry_t with only full_type and fq_path set.
+ */
+typedef struct {
+	char *dir;
+	char *major_type;
+	List paths;
+} plugrack_scan_t;
+
+static List scan_cache = NULL;
+static pthread_mutex_t scan_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
 static bool _match_major(const char *path_name, const char *major_type);
 static int _plugrack_read_single_dir(plugrack_t *rack, char *dir);
 static bool _so_file(char *pathname);
@@ -125,6 +143,28 @@ plugrack_t *plugrack_create(const char *major_type)
 	return rack;
 }
 
+static void _scan_destructor(void *v)
+{
+	plugrack_scan_t *scan = v;
+
+	xfree(scan->dir);
+	xfree(scan->major_type);
+	FREE_NULL_LIST(scan->paths);
+	xfree(scan);
+}
+
+static int _find_scan(void *x, void *key)
+{
+	plugrack_scan_t *scan = x;
+	plugrack_t *rack = ((void **) key)[0];
+	char *dir = ((void **) key)[1];
+
+	if (!xstrcmp(scan->dir, dir) &&
+	    !xstrcmp(scan->major_type, rack->major_type))
+		return 1;
+	return 0;
+}
+
 int plugrack_destroy(plugrack_t *rack)
 {
 	ListIterator it;
@@ -155,6 +195,19 @@ int plugrack_destroy(plugrack_t *rack)
 	return SLURM_SUCCESS;
 }
 
+static int _add_scan_path(plugrack_scan_t *scan, const char *full_type,
+			  const char *fq_path)
+{
+	plugrack_entry_t *e = xmalloc(sizeof(*e));
+
+	e->full_type = xstrdup(full_type);
+	e->fq_path   = xstrdup(fq_path);
+	e->plug      = PLUGIN_INVALID_HANDLE;
+	list_append(scan->paths, e);
+
+	return SLURM_SUCCESS;
+}
+
 static int plugrack_add_plugin_path(plugrack_t *rack,
 				    const char *full_type,
 				    const char *fq_path)
@@ -204,6 +257,13 @@ int plugrack_read_dir(plugrack_t *rack, const char *dir)
 	return rc;
 }
 
+static int _add_cached_path(void *x, void *arg)
+{
+	plugrack_entry_t *e = x;
+
+	return plugrack_add_plugin_path(arg, e->full_type, e->fq_path);
+}
+
 static int _plugrack_read_single_dir(plugrack_t *rack, char *dir)
 {
 	char *fq_path;
@@ -214,6 +274,17 @@ static int _plugrack_read_single_dir(plugrack_t *rack, char *dir)
 	static const size_t type_len = 64;
 	char plugin_type[type_len];
 	static int max_path_len = 0;
+	plugrack_scan_t *scan;
+	void *key[2] = { rack, dir };
+
+	slurm_mutex_lock(&scan_cache_lock);
+	if (!scan_cache)
+		scan_cache = list_create(_scan_destructor);
+	if ((scan = list_find_first(scan_cache, _find_scan, key))) {
+		list_for_each(scan->paths, _add_cached_path, rack);
+		slurm_mutex_unlock(&scan_cache_lock);
+		return SLURM_SUCCESS;
+	}
 
 	/* Allocate a buffer for fully-qualified path names. */
 	if (max_path_len == 0) {
@@ -236,11 +307,17 @@ static int _plugrack_read_single_dir(plugrack_t *rack, char *dir)
 	/* Open the directory. */
 	dirp = opendir(dir);
 	if (dirp == NULL) {
+		slurm_mutex_unlock(&scan_cache_lock);
 		error("cannot open plugin directory %s", dir);
 		xfree(fq_path);
 		return SLURM_ERROR;
 	}
 
+	scan = xmalloc(sizeof(*scan));
+	scan->dir = xstrdup(dir);
+	scan->major_type = xstrdup(rack->major_type);
+	scan->paths = list_create(plugrack_entry_destructor);
+
 	while (1) {
 		e = readdir(dirp);
 		if (e == NULL)
@@ -254,10 +331,8 @@ static int _plugrack_read_single_dir(plugrack_t *rack, char *dir)
 		 */
 		strcpy(tail, e->d_name);
 
-		/* Check only regular files. */
-		if ((xstrncmp(e->d_name, ".", 1) == 0) ||
-		    (stat(fq_path, &st) < 0) ||
-		    (!S_ISREG(st.st_mode)))
+		/* Skip hidden files */
+		if (xstrncmp(e->d_name, ".", 1) == 0)
 			continue;
 
 		/* Check only shared object files */
@@ -272,6 +347,10 @@ static int _plugrack_read_single_dir(plugrack_t *rack, char *dir)
 		    (!_match_major(e->d_name, rack->major_type)))
 			continue;
 
+		/* Check only regular files, this is the costly test */
+		if ((stat(fq_path, &st) < 0) || (!S_ISREG(st.st_mode)))
+			continue;
+
 		/* Test the type. */
 		if (plugin_peek(fq_path, plugin_type, type_len, NULL) ==
 		    SLURM_ERROR) {
@@ -286,9 +365,12 @@ static int _plugrack_read_single_dir(plugrack_t *rack, char *dir)
 
 		/* Add it to the list. */
 		(void) plugrack_add_plugin_path(rack, plugin_type, fq_path);
+		(void) _add_scan_path(scan, plugin_type, fq_path);
 	}
 
 	closedir(dirp);
+	list_append(scan_cache, scan);
+	slurm_mutex_unlock(&scan_cache_lock);
 
 	xfree(fq_path);
 	return SLURM_SUCCESS;
@@ -154,6 +154,13 @@ typedef enum step_fn {
 	SPANK_EXIT
 } step_fn_t;
 
+static const step_fn_t spank_step_fns[] = {
+	SPANK_INIT, SPANK_JOB_PROLOG, SPANK_INIT_POST_OPT, LOCAL_USER_INIT,
+	STEP_USER_INIT, STEP_TASK_INIT_PRIV, STEP_USER_TASK_INIT,
+	STEP_TASK_POST_FORK, STEP_TASK_EXIT, SPANK_JOB_EPILOG,
+	SPANK_SLURMD_EXIT, SPANK_EXIT
+};
+
 /*
  *  Job information in prolog/epilog context:
  */
@@ -183,6 +190,7 @@ struct spank_stack {
 	List option_cache;           /*  Cache of plugin options in this ctx */
 	int  spank_optval;           /*  optvalue for next plugin option     */
 	const char * plugin_path;    /*  default path to search for plugins  */
+	uint32_t hook_mask;          /*  step_fn_t bits some plugin defines  */
 };
 
 /*
@@ -202,6 +210,7 @@ static int spank_stack_get_remote_options_env (struct spank_stack *, char **);
 static int spank_stack_set_remote_options_env (struct spank_stack * stack);
 static int dyn_spank_set_job_env (const char *var, const char *val, int ovwt);
 static char *_opt_env_name(struct spank_plugin_opt *p, char *buf, size_t siz);
+static spank_f *spank_plugin_get_fn (struct spank_plugin *sp, step_fn_t type);
 
 static void spank_stack_destroy (struct spank_stack *stack)
 {
@@ -469,7 +478,7 @@ _spank_stack_process_line(struct spank_stack *stack,
 	const char *file, int line, char *buf)
 {
 	char **argv;
-	int ac;
+	int ac, i;
 	char *path;
 	cf_line_t type = CF_REQUIRED;
 	bool required;
@@ -531,6 +540,15 @@ _spank_stack_process_line(struct spank_stack *stack,
 	list_append (stack->plugin_list, p);
 	_spank_plugin_options_cache(p);
 
+	/*
+	 *  Remember which hooks are defined so phases with none, like the
+	 *   per task hooks of most sites, skip the stack entirely.
+	 */
+	for (i = 0; i < sizeof(spank_step_fns) / sizeof(step_fn_t); i++) {
+		if (spank_plugin_get_fn (p, spank_step_fns[i]))
+			stack->hook_mask |= (1 << spank_step_fns[i]);
+	}
+
 	return (0);
 }
 
@@ -721,6 +739,9 @@ static int _do_call_stack(struct spank_stack *stack,
 	if (!stack)
 		return (-1);
 
+	if (!(stack->hook_mask & (1 << type)))
+		return (0);
+
 	if (_spank_handle_init(spank, stack, job, taskid, type) < 0) {
 		error("spank: Failed to initialize handle for plugins");
 		return (-1);
@@ -732,6 +753,7 @@ static int _do_call_stack(struct spank_stack *stack,
 	while ((sp = list_next(i))) {
 		const char *name = xbasename(sp->fq_path);
 		spank_f *spank_fn;
+		struct timeval tv1, tv2;
 
 		spank->plugin = sp;
 
@@ -739,8 +761,12 @@ static int _do_call_stack(struct spank_stack *stack,
 		if (!spank_fn)
 			continue;
 
+		gettimeofday(&tv1, NULL);
 		rc = (*spank_fn) (spank, sp->ac, sp->argv);
-		debug2("spank: %s: %s = %d", name, fn_name, rc);
+		gettimeofday(&tv2, NULL);
+		debug2("spank: %s: %s = %d (%ld usec)", name, fn_name, rc,
+		       ((tv2.tv_sec - tv1.tv_sec) * 1000000L) +
+		       (tv2.tv_usec - tv1.tv_usec));
 
 		if ((rc < 0) && sp->required) {
 			error("spank: required plugin %s: "
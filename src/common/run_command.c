@@ -42,6 +42,7 @@
 #include <signal.h>
 #include <stdlib.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -100,6 +101,34 @@ static int _tot_wait (struct timeval *start_time)
 	return msec_delay;
 }
 
+/*
+ * Close every file descriptor numbered first_fd or above except keep_fd
+ * (-1 for none). Use the close_range() system call when available so that
+ * a daemon with a large RLIMIT_NOFILE does not make millions of close()
+ * calls for every script it runs. Only async-signal-safe calls are made
+ * here.
+ */
+static void _close_fds_from(int first_fd, int keep_fd)
+{
+	int fd, max_fd;
+
+#ifdef SYS_close_range
+	if (keep_fd < first_fd) {
+		if (syscall(SYS_close_range, first_fd, ~0U, 0) == 0)
+			return;
+	} else if (((keep_fd == first_fd) ||
+		    !syscall(SYS_close_range, first_fd, keep_fd - 1, 0)) &&
+		   !syscall(SYS_close_range, keep_fd + 1, ~0U, 0)) {
+		return;
+	}
+#endif
+	max_fd = sysconf(_SC_OPEN_MAX);
+	for (fd = first_fd; fd < max_fd; fd++) {
+		if (fd != keep_fd)
+			close(fd);
+	}
+}
+
 /* Execute a script, wait for termination and return its stdout.
  * script_type IN - Type of program being run (e.g. "StartStageIn")
  * script_path IN - Fully qualified pathname of the program to execute
@@ -113,10 +142,10 @@ extern char *run_command(char *script_type, char *script_path,
 			 char **script_argv, int max_wait,
 			 pthread_t tid, int *status)
 {
-	int i, new_wait, resp_size = 0, resp_offset = 0;
+	int i, new_wait, resp_size = 0, resp_offset = 0, exec_errno;
 	pid_t cpid;
 	char *resp = NULL;
-	int pfd[2] = { -1, -1 };
+	int pfd[2] = { -1, -1 }, efd[2] = { -1, -1 };
 
 	if ((script_path == NULL) || (script_path[0] == '\0')) {
 		error("%s: no script specified", __func__);
@@ -145,38 +174,64 @@ extern char *run_command(char *script_type, char *script_path,
 			resp = xstrdup("System error");
 			return resp;
 		}
+		/*
+		 * The child can not log after vfork(), so it reports the
+		 * errno of a failed execv() through this close-on-exec pipe.
+		 */
+		if ((pipe(efd) != 0) ||
+		    (fcntl(efd[1], F_SETFD, FD_CLOEXEC) < 0)) {
+			error("%s: pipe(): %m", __func__);
+			close(pfd[0]);
+			close(pfd[1]);
+			if (efd[0] >= 0) {
+				close(efd[0]);
+				close(efd[1]);
+			}
+			*status = 127;
+			resp = xstrdup("System error");
+			return resp;
+		}
 	}
 	slurm_mutex_lock(&proc_count_mutex);
 	child_proc_count++;
 	slurm_mutex_unlock(&proc_count_mutex);
-	if ((cpid = fork()) == 0) {
-		int cc;
-
-		cc = sysconf(_SC_OPEN_MAX);
+	/*
+	 * The synchronous child only rearranges its descriptors before
+	 * calling execv(), so vfork() avoids copying the page tables of a
+	 * potentially very large daemon. The asynchronous path must fork()
+	 * twice and so can not use it.
+	 */
+	if (max_wait != -1)
+		cpid = vfork();
+	else
+		cpid = fork();
+	if (cpid == 0) {
 		if (max_wait != -1) {
 			dup2(pfd[1], STDERR_FILENO);
 			dup2(pfd[1], STDOUT_FILENO);
-			for (i = 0; i < cc; i++) {
-				if ((i != STDERR_FILENO) &&
-				    (i != STDOUT_FILENO))
-					close(i);
-			}
+			close(STDIN_FILENO);
+			_close_fds_from(STDERR_FILENO + 1, efd[1]);
 		} else {
-			for (i = 0; i < cc; i++)
-				close(i);
+			_close_fds_from(0, -1);
 			if ((cpid = fork()) < 0)
-				exit(127);
+				_exit(127);
 			else if (cpid > 0)
-				exit(0);
+				_exit(0);
 		}
 		setpgid(0, 0);
 		execv(script_path, script_argv);
-		error("%s: execv(%s): %m", __func__, script_path);
-		exit(127);
+		/* Nothing which is not async-signal-safe after vfork() */
+		if (max_wait != -1) {
+			exec_errno = errno;
+			(void) write(efd[1], &exec_errno, sizeof(exec_errno));
+		}
+		_exit(127);
 	} else if (cpid < 0) {
 		if (max_wait != -1) {
 			close(pfd[0]);
 			close(pfd[1]);
+			close(efd[0]);
+			close(efd[1]);
 		}
 		error("%s: fork(): %m", __func__);
 		slurm_mutex_lock(&proc_count_mutex);
@@ -188,6 +243,14 @@ extern char *run_command(char *script_type, char *script_path,
 		resp_size = 1024;
 		resp = xmalloc(resp_size);
 		close(pfd[1]);
+		/* vfork() returns once the child called execv() or exited */
+		close(efd[1]);
+		if (read(efd[0], &exec_errno, sizeof(exec_errno)) ==
+		    sizeof(exec_errno)) {
+			errno = exec_errno;
+			error("%s: execv(%s): %m", __func__, script_path);
+		}
+		close(efd[0]);
 		gettimeofday(&tstart, NULL);
 		if (tid)
 			track_script_reset_cpid(tid, cpid);
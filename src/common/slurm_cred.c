@@ -62,6 +62,7 @@
 #include "src/common/slurm_time.h"
 #include "src/common/uid.h"
 #include "src/common/xassert.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
@@ -89,12 +90,16 @@ typedef struct sbcast_cred sbcast_cred_t;		/* opaque data type */
  *
  */
 typedef struct {
-	time_t   ctime;		/* Time that the cred was created	*/
-	time_t   expiration;    /* Time at which cred is no longer good	*/
+	/* jobid, stepid and ctime must stay first, see CRED_STATE_KEY_LEN */
 	uint32_t jobid;		/* Slurm job id for this credential	*/
 	uint32_t stepid;	/* Slurm step id for this credential	*/
+	time_t   ctime;		/* Time that the cred was created	*/
+	time_t   expiration;    /* Time at which cred is no longer good	*/
 } cred_state_t;
 
+/* Length of the (jobid, stepid, ctime) hash key of a cred_state_t */
+#define CRED_STATE_KEY_LEN (offsetof(cred_state_t, ctime) + sizeof(time_t))
+
 /*
  * slurm job state information
  * tracks jobids for which all future credentials have been revoked
@@ -147,7 +152,10 @@ struct slurm_cred_context {
 	enum ctx_type type;	/* context type (creator or verifier)	*/
 	void *key;		/* private or public key		*/
 	List job_list;		/* List of used jobids (for verifier)	*/
+	xhash_t *job_hash;	/* job_list entries hashed by jobid	*/
 	List state_list;	/* List of cred states (for verifier)	*/
+	xhash_t *state_hash;	/* state_list entries hashed by
+				 * jobid, stepid and ctime		*/
 
 	int expiry_window;	/* expiration window for cached creds	*/
 
@@ -264,6 +272,13 @@ static void           _job_state_destroy(job_state_t   *js);
 static job_state_t  * _find_job_state(slurm_cred_ctx_t ctx, uint32_t jobid);
 static job_state_t  * _insert_job_state(slurm_cred_ctx_t ctx,  uint32_t jobid);
 static int            _find_cred_state(cred_state_t *c, slurm_cred_t *cred);
+static cred_state_t * _find_cred_state_hash(slurm_cred_ctx_t ctx,
+					    slurm_cred_t *cred);
+static void           _state_hash_pop(slurm_cred_ctx_t ctx, slurm_cred_t *cred);
+static void _cred_state_hash_id(void *item, const char **key,
+				uint32_t *key_len);
+static void _job_state_hash_id(void *item, const char **key,
+			       uint32_t *key_len);
 
 static void _insert_cred_state(slurm_cred_ctx_t ctx, slurm_cred_t *cred);
 static void _clear_expired_job_states(slurm_cred_ctx_t ctx);
@@ -276,7 +291,7 @@ static bool _credential_revoked(slurm_cred_ctx_t ctx, slurm_cred_t *cred);
 static int _slurm_cred_sign(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
 			    uint16_t protocol_version);
 static int _slurm_cred_verify_signature(slurm_cred_ctx_t ctx, slurm_cred_t *c,
-					uint16_t protocol_version);
+					Buf buffer);
 
 static int _slurm_cred_init(void);
 static int _slurm_cred_fini(void);
@@ -449,7 +464,9 @@ slurm_cred_ctx_destroy(slurm_cred_ctx_t ctx)
 		(*(ops.cred_destroy_key))(ctx->exkey);
 	if (ctx->key)
 		(*(ops.cred_destroy_key))(ctx->key);
+	xhash_free(ctx->job_hash);
 	FREE_NULL_LIST(ctx->job_list);
+	xhash_free(ctx->state_hash);
 	FREE_NULL_LIST(ctx->state_list);
 
 	ctx->magic = ~CRED_CTX_MAGIC;
@@ -539,6 +556,22 @@ slurm_cred_ctx_key_update(slurm_cred_ctx_t ctx, const char *path)
 slurm_cred_t *
 slurm_cred_create(slurm_cred_ctx_t ctx, slurm_cred_arg_t *arg,
 		  uint16_t protocol_version)
+{
+	slurm_cred_t *cred;
+
+	if (!(cred = slurm_cred_create_unsigned(ctx, arg)))
+		return NULL;
+
+	if (slurm_cred_sign(ctx, cred, protocol_version) != SLURM_SUCCESS) {
+		slurm_cred_destroy(cred);
+		return NULL;
+	}
+
+	return cred;
+}
+
+extern slurm_cred_t *slurm_cred_create_unsigned(slurm_cred_ctx_t ctx,
+						slurm_cred_arg_t *arg)
 {
 	slurm_cred_t *cred = NULL;
 	int i = 0, sock_recs = 0;
@@ -600,24 +633,32 @@ slurm_cred_create(slurm_cred_ctx_t ctx, slurm_cred_arg_t *arg,
 	cred->job_hostlist    = xstrdup(arg->job_hostlist);
 	cred->ctime  = time(NULL);
 
-	if (enable_nss_slurm || enable_send_gids) {
-		struct passwd pwd, *result;
-		char buffer[PW_BUF_SIZE];
+	slurm_mutex_unlock(&cred->mutex);
 
-		int rc = slurm_getpwuid_r(arg->uid, &pwd, buffer,
-					  PW_BUF_SIZE, &result);
-		if (rc || !result) {
+	return cred;
+}
+
+extern int slurm_cred_sign(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
+			   uint16_t protocol_version)
+{
+	xassert(ctx != NULL);
+	xassert(cred != NULL);
+
+	slurm_mutex_lock(&cred->mutex);
+	xassert(cred->magic == CRED_MAGIC);
+
+	if (enable_nss_slurm || enable_send_gids) {
+		if (group_cache_getpw(cred->uid, &cred->pw_name,
+				      &cred->pw_gecos, &cred->pw_dir,
+				      &cred->pw_shell)) {
 			error("%s: getpwuid failed for uid=%u",
-			      __func__, arg->uid);
-			goto fail;
+			      __func__, cred->uid);
+			slurm_mutex_unlock(&cred->mutex);
+			return SLURM_ERROR;
 		}
-		cred->pw_name = xstrdup(result->pw_name);
-		cred->pw_gecos = xstrdup(result->pw_gecos);
-		cred->pw_dir = xstrdup(result->pw_dir);
-		cred->pw_shell = xstrdup(result->pw_shell);
 
-		cred->ngids = group_cache_lookup(arg->uid, arg->gid,
-						 arg->pw_name, &cred->gids);
+		cred->ngids = group_cache_lookup(cred->uid, cred->gid,
+						 cred->pw_name, &cred->gids);
 	}
 
 	if (enable_nss_slurm) {
@@ -633,19 +674,15 @@ slurm_cred_create(slurm_cred_ctx_t ctx, slurm_cred_arg_t *arg,
 	slurm_mutex_lock(&ctx->mutex);
 	xassert(ctx->magic == CRED_CTX_MAGIC);
 	xassert(ctx->type == SLURM_CRED_CREATOR);
-	if (_slurm_cred_sign(ctx, cred, protocol_version) < 0)
-		goto fail;
-
+	if (_slurm_cred_sign(ctx, cred, protocol_version) < 0) {
+		slurm_mutex_unlock(&ctx->mutex);
+		slurm_mutex_unlock(&cred->mutex);
+		return SLURM_ERROR;
+	}
 	slurm_mutex_unlock(&ctx->mutex);
 	slurm_mutex_unlock(&cred->mutex);
 
-	return cred;
-
-fail:
-	slurm_mutex_unlock(&ctx->mutex);
-	slurm_mutex_unlock(&cred->mutex);
-	slurm_cred_destroy(cred);
-	return NULL;
+	return SLURM_SUCCESS;
 }
 
 slurm_cred_t *
@@ -892,6 +929,7 @@ slurm_cred_verify(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
 {
 	time_t now = time(NULL);
 	int errnum;
+	Buf buffer;
 
 	xassert(ctx  != NULL);
 	xassert(cred != NULL);
@@ -900,6 +938,14 @@ slurm_cred_verify(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
 		return SLURM_ERROR;
 
 	slurm_mutex_lock(&cred->mutex);
+
+	/*
+	 * Pack the signed data before taking the context lock, which
+	 * serializes every credential verification on this node.
+	 */
+	buffer = init_buf(4096);
+	_pack_cred(cred, buffer, protocol_version);
+
 	slurm_mutex_lock(&ctx->mutex);
 
 	xassert(ctx->magic  == CRED_CTX_MAGIC);
@@ -908,7 +954,7 @@ slurm_cred_verify(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
 
 	/* NOTE: the verification checks that the credential was
 	 * created by SlurmUser or root */
-	if (_slurm_cred_verify_signature(ctx, cred, protocol_version) < 0) {
+	if (_slurm_cred_verify_signature(ctx, cred, buffer) < 0) {
 		slurm_seterrno(ESLURMD_INVALID_JOB_CREDENTIAL);
 		goto error;
 	}
@@ -931,6 +977,7 @@ slurm_cred_verify(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
 	}
 
 	slurm_mutex_unlock(&ctx->mutex);
+	free_buf(buffer);
 
 	_copy_cred_to_arg(cred, arg);
 
@@ -941,6 +988,7 @@ slurm_cred_verify(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
 error:
 	errnum = slurm_get_errno();
 	slurm_mutex_unlock(&ctx->mutex);
+	free_buf(buffer);
 	slurm_mutex_unlock(&cred->mutex);
 	slurm_seterrno(errnum);
 	return SLURM_ERROR;
@@ -1038,6 +1086,8 @@ slurm_cred_rewind(slurm_cred_ctx_t ctx, slurm_cred_t *cred)
 
 	rc = list_delete_all(ctx->state_list,
 			     (ListFindF) _find_cred_state, cred);
+	if (rc > 0)
+		_state_hash_pop(ctx, cred);
 
 	slurm_mutex_unlock(&ctx->mutex);
 
@@ -1505,7 +1555,9 @@ _verifier_ctx_init(slurm_cred_ctx_t ctx)
 	xassert(ctx->type == SLURM_CRED_VERIFIER);
 
 	ctx->job_list   = list_create((ListDelF) _job_state_destroy);
+	ctx->job_hash   = xhash_init(_job_state_hash_id, NULL);
 	ctx->state_list = list_create(xfree_ptr);
+	ctx->state_hash = xhash_init(_cred_state_hash_id, NULL);
 
 	return;
 }
@@ -1644,14 +1696,11 @@ _slurm_cred_sign(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
 
 static int
 _slurm_cred_verify_signature(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
-			     uint16_t protocol_version)
+			     Buf buffer)
 {
-	Buf            buffer;
 	int            rc;
 
 	debug("Checking credential with %u bytes of sig data", cred->siglen);
-	buffer = init_buf(4096);
-	_pack_cred(cred, buffer, protocol_version);
 
 	rc = (*(ops.cred_verify_sign))(ctx->key,
 				       get_buf_data(buffer),
@@ -1665,7 +1714,6 @@ _slurm_cred_verify_signature(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
 					       cred->signature,
 					       cred->siglen);
 	}
-	free_buf(buffer);
 
 	if (rc) {
 		error("Credential signature check: %s",
@@ -1735,15 +1783,49 @@ _pack_cred(slurm_cred_t *cred, Buf buffer, uint16_t protocol_version)
 	}
 }
 
-static int _list_find_cred_state(void *x, void *key)
+static void _cred_state_hash_id(void *item, const char **key,
+				uint32_t *key_len)
+{
+	cred_state_t *s = item;
+
+	*key = (const char *) s;
+	*key_len = CRED_STATE_KEY_LEN;
+}
+
+static void _job_state_hash_id(void *item, const char **key,
+			       uint32_t *key_len)
+{
+	job_state_t *j = item;
+
+	*key = (const char *) &j->jobid;
+	*key_len = sizeof(j->jobid);
+}
+
+static cred_state_t *_find_cred_state_hash(slurm_cred_ctx_t ctx,
+					   slurm_cred_t *cred)
+{
+	cred_state_t key;
+
+	memset(&key, 0, sizeof(key));
+	key.jobid = cred->jobid;
+	key.stepid = cred->stepid;
+	key.ctime = cred->ctime;
+
+	return xhash_get(ctx->state_hash, (const char *) &key,
+			 CRED_STATE_KEY_LEN);
+}
+
+static void _state_hash_pop(slurm_cred_ctx_t ctx, slurm_cred_t *cred)
 {
-	cred_state_t *s = (cred_state_t *) x;
-	slurm_cred_t *cred = (slurm_cred_t *) key;
-	if ((s->jobid  == cred->jobid)  &&
-	    (s->stepid == cred->stepid) &&
-	    (s->ctime  == cred->ctime))
-		return 1;
-	return 0;
+	cred_state_t key;
+
+	memset(&key, 0, sizeof(key));
+	key.jobid = cred->jobid;
+	key.stepid = cred->stepid;
+	key.ctime = cred->ctime;
+
+	(void) xhash_pop(ctx->state_hash, (const char *) &key,
+			 CRED_STATE_KEY_LEN);
 }
 
 
@@ -1754,7 +1836,7 @@ _credential_replayed(slurm_cred_ctx_t ctx, slurm_cred_t *cred)
 
 	_clear_expired_credential_states(ctx);
 
-	s = list_find_first(ctx->state_list, _list_find_cred_state, cred);
+	s = _find_cred_state_hash(ctx, cred);
 
 	/*
 	 * If we found a match, this credential is being replayed.
@@ -1823,21 +1905,10 @@ _credential_revoked(slurm_cred_ctx_t ctx, slurm_cred_t *cred)
 	return false;
 }
 
-static int _list_find_job_state(void *x, void *key)
-{
-	job_state_t *j = (job_state_t *) x;
-	uint32_t jobid = *(uint32_t *) key;
-	if (j->jobid == jobid)
-		return 1;
-	return 0;
-}
-
 static job_state_t *
 _find_job_state(slurm_cred_ctx_t ctx, uint32_t jobid)
 {
-	job_state_t *j =
-		list_find_first(ctx->job_list, _list_find_job_state, &jobid);
-	return j;
+	return xhash_get(ctx->job_hash, (const char *) &jobid, sizeof(jobid));
 }
 
 static int
@@ -1850,11 +1921,11 @@ _find_cred_state(cred_state_t *c, slurm_cred_t *cred)
 static job_state_t *
 _insert_job_state(slurm_cred_ctx_t ctx, uint32_t jobid)
 {
-	job_state_t *j = list_find_first(
-		ctx->job_list, _list_find_job_state, &jobid);;
+	job_state_t *j = _find_job_state(ctx, jobid);
 	if (!j) {
 		j = _job_state_create(jobid);
 		list_append(ctx->job_list, j);
+		xhash_add(ctx->job_hash, j);
 	} else
 		debug2("%s: we already have a job state for job %u.  No big deal, just an FYI.",
 		       __func__, jobid);
@@ -1900,6 +1971,8 @@ _clear_expired_job_states(slurm_cred_ctx_t ctx)
 		debug3("state for jobid %u: ctime:%ld revoked:%ld expires:%ld",
 		       j->jobid, j->ctime, j->revoked, j->expiration);
 		if (j->revoked && (now > j->expiration)) {
+			xhash_pop(ctx->job_hash, (const char *) &j->jobid,
+				  sizeof(j->jobid));
 			list_delete_item(i);
 		}
 	}
@@ -1907,27 +1980,27 @@ _clear_expired_job_states(slurm_cred_ctx_t ctx)
 	list_iterator_destroy(i);
 }
 
-static int _list_find_expired(void *x, void *key)
-{
-	cred_state_t *s = (cred_state_t *)x;
-	time_t curr_time = *(time_t *)key;
-
-	if (curr_time > s->expiration)
-		return 1;
-	return 0;
-}
-
 static void
 _clear_expired_credential_states(slurm_cred_ctx_t ctx)
 {
 	static time_t last_scan = 0;
 	time_t        now = time(NULL);
+	ListIterator  i   = NULL;
+	cred_state_t *s   = NULL;
 
 	if ((now - last_scan) < 2)	/* Reduces slurmd overhead */
 		return;
 	last_scan = now;
 
-	list_delete_all(ctx->state_list, _list_find_expired, &now);
+	i = list_iterator_create(ctx->state_list);
+	while ((s = list_next(i))) {
+		if (now > s->expiration) {
+			xhash_pop(ctx->state_hash, (const char *) s,
+				  CRED_STATE_KEY_LEN);
+			list_delete_item(i);
+		}
+	}
+	list_iterator_destroy(i);
 }
 
 
@@ -1936,6 +2009,7 @@ _insert_cred_state(slurm_cred_ctx_t ctx, slurm_cred_t *cred)
 {
 	cred_state_t *s = _cred_state_create(ctx, cred);
 	list_append(ctx->state_list, s);
+	xhash_add(ctx->state_hash, s);
 }
 
 
@@ -2045,9 +2119,12 @@ _cred_state_unpack(slurm_cred_ctx_t ctx, Buf buffer)
 		if (!(s = _cred_state_unpack_one(buffer)))
 			goto unpack_error;
 
-		if (now < s->expiration)
+		if ((now < s->expiration) &&
+		    !xhash_get(ctx->state_hash, (const char *) s,
+			       CRED_STATE_KEY_LEN)) {
 			list_append(ctx->state_list, s);
-		else
+			xhash_add(ctx->state_hash, s);
+		} else
 			xfree(s);
 	}
 
@@ -2090,9 +2167,14 @@ _job_state_unpack(slurm_cred_ctx_t ctx, Buf buffer)
 		if (!(j = _job_state_unpack_one(buffer)))
 			goto unpack_error;
 
-		if (!j->revoked || (j->revoked && (now < j->expiration)))
+		if (_find_job_state(ctx, j->jobid)) {
+			debug3("duplicate job %u state", j->jobid);
+			_job_state_destroy(j);
+		} else if (!j->revoked ||
+			   (j->revoked && (now < j->expiration))) {
 			list_append(ctx->job_list, j);
-		else {
+			xhash_add(ctx->job_hash, j);
+		} else {
 			debug3 ("not appending expired job %u state",
 			        j->jobid);
 			_job_state_destroy(j);
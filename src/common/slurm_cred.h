@@ -195,6 +195,21 @@ int slurm_cred_fini(void);
 slurm_cred_t *slurm_cred_create(slurm_cred_ctx_t ctx, slurm_cred_arg_t *arg,
 				uint16_t protocol_version);
 
+/*
+ * Same as slurm_cred_create() split in two: slurm_cred_create_unsigned()
+ * copies `arg' into a new credential, slurm_cred_sign() then looks up the
+ * user's passwd/group information (if needed) and signs it. Locks that
+ * protect the data in `arg' can be released before calling
+ * slurm_cred_sign(), which may be slow.
+ *
+ * slurm_cred_create_unsigned() returns NULL on failure. slurm_cred_sign()
+ * returns SLURM_ERROR on failure, the credential must still be destroyed.
+ */
+extern slurm_cred_t *slurm_cred_create_unsigned(slurm_cred_ctx_t ctx,
+						slurm_cred_arg_t *arg);
+extern int slurm_cred_sign(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
+			   uint16_t protocol_version);
+
 /*
  * Copy a slurm credential.
  * Returns NULL on failure.
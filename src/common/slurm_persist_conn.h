@@ -52,6 +52,7 @@ typedef enum {
 	PERSIST_TYPE_FED,
 	PERSIST_TYPE_HA_CTL,
 	PERSIST_TYPE_HA_DBD,
+	PERSIST_TYPE_SLURMD,
 } persist_conn_type_t;
 
 typedef struct {
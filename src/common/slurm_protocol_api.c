@@ -55,6 +55,10 @@
 #include <time.h>
 #include <unistd.h>
 
+#if HAVE_LIBZ
+#  include <zlib.h>
+#endif
+
 /* PROJECT INCLUDES */
 #include "src/common/assoc_mgr.h"
 #include "src/common/fd.h"
@@ -91,6 +95,14 @@ strong_alias(get_unit_type, slurm_get_unit_type);
 			_print_data(__func__, data, len);		\
 	} while (0)
 
+/*
+ * Pre-packed response bodies at least this large are compressed when the
+ * requester advertised SLURM_MSG_ACCEPT_COMPRESS, and compressed bodies
+ * may not expand beyond the largest message we are willing to receive.
+ */
+#define MSG_COMPRESS_MIN_SIZE	(64 * 1024)
+#define MSG_COMPRESS_MAX_SIZE	(1024 * 1024 * 1024)
+
 
 /* STATIC VARIABLES */
 static int message_timeout = -1;
@@ -101,6 +113,7 @@ static void  _remap_slurmctld_errno(void);
 static int   _unpack_msg_uid(Buf buffer, uint16_t protocol_version);
 static bool  _is_port_ok(int, uint16_t, bool);
 static void _print_data(const char *tag, const char *data, int len);
+static int   _unpack_msg_body(slurm_msg_t *msg, header_t *header, Buf buffer);
 
 /* define slurmdbd_conf here so we can treat its existence as a flag */
 slurmdbd_conf_t *slurmdbd_conf = NULL;
@@ -1166,6 +1179,34 @@ extern int slurm_get_auth_ttl(void)
 	return ttl;
 }
 
+/* slurm_get_auth_cred_reuse
+ * returns the credential reuse window option from the AuthInfo parameter
+ * cache value in local buffer for best performance
+ * RET int - reuse window in seconds or 0 if not specified (no reuse)
+ */
+extern int slurm_get_auth_cred_reuse(void)
+{
+	static int reuse = -1;
+	char *tmp;
+
+	if (reuse >= 0)
+		return reuse;
+
+	if (!slurm_conf.authinfo)
+		return 0;
+
+	tmp = xstrstr(slurm_conf.authinfo, "cred_reuse=");
+	if (tmp) {
+		reuse = atoi(tmp + 11);
+		if (reuse < 0)
+			reuse = 0;
+	} else {
+		reuse = 0;
+	}
+
+	return reuse;
+}
+
 /* _global_auth_key
  * returns the storage password from slurm_conf or slurmdbd_conf object
  * cache value in local buffer for best performance
@@ -2152,8 +2193,7 @@ extern int slurm_unpack_received_msg(slurm_msg_t *msg, int fd, Buf buffer)
 
 	msg->body_offset =  get_buf_offset(buffer);
 
-	if ((header.body_length > remaining_buf(buffer)) ||
-	    (unpack_msg(msg, buffer) != SLURM_SUCCESS)) {
+	if (_unpack_msg_body(msg, &header, buffer) != SLURM_SUCCESS) {
 		rc = ESLURM_PROTOCOL_INCOMPLETE_PACKET;
 		(void) g_slurm_auth_destroy(auth_cred);
 		goto total_return;
@@ -2414,8 +2454,7 @@ List slurm_receive_msgs(int fd, int steps, int timeout)
 	msg.msg_type = header.msg_type;
 	msg.flags = header.flags;
 
-	if ((header.body_length > remaining_buf(buffer)) ||
-	    (unpack_msg(&msg, buffer) != SLURM_SUCCESS)) {
+	if (_unpack_msg_body(&msg, &header, buffer) != SLURM_SUCCESS) {
 		(void) g_slurm_auth_destroy(auth_cred);
 		free_buf(buffer);
 		rc = ESLURM_PROTOCOL_INCOMPLETE_PACKET;
@@ -2651,8 +2690,7 @@ int slurm_receive_msg_and_forward(int fd, slurm_addr_t *orig_addr,
 		goto total_return;
 	}
 
-	if ( (header.body_length > remaining_buf(buffer)) ||
-	     (unpack_msg(msg, buffer) != SLURM_SUCCESS) ) {
+	if (_unpack_msg_body(msg, &header, buffer) != SLURM_SUCCESS) {
 		(void) g_slurm_auth_destroy(auth_cred);
 		free_buf(buffer);
 		rc = ESLURM_PROTOCOL_INCOMPLETE_PACKET;
@@ -2689,6 +2727,96 @@ total_return:
  *  Do the wonderful stuff that needs be done to pack msg
  *  and hdr into buffer
  */
+/*
+ * Return SLURM_MSG_ACCEPT_COMPRESS if this process should ask for
+ * compressed responses (CommunicationParameters=CompressResponses).
+ */
+static uint16_t _accept_compress_flag(void)
+{
+#if HAVE_LIBZ
+	if (xstrcasestr(slurm_conf.comm_params, "CompressResponses"))
+		return SLURM_MSG_ACCEPT_COMPRESS;
+#endif
+	return 0;
+}
+
+/*
+ * Compress size bytes of data.
+ * RET xmalloc'ed compressed copy with its length in size, or NULL if it
+ *     could not be compressed into fewer bytes
+ */
+static char *_compress_body(char *data, uint32_t *size)
+{
+#if HAVE_LIBZ
+	uLongf out_len = compressBound(*size);
+	char *out = xmalloc_nz(out_len);
+
+	if ((compress2((Bytef *) out, &out_len, (Bytef *) data, *size,
+		       Z_BEST_SPEED) != Z_OK) || (out_len >= *size)) {
+		xfree(out);
+		return NULL;
+	}
+	*size = out_len;
+	return out;
+#else
+	return NULL;
+#endif
+}
+
+/*
+ * Unpack the body of a received message, inflating it first if the
+ * sender flagged it SLURM_MSG_COMPRESSED.
+ */
+static int _unpack_msg_body(slurm_msg_t *msg, header_t *header, Buf buffer)
+{
+#if HAVE_LIBZ
+	uint32_t size;
+	uLongf out_len;
+	char *out;
+	Buf body;
+	int rc;
+#endif
+
+	if (header->body_length > remaining_buf(buffer))
+		return SLURM_ERROR;
+
+	if (!(header->flags & SLURM_MSG_COMPRESSED))
+		return unpack_msg(msg, buffer);
+
+#if HAVE_LIBZ
+	if ((header->body_length < sizeof(size)) ||
+	    unpack32(&size, buffer) || !size ||
+	    (size > MSG_COMPRESS_MAX_SIZE)) {
+		error("%s: invalid compressed %s message",
+		      __func__, rpc_num2string(header->msg_type));
+		return SLURM_ERROR;
+	}
+
+	out = xmalloc_nz(size);
+	out_len = size;
+	if ((uncompress((Bytef *) out, &out_len,
+			(Bytef *) &buffer->head[buffer->processed],
+			header->body_length - sizeof(size)) != Z_OK) ||
+	    (out_len != size)) {
+		error("%s: unable to uncompress %s message",
+		      __func__, rpc_num2string(header->msg_type));
+		xfree(out);
+		return SLURM_ERROR;
+	}
+	buffer->processed += header->body_length - sizeof(size);
+
+	body = create_buf(out, size);
+	rc = unpack_msg(msg, body);
+	msg->flags &= ~SLURM_MSG_COMPRESSED;
+	free_buf(body);
+	return rc;
+#else
+	error("%s: compressed %s message received, but zlib support is not built",
+	      __func__, rpc_num2string(header->msg_type));
+	return SLURM_ERROR;
+#endif
+}
+
 static void
 _pack_msg(slurm_msg_t *msg, header_t *hdr, Buf buffer)
 {
@@ -2795,7 +2923,7 @@ int slurm_send_node_msg(int fd, slurm_msg_t * msg)
 		slurm_seterrno_ret(SLURM_PROTOCOL_AUTHENTICATION_ERROR);
 	}
 
-	init_header(&header, msg, msg->flags);
+	init_header(&header, msg, msg->flags | _accept_compress_flag());
 
 	/*
 	 * Pack header into buffer for transmission
@@ -2815,17 +2943,51 @@ int slurm_send_node_msg(int fd, slurm_msg_t * msg)
 		slurm_seterrno_ret(SLURM_PROTOCOL_AUTHENTICATION_ERROR);
 	}
 
-	/*
-	 * Pack message into buffer
-	 */
-	_pack_msg(msg, &header, buffer);
-	_log_hex(get_buf_data(buffer), get_buf_offset(buffer));
+	if (pack_msg_is_raw(msg->msg_type)) {
+		/*
+		 * Pre-packed responses (job, node, partition info, ...) can
+		 * be hundreds of MB. Send them straight from msg->data
+		 * behind the header rather than copying them into buffer,
+		 * compressed if the requester can take that.
+		 */
+		char *body = msg->data, *zbody = NULL;
+		uint32_t body_size = msg->data_size;
+		uint32_t auth_end = get_buf_offset(buffer), tmplen;
+
+		if ((msg->flags & SLURM_MSG_ACCEPT_COMPRESS) &&
+		    (body_size >= MSG_COMPRESS_MIN_SIZE) &&
+		    (zbody = _compress_body(body, &body_size))) {
+			log_flag(NET, "%s: %s compressed from %u to %u bytes",
+				 __func__, rpc_num2string(msg->msg_type),
+				 msg->data_size, body_size);
+			header.flags |= SLURM_MSG_COMPRESSED;
+			pack32(msg->data_size, buffer);
+			body = zbody;
+		}
 
-	/*
-	 * Send message
-	 */
-	rc = slurm_msg_sendto(fd, get_buf_data(buffer),
-			      get_buf_offset(buffer));
+		tmplen = get_buf_offset(buffer);
+		update_header(&header, tmplen - auth_end + body_size);
+		set_buf_offset(buffer, 0);
+		pack_header(&header, buffer);
+		set_buf_offset(buffer, tmplen);
+
+		rc = slurm_msg_sendto_parts(fd, get_buf_data(buffer),
+					    get_buf_offset(buffer),
+					    body, body_size);
+		xfree(zbody);
+	} else {
+		/*
+		 * Pack message into buffer
+		 */
+		_pack_msg(msg, &header, buffer);
+		_log_hex(get_buf_data(buffer), get_buf_offset(buffer));
+
+		/*
+		 * Send message
+		 */
+		rc = slurm_msg_sendto(fd, get_buf_data(buffer),
+				      get_buf_offset(buffer));
+	}
 
 	if ((rc < 0) && (errno == ENOTCONN)) {
 		log_flag(NET, "%s: peer has disappeared for msg_type=%u",
@@ -3287,7 +3449,8 @@ extern int slurm_send_recv_controller_msg(slurm_msg_t * request_msg,
 	int retry = 1;
 	slurm_conf_t *conf;
 	bool have_backup;
-	uint16_t slurmctld_timeout;
+	uint16_t slurmctld_timeout, msg_timeout;
+	int backoff = 1;
 	slurm_addr_t ctrl_addr;
 	static bool use_backup = false;
 	slurmdb_cluster_rec_t *save_comm_cluster_rec = comm_cluster_rec;
@@ -3315,6 +3478,7 @@ tryagain:
 	conf = slurm_conf_lock();
 	have_backup = conf->control_cnt > 1;
 	slurmctld_timeout = conf->slurmctld_timeout;
+	msg_timeout = conf->msg_timeout;
 	slurm_conf_unlock();
 
 	while (retry) {
@@ -3349,6 +3513,24 @@ tryagain:
 			} else {
 				retry = 1;
 			}
+		} else if ((rc == 0)
+		    && (response_msg->msg_type == RESPONSE_SLURM_RC)
+		    && ((((return_code_msg_t *)response_msg->data)->return_code)
+			== SLURMCTLD_COMMUNICATIONS_BACKOFF)
+		    && (difftime(time(NULL), start_time) < msg_timeout)) {
+			log_flag(NET, "%s: Controller is busy. Sleeping %d seconds and retry.",
+				 __func__, backoff);
+			slurm_free_return_code_msg(response_msg->data);
+			sleep(backoff);
+			backoff = MIN(backoff * 2, 8);
+			if ((fd = slurm_open_controller_conn(&ctrl_addr,
+							     &use_backup,
+							     comm_cluster_rec))
+			    < 0) {
+				rc = -1;
+			} else {
+				retry = 1;
+			}
 		}
 
 		if (rc == -1)
@@ -92,6 +92,13 @@ char *slurm_auth_opts_to_socket(char *opts);
  */
 int slurm_get_auth_ttl(void);
 
+/* slurm_get_auth_cred_reuse
+ * returns the credential reuse window option from the AuthInfo parameter
+ * cache value in local buffer for best performance
+ * RET int - reuse window in seconds or 0 if not specified (no reuse)
+ */
+int slurm_get_auth_cred_reuse(void);
+
 /*
  * slurm_get_control_cnt
  * RET Count of SlurmctldHost records from slurm.conf
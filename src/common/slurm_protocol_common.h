@@ -106,5 +106,8 @@
 #define SLURM_MSG_KEEP_BUFFER   0x0004
 #define SLURM_DROP_PRIV		0x0008
 #define USE_BCAST_NETWORK	0x0010
+#define SLURM_MSG_ACCEPT_COMPRESS 0x0020 /* sender takes compressed replies */
+#define SLURM_MSG_COMPRESSED	0x0040	/* body is zlib compressed, led by
+					 * its uncompressed size */
 
 #endif
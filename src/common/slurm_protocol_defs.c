@@ -896,6 +896,26 @@ extern void slurm_free_job_step_kill_msg(job_step_kill_msg_t * msg)
 	}
 }
 
+extern void slurm_free_kill_jobs_msg(kill_jobs_msg_t *msg)
+{
+	int i;
+
+	if (msg) {
+		for (i = 0; i < msg->jobs_cnt; i++)
+			xfree(msg->jobs_array[i]);
+		xfree(msg->jobs_array);
+		xfree(msg);
+	}
+}
+
+extern void slurm_free_kill_jobs_response_msg(kill_jobs_resp_msg_t *msg)
+{
+	if (msg) {
+		xfree(msg->error_code);
+		xfree(msg);
+	}
+}
+
 extern void slurm_free_job_info_request_msg(job_info_request_msg_t *msg)
 {
 	if (msg) {
@@ -904,6 +924,12 @@ extern void slurm_free_job_info_request_msg(job_info_request_msg_t *msg)
 	}
 }
 
+extern void slurm_free_job_info_delta_request_msg(
+	job_info_delta_request_msg_t *msg)
+{
+	xfree(msg);
+}
+
 extern void slurm_free_job_step_info_request_msg(job_step_info_request_msg_t *msg)
 {
 	xfree(msg);
@@ -1683,6 +1709,9 @@ extern void slurm_free_stats_response_msg(stats_info_response_msg_t *msg)
 			xfree(msg->rpc_dump_hostlist[i]);
 		}
 		xfree(msg->rpc_dump_hostlist);
+		xfree(msg->rpc_throttle_user_id);
+		xfree(msg->rpc_throttle_count);
+		xfree(msg->rpc_type_max);
 		xfree(msg);
 	}
 }
@@ -2622,6 +2651,14 @@ extern void slurm_free_ping_slurmd_resp(ping_slurmd_resp_msg_t *msg)
 	xfree(msg);
 }
 
+extern void slurm_free_node_heartbeat_msg(node_heartbeat_msg_t *msg)
+{
+	if (msg) {
+		xfree(msg->node_name);
+		xfree(msg);
+	}
+}
+
 /*
  * structured as a static lookup table, which allows this
  * to be thread safe while avoiding any heap allocation
@@ -4136,6 +4173,15 @@ extern void slurm_free_job_info_msg(job_info_msg_t * job_buffer_ptr)
 	}
 }
 
+extern void slurm_free_job_info_delta_msg(job_info_delta_msg_t *msg)
+{
+	if (msg) {
+		slurm_free_job_info_msg(msg->jobs);
+		xfree(msg->removed_ids);
+		xfree(msg);
+	}
+}
+
 static void _free_all_job_info(job_info_msg_t *msg)
 {
 	int i;
@@ -4771,6 +4817,12 @@ extern int slurm_free_msg_data(slurm_msg_type_t type, void *data)
 	case REQUEST_JOB_INFO:
 		slurm_free_job_info_request_msg(data);
 		break;
+	case REQUEST_JOB_INFO_DELTA:
+		slurm_free_job_info_delta_request_msg(data);
+		break;
+	case RESPONSE_JOB_INFO_DELTA:
+		slurm_free_job_info_delta_msg(data);
+		break;
 	case REQUEST_NODE_INFO:
 		slurm_free_node_info_request_msg(data);
 		break;
@@ -4838,6 +4890,9 @@ extern int slurm_free_msg_data(slurm_msg_type_t type, void *data)
 	case RESPONSE_NODE_REGISTRATION:
 		slurm_free_node_reg_resp_msg(data);
 		break;
+	case MESSAGE_NODE_HEARTBEAT:
+		slurm_free_node_heartbeat_msg(data);
+		break;
 	case REQUEST_NODE_REGISTRATION_STATUS:
 	case MESSAGE_NODE_REGISTRATION_STATUS:
 		slurm_free_node_registration_status_msg(data);
@@ -4905,6 +4960,12 @@ extern int slurm_free_msg_data(slurm_msg_type_t type, void *data)
 	case RESPONSE_AUTH_TOKEN:
 		slurm_free_token_response_msg(data);
 		break;
+	case REQUEST_KILL_JOBS:
+		slurm_free_kill_jobs_msg(data);
+		break;
+	case RESPONSE_KILL_JOBS:
+		slurm_free_kill_jobs_response_msg(data);
+		break;
 	case REQUEST_JOB_REQUEUE:
 		slurm_free_requeue_msg(data);
 		break;
@@ -5124,7 +5185,9 @@ extern int slurm_free_msg_data(slurm_msg_type_t type, void *data)
 		break;
 	case REQUEST_HET_JOB_ALLOCATION:
 	case REQUEST_SUBMIT_BATCH_HET_JOB:
+	case REQUEST_SUBMIT_BATCH_JOBS:
 	case RESPONSE_HET_JOB_ALLOCATION:
+	case RESPONSE_SUBMIT_BATCH_JOBS:
 		FREE_NULL_LIST(data);
 		break;
 	case REQUEST_SET_FS_DAMPENING_FACTOR:
@@ -5306,6 +5369,8 @@ rpc_num2string(uint16_t opcode)
 		return "RESPONSE_LICENSE_INFO";
 	case REQUEST_SET_FS_DAMPENING_FACTOR:
 		return "REQUEST_SET_FS_DAMPENING_FACTOR,";
+	case MESSAGE_NODE_HEARTBEAT:
+		return "MESSAGE_NODE_HEARTBEAT";
 
 	case REQUEST_BUILD_INFO:				/* 2001 */
 		return "REQUEST_BUILD_INFO";
@@ -5411,6 +5476,10 @@ rpc_num2string(uint16_t opcode)
 		return "REQUEST_BURST_BUFFER_STATUS";
 	case RESPONSE_BURST_BUFFER_STATUS:
 		return "RESPONSE_BURST_BUFFER_STATUS";
+	case REQUEST_JOB_INFO_DELTA:
+		return "REQUEST_JOB_INFO_DELTA";
+	case RESPONSE_JOB_INFO_DELTA:
+		return "RESPONSE_JOB_INFO_DELTA";
 
 	case REQUEST_UPDATE_JOB:				/* 3001 */
 		return "REQUEST_UPDATE_JOB";
@@ -5556,6 +5625,14 @@ rpc_num2string(uint16_t opcode)
 		return "REQUEST_AUTH_TOKEN";
 	case RESPONSE_AUTH_TOKEN:
 		return "RESPONSE_AUTH_TOKEN";
+	case REQUEST_KILL_JOBS:
+		return "REQUEST_KILL_JOBS";
+	case RESPONSE_KILL_JOBS:
+		return "RESPONSE_KILL_JOBS";
+	case REQUEST_SUBMIT_BATCH_JOBS:
+		return "REQUEST_SUBMIT_BATCH_JOBS";
+	case RESPONSE_SUBMIT_BATCH_JOBS:
+		return "RESPONSE_SUBMIT_BATCH_JOBS";
 
 	case REQUEST_LAUNCH_TASKS:				/* 6001 */
 		return "REQUEST_LAUNCH_TASKS";
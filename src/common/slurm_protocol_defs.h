@@ -224,6 +224,7 @@ typedef enum {
 	RESPONSE_LICENSE_INFO,
 	REQUEST_SET_FS_DAMPENING_FACTOR,
 	RESPONSE_NODE_REGISTRATION,
+	MESSAGE_NODE_HEARTBEAT,
 
 	PERSIST_RC = 1433, /* To mirror the DBD_RC this is replacing */
 	/* Don't make any messages in this range as this is what the DBD uses
@@ -286,6 +287,8 @@ typedef enum {
 	RESPONSE_CONTROL_STATUS,
 	REQUEST_BURST_BUFFER_STATUS,
 	RESPONSE_BURST_BUFFER_STATUS,
+	REQUEST_JOB_INFO_DELTA,
+	RESPONSE_JOB_INFO_DELTA,
 
 	REQUEST_UPDATE_JOB = 3001,
 	REQUEST_UPDATE_NODE,
@@ -378,6 +381,10 @@ typedef enum {
 	REQUEST_TOP_JOB,		/* 5038 */
 	REQUEST_AUTH_TOKEN,
 	RESPONSE_AUTH_TOKEN,
+	REQUEST_KILL_JOBS,
+	RESPONSE_KILL_JOBS,
+	REQUEST_SUBMIT_BATCH_JOBS,
+	RESPONSE_SUBMIT_BATCH_JOBS,
 
 	REQUEST_LAUNCH_TASKS = 6001,
 	RESPONSE_LAUNCH_TASKS,
@@ -626,6 +633,12 @@ typedef struct job_info_request_msg {
 				 * jobs. */
 } job_info_request_msg_t;
 
+typedef struct job_info_delta_request_msg {
+	time_t epoch;		/* epoch of prior response or 0 */
+	uint64_t seq;		/* seq of prior response or 0 for all jobs */
+	uint16_t show_flags;
+} job_info_delta_request_msg_t;
+
 typedef struct job_step_info_request_msg {
 	time_t last_update;
 	uint32_t job_id;
@@ -1215,6 +1228,12 @@ typedef struct ping_slurmd_resp_msg {
 	uint64_t free_mem;	/* Free memory in MiB */
 } ping_slurmd_resp_msg_t;
 
+typedef struct node_heartbeat_msg {
+	uint32_t cpu_load;	/* CPU load * 100 */
+	uint64_t free_mem;	/* Free memory in MiB */
+	char *node_name;
+} node_heartbeat_msg_t;
+
 typedef struct license_info_request_msg {
 	time_t last_update;
 	uint16_t show_flags;
@@ -1386,6 +1405,8 @@ extern void slurm_free_return_code_msg(return_code_msg_t * msg);
 extern void slurm_free_reroute_msg(reroute_msg_t *msg);
 extern void slurm_free_job_alloc_info_msg(job_alloc_info_msg_t * msg);
 extern void slurm_free_job_info_request_msg(job_info_request_msg_t *msg);
+extern void slurm_free_job_info_delta_request_msg(
+	job_info_delta_request_msg_t *msg);
 extern void slurm_free_job_step_info_request_msg(
 		job_step_info_request_msg_t *msg);
 extern void slurm_free_front_end_info_request_msg(
@@ -1412,6 +1433,7 @@ extern void slurm_free_forward_data_msg(forward_data_msg_t *msg);
 extern void slurm_free_comp_msg_list(void *x);
 extern void slurm_free_composite_msg(composite_msg_t *msg);
 extern void slurm_free_ping_slurmd_resp(ping_slurmd_resp_msg_t *msg);
+extern void slurm_free_node_heartbeat_msg(node_heartbeat_msg_t *msg);
 
 #define	slurm_free_timelimit_msg(msg) \
 	slurm_free_kill_job_msg(msg)
@@ -1479,6 +1501,7 @@ extern void slurm_free_reattach_tasks_response_msg(
 extern void slurm_free_kill_job_msg(kill_job_msg_t * msg);
 extern void slurm_free_update_job_time_msg(job_time_msg_t * msg);
 extern void slurm_free_job_step_kill_msg(job_step_kill_msg_t * msg);
+extern void slurm_free_kill_jobs_msg(kill_jobs_msg_t *msg);
 extern void slurm_free_epilog_complete_msg(epilog_complete_msg_t * msg);
 extern void slurm_free_srun_job_complete_msg(srun_job_complete_msg_t * msg);
 extern void slurm_free_srun_exec_msg(srun_exec_msg_t *msg);
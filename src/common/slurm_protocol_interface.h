@@ -95,6 +95,20 @@ extern ssize_t slurm_msg_sendto_timeout(int open_fd,
 					size_t size,
 					int timeout);
 
+/* slurm_msg_sendto_parts
+ * Send a message made of a header buffer followed by a separately held
+ * body as one message, without copying them into a single buffer.
+ * IN open_fd - an open file descriptor
+ * IN head - leading data to transmit
+ * IN head_size - size of head in bytes
+ * IN body - trailing data to transmit, may be NULL if body_size is zero
+ * IN body_size - size of body in bytes
+ * RET number of bytes written or SLURM_ERROR
+ */
+extern ssize_t slurm_msg_sendto_parts(int open_fd, char *head,
+				      size_t head_size, char *body,
+				      size_t body_size);
+
 /********************/
 /* stream functions */
 /********************/
@@ -69,6 +69,7 @@
 #include "src/common/xstring.h"
 
 #define _pack_job_info_msg(msg,buf)		_pack_buffer_msg(msg,buf)
+#define _pack_job_info_delta_msg(msg,buf)	_pack_buffer_msg(msg,buf)
 #define _pack_job_step_info_msg(msg,buf)	_pack_buffer_msg(msg,buf)
 #define _pack_burst_buffer_info_resp_msg(msg,buf) _pack_buffer_msg(msg,buf)
 #define _pack_front_end_info_msg(msg,buf)	_pack_buffer_msg(msg,buf)
@@ -3605,6 +3606,37 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static int _unpack_job_info_delta_msg(job_info_delta_msg_t **msg_ptr,
+				      Buf buffer, uint16_t protocol_version)
+{
+	job_info_delta_msg_t *msg;
+	uint32_t uint32_tmp;
+
+	xassert(msg_ptr);
+	msg = xmalloc(sizeof(*msg));
+	*msg_ptr = msg;
+
+	if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+		safe_unpack64(&msg->seq, buffer);
+		safe_unpack_time(&msg->epoch, buffer);
+		safe_unpackbool(&msg->full, buffer);
+		safe_unpack32_array(&msg->removed_ids, &uint32_tmp, buffer);
+		msg->removed_cnt = uint32_tmp;
+		if (_unpack_job_info_msg(&msg->jobs, buffer, protocol_version))
+			goto unpack_error;
+	} else {
+		error("%s: protocol_version %hu not supported",
+		      __func__, protocol_version);
+		goto unpack_error;
+	}
+	return SLURM_SUCCESS;
+
+unpack_error:
+	slurm_free_job_info_delta_msg(msg);
+	*msg_ptr = NULL;
+	return SLURM_ERROR;
+}
+
 /* Translate bitmap representation from hex to decimal format, replacing
  * array_task_str and store the bitmap in job->array_bitmap. */
 static void _xlate_task_str(job_info_t *job_ptr)
@@ -7116,6 +7148,69 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+/* _pack_submit_response_list_msg
+ * packs a list of submit_response_msg_t structs
+ * IN resp_list - list of batch job submit responses to pack
+ * IN/OUT buffer - destination of the pack, contains pointers that are
+ *			automatically updated
+ */
+static void
+_pack_submit_response_list_msg(List resp_list, Buf buffer,
+			       uint16_t protocol_version)
+{
+	submit_response_msg_t *resp;
+	ListIterator iter;
+	uint16_t cnt = 0;
+
+	if (resp_list)
+		cnt = list_count(resp_list);
+	pack16(cnt, buffer);
+	if (cnt == 0)
+		return;
+
+	iter = list_iterator_create(resp_list);
+	while ((resp = (submit_response_msg_t *) list_next(iter)))
+		_pack_submit_response_msg(resp, buffer, protocol_version);
+	list_iterator_destroy(iter);
+}
+
+static void _free_submit_response_list(void *x)
+{
+	slurm_free_submit_response_response_msg((submit_response_msg_t *) x);
+}
+
+static int
+_unpack_submit_response_list_msg(List *resp_list, Buf buffer,
+				 uint16_t protocol_version)
+{
+	submit_response_msg_t *resp;
+	uint16_t cnt = 0;
+	int i;
+
+	*resp_list = NULL;
+
+	safe_unpack16(&cnt, buffer);
+	if (cnt == 0)
+		return SLURM_SUCCESS;
+	if (cnt > NO_VAL16)
+		goto unpack_error;
+
+	*resp_list = list_create(_free_submit_response_list);
+	for (i = 0; i < cnt; i++) {
+		resp = NULL;
+		if (_unpack_submit_response_msg(&resp, buffer,
+						protocol_version) !=
+		    SLURM_SUCCESS)
+			goto unpack_error;
+		list_append(*resp_list, resp);
+	}
+	return SLURM_SUCCESS;
+
+unpack_error:
+	FREE_NULL_LIST(*resp_list);
+	return SLURM_ERROR;
+}
+
 static void
 _pack_step_alloc_info_msg(step_alloc_info_msg_t * job_desc_ptr, Buf buffer,
 			  uint16_t protocol_version)
@@ -8961,6 +9056,49 @@ _pack_job_info_request_msg(job_info_request_msg_t * msg, Buf buffer,
 	}
 }
 
+static void _pack_job_info_delta_request_msg(job_info_delta_request_msg_t *msg,
+					     Buf buffer,
+					     uint16_t protocol_version)
+{
+	xassert(msg);
+
+	if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+		pack_time(msg->epoch, buffer);
+		pack64(msg->seq, buffer);
+		pack16(msg->show_flags, buffer);
+	} else {
+		error("%s: protocol_version %hu not supported",
+		      __func__, protocol_version);
+	}
+}
+
+static int _unpack_job_info_delta_request_msg(
+	job_info_delta_request_msg_t **msg_ptr, Buf buffer,
+	uint16_t protocol_version)
+{
+	job_info_delta_request_msg_t *msg;
+
+	xassert(msg_ptr);
+	msg = xmalloc(sizeof(*msg));
+	*msg_ptr = msg;
+
+	if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+		safe_unpack_time(&msg->epoch, buffer);
+		safe_unpack64(&msg->seq, buffer);
+		safe_unpack16(&msg->show_flags, buffer);
+	} else {
+		error("%s: protocol_version %hu not supported",
+		      __func__, protocol_version);
+		goto unpack_error;
+	}
+	return SLURM_SUCCESS;
+
+unpack_error:
+	slurm_free_job_info_delta_request_msg(msg);
+	*msg_ptr = NULL;
+	return SLURM_ERROR;
+}
+
 static int
 _unpack_job_info_request_msg(job_info_request_msg_t** msg,
 			     Buf buffer,
@@ -10483,6 +10621,68 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static void _pack_kill_jobs_msg(kill_jobs_msg_t *msg, Buf buffer,
+				uint16_t protocol_version)
+{
+	xassert(msg);
+
+	if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+		pack16(msg->flags, buffer);
+		packstr_array(msg->jobs_array, msg->jobs_cnt, buffer);
+		pack16(msg->signal, buffer);
+	}
+}
+
+static int _unpack_kill_jobs_msg(kill_jobs_msg_t **msg_ptr, Buf buffer,
+				 uint16_t protocol_version)
+{
+	kill_jobs_msg_t *msg = xmalloc(sizeof(*msg));
+	xassert(msg_ptr);
+	*msg_ptr = msg;
+
+	if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+		safe_unpack16(&msg->flags, buffer);
+		safe_unpackstr_array(&msg->jobs_array, &msg->jobs_cnt, buffer);
+		safe_unpack16(&msg->signal, buffer);
+	}
+
+	return SLURM_SUCCESS;
+
+unpack_error:
+	*msg_ptr = NULL;
+	slurm_free_kill_jobs_msg(msg);
+	return SLURM_ERROR;
+}
+
+static void _pack_kill_jobs_resp_msg(kill_jobs_resp_msg_t *msg, Buf buffer,
+				     uint16_t protocol_version)
+{
+	xassert(msg);
+
+	if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+		pack32_array(msg->error_code, msg->jobs_cnt, buffer);
+	}
+}
+
+static int _unpack_kill_jobs_resp_msg(kill_jobs_resp_msg_t **msg_ptr,
+				      Buf buffer, uint16_t protocol_version)
+{
+	kill_jobs_resp_msg_t *msg = xmalloc(sizeof(*msg));
+	xassert(msg_ptr);
+	*msg_ptr = msg;
+
+	if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+		safe_unpack32_array(&msg->error_code, &msg->jobs_cnt, buffer);
+	}
+
+	return SLURM_SUCCESS;
+
+unpack_error:
+	*msg_ptr = NULL;
+	slurm_free_kill_jobs_response_msg(msg);
+	return SLURM_ERROR;
+}
+
 static void _pack_forward_data_msg(forward_data_msg_t *msg,
 				   Buf buffer, uint16_t protocol_version)
 {
@@ -10546,6 +10746,42 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static void _pack_node_heartbeat_msg(node_heartbeat_msg_t *msg, Buf buffer,
+				     uint16_t protocol_version)
+{
+	xassert(msg);
+
+	if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+		packstr(msg->node_name, buffer);
+		pack32(msg->cpu_load, buffer);
+		pack64(msg->free_mem, buffer);
+	}
+}
+
+static int _unpack_node_heartbeat_msg(node_heartbeat_msg_t **msg_ptr,
+				      Buf buffer, uint16_t protocol_version)
+{
+	node_heartbeat_msg_t *msg;
+	uint32_t uint32_tmp;
+
+	xassert(msg_ptr);
+	msg = xmalloc(sizeof(node_heartbeat_msg_t));
+	*msg_ptr = msg;
+
+	if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+		safe_unpackstr_xmalloc(&msg->node_name, &uint32_tmp, buffer);
+		safe_unpack32(&msg->cpu_load, buffer);
+		safe_unpack64(&msg->free_mem, buffer);
+	}
+
+	return SLURM_SUCCESS;
+
+unpack_error:
+	slurm_free_node_heartbeat_msg(msg);
+	*msg_ptr = NULL;
+	return SLURM_ERROR;
+}
+
 static void _pack_file_bcast(file_bcast_msg_t * msg , Buf buffer,
 			     uint16_t protocol_version)
 {
@@ -11365,7 +11601,94 @@ static int  _unpack_stats_response_msg(stats_info_response_msg_t **msg_ptr,
 	msg = xmalloc ( sizeof (stats_info_response_msg_t) );
 	*msg_ptr = msg ;
 
-	if (protocol_version >= SLURM_20_02_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+		safe_unpack32(&msg->parts_packed,	buffer);
+		if (msg->parts_packed) {
+			safe_unpack_time(&msg->req_time,	buffer);
+			safe_unpack_time(&msg->req_time_start,	buffer);
+			safe_unpack32(&msg->server_thread_count,buffer);
+			safe_unpack32(&msg->agent_queue_size,	buffer);
+			safe_unpack32(&msg->agent_count,	buffer);
+			safe_unpack32(&msg->agent_thread_count,	buffer);
+			safe_unpack32(&msg->dbd_agent_queue_size, buffer);
+			safe_unpack32(&msg->gettimeofday_latency, buffer);
+			safe_unpack32(&msg->jobs_submitted,	buffer);
+			safe_unpack32(&msg->jobs_started,	buffer);
+			safe_unpack32(&msg->jobs_completed,	buffer);
+			safe_unpack32(&msg->jobs_canceled,	buffer);
+			safe_unpack32(&msg->jobs_failed,	buffer);
+
+			safe_unpack32(&msg->jobs_pending,	buffer);
+			safe_unpack32(&msg->jobs_running,	buffer);
+			safe_unpack_time(&msg->job_states_ts,	buffer);
+
+			safe_unpack32(&msg->schedule_cycle_max,	buffer);
+			safe_unpack32(&msg->schedule_cycle_last,buffer);
+			safe_unpack32(&msg->schedule_cycle_sum,	buffer);
+			safe_unpack32(&msg->schedule_cycle_counter, buffer);
+			safe_unpack32(&msg->schedule_cycle_depth, buffer);
+			safe_unpack32(&msg->schedule_queue_len,	buffer);
+
+			safe_unpack32(&msg->bf_backfilled_jobs,	buffer);
+			safe_unpack32(&msg->bf_last_backfilled_jobs, buffer);
+			safe_unpack32(&msg->bf_cycle_counter,	buffer);
+			safe_unpack64(&msg->bf_cycle_sum,	buffer);
+			safe_unpack32(&msg->bf_cycle_last,	buffer);
+			safe_unpack32(&msg->bf_last_depth,	buffer);
+			safe_unpack32(&msg->bf_last_depth_try,	buffer);
+
+			safe_unpack32(&msg->bf_queue_len,	buffer);
+			safe_unpack32(&msg->bf_cycle_max,	buffer);
+			safe_unpack_time(&msg->bf_when_last_cycle, buffer);
+			safe_unpack32(&msg->bf_depth_sum,	buffer);
+			safe_unpack32(&msg->bf_depth_try_sum,	buffer);
+			safe_unpack32(&msg->bf_queue_len_sum,	buffer);
+			safe_unpack32(&msg->bf_table_size,	buffer);
+			safe_unpack32(&msg->bf_table_size_sum,	buffer);
+
+			safe_unpack32(&msg->bf_active,		buffer);
+			safe_unpack32(&msg->bf_backfilled_het_jobs, buffer);
+		}
+
+		safe_unpack32(&msg->rpc_type_size,		buffer);
+		safe_unpack16_array(&msg->rpc_type_id,   &uint32_tmp, buffer);
+		safe_unpack32_array(&msg->rpc_type_cnt,  &uint32_tmp, buffer);
+		safe_unpack64_array(&msg->rpc_type_time, &uint32_tmp, buffer);
+
+		safe_unpack32(&msg->rpc_user_size,		buffer);
+		safe_unpack32_array(&msg->rpc_user_id,   &uint32_tmp, buffer);
+		safe_unpack32_array(&msg->rpc_user_cnt,  &uint32_tmp, buffer);
+		safe_unpack64_array(&msg->rpc_user_time, &uint32_tmp, buffer);
+
+		safe_unpack32_array(&msg->rpc_queue_type_id,
+				    &msg->rpc_queue_type_count,
+				    buffer);
+		safe_unpack32_array(&msg->rpc_queue_count,
+				    &uint32_tmp, buffer);
+		if (uint32_tmp != msg->rpc_queue_type_count)
+			goto unpack_error;
+
+		safe_unpack32_array(&msg->rpc_dump_types,
+				    &msg->rpc_dump_count,
+				    buffer);
+		safe_unpackstr_array(&msg->rpc_dump_hostlist,
+				     &uint32_tmp,
+				     buffer);
+		if (uint32_tmp != msg->rpc_dump_count)
+			goto unpack_error;
+
+		safe_unpack32_array(&msg->rpc_throttle_user_id,
+				    &msg->rpc_throttle_user_count,
+				    buffer);
+		safe_unpack32_array(&msg->rpc_throttle_count,
+				    &uint32_tmp, buffer);
+		if (uint32_tmp != msg->rpc_throttle_user_count)
+			goto unpack_error;
+
+		safe_unpack64_array(&msg->rpc_type_max, &uint32_tmp, buffer);
+		if (uint32_tmp != msg->rpc_type_size)
+			goto unpack_error;
+	} else if (protocol_version >= SLURM_20_02_PROTOCOL_VERSION) {
 		safe_unpack32(&msg->parts_packed,	buffer);
 		if (msg->parts_packed) {
 			safe_unpack_time(&msg->req_time,	buffer);
@@ -12003,6 +12326,27 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+extern bool pack_msg_is_raw(uint16_t msg_type)
+{
+	switch (msg_type) {
+	case RESPONSE_JOB_INFO:
+	case RESPONSE_JOB_INFO_DELTA:
+	case RESPONSE_JOB_STEP_INFO:
+	case RESPONSE_PARTITION_INFO:
+	case RESPONSE_NODE_INFO:
+	case RESPONSE_RESERVATION_INFO:
+	case RESPONSE_LAYOUT_INFO:
+	case RESPONSE_BURST_BUFFER_INFO:
+	case RESPONSE_FRONT_END_INFO:
+	case RESPONSE_STATS_INFO:
+	case RESPONSE_LICENSE_INFO:
+	case RESPONSE_ASSOC_MGR_INFO:
+		return true;
+	default:
+		return false;
+	}
+}
+
 /* pack_msg
  * packs a generic slurm protocol message body
  * IN msg - the body structure to pack (note: includes message type)
@@ -12058,6 +12402,9 @@ pack_msg(slurm_msg_t const *msg, Buf buffer)
 	case RESPONSE_JOB_INFO:
 		_pack_job_info_msg((slurm_msg_t *) msg, buffer);
 		break;
+	case RESPONSE_JOB_INFO_DELTA:
+		_pack_job_info_delta_msg((slurm_msg_t *) msg, buffer);
+		break;
 	case RESPONSE_BATCH_SCRIPT:
 		_pack_job_script_msg((Buf) msg->data, buffer,
 				     msg->protocol_version);
@@ -12089,9 +12436,14 @@ pack_msg(slurm_msg_t const *msg, Buf buffer)
 		break;
 	case REQUEST_HET_JOB_ALLOCATION:
 	case REQUEST_SUBMIT_BATCH_HET_JOB:
+	case REQUEST_SUBMIT_BATCH_JOBS:
 		_pack_job_desc_list_msg((List) msg->data, buffer,
 					msg->protocol_version);
 		break;
+	case RESPONSE_SUBMIT_BATCH_JOBS:
+		_pack_submit_response_list_msg((List) msg->data, buffer,
+					       msg->protocol_version);
+		break;
 	case RESPONSE_HET_JOB_ALLOCATION:
 		_pack_job_info_list_msg((List) msg->data, buffer,
 					msg->protocol_version);
@@ -12274,6 +12626,11 @@ pack_msg(slurm_msg_t const *msg, Buf buffer)
 					   msg->data, buffer,
 					   msg->protocol_version);
 		break;
+	case REQUEST_JOB_INFO_DELTA:
+		_pack_job_info_delta_request_msg(
+			(job_info_delta_request_msg_t *) msg->data, buffer,
+			msg->protocol_version);
+		break;
 	case REQUEST_CANCEL_JOB_STEP:
 	case REQUEST_KILL_JOB:
 	case SRUN_STEP_SIGNAL:
@@ -12458,6 +12815,14 @@ pack_msg(slurm_msg_t const *msg, Buf buffer)
 		_pack_token_response_msg((token_response_msg_t *) msg->data,
 					 buffer, msg->protocol_version);
 		break;
+	case REQUEST_KILL_JOBS:
+		_pack_kill_jobs_msg((kill_jobs_msg_t *) msg->data, buffer,
+				    msg->protocol_version);
+		break;
+	case RESPONSE_KILL_JOBS:
+		_pack_kill_jobs_resp_msg((kill_jobs_resp_msg_t *) msg->data,
+					 buffer, msg->protocol_version);
+		break;
 	case REQUEST_BATCH_SCRIPT:
 	case REQUEST_JOB_READY:
 	case REQUEST_JOB_INFO_SINGLE:
@@ -12596,6 +12961,10 @@ pack_msg(slurm_msg_t const *msg, Buf buffer)
 		_pack_ping_slurmd_resp((ping_slurmd_resp_msg_t *)msg->data,
 				       buffer, msg->protocol_version);
 		break;
+	case MESSAGE_NODE_HEARTBEAT:
+		_pack_node_heartbeat_msg((node_heartbeat_msg_t *) msg->data,
+					 buffer, msg->protocol_version);
+		break;
 	case REQUEST_LICENSE_INFO:
 		 _pack_license_info_request_msg((license_info_request_msg_t *)
 						msg->data,
@@ -12721,6 +13090,11 @@ unpack_msg(slurm_msg_t * msg, Buf buffer)
 					  buffer,
 					  msg->protocol_version);
 		break;
+	case RESPONSE_JOB_INFO_DELTA:
+		rc = _unpack_job_info_delta_msg(
+			(job_info_delta_msg_t **) &(msg->data), buffer,
+			msg->protocol_version);
+		break;
 	case RESPONSE_BATCH_SCRIPT:
 		rc = _unpack_job_script_msg((char **) &(msg->data),
 					    buffer,
@@ -12757,9 +13131,15 @@ unpack_msg(slurm_msg_t * msg, Buf buffer)
 		break;
 	case REQUEST_HET_JOB_ALLOCATION:
 	case REQUEST_SUBMIT_BATCH_HET_JOB:
+	case REQUEST_SUBMIT_BATCH_JOBS:
 		rc = _unpack_job_desc_list_msg((List *) &(msg->data),
 					       buffer, msg->protocol_version);
 		break;
+	case RESPONSE_SUBMIT_BATCH_JOBS:
+		rc = _unpack_submit_response_list_msg((List *) &(msg->data),
+						      buffer,
+						      msg->protocol_version);
+		break;
 	case RESPONSE_HET_JOB_ALLOCATION:
 		rc = _unpack_job_info_list_msg((List *) &(msg->data),
 					       buffer, msg->protocol_version);
@@ -12956,6 +13336,11 @@ unpack_msg(slurm_msg_t * msg, Buf buffer)
 						  & (msg->data), buffer,
 						  msg->protocol_version);
 		break;
+	case REQUEST_JOB_INFO_DELTA:
+		rc = _unpack_job_info_delta_request_msg(
+			(job_info_delta_request_msg_t **) &(msg->data), buffer,
+			msg->protocol_version);
+		break;
 	case REQUEST_CANCEL_JOB_STEP:
 	case REQUEST_KILL_JOB:
 	case SRUN_STEP_SIGNAL:
@@ -13157,6 +13542,15 @@ unpack_msg(slurm_msg_t * msg, Buf buffer)
 						&msg->data,
 					        buffer, msg->protocol_version);
 		break;
+	case REQUEST_KILL_JOBS:
+		rc = _unpack_kill_jobs_msg((kill_jobs_msg_t **) &msg->data,
+					   buffer, msg->protocol_version);
+		break;
+	case RESPONSE_KILL_JOBS:
+		rc = _unpack_kill_jobs_resp_msg((kill_jobs_resp_msg_t **)
+						&msg->data,
+						buffer, msg->protocol_version);
+		break;
 	case REQUEST_BATCH_SCRIPT:
 	case REQUEST_JOB_READY:
 	case REQUEST_JOB_INFO_SINGLE:
@@ -13312,6 +13706,11 @@ unpack_msg(slurm_msg_t * msg, Buf buffer)
 					      &msg->data, buffer,
 					      msg->protocol_version);
 		break;
+	case MESSAGE_NODE_HEARTBEAT:
+		rc = _unpack_node_heartbeat_msg((node_heartbeat_msg_t **)
+						&msg->data, buffer,
+						msg->protocol_version);
+		break;
 	case RESPONSE_LICENSE_INFO:
 		rc = _unpack_license_info_msg((license_info_msg_t **)&(msg->data),
 					      buffer,
@@ -80,6 +80,13 @@ extern int unpack_header(header_t *header, Buf buffer);
  */
 extern int pack_msg(slurm_msg_t const *msg, Buf buffer);
 
+/*
+ * Return true if pack_msg() copies msg->data verbatim for this message type,
+ * as it does for the pre-packed info responses, so the data can be sent
+ * directly instead of being copied into the message buffer first.
+ */
+extern bool pack_msg_is_raw(uint16_t msg_type);
+
 /*
  * unpacks a generic slurm protocol message body
  * OUT msg - the body structure to unpack (note: includes message type)
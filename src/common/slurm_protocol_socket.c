@@ -197,6 +197,36 @@ ssize_t slurm_msg_sendto_timeout(int fd, char *buffer,
 	return len;
 }
 
+extern ssize_t slurm_msg_sendto_parts(int fd, char *head, size_t head_size,
+				      char *body, size_t body_size)
+{
+	int len, timeout = slurm_conf.msg_timeout * 1000;
+	uint32_t usize;
+	SigFunc *ohandler;
+
+	ohandler = xsignal(SIGPIPE, SIG_IGN);
+
+	usize = htonl(head_size + body_size);
+
+	if ((len = slurm_send_timeout(
+				fd, (char *)&usize, sizeof(usize), 0,
+				timeout)) < 0)
+		goto done;
+
+	if ((len = slurm_send_timeout(fd, head, head_size, 0, timeout)) < 0)
+		goto done;
+
+	if (body_size &&
+	    ((len = slurm_send_timeout(fd, body, body_size, 0, timeout)) < 0))
+		goto done;
+
+	len = head_size + body_size;
+
+done:
+	xsignal(SIGPIPE, ohandler);
+	return len;
+}
+
 /* Send slurm message with timeout
  * RET message size (as specified in argument) or SLURM_ERROR on error */
 extern int slurm_send_timeout(int fd, char *buf, size_t size,
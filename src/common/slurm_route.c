@@ -88,6 +88,7 @@ static slurm_addr_t *msg_collect_node = NULL; /* address of node to aggregate
 /* addresses of backup nodes to aggregate messages from this node */
 static uint32_t msg_backup_cnt = 0;
 static slurm_addr_t **msg_collect_backup  = NULL;
+static bool setting_collectors = false; /* _set_collectors() is running */
 
 /* _get_all_nodes creates a hostlist containing all the nodes in the
  * node_record_table.
@@ -166,6 +167,7 @@ static void _set_collectors(char *this_node_name)
 	parent_port = conf->slurmctld_port;
 	backup_port = parent_port;
 	slurm_conf_unlock();
+	setting_collectors = true;
 	while (1) {
 		if (route_g_split_hostlist(nodes, &hll, &hl_count, 0)) {
 			error("unable to split forward hostlist");
@@ -274,6 +276,7 @@ static void _set_collectors(char *this_node_name)
 			backup_port = 0;
 	}
 clean:
+	setting_collectors = false;
 	if (slurm_conf.debug_flags & DEBUG_FLAG_ROUTE) {
 		slurm_print_slurm_addr(msg_collect_node, addrbuf, 32);
 		xstrfmtcat(tmp, "ROUTE -- %s is a %s node (parent:%s",
@@ -516,6 +519,15 @@ extern int route_split_hostlist_treewidth(hostlist_t hl,
 	return SLURM_SUCCESS;
 }
 
+/*
+ * route_setting_collectors - true while this node computes its message
+ *	aggregation collectors
+ */
+extern bool route_setting_collectors(void)
+{
+	return setting_collectors;
+}
+
 /*
  * route_next_collector - get collector node address based
  *
@@ -135,6 +135,13 @@ extern int route_split_hostlist_treewidth(hostlist_t hl,
 					  hostlist_t** sp_hl,
 					  int* count, uint16_t tree_width);
 
+/*
+ * route_setting_collectors - true while this node computes its message
+ *	aggregation collectors. Every node must then derive the same tree, so
+ *	plugins must not vary their split from one call to the next.
+ */
+extern bool route_setting_collectors(void);
+
 /*
  * route_next_collector - return address of next collector
  *
@@ -665,7 +665,8 @@ static int _task_layout_cyclic(slurm_step_layout_t *step_layout,
 			       uint16_t *cpus)
 {
 	int i, j, max_over_subscribe = 0, taskid = 0, total_cpus = 0;
-	bool over_subscribe = false;
+	bool over_subscribe = false, init_over_subscribe;
+	uint32_t cur_task[step_layout->node_cnt];
 
 	for (i = 0; i < step_layout->node_cnt; i++)
 		total_cpus += cpus[i];
@@ -675,7 +676,12 @@ static int _task_layout_cyclic(slurm_step_layout_t *step_layout,
 		max_over_subscribe = (i + step_layout->node_cnt - 1) /
 				     step_layout->node_cnt;
 	}
+	init_over_subscribe = over_subscribe;
 
+	/*
+	 * Pass 1 counts the tasks per node, so that each tids array can be
+	 * allocated once. Pass 2 repeats the same walk to fill them in.
+	 */
 	for (j=0; taskid<step_layout->task_cnt; j++) {   /* cycle counter */
 		bool space_remaining = false;
 		for (i=0; ((i<step_layout->node_cnt)
@@ -683,11 +689,6 @@ static int _task_layout_cyclic(slurm_step_layout_t *step_layout,
 			if ((j < cpus[i]) ||
 			    (over_subscribe &&
 			     (j < (cpus[i] + max_over_subscribe)))) {
-				xrealloc(step_layout->tids[i], sizeof(uint32_t)
-					 * (step_layout->tasks[i] + 1));
-
-				step_layout->tids[i][step_layout->tasks[i]] =
-					taskid;
 				taskid++;
 				step_layout->tasks[i]++;
 				if ((j+1) < cpus[i])
@@ -697,6 +698,31 @@ static int _task_layout_cyclic(slurm_step_layout_t *step_layout,
 		if (!space_remaining)
 			over_subscribe = true;
 	}
+
+	for (i = 0; i < step_layout->node_cnt; i++) {
+		step_layout->tids[i] = xcalloc(step_layout->tasks[i],
+					       sizeof(uint32_t));
+		cur_task[i] = 0;
+	}
+
+	taskid = 0;
+	over_subscribe = init_over_subscribe;
+	for (j=0; taskid<step_layout->task_cnt; j++) {   /* cycle counter */
+		bool space_remaining = false;
+		for (i=0; ((i<step_layout->node_cnt)
+			   && (taskid<step_layout->task_cnt)); i++) {
+			if ((j < cpus[i]) ||
+			    (over_subscribe &&
+			     (j < (cpus[i] + max_over_subscribe)))) {
+				step_layout->tids[i][cur_task[i]++] = taskid;
+				taskid++;
+				if ((j+1) < cpus[i])
+					space_remaining = true;
+			}
+		}
+		if (!space_remaining)
+			over_subscribe = true;
+	}
 	return SLURM_SUCCESS;
 }
 
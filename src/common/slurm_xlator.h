@@ -81,6 +81,7 @@
 #define	bit_clear_all		slurm_bit_clear_all
 #define	bit_ffc			slurm_bit_ffc
 #define	bit_ffs			slurm_bit_ffs
+#define	bit_ffs_from_bit	slurm_bit_ffs_from_bit
 #define	bit_free		slurm_bit_free
 #define	bit_realloc		slurm_bit_realloc
 #define	bit_size		slurm_bit_size
@@ -135,6 +136,7 @@
 #define	hostlist_iterator_destroy slurm_hostlist_iterator_destroy
 #define	hostlist_iterator_reset	slurm_hostlist_iterator_reset
 #define	hostlist_next		slurm_hostlist_next
+#define	hostlist_next_buf	slurm_hostlist_next_buf
 #define	hostlist_next_range	slurm_hostlist_next_range
 #define	hostlist_nth		slurm_hostlist_nth
 #define	hostlist_pop            slurm_hostlist_pop
@@ -437,6 +439,7 @@
 
 
 #define eio_handle_create		slurm_eio_handle_create
+#define eio_handle_create_epoll		slurm_eio_handle_create_epoll
 #define eio_handle_destroy		slurm_eio_handle_destroy
 #define eio_handle_mainloop		slurm_eio_handle_mainloop
 #define eio_message_socket_accept	slurm_eio_message_socket_accept
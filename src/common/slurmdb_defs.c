@@ -2533,6 +2533,13 @@ extern void log_assoc_rec(slurmdb_assoc_rec_t *assoc_ptr,
 {
 	xassert(assoc_ptr);
 
+	/*
+	 * This is called for every association while assoc_mgr holds its
+	 * write locks, don't build the QOS and TRES strings for nothing.
+	 */
+	if (get_log_level() < LOG_LEVEL_DEBUG2)
+		return;
+
 	debug2("association rec id : %u", assoc_ptr->id);
 	debug2("  acct             : %s", assoc_ptr->acct);
 	debug2("  cluster          : %s", assoc_ptr->cluster);
@@ -3922,7 +3929,7 @@ extern int slurmdb_sort_tres_by_id_asc(void *v1, void *v2)
 extern void slurmdb_tres_list_from_string(
 	List *tres_list, char *tres, uint32_t flags)
 {
-	char *tmp_str = tres;
+	char *tmp_str = tres, *end_ptr = NULL;
 	int id;
 	uint64_t count;
 	slurmdb_tres_rec_t *tres_rec;
@@ -3935,20 +3942,27 @@ extern void slurmdb_tres_list_from_string(
 	if (tmp_str[0] == ',')
 		tmp_str++;
 
+	/*
+	 * This is run on every TRES string of every job and step read from
+	 * the database, so continue from where each number ended rather than
+	 * scanning the digits again for the '=' and ','.
+	 */
 	while (tmp_str) {
-		id = atoi(tmp_str);
+		id = strtol(tmp_str, &end_ptr, 10);
 		/* 0 isn't a valid tres id */
 		if (id <= 0) {
 			error("slurmdb_tres_list_from_string: no id "
 			      "found at %s instead", tmp_str);
 			break;
 		}
-		if (!(tmp_str = strchr(tmp_str, '='))) {
+		tmp_str = end_ptr;
+		if ((*tmp_str != '=') && !(tmp_str = strchr(tmp_str, '='))) {
 			error("slurmdb_tres_list_from_string: "
 			      "no value found %s", tres);
 			break;
 		}
-		count = slurm_atoull(++tmp_str);
+		count = strtoull(++tmp_str, &end_ptr, 10);
+		tmp_str = end_ptr;
 
 		if (!*tres_list)
 			*tres_list = list_create(slurmdb_destroy_tres_rec);
@@ -3991,7 +4005,7 @@ extern void slurmdb_tres_list_from_string(
 			}
 		}
 
-		if (!(tmp_str = strchr(tmp_str, ',')))
+		if ((*tmp_str != ',') && !(tmp_str = strchr(tmp_str, ',')))
 			break;
 		tmp_str++;
 	}
@@ -4088,14 +4102,16 @@ extern slurmdb_tres_rec_t *slurmdb_find_tres_in_string(
 
 extern uint64_t slurmdb_find_tres_count_in_string(char *tres_str_in, int id)
 {
-	char *tmp_str = tres_str_in;
+	char *tmp_str = tres_str_in, *end_ptr = NULL;
 
 	if (!tmp_str || !tmp_str[0])
 		return INFINITE64;
 
 	while (tmp_str) {
-		if (id == atoi(tmp_str)) {
-			if (!(tmp_str = strchr(tmp_str, '='))) {
+		if (id == strtol(tmp_str, &end_ptr, 10)) {
+			tmp_str = end_ptr;
+			if ((*tmp_str != '=') &&
+			    !(tmp_str = strchr(tmp_str, '='))) {
 				error("slurmdb_find_tres_count_in_string: "
 				      "no value found");
 				break;
@@ -4103,7 +4119,8 @@ extern uint64_t slurmdb_find_tres_count_in_string(char *tres_str_in, int id)
 			return slurm_atoull(++tmp_str);
 		}
 
-		if (!(tmp_str = strchr(tmp_str, ',')))
+		tmp_str = end_ptr;
+		if ((*tmp_str != ',') && !(tmp_str = strchr(tmp_str, ',')))
 			break;
 		tmp_str++;
 	}
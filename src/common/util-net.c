@@ -83,6 +83,28 @@ struct hostent * get_host_by_name(const char *name,
 
 	xassert(name && buf);
 
+#ifdef __GLIBC__
+	/*
+	 * glibc's gethostbyname_r() is reentrant, so resolve straight into
+	 * the caller's buffer without serializing every lookup in the
+	 * process behind hostentLock.
+	 */
+	if (buflen > sizeof(struct hostent)) {
+		struct hostent *he = buf;
+		int rc, err = 0;
+
+		rc = gethostbyname_r(name, he, (char *) buf + sizeof(*he),
+				     buflen - sizeof(*he), &hptr, &err);
+		if (h_err)
+			*h_err = err;
+		if (rc == ERANGE) {
+			errno = ERANGE;
+			return NULL;
+		}
+		return (rc || !hptr) ? NULL : he;
+	}
+#endif
+
 	slurm_mutex_lock(&hostentLock);
 	/* It appears gethostbyname leaks memory once.  Under the covers it
 	 * calls gethostbyname_r (at least on Ubuntu 16.10).  This leak doesn't
@@ -46,7 +46,7 @@
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
-#include "src/slurmrestd/workq.h"
+#include "src/common/workq.h"
 
 typedef struct {
 	int magic;
@@ -34,8 +34,8 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
 \*****************************************************************************/
 
-#ifndef SLURMRESTD_WORKQ_H
-#define SLURMRESTD_WORKQ_H
+#ifndef _COMMON_WORKQ_H
+#define _COMMON_WORKQ_H
 
 #include "src/common/list.h"
 
@@ -109,4 +109,4 @@ extern int workq_get_active(workq_t *workq);
 		_X = NULL;              \
 	} while (0)
 
-#endif /* SLURMRESTD_WORKQ_H */
+#endif /* _COMMON_WORKQ_H */
@@ -49,17 +49,18 @@
 #endif
 
 /*
- * FIXME:
- * A pre-malloced array of xhash_item_t could be associated to
- * the xhash_table in order to speed up the xhash_add function.
- * The default array size could be something like 10% of the
- * provided table_size (hash table are commonly defined larger
- * than necessary to avoid shared keys and usage of linked list)
+ * Hash items are carved out of blocks allocated by the table rather than
+ * malloced one by one. Block sizes start small, so that tiny tables stay
+ * tiny, and double up to a limit for large tables such as the node names.
+ * Removed items are kept on a free list and reused by xhash_add().
  */
+#define XHASH_BLOCK_MIN 8
+#define XHASH_BLOCK_MAX 1024
 
 typedef struct xhash_item_st {
 	void*		item;    /* user item                               */
 	UT_hash_handle	hh;      /* make this structure hashable by uthash  */
+	struct xhash_item_st* next_free; /* next unused item               */
 } xhash_item_t;
 
 struct xhash_st {
@@ -68,6 +69,10 @@ struct xhash_st {
 	xhash_item_t*		ht;       /* hash table                      */
 	xhash_idfunc_t		identify; /* function returning a unique str
 					     key */
+	xhash_item_t*		free_items; /* unused items                  */
+	xhash_item_t**		blocks;   /* item blocks allocated           */
+	uint32_t		block_cnt; /* number of blocks               */
+	uint32_t		block_size; /* items in the next block       */
 };
 
 xhash_t *xhash_init(xhash_idfunc_t idfunc, xhash_freefunc_t freefunc)
@@ -83,6 +88,38 @@ xhash_t *xhash_init(xhash_idfunc_t idfunc, xhash_freefunc_t freefunc)
 	return table;
 }
 
+static xhash_item_t* _item_alloc(xhash_t* table)
+{
+	xhash_item_t* block;
+	uint32_t i;
+
+	if (!table->free_items) {
+		if (table->block_size < XHASH_BLOCK_MIN)
+			table->block_size = XHASH_BLOCK_MIN;
+		block = xcalloc(table->block_size, sizeof(xhash_item_t));
+		for (i = 0; i < table->block_size; i++) {
+			block[i].next_free = table->free_items;
+			table->free_items = &block[i];
+		}
+		xrecalloc(table->blocks, table->block_cnt + 1,
+			  sizeof(xhash_item_t *));
+		table->blocks[table->block_cnt++] = block;
+		if (table->block_size < XHASH_BLOCK_MAX)
+			table->block_size *= 2;
+	}
+	block = table->free_items;
+	table->free_items = block->next_free;
+	block->next_free = NULL;
+	return block;
+}
+
+static void _item_free(xhash_t* table, xhash_item_t* hash_item)
+{
+	hash_item->item = NULL;
+	hash_item->next_free = table->free_items;
+	table->free_items = hash_item;
+}
+
 static xhash_item_t* xhash_find(xhash_t* table, const char* key, uint32_t len)
 {
 	xhash_item_t* hash_item = NULL;
@@ -114,7 +151,7 @@ void* xhash_add(xhash_t* table, void* item)
 
 	if (!table || !item)
 		return NULL;
-	hash_item = xmalloc(sizeof(xhash_item_t));
+	hash_item = _item_alloc(table);
 	hash_item->item    = item;
 	table->identify(item, &key, &keylen);
 	HASH_ADD_KEYPTR(hh, table->ht, key, keylen, hash_item);
@@ -130,7 +167,7 @@ void* xhash_pop(xhash_t* table, const char* key, uint32_t len)
 		return NULL;
 	item_item = item->item;
 	HASH_DELETE(hh, table->ht, item);
-	xfree(item);
+	_item_free(table, item);
 	--table->count;
 	return item_item;
 }
@@ -178,6 +215,7 @@ void xhash_clear(xhash_t* table)
 {
 	xhash_item_t* current_item = NULL;
 	xhash_item_t* tmp = NULL;
+	uint32_t i;
 
 	if (!table)
 		return;
@@ -185,9 +223,14 @@ void xhash_clear(xhash_t* table)
 		  HASH_DEL(table->ht, current_item);
 		  if (table->freefunc)
 			  table->freefunc(current_item->item);
-		  xfree(current_item);
 	}
 
+	for (i = 0; i < table->block_cnt; i++)
+		xfree(table->blocks[i]);
+	xfree(table->blocks);
+	table->block_cnt = 0;
+	table->block_size = 0;
+	table->free_items = NULL;
 	table->count = 0;
 }
 
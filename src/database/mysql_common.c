@@ -50,8 +50,39 @@
 
 #define MAX_DEADLOCK_ATTEMPTS 10
 
+/* Limits on queries waiting in mysql_conn->deferred_list */
+#define MAX_DEFERRED_CNT	1000
+#define MAX_DEFERRED_SIZE	(1024 * 1024)
+
+/* Prepared statements kept per connection by mysql_db_query_stmt() */
+#define MAX_STMT_CACHE		64
+
+typedef struct {
+	char *query;
+	MYSQL_STMT *stmt;
+} stmt_cache_t;
+
+/* How often to check replication lag or retry a failed replica */
+#define REPLICA_CHECK_INTERVAL	10
+
+/* Most server connections kept open by mysql_db_release_db_connection() */
+#define MAX_IDLE_DB_CONN	10
+
 static char *table_defs_table = "table_defs_table";
 
+/* An open server connection waiting to be reused */
+typedef struct {
+	MYSQL *db_conn;
+	char *db_name;
+	char *host;
+	uint32_t port;
+	char *user;
+} idle_conn_t;
+
+static idle_conn_t idle_conn[MAX_IDLE_DB_CONN];
+static int idle_conn_cnt = 0;
+static pthread_mutex_t idle_conn_lock = PTHREAD_MUTEX_INITIALIZER;
+
 typedef struct {
 	char *name;
 	char *columns;
@@ -202,6 +233,133 @@ end_it:
 	return rc;
 }
 
+static void _stmt_cache_free(void *x)
+{
+	stmt_cache_t *cache = x;
+
+	if (cache) {
+		mysql_stmt_close(cache->stmt);
+		xfree(cache->query);
+		xfree(cache);
+	}
+}
+
+static int _find_stmt_query(void *x, void *key)
+{
+	stmt_cache_t *cache = x;
+
+	return !xstrcmp(cache->query, key);
+}
+
+static int _find_stmt(void *x, void *key)
+{
+	stmt_cache_t *cache = x;
+
+	return (cache->stmt == key);
+}
+
+/*
+ * Return the prepared statement for query, preparing it if needed.
+ * NOTE: Ensure that mysql_conn->lock is set on function entry
+ */
+static MYSQL_STMT *_stmt_get(mysql_conn_t *mysql_conn, char *query)
+{
+	stmt_cache_t *cache;
+	MYSQL_STMT *stmt;
+
+	if (!mysql_conn->stmt_list)
+		mysql_conn->stmt_list = list_create(_stmt_cache_free);
+	else if ((cache = list_find_first(mysql_conn->stmt_list,
+					  _find_stmt_query, query)))
+		return cache->stmt;
+
+	if (!(stmt = mysql_stmt_init(mysql_conn->db_conn))) {
+		error("mysql_stmt_init failed: %s",
+		      mysql_error(mysql_conn->db_conn));
+		return NULL;
+	}
+	if (mysql_stmt_prepare(stmt, query, strlen(query))) {
+		errno = mysql_stmt_errno(stmt);
+		error("mysql_stmt_prepare failed: %d %s\n%s",
+		      errno, mysql_stmt_error(stmt), query);
+		mysql_stmt_close(stmt);
+		return NULL;
+	}
+
+	if (list_count(mysql_conn->stmt_list) >= MAX_STMT_CACHE)
+		list_flush(mysql_conn->stmt_list);
+	cache = xmalloc(sizeof(stmt_cache_t));
+	cache->query = xstrdup(query);
+	cache->stmt = stmt;
+	list_append(mysql_conn->stmt_list, cache);
+
+	return stmt;
+}
+
+/* NOTE: Ensure that mysql_conn->lock is set on function entry */
+static void _discard_deferred(mysql_conn_t *mysql_conn)
+{
+	if (mysql_conn->deferred_list)
+		list_flush(mysql_conn->deferred_list);
+	mysql_conn->deferred_size = 0;
+}
+
+/*
+ * Send the queries in mysql_conn->deferred_list as one multi-statement
+ * query. MySQL stops at the first statement that fails, so that statement
+ * is run again alone, to log the error and retry on deadlock, before the
+ * rest are sent. Each query thus runs as if it had been sent by itself.
+ * NOTE: Ensure that mysql_conn->lock is set on function entry
+ */
+static int _run_deferred(mysql_conn_t *mysql_conn)
+{
+	MYSQL *db_conn = mysql_conn->db_conn;
+	MYSQL_RES *result;
+	ListIterator itr;
+	char *query, *stmt;
+	int rc = SLURM_SUCCESS, done_cnt, next_rc;
+
+	if (!mysql_conn->deferred_list)
+		return rc;
+	if (!db_conn) {
+		_discard_deferred(mysql_conn);
+		return SLURM_ERROR;
+	}
+
+	while (list_count(mysql_conn->deferred_list)) {
+		query = NULL;
+		itr = list_iterator_create(mysql_conn->deferred_list);
+		while ((stmt = list_next(itr)))
+			xstrcat(query, stmt);
+		list_iterator_destroy(itr);
+
+		done_cnt = 0;
+		_clear_results(db_conn);
+		if (!mysql_query(db_conn, query)) {
+			do {
+				done_cnt++;
+				if ((result = mysql_store_result(db_conn)))
+					mysql_free_result(result);
+			} while (!(next_rc = mysql_next_result(db_conn)));
+			if (next_rc < 0)	/* all statements ran */
+				done_cnt = list_count(
+					mysql_conn->deferred_list);
+		}
+		xfree(query);
+
+		while (done_cnt--)
+			xfree_ptr(list_pop(mysql_conn->deferred_list));
+		if ((stmt = list_pop(mysql_conn->deferred_list))) {
+			if (_mysql_query_internal(db_conn, stmt))
+				rc = SLURM_ERROR;
+			xfree(stmt);
+		}
+	}
+	mysql_conn->deferred_size = 0;
+
+	return rc;
+}
+
 /* NOTE: Ensure that mysql_conn->lock is NOT set on function entry */
 static int _mysql_make_table_current(mysql_conn_t *mysql_conn, char *table_name,
 				     storage_field_t *fields, char *ending)
@@ -664,6 +822,8 @@ extern int destroy_mysql_conn(mysql_conn_t *mysql_conn)
 	if (mysql_conn) {
 		mysql_db_close_db_connection(mysql_conn);
 		xfree(mysql_conn->pre_commit_query);
+		FREE_NULL_LIST(mysql_conn->deferred_list);
+		FREE_NULL_LIST(mysql_conn->stmt_list);
 		xfree(mysql_conn->cluster_name);
 		slurm_mutex_destroy(&mysql_conn->lock);
 		FREE_NULL_LIST(mysql_conn->update_list);
@@ -709,11 +869,82 @@ extern int destroy_mysql_db_info(mysql_db_info_t *db_info)
 		xfree(db_info->host);
 		xfree(db_info->user);
 		xfree(db_info->pass);
+		xfree(db_info->replica);
 		xfree(db_info);
 	}
 	return SLURM_SUCCESS;
 }
 
+/* Take an idle connection to db_name on the primary of db_info, if any */
+static MYSQL *_idle_conn_get(char *db_name, mysql_db_info_t *db_info)
+{
+	MYSQL *db_conn = NULL;
+	int i;
+
+	slurm_mutex_lock(&idle_conn_lock);
+	for (i = idle_conn_cnt - 1; i >= 0; i--) {
+		if ((idle_conn[i].port != db_info->port) ||
+		    xstrcmp(idle_conn[i].db_name, db_name) ||
+		    xstrcmp(idle_conn[i].host, db_info->host) ||
+		    xstrcmp(idle_conn[i].user, db_info->user))
+			continue;
+		db_conn = idle_conn[i].db_conn;
+		xfree(idle_conn[i].db_name);
+		xfree(idle_conn[i].host);
+		xfree(idle_conn[i].user);
+		idle_conn[i] = idle_conn[--idle_conn_cnt];
+		break;
+	}
+	slurm_mutex_unlock(&idle_conn_lock);
+
+	return db_conn;
+}
+
+/* Keep db_conn open for reuse, return false if the pool is full */
+static bool _idle_conn_put(MYSQL *db_conn, char *db_name,
+			   mysql_db_info_t *db_info)
+{
+	bool rc = false;
+
+	slurm_mutex_lock(&idle_conn_lock);
+	if (idle_conn_cnt < MAX_IDLE_DB_CONN) {
+		idle_conn[idle_conn_cnt].db_conn = db_conn;
+		idle_conn[idle_conn_cnt].db_name = xstrdup(db_name);
+		idle_conn[idle_conn_cnt].host = xstrdup(db_info->host);
+		idle_conn[idle_conn_cnt].port = db_info->port;
+		idle_conn[idle_conn_cnt].user = xstrdup(db_info->user);
+		idle_conn_cnt++;
+		rc = true;
+	}
+	slurm_mutex_unlock(&idle_conn_lock);
+
+	return rc;
+}
+
+/*
+ * Reuse an idle connection for mysql_conn. The session settings are applied
+ * again since the client library may have silently reconnected.
+ * NOTE: Ensure that mysql_conn->lock is set on function entry
+ */
+static bool _idle_conn_reuse(mysql_conn_t *mysql_conn, char *db_name,
+			     mysql_db_info_t *db_info)
+{
+	while ((mysql_conn->db_conn = _idle_conn_get(db_name, db_info))) {
+		if (!mysql_autocommit(mysql_conn->db_conn, 0) &&
+		    (_mysql_query_internal(mysql_conn->db_conn,
+					   "SET session sql_mode='ANSI_QUOTES,"
+					   "NO_ENGINE_SUBSTITUTION';")
+		     == SLURM_SUCCESS)) {
+			debug2("Reusing idle connection to %s:%d",
+			       db_info->host, db_info->port);
+			return true;
+		}
+		mysql_close(mysql_conn->db_conn);
+	}
+
+	return false;
+}
+
 extern int mysql_db_get_db_connection(mysql_conn_t *mysql_conn, char *db_name,
 				      mysql_db_info_t *db_info)
 {
@@ -728,6 +959,14 @@ extern int mysql_db_get_db_connection(mysql_conn_t *mysql_conn, char *db_name,
 
 	slurm_mutex_lock(&mysql_conn->lock);
 
+	/* Only rollback connections are released to the idle pool */
+	if (mysql_conn->rollback &&
+	    _idle_conn_reuse(mysql_conn, db_name, db_info)) {
+		slurm_mutex_unlock(&mysql_conn->lock);
+		errno = SLURM_SUCCESS;
+		return SLURM_SUCCESS;
+	}
+
 	if (!(mysql_conn->db_conn = mysql_init(mysql_conn->db_conn))) {
 		slurm_mutex_unlock(&mysql_conn->lock);
 		fatal("mysql_init failed: %s",
@@ -792,9 +1031,146 @@ extern int mysql_db_get_db_connection(mysql_conn_t *mysql_conn, char *db_name,
 	return rc;
 }
 
+/* NOTE: Ensure that mysql_conn->lock is set on function entry */
+static void _replica_close(mysql_conn_t *mysql_conn)
+{
+	if (mysql_conn->primary_conn) {
+		mysql_conn->db_conn = mysql_conn->primary_conn;
+		mysql_conn->primary_conn = NULL;
+	}
+	if (mysql_conn->replica_conn) {
+		mysql_close(mysql_conn->replica_conn);
+		mysql_conn->replica_conn = NULL;
+	}
+	mysql_conn->replica_ok = false;
+}
+
+static MYSQL *_replica_connect(char *db_name, mysql_db_info_t *db_info)
+{
+	char *hosts = xstrdup(db_info->replica), *host, *save_ptr = NULL;
+	unsigned int my_timeout = 5;
+	MYSQL *db_conn = NULL;
+
+	for (host = strtok_r(hosts, ",", &save_ptr); host;
+	     host = strtok_r(NULL, ",", &save_ptr)) {
+		if (!(db_conn = mysql_init(NULL)))
+			break;
+		mysql_options(db_conn, MYSQL_OPT_CONNECT_TIMEOUT,
+			      (char *)&my_timeout);
+		if (mysql_real_connect(db_conn, host, db_info->user,
+				       db_info->pass, db_name, db_info->port,
+				       NULL, CLIENT_MULTI_STATEMENTS) &&
+		    (_mysql_query_internal(db_conn,
+					   "SET session sql_mode='ANSI_QUOTES,"
+					   "NO_ENGINE_SUBSTITUTION';")
+		     == SLURM_SUCCESS)) {
+			debug2("Connected to replica %s:%u",
+			       host, db_info->port);
+			break;
+		}
+		error("Connection to replica %s:%u failed: %d %s",
+		      host, db_info->port, mysql_errno(db_conn),
+		      mysql_error(db_conn));
+		mysql_close(db_conn);
+		db_conn = NULL;
+	}
+	xfree(hosts);
+
+	return db_conn;
+}
+
+/* Return true if replication to db_conn is running and within max_lag */
+static bool _replica_lag_ok(MYSQL *db_conn, uint32_t max_lag)
+{
+	MYSQL_RES *result;
+	MYSQL_FIELD *fields;
+	MYSQL_ROW row;
+	unsigned int i, num_fields;
+	bool ok = false;
+
+	_clear_results(db_conn);
+	if (mysql_query(db_conn, "show slave status;") ||
+	    !(result = mysql_store_result(db_conn))) {
+		error("Unable to get replica status: %d %s",
+		      mysql_errno(db_conn), mysql_error(db_conn));
+		return false;
+	}
+
+	/* A NULL lag means replication is stopped, no row means none */
+	if ((row = mysql_fetch_row(result))) {
+		num_fields = mysql_num_fields(result);
+		fields = mysql_fetch_fields(result);
+		for (i = 0; i < num_fields; i++) {
+			if (xstrcasecmp(fields[i].name,
+					"Seconds_Behind_Master"))
+				continue;
+			if (row[i] && (strtoul(row[i], NULL, 10) <= max_lag))
+				ok = true;
+			else
+				debug("Replica lag %s exceeds %u seconds, using primary",
+				      row[i] ? row[i] : "NULL", max_lag);
+			break;
+		}
+	}
+	mysql_free_result(result);
+
+	return ok;
+}
+
+extern bool mysql_db_replica_begin(mysql_conn_t *mysql_conn, char *db_name,
+				   mysql_db_info_t *db_info)
+{
+	time_t now = time(NULL);
+	bool use_replica;
+
+	if (!db_info->replica || !mysql_conn->db_conn)
+		return false;
+
+	slurm_mutex_lock(&mysql_conn->lock);
+	xassert(!mysql_conn->primary_conn);
+	/* Queued writes belong to the primary */
+	_run_deferred(mysql_conn);
+
+	if ((now - mysql_conn->replica_check) >= REPLICA_CHECK_INTERVAL) {
+		mysql_conn->replica_check = now;
+		if (mysql_conn->replica_conn &&
+		    mysql_ping(mysql_conn->replica_conn))
+			_replica_close(mysql_conn);
+		if (!mysql_conn->replica_conn)
+			mysql_conn->replica_conn =
+				_replica_connect(db_name, db_info);
+		mysql_conn->replica_ok =
+			mysql_conn->replica_conn &&
+			_replica_lag_ok(mysql_conn->replica_conn,
+					db_info->replica_max_lag);
+	}
+
+	if ((use_replica = mysql_conn->replica_ok)) {
+		mysql_conn->primary_conn = mysql_conn->db_conn;
+		mysql_conn->db_conn = mysql_conn->replica_conn;
+	}
+	slurm_mutex_unlock(&mysql_conn->lock);
+
+	return use_replica;
+}
+
+extern void mysql_db_replica_end(mysql_conn_t *mysql_conn)
+{
+	slurm_mutex_lock(&mysql_conn->lock);
+	if (mysql_conn->primary_conn) {
+		mysql_conn->db_conn = mysql_conn->primary_conn;
+		mysql_conn->primary_conn = NULL;
+	}
+	slurm_mutex_unlock(&mysql_conn->lock);
+}
+
 extern int mysql_db_close_db_connection(mysql_conn_t *mysql_conn)
 {
 	slurm_mutex_lock(&mysql_conn->lock);
+	_discard_deferred(mysql_conn);
+	_replica_close(mysql_conn);
+	/* Statements belong to the connection, close them first */
+	FREE_NULL_LIST(mysql_conn->stmt_list);
 	if (mysql_conn && mysql_conn->db_conn) {
 		if (mysql_thread_safe())
 			mysql_thread_end();
@@ -805,10 +1181,43 @@ extern int mysql_db_close_db_connection(mysql_conn_t *mysql_conn)
 	return SLURM_SUCCESS;
 }
 
+extern int mysql_db_release_db_connection(mysql_conn_t *mysql_conn,
+					  char *db_name,
+					  mysql_db_info_t *db_info)
+{
+	slurm_mutex_lock(&mysql_conn->lock);
+	_discard_deferred(mysql_conn);
+	_replica_close(mysql_conn);
+	FREE_NULL_LIST(mysql_conn->stmt_list);
+	if (mysql_conn->rollback && mysql_conn->db_conn &&
+	    !mysql_rollback(mysql_conn->db_conn) &&
+	    _idle_conn_put(mysql_conn->db_conn, db_name, db_info)) {
+		if (mysql_thread_safe())
+			mysql_thread_end();
+		mysql_conn->db_conn = NULL;
+	}
+	slurm_mutex_unlock(&mysql_conn->lock);
+
+	/* Close it if it could not be kept */
+	return mysql_db_close_db_connection(mysql_conn);
+}
+
 extern int mysql_db_cleanup()
 {
+	int i;
+
 	debug3("starting mysql cleaning up");
 
+	slurm_mutex_lock(&idle_conn_lock);
+	for (i = 0; i < idle_conn_cnt; i++) {
+		mysql_close(idle_conn[i].db_conn);
+		xfree(idle_conn[i].db_name);
+		xfree(idle_conn[i].host);
+		xfree(idle_conn[i].user);
+	}
+	idle_conn_cnt = 0;
+	slurm_mutex_unlock(&idle_conn_lock);
+
 #ifdef mysql_library_end
 	mysql_library_end();
 #else
@@ -827,11 +1236,137 @@ extern int mysql_db_query(mysql_conn_t *mysql_conn, char *query)
 		return 0;	/* For CLANG false positive */
 	}
 	slurm_mutex_lock(&mysql_conn->lock);
+	_run_deferred(mysql_conn);
 	rc = _mysql_query_internal(mysql_conn->db_conn, query);
 	slurm_mutex_unlock(&mysql_conn->lock);
 	return rc;
 }
 
+extern int mysql_db_query_defer(mysql_conn_t *mysql_conn, char *query)
+{
+	int rc = SLURM_SUCCESS;
+	char *stmt;
+
+	if (!mysql_conn->rollback)
+		return mysql_db_query(mysql_conn, query);
+
+	stmt = xstrdup(query);
+	if (stmt[strlen(stmt) - 1] != ';')
+		xstrcatchar(stmt, ';');
+
+	slurm_mutex_lock(&mysql_conn->lock);
+	if (!mysql_conn->deferred_list)
+		mysql_conn->deferred_list = list_create(xfree_ptr);
+	mysql_conn->deferred_size += strlen(stmt);
+	list_append(mysql_conn->deferred_list, stmt);
+	if ((list_count(mysql_conn->deferred_list) >= MAX_DEFERRED_CNT) ||
+	    (mysql_conn->deferred_size >= MAX_DEFERRED_SIZE))
+		rc = _run_deferred(mysql_conn);
+	slurm_mutex_unlock(&mysql_conn->lock);
+
+	return rc;
+}
+
+extern int mysql_db_query_stmt(mysql_conn_t *mysql_conn, char *query,
+			       mysql_stmt_args_t *args)
+{
+	MYSQL_STMT *stmt;
+	int rc = SLURM_ERROR, deadlock_attempt = 0;
+	bool reprepared = false;
+	uint32_t i;
+
+	if (!mysql_conn || !mysql_conn->db_conn) {
+		fatal("You haven't inited this storage yet.");
+		return 0;	/* For CLANG false positive */
+	}
+
+	for (i = 0; i < args->cnt; i++) {
+		if (args->bind[i].buffer_type == MYSQL_TYPE_LONGLONG)
+			args->bind[i].buffer = &args->val[i];
+		else
+			args->bind[i].length = &args->len[i];
+	}
+
+	slurm_mutex_lock(&mysql_conn->lock);
+	_run_deferred(mysql_conn);
+	/* clear out the old results so we don't get a 2014 error */
+	_clear_results(mysql_conn->db_conn);
+	while ((stmt = _stmt_get(mysql_conn, query))) {
+		if (mysql_stmt_param_count(stmt) != args->cnt) {
+			error("%s: query has %lu parameters, %u given\n%s",
+			      __func__, mysql_stmt_param_count(stmt),
+			      args->cnt, query);
+			break;
+		}
+		if (!mysql_stmt_bind_param(stmt, args->bind) &&
+		    !mysql_stmt_execute(stmt)) {
+			rc = SLURM_SUCCESS;
+			errno = 0;
+			break;
+		}
+
+		errno = mysql_stmt_errno(stmt);
+		if ((errno == ER_LOCK_DEADLOCK) &&
+		    (++deadlock_attempt < MAX_DEADLOCK_ATTEMPTS)) {
+			error("%s: deadlock detected attempt %u/%u: %d %s",
+			      __func__, deadlock_attempt,
+			      MAX_DEADLOCK_ATTEMPTS, errno,
+			      mysql_stmt_error(stmt));
+			continue;
+		}
+		error("%s: mysql_stmt_execute failed: %d %s\n%s",
+		      __func__, errno, mysql_stmt_error(stmt), query);
+
+		/*
+		 * An automatic reconnect loses every prepared statement, so
+		 * prepare it once more before giving up.
+		 */
+		list_delete_all(mysql_conn->stmt_list, _find_stmt, stmt);
+		if (reprepared)
+			break;
+		reprepared = true;
+	}
+	slurm_mutex_unlock(&mysql_conn->lock);
+
+	return rc;
+}
+
+extern void mysql_stmt_add_int(mysql_stmt_args_t *args, int64_t val)
+{
+	MYSQL_BIND *bind;
+
+	if (args->cnt >= MAX_STMT_ARGS)
+		fatal("%s: more than %d parameters", __func__, MAX_STMT_ARGS);
+
+	bind = &args->bind[args->cnt];
+	memset(bind, 0, sizeof(MYSQL_BIND));
+	bind->buffer_type = MYSQL_TYPE_LONGLONG;
+	args->val[args->cnt++] = val;
+}
+
+extern void mysql_stmt_add_uint(mysql_stmt_args_t *args, uint64_t val)
+{
+	mysql_stmt_add_int(args, (int64_t) val);
+	args->bind[args->cnt - 1].is_unsigned = 1;
+}
+
+extern void mysql_stmt_add_str(mysql_stmt_args_t *args, const char *str)
+{
+	MYSQL_BIND *bind;
+
+	if (args->cnt >= MAX_STMT_ARGS)
+		fatal("%s: more than %d parameters", __func__, MAX_STMT_ARGS);
+
+	if (!str)
+		str = "";
+	bind = &args->bind[args->cnt];
+	memset(bind, 0, sizeof(MYSQL_BIND));
+	bind->buffer_type = MYSQL_TYPE_STRING;
+	bind->buffer = (char *) str;
+	bind->buffer_length = strlen(str);
+	args->len[args->cnt++] = bind->buffer_length;
+}
+
 /*
  * Executes a single delete sql query.
  * Returns the number of deleted rows, <0 for failure.
@@ -845,6 +1380,7 @@ extern int mysql_db_delete_affected_rows(mysql_conn_t *mysql_conn, char *query)
 		return 0;	/* For CLANG false positive */
 	}
 	slurm_mutex_lock(&mysql_conn->lock);
+	_run_deferred(mysql_conn);
 	if (!(rc = _mysql_query_internal(mysql_conn->db_conn, query)))
 		rc = mysql_affected_rows(mysql_conn->db_conn);
 	slurm_mutex_unlock(&mysql_conn->lock);
@@ -862,6 +1398,14 @@ extern int mysql_db_ping(mysql_conn_t *mysql_conn)
 	slurm_mutex_lock(&mysql_conn->lock);
 	_clear_results(mysql_conn->db_conn);
 	rc = mysql_ping(mysql_conn->db_conn);
+	if (rc && mysql_conn->primary_conn) {
+		/* Lost the replica, finish the request on the primary */
+		error("Lost connection to replica, using primary");
+		_replica_close(mysql_conn);
+		mysql_conn->replica_check = time(NULL);
+		_clear_results(mysql_conn->db_conn);
+		rc = mysql_ping(mysql_conn->db_conn);
+	}
 	/*
 	 * Starting in MariaDB 10.2 many of the api commands started
 	 * setting errno erroneously.
@@ -880,6 +1424,7 @@ extern int mysql_db_commit(mysql_conn_t *mysql_conn)
 		return SLURM_ERROR;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	_run_deferred(mysql_conn);
 	/* clear out the old results so we don't get a 2014 error */
 	_clear_results(mysql_conn->db_conn);
 	if (mysql_commit(mysql_conn->db_conn)) {
@@ -901,6 +1446,7 @@ extern int mysql_db_rollback(mysql_conn_t *mysql_conn)
 		return SLURM_ERROR;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	_discard_deferred(mysql_conn);
 	/* clear out the old results so we don't get a 2014 error */
 	_clear_results(mysql_conn->db_conn);
 	if (mysql_rollback(mysql_conn->db_conn)) {
@@ -927,6 +1473,7 @@ extern MYSQL_RES *mysql_db_query_ret(mysql_conn_t *mysql_conn,
 	MYSQL_RES *result = NULL;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	_run_deferred(mysql_conn);
 	if (_mysql_query_internal(mysql_conn->db_conn, query) != SLURM_ERROR)  {
 		if (mysql_errno(mysql_conn->db_conn) == ER_NO_SUCH_TABLE)
 			goto fini;
@@ -956,6 +1503,7 @@ extern int mysql_db_query_check_after(mysql_conn_t *mysql_conn, char *query)
 	int rc = SLURM_SUCCESS;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	_run_deferred(mysql_conn);
 	if ((rc = _mysql_query_internal(
 		     mysql_conn->db_conn, query)) != SLURM_ERROR)
 		rc = _clear_results(mysql_conn->db_conn);
@@ -968,6 +1516,7 @@ extern uint64_t mysql_db_insert_ret_id(mysql_conn_t *mysql_conn, char *query)
 	uint64_t new_id = 0;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	_run_deferred(mysql_conn);
 	if (_mysql_query_internal(mysql_conn->db_conn, query) != SLURM_ERROR)  {
 		new_id = mysql_insert_id(mysql_conn->db_conn);
 		if (!new_id) {
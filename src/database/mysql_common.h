@@ -62,8 +62,15 @@ typedef struct {
 	bool cluster_deleted;
 	char *cluster_name;
 	MYSQL *db_conn;
+	List deferred_list;	/* queries for mysql_db_query_defer() */
+	uint32_t deferred_size;	/* bytes of queries in deferred_list */
 	pthread_mutex_t lock;
 	char *pre_commit_query;
+	MYSQL *primary_conn;	/* db_conn while replica_conn is in use */
+	List stmt_list;		/* statements for mysql_db_query_stmt() */
+	MYSQL *replica_conn;
+	time_t replica_check;	/* last time replica_conn lag was checked */
+	bool replica_ok;	/* replica_conn is up and within max lag */
 	bool rollback;
 	List update_list;
 	int conn;
@@ -75,6 +82,8 @@ typedef struct {
 	char *host;
 	char *user;
 	char *pass;
+	char *replica;		/* comma separated read-only replica hosts */
+	uint32_t replica_max_lag; /* seconds a replica may be behind */
 } mysql_db_info_t;
 
 typedef struct {
@@ -82,6 +91,16 @@ typedef struct {
 	char *options;
 } storage_field_t;
 
+#define MAX_STMT_ARGS 32
+
+/* Parameters for mysql_db_query_stmt(), add them with mysql_stmt_add_*() */
+typedef struct {
+	uint32_t cnt;
+	MYSQL_BIND bind[MAX_STMT_ARGS];
+	long long val[MAX_STMT_ARGS];
+	unsigned long len[MAX_STMT_ARGS];
+} mysql_stmt_args_t;
+
 extern mysql_conn_t *create_mysql_conn(int conn_num, bool rollback,
 				       char *cluster_name);
 extern int destroy_mysql_conn(mysql_conn_t *mysql_conn);
@@ -91,8 +110,47 @@ extern int destroy_mysql_db_info(mysql_db_info_t *db_info);
 extern int mysql_db_get_db_connection(mysql_conn_t *mysql_conn, char *db_name,
 				   mysql_db_info_t *db_info);
 extern int mysql_db_close_db_connection(mysql_conn_t *mysql_conn);
+/*
+ * Like mysql_db_close_db_connection(), but roll back and keep the server
+ * connection of a rollback mysql_conn open, so that the next
+ * mysql_db_get_db_connection() to the same database can skip the connect
+ * and authentication round trips. Up to 10 connections are kept.
+ */
+extern int mysql_db_release_db_connection(mysql_conn_t *mysql_conn,
+					  char *db_name,
+					  mysql_db_info_t *db_info);
+/*
+ * Send the queries that follow on mysql_conn to one of db_info->replica
+ * instead of the primary, as long as the replica is reachable and no more
+ * than db_info->replica_max_lag seconds behind. Only use this for read only
+ * requests that can live with that staleness. Returns true if the replica is
+ * in use, in which case mysql_db_replica_end() must be called afterwards.
+ */
+extern bool mysql_db_replica_begin(mysql_conn_t *mysql_conn, char *db_name,
+				   mysql_db_info_t *db_info);
+extern void mysql_db_replica_end(mysql_conn_t *mysql_conn);
 extern int mysql_db_cleanup();
 extern int mysql_db_query(mysql_conn_t *mysql_conn, char *query);
+/*
+ * Queue a query that returns no data to be sent along with others in one
+ * round trip, ahead of the next query on the connection or the commit.
+ * Errors are logged when the query is run rather than returned. Run now if
+ * the connection is not transactional.
+ */
+extern int mysql_db_query_defer(mysql_conn_t *mysql_conn, char *query);
+/*
+ * Run query, which has a '?' in place of each of the parameters in args, as a
+ * server side prepared statement. The statement is prepared the first time
+ * the query text is seen on the connection and reused after that, and the
+ * parameters are sent in binary so they need no formatting or escaping. Use
+ * it for statements run often with the same text.
+ */
+extern int mysql_db_query_stmt(mysql_conn_t *mysql_conn, char *query,
+			       mysql_stmt_args_t *args);
+extern void mysql_stmt_add_int(mysql_stmt_args_t *args, int64_t val);
+extern void mysql_stmt_add_uint(mysql_stmt_args_t *args, uint64_t val);
+/* A NULL str is sent as an empty string */
+extern void mysql_stmt_add_str(mysql_stmt_args_t *args, const char *str);
 extern int mysql_db_delete_affected_rows(mysql_conn_t *mysql_conn, char *query);
 extern int mysql_db_ping(mysql_conn_t *mysql_conn);
 extern int mysql_db_commit(mysql_conn_t *mysql_conn);
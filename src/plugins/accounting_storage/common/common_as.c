@@ -36,12 +36,18 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
 \*****************************************************************************/
 
+#include "config.h"
+
 #include <fcntl.h>
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#if HAVE_LIBZ
+#  include <zlib.h>
+#endif
+
 #include "src/common/env.h"
 #include "src/common/slurmdbd_defs.h"
 #include "src/common/slurm_auth.h"
@@ -892,6 +898,7 @@ extern int archive_write_file(Buf buffer, char *cluster_name,
 				      arch_type, archive_period);
 	if (!new_file) {
 		error("%s: Unable to make archive file name.", __func__);
+		slurm_mutex_unlock(&local_file_lock);
 		return SLURM_ERROR;
 	}
 
@@ -902,6 +909,36 @@ extern int archive_write_file(Buf buffer, char *cluster_name,
 	if (fd < 0) {
 		error("Can't save archive, create file %s error %m", new_file);
 		rc = SLURM_ERROR;
+#if HAVE_LIBZ
+	} else if (slurmdbd_conf && slurmdbd_conf->archive_compress) {
+		/*
+		 * Archives are mostly repeated names and small integers and
+		 * shrink several times over, which matters when the archive
+		 * directory is shared or kept for years.
+		 */
+		gzFile gz = gzdopen(fd, "wb");
+		uint32_t nwrite = get_buf_offset(buffer);
+
+		if (!gz) {
+			error("Can't save archive, gzdopen file %s error %m",
+			      new_file);
+			close(fd);
+			rc = SLURM_ERROR;
+		} else {
+			if (nwrite &&
+			    (gzwrite(gz, get_buf_data(buffer), nwrite) <= 0)) {
+				error("Error writing file %s", new_file);
+				rc = SLURM_ERROR;
+			}
+			if (gzflush(gz, Z_FINISH) != Z_OK)
+				rc = SLURM_ERROR;
+			fsync(fd);
+			if (gzclose(gz) != Z_OK) {
+				error("Error closing file %s", new_file);
+				rc = SLURM_ERROR;
+			}
+		}
+#endif
 	} else {
 		int amount;
 		uint32_t pos = 0, nwrite = get_buf_offset(buffer);
@@ -925,3 +962,63 @@ extern int archive_write_file(Buf buffer, char *cluster_name,
 
 	return rc;
 }
+
+extern int archive_read_file(char *file_name, char **data,
+			     uint32_t *data_size)
+{
+	uint32_t data_allocated = BUF_SIZE + 1, data_read_total = 0;
+	int data_read, rc = SLURM_SUCCESS;
+#if HAVE_LIBZ
+	/* gzread() passes uncompressed archives through unchanged */
+	gzFile state_fd = gzopen(file_name, "rb");
+
+	if (!state_fd) {
+#else
+	int state_fd = open(file_name, O_RDONLY);
+
+	if (state_fd < 0) {
+#endif
+		info("Could not open archive file `%s`: %m", file_name);
+		return errno ? errno : SLURM_ERROR;
+	}
+
+	*data = xmalloc_nz(data_allocated);
+	while (1) {
+		if ((data_allocated - data_read_total) <= BUF_SIZE) {
+			data_allocated *= 2;
+			xrealloc_nz(*data, data_allocated);
+		}
+#if HAVE_LIBZ
+		data_read = gzread(state_fd, *data + data_read_total,
+				   data_allocated - data_read_total - 1);
+#else
+		data_read = read(state_fd, *data + data_read_total,
+				 data_allocated - data_read_total - 1);
+#endif
+		if (data_read < 0) {
+			if (errno == EINTR)
+				continue;
+			error("Read error on %s: %m", file_name);
+			rc = errno ? errno : SLURM_ERROR;
+			break;
+		}
+		if (data_read == 0)	/* eof */
+			break;
+		data_read_total += data_read;
+	}
+	(*data)[data_read_total] = '\0';
+#if HAVE_LIBZ
+	gzclose(state_fd);
+#else
+	close(state_fd);
+#endif
+
+	if (rc != SLURM_SUCCESS) {
+		xfree(*data);
+		data_read_total = 0;
+	}
+	if (data_size)
+		*data_size = data_read_total;
+
+	return rc;
+}
@@ -85,4 +85,15 @@ extern int archive_write_file(Buf buffer, char *cluster_name,
 			      char *arch_dir, char *arch_type,
 			      uint32_t archive_period);
 
+/*
+ * Read a whole archive file, compressed or not, into a NUL terminated xmalloc
+ * buffer.
+ * IN file_name - archive file to read
+ * OUT data - file contents, must be xfreed by caller
+ * OUT data_size - number of bytes read, not counting the terminator
+ * RET SLURM_SUCCESS or an errno value
+ */
+extern int archive_read_file(char *file_name, char **data,
+			     uint32_t *data_size);
+
 #endif
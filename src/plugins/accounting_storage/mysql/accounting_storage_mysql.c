@@ -150,6 +150,29 @@ bool backup_dbd = 0;
 
 static char *default_qos_str = NULL;
 
+/*
+ * Updates committed within ACCT_UPDATE_DELAY_MSEC of each other are sent to
+ * the clusters together by _update_agent(), with consecutive objects of the
+ * same type merged so each controller takes its locks once per type instead
+ * of once per commit. Controllers so learn of a commit up to
+ * ACCT_UPDATE_DELAY_MSEC after the client saw it succeed.
+ */
+#define ACCT_UPDATE_DELAY_MSEC 500
+
+typedef struct {
+	char *control_host;
+	uint16_t control_port;
+	char *name;
+	uint16_t rpc_version;
+} update_cluster_t;
+
+static pthread_mutex_t update_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t update_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t update_thread = 0;
+static bool update_shutdown = false;
+static List update_pending = NULL;	/* slurmdb_update_object_t */
+static List update_clusters = NULL;	/* update_cluster_t */
+
 enum {
 	JASSOC_JOB,
 	JASSOC_ACCT,
@@ -1118,6 +1141,21 @@ extern int check_connection(mysql_conn_t *mysql_conn)
 	return SLURM_SUCCESS;
 }
 
+/*
+ * Send a read only request to a StorageReplicaHost if one is usable, see
+ * mysql_db_replica_begin(). Only job, usage and transaction queries use this,
+ * they are the bulk of sacct and sreport load and a few seconds of staleness
+ * is harmless there. Everything else stays on the primary so sacctmgr and
+ * slurmctld always see their own writes.
+ */
+static bool _replica_begin(mysql_conn_t *mysql_conn)
+{
+	if (!mysql_conn || !mysql_conn->db_conn)
+		return false;
+	return mysql_db_replica_begin(mysql_conn, mysql_db_name,
+				      mysql_db_info);
+}
+
 /* Let me know if the last statement had rows that were affected.
  * This only gets called by a non-threaded connection, so there is no
  * need to worry about locks.
@@ -2620,6 +2658,8 @@ extern int init(void)
 	}
 
 	mysql_db_info = create_mysql_db_info(SLURM_MYSQL_PLUGIN_AS);
+	mysql_db_info->replica = xstrdup(slurmdbd_conf->storage_replica_host);
+	mysql_db_info->replica_max_lag = slurmdbd_conf->storage_replica_max_lag;
 	mysql_db_name = acct_get_db_name();
 
 	debug2("mysql_connect() called for db %s", mysql_db_name);
@@ -2656,6 +2696,17 @@ extern int init(void)
 
 extern int fini ( void )
 {
+	slurm_mutex_lock(&update_lock);
+	update_shutdown = true;
+	slurm_cond_broadcast(&update_cond);
+	slurm_mutex_unlock(&update_lock);
+	if (update_thread) {
+		pthread_join(update_thread, NULL);
+		update_thread = 0;
+	}
+	FREE_NULL_LIST(update_pending);
+	FREE_NULL_LIST(update_clusters);
+
 	slurm_mutex_lock(&as_mysql_cluster_list_lock);
 	FREE_NULL_LIST(as_mysql_cluster_list);
 	FREE_NULL_LIST(as_mysql_total_cluster_list);
@@ -2742,12 +2793,195 @@ extern int acct_storage_p_close_connection(mysql_conn_t **mysql_conn)
 		return SLURM_SUCCESS;
 
 	acct_storage_p_commit((*mysql_conn), 0);
+	mysql_db_release_db_connection(*mysql_conn, mysql_db_name,
+				       mysql_db_info);
 	rc = destroy_mysql_conn(*mysql_conn);
 	*mysql_conn = NULL;
 
 	return rc;
 }
 
+static void _destroy_update_cluster(void *object)
+{
+	update_cluster_t *cluster = object;
+
+	if (cluster) {
+		xfree(cluster->control_host);
+		xfree(cluster->name);
+		xfree(cluster);
+	}
+}
+
+static int _find_update_feds(void *x, void *key)
+{
+	slurmdb_update_object_t *object = x;
+
+	return (object->type == SLURMDB_UPDATE_FEDS);
+}
+
+static int _find_update_cluster(void *x, void *key)
+{
+	update_cluster_t *cluster = x;
+
+	return !xstrcmp(cluster->name, key);
+}
+
+/*
+ * Copy the objects of update_list by packing and unpacking them, since the
+ * originals are consumed by assoc_mgr_update() once the commit returns.
+ */
+static List _copy_update_list(List update_list)
+{
+	List copy_list = list_create(slurmdb_destroy_update_object);
+	ListIterator itr = list_iterator_create(update_list);
+	slurmdb_update_object_t *object;
+	Buf buffer = init_buf(BUF_SIZE);
+	uint32_t i, count = 0;
+
+	while ((object = list_next(itr))) {
+		if (!object->objects || !list_count(object->objects))
+			continue;
+		slurmdb_pack_update_object(object, SLURM_PROTOCOL_VERSION,
+					   buffer);
+		count++;
+	}
+	list_iterator_destroy(itr);
+
+	set_buf_offset(buffer, 0);
+	for (i = 0; i < count; i++) {
+		if (slurmdb_unpack_update_object(&object,
+						 SLURM_PROTOCOL_VERSION,
+						 buffer) != SLURM_SUCCESS) {
+			error("%s: unable to copy update object", __func__);
+			break;
+		}
+		list_append(copy_list, object);
+	}
+	free_buf(buffer);
+
+	return copy_list;
+}
+
+static void *_update_agent(void *arg)
+{
+	struct timespec abs_time;
+	List send_list, clusters;
+	ListIterator itr;
+	update_cluster_t *cluster;
+
+	slurm_mutex_lock(&update_lock);
+	while (1) {
+		while (!update_shutdown && !list_count(update_pending))
+			slurm_cond_wait(&update_cond, &update_lock);
+
+		/* Give back-to-back commits a chance to join this batch */
+		if (!update_shutdown) {
+			clock_gettime(CLOCK_REALTIME, &abs_time);
+			abs_time.tv_nsec += ACCT_UPDATE_DELAY_MSEC * 1000000;
+			abs_time.tv_sec += abs_time.tv_nsec / 1000000000;
+			abs_time.tv_nsec %= 1000000000;
+			while (!update_shutdown &&
+			       (pthread_cond_timedwait(&update_cond,
+						       &update_lock,
+						       &abs_time) != ETIMEDOUT))
+				;
+		}
+
+		if (!list_count(update_pending)) {
+			if (update_shutdown)
+				break;
+			continue;
+		}
+		send_list = update_pending;
+		update_pending = list_create(slurmdb_destroy_update_object);
+		clusters = update_clusters;
+		update_clusters = NULL;
+		slurm_mutex_unlock(&update_lock);
+
+		if (clusters) {
+			itr = list_iterator_create(clusters);
+			while ((cluster = list_next(itr))) {
+				(void) slurmdb_send_accounting_update(
+					send_list, cluster->name,
+					cluster->control_host,
+					cluster->control_port,
+					cluster->rpc_version);
+			}
+			list_iterator_destroy(itr);
+		}
+		FREE_NULL_LIST(send_list);
+		FREE_NULL_LIST(clusters);
+
+		slurm_mutex_lock(&update_lock);
+	}
+	slurm_mutex_unlock(&update_lock);
+
+	return NULL;
+}
+
+/*
+ * Queue a copy of update_list to be sent to clusters by _update_agent().
+ * IN update_list - updates of the commit
+ * IN clusters - clusters registered at the time of the commit, consumed
+ */
+static void _queue_update(List update_list, List clusters)
+{
+	List copy_list = _copy_update_list(update_list);
+	slurmdb_update_object_t *object, *last, *next;
+	update_cluster_t *cluster;
+	ListIterator itr;
+	List tmp_list;
+
+	slurm_mutex_lock(&update_lock);
+	if (!update_pending)
+		update_pending = list_create(slurmdb_destroy_update_object);
+	while ((object = list_pop(copy_list))) {
+		/*
+		 * Federation updates carry the whole state, so the newest
+		 * replaces the contents of one already queued, which keeps
+		 * its place in the batch.
+		 */
+		if ((object->type == SLURMDB_UPDATE_FEDS) &&
+		    (next = list_find_first(update_pending, _find_update_feds,
+					    NULL))) {
+			tmp_list = next->objects;
+			next->objects = object->objects;
+			object->objects = tmp_list;
+			slurmdb_destroy_update_object(object);
+			continue;
+		}
+		last = NULL;
+		itr = list_iterator_create(update_pending);
+		while ((next = list_next(itr)))
+			last = next;
+		list_iterator_destroy(itr);
+		if (last && (last->type == object->type)) {
+			list_transfer(last->objects, object->objects);
+			slurmdb_destroy_update_object(object);
+		} else
+			list_append(update_pending, object);
+	}
+	FREE_NULL_LIST(copy_list);
+
+	/*
+	 * Send the batch to every cluster registered when any of its commits
+	 * was made, with the newest address known for each.
+	 */
+	if (!update_clusters)
+		update_clusters = list_create(_destroy_update_cluster);
+	while ((cluster = list_pop(clusters))) {
+		(void) list_delete_all(update_clusters, _find_update_cluster,
+				       cluster->name);
+		list_append(update_clusters, cluster);
+	}
+	FREE_NULL_LIST(clusters);
+
+	if (!update_thread && !update_shutdown)
+		slurm_thread_create(&update_thread, _update_agent, NULL);
+	slurm_cond_broadcast(&update_cond);
+	slurm_mutex_unlock(&update_lock);
+}
+
 extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 {
 	int rc = check_connection(mysql_conn);
@@ -2802,6 +3036,8 @@ extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 		MYSQL_ROW row;
 		ListIterator itr = NULL;
 		slurmdb_update_object_t *object = NULL;
+		List clusters = NULL;
+		update_cluster_t *cluster;
 
 		xstrfmtcat(query, "select control_host, control_port, "
 			   "name, rpc_version, flags "
@@ -2813,16 +3049,19 @@ extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 			goto skip;
 		}
 		xfree(query);
+		clusters = list_create(_destroy_update_cluster);
 		while ((row = mysql_fetch_row(result))) {
 			if (slurm_atoul(row[4]) & CLUSTER_FLAG_EXT)
 				continue;
-			(void) slurmdb_send_accounting_update(
-				mysql_conn->update_list,
-				row[2], row[0],
-				slurm_atoul(row[1]),
-				slurm_atoul(row[3]));
+			cluster = xmalloc(sizeof(update_cluster_t));
+			cluster->control_host = xstrdup(row[0]);
+			cluster->control_port = slurm_atoul(row[1]);
+			cluster->name = xstrdup(row[2]);
+			cluster->rpc_version = slurm_atoul(row[3]);
+			list_append(clusters, cluster);
 		}
 		mysql_free_result(result);
+		_queue_update(mysql_conn->update_list, clusters);
 	skip:
 		(void) assoc_mgr_update(mysql_conn->update_list, 0);
 
@@ -3176,14 +3415,28 @@ extern List acct_storage_p_get_reservations(
 extern List acct_storage_p_get_txn(mysql_conn_t *mysql_conn, uid_t uid,
 				   slurmdb_txn_cond_t *txn_cond)
 {
-	return as_mysql_get_txn(mysql_conn, uid, txn_cond);
+	List txn_list;
+	bool replica = _replica_begin(mysql_conn);
+
+	txn_list = as_mysql_get_txn(mysql_conn, uid, txn_cond);
+	if (replica)
+		mysql_db_replica_end(mysql_conn);
+
+	return txn_list;
 }
 
 extern int acct_storage_p_get_usage(mysql_conn_t *mysql_conn, uid_t uid,
 				    void *in, slurmdbd_msg_type_t type,
 				    time_t start, time_t end)
 {
-	return as_mysql_get_usage(mysql_conn, uid, in, type, start, end);
+	int rc;
+	bool replica = _replica_begin(mysql_conn);
+
+	rc = as_mysql_get_usage(mysql_conn, uid, in, type, start, end);
+	if (replica)
+		mysql_db_replica_end(mysql_conn);
+
+	return rc;
 }
 
 extern int acct_storage_p_roll_usage(mysql_conn_t *mysql_conn,
@@ -3364,11 +3617,15 @@ extern List jobacct_storage_p_get_jobs_cond(mysql_conn_t *mysql_conn,
 					    slurmdb_job_cond_t *job_cond)
 {
 	List job_list = NULL;
+	bool replica;
 
 	if (check_connection(mysql_conn) != SLURM_SUCCESS) {
 		return NULL;
 	}
+	replica = _replica_begin(mysql_conn);
 	job_list = as_mysql_jobacct_process_get_jobs(mysql_conn, uid, job_cond);
+	if (replica)
+		mysql_db_replica_end(mysql_conn);
 
 	return job_list;
 }
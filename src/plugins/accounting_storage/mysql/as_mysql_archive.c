@@ -64,6 +64,9 @@
 
 #define MAX_PURGE_LIMIT 50000 /* Number of records that are purged at a time
 				 so that locks can be periodically released. */
+#define MAX_PURGE_CHUNK 5000 /* Number of records deleted per transaction,
+				so job inserts only wait on a short delete. */
+#define MAX_PURGE_PAUSE 1000000 /* Most usec to pause between chunks */
 #define MAX_ARCHIVE_AGE (60 * 60 * 24 * 60) /* If archive data is older than
 					       this then archive by month to
 					       handle large datasets. */
@@ -3954,6 +3957,56 @@ static int _get_oldest_record(mysql_conn_t *mysql_conn, char *cluster,
 	return 1; /* found one record */
 }
 
+/*
+ * Delete up to MAX_PURGE_LIMIT records matching cond (a where clause ending in
+ * an order by) in chunks of MAX_PURGE_CHUNK, committing each one. After each
+ * chunk pause for as long as it took, so a purge holds InnoDB locks at most
+ * half the time and ingestion keeps up while it runs.
+ *
+ * Returns SLURM_ERROR on error and SLURM_SUCCESS on success.
+ */
+static int _purge_records(mysql_conn_t *mysql_conn, char *cluster_name,
+			  char *table, char *cond)
+{
+	char *query = NULL;
+	int cnt, limit, purged = 0;
+	DEF_TIMERS;
+
+	while (purged < MAX_PURGE_LIMIT) {
+		limit = MIN(MAX_PURGE_CHUNK, MAX_PURGE_LIMIT - purged);
+		query = xstrdup_printf("delete from \"%s\" %s LIMIT %d",
+				       table, cond, limit);
+		DB_DEBUG(DB_ARCHIVE, mysql_conn->conn, "query\n%s", query);
+
+		START_TIMER;
+		/*
+		 * mysql_db_delete_affected_rows will return < 0 on failure or
+		 * 0 if no records are affected.
+		 */
+		cnt = mysql_db_delete_affected_rows(mysql_conn, query);
+		xfree(query);
+		if (cnt < 0) {
+			error("Couldn't remove old data from %s table", table);
+			return SLURM_ERROR;
+		} else if (!cnt)
+			break;
+
+		if (mysql_db_commit(mysql_conn)) {
+			error("Couldn't commit cluster (%s) purge",
+			      cluster_name);
+			return SLURM_ERROR;
+		}
+		END_TIMER;
+		purged += cnt;
+
+		if (cnt < limit)
+			break;
+		usleep(MIN(DELTA_TIMER, MAX_PURGE_PAUSE));
+	}
+
+	return SLURM_SUCCESS;
+}
+
 /* Archive and purge a table.
  *
  * Returns SLURM_ERROR on error and SLURM_SUCCESS on success.
@@ -3968,7 +4021,7 @@ static int _archive_purge_table(purge_type_t purge_type, uint32_t usage_info,
 	time_t   last_submit = time(NULL);
 	time_t   curr_end    = 0, tmp_end = 0, record_start = 0;
 	char    *query = NULL, *sql_table = NULL,
-		*col_name = NULL;
+		*col_name = NULL, *table = NULL;
 	uint32_t tmp_archive_period;
 
 	switch (purge_type) {
@@ -4129,56 +4182,39 @@ static int _archive_purge_table(purge_type_t purge_type, uint32_t usage_info,
 		 */
 		switch (purge_type) {
 		case PURGE_TXN:
+			table = xstrdup(sql_table);
 			query = xstrdup_printf(
-				"delete from \"%s\" where "
-				"%s <= %ld && cluster='%s' order by %s asc LIMIT %d",
-				sql_table, col_name, tmp_end, cluster_name,
-				col_name, MAX_PURGE_LIMIT);
+				"where %s <= %ld && cluster='%s' "
+				"order by %s asc",
+				col_name, tmp_end, cluster_name, col_name);
 			break;
 		case PURGE_USAGE:
 		case PURGE_CLUSTER_USAGE:
+			table = xstrdup_printf("%s_%s", cluster_name,
+					       sql_table);
 			query = xstrdup_printf(
-				"delete from \"%s_%s\" where "
-				"%s <= %ld order by %s asc LIMIT %d",
-				cluster_name, sql_table, col_name,
-				tmp_end, col_name, MAX_PURGE_LIMIT);
+				"where %s <= %ld order by %s asc",
+				col_name, tmp_end, col_name);
 			break;
 		default:
+			table = xstrdup_printf("%s_%s", cluster_name,
+					       sql_table);
 			query = xstrdup_printf(
-				"delete from \"%s_%s\" where "
-				"%s <= %ld && time_end != 0 order by %s asc LIMIT %d",
-				cluster_name, sql_table, col_name,
-				tmp_end, col_name, MAX_PURGE_LIMIT);
+				"where %s <= %ld && time_end != 0 "
+				"order by %s asc",
+				col_name, tmp_end, col_name);
 			break;
 		}
-		DB_DEBUG(DB_ARCHIVE, mysql_conn->conn, "query\n%s", query);
 
 		/*
-		 * Don't loop this query, just do it once, since we are only
+		 * Don't loop this purge, just do it once, since we are only
 		 * archiving and purging MAX_PURGE_LIMIT rows at a time.
-		 * mysql_db_delete_affected_rows will return < 0 on failure or
-		 * 0 if no records are affected.
 		 */
-		if ((rc = mysql_db_delete_affected_rows(
-				mysql_conn, query)) > 0) {
-			/* Commit here every time since this could create a huge
-			 * transaction.
-			 */
-			if ((rc = mysql_db_commit(mysql_conn)))
-				error("Couldn't commit cluster (%s) purge",
-				      cluster_name);
-		}
-
+		rc = _purge_records(mysql_conn, cluster_name, table, query);
+		xfree(table);
 		xfree(query);
-		if (rc != SLURM_SUCCESS) {
-			error("Couldn't remove old data from %s table",
-			      sql_table);
+		if (rc != SLURM_SUCCESS)
 			return SLURM_ERROR;
-		} else if (mysql_db_commit(mysql_conn)) {
-			error("Couldn't commit cluster (%s) purge",
-			      cluster_name);
-			break;
-		}
 	}
 
 	return SLURM_SUCCESS;
@@ -4330,41 +4366,10 @@ extern int as_mysql_jobacct_process_archive_load(
 	if (arch_rec->insert) {
 		data = xstrdup(arch_rec->insert);
 	} else if (arch_rec->archive_file) {
-		int data_allocated, data_read = 0;
-		int state_fd = open(arch_rec->archive_file, O_RDONLY);
-		if (state_fd < 0) {
-			info("Could not open archive file `%s`: %m",
-			     arch_rec->archive_file);
-			error_code = errno;
-		} else {
-			data_allocated = BUF_SIZE + 1;
-			data = xmalloc_nz(data_allocated);
-			while (1) {
-				data_read = read(state_fd, &data[data_size],
-						 BUF_SIZE);
-				if (data_read < 0) {
-					data[data_size] = '\0';
-					if (errno == EINTR)
-						continue;
-					else {
-						error("Read error on %s: %m",
-						      arch_rec->archive_file);
-						break;
-					}
-				}
-				data[data_size + data_read] = '\0';
-				if (data_read == 0)	/* eof */
-					break;
-				data_size      += data_read;
-				data_allocated += data_read;
-				xrealloc_nz(data, data_allocated);
-			}
-			close(state_fd);
-		}
-		if (error_code != SLURM_SUCCESS) {
-			xfree(data);
+		error_code = archive_read_file(arch_rec->archive_file, &data,
+					       &data_size);
+		if (error_code != SLURM_SUCCESS)
 			return error_code;
-		}
 	} else {
 		error("Nothing was set in your "
 		      "slurmdb_archive_rec so I am unable to process.");
@@ -720,7 +720,7 @@ no_rollup_change:
 			   begin_time, job_ptr->db_index);
 
 		DB_DEBUG(DB_JOB, mysql_conn->conn, "query\n%s", query);
-		rc = mysql_db_query(mysql_conn, query);
+		rc = mysql_db_query_defer(mysql_conn, query);
 	}
 
 	/* now we will reset all the steps */
@@ -985,6 +985,7 @@ extern int as_mysql_job_complete(mysql_conn_t *mysql_conn,
 	time_t submit_time, end_time;
 	uint32_t exit_code = 0;
 	char *tres_alloc_str = NULL;
+	mysql_stmt_args_t args = { 0 };
 
 	if (!job_ptr->db_index
 	    && ((!job_ptr->details || !job_ptr->details->submit_time)
@@ -1076,33 +1077,41 @@ extern int as_mysql_job_complete(mysql_conn_t *mysql_conn,
 	}
 
 	/*
-	 * make sure we handle any quotes that may be in the comment
+	 * The comments are sent as statement parameters, so any quotes in
+	 * them need no escaping.
 	 */
-
 	query = xstrdup_printf("update \"%s_%s\" set "
 			       "mod_time=UNIX_TIMESTAMP(), "
-			       "time_end=%ld, state=%d",
-			       mysql_conn->cluster_name, job_table,
-			       end_time, job_state);
-
-	if (job_ptr->derived_ec != NO_VAL)
-		xstrfmtcat(query, ", derived_ec=%u", job_ptr->derived_ec);
+			       "time_end=?, state=?",
+			       mysql_conn->cluster_name, job_table);
+	mysql_stmt_add_int(&args, end_time);
+	mysql_stmt_add_int(&args, job_state);
+
+	if (job_ptr->derived_ec != NO_VAL) {
+		xstrcat(query, ", derived_ec=?");
+		mysql_stmt_add_uint(&args, job_ptr->derived_ec);
+	}
 
-	if (tres_alloc_str)
-		xstrfmtcat(query, ", tres_alloc='%s'", tres_alloc_str);
-	else if (job_ptr->tres_alloc_str)
-		xstrfmtcat(query, ", tres_alloc='%s'", job_ptr->tres_alloc_str);
+	if (tres_alloc_str || job_ptr->tres_alloc_str) {
+		xstrcat(query, ", tres_alloc=?");
+		mysql_stmt_add_str(&args, tres_alloc_str ?
+				   tres_alloc_str : job_ptr->tres_alloc_str);
+	}
 
-	if (job_ptr->comment)
-		xstrfmtcat(query, ", derived_es='%s'", job_ptr->comment);
+	if (job_ptr->comment) {
+		xstrcat(query, ", derived_es=?");
+		mysql_stmt_add_str(&args, job_ptr->comment);
+	}
 
-	if (job_ptr->admin_comment)
-		xstrfmtcat(query, ", admin_comment='%s'",
-			   job_ptr->admin_comment);
+	if (job_ptr->admin_comment) {
+		xstrcat(query, ", admin_comment=?");
+		mysql_stmt_add_str(&args, job_ptr->admin_comment);
+	}
 
-	if (job_ptr->system_comment)
-		xstrfmtcat(query, ", system_comment='%s'",
-			   job_ptr->system_comment);
+	if (job_ptr->system_comment) {
+		xstrcat(query, ", system_comment=?");
+		mysql_stmt_add_str(&args, job_ptr->system_comment);
+	}
 
 	exit_code = job_ptr->exit_code;
 	if (exit_code == 1) {
@@ -1112,13 +1121,13 @@ extern int as_mysql_job_complete(mysql_conn_t *mysql_conn,
 		exit_code = 256;
 	}
 
-	xstrfmtcat(query,
-		   ", exit_code=%d, kill_requid=%d where job_db_inx=%"PRIu64";",
-		   exit_code, job_ptr->requid,
-		   job_ptr->db_index);
+	xstrcat(query, ", exit_code=?, kill_requid=? where job_db_inx=?");
+	mysql_stmt_add_int(&args, (int32_t) exit_code);
+	mysql_stmt_add_int(&args, (int32_t) job_ptr->requid);
+	mysql_stmt_add_uint(&args, job_ptr->db_index);
 
 	DB_DEBUG(DB_JOB, mysql_conn->conn, "query\n%s", query);
-	rc = mysql_db_query(mysql_conn, query);
+	rc = mysql_db_query_stmt(mysql_conn, query, &args);
 	xfree(query);
 
 	xfree(tres_alloc_str);
@@ -1265,7 +1274,7 @@ extern int as_mysql_step_start(mysql_conn_t *mysql_conn,
 		step_ptr->cpu_freq_min, step_ptr->cpu_freq_gov,
 		step_ptr->tres_alloc_str);
 	DB_DEBUG(DB_STEP, mysql_conn->conn, "query\n%s", query);
-	rc = mysql_db_query(mysql_conn, query);
+	rc = mysql_db_query_defer(mysql_conn, query);
 	xfree(query);
 
 	return rc;
@@ -1280,6 +1289,8 @@ extern int as_mysql_step_complete(mysql_conn_t *mysql_conn,
 	struct jobacctinfo *jobacct = (struct jobacctinfo *)step_ptr->jobacct;
 	char *query = NULL;
 	int rc = SLURM_SUCCESS;
+	mysql_stmt_args_t args = { 0 };
+	slurmdb_stats_t stats;
 	uint32_t exit_code = 0;
 	time_t submit_time;
 
@@ -1365,21 +1376,18 @@ extern int as_mysql_step_complete(mysql_conn_t *mysql_conn,
 		}
 	}
 
-	/* The stepid could be -2 so use %d not %u */
 	query = xstrdup_printf(
-		"update \"%s_%s\" set time_end=%d, state=%u, "
-		"kill_requid=%d, exit_code=%d",
-		mysql_conn->cluster_name, step_table, (int)now,
-		comp_status,
-		step_ptr->requid,
-		exit_code);
-
-
+		"update \"%s_%s\" set time_end=?, state=?, "
+		"kill_requid=?, exit_code=?",
+		mysql_conn->cluster_name, step_table);
+	mysql_stmt_add_int(&args, (int) now);
+	mysql_stmt_add_uint(&args, comp_status);
+	mysql_stmt_add_int(&args, (int32_t) step_ptr->requid);
+	mysql_stmt_add_int(&args, (int32_t) exit_code);
+
+	/* The strings in stats must live until the query is run */
+	memset(&stats, 0, sizeof(slurmdb_stats_t));
 	if (jobacct) {
-		slurmdb_stats_t stats;
-
-		memset(&stats, 0, sizeof(slurmdb_stats_t));
-
 		/* figure out the ave of the totals sent */
 		if (tasks > 0) {
 			stats.tres_usage_in_ave =
@@ -1456,76 +1464,72 @@ extern int as_mysql_step_complete(mysql_conn_t *mysql_conn,
 			jobacct->tres_usage_out_tot,
 			jobacct->tres_count, 1);
 
-		xstrfmtcat(query,
-			   ", user_sec=%u, user_usec=%u, "
-			   "sys_sec=%u, sys_usec=%u, "
-			   "act_cpufreq=%u, consumed_energy=%"PRIu64", "
-			   "tres_usage_in_ave='%s', "
-			   "tres_usage_out_ave='%s', "
-			   "tres_usage_in_max='%s', "
-			   "tres_usage_in_max_taskid='%s', "
-			   "tres_usage_in_max_nodeid='%s', "
-			   "tres_usage_in_min='%s', "
-			   "tres_usage_in_min_taskid='%s', "
-			   "tres_usage_in_min_nodeid='%s', "
-			   "tres_usage_in_tot='%s', "
-			   "tres_usage_out_max='%s', "
-			   "tres_usage_out_max_taskid='%s', "
-			   "tres_usage_out_max_nodeid='%s', "
-			   "tres_usage_out_min='%s', "
-			   "tres_usage_out_min_taskid='%s', "
-			   "tres_usage_out_min_nodeid='%s', "
-			   "tres_usage_out_tot='%s'",
-			   /* user seconds */
-			   jobacct->user_cpu_sec,
-			   /* user microseconds */
-			   jobacct->user_cpu_usec,
-			   /* system seconds */
-			   jobacct->sys_cpu_sec,
-			   /* system microsecs */
-			   jobacct->sys_cpu_usec,
-			   jobacct->act_cpufreq,
-			   jobacct->energy.consumed_energy,
-			   stats.tres_usage_in_ave,
-			   stats.tres_usage_out_ave,
-			   stats.tres_usage_in_max,
-			   stats.tres_usage_in_max_taskid,
-			   stats.tres_usage_in_max_nodeid,
-			   stats.tres_usage_in_min,
-			   stats.tres_usage_in_min_taskid,
-			   stats.tres_usage_in_min_nodeid,
-			   stats.tres_usage_in_tot,
-			   stats.tres_usage_out_max,
-			   stats.tres_usage_out_max_taskid,
-			   stats.tres_usage_out_max_nodeid,
-			   stats.tres_usage_out_min,
-			   stats.tres_usage_out_min_taskid,
-			   stats.tres_usage_out_min_nodeid,
-			   stats.tres_usage_out_tot);
-
-		slurmdb_free_slurmdb_stats_members(&stats);
+		xstrcat(query,
+			", user_sec=?, user_usec=?, "
+			"sys_sec=?, sys_usec=?, "
+			"act_cpufreq=?, consumed_energy=?, "
+			"tres_usage_in_ave=?, "
+			"tres_usage_out_ave=?, "
+			"tres_usage_in_max=?, "
+			"tres_usage_in_max_taskid=?, "
+			"tres_usage_in_max_nodeid=?, "
+			"tres_usage_in_min=?, "
+			"tres_usage_in_min_taskid=?, "
+			"tres_usage_in_min_nodeid=?, "
+			"tres_usage_in_tot=?, "
+			"tres_usage_out_max=?, "
+			"tres_usage_out_max_taskid=?, "
+			"tres_usage_out_max_nodeid=?, "
+			"tres_usage_out_min=?, "
+			"tres_usage_out_min_taskid=?, "
+			"tres_usage_out_min_nodeid=?, "
+			"tres_usage_out_tot=?");
+		mysql_stmt_add_uint(&args, jobacct->user_cpu_sec);
+		mysql_stmt_add_uint(&args, jobacct->user_cpu_usec);
+		mysql_stmt_add_uint(&args, jobacct->sys_cpu_sec);
+		mysql_stmt_add_uint(&args, jobacct->sys_cpu_usec);
+		mysql_stmt_add_uint(&args, jobacct->act_cpufreq);
+		mysql_stmt_add_uint(&args, jobacct->energy.consumed_energy);
+		mysql_stmt_add_str(&args, stats.tres_usage_in_ave);
+		mysql_stmt_add_str(&args, stats.tres_usage_out_ave);
+		mysql_stmt_add_str(&args, stats.tres_usage_in_max);
+		mysql_stmt_add_str(&args, stats.tres_usage_in_max_taskid);
+		mysql_stmt_add_str(&args, stats.tres_usage_in_max_nodeid);
+		mysql_stmt_add_str(&args, stats.tres_usage_in_min);
+		mysql_stmt_add_str(&args, stats.tres_usage_in_min_taskid);
+		mysql_stmt_add_str(&args, stats.tres_usage_in_min_nodeid);
+		mysql_stmt_add_str(&args, stats.tres_usage_in_tot);
+		mysql_stmt_add_str(&args, stats.tres_usage_out_max);
+		mysql_stmt_add_str(&args, stats.tres_usage_out_max_taskid);
+		mysql_stmt_add_str(&args, stats.tres_usage_out_max_nodeid);
+		mysql_stmt_add_str(&args, stats.tres_usage_out_min);
+		mysql_stmt_add_str(&args, stats.tres_usage_out_min_taskid);
+		mysql_stmt_add_str(&args, stats.tres_usage_out_min_nodeid);
+		mysql_stmt_add_str(&args, stats.tres_usage_out_tot);
 	}
 
-	/* id_step has to be %d here to handle the -2 -1 for the batch and
-	   extern steps.  Don't change it to a %u.
+	/* id_step has to be signed here to handle the -2 -1 for the batch
+	   and extern steps.  Don't change it to unsigned.
 	*/
-	xstrfmtcat(query,
-		   " where job_db_inx=%"PRIu64" and id_step=%d",
-		   step_ptr->job_ptr->db_index, step_ptr->step_id);
+	xstrcat(query, " where job_db_inx=? and id_step=?");
+	mysql_stmt_add_uint(&args, step_ptr->job_ptr->db_index);
+	mysql_stmt_add_int(&args, (int32_t) step_ptr->step_id);
 	DB_DEBUG(DB_STEP, mysql_conn->conn, "query\n%s", query);
-	rc = mysql_db_query(mysql_conn, query);
+	rc = mysql_db_query_stmt(mysql_conn, query, &args);
 	xfree(query);
+	slurmdb_free_slurmdb_stats_members(&stats);
 
 	/* set the energy for the entire job. */
 	if (step_ptr->job_ptr->tres_alloc_str) {
+		args.cnt = 0;
 		query = xstrdup_printf(
-			"update \"%s_%s\" set tres_alloc='%s' where "
-			"job_db_inx=%"PRIu64,
-			mysql_conn->cluster_name, job_table,
-			step_ptr->job_ptr->tres_alloc_str,
-			step_ptr->job_ptr->db_index);
+			"update \"%s_%s\" set tres_alloc=? where "
+			"job_db_inx=?",
+			mysql_conn->cluster_name, job_table);
+		mysql_stmt_add_str(&args, step_ptr->job_ptr->tres_alloc_str);
+		mysql_stmt_add_uint(&args, step_ptr->job_ptr->db_index);
 		DB_DEBUG(DB_STEP, mysql_conn->conn, "query\n%s", query);
-		rc = mysql_db_query(mysql_conn, query);
+		rc = mysql_db_query_stmt(mysql_conn, query, &args);
 		xfree(query);
 	}
 
@@ -55,6 +55,22 @@ enum {
 	WCKEY_TABLES
 };
 
+/*
+ * Hourly rollups of at least ROLLUP_WINDOW_HOURS * 2 hours, e.g. after
+ * slurmdbd was down, are split into windows of consecutive hours rolled up
+ * concurrently on up to MAX_ROLLUP_WINDOWS database connections.
+ */
+#define MAX_ROLLUP_WINDOWS	4
+#define ROLLUP_WINDOW_HOURS	24
+
+typedef struct {
+	char *cluster_name;
+	int conn;
+	time_t end;
+	int rc;
+	time_t start;
+} rollup_window_t;
+
 typedef struct {
 	uint64_t count;
 	uint32_t id;
@@ -324,7 +340,7 @@ static void _setup_cluster_tres(List tres_list, uint32_t id,
 
 static void _add_tres_2_list(List tres_list, char *tres_str, int seconds)
 {
-	char *tmp_str = tres_str;
+	char *tmp_str = tres_str, *end_ptr = NULL;
 	int id;
 	uint64_t count;
 
@@ -334,12 +350,13 @@ static void _add_tres_2_list(List tres_list, char *tres_str, int seconds)
 		return;
 
 	while (tmp_str) {
-		id = atoi(tmp_str);
+		id = strtol(tmp_str, &end_ptr, 10);
 		if (id < 1) {
 			error("_add_tres_2_list: no id "
 			      "found at %s instead", tmp_str);
 			break;
 		}
+		tmp_str = end_ptr;
 
 		/* We don't run rollup on a node basis
 		 * because they are shared resources on
@@ -347,16 +364,18 @@ static void _add_tres_2_list(List tres_list, char *tres_str, int seconds)
 		 * have over committed resources.
 		 */
 		if (id != TRES_NODE) {
-			if (!(tmp_str = strchr(tmp_str, '='))) {
+			if ((*tmp_str != '=') &&
+			    !(tmp_str = strchr(tmp_str, '='))) {
 				error("_add_tres_2_list: no value found");
 				xassert(0);
 				break;
 			}
-			count = slurm_atoull(++tmp_str);
+			count = strtoull(++tmp_str, &end_ptr, 10);
+			tmp_str = end_ptr;
 			_setup_cluster_tres(tres_list, id, count, seconds);
 		}
 
-		if (!(tmp_str = strchr(tmp_str, ',')))
+		if ((*tmp_str != ',') && !(tmp_str = strchr(tmp_str, ',')))
 			break;
 		tmp_str++;
 	}
@@ -410,7 +429,7 @@ static void _add_tres_time_2_list(List tres_list, char *tres_str,
 				  int type, int seconds, int suspend_seconds,
 				  bool times_count)
 {
-	char *tmp_str = tres_str;
+	char *tmp_str = tres_str, *end_ptr = NULL;
 	int id;
 	uint64_t time, count;
 	local_tres_usage_t *loc_tres;
@@ -423,13 +442,14 @@ static void _add_tres_time_2_list(List tres_list, char *tres_str,
 	while (tmp_str) {
 		int loc_seconds = seconds;
 
-		id = atoi(tmp_str);
+		id = strtol(tmp_str, &end_ptr, 10);
 		if (id < 1) {
 			error("_add_tres_time_2_list: no id "
 			      "found at %s", tmp_str);
 			break;
 		}
-		if (!(tmp_str = strchr(tmp_str, '='))) {
+		tmp_str = end_ptr;
+		if ((*tmp_str != '=') && !(tmp_str = strchr(tmp_str, '='))) {
 			error("_add_tres_time_2_list: no value found for "
 			      "id %d '%s'", id, tres_str);
 			xassert(0);
@@ -445,7 +465,8 @@ static void _add_tres_time_2_list(List tres_list, char *tres_str,
 				loc_seconds = 0;
 		}
 
-		time = count = slurm_atoull(++tmp_str);
+		time = count = strtoull(++tmp_str, &end_ptr, 10);
+		tmp_str = end_ptr;
 		/* ENERGY is already totalled for the entire job so don't
 		 * multiple with time.
 		 */
@@ -458,7 +479,7 @@ static void _add_tres_time_2_list(List tres_list, char *tres_str,
 		if (loc_tres && !loc_tres->count)
 			loc_tres->count = count;
 
-		if (!(tmp_str = strchr(tmp_str, ',')))
+		if ((*tmp_str != ',') && !(tmp_str = strchr(tmp_str, ',')))
 			break;
 		tmp_str++;
 	}
@@ -1216,10 +1237,9 @@ extern int _setup_resv_usage(mysql_conn_t *mysql_conn,
 	return SLURM_SUCCESS;
 }
 
-extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
-				  char *cluster_name,
-				  time_t start, time_t end,
-				  uint16_t archive_data)
+/* Roll up the hours from start to end and commit them */
+static int _hourly_rollup_range(mysql_conn_t *mysql_conn, char *cluster_name,
+				time_t start, time_t end)
 {
 	int rc = SLURM_SUCCESS;
 	int add_sec = 3600;
@@ -1868,13 +1888,110 @@ end_it:
 			      cluster_name, slurm_ctime2_r(&curr_start, start),
 			      slurm_ctime2_r(&curr_end, end));
 			rc = SLURM_ERROR;
-		} else
-			rc = _process_purge(mysql_conn, cluster_name,
-					    archive_data, SLURMDB_PURGE_HOURS);
+		}
 	}
 
 	return rc;
 }
+
+static void *_hourly_rollup_window(void *arg)
+{
+	rollup_window_t *window = arg;
+	mysql_conn_t mysql_conn;
+
+	/* Each thread needs its own connection */
+	memset(&mysql_conn, 0, sizeof(mysql_conn_t));
+	mysql_conn.rollback = 1;
+	mysql_conn.conn = window->conn;
+	slurm_mutex_init(&mysql_conn.lock);
+
+	if ((window->rc = check_connection(&mysql_conn)) == SLURM_SUCCESS)
+		window->rc = _hourly_rollup_range(&mysql_conn,
+						  window->cluster_name,
+						  window->start, window->end);
+	if ((window->rc != SLURM_SUCCESS) && mysql_db_rollback(&mysql_conn))
+		error("rollback failed");
+
+	mysql_db_close_db_connection(&mysql_conn);
+	slurm_mutex_destroy(&mysql_conn.lock);
+
+	return NULL;
+}
+
+/*
+ * Roll up the hours from start to end split into window_cnt windows, each
+ * on its own thread and connection. The hours are independent of each
+ * other, so a window which fails is simply rolled up again next time along
+ * with the others since the last ran time is not advanced.
+ */
+static int _hourly_rollup_parallel(mysql_conn_t *mysql_conn,
+				   char *cluster_name, time_t start, time_t end,
+				   int window_cnt)
+{
+	rollup_window_t windows[MAX_ROLLUP_WINDOWS];
+	pthread_t threads[MAX_ROLLUP_WINDOWS];
+	int hours = (end - start) / 3600;
+	int rc = SLURM_SUCCESS;
+	time_t window_start = start;
+
+	for (int i = 0; i < window_cnt; i++) {
+		int window_hours = hours / window_cnt;
+
+		if (i < (hours % window_cnt))
+			window_hours++;
+		windows[i].cluster_name = cluster_name;
+		windows[i].conn = mysql_conn->conn;
+		windows[i].start = window_start;
+		if (i == (window_cnt - 1))
+			windows[i].end = end;
+		else
+			windows[i].end = window_start + (window_hours * 3600);
+		window_start = windows[i].end;
+		windows[i].rc = SLURM_SUCCESS;
+		slurm_thread_create(&threads[i], _hourly_rollup_window,
+				    &windows[i]);
+	}
+
+	for (int i = 0; i < window_cnt; i++) {
+		pthread_join(threads[i], NULL);
+		if (windows[i].rc != SLURM_SUCCESS) {
+			char tmp_start[25], tmp_end[25];
+			error("Couldn't roll up cluster (%s) hours %s - %s",
+			      cluster_name,
+			      slurm_ctime2_r(&windows[i].start, tmp_start),
+			      slurm_ctime2_r(&windows[i].end, tmp_end));
+			rc = windows[i].rc;
+		}
+	}
+
+	return rc;
+}
+
+extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
+				  char *cluster_name,
+				  time_t start, time_t end,
+				  uint16_t archive_data)
+{
+	int window_cnt = ((end - start) / 3600) / ROLLUP_WINDOW_HOURS;
+	int rc;
+
+	window_cnt = MIN(window_cnt, MAX_ROLLUP_WINDOWS);
+	if (window_cnt > 1) {
+		debug("%s: rolling up cluster %s hours in %d windows",
+		      __func__, cluster_name, window_cnt);
+		rc = _hourly_rollup_parallel(mysql_conn, cluster_name,
+					     start, end, window_cnt);
+	} else {
+		rc = _hourly_rollup_range(mysql_conn, cluster_name,
+					  start, end);
+	}
+
+	if (rc == SLURM_SUCCESS)
+		rc = _process_purge(mysql_conn, cluster_name, archive_data,
+				    SLURMDB_PURGE_HOURS);
+
+	return rc;
+}
 extern int as_mysql_nonhour_rollup(mysql_conn_t *mysql_conn,
 				   bool run_month,
 				   char *cluster_name,
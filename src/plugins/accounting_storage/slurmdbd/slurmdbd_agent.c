@@ -57,6 +57,8 @@ enum {
 #define SLURMDBD_TIMEOUT	900	/* Seconds SlurmDBD for response */
 #define DEBUG_PRINT_MAX_MSG_TYPES 10
 #define MAX_DBD_DEFAULT_ACTION MAX_DBD_ACTION_DISCARD
+#define DBD_SPOOL_MEM_CNT	10000	/* Messages kept in memory while
+					 * spooling to disk */
 
 static pthread_mutex_t agent_lock = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t  agent_cond = PTHREAD_COND_INITIALIZER;
@@ -73,6 +75,21 @@ static pthread_cond_t  slurmdbd_cond = PTHREAD_COND_INITIALIZER;
 
 static int max_dbd_msg_action = MAX_DBD_DEFAULT_ACTION;
 
+/*
+ * With SlurmctldParameters=dbd_spool, messages beyond spool_mem_cnt are
+ * appended to StateSaveLocation/dbd.spool instead of agent_list, and read
+ * back in order as the agent drains agent_list. Everything in the spool is
+ * newer than everything in agent_list. Protected by agent_lock.
+ */
+static bool     spool_enabled  = false;
+static int      spool_fd       = -1;	/* append */
+static int      spool_rd_fd    = -1;	/* read back */
+static uint32_t spool_cnt      = 0;	/* messages not yet read back */
+static uint32_t spool_mem_cnt  = DBD_SPOOL_MEM_CNT; /* spool beyond this */
+
+static void _enqueue_dbd_rec(Buf buffer);
+static char *_spool_fname(void);
+
 static void _acct_full(void)
 {
 	if (running_in_slurmctld())
@@ -347,15 +364,12 @@ static Buf _load_dbd_rec(int fd)
 	return buffer;
 }
 
-static void _load_dbd_state(void)
+static void _load_dbd_file(char *dbd_fname)
 {
-	char *dbd_fname;
 	Buf buffer;
 	int fd, recovered = 0;
 	uint16_t rpc_version = 0;
 
-	dbd_fname = slurm_get_state_save_location();
-	xstrcat(dbd_fname, "/dbd.messages");
 	fd = open(dbd_fname, O_RDONLY);
 	if (fd < 0) {
 		/* don't print an error message if there is no file */
@@ -416,8 +430,7 @@ static void _load_dbd_state(void)
 				error("no buffer given");
 				continue;
 			}
-			if (!list_enqueue(agent_list, buffer))
-				fatal("slurmdbd: list_enqueue, no memory");
+			_enqueue_dbd_rec(buffer);
 			recovered++;
 			buffer = NULL;
 		}
@@ -426,7 +439,30 @@ static void _load_dbd_state(void)
 		verbose("slurmdbd: recovered %d pending RPCs", recovered);
 		(void) close(fd);
 	}
+}
+
+static void _load_dbd_state(void)
+{
+	char *dbd_fname, *spool_fname, *old_fname = NULL;
+
+	dbd_fname = slurm_get_state_save_location();
+	xstrcat(dbd_fname, "/dbd.messages");
+	_load_dbd_file(dbd_fname);
 	xfree(dbd_fname);
+
+	/*
+	 * A spool left behind means slurmctld did not shut down cleanly.
+	 * Its messages are newer than dbd.messages and some may have been
+	 * sent already, slurmdbd handles such duplicates.
+	 */
+	spool_fname = _spool_fname();
+	xstrfmtcat(old_fname, "%s.old", spool_fname);
+	if (!rename(spool_fname, old_fname)) {
+		_load_dbd_file(old_fname);
+		(void) unlink(old_fname);
+	}
+	xfree(spool_fname);
+	xfree(old_fname);
 }
 
 static int _save_dbd_rec(int fd, Buf buffer)
@@ -467,6 +503,112 @@ static int _save_dbd_rec(int fd, Buf buffer)
 	return SLURM_SUCCESS;
 }
 
+static char *_spool_fname(void)
+{
+	char *fname = slurm_get_state_save_location();
+
+	xstrcat(fname, "/dbd.spool");
+	return fname;
+}
+
+static void _spool_close(void)
+{
+	char *fname = _spool_fname();
+
+	if (spool_fd >= 0)
+		(void) close(spool_fd);
+	if (spool_rd_fd >= 0)
+		(void) close(spool_rd_fd);
+	spool_fd = spool_rd_fd = -1;
+	spool_cnt = 0;
+	(void) unlink(fname);
+	xfree(fname);
+}
+
+/* Append buffer to the spool, freeing it on success */
+static int _spool_add(Buf buffer)
+{
+	if (spool_fd < 0) {
+		char *fname = _spool_fname();
+
+		spool_fd = open(fname, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND |
+				O_CLOEXEC, 0600);
+		if (spool_fd >= 0) {
+			char ver_str[10];
+			Buf header;
+
+			/* Same header as dbd.messages, skipped on read back */
+			snprintf(ver_str, sizeof(ver_str),
+				 "VER%d", SLURM_PROTOCOL_VERSION);
+			header = init_buf(strlen(ver_str));
+			packstr(ver_str, header);
+			if (_save_dbd_rec(spool_fd, header) == SLURM_SUCCESS)
+				spool_rd_fd = open(fname, O_RDONLY | O_CLOEXEC);
+			free_buf(header);
+			if (spool_rd_fd >= 0)
+				free_buf(_load_dbd_rec(spool_rd_fd));
+		}
+		if (spool_rd_fd < 0) {
+			error("slurmdbd: Creating spool file %s: %m", fname);
+			xfree(fname);
+			_spool_close();
+			return SLURM_ERROR;
+		}
+		info("slurmdbd: agent queue at %u, spooling messages to %s",
+		     list_count(agent_list), fname);
+		xfree(fname);
+	}
+
+	/*
+	 * On failure the message is queued in memory instead, and may be sent
+	 * ahead of older spooled ones. A partial record ends what can be read
+	 * back of the spool.
+	 */
+	if (_save_dbd_rec(spool_fd, buffer) != SLURM_SUCCESS)
+		return SLURM_ERROR;
+	spool_cnt++;
+	free_buf(buffer);
+
+	return SLURM_SUCCESS;
+}
+
+/* Move spooled messages back to agent_list up to spool_mem_cnt */
+static void _spool_refill(void)
+{
+	Buf buffer;
+	int moved = 0;
+
+	while (spool_cnt && (list_count(agent_list) < spool_mem_cnt)) {
+		if (!(buffer = _load_dbd_rec(spool_rd_fd))) {
+			error("slurmdbd: lost %u spooled messages", spool_cnt);
+			spool_cnt = 0;
+			break;
+		}
+		list_enqueue(agent_list, buffer);
+		spool_cnt--;
+		moved++;
+	}
+	log_flag(AGENT, "%s: moved %d messages from spool, %u left",
+		 __func__, moved, spool_cnt);
+
+	if (!spool_cnt) {
+		info("slurmdbd: spool drained");
+		_spool_close();
+	}
+}
+
+/* Queue a message, spooling it if agent_list is full enough */
+static void _enqueue_dbd_rec(Buf buffer)
+{
+	if (spool_enabled &&
+	    (spool_cnt || (list_count(agent_list) >= spool_mem_cnt)) &&
+	    (_spool_add(buffer) == SLURM_SUCCESS))
+		return;
+
+	if (!list_enqueue(agent_list, buffer))
+		fatal("slurmdbd: list_enqueue, no memory");
+}
+
 static void _save_dbd_state(void)
 {
 	char *dbd_fname;
@@ -481,7 +623,7 @@ static void _save_dbd_state(void)
 	fd = open(dbd_fname, O_WRONLY | O_CREAT | O_TRUNC, 0600);
 	if (fd < 0) {
 		error("slurmdbd: Creating state save file %s", dbd_fname);
-	} else if (list_count(agent_list)) {
+	} else if (list_count(agent_list) || spool_cnt) {
 		char curr_ver_str[10];
 		snprintf(curr_ver_str, sizeof(curr_ver_str),
 			 "VER%d", SLURM_PROTOCOL_VERSION);
@@ -518,7 +660,19 @@ static void _save_dbd_state(void)
 				break;
 			wrote++;
 		}
+
+		/* Spooled messages follow the ones still in memory */
+		while ((rc == SLURM_SUCCESS) && spool_cnt &&
+		       (buffer = _load_dbd_rec(spool_rd_fd))) {
+			rc = _save_dbd_rec(fd, buffer);
+			free_buf(buffer);
+			spool_cnt--;
+			wrote++;
+		}
 	}
+	/* Anything not copied is recovered from the spool on restart */
+	if ((fd >= 0) && !spool_cnt)
+		_spool_close();
 
 end_it:
 	if (fd >= 0) {
@@ -797,6 +951,9 @@ static void *_agent(void *x)
 		}
 
 		slurm_mutex_lock(&agent_lock);
+		if (spool_cnt &&
+		    (list_count(agent_list) < (spool_mem_cnt / 2)))
+			_spool_refill();
 		cnt = list_count(agent_list);
 		if ((cnt == 0) || (slurmdbd_conn->fd < 0) ||
 		    (fail_time && (difftime(time(NULL), fail_time) < 10))) {
@@ -1218,6 +1375,13 @@ extern int send_slurmdbd_msg(uint16_t rpc_version, persist_msg_t *req)
 		}
 	}
 	cnt = list_count(agent_list);
+	if (spool_enabled &&
+	    (spool_cnt || (cnt >= spool_mem_cnt)) &&
+	    (_spool_add(buffer) == SLURM_SUCCESS)) {
+		slurm_cond_broadcast(&agent_cond);
+		slurm_mutex_unlock(&agent_lock);
+		return rc;
+	}
 	if ((cnt >= (slurm_conf.max_dbd_msgs / 2)) &&
 	    (difftime(time(NULL), syslog_time) > 120)) {
 		/* Record critical error every 120 seconds */
@@ -1260,7 +1424,7 @@ extern bool slurmdbd_conn_active(void)
 
 extern int slurmdbd_agent_queue_count(void)
 {
-	return list_count(agent_list);
+	return list_count(agent_list) + spool_cnt;
 }
 
 extern void slurmdbd_agent_config_setup(void)
@@ -1293,4 +1457,7 @@ extern void slurmdbd_agent_config_setup(void)
 		xfree(tmp_ptr);
 	} else
 		max_dbd_msg_action = MAX_DBD_DEFAULT_ACTION;
+
+	spool_enabled = xstrcasestr(slurm_conf.slurmctld_params, "dbd_spool");
+	spool_mem_cnt = MIN(DBD_SPOOL_MEM_CNT, slurm_conf.max_dbd_msgs / 2);
 }
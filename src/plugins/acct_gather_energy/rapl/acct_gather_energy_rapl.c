@@ -132,6 +132,7 @@ static int pkg_fd[MAX_PKGS] = {[0 ... MAX_PKGS-1] = -1};
 static char hostname[MAXHOSTNAMELEN];
 
 static int nb_pkg = 0;
+static double energy_units = 0.0;	/* Joules per energy status unit */
 
 static stepd_step_rec_t *job = NULL;
 
@@ -152,9 +153,7 @@ static uint64_t _read_msr(int fd, int which)
 	uint64_t data = 0;
 	static bool first = true;
 
-	if (lseek(fd, which, SEEK_SET) < 0)
-		error("lseek of /dev/cpu/#/msr: %m");
-	if (read(fd, &data, sizeof(data)) != sizeof(data)) {
+	if (pread(fd, &data, sizeof(data), which) != sizeof(data)) {
 		if (which == MSR_DRAM_ENERGY_STATUS) {
 			if (first &&
 			    (slurm_conf.debug_flags & DEBUG_FLAG_ENERGY)) {
@@ -302,7 +301,6 @@ _send_drain_request(void)
 static void _get_joules_task(acct_gather_energy_t *energy)
 {
 	int i;
-	double energy_units;
 	uint64_t result;
 	double ret;
 	static uint32_t readings = 0;
@@ -314,21 +312,13 @@ static void _get_joules_task(acct_gather_energy_t *energy)
 		return;
 	}
 
-	/*
-	 * MSR_RAPL_POWER_UNIT
-	 * Power Units - bits 3:0
-	 * Energy Status Units - bits 12:8
-	 * Time Units - bits 19:16
-	 * See: Intel 64 and IA-32 Architectures Software Developer's
-	 * Manual, Volume 3 for details
-	 */
-	result = _read_msr(pkg_fd[0], MSR_RAPL_POWER_UNIT);
-	energy_units = pow(0.5, (double)((result>>8)&0x1f));
-
 	if (slurm_conf.debug_flags & DEBUG_FLAG_ENERGY) {
-		double power_units = pow(0.5, (double)(result&0xf));
+		double power_units;
 		unsigned long max_power;
 
+		result = _read_msr(pkg_fd[0], MSR_RAPL_POWER_UNIT);
+		power_units = pow(0.5, (double)(result&0xf));
+
 		info("RAPL powercapture_debug Energy units = %.6f, "
 		     "Power Units = %.6f", energy_units, power_units);
 		/*
@@ -577,9 +567,19 @@ extern void acct_gather_energy_p_conf_set(int context_id_in,
 
 	local_energy = acct_gather_energy_alloc(1);
 
+	/*
+	 * MSR_RAPL_POWER_UNIT
+	 * Power Units - bits 3:0
+	 * Energy Status Units - bits 12:8
+	 * Time Units - bits 19:16
+	 * See: Intel 64 and IA-32 Architectures Software Developer's
+	 * Manual, Volume 3 for details
+	 * The units are fixed by the hardware, so only read them once.
+	 */
 	result = _read_msr(pkg_fd[0], MSR_RAPL_POWER_UNIT);
 	if (result == 0)
 		local_energy->current_watts = NO_VAL;
+	energy_units = pow(0.5, (double)((result>>8)&0x1f));
 
 	debug("%s loaded", plugin_name);
 
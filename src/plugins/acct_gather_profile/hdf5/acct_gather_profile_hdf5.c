@@ -64,12 +64,17 @@
 #include "src/slurmd/common/proctrack.h"
 #include "hdf5_api.h"
 
-#define HDF5_CHUNK_SIZE 10
+/* Records per chunk. Larger chunks mean fewer, larger writes to the
+ * (usually shared) file system. */
+#define HDF5_CHUNK_SIZE 256
 /* Compression level, a value of 0 through 9. Level 0 is faster but offers the
  * least compression; level 9 is slower but offers maximum compression.
  * A setting of -1 indicates that no compression is desired. */
 /* TODO: Make this configurable with a parameter */
-#define HDF5_COMPRESS 0
+#define HDF5_COMPRESS 1
+/* Allocation block size for metadata and small raw data in the file, so
+ * these are aggregated into a few large writes instead of many small ones. */
+#define HDF5_BLOCK_SIZE (64 * 1024)
 
 /*
  * These variables are required by the generic plugin interface.  If they
@@ -287,6 +292,7 @@ extern int acct_gather_profile_p_node_step_start(stepd_step_rec_t* job)
 	int rc = SLURM_SUCCESS;
 
 	char *profile_file_name;
+	hid_t fapl_id;
 
 	xassert(running_in_slurmstepd());
 
@@ -328,10 +334,15 @@ extern int acct_gather_profile_p_node_step_start(stepd_step_rec_t* job)
 		 profile_file_name);
 
 	/*
-	 * Create a new file using the default properties
+	 * Create a new file, aggregating metadata and small datasets into
+	 * larger blocks to limit the number of small writes
 	 */
+	fapl_id = H5Pcreate(H5P_FILE_ACCESS);
+	H5Pset_meta_block_size(fapl_id, HDF5_BLOCK_SIZE);
+	H5Pset_small_data_block_size(fapl_id, HDF5_BLOCK_SIZE);
 	file_id = H5Fcreate(profile_file_name, H5F_ACC_TRUNC, H5P_DEFAULT,
-			    H5P_DEFAULT);
+			    fapl_id);
+	H5Pclose(fapl_id);
 	if (chown(profile_file_name, (uid_t)g_job->uid,
 		  (gid_t)g_job->gid) < 0)
 		error("chown(%s): %m", profile_file_name);
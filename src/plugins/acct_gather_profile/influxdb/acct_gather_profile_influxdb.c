@@ -127,9 +127,18 @@ static slurm_influxdb_conf_t influxdb_conf;
 static uint32_t g_profile_running = ACCT_GATHER_PROFILE_NOT_SET;
 static stepd_step_rec_t *g_job = NULL;
 
+#define MAX_PENDING_BUFFERS 8	/* full buffers waiting to be sent */
+
 static char *datastr = NULL;
 static int datastrlen = 0;
 
+/* Buffers queued for the flush thread, all protected by flush_mutex */
+static pthread_mutex_t flush_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t flush_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t flush_thread_id = 0;
+static List flush_list = NULL;
+static bool flush_shutdown = false;
+
 static table_t *tables = NULL;
 static size_t tables_max_len = 0;
 static size_t tables_cur_len = 0;
@@ -186,50 +195,21 @@ static size_t _write_callback(void *contents, size_t size, size_t nmemb,
 	return realsize;
 }
 
-/* Try to send data to influxdb */
-static int _send_data(const char *data)
+/* Try to send one buffer of data to influxdb */
+static int _post_data(CURL *curl_handle, const char *buffer)
 {
-	CURL *curl_handle = NULL;
 	CURLcode res;
 	struct http_response chunk;
 	int rc = SLURM_SUCCESS;
 	long response_code;
 	static int error_cnt = 0;
 	char *url = NULL;
-	size_t length;
 
 	debug3("%s %s called", plugin_type, __func__);
 
-	/*
-	 * Every compute node which is sampling data will try to establish a
-	 * different connection to the influxdb server. In order to reduce the
-	 * number of connections, every time a new sampled data comes in, it
-	 * is saved in the 'datastr' buffer. Once this buffer is full, then we
-	 * try to open the connection and send this buffer, instead of opening
-	 * one per sample.
-	 */
-	if (data && ((datastrlen + strlen(data)) <= BUF_SIZE)) {
-		xstrcat(datastr, data);
-		length = strlen(data);
-		datastrlen += length;
-		log_flag(PROFILE, "%s %s: %zu bytes of data added to buffer. New buffer size: %d",
-			 plugin_type, __func__, length, datastrlen);
-		return rc;
-	}
-
 	DEF_TIMERS;
 	START_TIMER;
 
-	if (curl_global_init(CURL_GLOBAL_ALL) != 0) {
-		error("%s %s: curl_global_init: %m", plugin_type, __func__);
-		rc = SLURM_ERROR;
-		goto cleanup_global_init;
-	} else if ((curl_handle = curl_easy_init()) == NULL) {
-		error("%s %s: curl_easy_init: %m", plugin_type, __func__);
-		rc = SLURM_ERROR;
-		goto cleanup_easy_init;
-	}
-
 	xstrfmtcat(url, "%s/write?db=%s&rp=%s&precision=s", influxdb_conf.host,
 		   influxdb_conf.database, influxdb_conf.rt_policy);
 
@@ -241,8 +221,8 @@ static int _send_data(const char *data)
 		curl_easy_setopt(curl_handle, CURLOPT_PASSWORD,
 				 influxdb_conf.password);
 	curl_easy_setopt(curl_handle, CURLOPT_POST, 1);
-	curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, datastr);
-	curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDSIZE, strlen(datastr));
+	curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, buffer);
+	curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDSIZE, strlen(buffer));
 	if (influxdb_conf.username)
 		curl_easy_setopt(curl_handle, CURLOPT_USERNAME,
 				 influxdb_conf.username);
@@ -291,24 +271,141 @@ static int _send_data(const char *data)
 cleanup:
 	xfree(chunk.message);
 	xfree(url);
-cleanup_easy_init:
-	curl_easy_cleanup(curl_handle);
-cleanup_global_init:
-	curl_global_cleanup();
 
 	END_TIMER;
 	log_flag(PROFILE, "%s %s: took %s to send data",
 		 plugin_type, __func__, TIME_STR);
 
+	return rc;
+}
+
+/*
+ * Send full buffers to influxdb so that the threads sampling data never wait
+ * on the network. One curl handle is kept for the life of the thread so the
+ * connection to influxdb is reused between writes.
+ */
+static void *_flush_thread(void *arg)
+{
+	CURL *curl_handle = NULL;
+	char *buffer;
+
+	if (curl_global_init(CURL_GLOBAL_ALL) != 0)
+		error("%s %s: curl_global_init: %m", plugin_type, __func__);
+	else if ((curl_handle = curl_easy_init()) == NULL)
+		error("%s %s: curl_easy_init: %m", plugin_type, __func__);
+
+	slurm_mutex_lock(&flush_mutex);
+	while (true) {
+		if (!(buffer = list_dequeue(flush_list))) {
+			if (flush_shutdown)
+				break;
+			slurm_cond_wait(&flush_cond, &flush_mutex);
+			continue;
+		}
+		slurm_mutex_unlock(&flush_mutex);
+
+		if (curl_handle)
+			(void) _post_data(curl_handle, buffer);
+		xfree(buffer);
+
+		slurm_mutex_lock(&flush_mutex);
+	}
+	slurm_mutex_unlock(&flush_mutex);
+
+	if (curl_handle)
+		curl_easy_cleanup(curl_handle);
+	curl_global_cleanup();
+
+	return NULL;
+}
+
+/*
+ * Hand the current buffer to the flush thread, starting it if needed.
+ * flush_mutex must be locked.
+ */
+static void _queue_datastr(void)
+{
+	static int drop_cnt = 0;
+
+	if (!datastrlen)
+		return;
+
+	if (list_count(flush_list) >= MAX_PENDING_BUFFERS) {
+		/* influxdb is not keeping up, discard the oldest data */
+		char *old = list_dequeue(flush_list);
+		if ((drop_cnt++ % 100) == 0)
+			error("%s %s: influxdb is not keeping up, %d buffers of data discarded",
+			      plugin_type, __func__, drop_cnt);
+		xfree(old);
+	}
+
+	list_enqueue(flush_list, datastr);
+	datastr = NULL;
+	datastrlen = 0;
+
+	if (!flush_thread_id)
+		slurm_thread_create(&flush_thread_id, _flush_thread, NULL);
+	slurm_cond_signal(&flush_cond);
+}
+
+/* Send all buffered data and wait for the flush thread to end */
+static void _stop_flush_thread(void)
+{
+	slurm_mutex_lock(&flush_mutex);
+	_queue_datastr();
+	if (!flush_thread_id) {
+		slurm_mutex_unlock(&flush_mutex);
+		return;
+	}
+	flush_shutdown = true;
+	slurm_cond_signal(&flush_cond);
+	slurm_mutex_unlock(&flush_mutex);
+
+	pthread_join(flush_thread_id, NULL);
+
+	slurm_mutex_lock(&flush_mutex);
+	flush_thread_id = 0;
+	flush_shutdown = false;
+	slurm_mutex_unlock(&flush_mutex);
+}
+
+/* Buffer data to send to influxdb, or queue the buffer if data is NULL */
+static int _send_data(const char *data)
+{
+	size_t length = 0;
+
+	debug3("%s %s called", plugin_type, __func__);
+
+	/*
+	 * Every compute node which is sampling data will try to establish a
+	 * different connection to the influxdb server. In order to reduce the
+	 * number of connections, every time a new sampled data comes in, it
+	 * is saved in the 'datastr' buffer. Once this buffer is full, it is
+	 * queued for the flush thread to send, instead of opening one
+	 * connection per sample.
+	 */
+	if (data)
+		length = strlen(data);
+
+	slurm_mutex_lock(&flush_mutex);
+	if (data && ((datastrlen + length) <= BUF_SIZE)) {
+		xstrcat(datastr, data);
+		datastrlen += length;
+		log_flag(PROFILE, "%s %s: %zu bytes of data added to buffer. New buffer size: %d",
+			 plugin_type, __func__, length, datastrlen);
+		slurm_mutex_unlock(&flush_mutex);
+		return SLURM_SUCCESS;
+	}
+
+	_queue_datastr();
+
 	if (data) {
 		datastr = xstrdup(data);
-		datastrlen = strlen(data);
-	} else {
-		datastr[0] = '\0';
-		datastrlen = 0;
+		datastrlen = length;
 	}
+	slurm_mutex_unlock(&flush_mutex);
 
-	return rc;
+	return SLURM_SUCCESS;
 }
 
 /*
@@ -322,7 +419,7 @@ extern int init(void)
 	if (!running_in_slurmstepd())
 		return SLURM_SUCCESS;
 
-	datastr = xmalloc(BUF_SIZE);
+	flush_list = list_create(xfree_ptr);
 	return SLURM_SUCCESS;
 }
 
@@ -330,6 +427,10 @@ extern int fini(void)
 {
 	debug3("%s %s called", plugin_type, __func__);
 
+	if (flush_list) {
+		_stop_flush_thread();
+		FREE_NULL_LIST(flush_list);
+	}
 	_free_tables();
 	xfree(datastr);
 	xfree(influxdb_conf.host);
@@ -458,6 +559,8 @@ extern int acct_gather_profile_p_node_step_end(void)
 
 	xassert(running_in_slurmstepd());
 
+	_stop_flush_thread();
+
 	return rc;
 }
 
@@ -36,6 +36,7 @@
 
 #include <jwt.h>
 #include <inttypes.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/types.h>
@@ -92,11 +93,79 @@ typedef struct {
 	char *username;
 } auth_token_t;
 
+/*
+ * Tokens that have passed jwt_decode() are remembered until they expire,
+ * since slurmrestd and long lived clients present the same token with every
+ * RPC. Each token hashes to a single slot; a newer token replaces an older
+ * one in the same slot.
+ */
+#define TOKEN_CACHE_SIZE 128
+
+typedef struct {
+	char *token;
+	char *username;		/* "sun" grant of the token */
+	time_t exp;		/* "exp" grant of the token */
+} token_cache_t;
+
+static token_cache_t token_cache[TOKEN_CACHE_SIZE];
+static pthread_mutex_t token_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
 buf_t *key = NULL;
 char *token = NULL;
 __thread char *thread_token = NULL;
 __thread char *thread_username = NULL;
 
+/* FNV-1a hash of a token, used to pick its token_cache slot */
+static int _token_cache_index(const char *tok)
+{
+	uint32_t hash = 2166136261U;
+
+	for (; *tok; tok++) {
+		hash ^= (uint8_t) *tok;
+		hash *= 16777619U;
+	}
+
+	return hash % TOKEN_CACHE_SIZE;
+}
+
+/* Return an xstrdup()'d username if tok was verified and has not expired */
+static char *_token_cache_get(const char *tok)
+{
+	token_cache_t *entry = &token_cache[_token_cache_index(tok)];
+	char *username = NULL;
+
+	slurm_mutex_lock(&token_cache_lock);
+	if (entry->token && !xstrcmp(entry->token, tok) &&
+	    (entry->exp >= time(NULL)))
+		username = xstrdup(entry->username);
+	slurm_mutex_unlock(&token_cache_lock);
+
+	return username;
+}
+
+static void _token_cache_add(const char *tok, const char *username, time_t exp)
+{
+	token_cache_t *entry = &token_cache[_token_cache_index(tok)];
+
+	slurm_mutex_lock(&token_cache_lock);
+	xfree(entry->token);
+	xfree(entry->username);
+	entry->token = xstrdup(tok);
+	entry->username = xstrdup(username);
+	entry->exp = exp;
+	slurm_mutex_unlock(&token_cache_lock);
+}
+
+static void _token_cache_flush(void)
+{
+	slurm_mutex_lock(&token_cache_lock);
+	for (int i = 0; i < TOKEN_CACHE_SIZE; i++) {
+		xfree(token_cache[i].token);
+		xfree(token_cache[i].username);
+	}
+	slurm_mutex_unlock(&token_cache_lock);
+}
+
 /*
  * This plugin behaves differently than the others in that it needs to operate
  * asynchronously. If we're running in one of the daemons, it's presumed that
@@ -144,6 +213,7 @@ extern int init(void)
 
 extern int fini(void)
 {
+	_token_cache_flush();
 	free_buf(key);
 
 	return SLURM_SUCCESS;
@@ -176,6 +246,7 @@ int slurm_auth_verify(auth_token_t *cred, char *auth_info)
 {
 	jwt_t *jwt = NULL;
 	char *username = NULL;
+	time_t exp;
 
 	if (!cred)
 		return SLURM_ERROR;
@@ -194,6 +265,9 @@ int slurm_auth_verify(auth_token_t *cred, char *auth_info)
 		goto fail;
 	}
 
+	if ((username = _token_cache_get(cred->token)))
+		goto verified;
+
 	if (jwt_decode(&jwt, cred->token,
 		       (unsigned char *) key->head, key->size) ||
 	    !jwt) {
@@ -201,7 +275,7 @@ int slurm_auth_verify(auth_token_t *cred, char *auth_info)
 		goto fail;
 	}
 
-	if (jwt_get_grant_int(jwt, "exp") < time(NULL)) {
+	if ((exp = jwt_get_grant_int(jwt, "exp")) < time(NULL)) {
 		error("%s: token expired", __func__);
 		goto fail;
 	}
@@ -209,6 +283,11 @@ int slurm_auth_verify(auth_token_t *cred, char *auth_info)
 		error("%s: jwt_get_grant failure", __func__);
 		goto fail;
 	}
+	jwt_free(jwt);
+	jwt = NULL;
+	_token_cache_add(cred->token, username, exp);
+
+verified:
 
 	if (!cred->username)
 		cred->username = username;
@@ -50,12 +50,17 @@
 
 #include "slurm/slurm_errno.h"
 #include "src/common/slurm_xlator.h"
+#include "src/common/macros.h"
 #include "src/common/slurm_time.h"
 #include "src/common/util-net.h"
+#include "src/common/xstring.h"
 
 #define RETRY_COUNT		20
 #define RETRY_USEC		100000
 
+/* Number of slots in the verified credential cache (AuthInfo=cred_reuse) */
+#define CRED_CACHE_SIZE		4096
+
 /*
  * These variables are required by the generic plugin interface.  If they
  * are not found in the plugin, the plugin loader will ignore it.
@@ -102,8 +107,40 @@ typedef struct _slurm_auth_credential {
 	gid_t   gid;       /* GID. valid only if verified == true            */
 } slurm_auth_credential_t;
 
+/*
+ * Cache of recently verified credentials, only used with
+ * AuthInfo=cred_reuse=#. A slot is overwritten by any newer credential
+ * hashing to it, so the cache never grows beyond CRED_CACHE_SIZE entries.
+ */
+typedef struct {
+	char *m_str;		/* munged string, NULL if slot unused */
+	time_t expire;		/* do not use after this time */
+	struct in_addr addr;
+	uid_t uid;
+	gid_t gid;
+} cred_cache_t;
+
+static cred_cache_t *cred_cache = NULL;
+static pthread_mutex_t cred_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Last credential encoded by this process, handed out again while it is
+ * inside the AuthInfo=cred_reuse=# window.
+ */
+static char *reuse_m_str = NULL;
+static char *reuse_opts = NULL;
+static time_t reuse_expire = 0;
+static uid_t reuse_uid;
+static gid_t reuse_gid;
+static pthread_mutex_t reuse_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /* Static prototypes */
 
+static bool _cred_cache_get(slurm_auth_credential_t *c);
+static void _cred_cache_put(slurm_auth_credential_t *c, int reuse);
+static char *_reuse_get(char *opts);
+static void _reuse_put(char *m_str, char *opts, int reuse);
+
 static int _decode_cred(slurm_auth_credential_t *c, char *socket);
 static void _print_cred(munge_ctx_t ctx);
 
@@ -122,6 +159,28 @@ int init(void)
 	return SLURM_SUCCESS;
 }
 
+int fini(void)
+{
+	int i;
+
+	slurm_mutex_lock(&cred_cache_lock);
+	if (cred_cache) {
+		for (i = 0; i < CRED_CACHE_SIZE; i++)
+			xfree(cred_cache[i].m_str);
+		xfree(cred_cache);
+	}
+	slurm_mutex_unlock(&cred_cache_lock);
+
+	slurm_mutex_lock(&reuse_lock);
+	if (reuse_m_str)
+		free(reuse_m_str);
+	reuse_m_str = NULL;
+	xfree(reuse_opts);
+	slurm_mutex_unlock(&reuse_lock);
+
+	return SLURM_SUCCESS;
+}
+
 
 /*
  * Allocate a credential.  This function should return NULL if it cannot
@@ -131,13 +190,22 @@ int init(void)
 slurm_auth_credential_t *slurm_auth_create(char *opts)
 {
 	int rc, retry = RETRY_COUNT, auth_ttl;
+	int reuse = (bad_cred_test > 0) ? 0 : slurm_get_auth_cred_reuse();
 	slurm_auth_credential_t *cred = NULL;
 	munge_err_t err = EMUNGE_SUCCESS;
-	munge_ctx_t ctx = munge_ctx_create();
+	munge_ctx_t ctx;
 	SigFunc *ohandler;
-	char *socket;
+	char *socket, *m_str;
+
+	if (reuse && (m_str = _reuse_get(opts))) {
+		cred = xmalloc(sizeof(*cred));
+		cred->magic = MUNGE_MAGIC;
+		cred->verified = false;
+		cred->m_str = m_str;
+		return cred;
+	}
 
-	if (!ctx) {
+	if (!(ctx = munge_ctx_create())) {
 		error("munge_ctx_create failure");
 		return NULL;
 	}
@@ -188,6 +256,8 @@ again:
 	} else if ((bad_cred_test > 0) && cred->m_str) {
 		int i = ((int) time(NULL)) % strlen(cred->m_str);
 		cred->m_str[i]++;	/* random position in credential */
+	} else if (reuse) {
+		_reuse_put(cred->m_str, opts, reuse);
 	}
 
 	xsignal(SIGALRM, ohandler);
@@ -399,9 +469,10 @@ unpack_error:
  */
 static int _decode_cred(slurm_auth_credential_t *c, char *socket)
 {
-	int retry = RETRY_COUNT;
+	int retry = RETRY_COUNT, reuse = slurm_get_auth_cred_reuse();
 	munge_err_t err;
 	munge_ctx_t ctx;
+	time_t encoded;
 
 	if (c == NULL)
 		return SLURM_ERROR;
@@ -411,6 +482,9 @@ static int _decode_cred(slurm_auth_credential_t *c, char *socket)
 	if (c->verified)
 		return SLURM_SUCCESS;
 
+	if (reuse && _cred_cache_get(c))
+		return SLURM_SUCCESS;
+
 	if ((ctx = munge_ctx_create()) == NULL) {
 		error("munge_ctx_create failure");
 		return SLURM_ERROR;
@@ -424,6 +498,19 @@ static int _decode_cred(slurm_auth_credential_t *c, char *socket)
 
 again:
 	err = munge_decode(c->m_str, ctx, NULL, NULL, &c->uid, &c->gid);
+	/*
+	 * With cred_reuse a client legitimately sends the same credential
+	 * several times, possibly to different daemons sharing one munged or
+	 * after its cache slot here was recycled. Accept the replay only
+	 * inside the reuse window.
+	 */
+	if ((err == EMUNGE_CRED_REPLAYED) && reuse &&
+	    (munge_ctx_get(ctx, MUNGE_OPT_ENCODE_TIME, &encoded) ==
+	     EMUNGE_SUCCESS) &&
+	    (difftime(time(NULL), encoded) <= reuse)) {
+		debug2("%s: accepting reused credential", __func__);
+		err = EMUNGE_SUCCESS;
+	}
 	if (err != EMUNGE_SUCCESS) {
 		if ((err == EMUNGE_SOCKET) && retry--) {
 			debug("Munge decode failed: %s (retrying ...)",
@@ -469,12 +556,111 @@ again:
 		      munge_ctx_strerror(ctx));
 
 	c->verified = true;
+	if (reuse)
+		_cred_cache_put(c, reuse);
 
 done:
 	munge_ctx_destroy(ctx);
 	return err ? SLURM_ERROR : SLURM_SUCCESS;
 }
 
+/* FNV-1a hash of a munged string, used to pick its cache slot */
+static uint32_t _cred_hash(const char *m_str)
+{
+	uint32_t hash = 2166136261U;
+
+	while (*m_str) {
+		hash ^= (unsigned char) *m_str++;
+		hash *= 16777619U;
+	}
+
+	return hash % CRED_CACHE_SIZE;
+}
+
+/*
+ * If credential `c' was verified within the last reuse window, fill in its
+ * uid/gid/addr from the cache without asking munged.
+ * The full munged string is compared, so a hash collision is only a miss.
+ */
+static bool _cred_cache_get(slurm_auth_credential_t *c)
+{
+	cred_cache_t *ent;
+	bool hit = false;
+
+	if (!c->m_str)
+		return false;
+
+	slurm_mutex_lock(&cred_cache_lock);
+	if (cred_cache) {
+		ent = &cred_cache[_cred_hash(c->m_str)];
+		if (ent->m_str && (ent->expire >= time(NULL)) &&
+		    !xstrcmp(ent->m_str, c->m_str)) {
+			c->uid = ent->uid;
+			c->gid = ent->gid;
+			c->addr = ent->addr;
+			c->verified = true;
+			hit = true;
+		}
+	}
+	slurm_mutex_unlock(&cred_cache_lock);
+
+	return hit;
+}
+
+/* Remember verified credential `c' for `reuse' seconds */
+static void _cred_cache_put(slurm_auth_credential_t *c, int reuse)
+{
+	cred_cache_t *ent;
+
+	slurm_mutex_lock(&cred_cache_lock);
+	if (!cred_cache)
+		cred_cache = xcalloc(CRED_CACHE_SIZE, sizeof(cred_cache_t));
+	ent = &cred_cache[_cred_hash(c->m_str)];
+	if (xstrcmp(ent->m_str, c->m_str)) {
+		xfree(ent->m_str);
+		ent->m_str = xstrdup(c->m_str);
+		ent->expire = time(NULL) + reuse;
+		ent->uid = c->uid;
+		ent->gid = c->gid;
+		ent->addr = c->addr;
+	}
+	slurm_mutex_unlock(&cred_cache_lock);
+}
+
+/*
+ * Return a copy of the last credential encoded with the same AuthInfo
+ * options and identity, or NULL if it is too old to hand out again.
+ * NOTE: Caller must free() return value, like munge_encode() output.
+ */
+static char *_reuse_get(char *opts)
+{
+	char *m_str = NULL;
+
+	slurm_mutex_lock(&reuse_lock);
+	if (reuse_m_str && (reuse_expire >= time(NULL)) &&
+	    (reuse_uid == geteuid()) && (reuse_gid == getegid()) &&
+	    !xstrcmp(reuse_opts, opts))
+		m_str = strdup(reuse_m_str);
+	slurm_mutex_unlock(&reuse_lock);
+
+	return m_str;
+}
+
+/* Keep a copy of freshly encoded `m_str' for up to `reuse' seconds */
+static void _reuse_put(char *m_str, char *opts, int reuse)
+{
+	slurm_mutex_lock(&reuse_lock);
+	if (reuse_m_str)
+		free(reuse_m_str);
+	reuse_m_str = strdup(m_str);
+	xfree(reuse_opts);
+	reuse_opts = xstrdup(opts);
+	reuse_expire = time(NULL) + reuse;
+	reuse_uid = geteuid();
+	reuse_gid = getegid();
+	slurm_mutex_unlock(&reuse_lock);
+}
+
 /*
  *  Print credential information.
  */
@@ -1139,6 +1139,41 @@ static void _set_assoc_mgr_ptrs(bb_alloc_t *bb_alloc)
 /*
  * Determine the current actual burst buffer state.
  */
+static int _cmp_instance_session(const void *x, const void *y)
+{
+	const bb_instances_t *a = x, *b = y;
+
+	if (a->session < b->session)
+		return -1;
+	if (a->session > b->session)
+		return 1;
+	return 0;
+}
+
+/*
+ * Return the total size of the instances of a session.
+ * instances must be sorted by session with _cmp_instance_session().
+ */
+static uint64_t _session_size(bb_instances_t *instances, int num_instances,
+			      uint32_t session)
+{
+	int lo = 0, hi = num_instances;
+	uint64_t size = 0;
+
+	while (lo < hi) {	/* Find the first instance of this session */
+		int mid = (lo + hi) / 2;
+		if (instances[mid].session < session)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	for ( ; (lo < num_instances) && (instances[lo].session == session);
+	     lo++)
+		size += instances[lo].bytes;
+
+	return size;
+}
+
 static void _load_state(bool init_config)
 {
 	static bool first_run = true;
@@ -1250,6 +1285,10 @@ static void _load_state(bool init_config)
 		log_flag(BURST_BUF, "%s: %s: No DataWarp instances found",
 			 plugin_type, __func__);
 		num_instances = 0;	/* Redundant, but fixes CLANG bug */
+	} else if (num_instances > 1) {
+		/* Sort before locking so that sizes are found by bsearch */
+		qsort(instances, num_instances, sizeof(bb_instances_t),
+		      _cmp_instance_session);
 	}
 	sessions = _bb_get_sessions(&num_sessions, &bb_state, timeout);
 	assoc_mgr_lock(&assoc_locks);
@@ -1291,11 +1330,8 @@ static void _load_state(bool init_config)
 				bb_alloc->array_task_id = NO_VAL;
 			}
 		}
-		for (j = 0; j < num_instances; j++) {
-			if (sessions[i].id != instances[j].session)
-				continue;
-			bb_alloc->size += instances[j].bytes;
-		}
+		bb_alloc->size += _session_size(instances, num_instances,
+						sessions[i].id);
 		bb_alloc->seen_time = bb_state.last_load_time;
 
 		if (!init_config) {	/* Newly found buffer */
@@ -187,6 +187,25 @@ static int _job_rec_field_index(lua_State *L)
 	return slurm_lua_job_record_field(L, job_ptr, name);
 }
 
+/*
+ * Entries of slurm.jobs all share one metatable and keep their job_record
+ * under a private light userdata key, so rebuilding the table costs one
+ * table per job rather than a table and a metatable.
+ */
+static char jobs_global_key;
+
+static int _jobs_global_field_index(lua_State *L)
+{
+	const char *name = luaL_checkstring(L, 2);
+	job_record_t *job_ptr;
+
+	lua_pushlightuserdata(L, &jobs_global_key);
+	lua_rawget(L, 1);
+	job_ptr = lua_touserdata(L, -1);
+
+	return slurm_lua_job_record_field(L, job_ptr, name);
+}
+
 /* Get the list of existing slurmctld job records. */
 static void _update_jobs_global(lua_State *st)
 {
@@ -199,32 +218,33 @@ static void _update_jobs_global(lua_State *st)
 	}
 
 	lua_getglobal(st, "slurm");
+	lua_createtable(st, 0, list_count(job_list));
+
+	/* Metatable shared by every job entry, kept at the stack top */
 	lua_newtable(st);
+	lua_pushcfunction(st, _jobs_global_field_index);
+	lua_setfield(st, -2, "__index");
 
 	iter = list_iterator_create(job_list);
 	while ((job_ptr = list_next(iter))) {
-		/* Create an empty table, with a metatable that looks up the
-		 * data for the individual job.
-		 */
-		lua_newtable(st);
-
-		lua_newtable(st);
-		lua_pushcfunction(st, _job_rec_field_index);
-		lua_setfield(st, -2, "__index");
-		/* Store the job_record in the metatable, so the index
-		 * function knows which job it's getting data for.
+		/* Create a table holding only the job_record, with a
+		 * metatable that looks up the data for the individual job.
 		 */
+		lua_createtable(st, 0, 1);
+		lua_pushlightuserdata(st, &jobs_global_key);
 		lua_pushlightuserdata(st, job_ptr);
-		lua_setfield(st, -2, "_job_rec_ptr");
+		lua_rawset(st, -3);
+		lua_pushvalue(st, -2);
 		lua_setmetatable(st, -2);
 
 		/* Lua copies passed strings, so we can reuse the buffer. */
 		snprintf(job_id_buf, sizeof(job_id_buf),
 		         "%d", job_ptr->job_id);
-		lua_setfield(st, -2, job_id_buf);
+		lua_setfield(st, -3, job_id_buf);
 	}
 	last_lua_jobs_update = last_job_update;
 	list_iterator_destroy(iter);
+	lua_pop(st, 1);
 
 	lua_setfield(st, -2, "jobs");
 	lua_pop(st, 1);
@@ -1284,6 +1304,7 @@ extern int job_submit(job_desc_msg_t *job_desc, uint32_t submit_uid,
 		      char **err_msg)
 {
 	int rc = SLURM_ERROR;
+	DEF_TIMERS;
 	slurm_mutex_lock (&lua_lock);
 
 	if ((rc = _load_script()))
@@ -1305,6 +1326,7 @@ extern int job_submit(job_desc_msg_t *job_desc, uint32_t submit_uid,
 	lua_pushnumber(L, submit_uid);
 	slurm_lua_stack_dump(
 		"job_submit/lua", "job_submit, before lua_pcall", L);
+	START_TIMER;
 	if (lua_pcall(L, 3, 1, 0) != 0) {
 		error("%s/lua: %s: %s",
 		      __func__, lua_script_path, lua_tostring(L, -1));
@@ -1318,6 +1340,8 @@ extern int job_submit(job_desc_msg_t *job_desc, uint32_t submit_uid,
 		}
 		lua_pop(L, 1);
 	}
+	END_TIMER2("job_submit/lua: job_submit");
+	debug2("%s/lua: %s", __func__, TIME_STR);
 	slurm_lua_stack_dump(
 		"job_submit/lua", "job_submit, after lua_pcall", L);
 	if (user_msg) {
@@ -1334,6 +1358,7 @@ extern int job_modify(job_desc_msg_t *job_desc, job_record_t *job_ptr,
 		      uint32_t submit_uid)
 {
 	int rc = SLURM_ERROR;
+	DEF_TIMERS;
 	slurm_mutex_lock (&lua_lock);
 
 	if ((rc = _load_script()))
@@ -1356,6 +1381,7 @@ extern int job_modify(job_desc_msg_t *job_desc, job_record_t *job_ptr,
 	lua_pushnumber(L, submit_uid);
 	slurm_lua_stack_dump(
 		"job_submit/lua", "job_modify, before lua_pcall", L);
+	START_TIMER;
 	if (lua_pcall(L, 4, 1, 0) != 0) {
 		error("%s/lua: %s: %s",
 		      __func__, lua_script_path, lua_tostring(L, -1));
@@ -1369,6 +1395,8 @@ extern int job_modify(job_desc_msg_t *job_desc, job_record_t *job_ptr,
 		}
 		lua_pop(L, 1);
 	}
+	END_TIMER2("job_submit/lua: job_modify");
+	debug2("%s/lua: %s", __func__, TIME_STR);
 	slurm_lua_stack_dump(
 		"job_submit/lua", "job_modify, after lua_pcall", L);
 	if (user_msg) {
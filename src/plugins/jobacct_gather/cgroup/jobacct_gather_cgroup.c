@@ -45,6 +45,9 @@
 #include "src/common/slurm_protocol_api.h"
 #include "src/common/slurm_protocol_defs.h"
 #include "src/common/slurm_acct_gather_energy.h"
+#include "src/common/slurm_acct_gather_filesystem.h"
+#include "src/common/slurm_acct_gather_interconnect.h"
+#include "src/common/slurm_jobacct_gather.h"
 #include "src/common/xstring.h"
 #include "src/slurmd/common/proctrack.h"
 #include "src/slurmd/common/xcpuinfo.h"
@@ -215,6 +218,49 @@ static void _prec_extra(jag_prec_t *prec, uint32_t taskid)
 
 }
 
+/*
+ * Build one process record per task from the task cgroups alone. Used with
+ * JobAcctGatherParams=CgroupOnly instead of walking /proc for every process
+ * of the step; _prec_extra() fills in the cpu and memory counters.
+ */
+static List _get_precs_cgroup(List task_list, bool pgid_plugin,
+			      uint64_t cont_id, jag_callbacks_t *callbacks)
+{
+	List prec_list = list_create(destroy_jag_prec);
+	ListIterator itr;
+	struct jobacctinfo *jobacct;
+	jag_prec_t *prec;
+	int i;
+
+	if (!task_list)
+		return prec_list;
+
+	itr = list_iterator_create(task_list);
+	while ((jobacct = list_next(itr))) {
+		prec = xmalloc(sizeof(jag_prec_t));
+		prec->pid = jobacct->pid;
+		prec->tres_count = jobacct->tres_count;
+		prec->tres_data = xmalloc(prec->tres_count *
+					  sizeof(acct_gather_data_t));
+		for (i = 0; i < prec->tres_count; i++) {
+			prec->tres_data[i].num_reads = INFINITE64;
+			prec->tres_data[i].num_writes = INFINITE64;
+			prec->tres_data[i].size_read = INFINITE64;
+			prec->tres_data[i].size_write = INFINITE64;
+		}
+
+		if (acct_gather_filesystem_g_get_data(prec->tres_data) < 0)
+			debug2("problem retrieving filesystem data");
+		if (acct_gather_interconnect_g_get_data(prec->tres_data) < 0)
+			debug2("problem retrieving interconnect data");
+
+		list_append(prec_list, prec);
+	}
+	list_iterator_destroy(itr);
+
+	return prec_list;
+}
+
 /*
  * init() is called when the plugin is loaded, before any other functions
  * are called.  Put global initialization here.
@@ -297,6 +343,9 @@ extern void jobacct_gather_p_poll_data(
 		memset(&callbacks, 0, sizeof(jag_callbacks_t));
 		first = 0;
 		callbacks.prec_extra = _prec_extra;
+		if (xstrcasestr(slurm_conf.job_acct_gather_params,
+				"CgroupOnly"))
+			callbacks.get_precs = _get_precs_cgroup;
 	}
 
 	jag_common_poll_data(task_list, pgid_plugin, cont_id, &callbacks,
@@ -52,6 +52,7 @@
 #include "src/common/slurm_acct_gather_energy.h"
 #include "src/common/slurm_acct_gather_filesystem.h"
 #include "src/common/slurm_acct_gather_interconnect.h"
+#include "src/common/xhash.h"
 #include "src/common/xstring.h"
 #include "src/slurmd/common/proctrack.h"
 
@@ -70,6 +71,15 @@ char **assoc_mgr_tres_name_array;
 #endif
 
 
+/* /proc files kept open between polls for a process of the container */
+typedef struct {
+	pid_t pid;
+	int stat_fd;
+	int io_fd;
+	int lwp;	/* _is_a_lwp() of pid, -1 if not known yet */
+	uint32_t gen;	/* proc_fd_gen of the last poll that saw pid */
+} jag_proc_fd_t;
+
 static int cpunfo_frequency = 0;
 static long hertz = 0;
 
@@ -77,6 +87,166 @@ static int my_pagesize = 0;
 static DIR  *slash_proc = NULL;
 static int energy_profile = ENERGY_DATA_NODE_ENERGY_UP;
 
+static xhash_t *proc_fd_hash = NULL;	/* jag_proc_fd_t by pid */
+static uint32_t proc_fd_gen = 0;
+
+static void _proc_fd_id(void *item, const char **key, uint32_t *key_len)
+{
+	jag_proc_fd_t *ent = item;
+
+	*key = (const char *) &ent->pid;
+	*key_len = sizeof(ent->pid);
+}
+
+static void _proc_fd_free(void *item)
+{
+	jag_proc_fd_t *ent = item;
+
+	if (ent->stat_fd >= 0)
+		close(ent->stat_fd);
+	if (ent->io_fd >= 0)
+		close(ent->io_fd);
+	xfree(ent);
+}
+
+static jag_proc_fd_t *_proc_fd_get(pid_t pid)
+{
+	jag_proc_fd_t *ent;
+
+	if (!proc_fd_hash)
+		proc_fd_hash = xhash_init(_proc_fd_id, _proc_fd_free);
+
+	if (!(ent = xhash_get(proc_fd_hash, (char *) &pid, sizeof(pid)))) {
+		ent = xmalloc(sizeof(*ent));
+		ent->pid = pid;
+		ent->stat_fd = -1;
+		ent->io_fd = -1;
+		ent->lwp = -1;
+		xhash_add(proc_fd_hash, ent);
+	}
+	ent->gen = proc_fd_gen;
+
+	return ent;
+}
+
+static void _proc_fd_find_gone(void *item, void *arg)
+{
+	jag_proc_fd_t *ent = item;
+
+	if (ent->gen != proc_fd_gen)
+		list_append((List) arg, &ent->pid);
+}
+
+/* Close the files of processes not seen by the current poll */
+static void _proc_fd_purge_gone(void)
+{
+	List gone_list;
+	pid_t *pid;
+
+	if (!proc_fd_hash)
+		return;
+
+	gone_list = list_create(NULL);
+	xhash_walk(proc_fd_hash, _proc_fd_find_gone, gone_list);
+	while ((pid = list_pop(gone_list)))
+		xhash_delete(proc_fd_hash, (char *) pid, sizeof(*pid));
+	FREE_NULL_LIST(gone_list);
+}
+
+/*
+ * Read /proc/<pid>/<name> into buf (NUL terminated).
+ * IN/OUT fd - if not NULL, an open descriptor of the file to pread() from,
+ *	 updated with the descriptor of the file if it had to be (re)opened.
+ *	 If NULL the file is opened and closed again.
+ * OUT opened - if not NULL, set when the file had to be (re)opened
+ * RET bytes read, <= 0 if the process went away
+ */
+static ssize_t _read_proc_file(pid_t pid, const char *name, int *fd,
+			       bool *opened, char *buf, size_t size)
+{
+	char path[64];
+	int tmp_fd = -1;
+	ssize_t n;
+
+	if (opened)
+		*opened = false;
+	if (!fd)
+		fd = &tmp_fd;
+
+	if (*fd >= 0) {
+		while (((n = pread(*fd, buf, size - 1, 0)) < 0) &&
+		       (errno == EINTR))
+			;
+		if (n > 0) {
+			buf[n] = '\0';
+			return n;
+		}
+		/* The process exited, its pid may have been reused */
+		close(*fd);
+		*fd = -1;
+	}
+
+	snprintf(path, sizeof(path), "/proc/%d/%s", pid, name);
+	if ((*fd = open(path, O_RDONLY | O_CLOEXEC)) < 0)
+		return -1;
+	if (opened)
+		*opened = true;
+
+	while (((n = read(*fd, buf, size - 1)) < 0) && (errno == EINTR))
+		;
+	if (n > 0)
+		buf[n] = '\0';
+	if ((n <= 0) || (fd == &tmp_fd)) {
+		close(*fd);
+		*fd = -1;
+	}
+
+	return n;
+}
+
+/*
+ * Parse the next whitespace separated field of *buf as a decimal number,
+ * advancing *buf past it.
+ * RET false if the field is missing or not a number
+ */
+static bool _next_num(char **buf, int64_t *val)
+{
+	char *p = *buf;
+	bool neg = false;
+	uint64_t v = 0;
+
+	while (isspace(*p))
+		p++;
+	if (*p == '-') {
+		neg = true;
+		p++;
+	}
+	if (!isdigit(*p))
+		return false;
+	while (isdigit(*p))
+		v = (v * 10) + (*p++ - '0');
+
+	*val = neg ? -((int64_t) v) : (int64_t) v;
+	*buf = p;
+	return true;
+}
+
+/* Advance *buf past the next whitespace separated field */
+static bool _skip_field(char **buf)
+{
+	char *p = *buf;
+
+	while (isspace(*p))
+		p++;
+	if (!*p)
+		return false;
+	while (*p && !isspace(*p))
+		p++;
+
+	*buf = p;
+	return true;
+}
+
 static int _find_prec(void *x, void *key)
 {
 	jag_prec_t *prec = (jag_prec_t *) x;
@@ -303,85 +473,64 @@ again:
 	}
 }
 
-/* _get_process_data_line() - get line of data from /proc/<pid>/stat
+/* _get_process_data_line() - parse data from /proc/<pid>/stat
  *
- * IN:	in - input file descriptor
+ * IN:	sbuf - contents of the file
  * OUT:	prec - the destination for the data
  *
  * RETVAL:	==0 - no valid data
  * 		!=0 - data are valid
  *
- * Based upon stat2proc() from the ps command. It can handle arbitrary
- * executable file basenames for `cmd', i.e. those with embedded whitespace or
- * embedded ')'s. Such names confuse %s (see scanf(3)), so the string is split
- * and %39c is used instead. (except for embedded ')' "(%[^)]c)" would work.
+ * Like stat2proc() from the ps command the line is split at the last ')', so
+ * that executable file basenames for `cmd' with embedded whitespace or ')'s
+ * are skipped over. Fields 4 (ppid) to 39 (processor) are all numbers.
  */
-static int _get_process_data_line(int in, jag_prec_t *prec) {
-	char sbuf[512], *tmp;
-	int num_read, nvals;
-	char cmd[40], state[1];
-	int ppid, pgrp, session, tty_nr, tpgid;
-	long unsigned flags, minflt, cminflt, majflt, cmajflt;
-	long unsigned utime, stime, starttime, vsize;
-	long int cutime, cstime, priority, nice, timeout, itrealvalue, rss;
-	long unsigned f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13;
-	int exit_signal, last_cpu;
-
-	num_read = read(in, sbuf, (sizeof(sbuf) - 1));
-	if (num_read <= 0)
-		return 0;
-	sbuf[num_read] = '\0';
+static int _get_process_data_line(char *sbuf, jag_prec_t *prec) {
+	enum {
+		STAT_PPID,
+		STAT_MAJFLT = 8,
+		STAT_UTIME = 10,
+		STAT_STIME,
+		STAT_VSIZE = 19,
+		STAT_RSS,
+		STAT_PROCESSOR = 35,
+		STAT_CNT
+	};
+	int64_t vals[STAT_CNT], pid;
+	char *tmp;
+	int i;
 
-	/*
-	 * split into "PID (cmd" and "<rest>" replace trailing ')' with NULL
-	 */
 	tmp = strrchr(sbuf, ')');
-	if (!tmp)
+	if (!tmp || !_next_num(&sbuf, &pid))
 		return 0;
-	*tmp = '\0';
+	prec->pid = pid;
 
-	/* parse these two strings separately, skipping the leading "(". */
-	nvals = sscanf(sbuf, "%d (%39c", &prec->pid, cmd);
-	if (nvals < 2)
+	tmp++;
+	if (!_skip_field(&tmp))	/* state */
 		return 0;
-
-	nvals = sscanf(tmp + 2,	 /* skip space after ')' too */
-		       "%c %d %d %d %d %d "
-		       "%lu %lu %lu %lu %lu "
-		       "%lu %lu %ld %ld %ld %ld "
-		       "%ld %ld %lu %lu %ld "
-		       "%lu %lu %lu %lu %lu "
-		       "%lu %lu %lu %lu %lu "
-		       "%lu %lu %lu %d %d ",
-		       state, &ppid, &pgrp, &session, &tty_nr, &tpgid,
-		       &flags, &minflt, &cminflt, &majflt, &cmajflt,
-		       &utime, &stime, &cutime, &cstime, &priority, &nice,
-		       &timeout, &itrealvalue, &starttime, &vsize, &rss,
-		       &f1, &f2, &f3, &f4, &f5 ,&f6, &f7, &f8, &f9, &f10, &f11,
-		       &f12, &f13, &exit_signal, &last_cpu);
+	for (i = 0; i < STAT_CNT; i++) {
+		if (!_next_num(&tmp, &vals[i]))
+			return 0;
+	}
 	/* There are some additional fields, which we do not scan or use */
-	if ((nvals < 37) || (rss < 0))
-		return 0;
-
-	/* If current pid corresponds to a Light Weight Process (Thread POSIX) */
-	/* skip it, we will only account the original process (pid==tgid) */
-	if (_is_a_lwp(prec->pid) > 0)
+	if (vals[STAT_RSS] < 0)
 		return 0;
 
 	/* Copy the values that slurm records into our data structure */
-	prec->ppid  = ppid;
+	prec->ppid  = vals[STAT_PPID];
 
-	prec->tres_data[TRES_ARRAY_PAGES].size_read = majflt;
-	prec->tres_data[TRES_ARRAY_VMEM].size_read = vsize;
-	prec->tres_data[TRES_ARRAY_MEM].size_read = rss * my_pagesize;
+	prec->tres_data[TRES_ARRAY_PAGES].size_read = vals[STAT_MAJFLT];
+	prec->tres_data[TRES_ARRAY_VMEM].size_read = vals[STAT_VSIZE];
+	prec->tres_data[TRES_ARRAY_MEM].size_read =
+		vals[STAT_RSS] * my_pagesize;
 
 	/*
 	 * Store unnormalized times, we will normalize in when
 	 * transfering to a struct jobacctinfo in job_common_poll_data()
 	 */
-	prec->usec = (double)utime;
-	prec->ssec = (double)stime;
-	prec->last_cpu = last_cpu;
+	prec->usec = (double)vals[STAT_UTIME];
+	prec->ssec = (double)vals[STAT_STIME];
+	prec->last_cpu = vals[STAT_PROCESSOR];
 	return 1;
 }
 
@@ -447,9 +596,9 @@ static int _remove_share_data(char *proc_stat_file, jag_prec_t *prec)
 	return rc;
 }
 
-/* _get_process_io_data_line() - get line of data from /proc/<pid>/io
+/* _get_process_io_data_line() - parse data from /proc/<pid>/io
  *
- * IN:	in - input file descriptor
+ * IN:	sbuf - contents of the file
  * OUT:	prec - the destination for the data
  *
  * RETVAL:	==0 - no valid data
@@ -460,23 +609,11 @@ static int _remove_share_data(char *proc_stat_file, jag_prec_t *prec)
  * wrchar: <# of characters written>
  *   . . .
  */
-static int _get_process_io_data_line(int in, jag_prec_t *prec) {
-	char sbuf[256];
-	char f1[7], f3[7];
-	int num_read, nvals;
-	uint64_t rchar, wchar;
-
-	num_read = read(in, sbuf, (sizeof(sbuf) - 1));
-	if (num_read <= 0)
-		return 0;
-	sbuf[num_read] = '\0';
-
-	nvals = sscanf(sbuf, "%s %"PRIu64" %s %"PRIu64"",
-		       f1, &rchar, f3, &wchar);
-	if (nvals < 4)
-		return 0;
+static int _get_process_io_data_line(char *sbuf, jag_prec_t *prec) {
+	int64_t rchar, wchar;
 
-	if (_is_a_lwp(prec->pid) > 0)
+	if (!_skip_field(&sbuf) || !_next_num(&sbuf, &rchar) ||
+	    !_skip_field(&sbuf) || !_next_num(&sbuf, &wchar))
 		return 0;
 
 	/* keep real value here since we aren't doubles */
@@ -486,16 +623,19 @@ static int _get_process_io_data_line(int in, jag_prec_t *prec) {
 	return 1;
 }
 
-static void _handle_stats(List prec_list, char *proc_stat_file,
-			  char *proc_io_file, char *proc_smaps_file,
+/*
+ * Add a process record for pid to prec_list.
+ * IN ent - if not NULL, /proc files of pid kept open between polls
+ */
+static void _handle_stats(List prec_list, pid_t pid, jag_proc_fd_t *ent,
 			  jag_callbacks_t *callbacks,
 			  int tres_count)
 {
 	static int no_share_data = -1;
 	static int use_pss = -1;
-	FILE *stat_fp = NULL;
-	FILE *io_fp = NULL;
-	int fd, fd2, i;
+	char sbuf[512], proc_file[64];
+	bool opened = false;
+	int i, lwp;
 	jag_prec_t *prec = NULL;
 
 	if (no_share_data == -1) {
@@ -510,21 +650,13 @@ static void _handle_stats(List prec_list, char *proc_stat_file,
 			use_pss = 0;
 	}
 
-	if (!(stat_fp = fopen(proc_stat_file, "r")))
-		return;  /* Assume the process went away */
 	/*
-	 * Close the file on exec() of user tasks.
-	 *
-	 * NOTE: If we fork() slurmstepd after the
-	 * fopen() above and before the fcntl() below,
-	 * then the user task may have this extra file
-	 * open, which can cause problems for
-	 * checkpoint/restart, but this should be a very rare
-	 * problem in practice.
+	 * The files are opened with O_CLOEXEC so user tasks forked while we
+	 * hold them open do not inherit them.
 	 */
-	fd = fileno(stat_fp);
-	if (fcntl(fd, F_SETFD, FD_CLOEXEC) == -1)
-		error("%s: fcntl(%s): %m", __func__, proc_stat_file);
+	if (_read_proc_file(pid, "stat", ent ? &ent->stat_fd : NULL, &opened,
+			    sbuf, sizeof(sbuf)) <= 0)
+		return;  /* Assume the process went away */
 
 	prec = xmalloc(sizeof(jag_prec_t));
 
@@ -549,13 +681,30 @@ static void _handle_stats(List prec_list, char *proc_stat_file,
 		prec->tres_data[i].size_write = INFINITE64;
 	}
 
-	if (!_get_process_data_line(fd, prec)) {
+	if (!_get_process_data_line(sbuf, prec)) {
+		xfree(prec->tres_data);
+		xfree(prec);
+		return;
+	}
+
+	/*
+	 * If current pid corresponds to a Light Weight Process (Thread POSIX)
+	 * skip it, we will only account the original process (pid==tgid).
+	 * That does not change for the life of the process, so only check it
+	 * again when the stat file had to be reopened.
+	 */
+	if (ent && !opened && (ent->lwp >= 0)) {
+		lwp = ent->lwp;
+	} else {
+		lwp = _is_a_lwp(prec->pid);
+		if (ent)
+			ent->lwp = lwp;
+	}
+	if (lwp > 0) {
 		xfree(prec->tres_data);
 		xfree(prec);
-		fclose(stat_fp);
 		return;
 	}
-	fclose(stat_fp);
 
 	if (acct_gather_filesystem_g_get_data(prec->tres_data) < 0) {
 		debug2("problem retrieving filesystem data");
@@ -566,12 +715,15 @@ static void _handle_stats(List prec_list, char *proc_stat_file,
 	}
 
 	/* Remove shared data from rss */
-	if (no_share_data)
-		_remove_share_data(proc_stat_file, prec);
+	if (no_share_data) {
+		snprintf(proc_file, sizeof(proc_file), "/proc/%d/stat", pid);
+		_remove_share_data(proc_file, prec);
+	}
 
 	/* Use PSS instead if RSS */
 	if (use_pss) {
-		if (_get_pss(proc_smaps_file, prec) == -1) {
+		snprintf(proc_file, sizeof(proc_file), "/proc/%d/smaps", pid);
+		if (_get_pss(proc_file, prec) == -1) {
 			xfree(prec->tres_data);
 			xfree(prec);
 			return;
@@ -580,22 +732,15 @@ static void _handle_stats(List prec_list, char *proc_stat_file,
 
 	list_append(prec_list, prec);
 
-	if ((io_fp = fopen(proc_io_file, "r"))) {
-		fd2 = fileno(io_fp);
-		if (fcntl(fd2, F_SETFD, FD_CLOEXEC) == -1)
-			error("%s: fcntl: %m", __func__);
-		_get_process_io_data_line(fd2, prec);
-		fclose(io_fp);
-	}
+	if (_read_proc_file(pid, "io", ent ? &ent->io_fd : NULL, NULL,
+			    sbuf, sizeof(sbuf)) > 0)
+		_get_process_io_data_line(sbuf, prec);
 }
 
 static List _get_precs(List task_list, bool pgid_plugin, uint64_t cont_id,
 		       jag_callbacks_t *callbacks)
 {
 	List prec_list = list_create(destroy_jag_prec);
-	char	proc_stat_file[256];	/* Allow ~20x extra length */
-	char	proc_io_file[256];	/* Allow ~20x extra length */
-	char	proc_smaps_file[256];	/* Allow ~20x extra length */
 	static	int	slash_proc_open = 0;
 	int i;
 	struct jobacctinfo *jobacct = NULL;
@@ -609,6 +754,7 @@ static List _get_precs(List task_list, bool pgid_plugin, uint64_t cont_id,
 		int npids = 0;
 		/* get only the processes in the proctrack container */
 		proctrack_g_get_pids(cont_id, &pids, &npids);
+		proc_fd_gen++;
 		if (!npids) {
 			/* update consumed energy even if pids do not exist */
 			if (jobacct) {
@@ -628,20 +774,24 @@ static List _get_precs(List task_list, bool pgid_plugin, uint64_t cont_id,
 			}
 
 			debug4("no pids in this container %"PRIu64"", cont_id);
+			_proc_fd_purge_gone();
 			goto finished;
 		}
+		/*
+		 * The processes of the container are mostly the same from one
+		 * poll to the next, so keep their files open and pread() them
+		 * instead of opening them again each time.
+		 */
 		for (i = 0; i < npids; i++) {
-			snprintf(proc_stat_file, 256, "/proc/%d/stat", pids[i]);
-			snprintf(proc_io_file, 256, "/proc/%d/io", pids[i]);
-			snprintf(proc_smaps_file, 256, "/proc/%d/smaps", pids[i]);
-			_handle_stats(prec_list, proc_stat_file, proc_io_file,
-				      proc_smaps_file, callbacks,
+			_handle_stats(prec_list, pids[i],
+				      _proc_fd_get(pids[i]), callbacks,
 				      jobacct ? jobacct->tres_count : 0);
 		}
 		xfree(pids);
+		_proc_fd_purge_gone();
 	} else {
 		struct dirent *slash_proc_entry;
-		char  *iptr = NULL, *optr = NULL, *optr2 = NULL;
+		char *iptr;
 
 		if (slash_proc_open) {
 			rewinddir(slash_proc);
@@ -653,79 +803,20 @@ static List _get_precs(List task_list, bool pgid_plugin, uint64_t cont_id,
 			}
 			slash_proc_open=1;
 		}
-		strcpy(proc_stat_file, "/proc/");
-		strcpy(proc_io_file, "/proc/");
-		strcpy(proc_smaps_file, "/proc/");
 
 		while ((slash_proc_entry = readdir(slash_proc))) {
-
-			/* Save a few cyles by simulating
-			 * strcat(statFileName, slash_proc_entry->d_name);
-			 * strcat(statFileName, "/stat");
-			 * while checking for a numeric filename (which really
-			 * should be a pid). Then do the same for the
-			 * /proc/<pid>/io file name.
-			 */
-			optr = proc_stat_file + sizeof("/proc");
-			iptr = slash_proc_entry->d_name;
-			i = 0;
-			do {
-				if ((*iptr < '0') ||
-				    ((*optr++ = *iptr++) > '9')) {
-					i = -1;
-					break;
-				}
-			} while (*iptr);
-
-			if (i == -1)
-				continue;
-			iptr = (char*)"/stat";
-
-			do {
-				*optr++ = *iptr++;
-			} while (*iptr);
-			*optr = 0;
-
-			optr2 = proc_io_file + sizeof("/proc");
+			/* Only numeric names (which really should be pids) */
 			iptr = slash_proc_entry->d_name;
-			i = 0;
 			do {
-				if ((*iptr < '0') ||
-				    ((*optr2++ = *iptr++) > '9')) {
-					i = -1;
+				if (!isdigit(*iptr))
 					break;
-				}
-			} while (*iptr);
-			if (i == -1)
+			} while (*++iptr);
+			if (*iptr)
 				continue;
-			iptr = (char*)"/io";
-
-			do {
-				*optr2++ = *iptr++;
-			} while (*iptr);
-			*optr2 = 0;
-
-			optr2 = proc_smaps_file + sizeof("/proc");
-			iptr = slash_proc_entry->d_name;
-			i = 0;
-			do {
-				if ((*iptr < '0') ||
-				    ((*optr2++ = *iptr++) > '9')) {
-					i = -1;
-					break;
-				}
-			} while (*iptr);
-			if (i == -1)
-				continue;
-			iptr = (char*)"/smaps";
-
-			do {
-				*optr2++ = *iptr++;
-			} while (*iptr);
-			*optr2 = 0;
 
-			_handle_stats(prec_list, proc_stat_file, proc_io_file,
-				      proc_smaps_file,callbacks,
+			_handle_stats(prec_list,
+				      atoi(slash_proc_entry->d_name), NULL,
+				      callbacks,
 				      jobacct ? jobacct->tres_count : 0);
 		}
 	}
@@ -881,6 +972,7 @@ extern void jag_common_fini(void)
 {
 	if (slash_proc)
 		(void) closedir(slash_proc);
+	xhash_free(proc_fd_hash);
 }
 
 extern void destroy_jag_prec(void *object)
@@ -99,6 +99,7 @@ const char plugin_type[] = "jobcomp/elasticsearch";
 const uint32_t plugin_version = SLURM_VERSION_NUMBER;
 
 #define INDEX_RETRY_INTERVAL 30
+#define BULK_MAX_JOBS 1000	/* max jobs indexed per _bulk request */
 #define JOBCOMP_DATA_FORMAT "{\"jobid\":%u,\"username\":\"%s\","	\
 	"\"user_id\":%u,\"groupname\":\"%s\",\"group_id\":%u,"		\
 	"\"@start\":\"%s\",\"@end\":\"%s\",\"elapsed\":%ld,"		\
@@ -128,6 +129,7 @@ struct http_response {
 struct job_node {
 	time_t last_index_retry;
 	char * serialized_job;
+	bool indexed;
 };
 
 char *save_state_file = "elasticsearch_state";
@@ -292,99 +294,101 @@ static size_t _write_callback(void *contents, size_t size, size_t nmemb,
 	return realsize;
 }
 
-/* Try to index job into elasticsearch */
-static int _index_job(const char *jobcomp)
+/*
+ * Try to index a batch of jobs into elasticsearch with a single request to
+ * the _bulk API, reusing curl_handle (and its open connection) between calls.
+ * Each job successfully indexed has its indexed flag set.
+ * RET count of jobs indexed
+ */
+static int _index_jobs(CURL *curl_handle, struct job_node **jnodes, int cnt)
 {
-	CURL *curl_handle = NULL;
 	CURLcode res;
 	struct http_response chunk;
 	struct curl_slist *slist = NULL;
-	int rc = SLURM_SUCCESS;
-	char *token = NULL;
+	char *body = NULL, *pos = NULL, *bulk_url = NULL, *status;
+	long http_code = 0;
+	int i, indexed = 0;
 
 	if (log_url == NULL) {
 		error("%s: JobCompLoc parameter not configured", plugin_type);
-		return SLURM_ERROR;
-	}
-
-	if (curl_global_init(CURL_GLOBAL_ALL) != 0) {
-		error("%s: curl_global_init: %m", plugin_type);
-		rc = SLURM_ERROR;
-		goto cleanup_global_init;
-	} else if ((curl_handle = curl_easy_init()) == NULL) {
-		error("%s: curl_easy_init: %m", plugin_type);
-		rc = SLURM_ERROR;
-		goto cleanup_easy_init;
+		return 0;
 	}
 
-	slist = curl_slist_append(slist, "Content-Type: application/json");
-
+	slist = curl_slist_append(slist, "Content-Type: application/x-ndjson");
 	if (slist == NULL) {
 		error("%s: curl_slist_append: %m", plugin_type);
-		rc = SLURM_ERROR;
-		goto cleanup_easy_init;
+		return 0;
 	}
 
+	/* one action line and one document line per job */
+	for (i = 0; i < cnt; i++)
+		xstrfmtcatat(body, &pos, "{\"index\":{}}\n%s\n",
+			     jnodes[i]->serialized_job);
+	bulk_url = xstrdup_printf("%s/_bulk", log_url);
+
 	chunk.message = xmalloc(1);
 	chunk.size = 0;
 
-	curl_easy_setopt(curl_handle, CURLOPT_URL, log_url);
+	curl_easy_setopt(curl_handle, CURLOPT_URL, bulk_url);
 	curl_easy_setopt(curl_handle, CURLOPT_POST, 1);
-	curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, jobcomp);
-	curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDSIZE, strlen(jobcomp));
+	curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, body);
+	curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDSIZE,
+			 (long) (pos - body));
 	curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, slist);
-	curl_easy_setopt(curl_handle, CURLOPT_HEADER, 1);
 	curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, _write_callback);
 	curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, (void *) &chunk);
+	curl_easy_setopt(curl_handle, CURLOPT_TIMEOUT, curl_timeout);
+	curl_easy_setopt(curl_handle, CURLOPT_CONNECTTIMEOUT,
+			 curl_connecttimeout);
+	if ((curl_timeout > 0) || (curl_connecttimeout > 0))
+		curl_easy_setopt(curl_handle, CURLOPT_NOSIGNAL, 1);
 
 	if ((res = curl_easy_perform(curl_handle)) != CURLE_OK) {
 		log_flag(ESEARCH, "%s: Could not connect to: %s , reason: %s",
-			 plugin_type, log_url, curl_easy_strerror(res));
-		rc = SLURM_ERROR;
+			 plugin_type, bulk_url, curl_easy_strerror(res));
 		goto cleanup;
 	}
 
-	token = strtok(chunk.message, " ");
-	if (token == NULL) {
-		error("%s: Could not receive the HTTP response status code from %s",
-		      plugin_type, log_url);
-		rc = SLURM_ERROR;
+	curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &http_code);
+	if (http_code != 200) {
+		log_flag(ESEARCH, "%s: HTTP status code %ld received from %s",
+			 plugin_type, http_code, bulk_url);
+		log_flag(ESEARCH, "%s: HTTP response:\n%s",
+			 plugin_type, chunk.message);
 		goto cleanup;
 	}
-	token = strtok(NULL, " ");
-
-	/* HTTP 100 (Continue). */
-	if ((xstrcmp(token, "100") == 0)) {
-		(void)  strtok(NULL, " ");
-		token = strtok(NULL, " ");
-	}
 
 	/*
-	 * HTTP 200 (OK)	- request succeed.
-	 * HTTP 201 (Created)	- request succeed and resource created.
+	 * The response holds one item per action, in request order, each
+	 * with its own HTTP status. 200 (OK) or 201 (Created) means the job
+	 * was indexed; anything else is retried later.
 	 */
-	if ((xstrcmp(token, "200") != 0) && (xstrcmp(token, "201") != 0)) {
-		log_flag(ESEARCH, "%s: HTTP status code %s received from %s",
-			 plugin_type, token, log_url);
-		log_flag(ESEARCH, "%s: HTTP response:\n%s",
-			 plugin_type, chunk.message);
-		rc = SLURM_ERROR;
-	} else {
-		token = strtok((char *)jobcomp, ",");
-		(void)  strtok(token, ":");
-		token = strtok(NULL, ":");
-		log_flag(ESEARCH, "%s: Job with jobid %s indexed into elasticsearch",
-			 plugin_type, token);
+	status = strstr(chunk.message, "\"items\"");
+	for (i = 0; status && (i < cnt); i++) {
+		long item_code;
+
+		if (!(status = strstr(status, "\"status\":")))
+			break;
+		status += strlen("\"status\":");
+		item_code = strtol(status, NULL, 10);
+		if ((item_code == 200) || (item_code == 201)) {
+			jnodes[i]->indexed = true;
+			indexed++;
+		} else {
+			log_flag(ESEARCH, "%s: HTTP status code %ld received indexing job %d of %d",
+				 plugin_type, item_code, (i + 1), cnt);
+		}
 	}
+	if (i < cnt)
+		error("%s: could not parse _bulk response from %s",
+		      plugin_type, bulk_url);
 
 cleanup:
 	curl_slist_free_all(slist);
 	xfree(chunk.message);
-cleanup_easy_init:
-	curl_easy_cleanup(curl_handle);
-cleanup_global_init:
-	curl_global_cleanup();
-	return rc;
+	xfree(bulk_url);
+	xfree(body);
+	return indexed;
 }
 
 static char _convert_dec_hex(char x)
@@ -877,12 +881,21 @@ extern int slurm_jobcomp_log_record(job_record_t *job_ptr)
 	return SLURM_SUCCESS;
 }
 
+static int _find_indexed(void *x, void *key)
+{
+	struct job_node *jnode = (struct job_node *) x;
+
+	return jnode->indexed;
+}
+
 extern void *_process_jobs(void *x)
 {
 	ListIterator iter;
-	struct job_node *jnode = NULL;
+	struct job_node *jnode = NULL, **batch;
 	struct timespec ts = {0, 0};
+	CURL *curl_handle;
 	time_t now;
+	int batch_cnt = 0;
 
 	/* Wait for slurm_jobcomp_set_location log_url setup. */
 	slurm_mutex_lock(&location_mutex);
@@ -890,33 +903,54 @@ extern void *_process_jobs(void *x)
 	slurm_cond_timedwait(&location_cond, &location_mutex, &ts);
 	slurm_mutex_unlock(&location_mutex);
 
+	/* One handle for the life of the thread, so connections are reused */
+	if ((curl_handle = curl_easy_init()) == NULL) {
+		error("%s: curl_easy_init: %m", plugin_type);
+		return NULL;
+	}
+	batch = xcalloc(BULK_MAX_JOBS, sizeof(*batch));
+
 	while (!thread_shutdown) {
-		int success_cnt = 0, fail_cnt = 0, wait_retry_cnt = 0;
-		sleep(1);
+		int success_cnt = 0, wait_retry_cnt = 0;
+
+		/* More may be waiting if the last batch was full */
+		if (batch_cnt < BULK_MAX_JOBS)
+			sleep(1);
+		batch_cnt = 0;
+
+		now = time(NULL);
 		iter = list_iterator_create(jobslist);
-		while ((jnode = (struct job_node *)list_next(iter)) &&
-		       !thread_shutdown) {
-			now = time(NULL);
-			if ((jnode->last_index_retry == 0) ||
-			    (difftime(now, jnode->last_index_retry) >=
-					INDEX_RETRY_INTERVAL)) {
-				if ((_index_job(jnode->serialized_job) ==
-				     SLURM_SUCCESS)) {
-					list_delete_item(iter);
-					success_cnt++;
-				} else {
-					jnode->last_index_retry = now;
-					fail_cnt++;
-				}
-			} else
+		while ((jnode = (struct job_node *)list_next(iter))) {
+			if ((jnode->last_index_retry != 0) &&
+			    (difftime(now, jnode->last_index_retry) <
+			     INDEX_RETRY_INTERVAL)) {
 				wait_retry_cnt++;
+				continue;
+			}
+			batch[batch_cnt++] = jnode;
+			if (batch_cnt >= BULK_MAX_JOBS)
+				break;
 		}
 		list_iterator_destroy(iter);
-		if ((success_cnt || fail_cnt))
-			log_flag(ESEARCH, "%s: index success:%d fail:%d wait_retry:%d",
-				 plugin_type, success_cnt, fail_cnt,
-				 wait_retry_cnt);
+
+		if (!batch_cnt || thread_shutdown)
+			continue;
+
+		success_cnt = _index_jobs(curl_handle, batch, batch_cnt);
+		for (int i = 0; i < batch_cnt; i++) {
+			if (!batch[i]->indexed)
+				batch[i]->last_index_retry = now;
+		}
+		if (success_cnt)
+			(void) list_delete_all(jobslist, _find_indexed, NULL);
+
+		log_flag(ESEARCH, "%s: index success:%d fail:%d wait_retry:%d",
+			 plugin_type, success_cnt, (batch_cnt - success_cnt),
+			 wait_retry_cnt);
 	}
+
+	xfree(batch);
+	curl_easy_cleanup(curl_handle);
 	return NULL;
 }
 
@@ -945,12 +979,15 @@ extern int init(void)
 	/*			    1234567890123456 */
 	if ((tmp_ptr = xstrcasestr(slurm_conf.job_comp_params,
 	                           "connect_timeout="))) {
-		curl_timeout = xstrntol(tmp_ptr + 16, NULL, 10, 10);
+		curl_connecttimeout = xstrntol(tmp_ptr + 16, NULL, 10, 10);
 
 		log_flag(ESEARCH, "%s: setting curl connect timeout: %lds",
-			 plugin_type, curl_timeout);
+			 plugin_type, curl_connecttimeout);
 	}
 
+	if (curl_global_init(CURL_GLOBAL_ALL) != 0)
+		error("%s: curl_global_init: %m", plugin_type);
+
 	jobslist = list_create(_jobslist_del);
 	slurm_thread_create(&job_handler_thread, _process_jobs, NULL);
 	slurm_mutex_lock(&pend_jobs_lock);
@@ -968,6 +1005,7 @@ extern int fini(void)
 	_save_state();
 	list_destroy(jobslist);
 	xfree(log_url);
+	curl_global_cleanup();
 	return SLURM_SUCCESS;
 }
 
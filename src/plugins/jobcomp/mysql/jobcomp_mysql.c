@@ -104,6 +104,19 @@ storage_field_t jobcomp_table_fields[] = {
 /* File descriptor used for logging */
 static pthread_mutex_t  jobcomp_lock = PTHREAD_MUTEX_INITIALIZER;
 
+/*
+ * Job records are formatted under the caller's locks and written to the
+ * database by an agent thread, several statements per round trip.
+ */
+#define MAX_BATCH_QUERIES 64
+static List query_list = NULL;
+static pthread_t agent_tid = 0;
+static bool agent_exit = false;
+static pthread_mutex_t agent_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t agent_cond = PTHREAD_COND_INITIALIZER;
+
+extern int slurm_jobcomp_set_location(char *location);
+
 
 static int _mysql_jobcomp_check_tables()
 {
@@ -157,6 +170,65 @@ static char *_get_group_name(uint32_t group_id)
 	return ret_name;
 }
 
+static int _check_connection(void)
+{
+	char *loc;
+	int rc = SLURM_SUCCESS;
+
+	if (jobcomp_mysql_conn && mysql_db_ping(jobcomp_mysql_conn) == 0)
+		return SLURM_SUCCESS;
+
+	loc = slurm_get_jobcomp_loc();
+	if (slurm_jobcomp_set_location(loc) == SLURM_ERROR)
+		rc = SLURM_ERROR;
+	xfree(loc);
+
+	return rc;
+}
+
+static void *_jobcomp_agent(void *args)
+{
+	char *query, *batch;
+	int cnt;
+
+	while (1) {
+		slurm_mutex_lock(&agent_mutex);
+		while (!agent_exit && list_is_empty(query_list))
+			slurm_cond_wait(&agent_cond, &agent_mutex);
+		if (list_is_empty(query_list)) {
+			slurm_mutex_unlock(&agent_mutex);
+			break;
+		}
+		batch = NULL;
+		cnt = 0;
+		while ((cnt < MAX_BATCH_QUERIES) &&
+		       (query = list_pop(query_list))) {
+			xstrcat(batch, query);
+			xfree(query);
+			cnt++;
+		}
+		slurm_mutex_unlock(&agent_mutex);
+
+		debug3("(%s:%d) query\n%s", THIS_FILE, __LINE__, batch);
+		if ((_check_connection() != SLURM_SUCCESS) ||
+		    (mysql_db_query(jobcomp_mysql_conn, batch) !=
+		     SLURM_SUCCESS))
+			error("%s: failed to log %d job records",
+			      plugin_type, cnt);
+		xfree(batch);
+	}
+
+	return NULL;
+}
+
+static void _close_connection(void)
+{
+	if (jobcomp_mysql_conn) {
+		destroy_mysql_conn(jobcomp_mysql_conn);
+		jobcomp_mysql_conn = NULL;
+	}
+}
+
 /*
  * init() is called when the plugin is loaded, before any other functions
  * are called.  Put global initialization here.
@@ -174,15 +246,27 @@ extern int init ( void )
 		debug4("%s loaded", plugin_name);
 	}
 
+	slurm_mutex_lock(&agent_mutex);
+	agent_exit = false;
+	slurm_mutex_unlock(&agent_mutex);
+
 	return SLURM_SUCCESS;
 }
 
 extern int fini ( void )
 {
-	if (jobcomp_mysql_conn) {
-		destroy_mysql_conn(jobcomp_mysql_conn);
-		jobcomp_mysql_conn = NULL;
+	slurm_mutex_lock(&agent_mutex);
+	agent_exit = true;
+	slurm_cond_broadcast(&agent_cond);
+	slurm_mutex_unlock(&agent_mutex);
+	if (agent_tid) {
+		/* The agent writes any queued records before exiting */
+		pthread_join(agent_tid, NULL);
+		agent_tid = 0;
 	}
+	FREE_NULL_LIST(query_list);
+
+	_close_connection();
 	return SLURM_SUCCESS;
 }
 
@@ -216,7 +300,7 @@ extern int slurm_jobcomp_set_location(char *location)
 
 	debug2("mysql_connect() called for db %s", db_name);
 	/* Just make sure our connection is gone. */
-	fini();
+	_close_connection();
 	jobcomp_mysql_conn = create_mysql_conn(0, 0, NULL);
 
 	db_info = create_mysql_db_info(SLURM_MYSQL_PLUGIN_JC);
@@ -246,15 +330,6 @@ extern int slurm_jobcomp_log_record(job_record_t *job_ptr)
 	char *query = NULL, *on_dup = NULL;
 	uint32_t time_limit, start_time, end_time;
 
-	if (!jobcomp_mysql_conn || mysql_db_ping(jobcomp_mysql_conn) != 0) {
-		char *loc = slurm_get_jobcomp_loc();
-		if (slurm_jobcomp_set_location(loc) == SLURM_ERROR) {
-			xfree(loc);
-			return SLURM_ERROR;
-		}
-		xfree(loc);
-	}
-
 	usr_str = _get_user_name(job_ptr->user_id);
 	grp_str = _get_group_name(job_ptr->group_id);
 
@@ -388,13 +463,26 @@ extern int slurm_jobcomp_log_record(job_record_t *job_ptr)
 	}
 	xstrfmtcat(query, ") ON DUPLICATE KEY UPDATE %s;", on_dup);
 
-	debug3("(%s:%d) query\n%s",
-	       THIS_FILE, __LINE__, query);
-	rc = mysql_db_query(jobcomp_mysql_conn, query);
+	/* The database is written by the agent, outside of the job locks */
+	slurm_mutex_lock(&agent_mutex);
+	if (agent_exit) {
+		error("%s: plugin shutting down, JobId=%u not logged",
+		      plugin_type, job_ptr->job_id);
+		xfree(query);
+		rc = SLURM_ERROR;
+	} else {
+		if (!query_list)
+			query_list = list_create(xfree_ptr);
+		list_append(query_list, query);
+		if (!agent_tid)
+			slurm_thread_create(&agent_tid, _jobcomp_agent, NULL);
+		slurm_cond_signal(&agent_cond);
+	}
+	slurm_mutex_unlock(&agent_mutex);
+
 	xfree(usr_str);
 	xfree(grp_str);
 	xfree(jname);
-	xfree(query);
 	xfree(on_dup);
 
 	return rc;
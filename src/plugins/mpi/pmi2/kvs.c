@@ -65,11 +65,12 @@ static uint32_t hash_size = 0;
 static char *temp_kvs_buf = NULL;
 static int temp_kvs_cnt = 0;
 static int temp_kvs_size = 0;
+static Buf temp_kvs_pack = NULL;	/* scratch buffer for temp_kvs_add() */
 
 static int no_dup_keys = 0;
 
 #define TASKS_PER_BUCKET 8
-#define TEMP_KVS_SIZE_INC 2048
+#define TEMP_KVS_SIZE_INIT 2048
 
 #define KEY_INDEX(i) (i * 2)
 #define VAL_INDEX(i) (i * 2 + 1)
@@ -90,6 +91,21 @@ _hash(char *key)
 	return hash;
 }
 
+/*
+ * Make room for size more bytes in temp_kvs_buf. The buffer grows
+ * geometrically since srun and the upper level stepds merge the kvs of
+ * every task below them into it before each fence.
+ */
+static void
+_temp_kvs_reserve(uint32_t size)
+{
+	if (temp_kvs_cnt + size <= temp_kvs_size)
+		return;
+	while (temp_kvs_cnt + size > temp_kvs_size)
+		temp_kvs_size *= 2;
+	xrealloc(temp_kvs_buf, temp_kvs_size);
+}
+
 extern int
 temp_kvs_init(void)
 {
@@ -97,10 +113,12 @@ temp_kvs_init(void)
 	uint32_t nodeid, num_children, size;
 	Buf buf = NULL;
 
-	xfree(temp_kvs_buf);
+	/* keep the buffer from the last fence, the next one is alike */
+	if (!temp_kvs_buf) {
+		temp_kvs_size = TEMP_KVS_SIZE_INIT;
+		temp_kvs_buf = xmalloc(temp_kvs_size);
+	}
 	temp_kvs_cnt = 0;
-	temp_kvs_size = TEMP_KVS_SIZE_INC;
-	temp_kvs_buf = xmalloc(temp_kvs_size);
 
 	/* put the tree cmd here to simplify message sending */
 	if (in_stepd()) {
@@ -124,10 +142,7 @@ temp_kvs_init(void)
 		pack32(kvs_seq, buf);
 	}
 	size = get_buf_offset(buf);
-	if (temp_kvs_cnt + size > temp_kvs_size) {
-		temp_kvs_size += TEMP_KVS_SIZE_INC;
-		xrealloc(temp_kvs_buf, temp_kvs_size);
-	}
+	_temp_kvs_reserve(size);
 	memcpy(&temp_kvs_buf[temp_kvs_cnt], get_buf_data(buf), size);
 	temp_kvs_cnt += size;
 	free_buf(buf);
@@ -141,23 +156,21 @@ temp_kvs_init(void)
 extern int
 temp_kvs_add(char *key, char *val)
 {
-	Buf buf;
 	uint32_t size;
 
 	if ( key == NULL || val == NULL )
 		return SLURM_SUCCESS;
 
-	buf = init_buf(PMI2_MAX_KEYLEN + PMI2_MAX_VALLEN + 2 * sizeof(uint32_t));
-	packstr(key, buf);
-	packstr(val, buf);
-	size = get_buf_offset(buf);
-	if (temp_kvs_cnt + size > temp_kvs_size) {
-		temp_kvs_size += TEMP_KVS_SIZE_INC;
-		xrealloc(temp_kvs_buf, temp_kvs_size);
-	}
-	memcpy(&temp_kvs_buf[temp_kvs_cnt], get_buf_data(buf), size);
+	if (!temp_kvs_pack)
+		temp_kvs_pack = init_buf(PMI2_MAX_KEYLEN + PMI2_MAX_VALLEN +
+					 2 * sizeof(uint32_t));
+	set_buf_offset(temp_kvs_pack, 0);
+	packstr(key, temp_kvs_pack);
+	packstr(val, temp_kvs_pack);
+	size = get_buf_offset(temp_kvs_pack);
+	_temp_kvs_reserve(size);
+	memcpy(&temp_kvs_buf[temp_kvs_cnt], get_buf_data(temp_kvs_pack), size);
 	temp_kvs_cnt += size;
-	free_buf(buf);
 
 	return SLURM_SUCCESS;
 }
@@ -175,10 +188,7 @@ temp_kvs_merge(Buf buf)
 	data = get_buf_data(buf);
 	offset = get_buf_offset(buf);
 
-	if (temp_kvs_cnt + size > temp_kvs_size) {
-		temp_kvs_size += size;
-		xrealloc(temp_kvs_buf, temp_kvs_size);
-	}
+	_temp_kvs_reserve(size);
 	memcpy(&temp_kvs_buf[temp_kvs_cnt], &data[offset], size);
 	temp_kvs_cnt += size;
 
@@ -771,12 +771,19 @@ extern int pmixp_lib_fence(const pmixp_proc_t procs[], size_t nprocs,
 		/*
 		 * Practice shows the Tree algorithm has better performance
 		 * performance for fence with zero data. Only use the Ring
-		 * algorithm if there is data to collect.
+		 * algorithm if there is data to collect, and only on steps
+		 * small enough for its linear number of hops not to dominate.
+		 * The node count is the same on every node of the step, so all
+		 * of them pick the same algorithm.
 		 */
-		if (collect && (ndata > 0)) {
+		if (collect && (ndata > 0) &&
+		    (pmixp_info_nodes() <= PMIXP_COLL_RING_MAX_NODES)) {
 			type = PMIXP_COLL_TYPE_FENCE_RING;
 		}
 	}
+	PMIXP_DEBUG("fence of %lu procs, %lu bytes using %s",
+		    (unsigned long) nprocs, (unsigned long) ndata,
+		    pmixp_coll_type2str(type));
 
 	coll = pmixp_state_coll_get(type, procs, nprocs);
 	if (!coll) {
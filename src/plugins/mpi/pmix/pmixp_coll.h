@@ -43,6 +43,10 @@
 
 #define PMIXP_COLL_DEBUG 1
 #define PMIXP_COLL_RING_CTX_NUM 3
+/* Largest step (in nodes) that the automatic fence selection runs the Ring
+ * algorithm for. A Ring fence takes one hop per node, so beyond this the
+ * logarithmic depth of the Tree algorithm wins even for large payloads. */
+#define PMIXP_COLL_RING_MAX_NODES 64
 
 typedef enum {
 	PMIXP_COLL_TYPE_FENCE_TREE = 0,
@@ -46,6 +46,18 @@
 
 static int  _ft_decay_apply_new_usage(job_record_t *job, time_t *start);
 static void _apply_priority_fs(void);
+static bool _level_fs_moved(List children_list);
+
+/*
+ * The ranks of the last full Fair Tree pass are reused as long as no
+ * association's level_fs moved by more than PriorityParameters=
+ * fair_tree_epsilon (relative) since that pass. The level_fs values left on
+ * the associations are those of the last full pass.
+ */
+static long double ft_epsilon = 0.0;
+static time_t ft_conf_update = 0;	/* slurm_conf.last_update of the
+					 * last full pass */
+static uint32_t ft_user_assoc_count = NO_VAL;
 
 /* Fair Tree code called from the decay thread loop */
 extern void fair_tree_decay(List jobs, time_t start)
@@ -63,12 +75,27 @@ extern void fair_tree_decay(List jobs, time_t start)
 
 	/* calculate fs factor for associations */
 	assoc_mgr_lock(&locks);
-	_apply_priority_fs();
+	if ((ft_conf_update != slurm_conf.last_update) ||
+	    (ft_user_assoc_count != g_user_assoc_count) ||
+	    _level_fs_moved(assoc_mgr_root_assoc->usage->children_list)) {
+		char *tmp_ptr;
+
+		ft_epsilon = 0.0;
+		if ((tmp_ptr = xstrcasestr(slurm_conf.priority_params,
+					   "fair_tree_epsilon=")))
+			ft_epsilon = strtold(tmp_ptr + 18, NULL);
+		ft_conf_update = slurm_conf.last_update;
+		ft_user_assoc_count = g_user_assoc_count;
+		_apply_priority_fs();
+	} else {
+		log_flag(PRIO, "Fair Tree fairshare unchanged within %Lg, keeping previous ranks",
+			 ft_epsilon);
+	}
 	assoc_mgr_unlock(&locks);
 
 	/* assign job priorities */
 	lock_slurmctld(job_write_lock);
-	list_for_each(jobs, (ListForF) decay_apply_weighted_factors, &start);
+	decay_apply_weighted_factors_list(jobs, &start, false);
 	unlock_slurmctld(job_write_lock);
 }
 
@@ -167,8 +194,10 @@ static int _cmp_level_fs(const void *x,
  * The range of values is 0.0 .. INFINITY.
  * If LF > 1.0, the association is under-served.
  * If LF < 1.0, the association is over-served.
+ *
+ * Sets usage_efctv and usage_norm of the association, but not level_fs.
  */
-static void _calc_assoc_fs(slurmdb_assoc_rec_t *assoc)
+static long double _get_level_fs(slurmdb_assoc_rec_t *assoc)
 {
 	long double U; /* long double U != long W */
 	long double S;
@@ -186,10 +215,9 @@ static void _calc_assoc_fs(slurmdb_assoc_rec_t *assoc)
 	 * Accounts marked as USE_PARENT do not use level_fs */
 	if (assoc->shares_raw == SLURMDB_FS_USE_PARENT) {
 		if (assoc->user)
-			assoc->usage->level_fs = INFINITY;
+			return INFINITY;
 		else
-			assoc->usage->level_fs = (long double) NO_VAL;
-		return;
+			return (long double) NO_VAL;
 	}
 
 	/* If S is 0, the assoc is assigned the lowest possible LF value. If
@@ -200,9 +228,46 @@ static void _calc_assoc_fs(slurmdb_assoc_rec_t *assoc)
 	 *
 	 * NOT A BUG: U can be 0. The result is infinity, a valid value. */
 	if (S == 0L)
-		assoc->usage->level_fs = 0L;
+		return 0L;
 	else
-		assoc->usage->level_fs = S / U;
+		return S / U;
+}
+
+static void _calc_assoc_fs(slurmdb_assoc_rec_t *assoc)
+{
+	assoc->usage->level_fs = _get_level_fs(assoc);
+}
+
+/*
+ * Return true if the level_fs of any association in the tree moved by more
+ * than ft_epsilon from the value of the last full pass.
+ * Associations are updated as by _calc_assoc_fs(), except for level_fs,
+ * until the first one which moved.
+ */
+static bool _level_fs_moved(List children_list)
+{
+	slurmdb_assoc_rec_t *assoc;
+	ListIterator itr;
+	bool moved = false;
+
+	if (!children_list)
+		return false;
+
+	itr = list_iterator_create(children_list);
+	while (!moved && (assoc = list_next(itr))) {
+		long double old_fs = assoc->usage->level_fs;
+		long double new_fs = _get_level_fs(assoc);
+
+		if ((old_fs != new_fs) &&
+		    (isinf(old_fs) || isinf(new_fs) ||
+		     (fabsl(new_fs - old_fs) > (ft_epsilon * fabsl(old_fs)))))
+			moved = true;
+		if (!moved && !assoc->user)
+			moved = _level_fs_moved(assoc->usage->children_list);
+	}
+	list_iterator_destroy(itr);
+
+	return moved;
 }
 
 /* Append list of associations to array
@@ -147,6 +147,19 @@ static double  *weight_tres; /* tres weights */
 static uint32_t flags;       /* Priority Flags */
 static time_t g_last_ran = 0; /* when the last poll ran */
 static double decay_factor = 1; /* The decay factor when decaying time. */
+static int calc_threads = 1; /* threads computing job priorities */
+
+#define CALC_THREADS_MAX 64
+#define CALC_THREAD_MIN_JOBS 256 /* don't start threads for fewer jobs */
+
+typedef struct {
+	job_record_t **jobs;
+	uint32_t *prio;
+	int begin;		/* first job of this thread */
+	int end;		/* one past the last job of this thread */
+	time_t start_time;
+	bool apply_usage;	/* call decay_apply_new_usage() first */
+} decay_calc_args_t;
 
 /* variables defined in priority_multifactor.h */
 
@@ -1342,13 +1355,9 @@ static void *_decay_thread(void *no_data)
 		 */
 		site_factor_g_update();
 
-		if (!(flags & PRIORITY_FLAGS_FAIR_TREE)) {
-			list_for_each(
-				job_list,
-				(ListForF) _decay_apply_new_usage_and_weighted_factors,
-				&start_time
-				);
-		}
+		if (!(flags & PRIORITY_FLAGS_FAIR_TREE))
+			decay_apply_weighted_factors_list(job_list,
+							  &start_time, true);
 
 		unlock_slurmctld(job_write_lock);
 
@@ -1373,6 +1382,15 @@ static void *_decay_thread(void *no_data)
 	return NULL;
 }
 
+/* List find function matching priority factors by job ID */
+static int _find_job_factors(void *x, void *key)
+{
+	priority_factors_object_t *obj = x;
+	uint32_t *job_id = key;
+
+	return (obj->job_id == *job_id);
+}
+
 /* If the specified job record satisfies the filter specifications in req_msg
  * and part_ptr_list (partition name filters), then add its priority specs
  * to ret_list */
@@ -1506,7 +1524,7 @@ static void _filter_job(job_record_t *job_ptr,
 
 static void _internal_setup(void)
 {
-	char *tres_weights_str;
+	char *tres_weights_str, *tmp_ptr;
 
 	damp_factor = (long double)slurm_get_fs_dampening_factor();
 	enforce = slurm_get_accounting_storage_enforce();
@@ -1526,6 +1544,17 @@ static void _internal_setup(void)
 	xfree(tres_weights_str);
 	flags = slurm_conf.priority_flags;
 
+	calc_threads = 1;
+	if ((tmp_ptr = xstrcasestr(slurm_conf.priority_params,
+				   "calc_threads="))) {
+		calc_threads = atoi(tmp_ptr + 13);
+		if ((calc_threads < 1) || (calc_threads > CALC_THREADS_MAX)) {
+			error("PriorityParameters: calc_threads=%d invalid, must be between 1 and %d",
+			      calc_threads, CALC_THREADS_MAX);
+			calc_threads = 1;
+		}
+	}
+
 	log_flag(PRIO, "priority: Damp Factor is %u", damp_factor);
 	log_flag(PRIO, "priority: AccountingStorageEnforce is %u", enforce);
 	log_flag(PRIO, "priority: Max Age is %u", max_age);
@@ -1536,6 +1565,7 @@ static void _internal_setup(void)
 	log_flag(PRIO, "priority: Weight Part is %u", weight_part);
 	log_flag(PRIO, "priority: Weight QOS is %u", weight_qos);
 	log_flag(PRIO, "priority: Flags is %u", flags);
+	log_flag(PRIO, "priority: Calc Threads is %d", calc_threads);
 }
 
 
@@ -1711,10 +1741,7 @@ int init ( void )
 
 		/* Initialize job priority factors for valid sprio output */
 		lock_slurmctld(job_write_lock);
-		list_for_each(
-			job_list,
-			(ListForF) _decay_apply_new_usage_and_weighted_factors,
-			&start_time);
+		decay_apply_weighted_factors_list(job_list, &start_time, true);
 		unlock_slurmctld(job_write_lock);
 	} else if (assoc_mgr_root_assoc) {
 		if (!cluster_cpus)
@@ -1887,6 +1914,55 @@ extern double priority_p_calc_fs_factor(long double usage_efctv,
 	return priority_fs;
 }
 
+/*
+ * Add the priority factors of one job to ret_list if the job is eligible and
+ * visible to the requesting user.
+ * check_private IN - PrivateData=jobs applies to the requesting user
+ */
+static void _add_job_factors(job_record_t *job_ptr,
+			     priority_factors_request_msg_t *req_msg,
+			     List part_filter_list, List ret_list, uid_t uid,
+			     bool check_private, time_t start_time)
+{
+	time_t use_time;
+
+	if (!(flags & PRIORITY_FLAGS_CALCULATE_RUNNING) &&
+	    !IS_JOB_PENDING(job_ptr))
+		return;
+
+	/* Job is not active on this cluster. */
+	if (IS_JOB_REVOKED(job_ptr))
+		return;
+
+	/*
+	 * This means the job is not eligible yet
+	 */
+	if (flags & PRIORITY_FLAGS_ACCRUE_ALWAYS)
+		use_time = job_ptr->details->submit_time;
+	else
+		use_time = job_ptr->details->begin_time;
+
+	if (!use_time || (use_time > start_time))
+		return;
+
+	/*
+	 * 0 means the job is held
+	 */
+	if (job_ptr->priority == 0)
+		return;
+
+	if (check_private &&
+	    (job_ptr->user_id != uid) &&
+	    (((slurm_mcs_get_privatedata() == 0) &&
+	      !assoc_mgr_is_user_acct_coord(acct_db_conn, uid,
+					    job_ptr->account)) ||
+	     ((slurm_mcs_get_privatedata() == 1) &&
+	      (mcs_g_check_mcs_label(uid, job_ptr->mcs_label) != 0))))
+		return;
+
+	_filter_job(job_ptr, req_msg, part_filter_list, ret_list);
+}
+
 extern List priority_p_get_priority_factors_list(
 	priority_factors_request_msg_t *req_msg, uid_t uid)
 {
@@ -1896,12 +1972,16 @@ extern List priority_p_get_priority_factors_list(
 	part_record_t *part_ptr;
 	time_t start_time = time(NULL);
 	char *part_str, *tok, *last = NULL;
+	bool check_private;
 	/* Read lock on jobs, nodes, and partitions */
 	slurmctld_lock_t job_read_lock =
 		{ NO_LOCK, READ_LOCK, READ_LOCK, READ_LOCK, NO_LOCK };
 
 	xassert(req_msg);
 
+	check_private = (slurm_conf.private_data & PRIVATE_DATA_JOBS) &&
+			!validate_operator(uid);
+
 	lock_slurmctld(job_read_lock);
 	if (req_msg->partitions) {
 		part_filter_list = list_create(NULL);
@@ -1916,49 +1996,28 @@ extern List priority_p_get_priority_factors_list(
 	}
 
 	if (job_list && list_count(job_list)) {
-		time_t use_time;
-
 		ret_list = list_create(slurm_destroy_priority_factors_object);
-		itr = list_iterator_create(job_list);
-		while ((job_ptr = list_next(itr))) {
-			if (!(flags & PRIORITY_FLAGS_CALCULATE_RUNNING) &&
-			    !IS_JOB_PENDING(job_ptr))
-				continue;
-
-			/* Job is not active on this cluster. */
-			if (IS_JOB_REVOKED(job_ptr))
-				continue;
-
-			/*
-			 * This means the job is not eligible yet
-			 */
-			if (flags & PRIORITY_FLAGS_ACCRUE_ALWAYS)
-				use_time = job_ptr->details->submit_time;
-			else
-				use_time = job_ptr->details->begin_time;
-
-			if (!use_time || (use_time > start_time))
-				continue;
-
-			/*
-			 * 0 means the job is held
-			 */
-			if (job_ptr->priority == 0)
-				continue;
-
-			if ((slurm_conf.private_data & PRIVATE_DATA_JOBS) &&
-			    (job_ptr->user_id != uid) &&
-			    !validate_operator(uid) &&
-			    (((slurm_mcs_get_privatedata() == 0) &&
-			      !assoc_mgr_is_user_acct_coord(acct_db_conn, uid,
-			                                    job_ptr->account))||
-			     ((slurm_mcs_get_privatedata() == 1) &&
-			      (mcs_g_check_mcs_label(uid, job_ptr->mcs_label)
-			       != 0))))
-				continue;
-
-			_filter_job(job_ptr, req_msg, part_filter_list,
-				    ret_list);
+		if (req_msg->job_id_list) {
+			/* Look up the requested jobs instead of a full scan */
+			uint32_t *job_id;
+			itr = list_iterator_create(req_msg->job_id_list);
+			while ((job_id = list_next(itr))) {
+				if (list_find_first(ret_list, _find_job_factors,
+						    job_id) ||
+				    !(job_ptr = find_job_record(*job_id)))
+					continue;
+				_add_job_factors(job_ptr, req_msg,
+						 part_filter_list, ret_list,
+						 uid, check_private,
+						 start_time);
+			}
+		} else {
+			itr = list_iterator_create(job_list);
+			while ((job_ptr = list_next(itr)))
+				_add_job_factors(job_ptr, req_msg,
+						 part_filter_list, ret_list,
+						 uid, check_private,
+						 start_time);
 		}
 		list_iterator_destroy(itr);
 		if (!list_count(ret_list))
@@ -1999,25 +2058,22 @@ extern bool decay_apply_new_usage(job_record_t *job_ptr,
 }
 
 
-extern int decay_apply_weighted_factors(job_record_t *job_ptr,
-					time_t *start_time_ptr)
+/*
+ * Priority 0 is reserved for held jobs. Also skip priority
+ * re_calculation for non-pending jobs.
+ */
+static bool _decay_calc_needed(job_record_t *job_ptr)
 {
-	uint32_t new_prio;
-
-	/* Always return SUCCESS so that list_for_each will
-	 * continue processing list of jobs. */
-
-	/*
-	 * Priority 0 is reserved for held jobs. Also skip priority
-	 * re_calculation for non-pending jobs.
-	 */
 	if ((job_ptr->priority == 0) ||
 	    IS_JOB_POWER_UP_NODE(job_ptr) ||
 	    (!IS_JOB_PENDING(job_ptr) &&
 	     !(flags & PRIORITY_FLAGS_CALCULATE_RUNNING)))
-		return SLURM_SUCCESS;
+		return false;
+	return true;
+}
 
-	new_prio = _get_priority_internal(*start_time_ptr, job_ptr);
+static void _decay_set_prio(job_record_t *job_ptr, uint32_t new_prio)
+{
 	if (((flags & PRIORITY_FLAGS_INCR_ONLY) == 0) ||
 	    (job_ptr->priority < new_prio)) {
 		job_ptr->priority = new_prio;
@@ -2026,10 +2082,136 @@ extern int decay_apply_weighted_factors(job_record_t *job_ptr,
 
 	debug2("priority for job %u is now %u",
 	       job_ptr->job_id, job_ptr->priority);
+}
+
+extern int decay_apply_weighted_factors(job_record_t *job_ptr,
+					time_t *start_time_ptr)
+{
+	uint32_t new_prio;
+
+	/* Always return SUCCESS so that list_for_each will
+	 * continue processing list of jobs. */
+
+	if (!_decay_calc_needed(job_ptr))
+		return SLURM_SUCCESS;
+
+	new_prio = _get_priority_internal(*start_time_ptr, job_ptr);
+	_decay_set_prio(job_ptr, new_prio);
 
 	return SLURM_SUCCESS;
 }
 
+static int _decay_calc_collect(void *x, void *arg)
+{
+	job_record_t *job_ptr = (job_record_t *) x;
+	decay_calc_args_t *all = (decay_calc_args_t *) arg;
+
+	if (all->apply_usage &&
+	    !decay_apply_new_usage(job_ptr, &all->start_time))
+		return SLURM_SUCCESS;
+	if (_decay_calc_needed(job_ptr))
+		all->jobs[all->end++] = job_ptr;
+
+	return SLURM_SUCCESS;
+}
+
+static void *_decay_calc_thread(void *arg)
+{
+	decay_calc_args_t *args = (decay_calc_args_t *) arg;
+
+	for (int i = args->begin; i < args->end; i++)
+		args->prio[i] = _get_priority_internal(args->start_time,
+						       args->jobs[i]);
+	return NULL;
+}
+
+/*
+ * Set the priority of every job in the list, computing the factors of
+ * different jobs from calc_threads threads. With apply_usage, apply the new
+ * usage of each job first as decay_apply_new_usage() does.
+ * The caller must hold the job write lock, which keeps the records stable
+ * while the threads run. Only the threads' own job records are modified by
+ * them. The priorities are then set by this thread.
+ */
+extern void decay_apply_weighted_factors_list(List jobs,
+					      time_t *start_time_ptr,
+					      bool apply_usage)
+{
+	assoc_mgr_lock_t locks = { WRITE_LOCK, NO_LOCK, NO_LOCK, NO_LOCK,
+				   NO_LOCK, NO_LOCK, NO_LOCK };
+	decay_calc_args_t all, *args;
+	pthread_t *threads;
+	int i, job_cnt, thread_cnt, per_thread;
+
+	job_cnt = list_count(jobs);
+	if ((calc_threads <= 1) || (job_cnt < CALC_THREAD_MIN_JOBS)) {
+		if (apply_usage)
+			list_for_each(
+				jobs,
+				(ListForF) _decay_apply_new_usage_and_weighted_factors,
+				start_time_ptr);
+		else
+			list_for_each(jobs,
+				      (ListForF) decay_apply_weighted_factors,
+				      start_time_ptr);
+		return;
+	}
+
+	memset(&all, 0, sizeof(all));
+	all.start_time = *start_time_ptr;
+	all.apply_usage = apply_usage;
+	all.jobs = xcalloc(job_cnt, sizeof(job_record_t *));
+	list_for_each(jobs, _decay_calc_collect, &all);
+	job_cnt = all.end;
+	all.prio = xcalloc(job_cnt, sizeof(uint32_t));
+
+	/*
+	 * _get_fairshare_priority() sets usage_efctv of an association on
+	 * first use with only a read lock, do that here instead
+	 */
+	assoc_mgr_lock(&locks);
+	for (i = 0; i < job_cnt; i++) {
+		slurmdb_assoc_rec_t *fs_assoc = all.jobs[i]->assoc_ptr;
+
+		if (!fs_assoc || !calc_fairshare)
+			continue;
+		if (fs_assoc->shares_raw == SLURMDB_FS_USE_PARENT)
+			fs_assoc = fs_assoc->usage->fs_assoc_ptr;
+		if (fuzzy_equal(fs_assoc->usage->usage_efctv, NO_VAL))
+			priority_p_set_assoc_usage(fs_assoc);
+	}
+	assoc_mgr_unlock(&locks);
+
+	thread_cnt = MIN(calc_threads,
+			 (job_cnt + CALC_THREAD_MIN_JOBS - 1) /
+			 CALC_THREAD_MIN_JOBS);
+	thread_cnt = MAX(thread_cnt, 1);
+	per_thread = (job_cnt + thread_cnt - 1) / thread_cnt;
+	threads = xcalloc(thread_cnt, sizeof(pthread_t));
+	args = xcalloc(thread_cnt, sizeof(decay_calc_args_t));
+	for (i = 0; i < thread_cnt; i++) {
+		args[i].jobs = all.jobs;
+		args[i].prio = all.prio;
+		args[i].begin = MIN(i * per_thread, job_cnt);
+		args[i].end = MIN((i + 1) * per_thread, job_cnt);
+		args[i].start_time = *start_time_ptr;
+		slurm_thread_create(&threads[i], _decay_calc_thread, &args[i]);
+	}
+	for (i = 0; i < thread_cnt; i++)
+		pthread_join(threads[i], NULL);
+
+	for (i = 0; i < job_cnt; i++)
+		_decay_set_prio(all.jobs[i], all.prio[i]);
+
+	log_flag(PRIO, "priority: calculated %d job priorities with %d threads",
+		 job_cnt, thread_cnt);
+
+	xfree(threads);
+	xfree(args);
+	xfree(all.jobs);
+	xfree(all.prio);
+}
+
 
 extern void set_priority_factors(time_t start_time, job_record_t *job_ptr)
 {
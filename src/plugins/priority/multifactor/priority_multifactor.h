@@ -56,6 +56,9 @@ extern bool decay_apply_new_usage(job_record_t *job_ptr,
 				  time_t *start_time_ptr);
 extern int decay_apply_weighted_factors(job_record_t *job_ptr,
 					time_t *start_time_ptr);
+extern void decay_apply_weighted_factors_list(List jobs,
+					      time_t *start_time_ptr,
+					      bool apply_usage);
 extern void set_assoc_usage_norm(slurmdb_assoc_rec_t *assoc);
 extern void set_priority_factors(time_t start_time, job_record_t *job_ptr);
 
@@ -43,6 +43,7 @@
 #include <stdlib.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <time.h>
 
 #include "slurm/slurm.h"
 #include "slurm/slurm_errno.h"
@@ -54,6 +55,11 @@
 #include "src/slurmd/slurmd/slurmd.h"
 #include "src/slurmd/slurmstepd/slurmstepd_job.h"
 
+/* proctrack_p_wait() delays between kill attempts, in msec */
+#define WAIT_DELAY_MIN 10
+#define WAIT_DELAY_MAX (64 * 1000)
+#define WAIT_TIME_MAX (255 * 1000)
+
 /*
  * These variables are required by the generic plugin interface.  If they
  * are not found in the plugin, the plugin loader will ignore it.
@@ -544,12 +550,22 @@ extern int proctrack_p_signal (uint64_t id, int signal)
 		if (pids[i] == (pid_t)id)
 			continue;
 
+		/*
+		 * SIGKILL goes to every process, skip reading the parent
+		 * of each of them from /proc
+		 */
+		if (signal == SIGKILL) {
+			debug2("killing process %d with signal %d",
+			       pids[i], signal);
+			kill(pids[i], signal);
+			continue;
+		}
+
 		/* only signal slurm tasks unless signal is SIGKILL */
 		slurm_task = _slurm_cgroup_is_pid_a_slurm_task(id, pids[i]);
-		if (slurm_task == 1 || signal == SIGKILL) {
-			debug2("killing process %d (%s) with signal %d", pids[i],
-			       (slurm_task==1)?"slurm_task":"inherited_task",
-			       signal);
+		if (slurm_task == 1) {
+			debug2("killing process %d (slurm_task) with signal %d",
+			       pids[i], signal);
 			kill(pids[i], signal);
 		}
 	}
@@ -583,7 +599,7 @@ extern bool proctrack_p_has_pid(uint64_t cont_id, pid_t pid)
 
 extern int proctrack_p_wait(uint64_t cont_id)
 {
-	int delay = 1;
+	int delay = WAIT_DELAY_MIN, waited = 0;	/* msec */
 
 	if (cont_id == 0 || cont_id == 1) {
 		errno = EINVAL;
@@ -592,16 +608,23 @@ extern int proctrack_p_wait(uint64_t cont_id)
 
 	/* Spin until the container is successfully destroyed */
 	/* This indicates that all tasks have exited the container */
+	/*
+	 * Killed tasks usually exit within a few milliseconds, so start with
+	 * short delays and back off to WAIT_DELAY_MAX for stuck processes
+	 */
 	while (proctrack_p_destroy(cont_id) != SLURM_SUCCESS) {
+		struct timespec ts = { .tv_sec = delay / 1000,
+				       .tv_nsec = (delay % 1000) * 1000000 };
+
 		proctrack_p_signal(cont_id, SIGKILL);
-		sleep(delay);
-		if (delay < 120) {
-			delay *= 2;
-		} else {
+		nanosleep(&ts, NULL);
+		waited += delay;
+		if (waited >= WAIT_TIME_MAX) {
 			error("%s: Unable to destroy container %"PRIu64" in cgroup plugin, giving up after %d sec",
-			      __func__, cont_id, delay);
+			      __func__, cont_id, waited / 1000);
 			break;
 		}
+		delay = MIN(delay * 2, WAIT_DELAY_MAX);
 	}
 
 	return SLURM_SUCCESS;
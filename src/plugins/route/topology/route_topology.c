@@ -45,6 +45,7 @@
 #include "src/common/forward.h"
 #include "src/common/node_conf.h"
 #include "src/common/slurm_protocol_defs.h"
+#include "src/common/slurm_route.h"
 #include "src/common/slurm_topology.h"
 #include "src/slurmctld/locks.h"
 
@@ -94,6 +95,41 @@ const uint32_t plugin_version   = SLURM_VERSION_NUMBER;
 /* Global data */
 static pthread_mutex_t route_lock = PTHREAD_MUTEX_INITIALIZER;
 static bool run_in_slurmctld = false;
+static bool rotate_relays = false;
+static uint32_t relay_seq = 0;	/* rotates relay nodes, under route_lock */
+
+static void _read_params(void)
+{
+	rotate_relays = (xstrcasestr(slurm_conf.topology_param, "RouteRotate") !=
+			 NULL);
+}
+
+/*
+ * Build the hostlist for one child switch. The first host becomes the relay
+ * for the others, so with RouteRotate pick a different one every message.
+ */
+static hostlist_t _switch_hostlist(bitstr_t *fwd_bitmap, int sw_count,
+				   uint32_t seq)
+{
+	hostlist_t hl, rest_hl;
+	bitoff_t relay;
+
+	if (!rotate_relays || (sw_count < 2))
+		return bitmap2hostlist(fwd_bitmap);
+
+	relay = bit_get_bit_num(fwd_bitmap, seq % sw_count);
+	if (relay < 0)
+		return bitmap2hostlist(fwd_bitmap);
+
+	hl = hostlist_create(node_record_table_ptr[relay].name);
+	bit_clear(fwd_bitmap, relay);
+	rest_hl = bitmap2hostlist(fwd_bitmap);
+	hostlist_push_list(hl, rest_hl);
+	hostlist_destroy(rest_hl);
+	bit_set(fwd_bitmap, relay);
+
+	return hl;
+}
 
 /*****************************************************************************\
  *  Functions required of all plugins
@@ -110,6 +146,7 @@ extern int init(void)
 		fatal("ROUTE: route/topology requires topology/tree");
 	}
 	xfree(topotype);
+	_read_params();
 	run_in_slurmctld = running_in_slurmctld();
 	verbose("%s loaded", plugin_name);
 	return SLURM_SUCCESS;
@@ -144,7 +181,9 @@ extern int route_p_split_hostlist(hostlist_t hl,
 				  hostlist_t** sp_hl,
 				  int* count, uint16_t tree_width)
 {
-	int i, j, k, hl_ndx, msg_count, sw_count, lst_count;
+	int i, j, k, hl_ndx, msg_count, sw_count, lst_count, child_cnt;
+	int group_size, in_group;
+	uint32_t seq = 0;
 	char  *buf;
 	bitstr_t *nodes_bitmap = NULL;		/* nodes in message list */
 	bitstr_t *fwd_bitmap = NULL;		/* nodes in forward list */
@@ -169,6 +208,9 @@ extern int route_p_split_hostlist(hostlist_t hl,
 			fatal("ROUTE: Failed to build topology config");
 		}
 	}
+	/* Every node must agree on the collector tree, so do not rotate it */
+	if (rotate_relays && !route_setting_collectors())
+		seq = relay_seq++;
 	slurm_mutex_unlock(&route_lock);
 	*sp_hl = (hostlist_t*) xmalloc(switch_record_cnt * sizeof(hostlist_t));
 	/* Only acquire the slurmctld lock if running as the slurmctld. */
@@ -225,29 +267,58 @@ extern int route_p_split_hostlist(hostlist_t hl,
 		return route_split_hostlist_treewidth(
 			hl, sp_hl, count, tree_width);
 	}
+	/*
+	 * Honor TreeWidth when the switch has more child switches with nodes
+	 * in the message list than that. Neighboring child switches are then
+	 * grouped, and the relay of each group splits it again by switch.
+	 */
+	child_cnt = 0;
+	for (i = 0; i < switch_record_table[j].num_switches; i++) {
+		k = switch_record_table[j].switch_index[i];
+		if (bit_overlap_any(switch_record_table[k].node_bitmap,
+				    nodes_bitmap))
+			child_cnt++;
+	}
+	group_size = 1;
+	if (tree_width && (child_cnt > tree_width))
+		group_size = (child_cnt + tree_width - 1) / tree_width;
+
 	/* loop through children, construction a hostlist for each child switch
 	 * with nodes in the message list */
 	hl_ndx = 0;
 	lst_count = 0;
+	in_group = 0;
 	for (i=0; i < switch_record_table[j].num_switches; i++) {
 		k = switch_record_table[j].switch_index[i];
 		fwd_bitmap = bit_copy(switch_record_table[k].node_bitmap);
 		bit_and(fwd_bitmap, nodes_bitmap);
 		sw_count = bit_set_count(fwd_bitmap);
 		if (sw_count == 0) {
+			FREE_NULL_BITMAP(fwd_bitmap);
 			continue; /* no nodes on this switch in message list */
 		}
-		(*sp_hl)[hl_ndx] = bitmap2hostlist(fwd_bitmap);
+		if (in_group) {
+			hostlist_t sw_hl = bitmap2hostlist(fwd_bitmap);
+			hostlist_push_list((*sp_hl)[hl_ndx - 1], sw_hl);
+			hostlist_destroy(sw_hl);
+		} else {
+			(*sp_hl)[hl_ndx] = _switch_hostlist(fwd_bitmap,
+							    sw_count,
+							    seq + hl_ndx);
+			hl_ndx++;
+		}
+		if (++in_group >= group_size)
+			in_group = 0;
 		/* Now remove nodes from this switch from message list */
 		bit_and_not(nodes_bitmap, fwd_bitmap);
 		FREE_NULL_BITMAP(fwd_bitmap);
 		if (slurm_conf.debug_flags & DEBUG_FLAG_ROUTE) {
-			buf = hostlist_ranged_string_xmalloc((*sp_hl)[hl_ndx]);
+			buf = hostlist_ranged_string_xmalloc(
+				(*sp_hl)[hl_ndx - 1]);
 			debug("ROUTE: ... sublist[%d] switch=%s :: %s",
-			      i, switch_record_table[i].name, buf);
+			      hl_ndx - 1, switch_record_table[k].name, buf);
 			xfree(buf);
 		}
-		hl_ndx++;
 		lst_count += sw_count;
 		if (lst_count == msg_count)
 			break; /* all nodes in message are in a child list */
@@ -266,6 +337,9 @@ extern int route_p_split_hostlist(hostlist_t hl,
  */
 extern int route_p_reconfigure (void)
 {
+	slurm_mutex_lock(&route_lock);
+	_read_params();
+	slurm_mutex_unlock(&route_lock);
 	return SLURM_SUCCESS;
 }
 
@@ -129,12 +129,68 @@ typedef struct node_space_map {
 	time_t end_time;
 	bitstr_t *avail_bitmap;
 	int next;	/* next record, by time, zero termination */
+	int free;	/* record 0 only: first unused record below
+			 * node_space_recs, chained by next, zero if none */
 } node_space_map_t;
 
-typedef struct node_space_handler {
+/*
+ * With bf_running_job_reserve, the nodes of running jobs are reserved until
+ * the jobs end. The running jobs seen by the previous cycle are cached, along
+ * with the resulting timeline of when nodes are released, so that only
+ * started, ended, resized or extended jobs cause the timeline to be rebuilt.
+ */
+typedef struct {
+	time_t end_time;
+	uint32_t job_id;
+	bitstr_t *node_bitmap;
+	uint32_t seen;		/* bf_run_cycle when last found running */
+} bf_run_job_t;
+
+typedef struct {
+	time_t end_time;	/* rounded to bf_resolution */
+	bitstr_t *node_bitmap;	/* nodes released at end_time */
+} bf_run_step_t;
+
+/*
+ * With bf_part_groups, partitions which share nodes are grouped (transitively)
+ * and each group is planned with its own resource/time map. Jobs in one group
+ * can never use nodes in another, so they never need to see each other's
+ * reservations.
+ */
+typedef struct {
+	bool full;		/* node_space table size limit reached */
+	bitstr_t *node_bitmap;	/* nodes in the group's partitions */
 	node_space_map_t *node_space;
-	int *node_space_recs;
-} node_space_handler_t;
+	int node_space_recs;
+} bf_group_t;
+
+/*
+ * With bf_shape_cache, the shape (partition, owner, resources requested, time
+ * limit, etc.) of each job which can not be started or given a reservation
+ * within bf_window is remembered for the rest of the cycle. Later jobs of an
+ * identical shape are skipped without calling the select plugin, unless a
+ * job was started or locks were yielded with a state change since then.
+ * Reservations added to node_space only take resources away, so they can not
+ * make a rejected shape fit.
+ */
+typedef struct {
+	char *key;
+	uint32_t seq;		/* bf_shape_seq when the shape was rejected */
+} bf_shape_t;
+
+/*
+ * With DebugFlags=Backfill, the time spent testing jobs in the select plugin
+ * is summed by a coarse job shape (partition, features, GRES, node count
+ * bucket) and the most expensive shapes are logged at the end of the cycle.
+ */
+#define BF_PROFILE_TOP 10
+
+typedef struct {
+	char *key;
+	uint32_t count;		/* jobs tested */
+	uint64_t max_usec;	/* longest single test */
+	uint64_t total_usec;	/* time spent testing */
+} bf_profile_t;
 
 /*
  * HetJob scheduling structures
@@ -146,6 +202,10 @@ typedef struct het_job_rec {
 	job_record_t *job_ptr;
 	time_t latest_start;		/* Time when expected to start */
 	part_record_t *part_ptr;
+	bitstr_t *resv_bitmap;		/* Nodes NOT reserved this cycle */
+	node_space_map_t *resv_space;	/* node_space holding reservation */
+	time_t resv_start;		/* Start of latest reservation */
+	time_t resv_len;		/* Length of reservation */
 } het_job_rec_t;
 
 typedef struct het_job_map {
@@ -194,6 +254,20 @@ static List deadlock_global_list;
 static bool bf_hetjob_immediate = false;
 static uint16_t bf_hetjob_prio = 0;
 static bool bf_one_resv_per_job = false;
+static bool bf_part_groups = false;
+static bf_group_t *bf_groups = NULL;	/* Only set during backfill cycle */
+static int bf_group_cnt = 0;
+static xhash_t *bf_run_cache = NULL;	/* bf_run_job_t by job_id */
+static time_t bf_run_conf_update = 0;	/* slurm_conf.last_update of cache */
+static uint32_t bf_run_cycle = 0;
+static int bf_run_resolution = 0;	/* backfill_resolution of bf_run_steps */
+static bf_run_step_t *bf_run_steps = NULL; /* sorted by end_time */
+static int bf_run_step_cnt = 0;
+static bool bf_shape_cache = false;
+static xhash_t *bf_shapes = NULL;	/* Only set during backfill cycle */
+static xhash_t *bf_profile = NULL;	/* Only set during backfill cycle */
+static uint32_t bf_shape_seq = 0;
+static uint32_t bf_shape_hits = 0, bf_shape_tests = 0;	/* This cycle */
 static uint32_t job_start_cnt = 0;
 static int max_backfill_job_cnt = 100;
 static int max_backfill_job_per_assoc = 0;
@@ -236,6 +310,12 @@ static int  _num_feature_count(job_record_t *job_ptr, bool *has_xand,
 			       bool *has_xor);
 static int  _het_job_find_map(void *x, void *key);
 static void _het_job_map_del(void *x);
+static void _het_job_rec_del(void *x);
+static int  _het_job_resv_clear(void *x, void *arg);
+static void _het_job_resv_align(job_record_t *job_ptr, time_t start_time,
+				time_t end_reserve, bitstr_t *res_bitmap,
+				node_space_map_t *node_space,
+				int *node_space_recs);
 static void _het_job_start_clear(void);
 static time_t _het_job_start_find(job_record_t *job_ptr);
 static void _het_job_start_set(job_record_t *job_ptr, time_t latest_start,
@@ -258,6 +338,7 @@ static int  _try_sched(job_record_t *job_ptr, bitstr_t **avail_bitmap,
 static int  _yield_locks(int64_t usec);
 static void _bf_map_key_id(void *item, const char **key, uint32_t *key_len);
 static void _bf_map_free(void *item);
+static void _bf_run_steps_free(void);
 
 /* Log resources to be allocated to a pending job */
 static void _dump_job_sched(job_record_t *job_ptr, time_t end_time,
@@ -687,6 +768,8 @@ static void _load_config(void)
 	} else {
 		backfill_interval = BACKFILL_INTERVAL;
 	}
+	/* For job_start_data(), which answers from the latest plan */
+	slurmctld_diag_stats.bf_interval = backfill_interval;
 
 	if ((tmp_ptr = xstrcasestr(sched_params, "bf_max_time="))) {
 		bf_max_time = atoi(tmp_ptr + 12);
@@ -935,11 +1018,21 @@ static void _load_config(void)
 	else
 		bf_one_resv_per_job = false;
 
+	if (xstrcasestr(sched_params, "bf_part_groups"))
+		bf_part_groups = true;
+	else
+		bf_part_groups = false;
+
 	if (xstrcasestr(sched_params, "bf_running_job_reserve"))
 		bf_running_job_reserve = true;
 	else
 		bf_running_job_reserve = false;
 
+	if (xstrcasestr(sched_params, "bf_shape_cache"))
+		bf_shape_cache = true;
+	else
+		bf_shape_cache = false;
+
 	if ((tmp_ptr = xstrcasestr(sched_params, "max_rpc_cnt=")))
 		max_rpc_cnt = atoi(tmp_ptr + 12);
 	else if ((tmp_ptr = xstrcasestr(sched_params, "max_rpc_count=")))
@@ -1066,6 +1159,8 @@ extern void *backfill_agent(void *args)
 	}
 	FREE_NULL_LIST(het_job_list);
 	xhash_free(user_usage_map); /* May have been init'ed if used */
+	xhash_free(bf_run_cache);
+	_bf_run_steps_free();
 
 	return NULL;
 }
@@ -1126,8 +1221,9 @@ static int _yield_locks(int64_t usec)
 	    (last_part_update == part_update) &&
 	    (! stop_backfill) && (! load_config))
 		return 0;
-	else
-		return 1;
+
+	bf_shape_seq++;		/* Rejected job shapes may now fit */
+	return 1;
 }
 
 /* Test if this job still has access to the specified partition. The job's
@@ -1336,36 +1432,373 @@ static int _foreach_het_job_details(void *x, void *arg)
 	return SLURM_SUCCESS;
 }
 
-static int _bf_reserve_running(void *x, void *arg)
+/*
+ * Build bf_groups from the partitions' nodes. The first group takes ownership
+ * of node_space, the others start with a copy of its first record.
+ */
+static void _bf_groups_build(node_space_map_t *node_space)
 {
-	job_record_t *job_ptr = (job_record_t *) x;
-	node_space_handler_t *ns_h = (node_space_handler_t *) arg;
-	node_space_map_t *node_space = ns_h->node_space;
-	int *ns_recs_ptr = ns_h->node_space_recs;
-	time_t start_time = job_ptr->start_time;
-	time_t end_time = job_ptr->end_time;
+	part_record_t *part_ptr;
+	ListIterator part_iterator;
+	int i, j, match;
 
-	if (!job_ptr || ! IS_JOB_RUNNING(job_ptr))
-		return SLURM_SUCCESS;
+	xassert(!bf_groups);
+
+	part_iterator = list_iterator_create(part_list);
+	while ((part_ptr = list_next(part_iterator))) {
+		if (!part_ptr->node_bitmap)
+			continue;
+		match = -1;
+		for (i = 0; i < bf_group_cnt; i++) {
+			if (!bit_overlap_any(bf_groups[i].node_bitmap,
+					     part_ptr->node_bitmap))
+				continue;
+			if (match == -1) {
+				match = i;
+				bit_or(bf_groups[i].node_bitmap,
+				       part_ptr->node_bitmap);
+				continue;
+			}
+			/* Partition links two groups, merge them */
+			bit_or(bf_groups[match].node_bitmap,
+			       bf_groups[i].node_bitmap);
+			FREE_NULL_BITMAP(bf_groups[i].node_bitmap);
+			bf_groups[i] = bf_groups[--bf_group_cnt];
+			i--;
+		}
+		if (match == -1) {
+			xrecalloc(bf_groups, bf_group_cnt + 1,
+				  sizeof(bf_group_t));
+			bf_groups[bf_group_cnt++].node_bitmap =
+				bit_copy(part_ptr->node_bitmap);
+		}
+	}
+	list_iterator_destroy(part_iterator);
+
+	if (!bf_group_cnt) {
+		xrecalloc(bf_groups, 1, sizeof(bf_group_t));
+		bf_groups[0].node_bitmap = bit_alloc(node_record_count);
+		bf_group_cnt = 1;
+	}
+
+	for (i = 0; i < bf_group_cnt; i++) {
+		if (i == 0) {
+			bf_groups[i].node_space = node_space;
+		} else {
+			bf_groups[i].node_space =
+				xcalloc((max_backfill_job_cnt * 2 + 1),
+					sizeof(node_space_map_t));
+			bf_groups[i].node_space[0] = node_space[0];
+			bf_groups[i].node_space[0].avail_bitmap =
+				bit_copy(node_space[0].avail_bitmap);
+		}
+		bf_groups[i].node_space_recs = 1;
+	}
+
+	if (slurm_conf.debug_flags & DEBUG_FLAG_BACKFILL) {
+		for (j = 0; j < bf_group_cnt; j++) {
+			char *node_list = bitmap2node_name(
+				bf_groups[j].node_bitmap);
+			info("backfill: partition group %d nodes %s",
+			     j, node_list);
+			xfree(node_list);
+		}
+	}
+}
+
+/* Return the group containing the given nodes (or the first group) */
+static bf_group_t *_bf_group_find(bitstr_t *node_bitmap)
+{
+	int i;
+
+	xassert(bf_groups);
+
+	for (i = 0; node_bitmap && (i < bf_group_cnt); i++) {
+		if (bit_overlap_any(bf_groups[i].node_bitmap, node_bitmap))
+			return &bf_groups[i];
+	}
+
+	return &bf_groups[0];
+}
+
+/*
+ * Return the map to use for a job, which is node_space unless partition
+ * groups are in use
+ */
+static node_space_map_t *_bf_node_space(job_record_t *job_ptr,
+					node_space_map_t *node_space)
+{
+	if (!bf_groups)
+		return node_space;
+	if (job_ptr->part_ptr)
+		return _bf_group_find(job_ptr->part_ptr->node_bitmap)->
+			node_space;
+	return _bf_group_find(job_ptr->node_bitmap)->node_space;
+}
+
+/* Free bf_groups and their maps, RET total records in the maps */
+static int _bf_groups_free(void)
+{
+	int i, j, recs = 0;
+
+	for (i = 0; i < bf_group_cnt; i++) {
+		node_space_map_t *node_space = bf_groups[i].node_space;
+
+		recs += bf_groups[i].node_space_recs;
+		for (j = 0; ; ) {
+			FREE_NULL_BITMAP(node_space[j].avail_bitmap);
+			if ((j = node_space[j].next) == 0)
+				break;
+		}
+		xfree(node_space);
+		FREE_NULL_BITMAP(bf_groups[i].node_bitmap);
+	}
+	xfree(bf_groups);
+	bf_group_cnt = 0;
+
+	return recs;
+}
+
+/* Release a cached running job */
+static void _bf_run_job_free(void *x)
+{
+	bf_run_job_t *run_job = (bf_run_job_t *) x;
+
+	if (!run_job)
+		return;
+	FREE_NULL_BITMAP(run_job->node_bitmap);
+	xfree(run_job);
+}
+
+static void _bf_run_job_key_id(void *item, const char **key,
+			       uint32_t *key_len)
+{
+	bf_run_job_t *run_job = (bf_run_job_t *) item;
+
+	*key = (const char *) &run_job->job_id;
+	*key_len = sizeof(uint32_t);
+}
+
+/* Jobs whose nodes bf_running_job_reserve holds until they end */
+static bool _bf_run_job_eligible(job_record_t *job_ptr)
+{
+	if (!IS_JOB_RUNNING(job_ptr) || !job_ptr->node_bitmap)
+		return false;
 	if (!job_ptr->job_resrcs || !(job_ptr->job_resrcs->whole_node ==
 				      WHOLE_NODE_REQUIRED))
-		return SLURM_SUCCESS;
+		return false;
 	if (slurm_job_preempt_mode(job_ptr) != PREEMPT_MODE_OFF)
+		return false;
+	return true;
+}
+
+/* Add or refresh the cache record of one running job */
+static int _bf_run_job_sync(void *x, void *arg)
+{
+	job_record_t *job_ptr = (job_record_t *) x;
+	bool *changed = (bool *) arg;
+	bf_run_job_t *run_job;
+
+	if (!_bf_run_job_eligible(job_ptr))
 		return SLURM_SUCCESS;
 
-	bitstr_t *tmp_bitmap = bit_copy(job_ptr->node_bitmap);
+	run_job = xhash_get(bf_run_cache, (char *) &job_ptr->job_id,
+			    sizeof(uint32_t));
+	if (!run_job) {
+		run_job = xmalloc(sizeof(bf_run_job_t));
+		run_job->job_id = job_ptr->job_id;
+		run_job->end_time = job_ptr->end_time;
+		run_job->node_bitmap = bit_copy(job_ptr->node_bitmap);
+		xhash_add(bf_run_cache, run_job);
+		*changed = true;
+	} else if ((run_job->end_time != job_ptr->end_time) ||
+		   !bit_equal(run_job->node_bitmap, job_ptr->node_bitmap)) {
+		/* Time limit changed or job resized */
+		run_job->end_time = job_ptr->end_time;
+		FREE_NULL_BITMAP(run_job->node_bitmap);
+		run_job->node_bitmap = bit_copy(job_ptr->node_bitmap);
+		*changed = true;
+	}
+	run_job->seen = bf_run_cycle;
 
-	bit_not(tmp_bitmap);
-	end_time = (end_time / backfill_resolution) * backfill_resolution;
+	return SLURM_SUCCESS;
+}
 
-	_add_reservation(start_time, end_time, tmp_bitmap, node_space,
-			 ns_recs_ptr);
+static void _bf_run_job_stale(void *item, void *arg)
+{
+	bf_run_job_t *run_job = (bf_run_job_t *) item;
+	List stale_list = (List) arg;
 
-	FREE_NULL_BITMAP(tmp_bitmap);
+	if (run_job->seen != bf_run_cycle)
+		list_append(stale_list, &run_job->job_id);
+}
 
+static int _bf_run_job_delete(void *x, void *arg)
+{
+	xhash_delete(bf_run_cache, (char *) x, sizeof(uint32_t));
 	return SLURM_SUCCESS;
 }
 
+static void _bf_run_job_collect(void *item, void *arg)
+{
+	bf_run_job_t ***next = (bf_run_job_t ***) arg;
+
+	*((*next)++) = (bf_run_job_t *) item;
+}
+
+static int _bf_run_job_sort(const void *x, const void *y)
+{
+	const bf_run_job_t *job1 = *(bf_run_job_t **) x;
+	const bf_run_job_t *job2 = *(bf_run_job_t **) y;
+
+	if (job1->end_time < job2->end_time)
+		return -1;
+	if (job1->end_time > job2->end_time)
+		return 1;
+	return 0;
+}
+
+static void _bf_run_steps_free(void)
+{
+	for (int i = 0; i < bf_run_step_cnt; i++)
+		FREE_NULL_BITMAP(bf_run_steps[i].node_bitmap);
+	xfree(bf_run_steps);
+	bf_run_step_cnt = 0;
+}
+
+/*
+ * Bring the cache of running jobs up to date with job_list and rebuild the
+ * release timeline if any job started, ended, was resized or had its end
+ * time changed since the previous backfill cycle. The timeline is kept
+ * between cycles, so a cycle without changes does no bitmap work here.
+ */
+static void _bf_run_cache_sync(void)
+{
+	bf_run_job_t **run_jobs, **next;
+	bool changed = false;
+	List stale_list;
+	uint32_t cnt;
+	time_t end_time;
+	int i;
+
+	if (bf_run_cache && (bf_run_conf_update != slurm_conf.last_update)) {
+		/* Node table may have changed, bitmaps are no longer valid */
+		xhash_free(bf_run_cache);
+		_bf_run_steps_free();
+	}
+	if (!bf_run_cache) {
+		bf_run_cache = xhash_init(_bf_run_job_key_id, _bf_run_job_free);
+		bf_run_conf_update = slurm_conf.last_update;
+		changed = true;
+	}
+
+	bf_run_cycle++;
+	list_for_each(job_list, _bf_run_job_sync, &changed);
+
+	stale_list = list_create(NULL);
+	xhash_walk(bf_run_cache, _bf_run_job_stale, stale_list);
+	if (list_count(stale_list)) {
+		/* Jobs ended, the pointers are only valid until deleted */
+		list_for_each(stale_list, _bf_run_job_delete, NULL);
+		changed = true;
+	}
+	FREE_NULL_LIST(stale_list);
+
+	if (!changed && (bf_run_resolution == backfill_resolution))
+		return;
+
+	_bf_run_steps_free();
+	bf_run_resolution = backfill_resolution;
+	if (!(cnt = xhash_count(bf_run_cache)))
+		return;
+
+	run_jobs = xcalloc(cnt, sizeof(bf_run_job_t *));
+	next = run_jobs;
+	xhash_walk(bf_run_cache, _bf_run_job_collect, &next);
+	qsort(run_jobs, cnt, sizeof(bf_run_job_t *), _bf_run_job_sort);
+
+	bf_run_steps = xcalloc(cnt, sizeof(bf_run_step_t));
+	for (i = 0; i < cnt; i++) {
+		end_time = (run_jobs[i]->end_time / backfill_resolution) *
+			   backfill_resolution;
+		if (!bf_run_step_cnt ||
+		    (bf_run_steps[bf_run_step_cnt - 1].end_time != end_time)) {
+			bf_run_steps[bf_run_step_cnt].end_time = end_time;
+			bf_run_steps[bf_run_step_cnt].node_bitmap =
+				bit_copy(run_jobs[i]->node_bitmap);
+			bf_run_step_cnt++;
+		} else {
+			bit_or(bf_run_steps[bf_run_step_cnt - 1].node_bitmap,
+			       run_jobs[i]->node_bitmap);
+		}
+	}
+	xfree(run_jobs);
+
+	log_flag(BACKFILL, "backfill: running job timeline rebuilt for %u jobs with %d end times",
+		 cnt, bf_run_step_cnt);
+}
+
+/*
+ * Reserve the nodes of running jobs in node_space until the jobs end, using
+ * the timeline built by _bf_run_cache_sync(). node_space must only contain
+ * its first record.
+ * IN mask - only reserve these nodes, NULL for all
+ */
+static void _bf_run_reserve(node_space_map_t *node_space, int *node_space_recs,
+			    bitstr_t *mask)
+{
+	bitstr_t *base_bitmap, *freed_bitmap;
+	int i, j = 0;
+
+	xassert(*node_space_recs == 1);
+
+	if (!bf_run_step_cnt)
+		return;
+
+	base_bitmap = bit_copy(node_space[0].avail_bitmap);
+	freed_bitmap = bit_alloc(bit_size(base_bitmap));
+	for (i = 0; i < bf_run_step_cnt; i++) {
+		if (bf_run_steps[i].end_time > node_space[0].begin_time)
+			bit_or(freed_bitmap, bf_run_steps[i].node_bitmap);
+	}
+	if (mask)
+		bit_and(freed_bitmap, mask);
+	bit_and_not(node_space[0].avail_bitmap, freed_bitmap);
+
+	for (i = 0; i < bf_run_step_cnt; i++) {
+		bf_run_step_t *step = &bf_run_steps[i];
+		int k;
+
+		if (step->end_time <= node_space[0].begin_time)
+			continue;	/* Past its end time, never reserved */
+		if (step->end_time >= node_space[j].end_time)
+			break;		/* Beyond the backfill window */
+		if (*node_space_recs >= (max_backfill_job_cnt * 2))
+			break;		/* Stay reserved to the window end */
+
+		bit_copybits(freed_bitmap, step->node_bitmap);
+		bit_and(freed_bitmap, base_bitmap);
+		if (mask)
+			bit_and(freed_bitmap, mask);
+		if (bit_super_set(freed_bitmap, node_space[j].avail_bitmap))
+			continue;	/* Nothing more becomes available */
+
+		/* Append a record starting when these nodes are released */
+		k = (*node_space_recs)++;
+		node_space[k].begin_time = step->end_time;
+		node_space[k].end_time = node_space[j].end_time;
+		node_space[k].avail_bitmap = bit_copy(node_space[j].avail_bitmap);
+		bit_or(node_space[k].avail_bitmap, freed_bitmap);
+		node_space[k].next = 0;
+		node_space[j].end_time = step->end_time;
+		node_space[j].next = k;
+		j = k;
+	}
+
+	FREE_NULL_BITMAP(base_bitmap);
+	FREE_NULL_BITMAP(freed_bitmap);
+}
+
 static int _set_hetjob_details(void *x, void *arg)
 {
 	job_record_t *job_ptr = (job_record_t *) x;
@@ -1553,10 +1986,197 @@ static bool _job_exceeds_max_bf_param(job_record_t *job_ptr,
 	return false;
 }
 
+static void _bf_shape_key_id(void *item, const char **key,
+			     uint32_t *key_len)
+{
+	bf_shape_t *shape = (bf_shape_t *) item;
+
+	*key = shape->key;
+	*key_len = strlen(shape->key);
+}
+
+static void _bf_shape_free(void *item)
+{
+	bf_shape_t *shape = (bf_shape_t *) item;
+
+	if (!shape)
+		return;
+	xfree(shape->key);
+	xfree(shape);
+}
+
+/*
+ * Build the key of everything about a pending job which can change where and
+ * when the select plugin and advanced reservations let it run.
+ * RET key to xfree or NULL if results for the job should not be shared
+ */
+static char *_bf_shape_key(job_record_t *job_ptr, uint32_t min_nodes,
+			   uint32_t req_nodes, uint32_t max_nodes,
+			   uint32_t job_no_reserve)
+{
+	struct job_details *detail_ptr = job_ptr->details;
+	multi_core_data_t *mc_ptr = detail_ptr->mc_ptr;
+	char *key = NULL;
+
+	/* Preemptees and deadlines depend on more than the shape */
+	if (job_ptr->het_job_id || job_ptr->deadline ||
+	    (slurm_job_preempt_mode(job_ptr) != PREEMPT_MODE_OFF))
+		return NULL;
+
+	xstrfmtcat(key, "%s|%u|%s|%u|%s|%s|%s|%u|%u|%u|%u|%u|%u|%u",
+		   job_ptr->part_ptr->name, job_ptr->user_id,
+		   job_ptr->account, job_ptr->qos_id, job_ptr->resv_name,
+		   job_ptr->mcs_label, job_ptr->licenses, job_ptr->bit_flags,
+		   job_ptr->time_limit, job_ptr->time_min, min_nodes,
+		   req_nodes, max_nodes, job_no_reserve);
+	xstrfmtcat(key, "|%s|%s|%s|%s|%s|%s|%s|%u|%u",
+		   job_ptr->tres_per_job, job_ptr->tres_per_node,
+		   job_ptr->tres_per_socket, job_ptr->tres_per_task,
+		   job_ptr->cpus_per_tres, job_ptr->mem_per_tres,
+		   job_ptr->network, job_ptr->req_switch,
+		   job_ptr->wait4switch);
+	xstrfmtcat(key, "|%s|%s|%s|%u|%u|%u|%u|%u|%u|%"PRIu64"|%u|%u|%u|%u|%u|%u|%u",
+		   detail_ptr->features, detail_ptr->req_nodes,
+		   detail_ptr->exc_nodes, detail_ptr->min_cpus,
+		   detail_ptr->max_cpus, detail_ptr->num_tasks,
+		   detail_ptr->cpus_per_task, detail_ptr->ntasks_per_node,
+		   detail_ptr->pn_min_cpus, detail_ptr->pn_min_memory,
+		   detail_ptr->pn_min_tmp_disk, detail_ptr->contiguous,
+		   detail_ptr->core_spec, detail_ptr->share_res,
+		   detail_ptr->whole_node, detail_ptr->overcommit,
+		   detail_ptr->task_dist);
+	if (mc_ptr) {
+		xstrfmtcat(key, "|%u|%u|%u|%u|%u|%u|%u|%u|%u",
+			   mc_ptr->boards_per_node, mc_ptr->sockets_per_board,
+			   mc_ptr->sockets_per_node, mc_ptr->cores_per_socket,
+			   mc_ptr->threads_per_core, mc_ptr->ntasks_per_board,
+			   mc_ptr->ntasks_per_socket, mc_ptr->ntasks_per_core,
+			   mc_ptr->plane_size);
+	}
+
+	return key;
+}
+
+static void _bf_profile_key_id(void *item, const char **key,
+			       uint32_t *key_len)
+{
+	bf_profile_t *profile = (bf_profile_t *) item;
+
+	*key = profile->key;
+	*key_len = strlen(profile->key);
+}
+
+static void _bf_profile_free(void *item)
+{
+	bf_profile_t *profile = (bf_profile_t *) item;
+
+	if (!profile)
+		return;
+	xfree(profile->key);
+	xfree(profile);
+}
+
+/* Add the time spent testing a job to the totals of its shape */
+static void _bf_profile_add(job_record_t *job_ptr, uint32_t min_nodes,
+			    struct timeval *tv1, struct timeval *tv2)
+{
+	bf_profile_t *profile;
+	char *key = NULL;
+	uint32_t nodes_lo = 1;
+	uint64_t usec;
+
+	if (!bf_profile)
+		return;
+
+	while ((nodes_lo * 2) <= min_nodes)
+		nodes_lo *= 2;
+	xstrfmtcat(key, "Partition=%s Features=%s Gres=%s Nodes=%u-%u",
+		   job_ptr->part_ptr->name, job_ptr->details->features,
+		   job_ptr->tres_per_node, nodes_lo, (nodes_lo * 2) - 1);
+
+	if (!(profile = xhash_get(bf_profile, key, strlen(key)))) {
+		profile = xmalloc(sizeof(bf_profile_t));
+		profile->key = key;
+		xhash_add(bf_profile, profile);
+	} else
+		xfree(key);
+
+	usec = ((tv2->tv_sec - tv1->tv_sec) * USEC_IN_SEC) +
+	       (tv2->tv_usec - tv1->tv_usec);
+	profile->count++;
+	profile->total_usec += usec;
+	profile->max_usec = MAX(profile->max_usec, usec);
+}
+
+static void _bf_profile_top(void *item, void *arg)
+{
+	bf_profile_t *profile = (bf_profile_t *) item;
+	bf_profile_t **top = (bf_profile_t **) arg;
+	int i;
+
+	for (i = 0; i < BF_PROFILE_TOP; i++) {
+		if (!top[i] || (profile->total_usec > top[i]->total_usec)) {
+			memmove(&top[i + 1], &top[i],
+				sizeof(bf_profile_t *) *
+				(BF_PROFILE_TOP - i - 1));
+			top[i] = profile;
+			break;
+		}
+	}
+}
+
+/* Log the shapes which took the most select plugin time this cycle */
+static void _bf_profile_report(void)
+{
+	bf_profile_t *top[BF_PROFILE_TOP] = { NULL };
+	int i;
+
+	if (!bf_profile)
+		return;
+
+	xhash_walk(bf_profile, _bf_profile_top, top);
+	for (i = 0; (i < BF_PROFILE_TOP) && top[i]; i++) {
+		info("backfill: profile %s tested:%u total_time:%"PRIu64"usec max_time:%"PRIu64"usec",
+		     top[i]->key, top[i]->count, top[i]->total_usec,
+		     top[i]->max_usec);
+	}
+}
+
+/* Return true if a job of this shape was rejected with the current state */
+static bool _bf_shape_rejected(char *key)
+{
+	bf_shape_t *shape;
+
+	if (!key)
+		return false;
+	bf_shape_tests++;
+	shape = xhash_get(bf_shapes, key, strlen(key));
+	if (!shape || (shape->seq != bf_shape_seq))
+		return false;
+	bf_shape_hits++;
+	return true;
+}
+
+/* Remember that a job of this shape can not start within bf_window */
+static void _bf_shape_reject(char *key)
+{
+	bf_shape_t *shape;
+
+	if (!bf_shapes || !key)
+		return;
+	if (!(shape = xhash_get(bf_shapes, key, strlen(key)))) {
+		shape = xmalloc(sizeof(bf_shape_t));
+		shape->key = xstrdup(key);
+		xhash_add(bf_shapes, shape);
+	}
+	shape->seq = bf_shape_seq;
+}
+
 static int _attempt_backfill(void)
 {
 	DEF_TIMERS;
 	List job_queue;
+	job_queue_heap_t *job_queue_heap = NULL;
 	job_queue_rec_t *job_queue_rec;
 	int bb, i, j, node_space_recs, mcs_select = 0;
 	slurmdb_qos_rec_t *qos_ptr = NULL;
@@ -1571,12 +2191,15 @@ static int _attempt_backfill(void)
 	time_t now, sched_start, later_start, start_res, resv_end, window_end;
 	time_t het_job_time, orig_sched_start, orig_start_time = (time_t) 0;
 	node_space_map_t *node_space;
-	struct timeval bf_time1, bf_time2;
+	bf_group_t *cur_group = NULL;
+	int groups_full = 0;
+	struct timeval bf_time1, bf_time2, test_tv1, test_tv2;
 	int rc = 0, error_code;
 	int job_test_count = 0, test_time_count = 0, pend_time;
 	bool already_counted, many_rpcs = false;
 	job_record_t *reject_array_job = NULL;
 	part_record_t *reject_array_part = NULL;
+	char *shape_key = NULL;
 	uint32_t start_time;
 	time_t config_update = slurm_conf.last_update;
 	time_t part_update = last_part_update;
@@ -1629,6 +2252,7 @@ static int _attempt_backfill(void)
 		debug("backfill: %u jobs to backfill", job_test_count);
 
 	list_for_each(job_list, _clear_job_estimates, NULL);
+	list_for_each(het_job_list, _het_job_resv_clear, NULL);
 
 	if (bf_hetjob_prio)
 		list_for_each(job_list, _set_hetjob_details, NULL);
@@ -1657,13 +2281,22 @@ static int _attempt_backfill(void)
 	node_space[0].next = 0;
 	node_space_recs = 1;
 
-	if (bf_running_job_reserve) {
-		node_space_handler_t node_space_handler;
-		node_space_handler.node_space = node_space;
-		node_space_handler.node_space_recs = &node_space_recs;
+	if (bf_part_groups)
+		_bf_groups_build(node_space);
 
-		list_for_each(job_list, _bf_reserve_running,
-			      &node_space_handler);
+	if (bf_running_job_reserve) {
+		_bf_run_cache_sync();
+		if (!bf_groups) {
+			_bf_run_reserve(node_space, &node_space_recs, NULL);
+		} else {
+			for (i = 0; i < bf_group_cnt; i++)
+				_bf_run_reserve(bf_groups[i].node_space,
+						&bf_groups[i].node_space_recs,
+						bf_groups[i].node_bitmap);
+		}
+	} else if (bf_run_cache) {
+		xhash_free(bf_run_cache);
+		_bf_run_steps_free();
 	}
 
 	if (slurm_conf.debug_flags & DEBUG_FLAG_BACKFILL_MAP)
@@ -1676,11 +2309,17 @@ static int _attempt_backfill(void)
 		assoc_mgr_unlock(&qos_read_lock);
 	}
 
-	sort_job_queue(job_queue);
+	job_queue_heap = job_queue_heap_create(job_queue);
 
 	/* Ignore nodes that have been set as available during this cycle. */
 	bit_clear_all(bf_ignore_node_bitmap);
 
+	if (bf_shape_cache)
+		bf_shapes = xhash_init(_bf_shape_key_id, _bf_shape_free);
+	bf_shape_hits = bf_shape_tests = 0;
+	if (slurm_conf.debug_flags & DEBUG_FLAG_BACKFILL)
+		bf_profile = xhash_init(_bf_profile_key_id, _bf_profile_free);
+
 	while (1) {
 		uint32_t bf_array_task_id, bf_job_priority,
 			prio_reserve;
@@ -1691,7 +2330,7 @@ static int _attempt_backfill(void)
 			job_resv_clear_promiscous_flag(job_ptr);
 			fill_array_reasons(job_ptr, reject_array_job);
 		}
-		job_queue_rec = (job_queue_rec_t *) list_pop(job_queue);
+		job_queue_rec = job_queue_heap_pop(job_queue_heap);
 		if (!job_queue_rec) {
 			log_flag(BACKFILL, "backfill: reached end of job queue");
 			break;
@@ -1773,6 +2412,21 @@ static int _attempt_backfill(void)
 		if (!part_ptr)
 			continue;
 
+		if (bf_groups) {
+			bf_group_t *group = _bf_group_find(part_ptr->node_bitmap);
+
+			if (group != cur_group) {
+				if (cur_group)
+					cur_group->node_space_recs =
+						node_space_recs;
+				cur_group = group;
+				node_space = group->node_space;
+				node_space_recs = group->node_space_recs;
+			}
+			if (group->full)
+				continue;
+		}
+
 		job_ptr->last_sched_eval = now;
 		job_ptr->part_ptr = part_ptr;
 		job_ptr->priority = bf_job_priority;
@@ -2014,6 +2668,19 @@ next_task:
 		else if (job_ptr->time_min && (job_ptr->time_min < time_limit))
 			time_limit = job_ptr->time_limit = job_ptr->time_min;
 
+		xfree(shape_key);
+		if (bf_shapes)
+			shape_key = _bf_shape_key(job_ptr, min_nodes,
+						  req_nodes, max_nodes,
+						  job_no_reserve);
+		if (_bf_shape_rejected(shape_key)) {
+			log_flag(BACKFILL, "backfill: %pJ has the shape of a job which can not start, skipping",
+				 job_ptr);
+			_set_job_time_limit(job_ptr, orig_time_limit);
+			job_ptr->start_time = orig_start_time;
+			continue;
+		}
+
 		later_start = now;
 
 		if (assoc_limit_stop) {
@@ -2185,6 +2852,7 @@ next_task:
 			}
 
 			/* Job can not start until too far in the future */
+			_bf_shape_reject(shape_key);
 			_set_job_time_limit(job_ptr, orig_time_limit);
 			/*
 			 * Use orig_start_time if job can't
@@ -2209,6 +2877,8 @@ next_task:
 		}
 		if (slurm_conf.debug_flags & DEBUG_FLAG_BACKFILL_MAP)
 			_dump_job_test(job_ptr, avail_bitmap, start_res);
+		if (bf_profile)
+			gettimeofday(&test_tv1, NULL);
 		test_fini = -1;
 		build_active_feature_bitmap(job_ptr, avail_bitmap,
 					    &active_bitmap);
@@ -2294,6 +2964,11 @@ next_task:
 		job_ptr->bit_flags &= ~BACKFILL_TEST;
 		job_ptr->bit_flags &= ~BF_WHOLE_NODE_TEST;
 		job_ptr->bit_flags &= ~TEST_NOW_ONLY;
+		if (bf_profile) {
+			gettimeofday(&test_tv2, NULL);
+			_bf_profile_add(job_ptr, min_nodes, &test_tv1,
+					&test_tv2);
+		}
 
 		now = time(NULL);
 		if (j != SLURM_SUCCESS) {
@@ -2303,6 +2978,7 @@ next_task:
 				goto TRY_LATER;
 			}
 			job_ptr->start_time = orig_start_time;
+			_bf_shape_reject(shape_key);
 			continue;	/* not runable in this partition */
 		}
 
@@ -2589,6 +3265,11 @@ skip_start:
 				     max_backfill_job_cnt);
 			}
 			_set_job_time_limit(job_ptr, orig_time_limit);
+			if (cur_group && (++groups_full < bf_group_cnt)) {
+				/* Keep planning the other partition groups */
+				cur_group->full = true;
+				continue;
+			}
 			break;
 		}
 
@@ -2695,6 +3376,11 @@ skip_start:
 		    !(job_ptr->bit_flags & JOB_PROM)) {
 			_add_reservation(start_time, end_reserve, avail_bitmap,
 					 node_space, &node_space_recs);
+			if (job_ptr->het_job_id)
+				_het_job_resv_align(job_ptr, start_time,
+						    end_reserve, avail_bitmap,
+						    node_space,
+						    &node_space_recs);
 		}
 		if (slurm_conf.debug_flags & DEBUG_FLAG_BACKFILL_MAP)
 			_dump_node_space_table(node_space);
@@ -2742,13 +3428,22 @@ skip_start:
 	FREE_NULL_BITMAP(exc_core_bitmap);
 	FREE_NULL_BITMAP(resv_bitmap);
 
-	for (i = 0; ; ) {
-		FREE_NULL_BITMAP(node_space[i].avail_bitmap);
-		if ((i = node_space[i].next) == 0)
-			break;
+	if (bf_groups) {
+		if (cur_group)
+			cur_group->node_space_recs = node_space_recs;
+		node_space_recs = _bf_groups_free();
+	} else {
+		for (i = 0; ; ) {
+			FREE_NULL_BITMAP(node_space[i].avail_bitmap);
+			if ((i = node_space[i].next) == 0)
+				break;
+		}
+		xfree(node_space);
 	}
-	xfree(node_space);
+	job_queue_heap_destroy(job_queue_heap);
 	FREE_NULL_LIST(job_queue);
+	xhash_free(bf_shapes);
+	xfree(shape_key);
 
 	gettimeofday(&bf_time2, NULL);
 	_do_diag_stats(&bf_time1, &bf_time2, node_space_recs);
@@ -2757,7 +3452,12 @@ skip_start:
 		info("backfill: completed testing %u(%d) jobs, %s",
 		     slurmctld_diag_stats.bf_last_depth,
 		     job_test_count, TIME_STR);
+		if (bf_shape_cache)
+			info("backfill: bf_shape_cache skipped %u of %u jobs with a cached shape",
+			     bf_shape_hits, bf_shape_tests);
 	}
+	_bf_profile_report();
+	xhash_free(bf_profile);
 
 	slurm_mutex_lock(&slurmctld_config.thread_count_lock);
 	if (slurmctld_config.server_thread_count >= 150) {
@@ -2806,6 +3506,7 @@ static int _start_job(job_record_t *job_ptr, bitstr_t *resv_bitmap)
 		FREE_NULL_BITMAP(orig_exc_nodes);
 	if (rc == SLURM_SUCCESS) {
 		/* job initiated */
+		bf_shape_seq++;
 		last_job_update = time(NULL);
 		info("backfill: Started %pJ in %s on %s",
 		     job_ptr, job_ptr->part_ptr->name, job_ptr->nodes);
@@ -2931,6 +3632,32 @@ static bool _more_work (time_t last_backfill_time)
 	return rc;
 }
 
+/*
+ * Get an unused record of node_space, reusing records released by
+ * _node_space_release() before growing node_space_recs
+ */
+static int _node_space_alloc(node_space_map_t *node_space,
+			     int *node_space_recs)
+{
+	int i;
+
+	if ((i = node_space[0].free)) {
+		node_space[0].free = node_space[i].next;
+		return i;
+	}
+	return (*node_space_recs)++;
+}
+
+/* Return a record unlinked from the time line to the unused records */
+static void _node_space_release(node_space_map_t *node_space, int i)
+{
+	xassert(i != 0);
+
+	FREE_NULL_BITMAP(node_space[i].avail_bitmap);
+	node_space[i].next = node_space[0].free;
+	node_space[0].free = i;
+}
+
 /* Create a reservation for a job in the future */
 static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			     bitstr_t *res_bitmap,
@@ -2938,7 +3665,7 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			     int *node_space_recs)
 {
 	bool placed = false;
-	int i, j;
+	int first = 0, i, j;
 
 #if 0	
 	info("add job start:%u end:%u", start_time, end_reserve);
@@ -2955,7 +3682,7 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 	for (j = 0; ; ) {
 		if (node_space[j].end_time > start_time) {
 			/* insert start entry record */
-			i = *node_space_recs;
+			i = _node_space_alloc(node_space, node_space_recs);
 			node_space[i].begin_time = start_time;
 			node_space[i].end_time = node_space[j].end_time;
 			node_space[j].end_time = start_time;
@@ -2963,7 +3690,6 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 				bit_copy(node_space[j].avail_bitmap);
 			node_space[i].next = node_space[j].next;
 			node_space[j].next = i;
-			(*node_space_recs)++;
 			placed = true;
 		}
 		if (node_space[j].end_time == start_time) {
@@ -2971,10 +3697,12 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			placed = true;
 		}
 		if (placed == true) {
+			first = j;
 			while ((j = node_space[j].next)) {
 				if (end_reserve < node_space[j].end_time) {
 					/* insert end entry record */
-					i = *node_space_recs;
+					i = _node_space_alloc(node_space,
+							      node_space_recs);
 					node_space[i].begin_time = end_reserve;
 					node_space[i].end_time = node_space[j].
 								 end_time;
@@ -2984,7 +3712,6 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 							 avail_bitmap);
 					node_space[i].next = node_space[j].next;
 					node_space[j].next = i;
-					(*node_space_recs)++;
 					break;
 				}
 				if (end_reserve == node_space[j].end_time) {
@@ -2997,7 +3724,7 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			break;
 	}
 
-	for (j = 0; ; ) {
+	for (j = first; ; ) {
 		if ((node_space[j].begin_time >= start_time) &&
 		    (node_space[j].end_time <= end_reserve))
 			bit_and(node_space[j].avail_bitmap, res_bitmap);
@@ -3006,11 +3733,17 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			break;
 	}
 
-	/* Drop records with identical bitmaps (up to one record).
-	 * This can significantly improve performance of the backfill tests. */
-	for (i = 0; ; ) {
+	/*
+	 * Drop records with identical bitmaps. Only records from the one
+	 * preceding the reservation through the one following it can have
+	 * changed, so there is no need to compare the rest of the table.
+	 * This can significantly improve performance of the backfill tests.
+	 */
+	for (i = first; ; ) {
 		if ((j = node_space[i].next) == 0)
 			break;
+		if (node_space[j].begin_time > end_reserve)
+			break;
 		if (!bit_equal(node_space[i].avail_bitmap,
 			       node_space[j].avail_bitmap)) {
 			i = j;
@@ -3018,8 +3751,7 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 		}
 		node_space[i].end_time = node_space[j].end_time;
 		node_space[i].next = node_space[j].next;
-		FREE_NULL_BITMAP(node_space[j].avail_bitmap);
-		break;
+		_node_space_release(node_space, j);
 	}
 }
 
@@ -3045,7 +3777,8 @@ static bool _test_resv_overlap(node_space_map_t *node_space,
 			overlap = true;
 			break;
 		}
-		if ((j = node_space[j].next) == 0)
+		if ((node_space[j].begin_time >= end_reserve) ||
+		    ((j = node_space[j].next) == 0))
 			break;
 	}
 	return overlap;
@@ -3061,6 +3794,36 @@ static void _het_job_map_del(void *x)
 	xfree(map);
 }
 
+/*
+ * Delete het_job_rec_t record from het_job_rec_list
+ */
+static void _het_job_rec_del(void *x)
+{
+	het_job_rec_t *rec = (het_job_rec_t *) x;
+	FREE_NULL_BITMAP(rec->resv_bitmap);
+	xfree(rec);
+}
+
+/*
+ * Forget the node_space reservations recorded for hetjob components by the
+ * previous backfill cycle, whose node_space table no longer exists.
+ */
+static int _het_job_resv_clear(void *x, void *arg)
+{
+	het_job_map_t *map = (het_job_map_t *) x;
+	het_job_rec_t *rec;
+	ListIterator iter;
+
+	iter = list_iterator_create(map->het_job_rec_list);
+	while ((rec = (het_job_rec_t *) list_next(iter))) {
+		FREE_NULL_BITMAP(rec->resv_bitmap);
+		rec->resv_space = NULL;
+	}
+	list_iterator_destroy(iter);
+
+	return SLURM_SUCCESS;
+}
+
 /*
  * Return 1 if a het_job_map_t record with a specific het_job_id is found.
  * Always return 1 if "key" is zero.
@@ -3136,6 +3899,64 @@ static time_t _het_job_start_compute(het_job_map_t *map,
 	return latest_start;
 }
 
+/*
+ * Plan the components of a hetjob jointly. Record the reservation just added
+ * to node_space for this component, then re-reserve the resources of every
+ * component planned earlier in this cycle at the hetjob's common start time
+ * (the latest start of any component). Otherwise the earlier components hold
+ * their resources only at their own, earlier, start times, lower priority
+ * jobs get backfilled onto them at the common start time and the hetjob
+ * needs several cycles to converge. A component is only re-reserved when the
+ * common start time moves later, bounding the work to one reservation per
+ * component for each component planned.
+ */
+static void _het_job_resv_align(job_record_t *job_ptr, time_t start_time,
+				time_t end_reserve, bitstr_t *res_bitmap,
+				node_space_map_t *node_space,
+				int *node_space_recs)
+{
+	het_job_map_t *map;
+	het_job_rec_t *rec;
+	ListIterator iter;
+	time_t het_start;
+
+	map = (het_job_map_t *) list_find_first(het_job_list,
+						_het_job_find_map,
+						&job_ptr->het_job_id);
+	if (!map)
+		return;
+	rec = list_find_first(map->het_job_rec_list, _het_job_find_rec,
+			      &job_ptr->job_id);
+	if (!rec)
+		return;
+	FREE_NULL_BITMAP(rec->resv_bitmap);
+	rec->resv_bitmap = bit_copy(res_bitmap);
+	rec->resv_space = node_space;
+	rec->resv_start = start_time;
+	rec->resv_len = end_reserve - start_time;
+
+	het_start = _het_job_start_compute(map, 0);
+	het_start = (het_start / backfill_resolution) * backfill_resolution;
+	if (het_start > (time(NULL) + backfill_window))
+		return;
+
+	iter = list_iterator_create(map->het_job_rec_list);
+	while ((rec = (het_job_rec_t *) list_next(iter))) {
+		if (!rec->resv_bitmap || (rec->resv_space != node_space) ||
+		    (rec->resv_start >= het_start))
+			continue;
+		if (*node_space_recs >= max_backfill_job_cnt)
+			break;
+		log_flag(HETJOB, "%pJ reservation moved to common hetjob start in %ld secs",
+			 rec->job_ptr, MAX(0, het_start - time(NULL)));
+		_add_reservation(het_start, het_start + rec->resv_len,
+				 rec->resv_bitmap, node_space,
+				 node_space_recs);
+		rec->resv_start = het_start;
+	}
+	list_iterator_destroy(iter);
+}
+
 /*
  * Return the earliest that a job can start based upon _other_ components of
  * that same heterogeneous job. Return 0 if no limitation.
@@ -3218,7 +4039,7 @@ static void _het_job_start_set(job_record_t *job_ptr, time_t latest_start,
 			map = xmalloc(sizeof(het_job_map_t));
 			map->comp_time_limit = comp_time_limit;
 			map->het_job_id = job_ptr->het_job_id;
-			map->het_job_rec_list = list_create(xfree_ptr);
+			map->het_job_rec_list = list_create(_het_job_rec_del);
 			list_append(map->het_job_rec_list, rec);
 			list_append(het_job_list, map);
 		}
@@ -3458,7 +4279,9 @@ static int _het_job_start_now(het_job_map_t *map, node_space_map_t *node_space)
 			 * beforehand for _reset_job_time_limit.
 			 */
 			if (reset_time)
-				_reset_job_time_limit(job_ptr, now, node_space);
+				_reset_job_time_limit(job_ptr, now,
+						      _bf_node_space(job_ptr,
+								     node_space));
 		}
 		if (reset_time)
 			jobacct_storage_job_start_direct(acct_db_conn, job_ptr);
@@ -91,6 +91,7 @@ bool     is_cons_tres         = false;
 bool     pack_serial_at_end   = false;
 bool     preempt_by_part      = false;
 bool     preempt_by_qos       = false;
+int      select_eval_threads  = 1;
 int      select_node_cnt      = 0;
 bool     spec_cores_first     = false;
 bool     topo_optional        = false;
@@ -1064,6 +1065,16 @@ extern int select_p_node_init(node_record_t *node_ptr, int node_cnt)
 		backfill_busy_nodes = true;
 	else
 		backfill_busy_nodes = false;
+	select_eval_threads = 1;
+	if ((tmp_ptr = xstrcasestr(sched_params, "select_eval_threads="))) {
+		select_eval_threads = atoi(tmp_ptr + 20);
+		if ((select_eval_threads < 1) ||
+		    (select_eval_threads > MAX_SELECT_EVAL_THREADS)) {
+			error("Invalid SchedulerParameters select_eval_threads: %d",
+			      select_eval_threads);
+			select_eval_threads = 1;	/* Use default value */
+		}
+	}
 	xfree(sched_params);
 
 	preempt_type = slurm_get_preempt_type();
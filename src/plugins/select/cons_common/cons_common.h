@@ -46,6 +46,9 @@
 #include "src/common/gres.h"
 #include "src/slurmctld/slurmctld.h"
 
+/* Maximum value of SchedulerParameters=select_eval_threads */
+#define MAX_SELECT_EVAL_THREADS 64
+
 typedef struct avail_res {	/* Per-node resource availability */
 	uint16_t avail_cpus;	/* Count of available CPUs */
 	uint16_t avail_gpus;	/* Count of available GPUs */
@@ -113,6 +116,7 @@ extern const char *plugin_type;
 extern bool     preempt_by_part;
 extern bool     preempt_by_qos;
 extern uint16_t priority_flags;
+extern int      select_eval_threads;
 extern int      select_node_cnt;
 extern bool     spec_cores_first;
 extern bool     topo_optional;
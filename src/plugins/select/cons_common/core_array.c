@@ -237,10 +237,10 @@ extern bitstr_t *core_array_to_bitmap(bitstr_t **core_array)
 			continue;
 		core_offset = select_node_record[i].cume_cores -
 			      select_node_record[i].tot_cores;
-		for (c = 0; c < select_node_record[i].tot_cores; c++) {
-			if (bit_test(core_array[i], c))
-				bit_set(core_bitmap, core_offset + c);
-		}
+		for (c = bit_ffs(core_array[i]);
+		     (c >= 0) && (c < select_node_record[i].tot_cores);
+		     c = bit_ffs_from_bit(core_array[i], c + 1))
+			bit_set(core_bitmap, core_offset + c);
 	}
 
 #if _DEBUG
@@ -280,9 +280,8 @@ extern bitstr_t **core_bitmap_to_array(bitstr_t *core_bitmap)
 
 	i_last = bit_fls(core_bitmap);
 
-	for (i = i_first; i <= i_last; i++) {
-		if (!bit_test(core_bitmap, i))
-			continue;
+	for (i = i_first; (i >= 0) && (i <= i_last);
+	     i = bit_ffs_from_bit(core_bitmap, i + 1)) {
 		for (j = node_inx; j < select_node_cnt; j++) {
 			if (i < select_node_record[j].cume_cores) {
 				node_inx = j;
@@ -301,10 +300,11 @@ extern bitstr_t **core_bitmap_to_array(bitstr_t *core_bitmap)
 			bit_alloc(select_node_record[node_inx].tot_cores);
 		core_offset = select_node_record[node_inx].cume_cores -
 			      select_node_record[node_inx].tot_cores;
-		for (c = 0; c < select_node_record[node_inx].tot_cores; c++) {
-			if (bit_test(core_bitmap, core_offset + c))
-				bit_set(core_array[node_inx], c);
-		}
+		for (c = bit_ffs_from_bit(core_bitmap, core_offset);
+		     (c >= 0) &&
+		     (c < select_node_record[node_inx].cume_cores);
+		     c = bit_ffs_from_bit(core_bitmap, c + 1))
+			bit_set(core_array[node_inx], c - core_offset);
 		node_inx++;
 	}
 
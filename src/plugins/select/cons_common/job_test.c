@@ -42,6 +42,9 @@
 
 #include "src/slurmctld/preempt.h"
 
+/* Minimum nodes per thread with SchedulerParameters=select_eval_threads */
+#define EVAL_THREAD_MIN_NODES 256
+
 typedef struct {
 	int action;
 	bool job_fini;
@@ -51,6 +54,21 @@ typedef struct {
 	int rc;
 } wrapper_rm_job_args_t;
 
+typedef struct {
+	job_record_t *job_ptr;
+	bitstr_t *node_map;
+	bitstr_t **core_map;
+	node_use_record_t *node_usage;
+	uint16_t cr_type;
+	bool test_only;
+	bool will_run;
+	bitstr_t **part_core_map;
+	uint32_t s_p_n;
+	avail_res_t **avail_res_array;
+	int begin;		/* first node index of this thread */
+	int end;		/* one past the last node index of this thread */
+} res_avail_args_t;
+
 uint64_t def_cpu_per_gpu = 0;
 uint64_t def_mem_per_gpu = 0;
 bool preempt_strict_order = false;
@@ -290,6 +308,26 @@ static uint32_t _socks_per_node(job_record_t *job_ptr)
 	return s_p_n;
 }
 
+/* Evaluate the nodes of one range for _get_res_avail() */
+static void *_get_res_avail_range(void *arg)
+{
+	res_avail_args_t *args = (res_avail_args_t *) arg;
+	int i;
+
+	for (i = args->begin; i < args->end; i++) {
+		if (!bit_test(args->node_map, i))
+			continue;
+		args->avail_res_array[i] =
+			(*cons_common_callbacks.can_job_run_on_node)(
+				args->job_ptr, args->core_map, i,
+				args->s_p_n, args->node_usage,
+				args->cr_type, args->test_only,
+				args->will_run, args->part_core_map);
+	}
+
+	return NULL;
+}
+
 /*
  * Determine resource availability for pending job
  *
@@ -324,6 +362,48 @@ static avail_res_t **_get_res_avail(job_record_t *job_ptr,
 		i_last = bit_fls(node_map);
 	else
 		i_last = -2;
+
+	/*
+	 * With cons_tres each node has its own core bitmap and result, so
+	 * ranges of nodes can be evaluated by separate threads.
+	 */
+	if (is_cons_tres && (select_eval_threads > 1) &&
+	    ((i_last - i_first + 1) >= (2 * EVAL_THREAD_MIN_NODES))) {
+		res_avail_args_t *args;
+		pthread_t *threads;
+		int n, thread_cnt, per_thread;
+
+		n = i_last - i_first + 1;
+		thread_cnt = MIN(select_eval_threads,
+				 n / EVAL_THREAD_MIN_NODES);
+		per_thread = (n + thread_cnt - 1) / thread_cnt;
+		threads = xcalloc(thread_cnt, sizeof(pthread_t));
+		args = xcalloc(thread_cnt, sizeof(res_avail_args_t));
+		for (i = 0; i < thread_cnt; i++) {
+			args[i].job_ptr = job_ptr;
+			args[i].node_map = node_map;
+			args[i].core_map = core_map;
+			args[i].node_usage = node_usage;
+			args[i].cr_type = cr_type;
+			args[i].test_only = test_only;
+			args[i].will_run = will_run;
+			args[i].part_core_map = part_core_map;
+			args[i].s_p_n = s_p_n;
+			args[i].avail_res_array = avail_res_array;
+			args[i].begin = i_first + (i * per_thread);
+			args[i].end = MIN(args[i].begin + per_thread,
+					  i_last + 1);
+			slurm_thread_create(&threads[i], _get_res_avail_range,
+					    &args[i]);
+		}
+		for (i = 0; i < thread_cnt; i++)
+			pthread_join(threads[i], NULL);
+		xfree(threads);
+		xfree(args);
+
+		return avail_res_array;
+	}
+
 	for (i = i_first; i <= i_last; i++) {
 		if (bit_test(node_map, i))
 			avail_res_array[i] =
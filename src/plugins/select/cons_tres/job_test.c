@@ -2085,7 +2085,7 @@ static int _eval_nodes_topo(job_record_t *job_ptr,
 	int       *switch_cpu_cnt = NULL;	/* total CPUs on switch */
 	List      *switch_gres = NULL;		/* available GRES on switch */
 	bitstr_t **switch_node_bitmap = NULL;	/* nodes on this switch */
-	int       *switch_node_cnt = NULL;	/* total nodes on switch */
+	int       *switch_node_cnt = NULL;	/* free nodes on switch */
 	int       *switch_required = NULL;	/* set if has required node */
 	bitstr_t  *avail_nodes_bitmap = NULL;	/* nodes on any switch */
 	bitstr_t  *req_nodes_bitmap   = NULL;	/* required node bitmap */
@@ -2233,9 +2233,16 @@ static int _eval_nodes_topo(job_record_t *job_ptr,
 
 	for (i = 0, switch_ptr = switch_record_table; i < switch_record_cnt;
 	     i++, switch_ptr++) {
+		/*
+		 * Count before copying: switches with no usable nodes (e.g.
+		 * outside of the job's partition) get no bitmap at all.
+		 */
+		switch_node_cnt[i] = bit_overlap(switch_ptr->node_bitmap,
+						 node_map);
+		if (!switch_node_cnt[i])
+			continue;
 		switch_node_bitmap[i] = bit_copy(switch_ptr->node_bitmap);
 		bit_and(switch_node_bitmap[i], node_map);
-		switch_node_cnt[i] = bit_set_count(switch_node_bitmap[i]);
 		if (req_nodes_bitmap &&
 		    bit_overlap_any(req_nodes_bitmap, switch_node_bitmap[i])) {
 			switch_required[i] = 1;
@@ -2294,7 +2301,7 @@ static int _eval_nodes_topo(job_record_t *job_ptr,
 	 * top level switch.
 	 */
 	for (i = 0; i < switch_record_cnt; i++) {
-		if (top_switch_inx != i) {
+		if ((top_switch_inx != i) && switch_node_bitmap[i]) {
 			  bit_and(switch_node_bitmap[i],
 				  switch_node_bitmap[top_switch_inx]);
 		}
@@ -2433,7 +2440,7 @@ static int _eval_nodes_topo(job_record_t *job_ptr,
 
 		for (i = 0, switch_ptr = switch_record_table;
 		     i < switch_record_cnt; i++, switch_ptr++) {
-			if (switch_required[i])
+			if (switch_required[i] || !switch_node_bitmap[i])
 				continue;
 			if (bit_overlap_any(req2_nodes_bitmap,
 					    switch_node_bitmap[i])) {
@@ -2471,9 +2478,17 @@ static int _eval_nodes_topo(job_record_t *job_ptr,
 	avail_nodes_bitmap = bit_alloc(node_record_count);
 	for (i = 0, switch_ptr = switch_record_table; i < switch_record_cnt;
 	     i++, switch_ptr++) {
+		if (!switch_node_bitmap[i])
+			continue;
 		bit_and(switch_node_bitmap[i], best_nodes_bitmap);
 		bit_or(avail_nodes_bitmap, switch_node_bitmap[i]);
-		switch_node_cnt[i] = bit_set_count(switch_node_bitmap[i]);
+		/*
+		 * Track nodes not yet allocated to the job, so the leaf switch
+		 * selection below is not skewed by nodes already picked.
+		 */
+		switch_node_cnt[i] = bit_set_count(switch_node_bitmap[i]) -
+				     bit_overlap(switch_node_bitmap[i],
+						 node_map);
 	}
 
 	if (slurm_conf.debug_flags & DEBUG_FLAG_SELECT_TYPE) {
@@ -2497,7 +2512,8 @@ static int _eval_nodes_topo(job_record_t *job_ptr,
 	if (!req_nodes_bitmap) {
 		for (i = 0, switch_ptr = switch_record_table;
 		     i < switch_record_cnt; i++, switch_ptr++) {
-			if (switch_record_table[i].level != 0)
+			if ((switch_record_table[i].level != 0) ||
+			    !switch_node_bitmap[i])
 				continue;
 			if (bit_overlap_any(switch_node_bitmap[i],
 					    best_nodes_bitmap))
@@ -2544,6 +2560,7 @@ static int _eval_nodes_topo(job_record_t *job_ptr,
 						avail_cpus);
 				}
 				bit_set(node_map, j);
+				switch_node_cnt[i]--;
 				if ((rem_nodes <= 0) && (rem_cpus <= 0) &&
 				    (!gres_per_job ||
 				     gres_plugin_job_sched_test(
@@ -3257,6 +3274,54 @@ extern avail_res_t *can_job_run_on_node(job_record_t *job_ptr,
 		return NULL;
 	}
 
+	/* Check that sufficient CPUs remain to run a task on this node */
+	if (job_ptr->details->ntasks_per_node) {
+		ntasks_per_node = job_ptr->details->ntasks_per_node;
+	} else if (job_ptr->details->overcommit) {
+		ntasks_per_node = 1;
+	} else if ((job_ptr->details->max_nodes == 1) &&
+		   (job_ptr->details->num_tasks != 0)) {
+		ntasks_per_node = job_ptr->details->num_tasks;
+	} else if (job_ptr->details->max_nodes) {
+		ntasks_per_node = (job_ptr->details->num_tasks +
+				   job_ptr->details->max_nodes - 1) /
+				  job_ptr->details->max_nodes;
+	}
+	min_cpus_per_node = ntasks_per_node * job_ptr->details->cpus_per_task;
+
+	if (cr_type & CR_MEMORY) {
+		avail_mem = select_node_record[node_i].real_memory -
+			    select_node_record[node_i].mem_spec_limit;
+		if (!test_only)
+			avail_mem -= node_usage[node_i].alloc_memory;
+	}
+
+	/*
+	 * Reject nodes which obviously can not fit the job before doing the
+	 * GRES and per-core tests below: the job can get no more CPUs than
+	 * the threads of its available cores, and if it needs more memory
+	 * than is free for a single CPU the memory check below will leave it
+	 * no CPUs at all.
+	 */
+	if (core_map[node_i] &&
+	    ((bit_set_count(core_map[node_i]) *
+	      select_node_record[node_i].vpus) < min_cpus_per_node)) {
+#if _DEBUG
+		info("Test fail on node %d: free cores < min_cpus_per_node",
+		     node_i);
+#endif
+		return NULL;
+	}
+	if ((cr_type & CR_MEMORY) &&
+	    ((job_ptr->details->pn_min_memory & ~MEM_PER_CPU) > avail_mem)) {
+#if _DEBUG
+		info("Test fail on node %d: avail_mem < req_mem", node_i);
+#endif
+		if (core_map[node_i])
+			bit_clear_all(core_map[node_i]);
+		return NULL;
+	}
+
 	if (part_core_map)
 		part_core_map_ptr = part_core_map[node_i];
 	if (node_usage[node_i].gres_list)
@@ -3306,20 +3371,6 @@ extern avail_res_t *can_job_run_on_node(job_record_t *job_ptr,
 		return NULL;
 	}
 
-	/* Check that sufficient CPUs remain to run a task on this node */
-	if (job_ptr->details->ntasks_per_node) {
-		ntasks_per_node = job_ptr->details->ntasks_per_node;
-	} else if (job_ptr->details->overcommit) {
-		ntasks_per_node = 1;
-	} else if ((job_ptr->details->max_nodes == 1) &&
-		   (job_ptr->details->num_tasks != 0)) {
-		ntasks_per_node = job_ptr->details->num_tasks;
-	} else if (job_ptr->details->max_nodes) {
-		ntasks_per_node = (job_ptr->details->num_tasks +
-				   job_ptr->details->max_nodes - 1) /
-				  job_ptr->details->max_nodes;
-	}
-	min_cpus_per_node = ntasks_per_node * job_ptr->details->cpus_per_task;
 	if (avail_res->max_cpus < min_cpus_per_node) {
 #if _DEBUG
 		info("Test fail on node %d: max_cpus < min_cpus_per_node (%u < %u)",
@@ -3330,13 +3381,6 @@ extern avail_res_t *can_job_run_on_node(job_record_t *job_ptr,
 		return NULL;
 	}
 
-	if (cr_type & CR_MEMORY) {
-		avail_mem = select_node_record[node_i].real_memory -
-			    select_node_record[node_i].mem_spec_limit;
-		if (!test_only)
-			avail_mem -= node_usage[node_i].alloc_memory;
-	}
-
 	if (sock_gres_list) {
 		uint16_t near_gpu_cnt = 0;
 		avail_res->sock_gres_list = sock_gres_list;
@@ -1059,8 +1059,9 @@ extern int task_cgroup_cpuset_create(stepd_step_rec_t *job)
 	char* job_alloc_cores = NULL;
 	char* step_alloc_cores = NULL;
 	char cpuset_meta[PATH_MAX];
-	char *cpus = NULL;
-	size_t cpus_size;
+	char mems_meta[PATH_MAX];
+	char *cpus = NULL, *mems = NULL;
+	size_t cpus_size, mems_size;
 	char *slurm_cgpath;
 	xcgroup_t slurm_cg;
 #ifdef HAVE_NATIVE_CRAY
@@ -1239,11 +1240,20 @@ again:
 		xcgroup_destroy(&job_cpuset_cg);
 		goto error;
 	}
-	if (_xcgroup_cpuset_init(&job_cpuset_cg) != XCGROUP_SUCCESS) {
+	/*
+	 * the job cgroup is shared by all the steps of the job, only copy the
+	 * parent configuration when mems (set last by the init) is missing
+	 */
+	snprintf(mems_meta, sizeof(mems_meta), "%smems", cpuset_prefix);
+	rc = xcgroup_get_param(&job_cpuset_cg, mems_meta, &mems, &mems_size);
+	if (((rc != XCGROUP_SUCCESS) || (mems_size <= 1)) &&
+	    (_xcgroup_cpuset_init(&job_cpuset_cg) != XCGROUP_SUCCESS)) {
 		xcgroup_destroy(&user_cpuset_cg);
 		xcgroup_destroy(&job_cpuset_cg);
+		xfree(mems);
 		goto error;
 	}
+	xfree(mems);
 	xcgroup_set_param(&job_cpuset_cg, cpuset_meta, job_alloc_cores);
 	/*
 	 * create step cgroup in the cpuset ns (it should not exists)
@@ -63,9 +63,11 @@
 
 #define MAX_CANCEL_RETRY 10
 #define MAX_THREADS 10
+#define KILL_JOBS_BATCH_SIZE 1000	/* jobs per REQUEST_KILL_JOBS RPC */
 
 static void  _add_delay(void);
 static int   _cancel_jobs(void);
+static void  _cancel_job_batch(char **job_ids, uint32_t job_cnt, int *rc);
 static void *_cancel_job_id (void *cancel_info);
 static void *_cancel_step_id (void *cancel_info);
 static int  _confirmation(job_info_t *job_ptr, uint32_t step_id);
@@ -554,6 +556,8 @@ _cancel_jobs_by_state(uint32_t job_state, int *rc)
 	int i;
 	job_cancel_info_t *cancel_info;
 	job_info_t *job_ptr = job_buffer_ptr->job_array;
+	char **job_ids = NULL;
+	uint32_t job_id_cnt = 0;
 
 	/* Spawn a thread to cancel each job or job step marked for
 	 * cancellation */
@@ -562,6 +566,14 @@ _cancel_jobs_by_state(uint32_t job_state, int *rc)
 		return;
 	}
 
+	/*
+	 * Without confirmation prompts or sibling routing, collect the jobs
+	 * and cancel them with as few RPCs as possible.
+	 */
+	if (!opt.interactive && !opt.sibling)
+		job_ids = xcalloc(job_buffer_ptr->record_count + 1,
+				  sizeof(char *));
+
 	for (i = 0; i < job_buffer_ptr->record_count; i++, job_ptr++) {
 		if (IS_JOB_FINISHED(job_ptr))
 			job_ptr->job_id = 0;
@@ -578,6 +590,12 @@ _cancel_jobs_by_state(uint32_t job_state, int *rc)
 			continue;
 		}
 
+		if (job_ids) {
+			job_ids[job_id_cnt++] = _build_jobid_str(job_ptr);
+			job_ptr->job_id = 0;
+			continue;
+		}
+
 		cancel_info = (job_cancel_info_t *)
 			xmalloc(sizeof(job_cancel_info_t));
 		cancel_info->job_id_str = _build_jobid_str(job_ptr);
@@ -611,6 +629,13 @@ _cancel_jobs_by_state(uint32_t job_state, int *rc)
 			slurm_mutex_unlock(&num_active_threads_lock);
 		}
 	}
+
+	if (job_ids) {
+		_cancel_job_batch(job_ids, job_id_cnt, rc);
+		for (i = 0; i < job_id_cnt; i++)
+			xfree(job_ids[i]);
+		xfree(job_ids);
+	}
 }
 
 /* _cancel_jobs - filter then cancel jobs or job steps per request */
@@ -683,13 +708,147 @@ static void _add_delay(void)
 	return;
 }
 
+/* Build the KILL_* flags for cancelling whole jobs per the options */
+static uint16_t _kill_job_flags(void)
+{
+	uint16_t flags = 0;
+
+	if (opt.batch)
+		flags |= KILL_JOB_BATCH;
+	if (opt.full)
+		flags |= KILL_FULL_JOB;
+	if (opt.hurry)
+		flags |= KILL_HURRY;
+	return flags;
+}
+
+/*
+ * Report the result of signalling a job.
+ * RET error_code, or 0 if the error is one to ignore
+ */
+static int _kill_job_rc(char *job_id_str, uint16_t sig, int error_code)
+{
+	if (!error_code)
+		return error_code;
+
+	if ((opt.verbose > 0) ||
+	    ((error_code != ESLURM_ALREADY_DONE) &&
+	     (error_code != ESLURM_INVALID_JOB_ID) &&
+	     ((error_code != ESLURM_NOT_WHOLE_HET_JOB) ||
+	      (opt.job_cnt != 0)))) {
+		error("Kill job error on job id %s: %s",
+		      job_id_str, slurm_strerror(error_code));
+	}
+	if (((error_code == ESLURM_ALREADY_DONE) ||
+	     (error_code == ESLURM_INVALID_JOB_ID)) &&
+	    (sig == SIGKILL)) {
+		error_code = 0;	/* Ignore error if job done */
+	}
+	return error_code;
+}
+
+/* Spawn a thread to cancel one job by its ID string, which is consumed */
+static void _spawn_cancel_job(char *job_id_str, int *rc)
+{
+	job_cancel_info_t *cancel_info;
+
+	cancel_info = xmalloc(sizeof(job_cancel_info_t));
+	cancel_info->job_id_str = job_id_str;
+	cancel_info->rc      = rc;
+	cancel_info->sig     = opt.signal;
+	cancel_info->num_active_threads = &num_active_threads;
+	cancel_info->num_active_threads_lock = &num_active_threads_lock;
+	cancel_info->num_active_threads_cond = &num_active_threads_cond;
+
+	slurm_mutex_lock(&num_active_threads_lock);
+	num_active_threads++;
+	while (num_active_threads > MAX_THREADS) {
+		slurm_cond_wait(&num_active_threads_cond,
+				&num_active_threads_lock);
+	}
+	slurm_mutex_unlock(&num_active_threads_lock);
+
+	slurm_thread_create_detached(NULL, _cancel_job_id, cancel_info);
+}
+
+/*
+ * Cancel whole jobs, KILL_JOBS_BATCH_SIZE per REQUEST_KILL_JOBS RPC. Jobs
+ * the controller could not handle in a batch (an older or federated
+ * controller, or a job in a transitional state) are retried one at a time
+ * by _cancel_job_id() threads, which the caller must wait for.
+ */
+static void _cancel_job_batch(char **job_ids, uint32_t job_cnt, int *rc)
+{
+	kill_jobs_msg_t kill_msg;
+	kill_jobs_resp_msg_t *resp = NULL;
+	uint16_t sig = (opt.signal == NO_VAL16) ? SIGKILL : opt.signal;
+	char *job_type = "";
+	uint32_t i, start;
+	int error_code, job_rc;
+	DEF_TIMERS;
+
+	if (opt.batch)
+		job_type = "batch ";
+	if (opt.full)
+		job_type = "full ";
+
+	memset(&kill_msg, 0, sizeof(kill_msg));
+	kill_msg.flags  = _kill_job_flags();
+	kill_msg.signal = sig;
+
+	for (start = 0; start < job_cnt; start += kill_msg.jobs_cnt) {
+		kill_msg.jobs_array = &job_ids[start];
+		kill_msg.jobs_cnt   = MIN(job_cnt - start,
+					  KILL_JOBS_BATCH_SIZE);
+
+		for (i = 0; i < kill_msg.jobs_cnt; i++) {
+			if (opt.signal == NO_VAL16)
+				verbose("Terminating %sjob %s", job_type,
+					job_ids[start + i]);
+			else
+				verbose("Signal %u to %sjob %s", sig, job_type,
+					job_ids[start + i]);
+		}
+
+		_add_delay();
+		START_TIMER;
+		error_code = slurm_kill_jobs(&kill_msg, &resp);
+		END_TIMER;
+		slurm_mutex_lock(&max_delay_lock);
+		max_resp_time = MAX(max_resp_time, DELTA_TIMER);
+		slurm_mutex_unlock(&max_delay_lock);
+
+		if (error_code) {
+			debug("%s: REQUEST_KILL_JOBS failed, signalling jobs individually: %m",
+			      __func__);
+		}
+
+		for (i = 0; i < kill_msg.jobs_cnt; i++) {
+			char *job_id_str = job_ids[start + i];
+
+			if (error_code || (resp->error_code[i] ==
+					   ESLURM_TRANSITION_STATE_NO_UPDATE)) {
+				_spawn_cancel_job(xstrdup(job_id_str), rc);
+				continue;
+			}
+			job_rc = _kill_job_rc(job_id_str, sig,
+					      resp->error_code[i]);
+			slurm_mutex_lock(&num_active_threads_lock);
+			*rc = MAX(*rc, job_rc);
+			slurm_mutex_unlock(&num_active_threads_lock);
+		}
+		slurm_free_kill_jobs_response_msg(resp);
+		resp = NULL;
+	}
+}
+
 static void *
 _cancel_job_id (void *ci)
 {
 	int error_code = SLURM_SUCCESS, i;
 	job_cancel_info_t *cancel_info = (job_cancel_info_t *)ci;
 	bool sig_set = true;
-	uint16_t flags = 0;
+	uint16_t flags = _kill_job_flags();
 	char *job_type = "";
 	DEF_TIMERS;
 
@@ -697,16 +856,10 @@ _cancel_job_id (void *ci)
 		cancel_info->sig = SIGKILL;
 		sig_set = false;
 	}
-	if (opt.batch) {
-		flags |= KILL_JOB_BATCH;
+	if (opt.batch)
 		job_type = "batch ";
-	}
-	if (opt.full) {
-		flags |= KILL_FULL_JOB;
+	if (opt.full)
 		job_type = "full ";
-	}
-	if (opt.hurry)
-		flags |= KILL_HURRY;
 	if (cancel_info->array_flag)
 		flags |= KILL_JOB_ARRAY;
 
@@ -760,23 +913,9 @@ _cancel_job_id (void *ci)
 		verbose("Job is in transitional state, retrying");
 		sleep(5 + i);
 	}
-	if (error_code) {
-		error_code = slurm_get_errno();
-		if ((opt.verbose > 0) ||
-		    ((error_code != ESLURM_ALREADY_DONE) &&
-		     (error_code != ESLURM_INVALID_JOB_ID) &&
-		     ((error_code != ESLURM_NOT_WHOLE_HET_JOB) ||
-		      (opt.job_cnt != 0)))) {
-			error("Kill job error on job id %s: %s",
-			      cancel_info->job_id_str,
-			      slurm_strerror(slurm_get_errno()));
-		}
-		if (((error_code == ESLURM_ALREADY_DONE) ||
-		     (error_code == ESLURM_INVALID_JOB_ID)) &&
-		    (cancel_info->sig == SIGKILL)) {
-			error_code = 0;	/* Ignore error if job done */
-		}	
-	}
+	if (error_code)
+		error_code = _kill_job_rc(cancel_info->job_id_str,
+					  cancel_info->sig, slurm_get_errno());
 
 	/* Purposely free the struct passed in here, so the caller doesn't have
 	 * to keep track of it, but don't destroy the mutex and condition
@@ -911,33 +1050,19 @@ _confirmation(job_info_t *job_ptr, uint32_t step_id)
 
 static int _signal_job_by_str(void)
 {
-	job_cancel_info_t *cancel_info;
 	int i, rc = 0;
 
 	slurm_mutex_init(&num_active_threads_lock);
 	slurm_cond_init(&num_active_threads_cond, NULL);
 
-	for (i = 0; opt.job_list[i]; i++) {
-		cancel_info = (job_cancel_info_t *)
-			xmalloc(sizeof(job_cancel_info_t));
-		cancel_info->job_id_str = xstrdup(opt.job_list[i]);
-		cancel_info->rc      = &rc;
-		cancel_info->sig     = opt.signal;
-		cancel_info->num_active_threads = &num_active_threads;
-		cancel_info->num_active_threads_lock =
-			&num_active_threads_lock;
-		cancel_info->num_active_threads_cond =
-			&num_active_threads_cond;
-
-		slurm_mutex_lock(&num_active_threads_lock);
-		num_active_threads++;
-		while (num_active_threads > MAX_THREADS) {
-			slurm_cond_wait(&num_active_threads_cond,
-					&num_active_threads_lock);
-		}
-		slurm_mutex_unlock(&num_active_threads_lock);
-
-		slurm_thread_create_detached(NULL, _cancel_job_id, cancel_info);
+	if (opt.sibling) {
+		for (i = 0; opt.job_list[i]; i++)
+			_spawn_cancel_job(xstrdup(opt.job_list[i]), &rc);
+	} else {
+		i = 0;
+		while (opt.job_list[i])
+			i++;
+		_cancel_job_batch(opt.job_list, i, &rc);
 	}
 
 	/* Wait all spawned threads to finish */
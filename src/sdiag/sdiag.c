@@ -199,10 +199,12 @@ static int _print_stats(void)
 	printf("\nRemote Procedure Call statistics by message type\n");
 	for (i = 0; i < buf->rpc_type_size; i++) {
 		printf("\t%-40s(%5u) count:%-6u "
-		       "ave_time:%-6u total_time:%"PRIu64"\n",
+		       "ave_time:%-6u max_time:%-8"PRIu64" "
+		       "total_time:%"PRIu64"\n",
 		       rpc_num2string(buf->rpc_type_id[i]),
 		       buf->rpc_type_id[i], buf->rpc_type_cnt[i],
-		       rpc_type_ave_time[i], buf->rpc_type_time[i]);
+		       rpc_type_ave_time[i], buf->rpc_type_max[i],
+		       buf->rpc_type_time[i]);
 	}
 
 	printf("\nRemote Procedure Call statistics by user\n");
@@ -219,6 +221,20 @@ static int _print_stats(void)
 		xfree(user);
 	}
 
+	if (buf->rpc_throttle_user_count > 0)
+		printf("\nRate limited RPCs by user\n");
+	for (i = 0; i < buf->rpc_throttle_user_count; i++) {
+		char *user = uid_to_string_or_null(buf->rpc_throttle_user_id[i]);
+		if (!user)
+			xstrfmtcat(user, "%u", buf->rpc_throttle_user_id[i]);
+
+		printf("\t%-16s(%8u) count:%-6u\n",
+		       user, buf->rpc_throttle_user_id[i],
+		       buf->rpc_throttle_count[i]);
+
+		xfree(user);
+	}
+
 	printf("\nPending RPC statistics\n");
 	if (buf->rpc_queue_type_count == 0)
 		printf("\tNo pending RPCs\n");
@@ -248,9 +264,12 @@ static void _sort_rpc(void)
 	int i, j;
 	uint16_t type_id;
 	uint32_t type_ave, type_cnt, user_ave, user_cnt, user_id;
-	uint64_t type_time, user_time;
+	uint64_t type_max, type_time, user_time;
 
 	rpc_type_ave_time = xmalloc(sizeof(uint32_t) * buf->rpc_type_size);
+	if (!buf->rpc_type_max)	/* Not sent by older slurmctld */
+		buf->rpc_type_max = xcalloc(buf->rpc_type_size,
+					    sizeof(uint64_t));
 	rpc_user_ave_time = xmalloc(sizeof(uint32_t) * buf->rpc_user_size);
 
 	if (params.sort == SORT_ID) {
@@ -261,12 +280,15 @@ static void _sort_rpc(void)
 				type_id   = buf->rpc_type_id[i];
 				type_cnt  = buf->rpc_type_cnt[i];
 				type_time = buf->rpc_type_time[i];
+				type_max  = buf->rpc_type_max[i];
 				buf->rpc_type_id[i]   = buf->rpc_type_id[j];
 				buf->rpc_type_cnt[i]  = buf->rpc_type_cnt[j];
 				buf->rpc_type_time[i] = buf->rpc_type_time[j];
+				buf->rpc_type_max[i]  = buf->rpc_type_max[j];
 				buf->rpc_type_id[j]   = type_id;
 				buf->rpc_type_cnt[j]  = type_cnt;
 				buf->rpc_type_time[j] = type_time;
+				buf->rpc_type_max[j]  = type_max;
 			}
 			if (buf->rpc_type_cnt[i]) {
 				rpc_type_ave_time[i] = buf->rpc_type_time[i] /
@@ -300,12 +322,15 @@ static void _sort_rpc(void)
 				type_id   = buf->rpc_type_id[i];
 				type_cnt  = buf->rpc_type_cnt[i];
 				type_time = buf->rpc_type_time[i];
+				type_max  = buf->rpc_type_max[i];
 				buf->rpc_type_id[i]   = buf->rpc_type_id[j];
 				buf->rpc_type_cnt[i]  = buf->rpc_type_cnt[j];
 				buf->rpc_type_time[i] = buf->rpc_type_time[j];
+				buf->rpc_type_max[i]  = buf->rpc_type_max[j];
 				buf->rpc_type_id[j]   = type_id;
 				buf->rpc_type_cnt[j]  = type_cnt;
 				buf->rpc_type_time[j] = type_time;
+				buf->rpc_type_max[j]  = type_max;
 			}
 			if (buf->rpc_type_cnt[i]) {
 				rpc_type_ave_time[i] = buf->rpc_type_time[i] /
@@ -346,14 +371,17 @@ static void _sort_rpc(void)
 				type_id   = buf->rpc_type_id[i];
 				type_cnt  = buf->rpc_type_cnt[i];
 				type_time = buf->rpc_type_time[i];
+				type_max  = buf->rpc_type_max[i];
 				rpc_type_ave_time[i]  = rpc_type_ave_time[j];
 				buf->rpc_type_id[i]   = buf->rpc_type_id[j];
 				buf->rpc_type_cnt[i]  = buf->rpc_type_cnt[j];
 				buf->rpc_type_time[i] = buf->rpc_type_time[j];
+				buf->rpc_type_max[i]  = buf->rpc_type_max[j];
 				rpc_type_ave_time[j]  = type_ave;
 				buf->rpc_type_id[j]   = type_id;
 				buf->rpc_type_cnt[j]  = type_cnt;
 				buf->rpc_type_time[j] = type_time;
+				buf->rpc_type_max[j]  = type_max;
 			}
 		}
 		for (i = 0; i < buf->rpc_user_size; i++) {
@@ -388,12 +416,15 @@ static void _sort_rpc(void)
 				type_id   = buf->rpc_type_id[i];
 				type_cnt  = buf->rpc_type_cnt[i];
 				type_time = buf->rpc_type_time[i];
+				type_max  = buf->rpc_type_max[i];
 				buf->rpc_type_id[i]   = buf->rpc_type_id[j];
 				buf->rpc_type_cnt[i]  = buf->rpc_type_cnt[j];
 				buf->rpc_type_time[i] = buf->rpc_type_time[j];
+				buf->rpc_type_max[i]  = buf->rpc_type_max[j];
 				buf->rpc_type_id[j]   = type_id;
 				buf->rpc_type_cnt[j]  = type_cnt;
 				buf->rpc_type_time[j] = type_time;
+				buf->rpc_type_max[j]  = type_max;
 			}
 			if (buf->rpc_type_cnt[i]) {
 				rpc_type_ave_time[i] = buf->rpc_type_time[i] /
@@ -89,7 +89,8 @@ static int  _get_info(bool clear_old, slurmdb_federation_rec_t *fed,
 		      char *cluster_name);
 static int  _insert_node_ptr(List sinfo_list, uint16_t part_num,
 			     partition_info_t *part_ptr,
-			     node_info_t *node_ptr);
+			     node_info_t *node_ptr,
+			     sinfo_data_t **last_sinfo);
 static int  _load_resv(reserve_info_msg_t ** reserv_pptr, bool clear_old);
 static bool _match_node_data(sinfo_data_t *sinfo_ptr, node_info_t *node_ptr);
 static bool _match_part_data(sinfo_data_t *sinfo_ptr,
@@ -555,6 +556,7 @@ void *_build_part_info(void *args)
 	partition_info_t *part_ptr;
 	node_info_msg_t *node_msg;
 	node_info_t *node_ptr = NULL;
+	sinfo_data_t *last_sinfo = NULL;
 	uint16_t part_num;
 	int j = 0;
 
@@ -579,7 +581,7 @@ void *_build_part_info(void *args)
 				continue;
 
 			_insert_node_ptr(sinfo_list, part_num,
-					 part_ptr, node_ptr);
+					 part_ptr, node_ptr, &last_sinfo);
 		}
 		j += 2;
 	}
@@ -662,7 +664,7 @@ static int _build_sinfo_data(List sinfo_list,
 			if (pos < 0)
 				continue;
 			_insert_node_ptr(sinfo_list, (uint16_t) j,
-					 part_ptr, node_ptr);
+					 part_ptr, node_ptr, NULL);
 			continue;
 		}
 
@@ -1129,14 +1131,28 @@ static void _update_sinfo(sinfo_data_t *sinfo_ptr, node_info_t *node_ptr)
 		sinfo_ptr->cpus_idle += total_cpus;
 }
 
+/*
+ * last_sinfo IN/OUT - optional record the previous node of the partition was
+ *	added to. Consecutive nodes usually share their configuration, so it is
+ *	tried before searching the whole list.
+ */
 static int _insert_node_ptr(List sinfo_list, uint16_t part_num,
 			    partition_info_t *part_ptr,
-			    node_info_t *node_ptr)
+			    node_info_t *node_ptr,
+			    sinfo_data_t **last_sinfo)
 {
 	int rc = SLURM_SUCCESS;
 	sinfo_data_t *sinfo_ptr = NULL;
 	ListIterator itr = NULL;
 
+	if (last_sinfo && (sinfo_ptr = *last_sinfo) &&
+	    sinfo_ptr->nodes_total &&
+	    _match_part_data(sinfo_ptr, part_ptr) &&
+	    _match_node_data(sinfo_ptr, node_ptr)) {
+		_update_sinfo(sinfo_ptr, node_ptr);
+		return rc;
+	}
+
 	itr = list_iterator_create(sinfo_list);
 	while ((sinfo_ptr = list_next(itr))) {
 		if (!_match_part_data(sinfo_ptr, part_ptr))
@@ -1151,9 +1167,11 @@ static int _insert_node_ptr(List sinfo_list, uint16_t part_num,
 
 	/* if no match, create new sinfo_data entry */
 	if (!sinfo_ptr) {
-		list_append(sinfo_list,
-			    _create_sinfo(part_ptr, part_num, node_ptr));
+		sinfo_ptr = _create_sinfo(part_ptr, part_num, node_ptr);
+		list_append(sinfo_list, sinfo_ptr);
 	}
+	if (last_sinfo)
+		*last_sinfo = sinfo_ptr;
 
 	return rc;
 }
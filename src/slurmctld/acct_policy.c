@@ -3706,6 +3706,15 @@ extern bool acct_policy_job_runnable_post_select(job_record_t *job_ptr,
 
 	assoc_ptr = job_ptr->assoc_ptr;
 	while (assoc_ptr) {
+		/*
+		 * Parents are only checked for group TRES limits, skip the
+		 * ones that don't have any.
+		 */
+		if (parent && assoc_ptr->usage->grp_tres_unlimited) {
+			assoc_ptr = assoc_ptr->usage->parent_assoc_ptr;
+			continue;
+		}
+
 		for (i = 0; i < slurmctld_tres_cnt; i++) {
 			tres_usage_mins[i] =
 				(uint64_t)(assoc_ptr->usage->usage_tres_raw[i]
@@ -87,6 +87,8 @@
 #include "src/common/slurm_protocol_api.h"
 #include "src/common/slurm_protocol_interface.h"
 #include "src/common/uid.h"
+#include "src/common/workq.h"
+#include "src/common/xhash.h"
 #include "src/common/xsignal.h"
 #include "src/common/xassert.h"
 #include "src/common/xmalloc.h"
@@ -105,6 +107,8 @@
 #define RPC_PACK_MAX_AGE	30	/* Rebuild data over 30 seconds old */
 #define DUMP_RPC_COUNT 		25
 #define HOSTLIST_MAX_SIZE 	80
+#define MAX_AGENT_BATCH_WORKERS	64
+#define MAIL_BATCH_SIZE		16	/* Emails sent in turn by one thread */
 
 typedef enum {
 	DSH_NEW,        /* Request not yet started */
@@ -174,6 +178,12 @@ typedef struct mail_info {
 	char *message;
 } mail_info_t;
 
+typedef struct agent_batch {
+	char *node_name;
+	List agent_args;	/* agent_arg_t to send node_name, in order */
+} agent_batch_t;
+
+static void _agent_batch(void);
 static void _agent_defer(void);
 static void _agent_retry(int min_wait, bool wait_too);
 static int  _batch_launch_defer(queued_request_t *queued_req_ptr);
@@ -209,6 +219,11 @@ static List defer_list = NULL;		/* agent_arg_t list for requests
 static List mail_list = NULL;		/* pending e-mail requests */
 static List retry_list = NULL;		/* agent_arg_t list for retry */
 
+static pthread_mutex_t batch_mutex = PTHREAD_MUTEX_INITIALIZER;
+static List batch_list = NULL;		/* agent_arg_t list of single node
+					 * RPCs, grouped by node each tick */
+static workq_t *batch_workq = NULL;	/* set if agent_batch_workers */
+
 
 static pthread_mutex_t agent_cnt_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t  agent_cnt_cond  = PTHREAD_COND_INITIALIZER;
@@ -443,7 +458,6 @@ static agent_info_t *_make_agent_info(agent_arg_t *agent_arg_ptr)
 	if ((agent_arg_ptr->msg_type != REQUEST_JOB_NOTIFY)	&&
 	    (agent_arg_ptr->msg_type != REQUEST_REBOOT_NODES)	&&
 	    (agent_arg_ptr->msg_type != REQUEST_RECONFIGURE)	&&
-	    (agent_arg_ptr->msg_type != REQUEST_RECONFIGURE_WITH_CONFIG) &&
 	    (agent_arg_ptr->msg_type != REQUEST_SHUTDOWN)	&&
 	    (agent_arg_ptr->msg_type != SRUN_EXEC)		&&
 	    (agent_arg_ptr->msg_type != SRUN_TIMEOUT)		&&
@@ -1391,6 +1405,7 @@ static void *_agent_init(void *arg)
 			_agent_defer();
 		}
 
+		_agent_batch();
 		_agent_retry(min_wait, mail_too);
 	}
 
@@ -1402,6 +1417,9 @@ static void *_agent_init(void *arg)
 
 extern void agent_init(void)
 {
+	char *tmp_ptr;
+	int workers = 0;
+
 	slurm_mutex_lock(&pending_mutex);
 	if (pending_thread_running) {
 		error("%s: thread already running", __func__);
@@ -1409,6 +1427,23 @@ extern void agent_init(void)
 		return;
 	}
 
+	if ((tmp_ptr = xstrcasestr(slurm_conf.slurmctld_params,
+				   "agent_batch_workers="))) {
+		workers = atoi(tmp_ptr + 20);
+		if ((workers < 0) || (workers > MAX_AGENT_BATCH_WORKERS)) {
+			error("Invalid SlurmctldParameters agent_batch_workers=%d, batching disabled",
+			      workers);
+			workers = 0;
+		}
+	}
+	slurm_mutex_lock(&batch_mutex);
+	if (workers && !batch_workq) {
+		batch_workq = new_workq(workers);
+		verbose("%s: batching single node RPCs with %d workers",
+			__func__, workers);
+	}
+	slurm_mutex_unlock(&batch_mutex);
+
 	slurm_thread_create_detached(NULL, _agent_init, NULL);
 	pending_thread_running = true;
 	slurm_mutex_unlock(&pending_mutex);
@@ -1510,6 +1545,121 @@ pack_it:
 	packstr_array(rpc_host_list, rpc_count, buffer);
 }
 
+static void _batch_id(void *item, const char **key, uint32_t *key_len)
+{
+	agent_batch_t *batch = item;
+
+	*key = batch->node_name;
+	*key_len = strlen(batch->node_name);
+}
+
+static void _batch_free(void *x)
+{
+	agent_batch_t *batch = x;
+
+	if (!batch)
+		return;
+	FREE_NULL_LIST(batch->agent_args);
+	free(batch->node_name);
+	xfree(batch);
+}
+
+static void _batch_list_delete(void *x)
+{
+	_purge_agent_args(x);
+}
+
+/*
+ * Could this request be sent together with others to the same node? Only
+ * single node job termination RPCs are batched. They come in bursts as
+ * jobs end and have no ordering constraint relative to other RPC types.
+ */
+static bool _batchable(agent_arg_t *agent_arg_ptr)
+{
+	if (agent_arg_ptr->addr || (agent_arg_ptr->node_count != 1))
+		return false;
+
+	switch (agent_arg_ptr->msg_type) {
+	case REQUEST_ABORT_JOB:
+	case REQUEST_KILL_PREEMPTED:
+	case REQUEST_KILL_TIMELIMIT:
+	case REQUEST_TERMINATE_JOB:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* Send one node's requests from a batch worker, one after the other */
+static void _agent_batch_work(void *x)
+{
+	agent_batch_t *batch = x;
+	agent_arg_t *agent_arg_ptr;
+
+	log_flag(AGENT, "%s: sending %d RPCs to node %s",
+		 __func__, list_count(batch->agent_args), batch->node_name);
+	while ((agent_arg_ptr = list_pop(batch->agent_args)))
+		(void) agent(agent_arg_ptr);
+	_batch_free(batch);
+}
+
+/*
+ * Hand the single node RPCs queued since the last tick to the batch workers,
+ * grouped by node. Each node's RPCs are then sent by one worker rather than
+ * by a new agent thread each, and at most agent_batch_workers nodes are
+ * being contacted at once.
+ */
+static void _agent_batch(void)
+{
+	List work_list, node_batches;
+	agent_arg_t *agent_arg_ptr;
+	agent_batch_t *batch;
+	xhash_t *batch_hash;
+	workq_t *workq;
+	char *node_name;
+
+	slurm_mutex_lock(&batch_mutex);
+	if (!batch_list || !list_count(batch_list)) {
+		slurm_mutex_unlock(&batch_mutex);
+		return;
+	}
+	work_list = batch_list;
+	batch_list = NULL;
+	workq = batch_workq;
+	slurm_mutex_unlock(&batch_mutex);
+
+	batch_hash = xhash_init(_batch_id, NULL);
+	node_batches = list_create(NULL);
+	while ((agent_arg_ptr = list_pop(work_list))) {
+		node_name = hostlist_nth(agent_arg_ptr->hostlist, 0);
+		if (!node_name) {
+			_purge_agent_args(agent_arg_ptr);
+			continue;
+		}
+		if ((batch = xhash_get_str(batch_hash, node_name))) {
+			free(node_name);
+		} else {
+			batch = xmalloc(sizeof(*batch));
+			batch->node_name = node_name;
+			batch->agent_args = list_create(_batch_list_delete);
+			xhash_add(batch_hash, batch);
+			list_append(node_batches, batch);
+		}
+		list_append(batch->agent_args, agent_arg_ptr);
+	}
+	xhash_free(batch_hash);
+	FREE_NULL_LIST(work_list);
+
+	log_flag(AGENT, "%s: batched RPCs for %d nodes",
+		 __func__, list_count(node_batches));
+	while ((batch = list_pop(node_batches))) {
+		if (workq_add_work(workq, _agent_batch_work, batch,
+				   "agent_batch") != SLURM_SUCCESS)
+			_batch_free(batch);
+	}
+	FREE_NULL_LIST(node_batches);
+}
+
 static void _agent_defer(void)
 {
 	int rc = -1;
@@ -1575,7 +1725,6 @@ static void _agent_retry(int min_wait, bool mail_too)
 	queued_request_t *queued_req_ptr = NULL;
 	agent_arg_t *agent_arg_ptr = NULL;
 	ListIterator retry_iter;
-	mail_info_t *mi = NULL;
 
 	slurm_mutex_lock(&retry_mutex);
 	if (retry_list) {
@@ -1654,15 +1803,21 @@ static void _agent_retry(int min_wait, bool mail_too)
 		} else
 			error("agent_retry found record with no agent_args");
 	} else if (mail_too) {
+		/*
+		 * Each thread sends a batch of messages in turn, so a slow
+		 * MailProg only delays the rest of its own batch
+		 */
 		slurm_mutex_lock(&agent_cnt_mutex);
 		slurm_mutex_lock(&mail_mutex);
-		while (mail_list && (agent_thread_cnt < MAX_SERVER_THREADS)) {
-			mi = (mail_info_t *) list_dequeue(mail_list);
-			if (!mi)
-				break;
+		while (mail_list && list_count(mail_list) &&
+		       (agent_thread_cnt < MAX_SERVER_THREADS)) {
+			List mail_batch = list_create(_mail_free);
 
+			(void) list_transfer_max(mail_batch, mail_list,
+						 MAIL_BATCH_SIZE);
 			agent_thread_cnt++;
-			slurm_thread_create_detached(NULL, _mail_proc, mi);
+			slurm_thread_create_detached(NULL, _mail_proc,
+						     mail_batch);
 		}
 		slurm_mutex_unlock(&mail_mutex);
 		slurm_mutex_unlock(&agent_cnt_mutex);
@@ -1708,6 +1863,13 @@ void agent_queue_request(agent_arg_t *agent_arg_ptr)
 			defer_list = list_create(_list_delete_retry);
 		list_append(defer_list, (void *)queued_req_ptr);
 		slurm_mutex_unlock(&defer_mutex);
+	} else if (batch_workq && _batchable(agent_arg_ptr)) {
+		xfree(queued_req_ptr);
+		slurm_mutex_lock(&batch_mutex);
+		if (batch_list == NULL)
+			batch_list = list_create(_batch_list_delete);
+		list_append(batch_list, agent_arg_ptr);
+		slurm_mutex_unlock(&batch_mutex);
 	} else {
 		slurm_mutex_lock(&retry_mutex);
 		if (retry_list == NULL)
@@ -1740,6 +1902,10 @@ extern void agent_purge(void)
 		FREE_NULL_LIST(mail_list);
 		slurm_mutex_unlock(&mail_mutex);
 	}
+	slurm_mutex_lock(&batch_mutex);
+	FREE_NULL_LIST(batch_list);
+	FREE_NULL_WORKQ(batch_workq);
+	slurm_mutex_unlock(&batch_mutex);
 
 	xfree(rpc_stat_counts);
 	xfree(rpc_stat_types);
@@ -1852,35 +2018,60 @@ static char **_build_mail_env(void)
 	return my_env;
 }
 
-/* process an email request and free the record */
-static void *_mail_proc(void *arg)
+/*
+ * Run MailProg for one email request. The child only rearranges its file
+ * descriptors before calling execle(), so vfork() avoids copying the page
+ * tables of slurmctld for every message.
+ */
+static void _mail_send(mail_info_t *mi, char *mail_prog, char **my_env)
 {
-	mail_info_t *mi = (mail_info_t *) arg;
 	pid_t pid;
+	int status = 0;
 
-	pid = fork();
+	pid = vfork();
 	if (pid < 0) {		/* error */
 		error("fork(): %m");
 	} else if (pid == 0) {	/* child */
-		int fd_0, fd_1, fd_2, i;
-		char **my_env = NULL;
-		my_env = _build_mail_env();
+		int fd_0, i;
 		for (i = 0; i < 1024; i++)
 			(void) close(i);
-		if ((fd_0 = open("/dev/null", O_RDWR)) == -1)	// fd = 0
-			error("Couldn't open /dev/null: %m");
-		if ((fd_1 = dup(fd_0)) == -1)			// fd = 1
-			error("Couldn't do a dup on fd 1: %m");
-		if ((fd_2 = dup(fd_0)) == -1)			// fd = 2
-			error("Couldn't do a dup on fd 2 %m");
-		execle(slurm_conf.mail_prog, "mail", "-s", mi->message,
+		if ((fd_0 = open("/dev/null", O_RDWR)) != -1) {	// fd = 0
+			(void) dup(fd_0);			// fd = 1
+			(void) dup(fd_0);			// fd = 2
+		}
+		execle(mail_prog, "mail", "-s", mi->message,
 		       mi->user_name, NULL, my_env);
-		error("Failed to exec %s: %m", slurm_conf.mail_prog);
-		exit(1);
+		/*
+		 * Nothing which is not async-signal-safe after vfork(), the
+		 * parent logs the failure
+		 */
+		_exit(127);
 	} else {		/* parent */
-		waitpid(pid, NULL, 0);
+		if ((waitpid(pid, &status, 0) == pid) &&
+		    WIFEXITED(status) && (WEXITSTATUS(status) == 127))
+			error("Failed to exec %s", mail_prog);
 	}
-	_mail_free(mi);
+}
+
+/* process a list of email requests and free it */
+static void *_mail_proc(void *arg)
+{
+	List mail_batch = (List) arg;
+	mail_info_t *mi;
+	char **my_env = _build_mail_env();
+	char *mail_prog = xstrdup(slurm_conf.mail_prog);
+	int i;
+
+	while ((mi = list_dequeue(mail_batch))) {
+		_mail_send(mi, mail_prog, my_env);
+		_mail_free(mi);
+	}
+	FREE_NULL_LIST(mail_batch);
+	xfree(mail_prog);
+	for (i = 0; my_env[i]; i++)
+		xfree(my_env[i]);
+	xfree(my_env);
+
 	slurm_mutex_lock(&agent_cnt_mutex);
 	if (agent_thread_cnt)
 		agent_thread_cnt--;
@@ -2223,9 +2414,13 @@ static int _signal_defer(queued_request_t *queued_req_ptr)
 /* Return length of agent's retry_list */
 extern int retry_list_size(void)
 {
-	if (retry_list == NULL)
-		return 0;
-	return list_count(retry_list);
+	int cnt = 0;
+
+	if (retry_list)
+		cnt += list_count(retry_list);
+	if (batch_list)
+		cnt += list_count(batch_list);
+	return cnt;
 }
 
 static void _reboot_from_ctld(agent_arg_t *agent_arg_ptr)
@@ -103,6 +103,7 @@
 #include "src/slurmctld/gang.h"
 #include "src/slurmctld/heartbeat.h"
 #include "src/slurmctld/job_scheduler.h"
+#include "src/slurmctld/job_snapshot.h"
 #include "src/slurmctld/job_submit.h"
 #include "src/slurmctld/licenses.h"
 #include "src/slurmctld/locks.h"
@@ -112,8 +113,10 @@
 #include "src/slurmctld/powercapping.h"
 #include "src/slurmctld/preempt.h"
 #include "src/slurmctld/proc_req.h"
+#include "src/slurmctld/rate_limit.h"
 #include "src/slurmctld/read_config.h"
 #include "src/slurmctld/reservation.h"
+#include "src/slurmctld/rpc_mgr.h"
 #include "src/slurmctld/sched_plugin.h"
 #include "src/slurmctld/slurmctld.h"
 #include "src/slurmctld/slurmctld_plugstack.h"
@@ -131,7 +134,6 @@
 #define MIN_CHECKIN_TIME  3	/* Nodes have this number of seconds to
 				 * check-in before we ping them */
 #define SHUTDOWN_WAIT     2	/* Time to wait for backup server shutdown */
-#define JOB_COUNT_INTERVAL 30   /* Time to update running job count */
 
 /**************************************************************************\
  * To test for memory leaks, set MEMORY_LEAK_DEBUG to 1 using
@@ -254,7 +256,6 @@ static void *       _slurmctld_signal_hand(void *no_data);
 static void         _test_thread_limit(void);
 static void         _update_assoc(slurmdb_assoc_rec_t *rec);
 inline static void  _update_cred_key(void);
-static void         _update_diag_job_state_counts(void);
 static void         _update_cluster_tres(void);
 static void         _update_nice(void);
 static void         _update_qos(slurmdb_qos_rec_t *rec);
@@ -885,6 +886,8 @@ int main(int argc, char **argv)
 	configless_clear();
 	xcgroup_fini_slurm_cgroup_conf();
 	power_save_fini();
+	job_snapshot_fini();
+	rate_limit_fini();
 	job_fini();
 	part_fini();	/* part_fini() must precede node_fini() */
 	node_fini();
@@ -1179,6 +1182,15 @@ static void *_slurmctld_rpc_mgr(void *no_data)
 	xsignal(SIGUSR1, _sig_handler);
 	xsignal_unblock(sigarray);
 
+	if (rpc_mgr_enabled()) {
+		int *listen_fds = xcalloc(nports, sizeof(int));
+
+		for (i = 0; i < nports; i++)
+			listen_fds[i] = fds[i].fd;
+		rpc_mgr_run(listen_fds, nports, max_server_threads);
+		xfree(listen_fds);
+	}
+
 	/*
 	 * Process incoming RPCs until told to shutdown
 	 */
@@ -2225,13 +2237,6 @@ static void *_slurmctld_background(void *no_data)
 			_accounting_cluster_ready();
 		}
 
-		if (difftime(now, slurmctld_diag_stats.job_states_ts) >=
-		    JOB_COUNT_INTERVAL) {
-			lock_slurmctld(job_read_lock);
-			_update_diag_job_state_counts();
-			unlock_slurmctld(job_read_lock);
-		}
-
 		/* Stats will reset at midnight (approx) local time. */
 		if (last_proc_req_start == 0) {
 			last_proc_req_start = now;
@@ -3413,30 +3418,6 @@ static void _get_fed_updates(void)
 	FREE_NULL_LIST(fed_list);
 }
 
-static int _foreach_job_running(void *object, void *arg)
-{
-	job_record_t *job_ptr = (job_record_t *)object;
-
-	if (IS_JOB_PENDING(job_ptr)) {
-		int job_cnt = (job_ptr->array_recs &&
-			       job_ptr->array_recs->task_cnt) ?
-			job_ptr->array_recs->task_cnt : 1;
-		slurmctld_diag_stats.jobs_pending += job_cnt;
-	}
-	if (IS_JOB_RUNNING(job_ptr))
-		slurmctld_diag_stats.jobs_running++;
-
-	return SLURM_SUCCESS;
-}
-
-static void _update_diag_job_state_counts(void)
-{
-	slurmctld_diag_stats.jobs_running = 0;
-	slurmctld_diag_stats.jobs_pending = 0;
-	slurmctld_diag_stats.job_states_ts = time(NULL);
-	list_for_each(job_list, _foreach_job_running, NULL);
-}
-
 static void *_wait_primary_prog(void *arg)
 {
 	primary_thread_arg_t *wait_arg = (primary_thread_arg_t *) arg;
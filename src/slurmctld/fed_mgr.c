@@ -5439,9 +5439,32 @@ extern int fed_mgr_update_job_cluster_features(job_record_t *job_ptr,
 	return rc;
 }
 
+static int _sort_remote_job_id(const void *x, const void *y)
+{
+	const slurm_job_info_t *job1 = x;
+	const slurm_job_info_t *job2 = y;
+
+	if (job1->job_id < job2->job_id)
+		return -1;
+	if (job1->job_id > job2->job_id)
+		return 1;
+	return 0;
+}
+
+static int _cmp_remote_job_id(const void *key, const void *x)
+{
+	const uint32_t *job_id = key;
+	const slurm_job_info_t *job = x;
+
+	if (*job_id < job->job_id)
+		return -1;
+	if (*job_id > job->job_id)
+		return 1;
+	return 0;
+}
+
 static int _reconcile_fed_job(job_record_t *job_ptr, reconcile_sib_t *rec_sib)
 {
-	int i;
 	bool found_job = false;
 	job_info_msg_t *remote_jobs_ptr = rec_sib->job_info_msg;
 	uint32_t origin_id    = fed_mgr_get_cluster_id(job_ptr->job_id);
@@ -5470,13 +5493,12 @@ static int _reconcile_fed_job(job_record_t *job_ptr, reconcile_sib_t *rec_sib)
 		return SLURM_SUCCESS;
 	}
 
-	for (i = 0; i < remote_jobs_ptr->record_count; i++) {
-		remote_job = &remote_jobs_ptr->job_array[i];
-		if (job_ptr->job_id == remote_job->job_id) {
-			found_job = true;
-			break;
-		}
-	}
+	/* job_array was sorted by _sync_jobs() */
+	remote_job = bsearch(&job_ptr->job_id, remote_jobs_ptr->job_array,
+			     remote_jobs_ptr->record_count,
+			     sizeof(slurm_job_info_t), _cmp_remote_job_id);
+	if (remote_job)
+		found_job = true;
 
 	/* Jobs that originated on the remote sibling */
 	if (origin_id == sibling_id) {
@@ -5729,6 +5751,11 @@ static int _sync_jobs(const char *sib_name, job_info_msg_t *job_info_msg,
 	rec_sib.job_info_msg = job_info_msg;
 	rec_sib.sync_time    = sync_time;
 
+	/* Sort once so each local job's lookup is a binary search */
+	if (job_info_msg->record_count > 1)
+		qsort(job_info_msg->job_array, job_info_msg->record_count,
+		      sizeof(slurm_job_info_t), _sort_remote_job_id);
+
 	itr = list_iterator_create(job_list);
 	while ((job_ptr = list_next(itr)))
 		_reconcile_fed_job(job_ptr, &rec_sib);
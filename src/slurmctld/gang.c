@@ -1413,26 +1413,33 @@ static void _build_active_row(struct gs_part *p_ptr)
  */
 static void _cycle_job_list(struct gs_part *p_ptr)
 {
-	int i, j;
-	struct gs_job *j_ptr;
+	int i, j, active_cnt = 0;
+	struct gs_job *j_ptr, **active_list;
 	uint16_t preempt_mode;
 
 	log_flag(GANG, "gang: entering %s", __func__);
-	/* re-prioritize the job_list and set all row_states to GS_NO_ACTIVE */
-	for (i = 0; i < p_ptr->num_jobs; i++) {
-		while (p_ptr->job_list[i]->row_state == GS_ACTIVE) {
-			/* move this job to the back row and "deactivate" it */
-			j_ptr = p_ptr->job_list[i];
+	/*
+	 * re-prioritize the job_list and set all row_states to GS_NO_ACTIVE:
+	 * active jobs move to the back of the list, preserving their order
+	 * among each other. This is done in a single pass rather than by
+	 * shifting the list down once per active job.
+	 */
+	active_list = xcalloc(p_ptr->num_jobs, sizeof(struct gs_job *));
+	for (i = 0, j = 0; i < p_ptr->num_jobs; i++) {
+		j_ptr = p_ptr->job_list[i];
+		if (j_ptr->row_state == GS_ACTIVE)
+			active_list[active_cnt++] = j_ptr;
+		else
+			p_ptr->job_list[j++] = j_ptr;
+		if ((j_ptr->row_state == GS_ACTIVE) ||
+		    (j_ptr->row_state == GS_FILLER))
 			j_ptr->row_state = GS_NO_ACTIVE;
-			for (j = i; j+1 < p_ptr->num_jobs; j++) {
-				p_ptr->job_list[j] = p_ptr->job_list[j+1];
-			}
-			p_ptr->job_list[j] = j_ptr;
-		}
-		if (p_ptr->job_list[i]->row_state == GS_FILLER)
-			p_ptr->job_list[i]->row_state = GS_NO_ACTIVE;
-
 	}
+	if (active_cnt) {
+		memcpy(p_ptr->job_list + j, active_list,
+		       active_cnt * sizeof(struct gs_job *));
+	}
+	xfree(active_list);
 	log_flag(GANG, "gang: %s reordered job list:", __func__);
 	/* Rebuild the active row. */
 	_build_active_row(p_ptr);
@@ -84,6 +84,7 @@
 #include "src/common/tres_frequency.h"
 #include "src/common/uid.h"
 #include "src/common/xassert.h"
+#include "src/common/xhash.h"
 #include "src/common/xstring.h"
 
 #include "src/slurmctld/acct_policy.h"
@@ -117,6 +118,7 @@
 #define JOB_HASH_INX(_job_id)	(_job_id % hash_table_size)
 #define JOB_ARRAY_HASH_INX(_job_id, _task_id) \
 	((_job_id + _task_id) % hash_table_size)
+#define JOB_USER_HASH_INX(_user_id)	(_user_id % hash_table_size)
 
 /* No need to change we always pack SLURM_PROTOCOL_VERSION */
 #define JOB_STATE_VERSION     "PROTOCOL_VERSION"
@@ -126,6 +128,7 @@ typedef enum {
 	JOB_HASH_JOB,
 	JOB_HASH_ARRAY_JOB,
 	JOB_HASH_ARRAY_TASK,
+	JOB_HASH_USER,
 } job_hash_type_t;
 
 typedef struct {
@@ -149,6 +152,22 @@ typedef struct {
 	int rc;
 } job_overlap_args_t;
 
+/* Last record saved for a job, see _dump_job_state_journal() */
+typedef struct {
+	uint32_t job_id;
+	uint64_t hash;		/* of the packed job record */
+	uint64_t prev_hash;	/* hash before the current save */
+	uint32_t gen;		/* journal_gen of last save with this job */
+	uint32_t offset;	/* of record in journal file, only on load */
+	bool deleted;		/* record is a deletion, only on load */
+} journal_rec_t;
+
+/* Shared copy of a string used by many job records, see _intern_account() */
+typedef struct {
+	char *str;
+	uint32_t refcnt;
+} intern_str_t;
+
 /* Global variables */
 List   job_list = NULL;		/* job_record list */
 time_t last_job_update;		/* time of last update to job records */
@@ -166,8 +185,17 @@ static uint32_t job_id_sequence = 0;	/* first job_id to assign new job */
 static struct   job_record **job_hash = NULL;
 static struct   job_record **job_array_hash_j = NULL;
 static struct   job_record **job_array_hash_t = NULL;
+static struct   job_record **job_user_hash = NULL;
 static bool     kill_invalid_dep;
 static time_t   last_file_write_time = (time_t) 0;
+static xhash_t *account_hash = NULL;	/* intern_str_t by account name */
+static pthread_mutex_t account_hash_mutex = PTHREAD_MUTEX_INITIALIZER;
+static xhash_t *journal_hash = NULL;	/* journal_rec_t by job_id */
+static uint32_t journal_gen = 0;
+static uint32_t job_array_split_cnt = 0;	/* see _dump_job_yield() */
+static uint32_t journal_size = 0;	/* bytes in job_state.journal */
+static uint32_t journal_snap_size = 0;	/* bytes in job_state */
+static bool     journal_snap_needed = true;
 static uint32_t max_array_size = NO_VAL;
 static bitstr_t *requeue_exit = NULL;
 static bitstr_t *requeue_exit_hold = NULL;
@@ -175,6 +203,7 @@ static bool     validate_cfgd_licenses = true;
 
 /* Local functions */
 static void _add_job_hash(job_record_t *job_ptr);
+static void _add_job_user_hash(job_record_t *job_ptr);
 static void _add_job_array_hash(job_record_t *job_ptr);
 static void _clear_job_gres_details(job_record_t *job_ptr);
 static int  _copy_job_desc_to_file(job_desc_msg_t * job_desc,
@@ -192,16 +221,27 @@ static slurmdb_qos_rec_t *_determine_and_validate_qos(
 	bool locked, log_level_t log_lvl);
 static void _dump_job_details(struct job_details *detail_ptr, Buf buffer);
 static void _dump_job_state(job_record_t *dump_job_ptr, Buf buffer);
+static int _dump_job_state_journal(void);
+static bool _journal_enabled(void);
+static bool _dump_job_yield(slurmctld_lock_t *lock, int yield_cnt,
+			    int *pack_cnt);
+static bool _journal_note_job(uint32_t job_id, Buf buffer, uint32_t offset);
+static uint32_t _journal_purge_gone(Buf buffer);
+static void _journal_restart(void);
+static int _journal_replay(time_t snap_time);
+static int _journal_reset(time_t snap_time);
+static bool _journal_snap_due(void);
 static void _dump_job_fed_details(job_fed_details_t *fed_details_ptr,
 				  Buf buffer);
 static job_fed_details_t *_dup_job_fed_details(job_fed_details_t *src);
-static void _get_batch_job_dir_ids(List batch_dirs);
+static void _get_batch_job_dir_ids(List batch_dirs, List script_blobs);
 static bool _get_whole_hetjob(void);
 static void _job_array_comp(job_record_t *job_ptr, bool was_running,
 			    bool requeue);
 static int  _job_create(job_desc_msg_t * job_specs, int allocate, int will_run,
 			job_record_t **job_rec_ptr, uid_t submit_uid,
 			char **err_msg, uint16_t protocol_version);
+static void _job_delta_purged(job_record_t *job_ptr);
 static void _job_timed_out(job_record_t *job_ptr, bool preempted);
 static void _kill_dependent(job_record_t *job_ptr);
 static void _list_delete_job(void *job_entry);
@@ -224,6 +264,7 @@ static void _pack_pending_job_details(struct job_details *detail_ptr,
 				      uint16_t protocol_version);
 static bool _parse_array_tok(char *tok, bitstr_t *array_bitmap, uint32_t max);
 static void _purge_missing_jobs(int node_inx, time_t now);
+static int  _purge_script_blob(void *x, void *arg);
 static int  _read_data_array_from_file(int fd, char *file_name, char ***data,
 				       uint32_t *size, job_record_t *job_ptr);
 static void _remove_defunct_batch_dirs(List batch_dirs);
@@ -584,6 +625,67 @@ static job_array_resp_msg_t *_resp_array_xlate(resp_array_struct_t *resp,
 	return msg;
 }
 
+static void _intern_str_id(void *item, const char **key, uint32_t *key_len)
+{
+	intern_str_t *intern = item;
+
+	*key = intern->str;
+	*key_len = strlen(intern->str);
+}
+
+static void _intern_str_free(void *item)
+{
+	intern_str_t *intern = item;
+
+	xfree(intern->str);
+	xfree(intern);
+}
+
+/*
+ * Return a shared reference to the given account name. A few hundred
+ * accounts are typically spread over all job records, so keep a single
+ * refcounted copy of each rather than one per job. The returned string
+ * must not be modified and must be released with _release_account().
+ */
+static char *_intern_account(const char *account)
+{
+	intern_str_t *intern;
+
+	if (!account)
+		return NULL;
+
+	slurm_mutex_lock(&account_hash_mutex);
+	if (!account_hash)
+		account_hash = xhash_init(_intern_str_id, _intern_str_free);
+	if (!(intern = xhash_get_str(account_hash, account))) {
+		intern = xmalloc(sizeof(*intern));
+		intern->str = xstrdup(account);
+		xhash_add(account_hash, intern);
+	}
+	intern->refcnt++;
+	slurm_mutex_unlock(&account_hash_mutex);
+
+	return intern->str;
+}
+
+/* Drop a reference from _intern_account() and clear the pointer */
+static void _release_account(char **account)
+{
+	intern_str_t *intern;
+
+	if (!*account)
+		return;
+
+	slurm_mutex_lock(&account_hash_mutex);
+	intern = xhash_get_str(account_hash, *account);
+	xassert(intern && (intern->str == *account));
+	if (intern && !--intern->refcnt)
+		xhash_delete_str(account_hash, *account);
+	slurm_mutex_unlock(&account_hash_mutex);
+
+	*account = NULL;
+}
+
 /*
  * _create_job_record - create an empty job_record including job_details.
  *	load its values with defaults (zeros, nulls, and magic cookie)
@@ -679,6 +781,52 @@ static void _delete_job_details(job_record_t *job_entry)
 	xfree(job_entry->details);	/* Must be last */
 }
 
+/*
+ * Batch scripts are often identical across many jobs. Each script is also
+ * hard linked as hash.<N>/script.<content hash> so that later jobs with the
+ * same script can link to it rather than write another copy. The link count
+ * of the file serves as its reference count.
+ */
+static char *_script_blob_name(const char *script, size_t len)
+{
+	const unsigned char *p = (const unsigned char *) script;
+	uint64_t sig = 14695981039346656037ULL;
+
+	/* FNV-1a */
+	while (len--) {
+		sig ^= *p++;
+		sig *= 1099511628211ULL;
+	}
+
+	return xstrdup_printf("%s/hash.%d/script.%016"PRIx64,
+			      slurm_conf.state_save_location,
+			      (int) (sig % 10), sig);
+}
+
+/*
+ * Remove the shared copy of a job's script if no other job is linked to it
+ * IN file_name - the job's script file, about to be removed
+ */
+static void _unlink_script_blob(char *file_name)
+{
+	struct stat job_stat, blob_stat;
+	char *blob_name;
+	Buf buf;
+
+	if (stat(file_name, &job_stat) || (job_stat.st_nlink != 2))
+		return;
+	if (!(buf = create_mmap_buf(file_name)))
+		return;
+	blob_name = _script_blob_name(get_buf_data(buf), size_buf(buf));
+	free_buf(buf);
+
+	if (!stat(blob_name, &blob_stat) &&
+	    (blob_stat.st_dev == job_stat.st_dev) &&
+	    (blob_stat.st_ino == job_stat.st_ino))
+		(void) unlink(blob_name);
+	xfree(blob_name);
+}
+
 /*
  * delete_job_desc_files - delete job descriptor related files
  *
@@ -709,6 +857,8 @@ extern void delete_job_desc_files(uint32_t job_id)
 				continue;
 			xstrfmtcat(file_name, "%s/%s", dir_name,
 				   dir_ent->d_name);
+			if (!xstrcmp(dir_ent->d_name, "script"))
+				_unlink_script_blob(file_name);
 			(void) unlink(file_name);
 			xfree(file_name);
 		}
@@ -811,12 +961,19 @@ int dump_all_job_state(void)
 		{ READ_LOCK, READ_LOCK, NO_LOCK, NO_LOCK, NO_LOCK };
 	ListIterator job_iterator;
 	job_record_t *job_ptr;
-	Buf buffer = init_buf(high_buffer_size);
+	Buf buffer;
 	time_t now = time(NULL);
 	time_t last_state_file_time;
+	bool journal = _journal_enabled();
+	int yield_cnt, pack_cnt = 0;
+	uint32_t rec_offset;
 	DEF_TIMERS;
 
+	if (journal && !_journal_snap_due())
+		return _dump_job_state_journal();
+
 	START_TIMER;
+	buffer = init_buf(high_buffer_size);
 	/*
 	 * Check that last state file was written at expected time.
 	 * This is a check for two slurmctld daemons running at the same
@@ -853,11 +1010,29 @@ int dump_all_job_state(void)
 
 	/* write individual job records */
 	lock_slurmctld(job_read_lock);
+	if (journal)
+		journal_gen++;
+	yield_cnt = state_save_yield_cnt();
+	rec_offset = get_buf_offset(buffer);
 	job_iterator = list_iterator_create(job_list);
 	while ((job_ptr = list_next(job_iterator))) {
+		uint32_t offset = get_buf_offset(buffer);
 		_dump_job_state(job_ptr, buffer);
+		if (journal)
+			(void) _journal_note_job(job_ptr->job_id, buffer,
+						 offset);
+		if (_dump_job_yield(&job_read_lock, yield_cnt, &pack_cnt)) {
+			/* Start over, holding the locks throughout */
+			yield_cnt = 0;
+			set_buf_offset(buffer, rec_offset);
+			if (journal)
+				_journal_restart();
+			list_iterator_reset(job_iterator);
+		}
 	}
 	list_iterator_destroy(job_iterator);
+	if (journal)
+		_journal_purge_gone(NULL);
 
 
 	/* write the buffer to file */
@@ -925,7 +1100,13 @@ int dump_all_job_state(void)
 			       new_file, reg_file);
 		(void) unlink(new_file);
 		last_file_write_time = now;
+		if (journal) {
+			journal_snap_size = get_buf_offset(buffer);
+			error_code = _journal_reset(now);
+		}
 	}
+	if (error_code)
+		journal_snap_needed = true;
 	xfree(old_file);
 	xfree(reg_file);
 	xfree(new_file);
@@ -936,6 +1117,440 @@ int dump_all_job_state(void)
 	return error_code;
 }
 
+/*
+ * Job state journal, SlurmctldParameters=job_state_journal
+ *
+ * Rather than rewriting every job record in job_state each time job state
+ * is saved, only the records which changed since the last save are appended
+ * to job_state.journal. A record changed if a hash of its packed form
+ * differs from the one saved last time. A full job_state is written again,
+ * and the journal started over, once the journal grows to half the size of
+ * job_state. load_all_job_state() applies the journal over job_state.
+ *
+ * job_state.journal format:
+ *	header: JOB_STATE_VERSION, protocol version, time of job_state header
+ *	one segment per save: uint32_t size of the rest of the segment, time,
+ *	job_id_sequence, count of updated jobs, count of removed jobs, then
+ *	(job_id, record size, _dump_job_state() record) for every updated job
+ *	and job_id for every removed job.
+ * A segment which was not completely written is ignored.
+ */
+static bool _journal_enabled(void)
+{
+	return (xstrcasestr(slurm_conf.slurmctld_params,
+			    "job_state_journal") != NULL);
+}
+
+static bool _journal_snap_due(void)
+{
+	return (journal_snap_needed || !journal_hash ||
+		(journal_size > (journal_snap_size / 2)));
+}
+
+static void _journal_rec_id(void *item, const char **key, uint32_t *key_len)
+{
+	journal_rec_t *rec = item;
+
+	*key = (const char *) &rec->job_id;
+	*key_len = sizeof(rec->job_id);
+}
+
+/* FNV-1a */
+static uint64_t _journal_hash_buf(char *data, uint32_t len)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+
+	for (uint32_t i = 0; i < len; i++) {
+		hash ^= (uint8_t) data[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+/*
+ * Note the record of job_id packed into buffer starting at offset.
+ * RET true if the record differs from the one last saved
+ */
+static bool _journal_note_job(uint32_t job_id, Buf buffer, uint32_t offset)
+{
+	journal_rec_t *rec;
+	uint64_t hash;
+
+	if (!journal_hash)
+		journal_hash = xhash_init(_journal_rec_id, xfree_ptr);
+
+	hash = _journal_hash_buf(get_buf_data(buffer) + offset,
+				 get_buf_offset(buffer) - offset);
+	if ((rec = xhash_get(journal_hash, (char *) &job_id,
+			     sizeof(job_id)))) {
+		if (rec->gen != journal_gen)
+			rec->prev_hash = rec->hash;
+		rec->gen = journal_gen;
+		if (rec->hash == hash)
+			return false;
+		rec->hash = hash;
+		return true;
+	}
+
+	rec = xmalloc(sizeof(*rec));
+	rec->job_id = job_id;
+	rec->hash = hash;
+	rec->gen = journal_gen;
+	xhash_add(journal_hash, rec);
+	return true;
+}
+
+typedef struct {
+	Buf buffer;
+	uint32_t cnt;
+	List gone_list;
+} journal_gone_args_t;
+
+static void _journal_find_gone(void *item, void *arg)
+{
+	journal_rec_t *rec = item;
+	journal_gone_args_t *args = arg;
+
+	if (rec->gen == journal_gen)
+		return;
+	if (args->buffer)
+		pack32(rec->job_id, args->buffer);
+	args->cnt++;
+	list_append(args->gone_list, &rec->job_id);
+}
+
+/*
+ * Forget jobs not seen by the current save, packing their job IDs into
+ * buffer if set.
+ * RET count of jobs forgotten
+ */
+static uint32_t _journal_purge_gone(Buf buffer)
+{
+	journal_gone_args_t args = { .buffer = buffer };
+	uint32_t *job_id;
+
+	if (!journal_hash)
+		return 0;
+
+	args.gone_list = list_create(NULL);
+	xhash_walk(journal_hash, _journal_find_gone, &args);
+	while ((job_id = list_pop(args.gone_list)))
+		xhash_delete(journal_hash, (char *) job_id, sizeof(*job_id));
+	FREE_NULL_LIST(args.gone_list);
+
+	return args.cnt;
+}
+
+static void _journal_restore_hash(void *item, void *arg)
+{
+	journal_rec_t *rec = item;
+
+	if (rec->gen == journal_gen)
+		rec->hash = rec->prev_hash;
+}
+
+/*
+ * Forget the hashes noted by a save that is being started over, so records
+ * changed since the last completed save are written again
+ */
+static void _journal_restart(void)
+{
+	if (journal_hash)
+		xhash_walk(journal_hash, _journal_restore_hash, NULL);
+	journal_gen++;
+}
+
+static int _journal_write(char *file_name, int flags, Buf buffer)
+{
+	int fd, rc = SLURM_SUCCESS;
+
+	fd = open(file_name, flags | O_WRONLY | O_CREAT | O_CLOEXEC, 0600);
+	if (fd < 0) {
+		error("Can't save state, open file %s error %m", file_name);
+		return errno;
+	}
+	safe_write(fd, get_buf_data(buffer), get_buf_offset(buffer));
+	return fsync_and_close(fd, "job journal");
+
+rwfail:
+	error("Error writing file %s, %m", file_name);
+	rc = errno;
+	(void) close(fd);
+	return rc;
+}
+
+/* Start a new journal for the job_state file written at snap_time */
+static int _journal_reset(time_t snap_time)
+{
+	char *journal_file, *new_file;
+	Buf buffer = init_buf(BUF_SIZE);
+	int rc;
+
+	packstr(JOB_STATE_VERSION, buffer);
+	pack16(SLURM_PROTOCOL_VERSION, buffer);
+	pack_time(snap_time, buffer);
+
+	journal_file = xstrdup_printf("%s/job_state.journal",
+				      slurm_conf.state_save_location);
+	new_file = xstrdup_printf("%s.new", journal_file);
+	/* Caller holds lock_state_files() */
+	if (!(rc = _journal_write(new_file, O_TRUNC, buffer)) &&
+	    rename(new_file, journal_file)) {
+		error("Can't rename %s to %s: %m", new_file, journal_file);
+		rc = errno;
+	}
+	if (rc)
+		(void) unlink(new_file);
+	else {
+		journal_size = get_buf_offset(buffer);
+		journal_snap_needed = false;
+	}
+
+	xfree(journal_file);
+	xfree(new_file);
+	free_buf(buffer);
+	return rc;
+}
+
+/* Append the job records changed since the last save to the journal */
+static int _dump_job_state_journal(void)
+{
+	static int high_buffer_size = BUF_SIZE;
+	/* Locks: Read config and job */
+	slurmctld_lock_t job_read_lock =
+		{ READ_LOCK, READ_LOCK, NO_LOCK, NO_LOCK, NO_LOCK };
+	ListIterator job_iterator;
+	job_record_t *job_ptr;
+	Buf buffer = init_buf(high_buffer_size);
+	uint32_t size_offset, cnt_offset, rec_offset, end_offset;
+	uint32_t update_cnt = 0, remove_cnt = 0;
+	char *journal_file;
+	int error_code, yield_cnt, pack_cnt = 0;
+	DEF_TIMERS;
+
+	START_TIMER;
+	size_offset = get_buf_offset(buffer);
+	pack32(0, buffer);
+	pack_time(time(NULL), buffer);
+
+	lock_slurmctld(job_read_lock);
+	pack32(job_id_sequence, buffer);
+	cnt_offset = get_buf_offset(buffer);
+	pack32(update_cnt, buffer);
+	pack32(remove_cnt, buffer);
+
+	journal_gen++;
+	yield_cnt = state_save_yield_cnt();
+	job_iterator = list_iterator_create(job_list);
+	while ((job_ptr = list_next(job_iterator))) {
+		uint32_t start_offset = get_buf_offset(buffer);
+
+		pack32(job_ptr->job_id, buffer);
+		pack32(0, buffer);
+		rec_offset = get_buf_offset(buffer);
+		_dump_job_state(job_ptr, buffer);
+		if (!_journal_note_job(job_ptr->job_id, buffer, rec_offset)) {
+			set_buf_offset(buffer, start_offset);
+		} else {
+			end_offset = get_buf_offset(buffer);
+			set_buf_offset(buffer, rec_offset - sizeof(uint32_t));
+			pack32(end_offset - rec_offset, buffer);
+			set_buf_offset(buffer, end_offset);
+			update_cnt++;
+		}
+		if (_dump_job_yield(&job_read_lock, yield_cnt, &pack_cnt)) {
+			/* Start over, holding the locks throughout */
+			yield_cnt = 0;
+			update_cnt = 0;
+			set_buf_offset(buffer, cnt_offset + 2 * sizeof(uint32_t));
+			_journal_restart();
+			list_iterator_reset(job_iterator);
+		}
+	}
+	list_iterator_destroy(job_iterator);
+	remove_cnt = _journal_purge_gone(buffer);
+	unlock_slurmctld(job_read_lock);
+
+	if (!update_cnt && !remove_cnt) {
+		free_buf(buffer);
+		END_TIMER2("dump_all_job_state");
+		return SLURM_SUCCESS;
+	}
+
+	end_offset = get_buf_offset(buffer);
+	set_buf_offset(buffer, size_offset);
+	pack32(end_offset - size_offset - sizeof(uint32_t), buffer);
+	set_buf_offset(buffer, cnt_offset);
+	pack32(update_cnt, buffer);
+	pack32(remove_cnt, buffer);
+	set_buf_offset(buffer, end_offset);
+	high_buffer_size = MAX(end_offset, high_buffer_size);
+
+	journal_file = xstrdup_printf("%s/job_state.journal",
+				      slurm_conf.state_save_location);
+	lock_state_files();
+	error_code = _journal_write(journal_file, O_APPEND, buffer);
+	unlock_state_files();
+	xfree(journal_file);
+
+	if (error_code) {
+		/* The journal may now end with a partial segment */
+		journal_snap_needed = true;
+	} else {
+		journal_size += end_offset;
+	}
+	debug2("%s: journaled %u changed and %u removed jobs in %u bytes",
+	       __func__, update_cnt, remove_cnt, end_offset);
+
+	free_buf(buffer);
+	END_TIMER2("dump_all_job_state");
+	return error_code;
+}
+
+static int _journal_find_replaced(void *x, void *key)
+{
+	job_record_t *job_ptr = x;
+	xhash_t *replay_hash = key;
+
+	return (xhash_get(replay_hash, (char *) &job_ptr->job_id,
+			  sizeof(job_ptr->job_id)) != NULL);
+}
+
+/*
+ * Apply job_state.journal, if any, over the jobs just loaded from a
+ * job_state file written at snap_time.
+ * RET count of job records loaded from the journal
+ */
+static int _journal_replay(time_t snap_time)
+{
+	char *journal_file, *ver_str = NULL;
+	uint32_t ver_str_len, seg_size, seg_end, update_cnt, remove_cnt;
+	uint32_t job_id, rec_size, saved_job_id, seg_cnt = 0;
+	uint16_t protocol_version = NO_VAL16;
+	time_t buf_time;
+	Buf buffer;
+	xhash_t *replay_hash = NULL;
+	List replay_list = NULL;
+	journal_rec_t *rec;
+	int job_cnt = 0;
+
+	journal_file = xstrdup_printf("%s/job_state.journal",
+				      slurm_conf.state_save_location);
+	lock_state_files();
+	buffer = create_mmap_buf(journal_file);
+	unlock_state_files();
+	if (!buffer) {
+		xfree(journal_file);
+		return 0;
+	}
+
+	safe_unpackstr_xmalloc(&ver_str, &ver_str_len, buffer);
+	if (ver_str && !xstrcmp(ver_str, JOB_STATE_VERSION))
+		safe_unpack16(&protocol_version, buffer);
+	safe_unpack_time(&buf_time, buffer);
+	if ((protocol_version == NO_VAL16) || (buf_time != snap_time)) {
+		info("Ignoring %s, it does not match the job state file",
+		     journal_file);
+		goto fini;
+	}
+
+	replay_hash = xhash_init(_journal_rec_id, NULL);
+	replay_list = list_create(xfree_ptr);
+	while (remaining_buf(buffer) >= sizeof(uint32_t)) {
+		safe_unpack32(&seg_size, buffer);
+		if (seg_size > remaining_buf(buffer)) {
+			error("Ignoring incomplete segment at end of %s",
+			      journal_file);
+			break;
+		}
+		seg_end = get_buf_offset(buffer) + seg_size;
+		safe_unpack_time(&buf_time, buffer);
+		safe_unpack32(&saved_job_id, buffer);
+		if (saved_job_id <= slurm_conf.max_job_id)
+			job_id_sequence = MAX(saved_job_id, job_id_sequence);
+		safe_unpack32(&update_cnt, buffer);
+		safe_unpack32(&remove_cnt, buffer);
+		for (int i = 0; i < (update_cnt + remove_cnt); i++) {
+			safe_unpack32(&job_id, buffer);
+			if (!(rec = xhash_get(replay_hash, (char *) &job_id,
+					      sizeof(job_id)))) {
+				rec = xmalloc(sizeof(*rec));
+				rec->job_id = job_id;
+				xhash_add(replay_hash, rec);
+				list_append(replay_list, rec);
+			}
+			rec->deleted = (i >= update_cnt);
+			if (rec->deleted)
+				continue;
+			safe_unpack32(&rec_size, buffer);
+			rec->offset = get_buf_offset(buffer);
+			if (rec_size > remaining_buf(buffer))
+				goto unpack_error;
+			set_buf_offset(buffer, rec->offset + rec_size);
+		}
+		set_buf_offset(buffer, seg_end);
+		seg_cnt++;
+	}
+
+	/* Drop the job_state records the journal replaces in one pass */
+	(void) list_delete_all(job_list, _journal_find_replaced, replay_hash);
+	while ((rec = list_pop(replay_list))) {
+		if (!rec->deleted) {
+			set_buf_offset(buffer, rec->offset);
+			if (_load_job_state(buffer, protocol_version) !=
+			    SLURM_SUCCESS) {
+				xfree(rec);
+				goto unpack_error;
+			}
+			job_cnt++;
+		}
+		xfree(rec);
+	}
+	FREE_NULL_LIST(replay_list);
+	xhash_free(replay_hash);
+	info("Recovered %u job state journal segments", seg_cnt);
+	goto fini;
+
+unpack_error:
+	if (!ignore_state_errors)
+		fatal("Incomplete job state journal %s, start with '-i' to ignore this. Warning: using -i will lose the data that can't be recovered.",
+		      journal_file);
+	error("Incomplete job state journal %s", journal_file);
+	FREE_NULL_LIST(replay_list);
+	if (replay_hash)
+		xhash_free(replay_hash);
+fini:
+	xfree(ver_str);
+	xfree(journal_file);
+	free_buf(buffer);
+	return job_cnt;
+}
+
+/*
+ * Release and reacquire lock after every yield_cnt job records are packed
+ * so that pending lock requests are not delayed by the entire job state
+ * save (SlurmctldParameters=state_save_yield=#). The records then do not
+ * form a single consistent snapshot. This is harmless for independent
+ * records, but splitting a job array while unlocked can change a record
+ * already packed and add one not yet packed.
+ * RET true if a job array was split while unlocked, the caller must then
+ *	start packing over and not yield again
+ */
+static bool _dump_job_yield(slurmctld_lock_t *lock, int yield_cnt,
+			    int *pack_cnt)
+{
+	uint32_t split_cnt;
+
+	if (!yield_cnt || (++(*pack_cnt) % yield_cnt))
+		return false;
+
+	split_cnt = job_array_split_cnt;
+	unlock_slurmctld(*lock);
+	lock_slurmctld(*lock);
+
+	return (split_cnt != job_array_split_cnt);
+}
+
 static int _find_resv_part(void *x, void *key)
 {
 	slurmctld_resv_t *resv_ptr = (slurmctld_resv_t *) x;
@@ -1070,6 +1685,7 @@ extern void set_job_tres_alloc_str(job_record_t *job_ptr,
 extern void backup_slurmctld_restart(void)
 {
 	last_file_write_time = (time_t) 0;
+	journal_snap_needed = true;
 }
 
 /* Return the time stamp in the current job state save file, 0 is returned on
@@ -1170,6 +1786,7 @@ extern int load_all_job_state(void)
 			goto unpack_error;
 		job_cnt++;
 	}
+	job_cnt += _journal_replay(buf_time);
 	debug3("Set job_id_sequence to %u", job_id_sequence);
 
 	free_buf(buffer);
@@ -2052,10 +2669,10 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 	job_ptr->tres_fmt_req_str = tres_fmt_req_str;
 	tres_fmt_req_str = NULL;
 
-	xfree(job_ptr->account);
-	job_ptr->account = account;
-	xstrtolower(job_ptr->account);
-	account          = NULL;  /* reused, nothing left to free */
+	_release_account(&job_ptr->account);
+	xstrtolower(account);
+	job_ptr->account = _intern_account(account);
+	xfree(account);
 	xfree(job_ptr->alloc_node);
 	job_ptr->alloc_node   = alloc_node;
 	alloc_node             = NULL;	/* reused, nothing left to free */
@@ -2243,6 +2860,7 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 	job_ptr->start_protocol_ver = start_protocol_ver;
 
 	_add_job_hash(job_ptr);
+	_add_job_user_hash(job_ptr);
 	_add_job_array_hash(job_ptr);
 
 	memset(&assoc_rec, 0, sizeof(assoc_rec));
@@ -2763,6 +3381,20 @@ static void _add_job_hash(job_record_t *job_ptr)
 	job_hash[inx] = job_ptr;
 }
 
+/* _add_job_user_hash - add a job user hash entry for given job record,
+ *	user_id must already be set
+ * IN job_ptr - pointer to job record
+ * Globals: hash table updated
+ */
+static void _add_job_user_hash(job_record_t *job_ptr)
+{
+	int inx;
+
+	inx = JOB_USER_HASH_INX(job_ptr->user_id);
+	job_ptr->job_next_user = job_user_hash[inx];
+	job_user_hash[inx] = job_ptr;
+}
+
 /* _remove_job_hash - remove a job hash entry for given job record, job_id must
  *	already be set
  * IN job_ptr - pointer to job record
@@ -2788,6 +3420,10 @@ static void _remove_job_hash(job_record_t *job_entry, job_hash_type_t type)
 			JOB_ARRAY_HASH_INX(job_entry->array_job_id,
 					   job_entry->array_task_id)];
 		break;
+	case JOB_HASH_USER:
+		job_pptr = &job_user_hash[
+			JOB_USER_HASH_INX(job_entry->user_id)];
+		break;
 	default:
 		fatal("%s: unknown job_hash_type_t %d", __func__, type);
 		return;
@@ -2806,6 +3442,9 @@ static void _remove_job_hash(job_record_t *job_entry, job_hash_type_t type)
 		case JOB_HASH_ARRAY_TASK:
 			job_pptr = &job_ptr->job_array_next_t;
 			break;
+		case JOB_HASH_USER:
+			job_pptr = &job_ptr->job_next_user;
+			break;
 		}
 	}
 
@@ -2828,6 +3467,10 @@ static void _remove_job_hash(job_record_t *job_entry, job_hash_type_t type)
 			      job_entry->array_job_id,
 			      job_entry->array_task_id);
 			break;
+		case JOB_HASH_USER:
+			error("%s: job user hash error %pJ UserId=%u",
+			      __func__, job_entry, job_entry->user_id);
+			break;
 		}
 		return;
 	}
@@ -2845,6 +3488,10 @@ static void _remove_job_hash(job_record_t *job_entry, job_hash_type_t type)
 		*job_pptr = job_entry->job_array_next_t;
 		job_entry->job_array_next_t = NULL;
 		break;
+	case JOB_HASH_USER:
+		*job_pptr = job_entry->job_next_user;
+		job_entry->job_next_user = NULL;
+		break;
 	}
 }
 
@@ -3039,6 +3686,49 @@ extern bool test_job_array_pending(uint32_t array_job_id)
 	return false;
 }
 
+/*
+ * Set the results of test_job_array_complete(), test_job_array_completed()
+ * and test_job_array_pending() for a job array with a single pass over its
+ * job records.
+ */
+extern void test_job_array_state(uint32_t array_job_id, bool *complete,
+				 bool *completed, bool *pending)
+{
+	job_record_t *job_ptr;
+	int inx;
+
+	*complete = true;
+	*completed = true;
+	*pending = false;
+
+	job_ptr = find_job_record(array_job_id);
+	if (job_ptr) {
+		if (!IS_JOB_COMPLETE(job_ptr) ||
+		    (job_ptr->array_recs && job_ptr->array_recs->max_exit_code))
+			*complete = false;
+		if (!IS_JOB_COMPLETED(job_ptr))
+			*completed = false;
+		if (IS_JOB_PENDING(job_ptr) ||
+		    (job_ptr->array_recs && job_ptr->array_recs->task_cnt))
+			*pending = true;
+	}
+
+	/* Need to test individual job array records */
+	inx = JOB_HASH_INX(array_job_id);
+	job_ptr = job_array_hash_j[inx];
+	while (job_ptr && (*complete || *completed || !*pending)) {
+		if (job_ptr->array_job_id == array_job_id) {
+			if (!IS_JOB_COMPLETE(job_ptr))
+				*complete = false;
+			if (!IS_JOB_COMPLETED(job_ptr))
+				*completed = false;
+			if (IS_JOB_PENDING(job_ptr))
+				*pending = true;
+		}
+		job_ptr = job_ptr->job_array_next_j;
+	}
+}
+
 /* For a given job ID return the number of PENDING tasks which have their
  * own separate job_record (do not count tasks in pending META job record) */
 extern int num_pending_job_array_tasks(uint32_t array_job_id)
@@ -3058,6 +3748,60 @@ extern int num_pending_job_array_tasks(uint32_t array_job_id)
 	return count;
 }
 
+/*
+ * Call f for each job record with the given job ID or array job ID, using the
+ * job hash tables rather than walking job_list. The return value of f is
+ * ignored.
+ * RET count of job records visited
+ */
+extern int for_each_job_by_id(uint32_t job_id, ListForF f, void *arg)
+{
+	job_record_t *job_ptr;
+	int count = 0, inx;
+
+	if ((job_ptr = find_job_record(job_id))) {
+		(void) f(job_ptr, arg);
+		count++;
+	}
+
+	inx = JOB_HASH_INX(job_id);
+	job_ptr = job_array_hash_j[inx];
+	while (job_ptr) {
+		if ((job_ptr->array_job_id == job_id) &&
+		    (job_ptr->job_id != job_id)) {
+			(void) f(job_ptr, arg);
+			count++;
+		}
+		job_ptr = job_ptr->job_array_next_j;
+	}
+
+	return count;
+}
+
+/*
+ * Call f for each job record belonging to the given user, using the job user
+ * hash table rather than walking job_list. Stops if f returns a negative
+ * value.
+ * RET count of job records visited, negated if f stopped the walk
+ */
+extern int for_each_job_by_user(uid_t user_id, ListForF f, void *arg)
+{
+	job_record_t *job_ptr;
+	int count = 0;
+
+	job_ptr = job_user_hash[JOB_USER_HASH_INX(user_id)];
+	while (job_ptr) {
+		if (job_ptr->user_id == user_id) {
+			count++;
+			if (f(job_ptr, arg) < 0)
+				return -count;
+		}
+		job_ptr = job_ptr->job_next_user;
+	}
+
+	return count;
+}
+
 /*
  * find_job_array_rec - return a pointer to the job record with the given
  *	array_job_id/array_task_id
@@ -4200,6 +4944,8 @@ extern void rehash_jobs(void)
 					   sizeof(job_record_t *));
 		job_array_hash_t = xcalloc(hash_table_size,
 					   sizeof(job_record_t *));
+		job_user_hash = xcalloc(hash_table_size,
+					sizeof(job_record_t *));
 	} else if (hash_table_size < (slurm_conf.max_job_cnt / 2)) {
 		/* If the MaxJobCount grows by too much, the hash table will
 		 * be ineffective without rebuilding. We don't presently bother
@@ -4229,6 +4975,7 @@ extern job_record_t *job_array_split(job_record_t *job_ptr)
 	if (!job_ptr_pend)
 		return NULL;
 
+	job_array_split_cnt++;
 	_remove_job_hash(job_ptr, JOB_HASH_JOB);
 	job_ptr_pend->job_id = job_ptr->job_id;
 	if (_set_job_id(job_ptr) != SLURM_SUCCESS)
@@ -4258,7 +5005,7 @@ extern job_record_t *job_array_split(job_record_t *job_ptr)
 	slurm_copy_priority_factors_object(job_ptr_pend->prio_factors,
 					   job_ptr->prio_factors);
 
-	job_ptr_pend->account = xstrdup(job_ptr->account);
+	job_ptr_pend->account = _intern_account(job_ptr->account);
 	job_ptr_pend->admin_comment = xstrdup(job_ptr->admin_comment);
 	job_ptr_pend->alias_list = xstrdup(job_ptr->alias_list);
 	job_ptr_pend->alloc_node = xstrdup(job_ptr->alloc_node);
@@ -4307,6 +5054,7 @@ extern job_record_t *job_array_split(job_record_t *job_ptr)
 
 	_add_job_hash(job_ptr);		/* Sets job_next */
 	_add_job_hash(job_ptr_pend);	/* Sets job_next */
+	_add_job_user_hash(job_ptr_pend);	/* Sets job_next_user */
 	_add_job_array_hash(job_ptr);
 	job_ptr_pend->job_resrcs = NULL;
 
@@ -6834,7 +7582,6 @@ static int _job_create(job_desc_msg_t *job_desc, int allocate, int will_run,
 	    !valid_tres_cnt(job_desc->mem_per_tres)	||
 	    tres_bind_verify_cmdline(job_desc->tres_bind) ||
 	    tres_freq_verify_cmdline(job_desc->tres_freq) ||
-	    !valid_tres_cnt(job_desc->mem_per_tres)	||
 	    !valid_tres_cnt(job_desc->tres_per_job)	||
 	    !valid_tres_cnt(job_desc->tres_per_node)	||
 	    !valid_tres_cnt(job_desc->tres_per_socket)	||
@@ -7339,6 +8086,43 @@ extern int validate_job_create_req(job_desc_msg_t * job_desc, uid_t submit_uid,
 	return SLURM_SUCCESS;
 }
 
+/*
+ * Write a job script, linking to an identical script already written for
+ * another job when possible rather than writing another copy
+ */
+static int _write_job_script(char *file_name, char *script)
+{
+	char *blob_name;
+	size_t len;
+	bool linked = false;
+	Buf buf;
+	int rc;
+
+	if (!script)
+		return _write_data_to_file(file_name, script);
+
+	len = strlen(script) + 1;
+	blob_name = _script_blob_name(script, len);
+	if ((buf = create_mmap_buf(blob_name))) {
+		if ((size_buf(buf) == len) &&
+		    !memcmp(get_buf_data(buf), script, len) &&
+		    !link(blob_name, file_name))
+			linked = true;
+		free_buf(buf);
+	}
+
+	if (linked) {
+		rc = SLURM_SUCCESS;
+	} else if ((rc = _write_data_to_file(file_name, script)) ==
+		   SLURM_SUCCESS) {
+		/* Fails harmlessly if a different script has the same hash */
+		(void) link(file_name, blob_name);
+	}
+	xfree(blob_name);
+
+	return rc;
+}
+
 /* _copy_job_desc_to_file - copy the job script and environment from the RPC
  *	structure into a file */
 static int
@@ -7386,7 +8170,7 @@ _copy_job_desc_to_file(job_desc_msg_t * job_desc, uint32_t job_id)
 	if (error_code == 0) {
 		/* Create script file */
 		file_name = xstrdup_printf("%s/script", dir_name);
-		error_code = _write_data_to_file(file_name, job_desc->script);
+		error_code = _write_job_script(file_name, job_desc->script);
 		xfree(file_name);
 	}
 
@@ -7470,19 +8254,27 @@ _write_data_array_to_file(char *file_name, char **data, uint32_t size)
  * Create file with specified name and write the supplied data array to it
  * IN file_name - file to create and write to
  * IN data - pointer to string
+ *
+ * The data is written to a new file which is then renamed, never into an
+ * existing file: scripts may be hard linked between jobs (see
+ * _write_job_script()) and truncating one would change them all.
  */
 static int _write_data_to_file(char *file_name, char *data)
 {
 	int fd, pos, nwrite, amount;
+	char *new_file;
 
 	if (data == NULL) {
 		(void) unlink(file_name);
 		return SLURM_SUCCESS;
 	}
 
-	fd = creat(file_name, 0700);
+	new_file = xstrdup_printf("%s.new", file_name);
+	(void) unlink(new_file);
+	fd = creat(new_file, 0700);
 	if (fd < 0) {
-		error("Error creating file %s, %m", file_name);
+		error("Error creating file %s, %m", new_file);
+		xfree(new_file);
 		return ESLURM_WRITING_TO_FILE;
 	}
 
@@ -7491,14 +8283,24 @@ static int _write_data_to_file(char *file_name, char *data)
 	while (nwrite > 0) {
 		amount = write(fd, &data[pos], nwrite);
 		if ((amount < 0) && (errno != EINTR)) {
-			error("Error writing file %s, %m", file_name);
+			error("Error writing file %s, %m", new_file);
 			close(fd);
+			(void) unlink(new_file);
+			xfree(new_file);
 			return ESLURM_WRITING_TO_FILE;
 		}
 		nwrite -= amount;
 		pos    += amount;
 	}
 	close(fd);
+
+	if (rename(new_file, file_name)) {
+		error("Error renaming file %s to %s, %m", new_file, file_name);
+		(void) unlink(new_file);
+		xfree(new_file);
+		return ESLURM_WRITING_TO_FILE;
+	}
+	xfree(new_file);
 	return SLURM_SUCCESS;
 }
 
@@ -7845,6 +8647,7 @@ static int _copy_job_desc_to_job_record(job_desc_msg_t *job_desc,
 	_add_job_hash(job_ptr);
 
 	job_ptr->user_id    = (uid_t) job_desc->user_id;
+	_add_job_user_hash(job_ptr);
 	job_ptr->group_id   = (gid_t) job_desc->group_id;
 	job_ptr->job_state  = JOB_PENDING;
 	job_ptr->time_limit = job_desc->time_limit;
@@ -7857,7 +8660,7 @@ static int _copy_job_desc_to_job_record(job_desc_msg_t *job_desc,
 		job_ptr->time_min = job_desc->time_min;
 	job_ptr->alloc_sid  = job_desc->alloc_sid;
 	job_ptr->alloc_node = xstrdup(job_desc->alloc_node);
-	job_ptr->account    = xstrdup(job_desc->account);
+	job_ptr->account    = _intern_account(job_desc->account);
 	job_ptr->batch_features = xstrdup(job_desc->batch_features);
 	job_ptr->burst_buffer = xstrdup(job_desc->burst_buffer);
 	job_ptr->network    = xstrdup(job_desc->network);
@@ -9070,8 +9873,9 @@ static void _delete_job_common(job_record_t *job_ptr)
 	/* Remove record from fed_job_list */
 	fed_mgr_remove_fed_job_info(job_ptr->job_id);
 
-	/* Remove the record from job hash table */
+	/* Remove the record from job hash tables */
 	_remove_job_hash(job_ptr, JOB_HASH_JOB);
+	_remove_job_hash(job_ptr, JOB_HASH_USER);
 
 	/* Remove the record from job array hash tables, if applicable */
 	if (job_ptr->array_task_id != NO_VAL) {
@@ -9094,6 +9898,7 @@ static void _list_delete_job(void *job_entry)
 	xassert (job_ptr->magic == JOB_MAGIC);
 	job_ptr->magic = 0;	/* make sure we don't delete record twice */
 
+	_job_delta_purged(job_ptr);
 	_delete_job_common(job_ptr);
 
 	if (job_ptr->array_recs) {
@@ -9103,7 +9908,7 @@ static void _list_delete_job(void *job_entry)
 	}
 
 	_delete_job_details(job_ptr);
-	xfree(job_ptr->account);
+	_release_account(&job_ptr->account);
 	xfree(job_ptr->admin_comment);
 	xfree(job_ptr->alias_list);
 	xfree(job_ptr->alloc_node);
@@ -9369,16 +10174,40 @@ static void _pack_job(job_record_t *job_ptr,
 	(*pack_info->jobs_packed)++;
 }
 
+static int _foreach_pack_job(void *object, void *arg)
+{
+	_pack_job((job_record_t *) object, (_foreach_pack_job_info_t *) arg);
+
+	return SLURM_SUCCESS;
+}
+
+static int _foreach_pack_het_comp(void *object, void *arg)
+{
+	job_record_t *job_ptr = (job_record_t *) object;
+
+	/* The leader was already packed by _foreach_pack_jobid() */
+	if (job_ptr->job_id != job_ptr->het_job_id)
+		_pack_job(job_ptr, (_foreach_pack_job_info_t *) arg);
+
+	return SLURM_SUCCESS;
+}
+
+/*
+ * Pack the job with the given ID along with any job array tasks and
+ * heterogeneous job components it covers, matching what a client filtering
+ * on that ID would select.
+ */
 static int _foreach_pack_jobid(void *object, void *arg)
 {
 	job_record_t *job_ptr;
 	uint32_t job_id = *(uint32_t *)object;
-	_foreach_pack_job_info_t *info = (_foreach_pack_job_info_t *)arg;
 
-	if (!(job_ptr = find_job_record(job_id)))
-		return SLURM_SUCCESS;
+	(void) for_each_job_by_id(job_id, _foreach_pack_job, arg);
 
-	_pack_job(job_ptr, info);
+	if ((job_ptr = find_job_record(job_id)) && job_ptr->het_job_list &&
+	    (job_ptr->het_job_id == job_id))
+		list_for_each(job_ptr->het_job_list, _foreach_pack_het_comp,
+			      arg);
 
 	return SLURM_SUCCESS;
 }
@@ -9424,11 +10253,16 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 	pack_info.show_flags       = show_flags;
 	pack_info.uid              = uid;
 
-	itr = list_iterator_create(job_list);
-	while ((job_ptr = list_next(itr))) {
-		_pack_job(job_ptr, &pack_info);
+	if (filter_uid != NO_VAL) {
+		(void) for_each_job_by_user(filter_uid, _foreach_pack_job,
+					    &pack_info);
+	} else {
+		itr = list_iterator_create(job_list);
+		while ((job_ptr = list_next(itr))) {
+			_pack_job(job_ptr, &pack_info);
+		}
+		list_iterator_destroy(itr);
 	}
-	list_iterator_destroy(itr);
 
 	/* put the real record count in the message body header */
 	tmp_offset = get_buf_offset(buffer);
@@ -9494,6 +10328,245 @@ extern void pack_spec_jobs(char **buffer_ptr, int *buffer_size, List job_ids,
 	buffer_ptr[0] = xfer_buf_data(buffer);
 }
 
+/*
+ * Job change tracking for REQUEST_JOB_INFO_DELTA.
+ *
+ * Each job record carries the value of job_table_seq at which it last changed.
+ * Rather than instrumenting every place a job record is modified, changes are
+ * detected by comparing a signature of the fields clients most commonly
+ * display. Updates through update_job() explicitly mark the record changed.
+ * Purged jobs are remembered as tombstones so clients can drop them.
+ */
+#define JOB_TOMBSTONE_MAX 65536
+
+typedef struct {
+	uint32_t job_id;
+	uint64_t seq;
+} job_tombstone_t;
+
+static pthread_mutex_t job_delta_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t job_table_seq = 0;
+/* Deltas since an older sequence number may miss purged jobs */
+static uint64_t job_tombstone_min_seq = 0;
+static List job_tombstone_list = NULL;
+static time_t job_delta_scan_time = 0;
+static time_t job_delta_scan_update = 0;
+
+static uint32_t _sig_add(uint32_t sig, const void *data, size_t len)
+{
+	const unsigned char *p = data;
+
+	/* FNV-1a */
+	while (len--) {
+		sig ^= *p++;
+		sig *= 16777619;
+	}
+	return sig;
+}
+
+static uint32_t _sig_add_str(uint32_t sig, const char *str)
+{
+	if (!str)
+		return _sig_add(sig, "", 1);
+	return _sig_add(sig, str, strlen(str) + 1);
+}
+
+#define SIG_ADD(_sig, _val) _sig = _sig_add(_sig, &(_val), sizeof(_val))
+
+static uint32_t _job_change_sig(job_record_t *job_ptr)
+{
+	uint32_t sig = 2166136261U;
+
+	SIG_ADD(sig, job_ptr->job_state);
+	SIG_ADD(sig, job_ptr->state_reason);
+	SIG_ADD(sig, job_ptr->priority);
+	SIG_ADD(sig, job_ptr->bit_flags);
+	SIG_ADD(sig, job_ptr->start_time);
+	SIG_ADD(sig, job_ptr->end_time);
+	SIG_ADD(sig, job_ptr->suspend_time);
+	SIG_ADD(sig, job_ptr->pre_sus_time);
+	SIG_ADD(sig, job_ptr->time_limit);
+	SIG_ADD(sig, job_ptr->restart_cnt);
+	SIG_ADD(sig, job_ptr->node_cnt);
+	SIG_ADD(sig, job_ptr->total_cpus);
+	SIG_ADD(sig, job_ptr->exit_code);
+	SIG_ADD(sig, job_ptr->derived_ec);
+	SIG_ADD(sig, job_ptr->part_ptr);
+	SIG_ADD(sig, job_ptr->qos_ptr);
+	sig = _sig_add_str(sig, job_ptr->state_desc);
+	sig = _sig_add_str(sig, job_ptr->nodes);
+	sig = _sig_add_str(sig, job_ptr->batch_host);
+	if (job_ptr->details)
+		SIG_ADD(sig, job_ptr->details->begin_time);
+	if (job_ptr->array_recs) {
+		SIG_ADD(sig, job_ptr->array_recs->task_cnt);
+		SIG_ADD(sig, job_ptr->array_recs->max_run_tasks);
+	}
+
+	return sig;
+}
+
+static int _job_delta_scan_one(void *x, void *arg)
+{
+	job_record_t *job_ptr = x;
+	uint32_t sig = _job_change_sig(job_ptr);
+
+	if ((job_ptr->change_seq == 0) || (job_ptr->change_sig != sig)) {
+		job_ptr->change_sig = sig;
+		job_ptr->change_seq = ++job_table_seq;
+	}
+
+	return 0;
+}
+
+/*
+ * Assign new sequence numbers to changed job records.
+ * Caller must hold a job read lock and job_delta_mutex.
+ */
+static void _job_delta_scan(void)
+{
+	time_t now = time(NULL);
+
+	if ((job_delta_scan_update == last_job_update) &&
+	    (job_delta_scan_time == now))
+		return;
+
+	job_delta_scan_update = last_job_update;
+	job_delta_scan_time = now;
+	list_for_each(job_list, _job_delta_scan_one, NULL);
+}
+
+/*
+ * Mark a job record as changed, for fields not covered by _job_change_sig().
+ * Caller must hold a job write lock.
+ */
+static void _job_delta_touch(job_record_t *job_ptr)
+{
+	slurm_mutex_lock(&job_delta_mutex);
+	job_ptr->change_seq = ++job_table_seq;
+	slurm_mutex_unlock(&job_delta_mutex);
+}
+
+/*
+ * Record a job purged from job_list.
+ * Caller must hold a job write lock.
+ */
+static void _job_delta_purged(job_record_t *job_ptr)
+{
+	job_tombstone_t *tomb;
+
+	if (!job_ptr->change_seq)
+		return;		/* never seen by a delta client */
+
+	slurm_mutex_lock(&job_delta_mutex);
+	if (!job_tombstone_list)
+		job_tombstone_list = list_create(xfree_ptr);
+	if (list_count(job_tombstone_list) >= JOB_TOMBSTONE_MAX) {
+		tomb = list_pop(job_tombstone_list);
+		job_tombstone_min_seq = tomb->seq;
+		xfree(tomb);
+	}
+	tomb = xmalloc(sizeof(*tomb));
+	tomb->job_id = job_ptr->job_id;
+	tomb->seq = ++job_table_seq;
+	list_append(job_tombstone_list, tomb);
+	slurm_mutex_unlock(&job_delta_mutex);
+}
+
+/*
+ * pack_jobs_delta - dump information about jobs changed or purged since
+ *	a prior REQUEST_JOB_INFO_DELTA in machine independent form
+ * OUT buffer_ptr - the pointer is set to the allocated buffer.
+ * OUT buffer_size - set to size of the buffer in bytes
+ * IN epoch - epoch from the client's prior response or 0
+ * IN seq - sequence number from the client's prior response or 0
+ * IN show_flags - job filtering options
+ * IN uid - uid of user making request (for partition filtering)
+ * IN protocol_version - slurm protocol version of client
+ * global: job_list - global list of job records
+ * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
+ * NOTE: change _unpack_job_info_delta_msg() in common/slurm_protocol_pack.c
+ *	whenever the data format changes
+ */
+extern void pack_jobs_delta(char **buffer_ptr, int *buffer_size, time_t epoch,
+			    uint64_t seq, uint16_t show_flags, uid_t uid,
+			    uint16_t protocol_version)
+{
+	uint32_t jobs_packed = 0, removed_cnt = 0, tmp_offset, cnt_offset;
+	_foreach_pack_job_info_t pack_info = {0};
+	Buf buffer;
+	ListIterator itr;
+	job_record_t *job_ptr;
+	job_tombstone_t *tomb;
+	bool full;
+
+	buffer_ptr[0] = NULL;
+	*buffer_size = 0;
+
+	buffer = init_buf(BUF_SIZE);
+
+	slurm_mutex_lock(&job_delta_mutex);
+	_job_delta_scan();
+
+	/*
+	 * The client's mirror can not be patched if it describes a different
+	 * slurmctld instance or predates the oldest tombstone we retain.
+	 */
+	full = ((epoch != slurmctld_config.boot_time) || !seq ||
+		(seq < job_tombstone_min_seq) || (seq > job_table_seq));
+
+	pack64(job_table_seq, buffer);
+	pack_time(slurmctld_config.boot_time, buffer);
+	packbool(full, buffer);
+
+	/* put in a place holder removed record count of 0 for now */
+	cnt_offset = get_buf_offset(buffer);
+	pack32(removed_cnt, buffer);
+	if (!full && job_tombstone_list) {
+		itr = list_iterator_create(job_tombstone_list);
+		while ((tomb = list_next(itr))) {
+			if (tomb->seq <= seq)
+				continue;
+			pack32(tomb->job_id, buffer);
+			removed_cnt++;
+		}
+		list_iterator_destroy(itr);
+	}
+	tmp_offset = get_buf_offset(buffer);
+	set_buf_offset(buffer, cnt_offset);
+	pack32(removed_cnt, buffer);
+	set_buf_offset(buffer, tmp_offset);
+
+	/* job_info_msg_t header, same as pack_all_jobs() */
+	cnt_offset = get_buf_offset(buffer);
+	pack32(jobs_packed, buffer);
+	pack_time(time(NULL), buffer);
+
+	pack_info.buffer           = buffer;
+	pack_info.filter_uid       = NO_VAL;
+	pack_info.jobs_packed      = &jobs_packed;
+	pack_info.protocol_version = protocol_version;
+	pack_info.show_flags       = show_flags;
+	pack_info.uid              = uid;
+
+	itr = list_iterator_create(job_list);
+	while ((job_ptr = list_next(itr))) {
+		if (!full && (job_ptr->change_seq <= seq))
+			continue;
+		_pack_job(job_ptr, &pack_info);
+	}
+	list_iterator_destroy(itr);
+	slurm_mutex_unlock(&job_delta_mutex);
+
+	tmp_offset = get_buf_offset(buffer);
+	set_buf_offset(buffer, cnt_offset);
+	pack32(jobs_packed, buffer);
+	set_buf_offset(buffer, tmp_offset);
+
+	*buffer_size = get_buf_offset(buffer);
+	buffer_ptr[0] = xfer_buf_data(buffer);
+}
+
 static int _pack_het_job(job_record_t *job_ptr, uint16_t show_flags,
 			    Buf buffer, uint16_t protocol_version, uid_t uid)
 {
@@ -11252,6 +12325,8 @@ static int _update_job(job_record_t *job_ptr, job_desc_msg_t *job_specs,
 	if (job_ptr->db_index == NO_VAL64)
 		return ESLURM_JOB_SETTING_DB_INX;
 
+	_job_delta_touch(job_ptr);	/* resend to REQUEST_JOB_INFO_DELTA */
+	job_ptr->last_update = time(NULL);
 	operator = validate_operator(uid);
 	if (job_specs->burst_buffer) {
 		/*
@@ -12028,8 +13103,8 @@ static int _update_job(job_record_t *job_ptr, job_desc_msg_t *job_specs,
 
 	if (new_assoc_ptr) {
 		/* Change account/association */
-		xfree(job_ptr->account);
-		job_ptr->account = xstrdup(new_assoc_ptr->acct);
+		_release_account(&job_ptr->account);
+		job_ptr->account = _intern_account(new_assoc_ptr->acct);
 		job_ptr->assoc_id = new_assoc_ptr->id;
 		job_ptr->assoc_ptr = new_assoc_ptr;
 
@@ -14176,6 +15251,12 @@ static void _purge_missing_jobs(int node_inx, time_t now)
 	job_record_t *job_ptr;
 	node_record_t *node_ptr = node_record_table_ptr + node_inx;
 	time_t batch_startup_time, node_boot_time = (time_t) 0, startup_time;
+	/*
+	 * Only running and suspended jobs are of interest here, so stop
+	 * walking job_list (which includes every pending job) once all of
+	 * this node's jobs have been seen.
+	 */
+	uint32_t jobs_left = node_ptr->run_job_cnt + node_ptr->sus_job_cnt;
 
 	if (node_ptr->boot_time > (slurm_conf.msg_timeout + 5)) {
 		/* allow for message timeout and other delays */
@@ -14186,11 +15267,13 @@ static void _purge_missing_jobs(int node_inx, time_t now)
 	batch_startup_time -= MIN(DEFAULT_MSG_TIMEOUT, slurm_conf.msg_timeout);
 
 	job_iterator = list_iterator_create(job_list);
-	while ((job_ptr = list_next(job_iterator))) {
-		if ((IS_JOB_CONFIGURING(job_ptr) ||
-		    (!IS_JOB_RUNNING(job_ptr) && !IS_JOB_SUSPENDED(job_ptr))) ||
+	while (jobs_left && (job_ptr = list_next(job_iterator))) {
+		if ((!IS_JOB_RUNNING(job_ptr) && !IS_JOB_SUSPENDED(job_ptr)) ||
 		    (!bit_test(job_ptr->node_bitmap, node_inx)))
 			continue;
+		jobs_left--;
+		if (IS_JOB_CONFIGURING(job_ptr))
+			continue;
 		if ((job_ptr->batch_flag != 0)			&&
 		    (slurm_conf.suspend_time != 0) /* power mgmt on */	&&
 		    (job_ptr->start_time < node_boot_time)) {
@@ -14542,7 +15625,7 @@ extern int job_alloc_info(uint32_t uid, uint32_t job_id,
  */
 int sync_job_files(void)
 {
-	List batch_dirs;
+	List batch_dirs, script_blobs;
 
 	xassert(verify_lock(CONF_LOCK, READ_LOCK));
 	xassert(verify_lock(JOB_LOCK, WRITE_LOCK));
@@ -14551,23 +15634,42 @@ int sync_job_files(void)
 		return SLURM_SUCCESS;
 
 	batch_dirs = list_create(xfree_ptr);
-	_get_batch_job_dir_ids(batch_dirs);
+	script_blobs = list_create(xfree_ptr);
+	_get_batch_job_dir_ids(batch_dirs, script_blobs);
 	_validate_job_files(batch_dirs);
 	_remove_defunct_batch_dirs(batch_dirs);
+	/* After the defunct jobs dropped their links to the shared scripts */
+	list_for_each(script_blobs, _purge_script_blob, NULL);
 	FREE_NULL_LIST(batch_dirs);
+	FREE_NULL_LIST(script_blobs);
 	return SLURM_SUCCESS;
 }
 
+/* Remove a shared job script that no job is linked to any more */
+static int _purge_script_blob(void *x, void *arg)
+{
+	char *blob_name = (char *) x;
+	struct stat sbuf;
+
+	if (!stat(blob_name, &sbuf) && (sbuf.st_nlink == 1)) {
+		debug3("Purged unused batch script %s", blob_name);
+		(void) unlink(blob_name);
+	}
+
+	return 0;
+}
+
 /* Append to the batch_dirs list the job_id's associated with
- *	every batch job directory in existence
+ *	every batch job directory in existence and to the script_blobs list
+ *	the path of every shared batch script
  */
-static void _get_batch_job_dir_ids(List batch_dirs)
+static void _get_batch_job_dir_ids(List batch_dirs, List script_blobs)
 {
 	DIR *f_dir, *h_dir;
 	struct dirent *dir_ent, *hash_ent;
 	long long_job_id;
 	uint32_t *job_id_ptr;
-	char *endptr;
+	char *endptr, *blob_name;
 
 	xassert(verify_lock(CONF_LOCK, READ_LOCK));
 
@@ -14589,6 +15691,14 @@ static void _get_batch_job_dir_ids(List batch_dirs)
 			if (!h_dir)
 				continue;
 			while ((hash_ent = readdir(h_dir))) {
+				if (!xstrncmp("script.", hash_ent->d_name, 7)) {
+					blob_name = xstrdup_printf("%s/%s/%s",
+						slurm_conf.state_save_location,
+						dir_ent->d_name,
+						hash_ent->d_name);
+					list_append(script_blobs, blob_name);
+					continue;
+				}
 				if (xstrncmp("job.#", hash_ent->d_name, 4))
 					continue;
 				long_job_id = strtol(&hash_ent->d_name[4],
@@ -15008,9 +16118,11 @@ void batch_requeue_fini(job_record_t *job_ptr)
 void job_fini (void)
 {
 	FREE_NULL_LIST(job_list);
+	FREE_NULL_LIST(job_tombstone_list);
 	xfree(job_hash);
 	xfree(job_array_hash_j);
 	xfree(job_array_hash_t);
+	xfree(job_user_hash);
 	FREE_NULL_LIST(purge_files_list);
 	FREE_NULL_BITMAP(requeue_exit);
 	FREE_NULL_BITMAP(requeue_exit_hold);
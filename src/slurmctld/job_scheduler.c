@@ -100,10 +100,14 @@
 #endif
 #define BUILD_TIMEOUT 2000000	/* Max build_job_queue() run time in usec */
 #define MAX_FAILED_RESV 10
+#define WAIT_BOOT_POLL 5	/* Max seconds between node boot checks */
 
 typedef struct wait_boot_arg {
 	uint32_t job_id;
-	bitstr_t *node_bitmap;
+	bitstr_t *node_bitmap;	/* nodes not yet booted */
+	int node_cnt;		/* nodes rebooted for the job */
+	time_t start_time;
+	bool timeout;
 } wait_boot_arg_t;
 
 static batch_job_launch_msg_t *_build_launch_job_msg(job_record_t *job_ptr,
@@ -120,8 +124,18 @@ static int	_valid_feature_list(job_record_t *job_ptr, bool can_reboot);
 static int	_valid_node_feature(char *feature, bool can_reboot);
 #ifndef HAVE_FRONT_END
 static void *	_wait_boot(void *arg);
+static void	_wait_boot_arg_free(void *x);
 #endif
 static int	build_queue_timeout = BUILD_TIMEOUT;
+static pthread_mutex_t prolog_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t *prolog_job_ids = NULL;	/* jobs awaiting prolog setup */
+static int prolog_job_cnt = 0, prolog_job_size = 0;
+static bool prolog_agent_running = false;
+static pthread_mutex_t wait_boot_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wait_boot_cond = PTHREAD_COND_INITIALIZER;
+static List wait_boot_list = NULL;	/* wait_boot_arg_t of booting jobs */
+static bool wait_boot_agent_running = false;
+static bool wait_boot_event = false;
 static int	save_last_part_update = 0;
 
 static pthread_mutex_t sched_mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -136,6 +150,10 @@ static int sched_min_interval = 2;
 static int bb_array_stage_cnt = 10;
 extern diag_stats_t slurmctld_diag_stats;
 
+/*
+ * Find a job which blocks a singleton dependency of the job in key.
+ * RET -1 to stop for_each_job_by_user() on such a job, otherwise 0
+ */
 static int _find_singleton_job (void *x, void *key)
 {
 	struct job_record *qjob_ptr = (struct job_record *) x;
@@ -158,7 +176,7 @@ static int _find_singleton_job (void *x, void *key)
 	if (IS_JOB_RUNNING(qjob_ptr) || IS_JOB_SUSPENDED(qjob_ptr) ||
 	    (IS_JOB_PENDING(qjob_ptr) &&
 	     (qjob_ptr->job_id < job_ptr->job_id))) {
-		return 1;
+		return -1;
 	}
 
 	return 0;
@@ -381,6 +399,101 @@ extern void job_queue_rec_prom_resv(job_queue_rec_t *job_queue_rec)
 	job_queue_rec->job_ptr->bit_flags |= JOB_PROM;
 }
 
+/* Split out one task of a job array that needs burst buffer staging */
+static void _split_bb_array_task(job_record_t *job_ptr)
+{
+	job_record_t *new_job_ptr;
+	int i, pend_cnt;
+
+	if ((i = bit_ffs(job_ptr->array_recs->task_id_bitmap)) < 0)
+		return;
+	pend_cnt = num_pending_job_array_tasks(job_ptr->array_job_id);
+	if (pend_cnt >= bb_array_stage_cnt)
+		return;
+	if (job_ptr->array_recs->task_cnt < 1)
+		return;
+	if (job_ptr->array_recs->task_cnt == 1) {
+		job_ptr->array_task_id = i;
+		(void) job_array_post_sched(job_ptr);
+		if (job_ptr->details && job_ptr->details->dependency &&
+		    job_ptr->details->depend_list)
+			fed_mgr_submit_remote_dependencies(job_ptr, false,
+							   false);
+		return;
+	}
+	job_ptr->array_task_id = i;
+	new_job_ptr = job_array_split(job_ptr);
+	if (new_job_ptr) {
+		debug("%s: Split out %pJ for burst buffer use",
+		      __func__, job_ptr);
+		new_job_ptr->job_state = JOB_PENDING;
+		new_job_ptr->start_time = (time_t) 0;
+		/* Do NOT clear db_index here, it is handled when
+		 * task_id_str is created elsewhere */
+		(void) bb_g_job_validate2(job_ptr, NULL);
+	} else {
+		error("%s: Unable to copy record for %pJ",
+		      __func__, job_ptr);
+	}
+}
+
+/*
+ * Split out one task of a job array with
+ * depend_type == SLURM_DEPEND_AFTER_CORRESPOND
+ */
+static void _split_correspond_array_task(job_record_t *job_ptr)
+{
+	ListIterator depend_iter;
+	depend_spec_t *dep_ptr;
+	job_record_t *new_job_ptr;
+	int i, pend_cnt, dep_corr;
+
+	if ((i = bit_ffs(job_ptr->array_recs->task_id_bitmap)) < 0)
+		return;
+	if ((job_ptr->details == NULL) ||
+	    (job_ptr->details->depend_list == NULL) ||
+	    (list_count(job_ptr->details->depend_list) == 0))
+		return;
+	depend_iter = list_iterator_create(job_ptr->details->depend_list);
+	dep_corr = 0;
+	while ((dep_ptr = list_next(depend_iter))) {
+		if (dep_ptr->depend_type == SLURM_DEPEND_AFTER_CORRESPOND) {
+			dep_corr = 1;
+			break;
+		}
+	}
+	list_iterator_destroy(depend_iter);
+	if (!dep_corr)
+		return;
+	pend_cnt = num_pending_job_array_tasks(job_ptr->array_job_id);
+	if (pend_cnt >= CORRESPOND_ARRAY_TASK_CNT)
+		return;
+	if (job_ptr->array_recs->task_cnt < 1)
+		return;
+	if (job_ptr->array_recs->task_cnt == 1) {
+		job_ptr->array_task_id = i;
+		(void) job_array_post_sched(job_ptr);
+		if (job_ptr->details && job_ptr->details->dependency &&
+		    job_ptr->details->depend_list)
+			fed_mgr_submit_remote_dependencies(job_ptr, false,
+							   false);
+		return;
+	}
+	job_ptr->array_task_id = i;
+	new_job_ptr = job_array_split(job_ptr);
+	if (new_job_ptr) {
+		info("%s: Split out %pJ for SLURM_DEPEND_AFTER_CORRESPOND use",
+		     __func__, job_ptr);
+		new_job_ptr->job_state = JOB_PENDING;
+		new_job_ptr->start_time = (time_t) 0;
+		/* Do NOT clear db_index here, it is handled when
+		 * task_id_str is created elsewhere */
+	} else {
+		error("%s: Unable to copy record for %pJ",
+		      __func__, job_ptr);
+	}
+}
+
 /*
  * build_job_queue - build (non-priority ordered) list of pending jobs
  * IN clear_start - if set then clear the start_time for pending jobs,
@@ -393,11 +506,10 @@ extern List build_job_queue(bool clear_start, bool backfill)
 {
 	static time_t last_log_time = 0;
 	List job_queue;
-	ListIterator depend_iter, job_iterator, part_iterator;
-	job_record_t *job_ptr = NULL, *new_job_ptr;
+	ListIterator job_iterator, part_iterator;
+	job_record_t *job_ptr = NULL;
 	part_record_t *part_ptr;
-	depend_spec_t *dep_ptr;
-	int i, pend_cnt, reason, dep_corr;
+	int reason;
 	struct timeval start_tv = {0, 0};
 	int tested_jobs = 0;
 	int job_part_pairs = 0;
@@ -409,7 +521,7 @@ extern List build_job_queue(bool clear_start, bool backfill)
 
 	/*
 	 * Create individual job records for job arrays that need burst buffer
-	 * staging
+	 * staging or have depend_type == SLURM_DEPEND_AFTER_CORRESPOND
 	 *
 	 * NOTE: You can not use list_for_each for these loops here because
 	 * job_array_post_sched and job_array_split could eventually call
@@ -421,107 +533,33 @@ extern List build_job_queue(bool clear_start, bool backfill)
 	job_iterator = list_iterator_create(job_list);
 	while ((job_ptr = list_next(job_iterator))) {
 		if (!IS_JOB_PENDING(job_ptr) ||
-		    !job_ptr->burst_buffer || !job_ptr->array_recs ||
+		    !job_ptr->array_recs ||
 		    !job_ptr->array_recs->task_id_bitmap ||
 		    (job_ptr->array_task_id != NO_VAL))
 			continue;
-
-		if ((i = bit_ffs(job_ptr->array_recs->task_id_bitmap)) < 0)
-			continue;
-		pend_cnt = num_pending_job_array_tasks(job_ptr->array_job_id);
-		if (pend_cnt >= bb_array_stage_cnt)
-			continue;
-		if (job_ptr->array_recs->task_cnt < 1)
-			continue;
-		if (job_ptr->array_recs->task_cnt == 1) {
-			job_ptr->array_task_id = i;
-			(void) job_array_post_sched(job_ptr);
-			if (job_ptr->details && job_ptr->details->dependency &&
-			    job_ptr->details->depend_list)
-				fed_mgr_submit_remote_dependencies(job_ptr,
-								   false,
-								   false);
-			continue;
-		}
-		job_ptr->array_task_id = i;
-		new_job_ptr = job_array_split(job_ptr);
-		if (new_job_ptr) {
-			debug("%s: Split out %pJ for burst buffer use",
-			      __func__, job_ptr);
-			new_job_ptr->job_state = JOB_PENDING;
-			new_job_ptr->start_time = (time_t) 0;
-			/* Do NOT clear db_index here, it is handled when
-			 * task_id_str is created elsewhere */
-			(void) bb_g_job_validate2(job_ptr, NULL);
-		} else {
-			error("%s: Unable to copy record for %pJ",
-			      __func__, job_ptr);
-		}
+		if (job_ptr->burst_buffer)
+			_split_bb_array_task(job_ptr);
+		if (IS_JOB_PENDING(job_ptr) && job_ptr->array_recs &&
+		    job_ptr->array_recs->task_id_bitmap &&
+		    (job_ptr->array_task_id == NO_VAL))
+			_split_correspond_array_task(job_ptr);
 	}
 
-	/* Create individual job records for job arrays with
-	 * depend_type == SLURM_DEPEND_AFTER_CORRESPOND */
 	list_iterator_reset(job_iterator);
 	while ((job_ptr = list_next(job_iterator))) {
-		if (!IS_JOB_PENDING(job_ptr) ||
-		    !job_ptr->array_recs ||
-		    !job_ptr->array_recs->task_id_bitmap ||
-		    (job_ptr->array_task_id != NO_VAL))
-			continue;
-		if ((i = bit_ffs(job_ptr->array_recs->task_id_bitmap)) < 0)
-			continue;
-		if ((job_ptr->details == NULL) ||
-		    (job_ptr->details->depend_list == NULL) ||
-		    (list_count(job_ptr->details->depend_list) == 0))
-			continue;
-		depend_iter = list_iterator_create(
-			job_ptr->details->depend_list);
-		dep_corr = 0;
-		while ((dep_ptr = list_next(depend_iter))) {
-			if (dep_ptr->depend_type ==
-			    SLURM_DEPEND_AFTER_CORRESPOND) {
-				dep_corr = 1;
-				break;
-			}
-		}
-		if (!dep_corr)
-			continue;
-		pend_cnt = num_pending_job_array_tasks(job_ptr->array_job_id);
-		if (pend_cnt >= CORRESPOND_ARRAY_TASK_CNT)
-			continue;
-		if (job_ptr->array_recs->task_cnt < 1)
-			continue;
-		if (job_ptr->array_recs->task_cnt == 1) {
-			job_ptr->array_task_id = i;
-			(void) job_array_post_sched(job_ptr);
-			if (job_ptr->details && job_ptr->details->dependency &&
-			    job_ptr->details->depend_list)
-				fed_mgr_submit_remote_dependencies(job_ptr,
-								   false,
-								   false);
+		job_ptr->preempt_in_progress = false;	/* initialize */
+		if (job_ptr->array_recs)
+			job_ptr->array_recs->pend_run_tasks = 0;
+		/*
+		 * Most records in job_list are running or finished jobs kept
+		 * for MinJobAge. Skip them before doing any per-job work so
+		 * that build_queue_timeout is only spent on pending jobs.
+		 */
+		if (!IS_JOB_PENDING(job_ptr))
 			continue;
-		}
-		job_ptr->array_task_id = i;
-		new_job_ptr = job_array_split(job_ptr);
-		if (new_job_ptr) {
-			info("%s: Split out %pJ for SLURM_DEPEND_AFTER_CORRESPOND use",
-			     __func__, job_ptr);
-			new_job_ptr->job_state = JOB_PENDING;
-			new_job_ptr->start_time = (time_t) 0;
-			/* Do NOT clear db_index here, it is handled when
-			 * task_id_str is created elsewhere */
-		} else {
-			error("%s: Unable to copy record for %pJ",
-			      __func__, job_ptr);
-		}
-	}
 
-	list_iterator_reset(job_iterator);
-	while ((job_ptr = list_next(job_iterator))) {
-		if (IS_JOB_PENDING(job_ptr)) {
-			set_job_failed_assoc_qos_ptr(job_ptr);
-			acct_policy_handle_accrue_time(job_ptr, false);
-		}
+		set_job_failed_assoc_qos_ptr(job_ptr);
+		acct_policy_handle_accrue_time(job_ptr, false);
 
 		if (((tested_jobs % 100) == 0) &&
 		    (slurm_delta_tv(&start_tv) >= build_queue_timeout)) {
@@ -537,9 +575,6 @@ extern List build_job_queue(bool clear_start, bool backfill)
 			break;
 		}
 		tested_jobs++;
-		job_ptr->preempt_in_progress = false;	/* initialize */
-		if (job_ptr->array_recs)
-			job_ptr->array_recs->pend_run_tasks = 0;
 		if (job_ptr->state_reason != WAIT_NO_REASON) {
 			if ((job_ptr->state_reason != WAIT_PRIORITY) &&
 			    (job_ptr->state_reason != WAIT_RESOURCES))
@@ -968,9 +1003,11 @@ static int _schedule(uint32_t job_limit)
 {
 	ListIterator job_iterator = NULL, part_iterator = NULL;
 	List job_queue = NULL;
+	job_queue_heap_t *job_queue_heap = NULL;
 	int failed_part_cnt = 0, failed_resv_cnt = 0, job_cnt = 0;
 	int error_code, i, j, part_cnt, time_limit, pend_time;
 	uint32_t job_depth = 0, array_task_id;
+	int array_batch_cnt = 0;
 	job_queue_rec_t *job_queue_rec;
 	job_record_t *job_ptr = NULL;
 	part_record_t *part_ptr, **failed_parts = NULL, *skip_part_ptr = NULL;
@@ -987,6 +1024,7 @@ static int _schedule(uint32_t job_limit)
 	static bool assoc_limit_stop = false;
 	static int sched_timeout = 0;
 	static int sched_max_job_start = 0;
+	static int sched_array_batch = 0;
 	static int bf_min_age_reserve = 0;
 	static uint32_t bf_min_prio_reserve = 0;
 	static int def_job_limit = 100;
@@ -1201,12 +1239,25 @@ static int _schedule(uint32_t job_limit)
 			sched_max_job_start = 0;
 		}
 
+		if ((tmp_ptr = xstrcasestr(slurm_conf.sched_params,
+					   "sched_array_batch="))) {
+			sched_array_batch = atoi(tmp_ptr + 18);
+			if (sched_array_batch < 0) {
+				error("Invalid sched_array_batch: %d",
+				      sched_array_batch);
+				sched_array_batch = 0;
+			}
+		} else {
+			sched_array_batch = 0;
+		}
+
 		sched_update = slurm_conf.last_update;
 		info("SchedulerParameters=default_queue_depth=%d,"
 		     "max_rpc_cnt=%d,max_sched_time=%d,partition_job_depth=%d,"
-		     "sched_max_job_start=%d,sched_min_interval=%d",
+		     "sched_array_batch=%d,sched_max_job_start=%d,"
+		     "sched_min_interval=%d",
 		     def_job_limit, defer_rpc_cnt, sched_timeout,
-		     max_jobs_per_part, sched_max_job_start,
+		     max_jobs_per_part, sched_array_batch, sched_max_job_start,
 		     sched_min_interval);
 	}
 
@@ -1330,7 +1381,7 @@ static int _schedule(uint32_t job_limit)
 	} else {
 		job_queue = build_job_queue(false, false);
 		slurmctld_diag_stats.schedule_queue_len = list_count(job_queue);
-		sort_job_queue(job_queue);
+		job_queue_heap = job_queue_heap_create(job_queue);
 	}
 
 	job_ptr = NULL;
@@ -1388,7 +1439,7 @@ next_part:
 					continue;
 			}
 		} else {
-			job_queue_rec = list_pop(job_queue);
+			job_queue_rec = job_queue_heap_pop(job_queue_heap);
 			if (!job_queue_rec)
 				break;
 			array_task_id = job_queue_rec->array_task_id;
@@ -1434,6 +1485,7 @@ next_part:
 			is_job_array_head = true;
 		else
 			is_job_array_head = false;
+		array_batch_cnt = 0;
 
 next_task:
 		if ((time(NULL) - sched_start) >= sched_timeout) {
@@ -1482,7 +1534,13 @@ next_task:
 				continue;
 			}
 		}
-		if (job_depth++ > job_limit) {
+		/*
+		 * Further tasks started from one job array record count as
+		 * one job against the queue depth, up to sched_array_batch
+		 */
+		if ((!array_batch_cnt ||
+		     (array_batch_cnt >= sched_array_batch)) &&
+		    (job_depth++ > job_limit)) {
 			sched_debug("already tested %u jobs, breaking out",
 				    job_depth);
 			break;
@@ -1799,8 +1857,10 @@ skip_start:
 				/* Try starting another task of the job array */
 				job_ptr = find_job_record(job_ptr->array_job_id);
 				if (job_ptr && IS_JOB_PENDING(job_ptr) &&
-				    (bb_g_job_test_stage_in(job_ptr,false) ==1))
+				    (bb_g_job_test_stage_in(job_ptr,false) ==1)) {
+					array_batch_cnt++;
 					goto next_task;
+				}
 			}
 			continue;
 		} else if ((error_code ==
@@ -1906,6 +1966,7 @@ fail_this_part:	if (fail_by_part) {
 		if (part_iterator)
 			list_iterator_destroy(part_iterator);
 	} else if (job_queue) {
+		job_queue_heap_destroy(job_queue_heap);
 		FREE_NULL_LIST(job_queue);
 	}
 	xfree(sched_part_ptr);
@@ -1941,6 +2002,69 @@ extern void sort_job_queue(List job_queue)
 	list_sort(job_queue, sort_job_queue2);
 }
 
+/* Restore the heap order below index i */
+static void _job_queue_heap_down(job_queue_heap_t *heap, int i)
+{
+	job_queue_rec_t *tmp;
+	int child;
+
+	while ((child = (2 * i) + 1) < heap->cnt) {
+		if (((child + 1) < heap->cnt) &&
+		    (sort_job_queue2(&heap->recs[child + 1],
+				     &heap->recs[child]) < 0))
+			child++;
+		if (sort_job_queue2(&heap->recs[i], &heap->recs[child]) <= 0)
+			break;
+		tmp = heap->recs[i];
+		heap->recs[i] = heap->recs[child];
+		heap->recs[child] = tmp;
+		i = child;
+	}
+}
+
+extern job_queue_heap_t *job_queue_heap_create(List job_queue)
+{
+	job_queue_heap_t *heap = xmalloc(sizeof(job_queue_heap_t));
+	job_queue_rec_t *job_queue_rec;
+	int i;
+
+	heap->recs = xcalloc(list_count(job_queue) + 1,
+			     sizeof(job_queue_rec_t *));
+	while ((job_queue_rec = list_pop(job_queue)))
+		heap->recs[heap->cnt++] = job_queue_rec;
+	for (i = (heap->cnt / 2) - 1; i >= 0; i--)
+		_job_queue_heap_down(heap, i);
+
+	return heap;
+}
+
+extern job_queue_rec_t *job_queue_heap_pop(job_queue_heap_t *heap)
+{
+	job_queue_rec_t *job_queue_rec;
+
+	if (!heap || !heap->cnt)
+		return NULL;
+
+	job_queue_rec = heap->recs[0];
+	heap->recs[0] = heap->recs[--heap->cnt];
+	_job_queue_heap_down(heap, 0);
+
+	return job_queue_rec;
+}
+
+extern void job_queue_heap_destroy(job_queue_heap_t *heap)
+{
+	int i;
+
+	if (!heap)
+		return;
+
+	for (i = 0; i < heap->cnt; i++)
+		xfree(heap->recs[i]);
+	xfree(heap->recs);
+	xfree(heap);
+}
+
 /* Note this differs from the ListCmpF typedef since we want jobs sorted
  * in order of decreasing priority then submit time and the by increasing
  * job id */
@@ -2940,8 +3064,9 @@ extern int test_job_dependency(job_record_t *job_ptr, bool *was_changed)
 		djob_ptr = dep_ptr->job_ptr;
 		if ((dep_ptr->depend_type == SLURM_DEPEND_SINGLETON) &&
 		    job_ptr->name) {
-			if (list_find_first(job_list, _find_singleton_job,
-					    job_ptr) ||
+			if ((for_each_job_by_user(job_ptr->user_id,
+						  _find_singleton_job,
+						  job_ptr) < 0) ||
 			    !fed_mgr_is_singleton_satisfied(job_ptr,
 							    dep_ptr, true)) {
 				/* Still depends */
@@ -2956,12 +3081,10 @@ extern int test_job_dependency(job_record_t *job_ptr, bool *was_changed)
 		} else {
 			/* Special case, apply test to job array as a whole */
 			if (dep_ptr->array_task_id == INFINITE) {
-				is_complete = test_job_array_complete(
-					dep_ptr->job_id);
-				is_completed = test_job_array_completed(
-					dep_ptr->job_id);
-				is_pending = test_job_array_pending(
-					dep_ptr->job_id);
+				test_job_array_state(dep_ptr->job_id,
+						     &is_complete,
+						     &is_completed,
+						     &is_pending);
 			} else {
 				/* Normal job */
 				is_complete = IS_JOB_COMPLETE(djob_ptr);
@@ -3823,6 +3946,47 @@ static int _part_weight_sort(void *x, void *y)
 	return 0;
 }
 
+/*
+ * Build a will-run response for a pending job from the plan of the most
+ * recent backfill cycle, which already considered all higher priority jobs.
+ * This avoids a select_g_job_test() call for every "--test-only" request.
+ * The plan is only used if that cycle started no more than bf_interval
+ * seconds ago, evaluated the job and the job was not updated since it
+ * started, the request does not name specific nodes and the answer can
+ * not depend upon preemption. Return NULL if no usable plan exists.
+ */
+static will_run_response_msg_t *_will_run_from_plan(
+	job_record_t *job_ptr, job_desc_msg_t *job_desc_msg, time_t now)
+{
+	will_run_response_msg_t *resp_data;
+	time_t plan_time = slurmctld_diag_stats.bf_when_last_cycle;
+	uint32_t plan_max_age = slurmctld_diag_stats.bf_interval;
+
+	if (!plan_time || !plan_max_age ||
+	    ((now - plan_time) > plan_max_age) ||
+	    (job_ptr->last_sched_eval < plan_time) ||
+	    (job_ptr->last_update >= plan_time) ||
+	    !job_ptr->sched_nodes || !job_ptr->start_time ||
+	    job_ptr->part_ptr_list || !job_ptr->part_ptr ||
+	    (job_desc_msg->req_nodes && job_desc_msg->req_nodes[0]) ||
+	    slurm_preemption_enabled())
+		return NULL;
+
+	resp_data = xmalloc(sizeof(will_run_response_msg_t));
+	resp_data->job_id     = job_ptr->job_id;
+	resp_data->proc_cnt   = job_ptr->total_cpus;
+	resp_data->start_time = MAX(job_ptr->start_time, now);
+	if (job_ptr->details->begin_time)
+		resp_data->start_time = MAX(resp_data->start_time,
+					    job_ptr->details->begin_time);
+	resp_data->node_list  = xstrdup(job_ptr->sched_nodes);
+	resp_data->part_name  = xstrdup(job_ptr->part_ptr->name);
+	debug2("%s: %pJ answered from backfill plan of age %ld secs",
+	       __func__, job_ptr, (long) (now - plan_time));
+
+	return resp_data;
+}
+
 /*
  * Determine if a pending job will run using only the specified nodes
  * (in job_desc_msg->req_nodes), build response message and return
@@ -3857,6 +4021,9 @@ extern int job_start_data(job_desc_msg_t *job_desc_msg,
 	if ((job_ptr->details == NULL) || (job_ptr->job_state != JOB_PENDING))
 		return ESLURM_DISABLED;
 
+	if ((*resp = _will_run_from_plan(job_ptr, job_desc_msg, now)))
+		return SLURM_SUCCESS;
+
 	if (job_ptr->part_ptr_list) {
 		list_sort(job_ptr->part_ptr_list, _part_weight_sort);
 		iter = list_iterator_create(job_ptr->part_ptr_list);
@@ -4143,7 +4310,22 @@ extern int reboot_job_nodes(job_record_t *job_ptr)
 {
 	return SLURM_SUCCESS;
 }
+
+extern void wait_boot_notify(void)
+{
+}
 #else
+/* Wake the agent waiting for nodes rebooted by reboot_job_nodes() */
+extern void wait_boot_notify(void)
+{
+	slurm_mutex_lock(&wait_boot_mutex);
+	if (wait_boot_agent_running) {
+		wait_boot_event = true;
+		slurm_cond_signal(&wait_boot_cond);
+	}
+	slurm_mutex_unlock(&wait_boot_mutex);
+}
+
 /* NOTE: See power_job_reboot() in power_save.c for similar logic */
 extern int reboot_job_nodes(job_record_t *job_ptr)
 {
@@ -4157,7 +4339,6 @@ extern int reboot_job_nodes(job_record_t *job_ptr)
 	char *nodes, *reboot_features = NULL;
 	uint16_t protocol_version = SLURM_PROTOCOL_VERSION;
 	wait_boot_arg_t *wait_boot_arg;
-	pthread_t tid;
 
 	if ((job_ptr->details == NULL) || (job_ptr->node_bitmap == NULL))
 		return SLURM_SUCCESS;
@@ -4182,6 +4363,7 @@ extern int reboot_job_nodes(job_record_t *job_ptr)
 	wait_boot_arg = xmalloc(sizeof(wait_boot_arg_t));
 	wait_boot_arg->job_id = job_ptr->job_id;
 	wait_boot_arg->node_bitmap = bit_alloc(node_record_count);
+	wait_boot_arg->start_time = now;
 
 	/* Modify state information for all nodes, KNL and others */
 	i_first = bit_ffs(boot_node_bitmap);
@@ -4200,6 +4382,7 @@ extern int reboot_job_nodes(job_record_t *job_ptr)
 		bit_clear(avail_node_bitmap, i);
 		bit_set(booting_node_bitmap, i);
 		bit_set(wait_boot_arg->node_bitmap, i);
+		wait_boot_arg->node_cnt++;
 		node_ptr->boot_req_time = now;
 		node_ptr->last_response = now + slurm_conf.resume_timeout;
 	}
@@ -4289,92 +4472,172 @@ extern int reboot_job_nodes(job_record_t *job_ptr)
 	}
 
 	job_ptr->details->prolog_running++;
-	slurm_thread_create(&tid, _wait_boot, wait_boot_arg);
+	slurm_mutex_lock(&wait_boot_mutex);
+	if (!wait_boot_list)
+		wait_boot_list = list_create(_wait_boot_arg_free);
+	list_append(wait_boot_list, wait_boot_arg);
+	if (!wait_boot_agent_running) {
+		pthread_t tid;
+		wait_boot_agent_running = true;
+		slurm_thread_create(&tid, _wait_boot, NULL);
+	}
+	slurm_mutex_unlock(&wait_boot_mutex);
 	FREE_NULL_BITMAP(boot_node_bitmap);
 	FREE_NULL_BITMAP(feature_node_bitmap);
 
 	return rc;
 }
 
-static void *_wait_boot(void *arg)
+static void _wait_boot_arg_free(void *x)
+{
+	wait_boot_arg_t *wait_boot_arg = (wait_boot_arg_t *) x;
+
+	if (wait_boot_arg) {
+		FREE_NULL_BITMAP(wait_boot_arg->node_bitmap);
+		xfree(wait_boot_arg);
+	}
+}
+
+/*
+ * Clear the nodes of a job which have booted since the reboot request.
+ * RET 0 if still waiting, 1 if boot complete or timed out, -1 if the job no
+ *     longer waits for the boot
+ */
+static int _wait_boot_test(wait_boot_arg_t *wait_boot_arg)
 {
-	wait_boot_arg_t *wait_boot_arg = (wait_boot_arg_t *) arg;
 	job_record_t *job_ptr;
-	bitstr_t *boot_node_bitmap = wait_boot_arg->node_bitmap;
+	node_record_t *node_ptr;
+	int i, i_first, i_last, wait_node_cnt;
+
+	if (!(job_ptr = find_job_record(wait_boot_arg->job_id))) {
+		error("%s: JobId=%u vanished while waiting for node boot",
+		      __func__, wait_boot_arg->job_id);
+		return -1;
+	}
+	if (IS_JOB_PENDING(job_ptr) ||	/* Job requeued or killed */
+	    IS_JOB_FINISHED(job_ptr) ||
+	    !job_ptr->node_bitmap) {
+		verbose("%pJ no longer waiting for node boot", job_ptr);
+		return -1;
+	}
+
+	/* Only the nodes still booting are checked on later passes */
+	i_first = bit_ffs(wait_boot_arg->node_bitmap);
+	if (i_first >= 0)
+		i_last = bit_fls(wait_boot_arg->node_bitmap);
+	else
+		i_last = i_first - 1;
+	for (i = i_first; i <= i_last; i++) {
+		if (!bit_test(wait_boot_arg->node_bitmap, i))
+			continue;
+		node_ptr = node_record_table_ptr + i;
+		if (node_ptr->boot_time >= wait_boot_arg->start_time)
+			bit_clear(wait_boot_arg->node_bitmap, i);
+	}
+	wait_node_cnt = bit_set_count(wait_boot_arg->node_bitmap);
+
+	if (wait_node_cnt) {
+		debug("%pJ still waiting for %d of %d nodes to boot",
+		      job_ptr, wait_node_cnt, wait_boot_arg->node_cnt);
+	} else {
+		info("%pJ boot complete for all %d nodes",
+		     job_ptr, wait_boot_arg->node_cnt);
+		return 1;
+	}
+	i = (int) difftime(time(NULL), wait_boot_arg->start_time);
+	if (i >= slurm_conf.resume_timeout) {
+		error("%pJ timeout waiting for node %d of %d boots",
+		      job_ptr, wait_node_cnt, wait_boot_arg->node_cnt);
+		wait_boot_arg->timeout = true;
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * A single agent tracks the node boots of all jobs in wait_boot_list. It is
+ * woken by wait_boot_notify() when a rebooted node registers, or every
+ * WAIT_BOOT_POLL seconds to enforce ResumeTimeout.
+ */
+static void *_wait_boot(void *arg)
+{
 	/* Locks: Write jobs; read nodes */
 	slurmctld_lock_t job_write_lock = {
 		READ_LOCK, WRITE_LOCK, READ_LOCK, NO_LOCK, NO_LOCK };
 	/* Locks: Write jobs; write nodes */
 	slurmctld_lock_t node_write_lock = {
 		READ_LOCK, WRITE_LOCK, WRITE_LOCK, NO_LOCK, READ_LOCK };
-	node_record_t *node_ptr;
-	time_t start_time = time(NULL);
-	int i, total_node_cnt, wait_node_cnt;
-	bool job_timeout = false;
+	List done_list = list_create(_wait_boot_arg_free);
+	ListIterator iter;
+	wait_boot_arg_t *wait_boot_arg;
+	job_record_t *job_ptr;
+	struct timespec ts = {0, 0};
+	int rc;
 
 	/*
-	 * This adds the process to the list, we don't need the return pointer
+	 * track_script_flush() cancels this thread on shutdown. Only allow
+	 * that while no lock is held.
 	 */
-	(void)track_script_rec_add(wait_boot_arg->job_id, 0, pthread_self());
+	pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+	track_script_rec_add(0, 0, pthread_self());
 
-	do {
-		sleep(5);
-		total_node_cnt = wait_node_cnt = 0;
-		lock_slurmctld(job_write_lock);
-		if (!(job_ptr = find_job_record(wait_boot_arg->job_id))) {
-			error("%s: JobId=%u vanished while waiting for node boot",
-			      __func__, wait_boot_arg->job_id);
-			unlock_slurmctld(job_write_lock);
-			track_script_remove(pthread_self());
-			return NULL;
-		}
-		if (IS_JOB_PENDING(job_ptr) ||	/* Job requeued or killed */
-		    IS_JOB_FINISHED(job_ptr) ||
-		    !job_ptr->node_bitmap) {
-			verbose("%pJ no longer waiting for node boot",
-				job_ptr);
-			unlock_slurmctld(job_write_lock);
-			track_script_remove(pthread_self());
-			return NULL;
-		}
-		for (i = 0, node_ptr = node_record_table_ptr;
-		     i < node_record_count; i++, node_ptr++) {
-			if (!bit_test(boot_node_bitmap, i))
-				continue;
-			total_node_cnt++;
-			if (node_ptr->boot_time < start_time)
-				wait_node_cnt++;
+	while (1) {
+		slurm_mutex_lock(&wait_boot_mutex);
+		if (!list_count(wait_boot_list)) {
+			wait_boot_agent_running = false;
+			slurm_mutex_unlock(&wait_boot_mutex);
+			break;
 		}
-		if (wait_node_cnt) {
-			debug("%pJ still waiting for %d of %d nodes to boot",
-			      job_ptr, wait_node_cnt, total_node_cnt);
-		} else {
-			info("%pJ boot complete for all %d nodes",
-			     job_ptr, total_node_cnt);
+		if (!wait_boot_event) {
+			ts.tv_sec = time(NULL) + WAIT_BOOT_POLL;
+			slurm_cond_timedwait(&wait_boot_cond, &wait_boot_mutex,
+					     &ts);
 		}
-		i = (int) difftime(time(NULL), start_time);
-		if (i >= slurm_conf.resume_timeout) {
-			error("%pJ timeout waiting for node %d of %d boots",
-			      job_ptr, wait_node_cnt, total_node_cnt);
-			wait_node_cnt = 0;
-			job_timeout = true;
+		wait_boot_event = false;
+		slurm_mutex_unlock(&wait_boot_mutex);
+
+		pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+		pthread_testcancel();
+		pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+
+		lock_slurmctld(job_write_lock);
+		slurm_mutex_lock(&wait_boot_mutex);
+		iter = list_iterator_create(wait_boot_list);
+		while ((wait_boot_arg = list_next(iter))) {
+			if (!(rc = _wait_boot_test(wait_boot_arg)))
+				continue;
+			list_remove(iter);
+			if (rc > 0)
+				list_append(done_list, wait_boot_arg);
+			else
+				_wait_boot_arg_free(wait_boot_arg);
 		}
+		list_iterator_destroy(iter);
+		slurm_mutex_unlock(&wait_boot_mutex);
 		unlock_slurmctld(job_write_lock);
-	} while (wait_node_cnt);
 
-	lock_slurmctld(node_write_lock);
-	if (!(job_ptr = find_job_record(wait_boot_arg->job_id))) {
-		error("%s: missing JobId=%u after node_write_lock acquired",
-		      __func__, wait_boot_arg->job_id);
-	} else {
-		if (job_timeout)
-			(void) job_requeue(getuid(), job_ptr->job_id, NULL, false, 0);
-		prolog_running_decr(job_ptr);
+		if (!list_count(done_list))
+			continue;
+
+		lock_slurmctld(node_write_lock);
+		while ((wait_boot_arg = list_pop(done_list))) {
+			if (!(job_ptr = find_job_record(wait_boot_arg->job_id))) {
+				error("%s: missing JobId=%u after node_write_lock acquired",
+				      __func__, wait_boot_arg->job_id);
+			} else {
+				if (wait_boot_arg->timeout)
+					(void) job_requeue(getuid(),
+							   job_ptr->job_id,
+							   NULL, false, 0);
+				prolog_running_decr(job_ptr);
+			}
+			_wait_boot_arg_free(wait_boot_arg);
+		}
+		unlock_slurmctld(node_write_lock);
 	}
-	unlock_slurmctld(node_write_lock);
 
-	FREE_NULL_BITMAP(wait_boot_arg->node_bitmap);
-	xfree(arg);
+	FREE_NULL_LIST(done_list);
 	track_script_remove(pthread_self());
 	return NULL;
 }
@@ -4384,42 +4647,59 @@ static void *_wait_boot(void *arg)
  * Deferring this setup ensures that all calling paths into select_nodes()
  * have had a chance to update all appropriate job records.
  * This works since select_nodes() will always be holding the job_write lock,
- * and thus this new thread will be blocked waiting to acquire job_write
+ * and thus this thread will be blocked waiting to acquire job_write
  * until that has completed.
  * For HetJobs in particular, this is critical to ensure that all components
  * have been setup properly before prolog_slurmctld actually runs.
  *
- * FIXME: explore other ways to refactor slurmctld to avoid this extraneous
- * thread
+ * A single agent thread drains all queued jobs, taking the slurmctld locks
+ * once per batch rather than spawning one thread per job started.
  */
 static void *_start_prolog_slurmctld_thread(void *x)
 {
 	slurmctld_lock_t node_write_lock = {
 		.conf = READ_LOCK, .job = WRITE_LOCK,
 		.node = WRITE_LOCK, .fed = READ_LOCK };
-	uint32_t *job_id = (uint32_t *) x;
+	uint32_t *job_ids;
+	int i, job_cnt;
 	job_record_t *job_ptr;
 
-	lock_slurmctld(node_write_lock);
-	if (!(job_ptr = find_job_record(*job_id))) {
-		error("%s: missing JobId=%u", __func__, *job_id);
-		unlock_slurmctld(node_write_lock);
-		return NULL;
-	}
-	prep_prolog_slurmctld(job_ptr);
+	while (1) {
+		slurm_mutex_lock(&prolog_mutex);
+		if (!prolog_job_cnt) {
+			prolog_agent_running = false;
+			slurm_mutex_unlock(&prolog_mutex);
+			break;
+		}
+		job_ids = prolog_job_ids;
+		job_cnt = prolog_job_cnt;
+		prolog_job_ids = NULL;
+		prolog_job_cnt = prolog_job_size = 0;
+		slurm_mutex_unlock(&prolog_mutex);
+
+		lock_slurmctld(node_write_lock);
+		for (i = 0; i < job_cnt; i++) {
+			if (!(job_ptr = find_job_record(job_ids[i]))) {
+				error("%s: missing JobId=%u",
+				      __func__, job_ids[i]);
+				continue;
+			}
+			prep_prolog_slurmctld(job_ptr);
 
-	/*
-	 * No async prolog_slurmctld threads running, so decrement now to move
-	 * on with the job launch.
-	 */
-	if (!job_ptr->prep_prolog_cnt) {
-		debug2("%s: no async prolog_slurmctld running", __func__);
-		prolog_running_decr(job_ptr);
+			/*
+			 * No async prolog_slurmctld threads running, so
+			 * decrement now to move on with the job launch.
+			 */
+			if (!job_ptr->prep_prolog_cnt) {
+				debug2("%s: no async prolog_slurmctld running",
+				       __func__);
+				prolog_running_decr(job_ptr);
+			}
+		}
+		unlock_slurmctld(node_write_lock);
+		xfree(job_ids);
 	}
 
-	unlock_slurmctld(node_write_lock);
-	xfree(job_id);
-
 	return NULL;
 }
 
@@ -4430,15 +4710,26 @@ static void *_start_prolog_slurmctld_thread(void *x)
  */
 extern void prolog_slurmctld(job_record_t *job_ptr)
 {
-	uint32_t *job_id = xmalloc(sizeof(*job_id));
 	xassert(verify_lock(JOB_LOCK, WRITE_LOCK));
 	xassert(verify_lock(NODE_LOCK, WRITE_LOCK));
 
 	job_ptr->details->prolog_running++;
 	job_ptr->job_state |= JOB_CONFIGURING;
 
-	*job_id = job_ptr->job_id;
-	slurm_thread_create_detached(NULL, _start_prolog_slurmctld_thread, job_id);
+	slurm_mutex_lock(&prolog_mutex);
+	if (prolog_job_cnt >= prolog_job_size) {
+		prolog_job_size = MAX(prolog_job_size * 2, 64);
+		xrealloc(prolog_job_ids,
+			 sizeof(*prolog_job_ids) * prolog_job_size);
+	}
+	prolog_job_ids[prolog_job_cnt++] = job_ptr->job_id;
+	if (!prolog_agent_running) {
+		prolog_agent_running = true;
+		slurm_thread_create_detached(NULL,
+					     _start_prolog_slurmctld_thread,
+					     NULL);
+	}
+	slurm_mutex_unlock(&prolog_mutex);
 }
 
 /* Decrement a job's prolog_running counter and launch the job if zero */
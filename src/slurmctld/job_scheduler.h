@@ -56,6 +56,12 @@ typedef struct job_queue_rec {
 					 * in without requesting */
 } job_queue_rec_t;
 
+/* Binary heap of job_queue_rec_t, see job_queue_heap_create() */
+typedef struct {
+	int cnt;			/* Records in the heap */
+	job_queue_rec_t **recs;		/* recs[0] is the next to pop */
+} job_queue_heap_t;
+
 /* Use as return values for test_job_dependency. */
 enum {
 	NO_DEPEND = 0,
@@ -202,6 +208,9 @@ extern void prolog_slurmctld(job_record_t *job_ptr);
  */
 extern int reboot_job_nodes(job_record_t *job_ptr);
 
+/* Note that a node rebooted by reboot_job_nodes() has registered */
+extern void wait_boot_notify(void);
+
 /* If a job can run in multiple partitions, make sure that the one 
  * actually used is first in the string. Needed for job state save/restore */
 extern void rebuild_job_part_list(job_record_t *job_ptr);
@@ -240,6 +249,26 @@ extern void sort_job_queue(List job_queue);
  *	in order of decreasing priority */
 extern int sort_job_queue2(void *x, void *y);
 
+/*
+ * job_queue_heap_create - move the records of a job_queue previously made by
+ *	build_job_queue() into a heap ordered by sort_job_queue2()
+ * IN/OUT job_queue - emptied, must still be freed by the caller
+ * RET the heap, free with job_queue_heap_destroy()
+ * NOTE: Building the heap is linear in the number of records and each pop
+ *	is logarithmic, so a scheduling pass that stops early never pays for
+ *	ordering the records it does not reach.
+ */
+extern job_queue_heap_t *job_queue_heap_create(List job_queue);
+
+/*
+ * job_queue_heap_pop - remove the highest priority record from the heap
+ * RET the record, which the caller must xfree(), or NULL if the heap is empty
+ */
+extern job_queue_rec_t *job_queue_heap_pop(job_queue_heap_t *heap);
+
+/* job_queue_heap_destroy - free the heap and any records still in it */
+extern void job_queue_heap_destroy(job_queue_heap_t *heap);
+
 /*
  * Determine if a job's dependencies are met
  * Inputs: job_ptr
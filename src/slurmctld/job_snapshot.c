@@ -0,0 +1,290 @@
+/*****************************************************************************\
+ *  job_snapshot.c - shared, pre-packed copies of the job table
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <pthread.h>
+
+#include "src/common/list.h"
+#include "src/common/log.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "src/slurmctld/job_snapshot.h"
+#include "src/slurmctld/locks.h"
+#include "src/slurmctld/slurmctld.h"
+
+/*
+ * Packed job data depends on the time (e.g. the expected start time of pending
+ * jobs), so a snapshot is only shared for a short period even if no job has
+ * changed.
+ */
+#define JOB_SNAPSHOT_MAX_AGE	2	/* seconds */
+#define JOB_SNAPSHOT_SLOTS	4	/* distinct show_flags/protocol combos */
+
+static bool snapshot_enabled = false;
+static pthread_mutex_t snapshot_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* Serializes packing so concurrent requests share one rebuild */
+static pthread_mutex_t snapshot_build_mutex = PTHREAD_MUTEX_INITIALIZER;
+static job_snapshot_t *snapshot_cache[JOB_SNAPSHOT_SLOTS];
+
+static void _snapshot_free(job_snapshot_t *snap)
+{
+	xfree(snap->data);
+	xfree(snap);
+}
+
+/* Drop one reference. Caller must hold snapshot_mutex. */
+static void _snapshot_unref(job_snapshot_t *snap)
+{
+	xassert(snap->ref_cnt > 0);
+	if (--snap->ref_cnt == 0)
+		_snapshot_free(snap);
+}
+
+static void _snapshot_purge(void)
+{
+	slurm_mutex_lock(&snapshot_mutex);
+	for (int i = 0; i < JOB_SNAPSHOT_SLOTS; i++) {
+		if (snapshot_cache[i])
+			_snapshot_unref(snapshot_cache[i]);
+		snapshot_cache[i] = NULL;
+	}
+	slurm_mutex_unlock(&snapshot_mutex);
+}
+
+extern void job_snapshot_reconfig(void)
+{
+	snapshot_enabled = (xstrcasestr(slurm_conf.slurmctld_params,
+					"job_snapshot") != NULL);
+	_snapshot_purge();
+}
+
+extern void job_snapshot_fini(void)
+{
+	snapshot_enabled = false;
+	_snapshot_purge();
+}
+
+/* Determine if a snapshot is current. Caller must hold snapshot_mutex. */
+static bool _snapshot_valid(job_snapshot_t *snap, time_t now)
+{
+	/*
+	 * last_job_update and last_part_update are read without locks.
+	 * A racing update only means this request is answered with the data
+	 * as it was an instant before the update, just as if the RPC had been
+	 * processed slightly earlier.
+	 */
+	if ((snap->job_update != last_job_update) ||
+	    (snap->part_update != last_part_update))
+		return false;
+	if ((now - snap->build_time) >= JOB_SNAPSHOT_MAX_AGE)
+		return false;
+	return true;
+}
+
+/* Determine if a snapshot may be sent to this user */
+static bool _snapshot_usable(job_snapshot_t *snap, uid_t uid)
+{
+	/*
+	 * Snapshots are packed as for user root, which sees jobs in every
+	 * partition. That is only what other users would see as well if they
+	 * asked for all partitions or if no partition is restricted.
+	 */
+	if ((snap->show_flags & SHOW_ALL) || snap->uid_independent)
+		return true;
+	return validate_slurm_user(uid);
+}
+
+/*
+ * Find a current cached snapshot and reference it.
+ * Caller must hold snapshot_mutex.
+ */
+static job_snapshot_t *_snapshot_find(uint16_t show_flags,
+				      uint16_t protocol_version, time_t now)
+{
+	for (int i = 0; i < JOB_SNAPSHOT_SLOTS; i++) {
+		job_snapshot_t *snap = snapshot_cache[i];
+
+		if (!snap || (snap->show_flags != show_flags) ||
+		    (snap->protocol_version != protocol_version))
+			continue;
+		if (!_snapshot_valid(snap, now))
+			return NULL;
+		snap->ref_cnt++;
+		return snap;
+	}
+
+	return NULL;
+}
+
+/*
+ * Replace the cache slot for this show_flags/protocol_version or the oldest
+ * slot. Caller must hold snapshot_mutex.
+ */
+static void _snapshot_publish(job_snapshot_t *snap)
+{
+	int slot = 0;
+
+	for (int i = 0; i < JOB_SNAPSHOT_SLOTS; i++) {
+		job_snapshot_t *old = snapshot_cache[i];
+
+		if (!old) {
+			slot = i;
+			break;
+		}
+		if ((old->show_flags == snap->show_flags) &&
+		    (old->protocol_version == snap->protocol_version)) {
+			slot = i;
+			break;
+		}
+		if (old->build_time < snapshot_cache[slot]->build_time)
+			slot = i;
+	}
+
+	if (snapshot_cache[slot])
+		_snapshot_unref(snapshot_cache[slot]);
+	snap->ref_cnt++;	/* reference held by the cache */
+	snapshot_cache[slot] = snap;
+}
+
+static int _find_restricted_part(void *x, void *arg)
+{
+	part_record_t *part_ptr = x;
+
+	if ((part_ptr->flags & PART_FLAG_HIDDEN) || part_ptr->allow_groups)
+		return 1;
+	return 0;
+}
+
+/*
+ * Determine if a snapshot built now for these show_flags could be sent to
+ * this user, so that none is packed only to be discarded
+ */
+static bool _snapshot_buildable(uint16_t show_flags, uid_t uid)
+{
+	/* Locks: Read partition */
+	slurmctld_lock_t part_read_lock = {
+		NO_LOCK, NO_LOCK, NO_LOCK, READ_LOCK, NO_LOCK };
+	bool uid_independent;
+
+	if ((show_flags & SHOW_ALL) || validate_slurm_user(uid))
+		return true;
+
+	lock_slurmctld(part_read_lock);
+	uid_independent = !list_find_first(part_list, _find_restricted_part,
+					   NULL);
+	unlock_slurmctld(part_read_lock);
+
+	return uid_independent;
+}
+
+static job_snapshot_t *_snapshot_build(uint16_t show_flags,
+				       uint16_t protocol_version)
+{
+	/* Locks: Read config, job, part and fed, same as REQUEST_JOB_INFO */
+	slurmctld_lock_t job_read_lock = {
+		READ_LOCK, READ_LOCK, NO_LOCK, READ_LOCK, READ_LOCK };
+	job_snapshot_t *snap = xmalloc(sizeof(*snap));
+	int dump_size = 0;
+
+	lock_slurmctld(job_read_lock);
+	snap->job_update = last_job_update;
+	snap->part_update = last_part_update;
+	snap->build_time = time(NULL);
+	snap->protocol_version = protocol_version;
+	snap->show_flags = show_flags;
+	snap->uid_independent =
+		!list_find_first(part_list, _find_restricted_part, NULL);
+	pack_all_jobs(&snap->data, &dump_size, show_flags, 0, NO_VAL,
+		      protocol_version);
+	unlock_slurmctld(job_read_lock);
+	snap->data_size = dump_size;
+
+	return snap;
+}
+
+extern job_snapshot_t *job_snapshot_acquire(uint16_t show_flags, uid_t uid,
+					    uint16_t protocol_version)
+{
+	job_snapshot_t *snap;
+	time_t now = time(NULL);
+
+	if (!snapshot_enabled)
+		return NULL;
+
+	/* Job visibility depends on the requesting user */
+	if ((slurm_conf.private_data & PRIVATE_DATA_JOBS) &&
+	    !validate_operator(uid))
+		return NULL;
+
+	slurm_mutex_lock(&snapshot_mutex);
+	snap = _snapshot_find(show_flags, protocol_version, now);
+	slurm_mutex_unlock(&snapshot_mutex);
+
+	if (!snap) {
+		if (!_snapshot_buildable(show_flags, uid))
+			return NULL;
+		slurm_mutex_lock(&snapshot_build_mutex);
+		/* Another thread may have rebuilt it while we waited */
+		slurm_mutex_lock(&snapshot_mutex);
+		snap = _snapshot_find(show_flags, protocol_version, now);
+		slurm_mutex_unlock(&snapshot_mutex);
+		if (!snap) {
+			snap = _snapshot_build(show_flags, protocol_version);
+			slurm_mutex_lock(&snapshot_mutex);
+			snap->ref_cnt = 1;	/* reference for caller */
+			_snapshot_publish(snap);
+			slurm_mutex_unlock(&snapshot_mutex);
+		}
+		slurm_mutex_unlock(&snapshot_build_mutex);
+	}
+
+	/* Cached snapshots were not checked above, partitions may change */
+	if (!_snapshot_usable(snap, uid)) {
+		job_snapshot_release(snap);
+		return NULL;
+	}
+
+	return snap;
+}
+
+extern void job_snapshot_release(job_snapshot_t *snap)
+{
+	if (!snap)
+		return;
+
+	slurm_mutex_lock(&snapshot_mutex);
+	_snapshot_unref(snap);
+	slurm_mutex_unlock(&snapshot_mutex);
+}
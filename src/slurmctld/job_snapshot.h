@@ -0,0 +1,87 @@
+/*****************************************************************************\
+ *  job_snapshot.h - shared, pre-packed copies of the job table
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _SLURMCTLD_JOB_SNAPSHOT_H
+#define _SLURMCTLD_JOB_SNAPSHOT_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <sys/types.h>
+#include <time.h>
+
+/*
+ * A job snapshot is an immutable, reference counted copy of the packed
+ * RESPONSE_JOB_INFO message body. Once published it is never modified, so
+ * RPC threads may send it to clients without holding any slurmctld locks.
+ */
+typedef struct {
+	time_t build_time;	/* when the snapshot was packed */
+	char *data;		/* packed job_info_msg_t body */
+	uint32_t data_size;	/* bytes in data */
+	time_t job_update;	/* last_job_update when packed */
+	time_t part_update;	/* last_part_update when packed */
+	uint16_t protocol_version;
+	int ref_cnt;		/* protected by snapshot mutex */
+	uint16_t show_flags;
+	bool uid_independent;	/* no hidden or AllowGroups partitions */
+} job_snapshot_t;
+
+/*
+ * Re-read SlurmctldParameters and discard any existing snapshots.
+ * Call after every read of slurm.conf.
+ */
+extern void job_snapshot_reconfig(void);
+
+/*
+ * Get a reference to a snapshot of all jobs usable for a REQUEST_JOB_INFO
+ * from the given user. A new snapshot is packed (under a slurmctld read lock)
+ * if the cached one is out of date.
+ * IN show_flags - job filtering options
+ * IN uid - uid of user making request
+ * IN protocol_version - slurm protocol version of client
+ * RET snapshot or NULL if snapshots are disabled or unusable for this request.
+ *     Release a returned snapshot with job_snapshot_release().
+ * NOTE: Do not call with any slurmctld locks held.
+ */
+extern job_snapshot_t *job_snapshot_acquire(uint16_t show_flags, uid_t uid,
+					    uint16_t protocol_version);
+
+/* Drop a reference obtained from job_snapshot_acquire() */
+extern void job_snapshot_release(job_snapshot_t *snap);
+
+/* Free all cached snapshots, used at shutdown */
+extern void job_snapshot_fini(void);
+
+#endif /* _SLURMCTLD_JOB_SNAPSHOT_H */
@@ -102,10 +102,52 @@ extern bool verify_lock(lock_datatype_t datatype, lock_level_t level)
 }
 #endif
 
+/*
+ * Acquisitions that have to wait longer than this (in usec) for the
+ * slurmctld locks are logged along with the calling function.
+ */
+#define LOCK_WAIT_REPORT 1000000
+
+static char *_lock_level_str(lock_level_t level)
+{
+	if (level == READ_LOCK)
+		return "R";
+	if (level == WRITE_LOCK)
+		return "W";
+	return "-";
+}
+
+/*
+ * Acquire one lock. The blocking call is only timed when the lock could not
+ * be acquired at once, so uncontended locking costs no clock reads.
+ */
+static void _lock_entity(lock_datatype_t datatype, lock_level_t level,
+			 int *wait_usec)
+{
+	struct timeval tv = { 0, 0 };
+
+	if (level == READ_LOCK) {
+		if (!slurm_rwlock_tryrdlock(&slurmctld_locks[datatype]))
+			return;
+		(void) slurm_delta_tv(&tv);
+		slurm_rwlock_rdlock(&slurmctld_locks[datatype]);
+	} else if (level == WRITE_LOCK) {
+		if (!slurm_rwlock_trywrlock(&slurmctld_locks[datatype]))
+			return;
+		(void) slurm_delta_tv(&tv);
+		slurm_rwlock_wrlock(&slurmctld_locks[datatype]);
+	} else
+		return;
+
+	*wait_usec += slurm_delta_tv(&tv);
+}
+
 /* lock_slurmctld - Issue the required lock requests in a well defined order */
-extern void lock_slurmctld(slurmctld_lock_t lock_levels)
+extern void lock_slurmctld_caller(slurmctld_lock_t lock_levels,
+				  const char *caller)
 {
 	static bool init_run = false;
+	int wait_usec = 0;
 	xassert(_store_locks(lock_levels));
 
 	if (!init_run) {
@@ -114,30 +156,19 @@ extern void lock_slurmctld(slurmctld_lock_t lock_levels)
 			slurm_rwlock_init(&slurmctld_locks[i]);
 	}
 
-	if (lock_levels.conf == READ_LOCK)
-		slurm_rwlock_rdlock(&slurmctld_locks[CONF_LOCK]);
-	else if (lock_levels.conf == WRITE_LOCK)
-		slurm_rwlock_wrlock(&slurmctld_locks[CONF_LOCK]);
-
-	if (lock_levels.job == READ_LOCK)
-		slurm_rwlock_rdlock(&slurmctld_locks[JOB_LOCK]);
-	else if (lock_levels.job == WRITE_LOCK)
-		slurm_rwlock_wrlock(&slurmctld_locks[JOB_LOCK]);
-
-	if (lock_levels.node == READ_LOCK)
-		slurm_rwlock_rdlock(&slurmctld_locks[NODE_LOCK]);
-	else if (lock_levels.node == WRITE_LOCK)
-		slurm_rwlock_wrlock(&slurmctld_locks[NODE_LOCK]);
-
-	if (lock_levels.part == READ_LOCK)
-		slurm_rwlock_rdlock(&slurmctld_locks[PART_LOCK]);
-	else if (lock_levels.part == WRITE_LOCK)
-		slurm_rwlock_wrlock(&slurmctld_locks[PART_LOCK]);
-
-	if (lock_levels.fed == READ_LOCK)
-		slurm_rwlock_rdlock(&slurmctld_locks[FED_LOCK]);
-	else if (lock_levels.fed == WRITE_LOCK)
-		slurm_rwlock_wrlock(&slurmctld_locks[FED_LOCK]);
+	_lock_entity(CONF_LOCK, lock_levels.conf, &wait_usec);
+	_lock_entity(JOB_LOCK, lock_levels.job, &wait_usec);
+	_lock_entity(NODE_LOCK, lock_levels.node, &wait_usec);
+	_lock_entity(PART_LOCK, lock_levels.part, &wait_usec);
+	_lock_entity(FED_LOCK, lock_levels.fed, &wait_usec);
+
+	if (wait_usec >= LOCK_WAIT_REPORT)
+		debug("%s: waited %d usec for locks config:%s, job:%s, node:%s, partition:%s, federation:%s",
+		      caller, wait_usec, _lock_level_str(lock_levels.conf),
+		      _lock_level_str(lock_levels.job),
+		      _lock_level_str(lock_levels.node),
+		      _lock_level_str(lock_levels.part),
+		      _lock_level_str(lock_levels.fed));
 }
 
 /* unlock_slurmctld - Issue the required unlock requests in a well
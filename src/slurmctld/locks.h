@@ -126,8 +126,14 @@ extern bool verify_lock(lock_datatype_t datatype, lock_level_t level);
  *	control */
 extern void init_locks ( void );
 
-/* lock_slurmctld - Issue the required lock requests in a well defined order */
-extern void lock_slurmctld (slurmctld_lock_t lock_levels);
+/*
+ * lock_slurmctld - Issue the required lock requests in a well defined order
+ * Long waits for the locks are logged with the name of the calling function.
+ */
+#define lock_slurmctld(lock_levels) \
+	lock_slurmctld_caller(lock_levels, __func__)
+extern void lock_slurmctld_caller(slurmctld_lock_t lock_levels,
+				  const char *caller);
 
 /* unlock_slurmctld - Issue the required unlock requests in a well
  *	defined order */
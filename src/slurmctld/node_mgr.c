@@ -74,6 +74,7 @@
 
 #include "src/slurmctld/agent.h"
 #include "src/slurmctld/front_end.h"
+#include "src/slurmctld/job_scheduler.h"
 #include "src/slurmctld/locks.h"
 #include "src/slurmctld/ping_nodes.h"
 #include "src/slurmctld/proc_req.h"
@@ -2308,7 +2309,10 @@ extern int validate_node_specs(slurm_node_registration_status_msg_t *reg_msg,
 
 	if (waiting_for_node_boot(node_ptr))
 		return SLURM_SUCCESS;
-	bit_clear(booting_node_bitmap, node_inx);
+	if (bit_test(booting_node_bitmap, node_inx)) {
+		bit_clear(booting_node_bitmap, node_inx);
+		wait_boot_notify();
+	}
 
 	if (cr_flag == NO_VAL) {
 		cr_flag = 0;  /* call is no-op for select/linear and others */
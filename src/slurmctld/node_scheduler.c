@@ -4268,8 +4268,9 @@ static int _nodes_in_sets(bitstr_t *req_bitmap,
 extern void build_node_details(job_record_t *job_ptr, bool new_alloc)
 {
 	hostlist_t host_list = NULL;
+	hostlist_iterator_t host_iter;
 	node_record_t *node_ptr;
-	char *this_node_name;
+	char this_node_name[HOSTLIST_NAME_LEN];
 	int node_inx = 0;
 
 	if ((job_ptr->node_bitmap == NULL) || (job_ptr->nodes == NULL)) {
@@ -4310,7 +4311,9 @@ extern void build_node_details(job_record_t *job_ptr, bool new_alloc)
 	xfree(job_ptr->batch_host);
 #endif
 
-	while ((this_node_name = hostlist_shift(host_list))) {
+	host_iter = hostlist_iterator_create(host_list);
+	while (hostlist_next_buf(host_iter, this_node_name,
+				 sizeof(this_node_name))) {
 		if ((node_ptr = find_node_record(this_node_name))) {
 			memcpy(&job_ptr->node_addr[node_inx++],
 			       &node_ptr->slurm_addr, sizeof(slurm_addr_t));
@@ -4326,8 +4329,8 @@ extern void build_node_details(job_record_t *job_ptr, bool new_alloc)
 			 */
 			job_ptr->batch_host = xstrdup(this_node_name);
 		}
-		free(this_node_name);
 	}
+	hostlist_iterator_destroy(host_iter);
 	hostlist_destroy(host_list);
 	if (job_ptr->node_cnt != node_inx) {
 		error("Node count mismatch for %pJ (%u,%u)",
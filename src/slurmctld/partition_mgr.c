@@ -168,10 +168,11 @@ extern void set_partition_tres()
  */
 extern int build_part_bitmap(part_record_t *part_ptr)
 {
-	char *this_node_name;
+	char this_node_name[HOSTLIST_NAME_LEN];
 	bitstr_t *old_bitmap;
 	node_record_t *node_ptr;
 	hostlist_t host_list;
+	hostlist_iterator_t host_iter;
 	int i;
 
 	part_ptr->total_cpus = 0;
@@ -207,13 +208,15 @@ extern int build_part_bitmap(part_record_t *part_ptr)
 		return ESLURM_INVALID_NODE_NAME;
 	}
 
-	while ((this_node_name = hostlist_shift(host_list))) {
+	host_iter = hostlist_iterator_create(host_list);
+	while (hostlist_next_buf(host_iter, this_node_name,
+				 sizeof(this_node_name))) {
 		node_ptr = find_node_record_no_alias(this_node_name);
 		if (node_ptr == NULL) {
 			error("build_part_bitmap: invalid node name %s",
 				this_node_name);
-			free(this_node_name);
 			FREE_NULL_BITMAP(old_bitmap);
+			hostlist_iterator_destroy(host_iter);
 			hostlist_destroy(host_list);
 			return ESLURM_INVALID_NODE_NAME;
 		}
@@ -240,8 +243,8 @@ extern int build_part_bitmap(part_record_t *part_ptr)
 					 node_record_table_ptr));
 		bit_set(part_ptr->node_bitmap,
 			(int) (node_ptr - node_record_table_ptr));
-		free(this_node_name);
 	}
+	hostlist_iterator_destroy(host_iter);
 	hostlist_destroy(host_list);
 
 	_unlink_free_nodes(old_bitmap, part_ptr);
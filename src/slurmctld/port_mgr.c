@@ -53,6 +53,9 @@ bitstr_t **port_resv_table = (bitstr_t **) NULL;
 int        port_resv_cnt   = 0;
 int        port_resv_min   = 0;
 int        port_resv_max   = 0;
+/* Set for each port reserved on at least one node, lets resv_port_alloc()
+ * accept idle ports without scanning their node bitmap */
+static bitstr_t *port_resv_used = NULL;
 
 static void _dump_resv_port_info(void);
 static void _make_all_resv(void);
@@ -130,6 +133,7 @@ static void _make_step_resv(step_record_t *step_ptr)
 			continue;
 		j = step_ptr->resv_port_array[i] - port_resv_min;
 		bit_or(port_resv_table[j], step_ptr->step_node_bitmap);
+		bit_set(port_resv_used, j);
 	}
 }
 
@@ -169,6 +173,7 @@ extern int reserve_port_config(char *mpi_params)
 			for (i=0; i<port_resv_cnt; i++)
 				FREE_NULL_BITMAP(port_resv_table[i]);
 			xfree(port_resv_table);
+			FREE_NULL_BITMAP(port_resv_used);
 			port_resv_cnt = 0;
 			port_resv_min = port_resv_max = 0;
 		}
@@ -193,16 +198,21 @@ extern int reserve_port_config(char *mpi_params)
 		return SLURM_SUCCESS;	/* No change */
 	}
 
+	for (i=0; i<port_resv_cnt; i++)
+		FREE_NULL_BITMAP(port_resv_table[i]);
+	xfree(port_resv_table);
+	FREE_NULL_BITMAP(port_resv_used);
+
 	port_resv_min = p_min;
 	port_resv_max = p_max;
 	port_resv_cnt = p_max - p_min + 1;
 	debug("Ports available for reservation %u-%u",
 	      port_resv_min, port_resv_max);
 
-	xfree(port_resv_table);
 	port_resv_table = xmalloc(sizeof(bitstr_t *) * port_resv_cnt);
 	for (i=0; i<port_resv_cnt; i++)
 		port_resv_table[i] = bit_alloc(node_record_count);
+	port_resv_used = bit_alloc(port_resv_cnt);
 
 	_make_all_resv();
 	_dump_resv_port_info();
@@ -238,7 +248,8 @@ extern int resv_port_alloc(step_record_t *step_ptr)
 	for (i=0; i<port_resv_cnt; i++) {
 		if (++last_port_alloc >= port_resv_cnt)
 			last_port_alloc = 0;
-		if (bit_overlap_any(step_ptr->step_node_bitmap,
+		if (bit_test(port_resv_used, last_port_alloc) &&
+		    bit_overlap_any(step_ptr->step_node_bitmap,
 				    port_resv_table[last_port_alloc]))
 			continue;
 		port_array[port_inx++] = last_port_alloc;
@@ -257,6 +268,7 @@ extern int resv_port_alloc(step_record_t *step_ptr)
 	for (i=0; i<port_inx; i++) {
 		bit_or(port_resv_table[port_array[i]],
 		       step_ptr->step_node_bitmap);
+		bit_set(port_resv_used, port_array[i]);
 		port_array[i] += port_resv_min;
 		snprintf(port_str, sizeof(port_str), "%d", port_array[i]);
 		hostlist_push_host(hl, port_str);
@@ -288,7 +300,8 @@ extern void resv_port_free(step_record_t *step_ptr)
 			continue;
 		j = step_ptr->resv_port_array[i] - port_resv_min;
 		bit_and_not(port_resv_table[j], step_ptr->step_node_bitmap);
-
+		if (bit_ffs(port_resv_table[j]) == -1)
+			bit_clear(port_resv_used, j);
 	}
 	xfree(step_ptr->resv_port_array);
 
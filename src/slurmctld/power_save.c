@@ -73,11 +73,15 @@
 #define MAX_SHUTDOWN_DELAY	10	/* seconds to wait for child procs
 					 * to exit after daemon shutdown
 					 * request, then orphan or kill proc */
+#define RESUME_BACKOFF_MIN	10	/* initial delay of new resumes after
+					 * ResumeProgram failure, seconds */
+
 
 /* Records for tracking processes forked to suspend/resume nodes */
 typedef struct proc_track_struct {
 	pid_t  child_pid;	/* pid of process		*/
 	time_t child_time;	/* start time of process	*/
+	bool   resume;		/* process is ResumeProgram	*/
 } proc_track_struct_t;
 static List proc_track_list = NULL;
 
@@ -107,6 +111,8 @@ bitstr_t *exc_node_bitmap = NULL;
 bitstr_t *resume_node_bitmap = NULL;
 int   suspend_cnt,   resume_cnt;
 float suspend_cnt_f, resume_cnt_f;
+static int resume_backoff = 0;		/* current backoff delay, seconds */
+static time_t resume_backoff_time = 0;	/* defer new resumes until then */
 
 static void  _clear_power_config(void);
 static void  _do_failed_nodes(char *hosts);
@@ -117,6 +123,7 @@ static int   _init_power_config(void);
 static void *_init_power_save(void *arg);
 static int   _kill_procs(void);
 static void  _reap_procs(void);
+static void  _resume_backoff(int rc);
 static void  _re_wake(void);
 static pid_t _run_prog(char *prog, char *arg1, char *arg2, uint32_t job_id);
 static void  _shutdown_power(void);
@@ -260,6 +267,7 @@ static void _do_power_work(time_t now)
 	bitstr_t *avoid_node_bitmap = NULL, *failed_node_bitmap = NULL;
 	bitstr_t *wake_node_bitmap = NULL, *sleep_node_bitmap = NULL;
 	node_record_t *node_ptr;
+	bool resume_ok = (now >= resume_backoff_time);
 
 	if (last_work_scan == 0) {
 		if (exc_nodes && (_parse_exc_nodes() != SLURM_SUCCESS))
@@ -336,7 +344,7 @@ static void _do_power_work(time_t now)
 			susp_total++;
 
 		/* Resume nodes as appropriate */
-		if (susp_state &&
+		if (susp_state && resume_ok &&
 		    ((resume_rate == 0) || (resume_cnt < resume_rate))	&&
 		    !IS_NODE_POWERING_DOWN(node_ptr) &&
 		    (IS_NODE_ALLOCATED(node_ptr) ||
@@ -725,11 +733,39 @@ static pid_t _run_prog(char *prog, char *arg1, char *arg2, uint32_t job_id)
 		proc_track = xmalloc(sizeof(proc_track_struct_t));
 		proc_track->child_pid = child;
 		proc_track->child_time = time(NULL);
+		proc_track->resume = (prog == resume_prog);
 		list_append(proc_track_list, proc_track);
 	}
 	return child;
 }
 
+/*
+ * Track ResumeProgram failures. A failure (e.g. the cloud provider rejecting
+ * requests) defers starting new resumes for an exponentially growing delay,
+ * capped at ResumeTimeout, so that a struggling backend is not flooded with
+ * more requests. A successful run clears the backoff.
+ */
+static void _resume_backoff(int rc)
+{
+	if (rc == 0) {
+		if (resume_backoff && power_save_debug)
+			info("power_save: ResumeProgram recovered");
+		resume_backoff = 0;
+		resume_backoff_time = 0;
+		return;
+	}
+
+	if (resume_backoff == 0)
+		resume_backoff = RESUME_BACKOFF_MIN;
+	else
+		resume_backoff *= 2;
+	resume_backoff = MIN(resume_backoff,
+			     MAX(resume_timeout, RESUME_BACKOFF_MIN));
+	resume_backoff_time = time(NULL) + resume_backoff;
+	info("power_save: deferring node resumes for %d sec after ResumeProgram failure",
+	     resume_backoff);
+}
+
 /* reap child processes previously forked to modify node state. */
 static void _reap_procs(void)
 {
@@ -760,8 +796,12 @@ static void _reap_procs(void)
 		} else if (WIFSIGNALED(status)) {
 			error("power_save: program signaled: %s",
 			      strsignal(WTERMSIG(status)));
+			rc = -1;
 		}
 
+		if (proc_track->resume)
+			_resume_backoff(rc);
+
 		list_delete_item(iter);
 	}
 	list_iterator_destroy(iter);
@@ -849,6 +889,8 @@ static int _init_power_config(void)
 	last_config = slurm_conf.last_update;
 	last_work_scan  = 0;
 	last_log	= 0;
+	resume_backoff	= 0;
+	resume_backoff_time = 0;
 	idle_time = slurm_conf.suspend_time - 1;
 	suspend_rate = slurm_conf.suspend_rate;
 	resume_timeout = slurm_conf.resume_timeout;
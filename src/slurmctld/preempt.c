@@ -63,9 +63,16 @@ typedef struct slurm_preempt_ops {
 				     void *data);
 } slurm_preempt_ops_t;
 
+typedef struct {
+	job_record_t *job_ptr;
+	uint32_t prio;
+} preempt_cand_t;
+
 typedef struct {
 	job_record_t *preemptor;
-	List preemptee_job_list;
+	preempt_cand_t *cand;
+	int cand_cnt;
+	int cand_size;
 } preempt_candidates_t;
 
 /*
@@ -174,27 +181,25 @@ static int _add_preemptable_job(void *x, void *arg)
 		return 0;
 
 	/* This job is a preemption candidate */
-	if (!candidates->preemptee_job_list)
-		candidates->preemptee_job_list = list_create(NULL);
-
-	list_append(candidates->preemptee_job_list, candidate);
+	if (candidates->cand_cnt >= candidates->cand_size) {
+		candidates->cand_size = MAX(64, candidates->cand_size * 2);
+		xrecalloc(candidates->cand, candidates->cand_size,
+			  sizeof(preempt_cand_t));
+	}
+	candidates->cand[candidates->cand_cnt++].job_ptr = candidate;
 
 	return 0;
 }
 
-static int _sort_by_prio(void *x, void *y)
+static int _sort_by_prio(const void *x, const void *y)
 {
 	int rc;
-	uint32_t job_prio1, job_prio2;
-	job_record_t *j1 = *(job_record_t **)x;
-	job_record_t *j2 = *(job_record_t **)y;
-
-	(void)(*(ops.get_data))(j1, PREEMPT_DATA_PRIO, &job_prio1);
-	(void)(*(ops.get_data))(j2, PREEMPT_DATA_PRIO, &job_prio2);
+	const preempt_cand_t *c1 = x;
+	const preempt_cand_t *c2 = y;
 
-	if (job_prio1 > job_prio2)
+	if (c1->prio > c2->prio)
 		rc = 1;
-	else if (job_prio1 < job_prio2)
+	else if (c1->prio < c2->prio)
 		rc = -1;
 	else
 		rc = 0;
@@ -202,11 +207,11 @@ static int _sort_by_prio(void *x, void *y)
 	return rc;
 }
 
-static int _sort_by_youngest(void *x, void *y)
+static int _sort_by_youngest(const void *x, const void *y)
 {
 	int rc;
-	job_record_t *j1 = *(job_record_t **) x;
-	job_record_t *j2 = *(job_record_t **) y;
+	job_record_t *j1 = ((const preempt_cand_t *) x)->job_ptr;
+	job_record_t *j2 = ((const preempt_cand_t *) y)->job_ptr;
 
 	if (j1->start_time < j2->start_time)
 		rc = 1;
@@ -273,6 +278,8 @@ extern int slurm_preempt_fini(void)
 extern List slurm_find_preemptable_jobs(job_record_t *job_ptr)
 {
 	preempt_candidates_t candidates	= { .preemptor = job_ptr };
+	List preemptee_job_list;
+	int i;
 
 	/* Validate the preemptor job */
 	if (!job_ptr) {
@@ -295,13 +302,32 @@ extern List slurm_find_preemptable_jobs(job_record_t *job_ptr)
 
 	/* Build an array of pointers to preemption candidates */
 	list_for_each(job_list, _add_preemptable_job, &candidates);
+	if (!candidates.cand_cnt)
+		return NULL;
+
+	/*
+	 * Get each candidate's priority from the plugin once rather than on
+	 * every comparison made by the sort.
+	 */
+	if (youngest_order) {
+		qsort(candidates.cand, candidates.cand_cnt,
+		      sizeof(preempt_cand_t), _sort_by_youngest);
+	} else {
+		for (i = 0; i < candidates.cand_cnt; i++) {
+			(void)(*(ops.get_data))(candidates.cand[i].job_ptr,
+						PREEMPT_DATA_PRIO,
+						&candidates.cand[i].prio);
+		}
+		qsort(candidates.cand, candidates.cand_cnt,
+		      sizeof(preempt_cand_t), _sort_by_prio);
+	}
 
-	if (candidates.preemptee_job_list && youngest_order)
-		list_sort(candidates.preemptee_job_list, _sort_by_youngest);
-	else if (candidates.preemptee_job_list)
-		list_sort(candidates.preemptee_job_list, _sort_by_prio);
+	preemptee_job_list = list_create(NULL);
+	for (i = 0; i < candidates.cand_cnt; i++)
+		list_append(preemptee_job_list, candidates.cand[i].job_ptr);
+	xfree(candidates.cand);
 
-	return candidates.preemptee_job_list;
+	return preemptee_job_list;
 }
 
 /*
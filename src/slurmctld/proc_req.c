@@ -91,13 +91,16 @@
 #include "src/slurmctld/front_end.h"
 #include "src/slurmctld/gang.h"
 #include "src/slurmctld/job_scheduler.h"
+#include "src/slurmctld/job_snapshot.h"
 #include "src/slurmctld/licenses.h"
 #include "src/slurmctld/locks.h"
 #include "src/slurmctld/power_save.h"
 #include "src/slurmctld/powercapping.h"
 #include "src/slurmctld/proc_req.h"
+#include "src/slurmctld/rate_limit.h"
 #include "src/slurmctld/read_config.h"
 #include "src/slurmctld/reservation.h"
+#include "src/slurmctld/rpc_mgr.h"
 #include "src/slurmctld/sched_plugin.h"
 #include "src/slurmctld/slurmctld.h"
 #include "src/slurmctld/slurmctld_plugstack.h"
@@ -110,6 +113,7 @@ static int rpc_type_size = 0;	/* Size of rpc_type_* arrays */
 static uint16_t *rpc_type_id = NULL;
 static uint32_t *rpc_type_cnt = NULL;
 static uint64_t *rpc_type_time = NULL;
+static uint64_t *rpc_type_max = NULL;
 static int rpc_user_size = 0;	/* Size of rpc_user_* arrays */
 static uint32_t *rpc_user_id = NULL;
 static uint32_t *rpc_user_cnt = NULL;
@@ -128,8 +132,7 @@ static void         _fill_ctld_conf(slurm_conf_t * build_ptr);
 static void         _kill_job_on_msg_fail(uint32_t job_id);
 static int          _is_prolog_finished(uint32_t job_id);
 static int          _make_step_cred(step_record_t *step_rec,
-				    slurm_cred_t **slurm_cred,
-				    uint16_t protocol_version);
+				    slurm_cred_t **slurm_cred);
 inline static void  _proc_multi_msg(uint32_t rpc_uid, slurm_msg_t *msg);
 static int          _route_msg_to_origin(slurm_msg_t *msg, char *job_id_str,
 					 uint32_t job_id, uid_t uid);
@@ -155,6 +158,7 @@ inline static void  _slurm_rpc_dump_conf(slurm_msg_t * msg);
 inline static void  _slurm_rpc_dump_front_end(slurm_msg_t * msg);
 inline static void  _slurm_rpc_dump_jobs(slurm_msg_t * msg);
 inline static void  _slurm_rpc_dump_jobs_user(slurm_msg_t * msg);
+inline static void  _slurm_rpc_dump_jobs_delta(slurm_msg_t *msg);
 inline static void  _slurm_rpc_dump_job_single(slurm_msg_t * msg);
 inline static void  _slurm_rpc_dump_licenses(slurm_msg_t * msg);
 inline static void  _slurm_rpc_dump_nodes(slurm_msg_t * msg);
@@ -181,6 +185,8 @@ inline static void  _slurm_rpc_job_will_run(slurm_msg_t * msg);
 inline static void  _slurm_rpc_job_alloc_info(slurm_msg_t * msg);
 inline static void  _slurm_rpc_het_job_alloc_info(slurm_msg_t * msg);
 inline static void  _slurm_rpc_kill_job(slurm_msg_t *msg);
+inline static void  _slurm_rpc_kill_jobs(slurm_msg_t *msg);
+static void         _slurm_rpc_node_heartbeat(slurm_msg_t *msg);
 inline static void  _slurm_rpc_node_registration(slurm_msg_t *msg,
 						 bool running_composite);
 inline static void  _slurm_rpc_ping(slurm_msg_t * msg);
@@ -209,6 +215,7 @@ inline static void  _slurm_rpc_step_complete(slurm_msg_t * msg,
 inline static void  _slurm_rpc_step_layout(slurm_msg_t * msg);
 inline static void  _slurm_rpc_step_update(slurm_msg_t * msg);
 inline static void  _slurm_rpc_submit_batch_job(slurm_msg_t * msg);
+static void         _slurm_rpc_submit_batch_jobs(slurm_msg_t *msg);
 inline static void  _slurm_rpc_submit_batch_het_job(slurm_msg_t * msg);
 inline static void  _slurm_rpc_suspend(slurm_msg_t * msg);
 inline static void  _slurm_rpc_top_job(slurm_msg_t * msg);
@@ -274,12 +281,18 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 	}
 	rpc_uid = (uint32_t) g_slurm_auth_get_uid(msg->auth_cred);
 
+	if (rate_limit_exceeded(msg, rpc_uid)) {
+		slurm_send_rc_msg(msg, SLURMCTLD_COMMUNICATIONS_BACKOFF);
+		return;
+	}
+
 	slurm_mutex_lock(&rpc_mutex);
 	if (rpc_type_size == 0) {
 		rpc_type_size = 100;  /* Capture info for first 100 RPC types */
 		rpc_type_id   = xmalloc(sizeof(uint16_t) * rpc_type_size);
 		rpc_type_cnt  = xmalloc(sizeof(uint32_t) * rpc_type_size);
 		rpc_type_time = xmalloc(sizeof(uint64_t) * rpc_type_size);
+		rpc_type_max  = xmalloc(sizeof(uint64_t) * rpc_type_size);
 	}
 	for (i = 0; i < rpc_type_size; i++) {
 		if (rpc_type_id[i] == 0)
@@ -342,6 +355,9 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 	case REQUEST_JOB_USER_INFO:
 		_slurm_rpc_dump_jobs_user(msg);
 		break;
+	case REQUEST_JOB_INFO_DELTA:
+		_slurm_rpc_dump_jobs_delta(msg);
+		break;
 	case REQUEST_JOB_INFO_SINGLE:
 		_slurm_rpc_dump_job_single(msg);
 		break;
@@ -410,6 +426,9 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 	case MESSAGE_NODE_REGISTRATION_STATUS:
 		_slurm_rpc_node_registration(msg, 0);
 		break;
+	case MESSAGE_NODE_HEARTBEAT:
+		_slurm_rpc_node_heartbeat(msg);
+		break;
 	case REQUEST_JOB_ALLOCATION_INFO:
 		_slurm_rpc_job_alloc_info(msg);
 		break;
@@ -443,6 +462,9 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 	case REQUEST_SUBMIT_BATCH_HET_JOB:
 		_slurm_rpc_submit_batch_het_job(msg);
 		break;
+	case REQUEST_SUBMIT_BATCH_JOBS:
+		_slurm_rpc_submit_batch_jobs(msg);
+		break;
 	case REQUEST_UPDATE_FRONT_END:
 		_slurm_rpc_update_front_end(msg);
 		break;
@@ -566,6 +588,9 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 	case REQUEST_KILL_JOB:
 		_slurm_rpc_kill_job(msg);
 		break;
+	case REQUEST_KILL_JOBS:
+		_slurm_rpc_kill_jobs(msg);
+		break;
 	case MESSAGE_COMPOSITE:
 		_slurm_rpc_composite_msg(msg);
 		break;
@@ -600,6 +625,8 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 	if (rpc_type_index >= 0) {
 		rpc_type_cnt[rpc_type_index]++;
 		rpc_type_time[rpc_type_index] += DELTA_TIMER;
+		if (rpc_type_max[rpc_type_index] < DELTA_TIMER)
+			rpc_type_max[rpc_type_index] = DELTA_TIMER;
 	}
 	if (rpc_user_index >= 0) {
 		rpc_user_cnt[rpc_user_index]++;
@@ -1167,8 +1194,12 @@ static void _kill_job_on_msg_fail(uint32_t job_id)
 }
 
 /* create a credential for a given job step, return error code */
-static int _make_step_cred(step_record_t *step_ptr, slurm_cred_t **slurm_cred,
-			   uint16_t protocol_version)
+/*
+ * Build the credential for a new step. It is not signed yet, signing (and
+ * the passwd/group lookups that go with it) can be slow so the caller does
+ * it with slurm_cred_sign() after releasing the job write lock.
+ */
+static int _make_step_cred(step_record_t *step_ptr, slurm_cred_t **slurm_cred)
 {
 	slurm_cred_arg_t cred_arg;
 	job_record_t *job_ptr = step_ptr->job_ptr;
@@ -1206,8 +1237,8 @@ static int _make_step_cred(step_record_t *step_ptr, slurm_cred_t **slurm_cred,
 	cred_arg.sockets_per_node    = job_resrcs_ptr->sockets_per_node;
 	cred_arg.sock_core_rep_count = job_resrcs_ptr->sock_core_rep_count;
 
-	*slurm_cred = slurm_cred_create(slurmctld_config.cred_ctx, &cred_arg,
-					protocol_version);
+	*slurm_cred = slurm_cred_create_unsigned(slurmctld_config.cred_ctx,
+						 &cred_arg);
 
 	if (*slurm_cred == NULL) {
 		error("slurm_cred_create error");
@@ -1920,9 +1951,30 @@ static void _slurm_rpc_dump_jobs(slurm_msg_t * msg)
 	slurmctld_lock_t job_read_lock = {
 		READ_LOCK, READ_LOCK, NO_LOCK, READ_LOCK, READ_LOCK };
 	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred);
+	job_snapshot_t *snap = NULL;
 
 	START_TIMER;
 	debug3("Processing RPC: REQUEST_JOB_INFO from uid=%d", uid);
+
+	if (!job_info_request_msg->job_ids &&
+	    (snap = job_snapshot_acquire(job_info_request_msg->show_flags, uid,
+					 msg->protocol_version))) {
+		if ((job_info_request_msg->last_update - 1) >=
+		    snap->job_update) {
+			debug3("_slurm_rpc_dump_jobs, no change");
+			slurm_send_rc_msg(msg, SLURM_NO_CHANGE_IN_DATA);
+		} else {
+			END_TIMER2("_slurm_rpc_dump_jobs");
+			response_init(&response_msg, msg);
+			response_msg.msg_type = RESPONSE_JOB_INFO;
+			response_msg.data = snap->data;
+			response_msg.data_size = snap->data_size;
+			slurm_send_node_msg(msg->conn_fd, &response_msg);
+		}
+		job_snapshot_release(snap);
+		return;
+	}
+
 	lock_slurmctld(job_read_lock);
 
 	if ((job_info_request_msg->last_update - 1) >= last_job_update) {
@@ -1957,6 +2009,37 @@ static void _slurm_rpc_dump_jobs(slurm_msg_t * msg)
 	}
 }
 
+/* _slurm_rpc_dump_jobs_delta - process RPC for changed job information */
+static void _slurm_rpc_dump_jobs_delta(slurm_msg_t *msg)
+{
+	DEF_TIMERS;
+	char *dump;
+	int dump_size;
+	slurm_msg_t response_msg;
+	job_info_delta_request_msg_t *req_msg =
+		(job_info_delta_request_msg_t *) msg->data;
+	/* Locks: Read config job part fed */
+	slurmctld_lock_t job_read_lock = {
+		READ_LOCK, READ_LOCK, NO_LOCK, READ_LOCK, READ_LOCK };
+	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred);
+
+	START_TIMER;
+	debug3("Processing RPC: REQUEST_JOB_INFO_DELTA from uid=%d", uid);
+	lock_slurmctld(job_read_lock);
+	pack_jobs_delta(&dump, &dump_size, req_msg->epoch, req_msg->seq,
+			req_msg->show_flags, uid, msg->protocol_version);
+	unlock_slurmctld(job_read_lock);
+	END_TIMER2("_slurm_rpc_dump_jobs_delta");
+
+	response_init(&response_msg, msg);
+	response_msg.msg_type = RESPONSE_JOB_INFO_DELTA;
+	response_msg.data = dump;
+	response_msg.data_size = dump_size;
+
+	slurm_send_node_msg(msg->conn_fd, &response_msg);
+	xfree(dump);
+}
+
 /* _slurm_rpc_dump_jobs - process RPC for job state information */
 static void _slurm_rpc_dump_jobs_user(slurm_msg_t * msg)
 {
@@ -2845,8 +2928,7 @@ static void _slurm_rpc_job_step_create(slurm_msg_t * msg)
 				 msg->protocol_version);
 
 	if (error_code == SLURM_SUCCESS) {
-		error_code = _make_step_cred(step_rec, &slurm_cred,
-					     step_rec->start_protocol_ver);
+		error_code = _make_step_cred(step_rec, &slurm_cred);
 		ext_sensors_g_get_stepstartdata(step_rec);
 	}
 	END_TIMER2("_slurm_rpc_job_step_create");
@@ -2893,6 +2975,17 @@ static void _slurm_rpc_job_step_create(slurm_msg_t * msg)
 
 		unlock_slurmctld(job_write_lock);
 		_throttle_fini(&active_rpc_cnt);
+
+		if (slurm_cred_sign(slurmctld_config.cred_ctx, slurm_cred,
+				    job_step_resp.use_protocol_ver)) {
+			error("%s: slurm_cred_sign error for JobId=%u StepId=%u",
+			      __func__, req_step_msg->job_id,
+			      job_step_resp.job_step_id);
+			slurm_cred_destroy(slurm_cred);
+			slurm_send_rc_msg(msg, ESLURM_INVALID_JOB_CREDENTIAL);
+			return;
+		}
+
 		response_init(&resp, msg);
 		resp.msg_type = RESPONSE_JOB_STEP_CREATE;
 		resp.data = &job_step_resp;
@@ -3106,6 +3199,38 @@ static void _slurm_rpc_event_log(slurm_msg_t * msg)
 	slurm_send_rc_msg(msg, error_code);
 }
 
+/*
+ * _slurm_rpc_node_heartbeat - record a heartbeat pushed by slurmd with
+ *	CommunicationParameters=SlurmdHeartbeat. This has the same effect as a
+ *	successful ping, so ping_nodes() has no need to ping the node.
+ *	No response is sent.
+ */
+static void _slurm_rpc_node_heartbeat(slurm_msg_t *msg)
+{
+	DEF_TIMERS;
+	node_heartbeat_msg_t *hb_msg = (node_heartbeat_msg_t *) msg->data;
+	/* Locks: Read config, write node */
+	slurmctld_lock_t node_write_lock = {
+		.conf = READ_LOCK, .node = WRITE_LOCK };
+	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred);
+
+	START_TIMER;
+	if (!validate_slurm_user(uid)) {
+		error("Security violation, MESSAGE_NODE_HEARTBEAT RPC from uid=%d",
+		      uid);
+		return;
+	}
+	if (!hb_msg->node_name)
+		return;
+
+	lock_slurmctld(node_write_lock);
+	node_did_resp(hb_msg->node_name);
+	reset_node_load(hb_msg->node_name, hb_msg->cpu_load);
+	reset_node_free_mem(hb_msg->node_name, hb_msg->free_mem);
+	unlock_slurmctld(node_write_lock);
+	END_TIMER2("_slurm_rpc_node_heartbeat");
+}
+
 /* _slurm_rpc_node_registration - process RPC to determine if a node's
  *	actual configuration satisfies the configured specification */
 static void _slurm_rpc_node_registration(slurm_msg_t * msg,
@@ -4425,6 +4550,176 @@ send_msg:
 	xfree(job_submit_user_msg);
 }
 
+static void _free_submit_response(void *x)
+{
+	slurm_free_submit_response_response_msg((submit_response_msg_t *) x);
+}
+
+/*
+ * _slurm_rpc_submit_batch_jobs - process RPC to submit several independent
+ * batch jobs. All jobs are validated under one read lock and created under
+ * one job write lock, and each gets its own result in the response.
+ */
+static void _slurm_rpc_submit_batch_jobs(slurm_msg_t *msg)
+{
+	static int active_rpc_cnt = 0;
+	DEF_TIMERS;
+	List job_req_list = (List) msg->data;
+	List resp_list;
+	ListIterator iter, resp_iter;
+	job_desc_msg_t *job_desc_msg;
+	job_record_t *job_ptr;
+	submit_response_msg_t *submit_msg;
+	slurm_msg_t response_msg;
+	slurmctld_lock_t fed_read_lock = {
+		NO_LOCK, NO_LOCK, NO_LOCK, NO_LOCK, READ_LOCK };
+	/* Locks: Read config, read job, read node, read partition */
+	slurmctld_lock_t job_read_lock = {
+		READ_LOCK, READ_LOCK, READ_LOCK, READ_LOCK, READ_LOCK };
+	/* Locks: Read config, write job, write node, read partition, read
+	 * federation */
+	slurmctld_lock_t job_write_lock = {
+		READ_LOCK, WRITE_LOCK, WRITE_LOCK, READ_LOCK, READ_LOCK };
+	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred);
+	gid_t gid = g_slurm_auth_get_gid(msg->auth_cred);
+	char *err_msg = NULL;
+	int error_code, job_cnt, accept_cnt = 0;
+	bool federated;
+
+	START_TIMER;
+	debug2("Processing RPC: REQUEST_SUBMIT_BATCH_JOBS from uid=%d", uid);
+	if (!job_req_list || (list_count(job_req_list) == 0)) {
+		info("REQUEST_SUBMIT_BATCH_JOBS from uid=%d with empty job list",
+		     uid);
+		slurm_send_rc_msg(msg, SLURM_ERROR);
+		return;
+	}
+	if (slurmctld_config.submissions_disabled) {
+		info("Submissions disabled on system");
+		slurm_send_rc_msg(msg, ESLURM_SUBMISSIONS_DISABLED);
+		return;
+	}
+
+	/*
+	 * Federated jobs are submitted to sibling clusters one at a time,
+	 * have the client fall back to REQUEST_SUBMIT_BATCH_JOB for them.
+	 */
+	lock_slurmctld(fed_read_lock);
+	federated = (fed_mgr_fed_rec != NULL);
+	unlock_slurmctld(fed_read_lock);
+	if (federated) {
+		slurm_send_rc_msg(msg, ESLURM_NOT_SUPPORTED);
+		return;
+	}
+
+	/* Validate the individual requests */
+	job_cnt = list_count(job_req_list);
+	resp_list = list_create(_free_submit_response);
+	lock_slurmctld(job_read_lock);	/* Locks for job_submit plugin use */
+	iter = list_iterator_create(job_req_list);
+	while ((job_desc_msg = list_next(iter))) {
+		submit_msg = xmalloc(sizeof(*submit_msg));
+		submit_msg->step_id = SLURM_BATCH_SCRIPT;
+		list_append(resp_list, submit_msg);
+
+		if ((error_code = _valid_id("REQUEST_SUBMIT_BATCH_JOBS",
+					    job_desc_msg, uid, gid))) {
+			submit_msg->error_code = error_code;
+			continue;
+		}
+
+		_set_hostname(msg, job_desc_msg);
+
+		if ((job_desc_msg->alloc_node == NULL) ||
+		    (job_desc_msg->alloc_node[0] == '\0')) {
+			error("REQUEST_SUBMIT_BATCH_JOBS lacks alloc_node from uid=%d",
+			      uid);
+			submit_msg->error_code = ESLURM_INVALID_NODE_NAME;
+			continue;
+		}
+
+		dump_job_desc(job_desc_msg);
+
+		job_desc_msg->het_job_offset = NO_VAL;
+		submit_msg->error_code = validate_job_create_req(
+			job_desc_msg, uid, &submit_msg->job_submit_user_msg);
+	}
+	list_iterator_destroy(iter);
+	unlock_slurmctld(job_read_lock);
+
+	/* Create new job allocations */
+	_throttle_start(&active_rpc_cnt);
+	lock_slurmctld(job_write_lock);
+	START_TIMER;	/* Restart after we have locks */
+	iter = list_iterator_create(job_req_list);
+	resp_iter = list_iterator_create(resp_list);
+	while ((job_desc_msg = list_next(iter)) &&
+	       (submit_msg = list_next(resp_iter))) {
+		if (submit_msg->error_code != SLURM_SUCCESS)
+			continue;
+
+		job_ptr = NULL;
+		error_code = job_allocate(job_desc_msg,
+					  job_desc_msg->immediate,
+					  false, NULL, 0, uid, &job_ptr,
+					  &err_msg,
+					  msg->protocol_version);
+		if (job_desc_msg->immediate && (error_code != SLURM_SUCCESS)) {
+			error_code = ESLURM_CAN_NOT_START_IMMEDIATELY;
+		} else if (job_ptr && !(error_code &&
+					(job_ptr->job_state == JOB_FAILED))) {
+			submit_msg->job_id = job_ptr->job_id;
+			accept_cnt++;
+		} else if (error_code == SLURM_SUCCESS) {
+			error_code = SLURM_ERROR;
+		}
+		submit_msg->error_code = error_code;
+
+		/* Keep the reason a job was rejected along with it */
+		if (err_msg && !submit_msg->job_id) {
+			if (submit_msg->job_submit_user_msg)
+				xstrfmtcat(submit_msg->job_submit_user_msg,
+					   "\n%s", err_msg);
+			else
+				submit_msg->job_submit_user_msg =
+					xstrdup(err_msg);
+		}
+		xfree(err_msg);
+	}
+	list_iterator_destroy(resp_iter);
+	list_iterator_destroy(iter);
+	unlock_slurmctld(job_write_lock);
+	_throttle_fini(&active_rpc_cnt);
+	END_TIMER2("_slurm_rpc_submit_batch_jobs");
+
+	info("%s: %d of %d jobs submitted from uid=%d %s",
+	     __func__, accept_cnt, job_cnt, uid, TIME_STR);
+	if (get_log_level() >= LOG_LEVEL_DEBUG) {
+		resp_iter = list_iterator_create(resp_list);
+		while ((submit_msg = list_next(resp_iter))) {
+			if (submit_msg->job_id)
+				debug("%s: JobId=%u", __func__,
+				      submit_msg->job_id);
+			else
+				debug("%s: %s", __func__,
+				      slurm_strerror(submit_msg->error_code));
+		}
+		list_iterator_destroy(resp_iter);
+	}
+
+	response_init(&response_msg, msg);
+	response_msg.msg_type = RESPONSE_SUBMIT_BATCH_JOBS;
+	response_msg.data = resp_list;
+	slurm_send_node_msg(msg->conn_fd, &response_msg);
+	FREE_NULL_LIST(resp_list);
+
+	if (accept_cnt) {
+		schedule_job_save();	/* Has own locks */
+		schedule_node_save();	/* Has own locks */
+		queue_job_scheduler();
+	}
+}
+
 /* _slurm_rpc_update_job - process RPC to update the configuration of a
  * job (e.g. priority)
  */
@@ -6019,6 +6314,7 @@ static void _clear_rpc_stats(void)
 		rpc_type_cnt[i] = 0;
 		rpc_type_id[i] = 0;
 		rpc_type_time[i] = 0;
+		rpc_type_max[i] = 0;
 	}
 	for (i = 0; i < rpc_user_size; i++) {
 		rpc_user_cnt[i] = 0;
@@ -6026,6 +6322,8 @@ static void _clear_rpc_stats(void)
 		rpc_user_time[i] = 0;
 	}
 	slurm_mutex_unlock(&rpc_mutex);
+
+	rate_limit_clear_stats();
 }
 
 static void _pack_rpc_stats(int resp, char **buffer_ptr, int *buffer_size,
@@ -6059,6 +6357,15 @@ static void _pack_rpc_stats(int resp, char **buffer_ptr, int *buffer_size,
 
 		agent_pack_pending_rpc_stats(buffer);
 
+		if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+			rate_limit_pack_stats(buffer);
+
+			for (i = 0; i < rpc_type_size; i++) {
+				if (rpc_type_id[i] == 0)
+					break;
+			}
+			pack64_array(rpc_type_max, i, buffer);
+		}
 	}
 
 	slurm_mutex_unlock(&rpc_mutex);
@@ -6179,6 +6486,7 @@ extern void free_rpc_stats(void)
 	xfree(rpc_type_cnt);
 	xfree(rpc_type_id);
 	xfree(rpc_type_time);
+	xfree(rpc_type_max);
 	rpc_type_size = 0;
 
 	xfree(rpc_user_cnt);
@@ -6288,6 +6596,78 @@ _slurm_rpc_kill_job(slurm_msg_t *msg)
 	END_TIMER2("_slurm_rpc_kill_job");
 }
 
+/*
+ * _slurm_rpc_kill_jobs - signal a list of jobs under a single lock
+ * acquisition, returning a result code for each of them
+ */
+inline static void
+_slurm_rpc_kill_jobs(slurm_msg_t *msg)
+{
+	static int active_rpc_cnt = 0;
+	DEF_TIMERS;
+	kill_jobs_msg_t *kill = msg->data;
+	kill_jobs_resp_msg_t resp;
+	slurm_msg_t response_msg;
+	slurmctld_lock_t fed_read_lock =
+		{ NO_LOCK, NO_LOCK, NO_LOCK, NO_LOCK, READ_LOCK };
+	slurmctld_lock_t lock = { READ_LOCK, WRITE_LOCK,
+				  WRITE_LOCK, NO_LOCK, READ_LOCK };
+	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred);
+	bool federated;
+	int i;
+
+	/*
+	 * Federated jobs may have to be routed to their origin cluster one
+	 * at a time, have the client fall back to REQUEST_KILL_JOB for them.
+	 */
+	lock_slurmctld(fed_read_lock);
+	federated = (fed_mgr_fed_rec != NULL);
+	unlock_slurmctld(fed_read_lock);
+	if (federated) {
+		slurm_send_rc_msg(msg, ESLURM_NOT_SUPPORTED);
+		return;
+	}
+
+	START_TIMER;
+	info("%s: REQUEST_KILL_JOBS for %u jobs uid %d",
+	     __func__, kill->jobs_cnt, uid);
+
+	resp.jobs_cnt = kill->jobs_cnt;
+	resp.error_code = xcalloc(kill->jobs_cnt, sizeof(uint32_t));
+
+	_throttle_start(&active_rpc_cnt);
+	lock_slurmctld(lock);
+	for (i = 0; i < kill->jobs_cnt; i++) {
+		resp.error_code[i] = job_str_signal(kill->jobs_array[i],
+						    kill->signal, kill->flags,
+						    uid, 0);
+	}
+	unlock_slurmctld(lock);
+	_throttle_fini(&active_rpc_cnt);
+
+	for (i = 0; i < kill->jobs_cnt; i++) {
+		if (resp.error_code[i] == ESLURM_ALREADY_DONE) {
+			debug2("%s: job_str_signal() JobId=%s sig %d returned %s",
+			       __func__, kill->jobs_array[i], kill->signal,
+			       slurm_strerror(resp.error_code[i]));
+		} else if (resp.error_code[i] != SLURM_SUCCESS) {
+			info("%s: job_str_signal() JobId=%s sig %d returned %s",
+			     __func__, kill->jobs_array[i], kill->signal,
+			     slurm_strerror(resp.error_code[i]));
+		} else {
+			slurmctld_diag_stats.jobs_canceled++;
+		}
+	}
+
+	response_init(&response_msg, msg);
+	response_msg.msg_type = RESPONSE_KILL_JOBS;
+	response_msg.data = &resp;
+	slurm_send_node_msg(msg->conn_fd, &response_msg);
+	xfree(resp.error_code);
+
+	END_TIMER2("_slurm_rpc_kill_jobs");
+}
+
 /* The batch messages when made for the comp_msg need to be freed
  * differently than the normal free, so do that here.
  */
@@ -6550,6 +6930,7 @@ static int _process_persist_conn(void *arg,
 
 	msg.msg_type = persist_msg->msg_type;
 	msg.data = persist_msg->data;
+	msg.protocol_version = persist_conn->version;
 
 	slurmctld_req(&msg, NULL);
 
@@ -6617,7 +6998,15 @@ static void _slurm_rpc_persist_init(slurm_msg_t *msg, connection_arg_t *arg)
 
 	if (persist_init->persist_type == PERSIST_TYPE_FED)
 		rc = fed_mgr_add_sibling_conn(persist_conn, &comment);
-	else
+	else if ((persist_init->persist_type == PERSIST_TYPE_SLURMD) &&
+		 rpc_mgr_enabled()) {
+		/* Serviced by the epoll loop, no thread per slurmd */
+		if ((rc = rpc_mgr_add_persist_conn(persist_conn)))
+			comment = xstrdup("slurmctld is shutting down");
+	} else if (persist_init->persist_type == PERSIST_TYPE_SLURMD) {
+		rc = ESLURM_NOT_SUPPORTED;
+		comment = xstrdup("slurmd persistent connections require SlurmctldParameters=rpc_epoll");
+	} else
 		rc = SLURM_ERROR;
 end_it:
 
@@ -0,0 +1,301 @@
+/*****************************************************************************\
+ *  rate_limit.c - per user RPC rate limiting for slurmctld
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include "config.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "src/slurmctld/rate_limit.h"
+#include "src/slurmctld/slurmctld.h"
+
+#define DEFAULT_BUCKET_SIZE	30
+#define DEFAULT_REFILL_PERIOD	1
+#define DEFAULT_REFILL_RATE	2
+#define DEFAULT_TABLE_SIZE	8192
+
+/*
+ * One token bucket. A bucket holds up to bucket_size tokens and gains
+ * refill_rate tokens every refill_period seconds. Every RPC takes a token;
+ * RPCs arriving at an empty bucket are rejected.
+ */
+typedef struct {
+	uint32_t exceeded;	/* RPCs rejected, for sdiag */
+	time_t last_refill;
+	uint16_t msg_type;	/* 0 unless rl_per_rpc_type */
+	uint32_t tokens;
+	uid_t uid;
+	bool used;
+} rl_bucket_t;
+
+typedef struct {
+	bool enabled;
+	uint32_t bucket_size;
+	bool per_rpc_type;
+	uint32_t refill_period;
+	uint32_t refill_rate;
+	uint32_t table_size;
+} rl_config_t;
+
+static pthread_mutex_t rl_mutex = PTHREAD_MUTEX_INITIALIZER;
+static rl_config_t rl_conf;
+static rl_bucket_t *rl_table = NULL;	/* open addressing hash table */
+static uint32_t rl_table_used = 0;
+static bool rl_full_logged = false;
+
+static uint32_t _rl_param(const char *param, uint32_t def)
+{
+	char *tmp_ptr;
+	long val;
+
+	if (!(tmp_ptr = xstrcasestr(slurm_conf.slurmctld_params, param)))
+		return def;
+
+	val = strtol(tmp_ptr + strlen(param), NULL, 10);
+	if ((val < 1) || (val > INT32_MAX)) {
+		error("Invalid SlurmctldParameters %s%ld, using %u",
+		      param, val, def);
+		return def;
+	}
+	return val;
+}
+
+extern void rate_limit_reconfig(void)
+{
+	rl_config_t new_conf = { 0 };
+
+	if (xstrcasestr(slurm_conf.slurmctld_params, "rl_enable")) {
+		new_conf.enabled = true;
+		new_conf.bucket_size = _rl_param("rl_bucket_size=",
+						 DEFAULT_BUCKET_SIZE);
+		new_conf.per_rpc_type = (xstrcasestr(slurm_conf.slurmctld_params,
+						     "rl_per_rpc_type") != NULL);
+		new_conf.refill_period = _rl_param("rl_refill_period=",
+						   DEFAULT_REFILL_PERIOD);
+		new_conf.refill_rate = _rl_param("rl_refill_rate=",
+						 DEFAULT_REFILL_RATE);
+		new_conf.table_size = _rl_param("rl_table_size=",
+						DEFAULT_TABLE_SIZE);
+	}
+
+	slurm_mutex_lock(&rl_mutex);
+	if (memcmp(&new_conf, &rl_conf, sizeof(rl_conf))) {
+		xfree(rl_table);
+		rl_table_used = 0;
+		rl_full_logged = false;
+		rl_conf = new_conf;
+		if (rl_conf.enabled) {
+			rl_table = xcalloc(rl_conf.table_size,
+					   sizeof(rl_bucket_t));
+			debug("%s: %u token buckets of %u tokens, refilled with %u tokens every %u seconds%s",
+			      __func__, rl_conf.table_size,
+			      rl_conf.bucket_size, rl_conf.refill_rate,
+			      rl_conf.refill_period,
+			      rl_conf.per_rpc_type ? " per RPC type" : "");
+		}
+	}
+	slurm_mutex_unlock(&rl_mutex);
+}
+
+/* Add the tokens earned since the last refill */
+static void _refill_bucket(rl_bucket_t *bucket, time_t now)
+{
+	uint64_t periods, tokens;
+
+	if (now <= bucket->last_refill)
+		return;
+
+	periods = (now - bucket->last_refill) / rl_conf.refill_period;
+	tokens = bucket->tokens + (periods * rl_conf.refill_rate);
+	bucket->tokens = MIN(tokens, rl_conf.bucket_size);
+	bucket->last_refill += periods * rl_conf.refill_period;
+}
+
+static void _init_bucket(rl_bucket_t *bucket, uid_t uid, uint16_t msg_type,
+			 time_t now)
+{
+	bucket->exceeded = 0;
+	bucket->last_refill = now;
+	bucket->msg_type = msg_type;
+	bucket->tokens = rl_conf.bucket_size;
+	bucket->uid = uid;
+}
+
+/*
+ * Find or add the bucket for a key, NULL if the table is full.
+ *
+ * Slots are never emptied, which would break the probe sequences of other
+ * keys. Instead a bucket which has refilled to full since its last use is
+ * idle, its user is indistinguishable from a new one, and its slot is given
+ * to the new key. Only when every bucket is in use does a key fail open.
+ */
+static rl_bucket_t *_find_bucket(uid_t uid, uint16_t msg_type, time_t now)
+{
+	uint32_t hash = ((uint32_t) uid * 2654435761U) ^ msg_type;
+	uint32_t inx = hash % rl_conf.table_size;
+	rl_bucket_t *idle = NULL;
+
+	for (uint32_t i = 0; i < rl_conf.table_size; i++) {
+		rl_bucket_t *bucket = &rl_table[inx];
+
+		if (!bucket->used) {
+			/* End of the probe sequence, key is not present */
+			if (!idle) {
+				idle = bucket;
+				idle->used = true;
+				rl_table_used++;
+			}
+			break;
+		}
+		if ((bucket->uid == uid) && (bucket->msg_type == msg_type))
+			return bucket;
+		if (!idle) {
+			_refill_bucket(bucket, now);
+			if (bucket->tokens == rl_conf.bucket_size)
+				idle = bucket;
+		}
+		inx = (inx + 1) % rl_conf.table_size;
+	}
+
+	if (idle)
+		_init_bucket(idle, uid, msg_type, now);
+
+	return idle;
+}
+
+extern bool rate_limit_exceeded(slurm_msg_t *msg, uid_t uid)
+{
+	rl_bucket_t *bucket;
+	uint16_t msg_type;
+	bool exceeded = false;
+	time_t now;
+
+	if (!rl_conf.enabled)
+		return false;
+	/* Never throttle slurmd, slurmdbd, other clusters or the admin */
+	if (msg->conn || validate_slurm_user(uid))
+		return false;
+
+	msg_type = rl_conf.per_rpc_type ? msg->msg_type : 0;
+	now = time(NULL);
+
+	slurm_mutex_lock(&rl_mutex);
+	if (!rl_conf.enabled) {
+		slurm_mutex_unlock(&rl_mutex);
+		return false;
+	}
+
+	if (!(bucket = _find_bucket(uid, msg_type, now))) {
+		/* Fail open rather than throttle everyone */
+		if (!rl_full_logged) {
+			error("%s: all %u buckets are in use, RPCs from new users are not rate limited, increase rl_table_size",
+			      __func__, rl_conf.table_size);
+			rl_full_logged = true;
+		}
+		slurm_mutex_unlock(&rl_mutex);
+		return false;
+	}
+
+	_refill_bucket(bucket, now);
+
+	if (bucket->tokens) {
+		bucket->tokens--;
+	} else {
+		bucket->exceeded++;
+		exceeded = true;
+	}
+	slurm_mutex_unlock(&rl_mutex);
+
+	if (exceeded)
+		log_flag(PROTOCOL, "%s: RPC %s from uid %u exceeds rate limit",
+			 __func__, rpc_num2string(msg->msg_type), uid);
+
+	return exceeded;
+}
+
+extern void rate_limit_pack_stats(Buf buffer)
+{
+	uint32_t *uids = NULL, *counts = NULL;
+	uint32_t cnt = 0;
+
+	slurm_mutex_lock(&rl_mutex);
+	for (uint32_t i = 0; rl_table && (i < rl_conf.table_size); i++) {
+		rl_bucket_t *bucket = &rl_table[i];
+		uint32_t j;
+
+		if (!bucket->used || !bucket->exceeded)
+			continue;
+		/* With rl_per_rpc_type a user may have many buckets */
+		for (j = 0; j < cnt; j++) {
+			if (uids[j] == bucket->uid)
+				break;
+		}
+		if (j == cnt) {
+			xrecalloc(uids, cnt + 1, sizeof(uint32_t));
+			xrecalloc(counts, cnt + 1, sizeof(uint32_t));
+			uids[cnt++] = bucket->uid;
+		}
+		counts[j] += bucket->exceeded;
+	}
+	slurm_mutex_unlock(&rl_mutex);
+
+	pack32_array(uids, cnt, buffer);
+	pack32_array(counts, cnt, buffer);
+	xfree(uids);
+	xfree(counts);
+}
+
+extern void rate_limit_clear_stats(void)
+{
+	slurm_mutex_lock(&rl_mutex);
+	for (uint32_t i = 0; rl_table && (i < rl_conf.table_size); i++)
+		rl_table[i].exceeded = 0;
+	slurm_mutex_unlock(&rl_mutex);
+}
+
+extern void rate_limit_fini(void)
+{
+	slurm_mutex_lock(&rl_mutex);
+	xfree(rl_table);
+	rl_table_used = 0;
+	memset(&rl_conf, 0, sizeof(rl_conf));
+	slurm_mutex_unlock(&rl_mutex);
+}
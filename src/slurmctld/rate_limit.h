@@ -0,0 +1,70 @@
+/*****************************************************************************\
+ *  rate_limit.h - per user RPC rate limiting for slurmctld
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _SLURMCTLD_RATE_LIMIT_H
+#define _SLURMCTLD_RATE_LIMIT_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#include "src/common/pack.h"
+#include "src/common/slurm_protocol_defs.h"
+
+/*
+ * Re-read the rl_* SlurmctldParameters. Existing buckets are discarded if
+ * the configuration changed. Call after every read of slurm.conf.
+ */
+extern void rate_limit_reconfig(void);
+
+/*
+ * Take a token from the bucket of the user (and RPC type if rl_per_rpc_type
+ * is configured) sending this RPC.
+ * IN msg - received RPC
+ * IN uid - authenticated uid of the sender
+ * RET true if the bucket was empty and the RPC should be rejected with
+ *     SLURMCTLD_COMMUNICATIONS_BACKOFF.
+ */
+extern bool rate_limit_exceeded(slurm_msg_t *msg, uid_t uid);
+
+/* Pack the count of rejected RPCs for each user, for sdiag */
+extern void rate_limit_pack_stats(Buf buffer);
+
+/* Zero the counts of rejected RPCs */
+extern void rate_limit_clear_stats(void);
+
+/* Free all memory */
+extern void rate_limit_fini(void);
+
+#endif /* _SLURMCTLD_RATE_LIMIT_H */
@@ -42,6 +42,7 @@
 
 #include <ctype.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -79,6 +80,7 @@
 #include "src/slurmctld/front_end.h"
 #include "src/slurmctld/gang.h"
 #include "src/slurmctld/job_scheduler.h"
+#include "src/slurmctld/job_snapshot.h"
 #include "src/slurmctld/job_submit.h"
 #include "src/slurmctld/licenses.h"
 #include "src/slurmctld/locks.h"
@@ -86,6 +88,7 @@
 #include "src/slurmctld/port_mgr.h"
 #include "src/slurmctld/preempt.h"
 #include "src/slurmctld/proc_req.h"
+#include "src/slurmctld/rate_limit.h"
 #include "src/slurmctld/read_config.h"
 #include "src/slurmctld/reservation.h"
 #include "src/slurmctld/sched_plugin.h"
@@ -114,6 +117,8 @@ static int  _compare_hostnames(node_record_t *old_node_table,
 static void _gres_reconfig(bool reconfig);
 static int  _init_all_slurm_conf(void);
 static void _list_delete_feature(void *feature_entry);
+static void _log_phase(struct timeval *tv, const char *phase);
+static void _prefetch_state_files(void);
 static int _preserve_select_type_param(slurm_conf_t *ctl_conf_ptr,
                                        uint16_t old_select_type_p);
 static void _purge_old_node_state(node_record_t *old_node_table_ptr,
@@ -159,6 +164,42 @@ static void _set_response_cluster_rec(void)
 	response_cluster_rec->plugin_id_select = select_get_plugin_id();
 }
 
+/*
+ * Log the time taken by a phase of read_slurm_conf() and start timing the
+ * next one
+ */
+static void _log_phase(struct timeval *tv, const char *phase)
+{
+	debug("read_slurm_conf: %s took %d usec", phase, slurm_delta_tv(tv));
+	gettimeofday(tv, NULL);
+}
+
+/*
+ * Have the kernel start reading the state save files so they are in memory
+ * by the time they are loaded, rather than read while slurmctld waits
+ */
+static void _prefetch_state_files(void)
+{
+	static const char *state_files[] = {
+		"front_end_state", "job_state", "job_state.journal",
+		"node_state", "part_state", "resv_state", "trigger_state",
+		NULL
+	};
+	char *file_name;
+	int fd;
+
+	for (int i = 0; state_files[i]; i++) {
+		file_name = xstrdup_printf("%s/%s",
+					   slurm_conf.state_save_location,
+					   state_files[i]);
+		if ((fd = open(file_name, O_RDONLY | O_CLOEXEC)) >= 0) {
+			(void) posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+			(void) close(fd);
+		}
+		xfree(file_name);
+	}
+}
+
 /*
  * Free the global response_cluster_rec
  */
@@ -244,6 +285,19 @@ static void _reorder_nodes_by_name(void)
 #endif
 }
 
+static int _cmp_node_rank(const void *x, const void *y)
+{
+	const int a = *(const int *) x, b = *(const int *) y;
+	uint32_t rank_a = node_record_table_ptr[a].node_rank;
+	uint32_t rank_b = node_record_table_ptr[b].node_rank;
+
+	if (rank_a < rank_b)
+		return -1;
+	if (rank_a > rank_b)
+		return 1;
+	return a - b;	/* Keep configured order for equal ranks */
+}
+
 /*
  * _reorder_nodes_by_rank - order node table in ascending order of node_rank
  * This depends on the TopologyPlugin and/or SelectPlugin, which may generate
@@ -251,39 +305,33 @@ static void _reorder_nodes_by_name(void)
  */
 static void _reorder_nodes_by_rank(void)
 {
-	node_record_t *node_ptr, *node_ptr2;
-	int i, j, min_inx;
-	uint32_t min_val;
+	node_record_t *orig_table;
+	int i, *order;
 
-	/* Now we need to sort the node records */
+	/*
+	 * Sort an index rather than swapping records in place, which took
+	 * O(n^2) comparisons and was slow for large ranked topologies.
+	 */
+	order = xcalloc(node_record_count, sizeof(int));
+	for (i = 0; i < node_record_count; i++)
+		order[i] = i;
+	qsort(order, node_record_count, sizeof(int), _cmp_node_rank);
+
+	orig_table = xcalloc(node_record_count, sizeof(node_record_t));
+	memcpy(orig_table, node_record_table_ptr,
+	       sizeof(node_record_t) * node_record_count);
 	for (i = 0; i < node_record_count; i++) {
-		min_val = node_record_table_ptr[i].node_rank;
-		min_inx = i;
-		for (j = i + 1; j < node_record_count; j++) {
-			if (node_record_table_ptr[j].node_rank < min_val) {
-				min_val = node_record_table_ptr[j].node_rank;
-				min_inx = j;
-			}
-		}
-
-		if (min_inx != i) {	/* swap records */
-			node_record_t node_record_tmp;
-
-			j = sizeof(node_record_t);
-			node_ptr  = node_record_table_ptr + i;
-			node_ptr2 = node_record_table_ptr + min_inx;
-
-			memcpy(&node_record_tmp, node_ptr, j);
-			memcpy(node_ptr, node_ptr2, j);
-			memcpy(node_ptr2, &node_record_tmp, j);
-		}
+		memcpy(node_record_table_ptr + i, orig_table + order[i],
+		       sizeof(node_record_t));
 	}
+	xfree(orig_table);
+	xfree(order);
 
 #if _DEBUG
 	/* Log the results */
-	for (i=0, node_ptr = node_record_table_ptr; i < node_record_count;
-	     i++, node_ptr++) {
-		info("node_rank[%u]: %s", node_ptr->node_rank, node_ptr->name);
+	for (i = 0; i < node_record_count; i++) {
+		info("node_rank[%u]: %s", node_record_table_ptr[i].node_rank,
+		     node_record_table_ptr[i].name);
 	}
 #endif
 }
@@ -401,6 +449,50 @@ static int _set_share_node_bitmap(void *x, void *arg)
 	return 0;
 }
 
+#ifndef HAVE_FRONT_END
+/* Maximum number of threads resolving node addresses concurrently */
+#define SLURMD_ADDR_THREADS 32
+
+static pthread_mutex_t slurmd_addr_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int slurmd_addr_next = 0;
+
+/* Skip nodes whose address _set_slurmd_addr() does not resolve */
+static bool _skip_slurmd_addr(node_record_t *node_ptr)
+{
+	if ((node_ptr->name == NULL) || (node_ptr->name[0] == '\0'))
+		return true;
+	if (IS_NODE_FUTURE(node_ptr))
+		return true;
+	if (IS_NODE_CLOUD(node_ptr) && IS_NODE_POWER_SAVE(node_ptr))
+		return true;
+	return false;
+}
+
+/* Resolve node addresses until none remain, lookups are mostly DNS waits */
+static void *_resolve_slurmd_addr(void *arg)
+{
+	node_record_t *node_ptr;
+	int i;
+
+	while (1) {
+		slurm_mutex_lock(&slurmd_addr_mutex);
+		i = slurmd_addr_next++;
+		slurm_mutex_unlock(&slurmd_addr_mutex);
+		if (i >= node_record_count)
+			break;
+		node_ptr = node_record_table_ptr + i;
+		if (_skip_slurmd_addr(node_ptr))
+			continue;
+		if (node_ptr->port == 0)
+			node_ptr->port = slurm_conf.slurmd_port;
+		slurm_set_addr(&node_ptr->slurm_addr, node_ptr->port,
+			       node_ptr->comm_name);
+	}
+
+	return NULL;
+}
+#endif
+
 /*
  * _set_slurmd_addr - establish the slurm_addr_t for the slurmd on each node
  *	Uses common data structures.
@@ -408,13 +500,23 @@ static int _set_share_node_bitmap(void *x, void *arg)
 static void _set_slurmd_addr(void)
 {
 #ifndef HAVE_FRONT_END
-	int i;
+	int i, thread_cnt;
+	pthread_t tids[SLURMD_ADDR_THREADS];
 	node_record_t *node_ptr = node_record_table_ptr;
 	DEF_TIMERS;
 
 	xassert(verify_lock(CONF_LOCK, READ_LOCK));
 
 	START_TIMER;
+	/* Resolve in parallel first, then handle the results serially */
+	slurmd_addr_next = 0;
+	thread_cnt = MIN(SLURMD_ADDR_THREADS, node_record_count);
+	for (i = 1; i < thread_cnt; i++)
+		slurm_thread_create(&tids[i], _resolve_slurmd_addr, NULL);
+	_resolve_slurmd_addr(NULL);
+	for (i = 1; i < thread_cnt; i++)
+		pthread_join(tids[i], NULL);
+
 	for (i = 0; i < node_record_count; i++, node_ptr++) {
 		if ((node_ptr->name == NULL) ||
 		    (node_ptr->name[0] == '\0'))
@@ -430,10 +532,6 @@ static void _set_slurmd_addr(void)
 			if (IS_NODE_POWER_SAVE(node_ptr))
 				continue;
 		}
-		if (node_ptr->port == 0)
-			node_ptr->port = slurm_conf.slurmd_port;
-		slurm_set_addr(&node_ptr->slurm_addr, node_ptr->port,
-			       node_ptr->comm_name);
 		if (node_ptr->slurm_addr.sin_port)
 			continue;
 		error("%s: failure on %s", __func__, node_ptr->comm_name);
@@ -1117,9 +1215,11 @@ int read_slurm_conf(int recover, bool reconfig)
 	char *state_save_dir = xstrdup(slurm_conf.state_save_location);
 	uint16_t old_select_type_p = slurm_conf.select_type_param;
 	bool cgroup_mem_confinement = false;
+	struct timeval phase_tv;
 
 	/* initialization */
 	START_TIMER;
+	gettimeofday(&phase_tv, NULL);
 
 	if (reconfig) {
 		/*
@@ -1159,6 +1259,8 @@ int read_slurm_conf(int recover, bool reconfig)
 		old_def_part_name = NULL;
 		goto end_it;
 	}
+	if (!reconfig && recover && !test_config)
+		_prefetch_state_files();
 
 	if (reconfig)
 		xcgroup_reconfig_slurm_cgroup_conf();
@@ -1205,6 +1307,7 @@ int read_slurm_conf(int recover, bool reconfig)
 	}
 	_handle_all_downnodes();
 	_build_all_partitionline_info();
+	_log_phase(&phase_tv, "node and partition configuration");
 	if (!reconfig) {
 		restore_front_end_state(recover);
 
@@ -1278,6 +1381,7 @@ int read_slurm_conf(int recover, bool reconfig)
 	_set_slurmd_addr();
 
 	_stat_slurm_dirs();
+	_log_phase(&phase_tv, "plugin initialization and node ordering");
 
 	/*
 	 * Load the layouts configuration.
@@ -1346,6 +1450,7 @@ int read_slurm_conf(int recover, bool reconfig)
 		load_job_ret = load_all_job_state();
 		sync_job_priorities();
 	}
+	_log_phase(&phase_tv, "node, partition and job state");
 
 	_sync_part_prio();
 	_build_bitmaps_pre_select();
@@ -1367,6 +1472,7 @@ int read_slurm_conf(int recover, bool reconfig)
 
 	(void) _sync_nodes_to_jobs(reconfig);
 	(void) sync_job_files();
+	_log_phase(&phase_tv, "select plugin, gres and node to job sync");
 	_purge_old_node_state(old_node_table_ptr, old_node_record_count);
 	_purge_old_part_state(old_part_list, old_def_part_name);
 
@@ -1385,6 +1491,8 @@ int read_slurm_conf(int recover, bool reconfig)
 
 	init_requeue_policy();
 	init_depend_policy();
+	job_snapshot_reconfig();
+	rate_limit_reconfig();
 
 	/* NOTE: Run restore_node_features before _restore_job_accounting */
 	restore_node_features(recover);
@@ -1418,6 +1526,7 @@ int read_slurm_conf(int recover, bool reconfig)
 	_validate_het_jobs();
 	(void) _sync_nodes_to_comp_job();/* must follow select_g_node_init() */
 	load_part_uid_allow_list(1);
+	_log_phase(&phase_tv, "node features and bitmaps");
 
 	/* NOTE: Run load_all_resv_state() before _restore_job_accounting */
 	if (reconfig) {
@@ -1429,10 +1538,12 @@ int read_slurm_conf(int recover, bool reconfig)
 			(void) slurm_sched_g_reconfig();
 		}
 	}
+	_log_phase(&phase_tv, "reservation and trigger state");
 	 if (test_config)
 		goto end_it;
 
 	_restore_job_accounting();
+	_log_phase(&phase_tv, "job accounting");
 
 	/* sort config_list by weight for scheduling */
 	list_sort(config_list, &list_compare_config);
@@ -1534,6 +1645,7 @@ int read_slurm_conf(int recover, bool reconfig)
 		fatal("Failed to reconfigure mcs plugin");
 
 	_set_response_cluster_rec();
+	_log_phase(&phase_tv, "plugin reconfiguration");
 
 	slurm_conf.last_update = time(NULL);
 end_it:
@@ -96,6 +96,12 @@ typedef struct resv_thread_args {
 	char *resv_name;
 } resv_thread_args_t;
 
+typedef struct resv_window {
+	slurmctld_resv_t *resv_ptr;
+	time_t start_relative;
+	time_t end_relative;
+} resv_window_t;
+
 time_t    last_resv_update = (time_t) 0;
 List      resv_list = (List) NULL;
 static List prom_resv_list = NULL;
@@ -4818,6 +4824,9 @@ extern int job_test_lic_resv(job_record_t *job_ptr, char *lic_name,
 		if (resv_ptr->end_time <= now)
 			_advance_resv_time(resv_ptr);
 
+		if (!resv_ptr->license_list)
+			continue;	/* reservation holds no licenses */
+
 		if (reboot)
 			job_end_time_use =
 				job_end_time + resv_ptr->boot_time;
@@ -5127,7 +5136,8 @@ extern int job_test_resv(job_record_t *job_ptr, time_t *when,
 	time_t start_relative, end_relative;
 	time_t now = time(NULL);
 	ListIterator iter;
-	int i, rc = SLURM_SUCCESS, rc2;
+	resv_window_t *resv_win;
+	int i, j, resv_win_cnt = 0, rc = SLURM_SUCCESS, rc2;
 
 	*resv_overlap = false;	/* initialize to false */
 	job_start_time = *when;
@@ -5267,6 +5277,36 @@ extern int job_test_resv(job_record_t *job_ptr, time_t *when,
 	if (list_count(resv_list) == 0)
 		return SLURM_SUCCESS;
 
+	/*
+	 * Collect the reservations which could overlap the job just once.
+	 * The job's start time only moves forward on retry, so reservations
+	 * ending before it need not be consulted again.
+	 */
+	resv_win = xcalloc(list_count(resv_list), sizeof(resv_window_t));
+	iter = list_iterator_create(resv_list);
+	while ((resv_ptr = list_next(iter))) {
+		_get_rel_start_end(resv_ptr, now,
+				   &start_relative, &end_relative);
+
+		if ((resv_ptr->node_bitmap == NULL) ||
+		    (end_relative <= job_start_time))
+			continue;
+
+		/*
+		 * Check if we are able to use this reservation's
+		 * resources even though we didn't request it.
+		 */
+		if ((job_ptr->warn_time <= resv_ptr->max_start_delay) &&
+		    (job_ptr->warn_flags & KILL_JOB_RESV))
+			continue;
+
+		resv_win[resv_win_cnt].resv_ptr = resv_ptr;
+		resv_win[resv_win_cnt].start_relative = start_relative;
+		resv_win[resv_win_cnt].end_relative = end_relative;
+		resv_win_cnt++;
+	}
+	list_iterator_destroy(iter);
+
 	/*
 	 * Job has no reservation, try to find time when this can
 	 * run and get it's required nodes (if any)
@@ -5274,10 +5314,10 @@ extern int job_test_resv(job_record_t *job_ptr, time_t *when,
 	for (i = 0; ; i++) {
 		lic_resv_time = (time_t) 0;
 
-		iter = list_iterator_create(resv_list);
-		while ((resv_ptr = list_next(iter))) {
-			_get_rel_start_end(
-				resv_ptr, now, &start_relative, &end_relative);
+		for (j = 0; j < resv_win_cnt; j++) {
+			resv_ptr = resv_win[j].resv_ptr;
+			start_relative = resv_win[j].start_relative;
+			end_relative = resv_win[j].end_relative;
 
 			if (reboot)
 				job_end_time_use =
@@ -5285,20 +5325,10 @@ extern int job_test_resv(job_record_t *job_ptr, time_t *when,
 			else
 				job_end_time_use = job_end_time;
 
-			if ((resv_ptr->node_bitmap == NULL) ||
-			    (start_relative >= job_end_time_use) ||
+			if ((start_relative >= job_end_time_use) ||
 			    (end_relative   <= job_start_time))
 				continue;
 
-			/*
-			 * Check if we are able to use this reservation's
-			 * resources even though we didn't request it.
-			 */
-			if ((job_ptr->warn_time <= resv_ptr->max_start_delay) &&
-			    (job_ptr->warn_flags & KILL_JOB_RESV)) {
-				continue;
-			}
-
 			if (resv_ptr->flags & RESERVE_FLAG_ALL_NODES ||
 			    ((resv_ptr->flags  & RESERVE_FLAG_PART_NODES) &&
 			     job_ptr->part_ptr == resv_ptr->part_ptr) ||
@@ -5367,7 +5397,6 @@ extern int job_test_resv(job_record_t *job_ptr, time_t *when,
 				continue;
 			}
 		}
-		list_iterator_destroy(iter);
 
 		if ((rc == SLURM_SUCCESS) && move_time) {
 			if (license_job_test(job_ptr, job_start_time, reboot)
@@ -5398,6 +5427,7 @@ extern int job_test_resv(job_record_t *job_ptr, time_t *when,
 		FREE_NULL_BITMAP(*node_bitmap);
 		break;	/* Give up */
 	}
+	xfree(resv_win);
 
 	return rc;
 }
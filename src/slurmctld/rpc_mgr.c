@@ -0,0 +1,762 @@
+/*****************************************************************************\
+ *  rpc_mgr.c - event driven RPC front end for slurmctld
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include "config.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "src/common/fd.h"
+#include "src/common/forward.h"
+#include "src/common/list.h"
+#include "src/common/log.h"
+#include "src/common/slurm_protocol_api.h"
+#include "src/common/slurm_protocol_pack.h"
+#include "src/common/slurm_protocol_util.h"
+#include "src/common/workq.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "src/slurmctld/slurmctld.h"
+#include "src/slurmctld/proc_req.h"
+#include "src/slurmctld/rpc_mgr.h"
+
+#define MAX_RPC_THREADS		1000	/* workq limit is 1024 */
+#define MAX_EPOLL_EVENTS	128
+#define MAX_MSG_SIZE		(1024 * 1024 * 1024) /* as slurm_protocol_socket.c */
+
+/*
+ * RPCs are serviced by separate worker pools according to their class, so
+ * that a burst of expensive queries can not delay the RPCs which keep jobs
+ * flowing. Under overload, the bounded queues shed queries first.
+ */
+typedef enum {
+	RPC_CLASS_CRITICAL,	/* completions, registrations; never shed */
+	RPC_CLASS_NORMAL,	/* submissions, updates, everything else */
+	RPC_CLASS_QUERY,	/* read-only state dumps */
+	RPC_CLASS_CNT
+} rpc_class_t;
+
+typedef struct {
+	const char *name;
+	const char *queue_param;	/* SlurmctldParameters depth option */
+	const char *threads_param;	/* SlurmctldParameters thread option */
+	int def_queue;			/* default max_queue, 0 is unlimited */
+	int def_threads;		/* default threads */
+	int max_queue;			/* shed new RPCs beyond this */
+	int queued;			/* queued or running RPCs */
+	uint64_t shed_cnt;		/* RPCs rejected since startup */
+	int threads;
+	workq_t *workq;
+} rpc_class_info_t;
+
+static rpc_class_info_t rpc_classes[RPC_CLASS_CNT] = {
+	[RPC_CLASS_CRITICAL] = {
+		.name = "critical",
+		.threads_param = "rpc_critical_threads=",
+		.def_threads = 4,
+	},
+	[RPC_CLASS_NORMAL] = {
+		.name = "normal",
+		.queue_param = "rpc_queue_depth=",
+		.threads_param = "rpc_threads=",
+		.def_queue = 256,
+		.def_threads = 32,
+	},
+	[RPC_CLASS_QUERY] = {
+		.name = "query",
+		.queue_param = "rpc_query_queue_depth=",
+		.threads_param = "rpc_query_threads=",
+		.def_queue = 64,
+		.def_threads = 8,
+	},
+};
+static pthread_mutex_t rpc_class_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+typedef struct {
+	slurm_addr_t cli_addr;
+	int fd;
+	bool have_len;		/* msg_len has been read */
+	bool listen;		/* listening socket, not a connection */
+	char *msg_buf;		/* message body */
+	uint32_t msg_len;	/* message body length */
+	size_t offset;		/* bytes of msg_len or msg_buf read so far */
+	slurm_persist_conn_t *persist; /* slurmd persistent connection */
+	rpc_class_t rpc_class;
+	bool shed;		/* reject with SLURMCTLD_COMMUNICATIONS_BACKOFF */
+	time_t start_time;	/* when the connection was accepted */
+} rpc_conn_t;
+
+static int epoll_fd = -1;
+/* List of rpc_conn_t still being read, only used by the rpc_mgr thread */
+static List conn_list = NULL;
+/*
+ * Persistent connections are idle most of the time, so they are neither in
+ * conn_list nor subject to its limits and timeouts.
+ */
+static int persist_cnt = 0;
+static pthread_mutex_t persist_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+extern bool rpc_mgr_enabled(void)
+{
+	return (xstrcasestr(slurm_conf.slurmctld_params, "rpc_epoll") != NULL);
+}
+
+static int _rpc_param(const char *param, int def, int min, int max)
+{
+	char *tmp_ptr;
+	int cnt = def;
+
+	if ((tmp_ptr = xstrcasestr(slurm_conf.slurmctld_params, param))) {
+		cnt = atoi(tmp_ptr + strlen(param));
+		if ((cnt < min) || (cnt > max)) {
+			error("Invalid SlurmctldParameters %s%d, using %d",
+			      param, cnt, def);
+			cnt = def;
+		}
+	}
+
+	return cnt;
+}
+
+static void _rpc_classes_init(void)
+{
+	for (int i = 0; i < RPC_CLASS_CNT; i++) {
+		rpc_class_info_t *rc = &rpc_classes[i];
+
+		rc->threads = _rpc_param(rc->threads_param, rc->def_threads,
+					 1, MAX_RPC_THREADS);
+		if (rc->queue_param)
+			rc->max_queue = _rpc_param(rc->queue_param,
+						   rc->def_queue, 0, INT_MAX);
+		rc->workq = new_workq(rc->threads);
+		verbose("%s: servicing %s RPCs with %d worker threads, queue depth %d",
+			__func__, rc->name, rc->threads, rc->max_queue);
+	}
+}
+
+static void _rpc_classes_fini(void)
+{
+	/* Process already queued requests before returning */
+	for (int i = 0; i < RPC_CLASS_CNT; i++)
+		FREE_NULL_WORKQ(rpc_classes[i].workq);
+}
+
+/* Map a message type to the class of worker which should service it */
+static rpc_class_t _rpc_class(uint16_t msg_type)
+{
+	switch (msg_type) {
+	case MESSAGE_EPILOG_COMPLETE:
+	case MESSAGE_NODE_HEARTBEAT:
+	case MESSAGE_NODE_REGISTRATION_STATUS:
+	case REQUEST_COMPLETE_BATCH_SCRIPT:
+	case REQUEST_COMPLETE_JOB_ALLOCATION:
+	case REQUEST_COMPLETE_PROLOG:
+	case REQUEST_PING:
+	case REQUEST_STEP_COMPLETE:
+	case REQUEST_CONTROL:
+	case REQUEST_CONTROL_STATUS:
+	case REQUEST_SHUTDOWN:
+		return RPC_CLASS_CRITICAL;
+	case REQUEST_ASSOC_MGR_INFO:
+	case REQUEST_BUILD_INFO:
+	case REQUEST_BURST_BUFFER_INFO:
+	case REQUEST_FED_INFO:
+	case REQUEST_FRONT_END_INFO:
+	case REQUEST_JOB_INFO:
+	case REQUEST_JOB_INFO_DELTA:
+	case REQUEST_JOB_INFO_SINGLE:
+	case REQUEST_JOB_STEP_INFO:
+	case REQUEST_JOB_USER_INFO:
+	case REQUEST_LICENSE_INFO:
+	case REQUEST_NODE_INFO:
+	case REQUEST_NODE_INFO_SINGLE:
+	case REQUEST_PARTITION_INFO:
+	case REQUEST_PRIORITY_FACTORS:
+	case REQUEST_RESERVATION_INFO:
+	case REQUEST_SHARE_INFO:
+	case REQUEST_STATS_INFO:
+	case REQUEST_TRIGGER_GET:
+		return RPC_CLASS_QUERY;
+	default:
+		return RPC_CLASS_NORMAL;
+	}
+}
+
+/*
+ * Peek at the message type in the header of a complete message without
+ * unpacking (and authenticating) it. See pack_header().
+ */
+static rpc_class_t _conn_rpc_class(rpc_conn_t *conn)
+{
+	uint16_t version, msg_type;
+
+	if (conn->msg_len < (4 * sizeof(uint16_t)))
+		return RPC_CLASS_NORMAL;
+
+	memcpy(&version, conn->msg_buf, sizeof(version));
+	if (ntohs(version) < SLURM_MIN_PROTOCOL_VERSION)
+		return RPC_CLASS_NORMAL;
+
+	memcpy(&msg_type, conn->msg_buf + (3 * sizeof(uint16_t)),
+	       sizeof(msg_type));
+	return _rpc_class(ntohs(msg_type));
+}
+
+static void _conn_free(void *x)
+{
+	rpc_conn_t *conn = x;
+
+	if (!conn)
+		return;
+	if (conn->persist) {
+		/* slurm_persist_conn_destroy() closes the fd */
+		slurm_persist_conn_destroy(conn->persist);
+		slurm_mutex_lock(&persist_mutex);
+		persist_cnt--;
+		slurm_mutex_unlock(&persist_mutex);
+	}
+	xfree(conn->msg_buf);
+	xfree(conn);
+}
+
+static int _find_conn(void *x, void *key)
+{
+	return (x == key);
+}
+
+/* Stop watching and close a connection, used on errors and timeouts */
+static void _conn_close(rpc_conn_t *conn)
+{
+	(void) epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+	if (conn->persist) {
+		_conn_free(conn);
+		return;
+	}
+	if (close(conn->fd) < 0)
+		error("close(%d): %m", conn->fd);
+	(void) list_delete_all(conn_list, _find_conn, conn);
+}
+
+/* Start watching a persistent connection for its next request */
+static int _persist_conn_watch(rpc_conn_t *conn)
+{
+	struct epoll_event ev = { .events = EPOLLIN };
+
+	conn->have_len = false;
+	conn->msg_len = 0;
+	conn->offset = 0;
+
+	ev.data.ptr = conn;
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, conn->fd, &ev) < 0) {
+		error("%s: epoll_ctl(%d): %m", __func__, conn->fd);
+		return SLURM_ERROR;
+	}
+
+	return SLURM_SUCCESS;
+}
+
+/*
+ * Read whatever is available of the message length and message body.
+ * RET 1 if the message is complete, 0 if more data is needed, -1 on error
+ */
+static int _conn_read(rpc_conn_t *conn)
+{
+	while (true) {
+		char *ptr;
+		size_t want;
+		ssize_t rc;
+
+		if (!conn->have_len) {
+			ptr = ((char *) &conn->msg_len) + conn->offset;
+			want = sizeof(conn->msg_len) - conn->offset;
+		} else {
+			ptr = conn->msg_buf + conn->offset;
+			want = conn->msg_len - conn->offset;
+		}
+		if (!want)
+			return 1;
+
+		rc = read(conn->fd, ptr, want);
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+				return 0;
+			return -1;
+		}
+		if (rc == 0)
+			return -1;	/* EOF before complete message */
+
+		conn->offset += rc;
+		if (!conn->have_len &&
+		    (conn->offset == sizeof(conn->msg_len))) {
+			conn->msg_len = ntohl(conn->msg_len);
+			if (conn->msg_len > MAX_MSG_SIZE) {
+				errno = SLURM_PROTOCOL_INSANE_MSG_LENGTH;
+				return -1;
+			}
+			conn->msg_buf = xmalloc_nz(conn->msg_len);
+			conn->have_len = true;
+			conn->offset = 0;
+		}
+	}
+}
+
+/*
+ * Process one request from a persistent connection. Unlike a regular
+ * connection there is no header or credential, the sender was authenticated
+ * when the connection was opened.
+ */
+static void _service_persist_rpc(rpc_conn_t *conn)
+{
+	slurm_persist_conn_t *persist_conn = conn->persist;
+	persist_msg_t persist_msg;
+	Buf buffer = NULL;
+	uint32_t uid = NO_VAL;
+	int rc;
+
+	rc = slurm_persist_conn_process_msg(persist_conn, &persist_msg,
+					    conn->msg_buf, conn->msg_len,
+					    &buffer, false);
+	xfree(conn->msg_buf);
+	if (rc == SLURM_SUCCESS) {
+		(void) (persist_conn->callback_proc)(persist_conn,
+						     &persist_msg, &buffer,
+						     &uid);
+		slurm_free_msg_data(persist_msg.msg_type, persist_msg.data);
+	}
+	if (buffer) {
+		if (slurm_persist_send_msg(persist_conn, buffer) !=
+		    SLURM_SUCCESS)
+			rc = SLURM_ERROR;
+		free_buf(buffer);
+	}
+
+	slurm_mutex_lock(&rpc_class_mutex);
+	rpc_classes[conn->rpc_class].queued--;
+	slurm_mutex_unlock(&rpc_class_mutex);
+
+	if (slurmctld_config.shutdown_time || rc ||
+	    _persist_conn_watch(conn))
+		_conn_free(conn);
+	server_thread_decr();
+}
+
+/*
+ * Tell the client of a shed request to retry later. Only the header is
+ * unpacked, the credential is neither unpacked nor verified since the request
+ * will not be processed.
+ */
+static void _shed_rpc(rpc_conn_t *conn)
+{
+	header_t header;
+	slurm_msg_t msg;
+	Buf buffer;
+
+	buffer = create_buf(conn->msg_buf, conn->msg_len);
+	conn->msg_buf = NULL;
+
+	if (unpack_header(&header, buffer) == SLURM_SUCCESS) {
+		if (check_header_version(&header) == SLURM_SUCCESS) {
+			/* Replies use the usual blocking, timed sends */
+			fd_set_blocking(conn->fd);
+			slurm_msg_t_init(&msg);
+			msg.conn_fd = conn->fd;
+			msg.protocol_version = header.version;
+			msg.msg_type = header.msg_type;
+			msg.flags = header.flags;
+			memcpy(&msg.address, &conn->cli_addr,
+			       sizeof(slurm_addr_t));
+			(void) slurm_send_rc_msg(
+				&msg, SLURMCTLD_COMMUNICATIONS_BACKOFF);
+		}
+		destroy_forward(&header.forward);
+		FREE_NULL_LIST(header.ret_list);
+	}
+	free_buf(buffer);
+
+	if (close(conn->fd) < 0)
+		error("close(%d): %m", conn->fd);
+}
+
+/* workq callback, process one complete request */
+static void _service_rpc(void *arg)
+{
+	rpc_conn_t *conn = arg;
+	connection_arg_t *conn_arg;
+	slurm_msg_t msg;
+	Buf buffer;
+
+	/* slurm_persist_conn_writeable() needs a non-blocking socket */
+	if (conn->persist) {
+		_service_persist_rpc(conn);
+		return;
+	}
+
+	if (conn->shed) {
+		_shed_rpc(conn);
+		slurm_mutex_lock(&rpc_class_mutex);
+		rpc_classes[conn->rpc_class].queued--;
+		slurm_mutex_unlock(&rpc_class_mutex);
+		_conn_free(conn);
+		server_thread_decr();
+		return;
+	}
+
+	/* Replies are written with the usual blocking, timed sends */
+	fd_set_blocking(conn->fd);
+
+	conn_arg = xmalloc(sizeof(*conn_arg));
+	conn_arg->newsockfd = conn->fd;
+	memcpy(&conn_arg->cli_addr, &conn->cli_addr, sizeof(slurm_addr_t));
+
+	slurm_msg_t_init(&msg);
+	msg.flags |= SLURM_MSG_KEEP_BUFFER;
+	msg.conn_fd = conn->fd;
+	buffer = create_buf(conn->msg_buf, conn->msg_len);
+	conn->msg_buf = NULL;
+	msg.buffer = buffer;
+
+	if (slurm_unpack_received_msg(&msg, conn->fd, buffer)) {
+		if (errno == SLURM_PROTOCOL_VERSION_ERROR) {
+			slurm_send_rc_msg(&msg, SLURM_PROTOCOL_VERSION_ERROR);
+		} else {
+			char addr_buf[32];
+			slurm_print_slurm_addr(&conn->cli_addr, addr_buf,
+					       sizeof(addr_buf));
+			error("slurm_receive_msg [%s]: %m", addr_buf);
+		}
+	} else {
+		/* process the request */
+		slurmctld_req(&msg, conn_arg);
+	}
+
+	if ((conn_arg->newsockfd >= 0) && (close(conn_arg->newsockfd) < 0))
+		error("close(%d): %m", conn_arg->newsockfd);
+
+	slurm_free_msg_members(&msg);
+	xfree(conn_arg);
+	slurm_mutex_lock(&rpc_class_mutex);
+	rpc_classes[conn->rpc_class].queued--;
+	slurm_mutex_unlock(&rpc_class_mutex);
+	_conn_free(conn);
+	server_thread_decr();
+}
+
+static void _accept_conns(rpc_conn_t *listen_conn)
+{
+	while (true) {
+		struct epoll_event ev = { .events = EPOLLIN };
+		slurm_addr_t cli_addr;
+		rpc_conn_t *conn;
+		int fd;
+
+		if ((fd = slurm_accept_msg_conn(listen_conn->fd, &cli_addr)) ==
+		    SLURM_ERROR) {
+			if ((errno != EAGAIN) && (errno != EWOULDBLOCK) &&
+			    (errno != EINTR))
+				error("slurm_accept_msg_conn: %m");
+			return;
+		}
+		fd_set_close_on_exec(fd);
+		fd_set_nonblocking(fd);
+
+		if (slurm_conf.debug_flags & DEBUG_FLAG_PROTOCOL) {
+			char inetbuf[64];
+
+			slurm_print_slurm_addr(&cli_addr, inetbuf,
+					       sizeof(inetbuf));
+			info("%s: accept() connection from %s",
+			     __func__, inetbuf);
+		}
+
+		conn = xmalloc(sizeof(*conn));
+		conn->fd = fd;
+		conn->start_time = time(NULL);
+		memcpy(&conn->cli_addr, &cli_addr, sizeof(slurm_addr_t));
+
+		ev.data.ptr = conn;
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+			error("%s: epoll_ctl(%d): %m", __func__, fd);
+			close(fd);
+			_conn_free(conn);
+			continue;
+		}
+		list_append(conn_list, conn);
+	}
+}
+
+static int _close_conn(void *x, void *arg)
+{
+	rpc_conn_t *conn = x;
+
+	(void) close(conn->fd);
+	return 0;
+}
+
+static void _conn_readable(rpc_conn_t *conn)
+{
+	rpc_class_info_t *rc_info;
+	rpc_class_t rpc_class;
+	int rc = _conn_read(conn);
+
+	if (rc == 0)
+		return;
+
+	if (rc < 0) {
+		char addr_buf[32], *host = addr_buf;
+
+		if (conn->persist && !conn->have_len && !conn->offset) {
+			/* slurmd closed an idle connection */
+			log_flag(NET, "%s: persistent connection from %s closed",
+				 __func__, conn->persist->rem_host);
+			_conn_close(conn);
+			return;
+		}
+		if (conn->persist)
+			host = conn->persist->rem_host;
+		else
+			slurm_print_slurm_addr(&conn->cli_addr, addr_buf,
+					       sizeof(addr_buf));
+		error("%s: read from [%s]: %m", __func__, host);
+		_conn_close(conn);
+		return;
+	}
+
+	/* Complete request, hand it to a worker */
+	(void) epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+	if (!conn->persist)
+		list_remove_first(conn_list, _find_conn, conn);
+
+	/*
+	 * Only slurmd messages come over persistent connections. They are
+	 * never shed since some of them expect no response at all.
+	 */
+	rpc_class = conn->persist ? RPC_CLASS_CRITICAL : _conn_rpc_class(conn);
+	slurm_mutex_lock(&rpc_class_mutex);
+	rc_info = &rpc_classes[rpc_class];
+	if (rc_info->max_queue && (rc_info->queued >= rc_info->max_queue)) {
+		/*
+		 * The class was peeked from the header, so the request is
+		 * rejected by the critical workers without authenticating or
+		 * unpacking it, see _shed_rpc()
+		 */
+		static time_t last_print_time = 0;
+		time_t now = time(NULL);
+
+		rc_info->shed_cnt++;
+		if (difftime(now, last_print_time) > 2) {
+			verbose("%s: %s RPC queue full (%d), %"PRIu64" RPCs shed",
+				__func__, rc_info->name, rc_info->queued,
+				rc_info->shed_cnt);
+			last_print_time = now;
+		}
+		conn->shed = true;
+		rpc_class = RPC_CLASS_CRITICAL;
+		rc_info = &rpc_classes[rpc_class];
+	}
+	conn->rpc_class = rpc_class;
+	rc_info->queued++;
+	slurm_mutex_unlock(&rpc_class_mutex);
+
+	server_thread_incr();
+	if (workq_add_work(rc_info->workq, _service_rpc, conn, "rpc")) {
+		/* Only happens during shutdown */
+		if (!conn->persist)
+			close(conn->fd);
+		slurm_mutex_lock(&rpc_class_mutex);
+		rc_info->queued--;
+		slurm_mutex_unlock(&rpc_class_mutex);
+		_conn_free(conn);
+		server_thread_decr();
+	}
+}
+
+static int _find_expired_conn(void *x, void *arg)
+{
+	rpc_conn_t *conn = x;
+	time_t *cutoff = arg;
+
+	return (conn->start_time < *cutoff);
+}
+
+/* Drop connections which failed to send a complete request in time */
+static void _expire_conns(void)
+{
+	time_t cutoff = time(NULL) - slurm_conf.msg_timeout;
+	rpc_conn_t *conn;
+
+	while ((conn = list_find_first(conn_list, _find_expired_conn,
+				       &cutoff))) {
+		char addr_buf[32];
+
+		slurm_print_slurm_addr(&conn->cli_addr, addr_buf,
+				       sizeof(addr_buf));
+		error("%s: incomplete request from [%s] timed out",
+		      __func__, addr_buf);
+		_conn_close(conn);
+	}
+}
+
+/*
+ * Stop accepting new connections while too many partial requests are being
+ * read, but keep reading the connections we already have. Complete requests
+ * are limited by their class queue depth instead.
+ */
+static void _throttle_listen(rpc_conn_t *listen_conns, int nfds,
+			     uint32_t max_conns, bool *paused)
+{
+	bool busy = (list_count(conn_list) >= max_conns);
+
+	if (busy == *paused)
+		return;
+
+	for (int i = 0; i < nfds; i++) {
+		struct epoll_event ev = { .events = busy ? 0 : EPOLLIN };
+
+		ev.data.ptr = &listen_conns[i];
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, listen_conns[i].fd,
+			      &ev) < 0)
+			error("%s: epoll_ctl(%d): %m",
+			      __func__, listen_conns[i].fd);
+	}
+	if (busy) {
+		static time_t last_print_time = 0;
+		time_t now = time(NULL);
+
+		if (difftime(now, last_print_time) > 2) {
+			verbose("%s: connection count over limit (%u), deferring new connections",
+				__func__, max_conns);
+			last_print_time = now;
+		}
+	}
+	*paused = busy;
+}
+
+extern int rpc_mgr_add_persist_conn(slurm_persist_conn_t *persist_conn)
+{
+	rpc_conn_t *conn;
+
+	if ((epoll_fd < 0) || slurmctld_config.shutdown_time)
+		return SLURM_ERROR;
+
+	conn = xmalloc(sizeof(*conn));
+	conn->fd = persist_conn->fd;
+	conn->persist = persist_conn;
+	conn->start_time = time(NULL);
+	fd_set_nonblocking(conn->fd);
+	if (_persist_conn_watch(conn)) {
+		xfree(conn);
+		return SLURM_ERROR;
+	}
+
+	slurm_mutex_lock(&persist_mutex);
+	persist_cnt++;
+	log_flag(NET, "%s: servicing persistent connection from %s, %d open",
+		 __func__, persist_conn->rem_host, persist_cnt);
+	slurm_mutex_unlock(&persist_mutex);
+
+	return SLURM_SUCCESS;
+}
+
+extern void rpc_mgr_run(int *fds, int nfds, uint32_t max_conns)
+{
+	struct epoll_event events[MAX_EPOLL_EVENTS];
+	rpc_conn_t *listen_conns;
+	time_t last_expire = time(NULL);
+	bool paused = false;
+
+	if ((epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+		fatal("%s: epoll_create1: %m", __func__);
+
+	conn_list = list_create(_conn_free);
+	listen_conns = xcalloc(nfds, sizeof(*listen_conns));
+	for (int i = 0; i < nfds; i++) {
+		struct epoll_event ev = { .events = EPOLLIN };
+
+		listen_conns[i].fd = fds[i];
+		listen_conns[i].listen = true;
+		fd_set_nonblocking(fds[i]);
+		ev.data.ptr = &listen_conns[i];
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fds[i], &ev) < 0)
+			fatal("%s: epoll_ctl(%d): %m", __func__, fds[i]);
+	}
+
+	_rpc_classes_init();
+
+	while (!slurmctld_config.shutdown_time) {
+		int cnt;
+		time_t now;
+
+		_throttle_listen(listen_conns, nfds, max_conns, &paused);
+
+		cnt = epoll_wait(epoll_fd, events, MAX_EPOLL_EVENTS,
+				 MSEC_IN_SEC);
+		if (cnt < 0) {
+			if (errno != EINTR)
+				error("%s: epoll_wait: %m", __func__);
+			continue;
+		}
+
+		for (int i = 0; i < cnt; i++) {
+			rpc_conn_t *conn = events[i].data.ptr;
+
+			if (conn->listen)
+				_accept_conns(conn);
+			else
+				_conn_readable(conn);
+		}
+
+		now = time(NULL);
+		if (now != last_expire) {
+			_expire_conns();
+			last_expire = now;
+		}
+	}
+
+	debug3("%s shutting down", __func__);
+	_rpc_classes_fini();
+	(void) list_for_each(conn_list, _close_conn, NULL);
+	FREE_NULL_LIST(conn_list);
+	close(epoll_fd);
+	epoll_fd = -1;
+	xfree(listen_conns);
+}
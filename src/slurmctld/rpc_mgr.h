@@ -0,0 +1,73 @@
+/*****************************************************************************\
+ *  rpc_mgr.h - event driven RPC front end for slurmctld
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _SLURMCTLD_RPC_MGR_H
+#define _SLURMCTLD_RPC_MGR_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include "src/common/slurm_persist_conn.h"
+
+/*
+ * Determine if RPCs should be serviced with the event driven front end
+ * (SlurmctldParameters=rpc_epoll) instead of one thread per connection.
+ */
+extern bool rpc_mgr_enabled(void);
+
+/*
+ * Accept connections on the listening sockets and read the requests from a
+ * single epoll() loop, then process complete requests with fixed pools of
+ * worker threads, one per RPC class (critical, normal and query). No thread
+ * is blocked waiting on a slow client.
+ * Returns once slurmctld begins shutting down and all queued RPCs have been
+ * processed.
+ * IN fds - listening sockets
+ * IN nfds - number of elements in fds
+ * IN max_conns - stop accepting connections while this many are being read
+ */
+extern void rpc_mgr_run(int *fds, int nfds, uint32_t max_conns);
+
+/*
+ * Keep reading requests from a slurmd's persistent connection from the
+ * epoll() loop once its REQUEST_PERSIST_INIT has been accepted. Each message
+ * is processed by a critical class worker and the connection is watched
+ * again once the response has been sent.
+ * IN persist_conn - connection to service, rpc_mgr takes ownership on success
+ * RET SLURM_SUCCESS or SLURM_ERROR if rpc_mgr is not running
+ */
+extern int rpc_mgr_add_persist_conn(slurm_persist_conn_t *persist_conn);
+
+#endif /* _SLURMCTLD_RPC_MGR_H */
@@ -192,6 +192,7 @@ typedef struct diag_stats {
 	uint32_t bf_table_size;
 	uint32_t bf_table_size_sum;
 	time_t   bf_when_last_cycle;
+	uint32_t bf_interval;	/* backfill's configured bf_interval, not reset */
 
 	uint32_t latency;
 } diag_stats_t;
@@ -681,6 +682,10 @@ struct job_record {
 	uint32_t bit_flags;             /* various job flags */
 	char *burst_buffer;		/* burst buffer specification */
 	char *burst_buffer_state;	/* burst buffer state */
+	uint64_t change_seq;		/* job table sequence number of last
+					 * change, 0 if not yet numbered (see
+					 * pack_jobs_delta()) */
+	uint32_t change_sig;		/* signature of fields at change_seq */
 	char *clusters;			/* clusters job is submitted to with -M
 					   option */
 	char *comment;			/* arbitrary comment */
@@ -736,6 +741,8 @@ struct job_record {
 					 * components */
 	uint32_t job_id;		/* job ID */
 	job_record_t *job_next;		/* next entry with same hash index */
+	job_record_t *job_next_user;	/* next entry with same user_id
+					 * hash index */
 	job_record_t *job_array_next_j;	/* job array linked list by job_id */
 	job_record_t *job_array_next_t;	/* job array linked list by task_id */
 	job_record_t *job_preempt_comp; /* het job preempt component */
@@ -744,6 +751,7 @@ struct job_record {
 	uint16_t kill_on_node_fail;	/* 1 if job should be killed on
 					 * node failure */
 	time_t last_sched_eval;		/* last time job was evaluated for scheduling */
+	time_t last_update;		/* time of last update_job() request */
 	char *licenses;			/* licenses required by the job */
 	List license_list;		/* structure with license info */
 	acct_policy_limit_set_t limit_set; /* flags if indicate an
@@ -1929,6 +1937,21 @@ extern void node_no_resp_msg(void);
  * own separate job_record (do not count tasks in pending META job record) */
 extern int num_pending_job_array_tasks(uint32_t array_job_id);
 
+/*
+ * Call f for each job record with the given job ID or array job ID, using the
+ * job hash tables rather than walking job_list.
+ * RET count of job records visited
+ */
+extern int for_each_job_by_id(uint32_t job_id, ListForF f, void *arg);
+
+/*
+ * Call f for each job record belonging to the given user, using the job user
+ * hash table rather than walking job_list. Stops if f returns a negative
+ * value.
+ * RET count of job records visited, negated if f stopped the walk
+ */
+extern int for_each_job_by_user(uid_t user_id, ListForF f, void *arg);
+
 /*
  * pack_all_jobs - dump all job information for all jobs in
  *	machine independent form (for network transmission)
@@ -1947,6 +1970,24 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 			  uint16_t show_flags, uid_t uid, uint32_t filter_uid,
 			  uint16_t protocol_version);
 
+/*
+ * pack_jobs_delta - dump information about jobs changed or purged since
+ *	a prior REQUEST_JOB_INFO_DELTA in machine independent form
+ * OUT buffer_ptr - the pointer is set to the allocated buffer.
+ * OUT buffer_size - set to size of the buffer in bytes
+ * IN epoch - epoch from the client's prior response or 0
+ * IN seq - sequence number from the client's prior response or 0
+ * IN show_flags - job filtering options
+ * IN uid - uid of user making request (for partition filtering)
+ * IN protocol_version - slurm protocol version of client
+ * global: job_list - global list of job records
+ * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
+ * NOTE: READ lock_slurmctld config, job, part and fed before entry
+ */
+extern void pack_jobs_delta(char **buffer_ptr, int *buffer_size, time_t epoch,
+			    uint64_t seq, uint16_t show_flags, uid_t uid,
+			    uint16_t protocol_version);
+
 /*
  * pack_spec_jobs - dump job information for specified jobs in
  *	machine independent form (for network transmission)
@@ -2427,6 +2468,13 @@ extern bool test_job_array_finished(uint32_t array_job_id);
 /* Return true if ANY tasks of specific array job ID are pending */
 extern bool test_job_array_pending(uint32_t array_job_id);
 
+/*
+ * Set the results of test_job_array_complete(), test_job_array_completed()
+ * and test_job_array_pending() with a single pass over the job array records
+ */
+extern void test_job_array_state(uint32_t array_job_id, bool *complete,
+				 bool *completed, bool *pending);
+
 /* Determine of the nodes are ready to run a job
  * RET true if ready */
 extern bool test_job_nodes_ready(job_record_t *job_ptr);
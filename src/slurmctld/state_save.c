@@ -46,6 +46,7 @@
 #include <pthread.h>
 
 #include "src/common/macros.h"
+#include "src/common/xstring.h"
 #include "src/slurmctld/front_end.h"
 #include "src/slurmctld/reservation.h"
 #include "src/slurmctld/slurmctld.h"
@@ -117,6 +118,29 @@ extern void schedule_trigger_save(void)
 	slurm_mutex_unlock(&state_save_lock);
 }
 
+/*
+ * Return the count of records to pack between releasing and reacquiring
+ * slurmctld locks while saving state, 0 to hold the locks throughout
+ * (SlurmctldParameters=state_save_yield=#)
+ */
+extern int state_save_yield_cnt(void)
+{
+	char *tmp_ptr;
+	int yield_cnt = 0;
+
+	if ((tmp_ptr = xstrcasestr(slurm_conf.slurmctld_params,
+				   "state_save_yield="))) {
+		yield_cnt = atoi(tmp_ptr + 17);
+		if (yield_cnt < 0) {
+			error("Invalid SlurmctldParameters state_save_yield:%d",
+			      yield_cnt);
+			yield_cnt = 0;
+		}
+	}
+
+	return yield_cnt;
+}
+
 /* shutdown the slurmctld_state_save thread */
 extern void shutdown_state_save(void)
 {
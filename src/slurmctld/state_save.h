@@ -58,6 +58,13 @@ extern void schedule_resv_save(void);
 /* Queue saving of trigger state information */
 extern void schedule_trigger_save(void);
 
+/*
+ * Return the count of records to pack between releasing and reacquiring
+ * slurmctld locks while saving state, 0 to hold the locks throughout
+ * (SlurmctldParameters=state_save_yield=#)
+ */
+extern int state_save_yield_cnt(void);
+
 /* shutdown the slurmctld_state_save thread */
 extern void shutdown_state_save(void);
 
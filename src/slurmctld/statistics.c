@@ -39,14 +39,60 @@
 #include <stdio.h>
 
 #include "src/slurmctld/agent.h"
+#include "src/slurmctld/locks.h"
 #include "src/slurmctld/slurmctld.h"
 #include "src/common/list.h"
 #include "src/common/pack.h"
 #include "src/common/xstring.h"
 #include "src/common/slurmdbd_defs.h"
 
+#define JOB_COUNT_INTERVAL 30   /* Time to update running job count */
+
+static pthread_mutex_t job_count_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 extern int retry_list_size(void);
 
+static int _foreach_job_running(void *object, void *arg)
+{
+	job_record_t *job_ptr = (job_record_t *)object;
+
+	if (IS_JOB_PENDING(job_ptr)) {
+		int job_cnt = (job_ptr->array_recs &&
+			       job_ptr->array_recs->task_cnt) ?
+			job_ptr->array_recs->task_cnt : 1;
+		slurmctld_diag_stats.jobs_pending += job_cnt;
+	}
+	if (IS_JOB_RUNNING(job_ptr))
+		slurmctld_diag_stats.jobs_running++;
+
+	return SLURM_SUCCESS;
+}
+
+/*
+ * Count pending and running jobs when the statistics are requested and the
+ * last count is older than JOB_COUNT_INTERVAL, rather than periodically
+ * walking the job list when nobody is asking.
+ */
+static void _update_diag_job_state_counts(void)
+{
+	/* Locks: Read job */
+	slurmctld_lock_t job_read_lock =
+		{ NO_LOCK, READ_LOCK, NO_LOCK, NO_LOCK, NO_LOCK };
+	time_t now = time(NULL);
+
+	slurm_mutex_lock(&job_count_mutex);
+	if (difftime(now, slurmctld_diag_stats.job_states_ts) >=
+	    JOB_COUNT_INTERVAL) {
+		lock_slurmctld(job_read_lock);
+		slurmctld_diag_stats.jobs_running = 0;
+		slurmctld_diag_stats.jobs_pending = 0;
+		slurmctld_diag_stats.job_states_ts = now;
+		list_for_each(job_list, _foreach_job_running, NULL);
+		unlock_slurmctld(job_read_lock);
+	}
+	slurm_mutex_unlock(&job_count_mutex);
+}
+
 /* Pack all scheduling statistics */
 extern void pack_all_stat(int resp, char **buffer_ptr, int *buffer_size,
 			  uint16_t protocol_version)
@@ -70,6 +116,9 @@ extern void pack_all_stat(int resp, char **buffer_ptr, int *buffer_size,
 			slurmdbd_queue_size = 0;
 	}
 
+	if (resp)
+		_update_diag_job_state_counts();
+
 	buffer = init_buf(BUF_SIZE);
 	if (protocol_version >= SLURM_20_02_PROTOCOL_VERSION) {
 		parts_packed = resp;
@@ -1117,6 +1117,15 @@ static bitstr_t *_pick_step_nodes(job_record_t *job_ptr,
 			node_inx++;
 			if (!bit_test(nodes_avail, i))
 				continue;	/* node now DOWN */
+			/*
+			 * Once the step has its maximum node count the
+			 * remaining nodes are simply dropped, so skip the
+			 * memory and GRES tests for them.
+			 */
+			if (nodes_picked_cnt >= step_spec->max_nodes) {
+				bit_clear(nodes_avail, i);
+				continue;
+			}
 			avail_cpus = job_resrcs_ptr->cpus[node_inx] -
 				     job_resrcs_ptr->cpus_used[node_inx];
 			total_cpus = job_resrcs_ptr->cpus[node_inx];
@@ -1195,13 +1204,11 @@ static bitstr_t *_pick_step_nodes(job_record_t *job_ptr,
 				}
 			}
 
-			if (nodes_picked_cnt >= step_spec->max_nodes)
-				bit_clear(nodes_avail, i);
-			else if ((avail_tasks <= 0) ||
-				 ((selected_nodes == NULL) &&
-				  (nodes_picked_cnt >= step_spec->min_nodes) &&
-				  (tasks_picked_cnt > 0)   &&
-				  (tasks_picked_cnt >= step_spec->num_tasks))) {
+			if ((avail_tasks <= 0) ||
+			    ((selected_nodes == NULL) &&
+			     (nodes_picked_cnt >= step_spec->min_nodes) &&
+			     (tasks_picked_cnt > 0)   &&
+			     (tasks_picked_cnt >= step_spec->num_tasks))) {
 				bit_clear(nodes_avail, i);
 				total_task_cnt += total_tasks;
 			} else if (selected_nodes &&
@@ -3292,6 +3299,53 @@ static void _pack_ctld_job_step_info(step_record_t *step_ptr, Buf buffer,
 	}
 }
 
+typedef struct {
+	Buf buffer;
+	uint16_t protocol_version;
+	uint16_t show_flags;
+	uint32_t step_id;
+	uint32_t steps_packed;
+	uid_t uid;
+	int valid_job;
+} pack_step_args_t;
+
+static int _pack_job_steps(void *x, void *arg)
+{
+	job_record_t *job_ptr = (job_record_t *) x;
+	pack_step_args_t *args = (pack_step_args_t *) arg;
+	ListIterator step_iterator;
+	step_record_t *step_ptr;
+
+	args->valid_job = 1;
+
+	if (((args->show_flags & SHOW_ALL) == 0) && (args->uid != 0) &&
+	    (job_ptr->part_ptr) &&
+	    !part_is_visible(job_ptr->part_ptr, args->uid))
+		return 0;
+
+	if ((slurm_conf.private_data & PRIVATE_DATA_JOBS) &&
+	    (job_ptr->user_id != args->uid) && !validate_operator(args->uid) &&
+	    (((slurm_mcs_get_privatedata() == 0) &&
+	      !assoc_mgr_is_user_acct_coord(acct_db_conn, args->uid,
+					    job_ptr->account)) ||
+	     ((slurm_mcs_get_privatedata() == 1) &&
+	      (mcs_g_check_mcs_label(args->uid, job_ptr->mcs_label) != 0))))
+		return 0;
+
+	step_iterator = list_iterator_create(job_ptr->step_list);
+	while ((step_ptr = list_next(step_iterator))) {
+		if ((args->step_id != NO_VAL) &&
+		    (step_ptr->step_id != args->step_id))
+			continue;
+		_pack_ctld_job_step_info(step_ptr, args->buffer,
+					 args->protocol_version);
+		args->steps_packed++;
+	}
+	list_iterator_destroy(step_iterator);
+
+	return 0;
+}
+
 /*
  * pack_ctld_job_step_info_response_msg - packs job step info
  * IN job_id - specific id or NO_VAL for all
@@ -3306,60 +3360,34 @@ extern int pack_ctld_job_step_info_response_msg(
 	uint32_t job_id, uint32_t step_id, uid_t uid,
 	uint16_t show_flags, Buf buffer, uint16_t protocol_version)
 {
-	ListIterator job_iterator;
-	ListIterator step_iterator;
 	int error_code = 0;
-	uint32_t steps_packed = 0, tmp_offset;
-	step_record_t *step_ptr;
-	job_record_t *job_ptr;
+	uint32_t tmp_offset;
 	time_t now = time(NULL);
-	int valid_job = 0;
+	pack_step_args_t args = {
+		.buffer = buffer,
+		.protocol_version = protocol_version,
+		.show_flags = show_flags,
+		.step_id = step_id,
+		.uid = uid,
+	};
 
 	pack_time(now, buffer);
-	pack32(steps_packed, buffer);	/* steps_packed placeholder */
-
-	job_iterator = list_iterator_create(job_list);
-	while ((job_ptr = list_next(job_iterator))) {
-		if ((job_id != NO_VAL) && (job_id != job_ptr->job_id) &&
-		    (job_id != job_ptr->array_job_id))
-			continue;
-
-		valid_job = 1;
+	pack32(args.steps_packed, buffer);	/* steps_packed placeholder */
 
-		if (((show_flags & SHOW_ALL) == 0) && (uid != 0) &&
-		    (job_ptr->part_ptr) && !part_is_visible(job_ptr->part_ptr, uid))
-			continue;
-
-		if ((slurm_conf.private_data & PRIVATE_DATA_JOBS) &&
-		    (job_ptr->user_id != uid) && !validate_operator(uid) &&
-		    (((slurm_mcs_get_privatedata() == 0) &&
-		      !assoc_mgr_is_user_acct_coord(acct_db_conn, uid,
-						    job_ptr->account)) ||
-		     ((slurm_mcs_get_privatedata() == 1) &&
-		      (mcs_g_check_mcs_label(uid, job_ptr->mcs_label) != 0))))
-			continue;
-
-		step_iterator = list_iterator_create(job_ptr->step_list);
-		while ((step_ptr = list_next(step_iterator))) {
-			if ((step_id != NO_VAL) &&
-			    (step_ptr->step_id != step_id))
-				continue;
-			_pack_ctld_job_step_info(step_ptr, buffer,
-						 protocol_version);
-			steps_packed++;
-		}
-		list_iterator_destroy(step_iterator);
-	}
-	list_iterator_destroy(job_iterator);
+	/* Look up a specific job through the job hash tables */
+	if (job_id != NO_VAL)
+		(void) for_each_job_by_id(job_id, _pack_job_steps, &args);
+	else
+		(void) list_for_each(job_list, _pack_job_steps, &args);
 
-	if (list_count(job_list) && !valid_job && !steps_packed)
+	if (list_count(job_list) && !args.valid_job && !args.steps_packed)
 		error_code = ESLURM_INVALID_JOB_ID;
 
 	/* put the real record count in the message body header */
 	tmp_offset = get_buf_offset(buffer);
 	set_buf_offset(buffer, 0);
 	pack_time(now, buffer);
-	pack32(steps_packed, buffer);
+	pack32(args.steps_packed, buffer);
 	set_buf_offset(buffer, tmp_offset);
 
 	return error_code;
@@ -78,6 +78,10 @@ bitstr_t *trigger_down_nodes_bitmap = NULL;
 bitstr_t *trigger_drained_nodes_bitmap = NULL;
 bitstr_t *trigger_fail_nodes_bitmap = NULL;
 bitstr_t *trigger_up_nodes_bitmap   = NULL;
+/* Set when an event was published or a trigger added since the last
+ * trigger_process(). Only job and node idle triggers depend upon time, all
+ * other pending triggers can only fire after a new event. */
+static bool trigger_event_pending = true;
 static bool trigger_bb_error = false;
 static bool trigger_node_reconfig = false;
 static bool trigger_pri_ctld_fail = false;
@@ -495,6 +499,7 @@ extern int trigger_set(uid_t uid, gid_t gid, trigger_info_msg_t *msg)
 			continue;
 		}
 		list_append(trigger_list, trig_add);
+		trigger_event_pending = true;
 		schedule_trigger_save();
 	}
 
@@ -513,6 +518,7 @@ extern void trigger_front_end_down(front_end_record_t *front_end_ptr)
 	if (trigger_down_front_end_bitmap == NULL)
 		trigger_down_front_end_bitmap = bit_alloc(front_end_node_cnt);
 	bit_set(trigger_down_front_end_bitmap, inx);
+	trigger_event_pending = true;
 	slurm_mutex_unlock(&trigger_mutex);
 }
 
@@ -526,6 +532,7 @@ extern void trigger_front_end_up(front_end_record_t *front_end_ptr)
 	if (trigger_up_front_end_bitmap == NULL)
 		trigger_up_front_end_bitmap = bit_alloc(front_end_node_cnt);
 	bit_set(trigger_up_front_end_bitmap, inx);
+	trigger_event_pending = true;
 	slurm_mutex_unlock(&trigger_mutex);
 }
 
@@ -539,6 +546,7 @@ extern void trigger_node_down(node_record_t *node_ptr)
 	if (trigger_down_nodes_bitmap == NULL)
 		trigger_down_nodes_bitmap = bit_alloc(node_record_count);
 	bit_set(trigger_down_nodes_bitmap, inx);
+	trigger_event_pending = true;
 	slurm_mutex_unlock(&trigger_mutex);
 }
 
@@ -552,6 +560,7 @@ extern void trigger_node_drained(node_record_t *node_ptr)
 	if (trigger_drained_nodes_bitmap == NULL)
 		trigger_drained_nodes_bitmap = bit_alloc(node_record_count);
 	bit_set(trigger_drained_nodes_bitmap, inx);
+	trigger_event_pending = true;
 	slurm_mutex_unlock(&trigger_mutex);
 }
 
@@ -565,6 +574,7 @@ extern void trigger_node_failing(node_record_t *node_ptr)
 	if (trigger_fail_nodes_bitmap == NULL)
 		trigger_fail_nodes_bitmap = bit_alloc(node_record_count);
 	bit_set(trigger_fail_nodes_bitmap, inx);
+	trigger_event_pending = true;
 	slurm_mutex_unlock(&trigger_mutex);
 }
 
@@ -578,6 +588,7 @@ extern void trigger_node_up(node_record_t *node_ptr)
 	if (trigger_up_nodes_bitmap == NULL)
 		trigger_up_nodes_bitmap = bit_alloc(node_record_count);
 	bit_set(trigger_up_nodes_bitmap, inx);
+	trigger_event_pending = true;
 	slurm_mutex_unlock(&trigger_mutex);
 }
 
@@ -588,6 +599,7 @@ extern void trigger_reconfig(void)
 	lock_slurmctld(node_read_lock);
 	slurm_mutex_lock(&trigger_mutex);
 	trigger_node_reconfig = true;
+	trigger_event_pending = true;
 	if (trigger_down_front_end_bitmap)
 		trigger_down_front_end_bitmap = bit_realloc(
 			trigger_down_front_end_bitmap, node_record_count);
@@ -615,6 +627,7 @@ extern void trigger_primary_ctld_fail(void)
 	slurm_mutex_lock(&trigger_mutex);
 	if (ctld_failure != 1) {
 		trigger_pri_ctld_fail = true;
+		trigger_event_pending = true;
 		ctld_failure = 1;
 	}
 	slurm_mutex_unlock(&trigger_mutex);
@@ -624,6 +637,7 @@ extern void trigger_primary_ctld_res_op(void)
 {
 	slurm_mutex_lock(&trigger_mutex);
 	trigger_pri_ctld_res_op = true;
+	trigger_event_pending = true;
 	ctld_failure = 0;
 	slurm_mutex_unlock(&trigger_mutex);
 }
@@ -632,6 +646,7 @@ extern void trigger_primary_ctld_res_ctrl(void)
 {
 	slurm_mutex_lock(&trigger_mutex);
 	trigger_pri_ctld_res_ctrl = true;
+	trigger_event_pending = true;
 	slurm_mutex_unlock(&trigger_mutex);
 }
 
@@ -639,6 +654,7 @@ extern void trigger_primary_ctld_acct_full(void)
 {
 	slurm_mutex_lock(&trigger_mutex);
 	trigger_pri_ctld_acct_buffer_full = true;
+	trigger_event_pending = true;
 	slurm_mutex_unlock(&trigger_mutex);
 }
 
@@ -647,6 +663,7 @@ extern void trigger_backup_ctld_fail(int index)
 	slurm_mutex_lock(&trigger_mutex);
 	if (bu_ctld_failure != 1) {
 		trigger_bu_ctld_fail = true;
+		trigger_event_pending = true;
 		bu_ctld_failure = 1;
 	}
 	slurm_mutex_unlock(&trigger_mutex);
@@ -656,6 +673,7 @@ extern void trigger_backup_ctld_res_op(int index)
 {
 	slurm_mutex_lock(&trigger_mutex);
 	trigger_bu_ctld_res_op = true;
+	trigger_event_pending = true;
 	bu_ctld_failure = 0;
 	slurm_mutex_unlock(&trigger_mutex);
 }
@@ -664,6 +682,7 @@ extern void trigger_backup_ctld_as_ctrl(void)
 {
 	slurm_mutex_lock(&trigger_mutex);
 	trigger_bu_ctld_as_ctrl = true;
+	trigger_event_pending = true;
 	slurm_mutex_unlock(&trigger_mutex);
 }
 
@@ -672,6 +691,7 @@ extern void trigger_primary_dbd_fail(void)
 	slurm_mutex_lock(&trigger_mutex);
 	if (dbd_failure != 1) {
 		trigger_pri_dbd_fail = true;
+		trigger_event_pending = true;
 		dbd_failure = 1;
 	}
 	slurm_mutex_unlock(&trigger_mutex);
@@ -681,6 +701,7 @@ extern void trigger_primary_dbd_res_op(void)
 {
 	slurm_mutex_lock(&trigger_mutex);
 	trigger_pri_dbd_res_op = true;
+	trigger_event_pending = true;
 	dbd_failure = 0;
 	slurm_mutex_unlock(&trigger_mutex);
 }
@@ -690,6 +711,7 @@ extern void trigger_primary_db_fail(void)
 	slurm_mutex_lock(&trigger_mutex);
 	if (db_failure != 1) {
 		trigger_pri_db_fail = true;
+		trigger_event_pending = true;
 		db_failure = 1;
 	}
 	slurm_mutex_unlock(&trigger_mutex);
@@ -698,8 +720,9 @@ extern void trigger_primary_db_fail(void)
 extern void trigger_primary_db_res_op(void)
 {
 	slurm_mutex_lock(&trigger_mutex);
-		trigger_pri_db_res_op = true;
-		db_failure = 0;
+	trigger_pri_db_res_op = true;
+	trigger_event_pending = true;
+	db_failure = 0;
 	slurm_mutex_unlock(&trigger_mutex);
 }
 
@@ -707,6 +730,7 @@ extern void trigger_burst_buffer(void)
 {
 	slurm_mutex_lock(&trigger_mutex);
 	trigger_bb_error = true;
+	trigger_event_pending = true;
 	slurm_mutex_unlock(&trigger_mutex);
 }
 
@@ -799,6 +823,7 @@ static int _load_trigger_state(Buf buffer, uint16_t protocol_version)
 	if (trigger_list == NULL)
 		trigger_list = list_create(_trig_del);
 	list_append(trigger_list, trig_ptr);
+	trigger_event_pending = true;
 	next_trigger_id = MAX(next_trigger_id, trig_ptr->trig_id + 1);
 	slurm_mutex_unlock(&trigger_mutex);
 
@@ -1567,6 +1592,18 @@ static void _trigger_clone(trig_mgr_info_t *trig_in)
 	trig_add->group_id  = trig_in->group_id;
 	trig_add->program   = xstrdup(trig_in->program);;
 	list_prepend(trigger_list, trig_add);
+	trigger_event_pending = true;
+}
+
+/* Return true if a pending trigger may fire without any new event */
+static bool _trigger_time_based(trig_mgr_info_t *trig_in)
+{
+	if (trig_in->res_type == TRIGGER_RES_TYPE_JOB)
+		return true;
+	if ((trig_in->res_type == TRIGGER_RES_TYPE_NODE) &&
+	    (trig_in->trig_type & TRIGGER_TYPE_IDLE))
+		return true;
+	return false;
 }
 
 extern void trigger_process(void)
@@ -1574,7 +1611,7 @@ extern void trigger_process(void)
 	ListIterator trig_iter;
 	trig_mgr_info_t *trig_in;
 	time_t now = time(NULL);
-	bool state_change = false;
+	bool state_change = false, event_pending;
 	pid_t rc;
 	int prog_stat;
 
@@ -1582,9 +1619,13 @@ extern void trigger_process(void)
 	if (trigger_list == NULL)
 		trigger_list = list_create(_trig_del);
 
+	/* Clones prepended below set this again for the next pass */
+	event_pending = trigger_event_pending;
+	trigger_event_pending = false;
 	trig_iter = list_iterator_create(trigger_list);
 	while ((trig_in = list_next(trig_iter))) {
-		if (trig_in->state == 0) {
+		if ((trig_in->state == 0) &&
+		    (event_pending || _trigger_time_based(trig_in))) {
 			if (trig_in->res_type == TRIGGER_RES_TYPE_OTHER)
 				_trigger_other_event(trig_in, now);
 			else if (trig_in->res_type == TRIGGER_RES_TYPE_JOB)
@@ -428,6 +428,7 @@ int xcgroup_instantiate(xcgroup_t* cg)
 	char* file_path;
 	uid_t uid;
 	gid_t gid;
+	bool created = true;
 
 	/* init variables based on input cgroup */
 	file_path = cg->path;
@@ -448,6 +449,7 @@ int xcgroup_instantiate(xcgroup_t* cg)
 		} else {
 			debug("%s: cgroup '%s' already exists",
 			      __func__, file_path);
+			created = false;
 		}
 	}
 	umask(omask);
@@ -463,8 +465,12 @@ int xcgroup_instantiate(xcgroup_t* cg)
 	 * failure so set output status to success */
 	fstatus = XCGROUP_SUCCESS;
 
-	/* set notify on release flag */
-	xcgroup_set_param(cg, "notify_on_release", "0");
+	/*
+	 * set notify on release flag, an existing cgroup already got it when
+	 * it was created
+	 */
+	if (created)
+		xcgroup_set_param(cg, "notify_on_release", "0");
 
 	return fstatus;
 }
@@ -127,6 +127,8 @@ get_procs(uint16_t *procs)
 
 static char *hwloc_xml_whole = NULL;
 
+#define BOOT_ID_FILE "/proc/sys/kernel/random/boot_id"
+
 #if _DEBUG
 static void _hwloc_children(hwloc_topology_t topology, hwloc_obj_t obj,
 			    int depth)
@@ -167,6 +169,71 @@ static inline int _internal_hwloc_topology_export_xml(
 #endif
 }
 
+/* Return the kernel's boot id, which changes on every reboot. xfree() it. */
+static char *_get_boot_id(void)
+{
+	char buf[64], *nl;
+	FILE *fp;
+
+	if (!(fp = fopen(BOOT_ID_FILE, "r")))
+		return NULL;
+	if (!fgets(buf, sizeof(buf), fp)) {
+		fclose(fp);
+		return NULL;
+	}
+	fclose(fp);
+	if ((nl = strchr(buf, '\n')))
+		*nl = '\0';
+
+	return xstrdup(buf);
+}
+
+/*
+ * The hardware can not change without a reboot, so a topology file written
+ * since the last boot can be trusted. Record the boot id next to the file.
+ */
+static bool _topo_file_current(char *topo_file)
+{
+	char *boot_id, *id_file, buf[64] = "", *nl;
+	FILE *fp;
+	bool current = false;
+
+	if (!(boot_id = _get_boot_id()))
+		return false;
+
+	id_file = xstrdup_printf("%s.boot_id", topo_file);
+	if ((fp = fopen(id_file, "r"))) {
+		if (fgets(buf, sizeof(buf), fp)) {
+			if ((nl = strchr(buf, '\n')))
+				*nl = '\0';
+			current = !xstrcmp(buf, boot_id);
+		}
+		fclose(fp);
+	}
+	xfree(id_file);
+	xfree(boot_id);
+
+	return current;
+}
+
+static void _topo_file_set_boot_id(char *topo_file)
+{
+	char *boot_id, *id_file;
+	FILE *fp;
+
+	if (!(boot_id = _get_boot_id()))
+		return;
+
+	id_file = xstrdup_printf("%s.boot_id", topo_file);
+	if ((fp = fopen(id_file, "w"))) {
+		fprintf(fp, "%s\n", boot_id);
+		fclose(fp);
+	} else
+		debug("%s: unable to write %s: %m", __func__, id_file);
+	xfree(id_file);
+	xfree(boot_id);
+}
+
 /* read or load topology and write if needed
  * init and destroy topology must be outside this function */
 extern int xcpuinfo_hwloc_topo_load(
@@ -187,8 +254,11 @@ extern int xcpuinfo_hwloc_topo_load(
 	}
 
 	if (full && first_full) {
-		/* Always regenerate file on slurmd startup */
-		if (running_in_slurmd())
+		/*
+		 * Regenerate file on slurmd startup, unless it was written
+		 * since the node last booted
+		 */
+		if (running_in_slurmd() && !_topo_file_current(topo_file))
 			check_file = false;
 		first_full = false;
 	}
@@ -247,7 +317,8 @@ handle_write:
 		if (_internal_hwloc_topology_export_xml(*topology, topo_file)) {
 			/* error in export hardware topology */
 			error("%s: failed (load will be required after read failures).", __func__);
-		}
+		} else if (full && running_in_slurmd())
+			_topo_file_set_boot_id(topo_file);
 	}
 
 	if (!topology_in)
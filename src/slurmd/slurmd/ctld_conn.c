@@ -0,0 +1,226 @@
+/*****************************************************************************\
+ *  ctld_conn.c - persistent connection from slurmd to slurmctld
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include "config.h"
+
+#include <poll.h>
+#include <pthread.h>
+
+#include "src/common/forward.h"
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/read_config.h"
+#include "src/common/slurm_persist_conn.h"
+#include "src/common/slurm_protocol_api.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "src/slurmd/slurmd/ctld_conn.h"
+
+/* Seconds to use regular connections after the persistent one failed */
+#define CTLD_CONN_RETRY_DELAY	60
+/* Same, but after slurmctld refused it (no SlurmctldParameters=rpc_epoll) */
+#define CTLD_CONN_REFUSED_DELAY	3600
+
+static slurm_persist_conn_t *ctld_conn = NULL;
+static pthread_mutex_t ctld_conn_lock = PTHREAD_MUTEX_INITIALIZER;
+static time_t ctld_conn_retry = 0;	/* do not try to open before this */
+static time_t ctld_conn_shutdown = 0;	/* never set, connection is closed
+					 * by ctld_conn_fini() instead */
+
+static bool _enabled(void)
+{
+	/* working_cluster_rec is only set for testing */
+	return (!working_cluster_rec &&
+		xstrcasestr(slurm_conf.comm_params, "SlurmdPersistConn"));
+}
+
+/* Give up on the persistent connection for a while */
+static void _conn_fail(void)
+{
+	slurm_persist_conn_close(ctld_conn);
+	ctld_conn_retry = time(NULL) + CTLD_CONN_RETRY_DELAY;
+}
+
+/*
+ * Make sure ctld_conn is open, called with ctld_conn_lock held.
+ * slurmctld never writes to an idle connection, so if it is readable the
+ * controller has closed it (e.g. on restart) and it is reopened.
+ * RET true if ctld_conn can be used
+ */
+static bool _conn_open(void)
+{
+	int rc;
+
+	if (ctld_conn && (ctld_conn->fd >= 0)) {
+		struct pollfd pfd = { .fd = ctld_conn->fd, .events = POLLIN };
+
+		if (poll(&pfd, 1, 0) == 0)
+			return true;
+		debug("%s: slurmctld closed persistent connection, reopening",
+		      __func__);
+		slurm_persist_conn_close(ctld_conn);
+	} else if (time(NULL) < ctld_conn_retry) {
+		return false;
+	}
+
+	if (!ctld_conn) {
+		ctld_conn = xmalloc(sizeof(*ctld_conn));
+		ctld_conn->cluster_name = xstrdup(slurm_conf.cluster_name);
+		ctld_conn->fd = -1;
+		ctld_conn->flags = PERSIST_FLAG_SUPPRESS_ERR;
+		ctld_conn->persist_type = PERSIST_TYPE_SLURMD;
+		ctld_conn->rem_host = xstrdup(slurm_conf.control_addr[0]);
+		ctld_conn->rem_port = slurm_conf.slurmctld_port;
+		ctld_conn->shutdown = &ctld_conn_shutdown;
+		ctld_conn->timeout = -1;	/* MessageTimeout */
+		ctld_conn->version = SLURM_PROTOCOL_VERSION;
+	}
+
+	if ((rc = slurm_persist_conn_open(ctld_conn)) != SLURM_SUCCESS) {
+		int delay = (rc == ESLURM_NOT_SUPPORTED) ?
+			    CTLD_CONN_REFUSED_DELAY : CTLD_CONN_RETRY_DELAY;
+
+		_conn_fail();
+		ctld_conn_retry = time(NULL) + delay;
+		debug("%s: unable to open persistent connection to %s, using a connection per message for %d seconds",
+		      __func__, ctld_conn->rem_host, delay);
+		return false;
+	}
+	debug2("%s: opened persistent connection to %s:%u",
+	       __func__, ctld_conn->rem_host, ctld_conn->rem_port);
+	ctld_conn_retry = 0;
+
+	return true;
+}
+
+/*
+ * Send a message over ctld_conn, reading the response if resp is not NULL.
+ * Called with ctld_conn_lock held. The connection is reopened and the
+ * message sent again once if it fails, slurmctld tolerates duplicates of
+ * the messages sent this way.
+ * RET SLURM_SUCCESS or SLURM_ERROR to fall back to a regular connection
+ */
+static int _conn_send(slurm_msg_t *req, slurm_msg_t *resp)
+{
+	int rc = SLURM_ERROR;
+
+	if (!_conn_open())
+		return SLURM_ERROR;
+
+	forward_init(&req->forward);
+	req->ret_list = NULL;
+	req->forward_struct = NULL;
+
+	for (int retry = 0; retry < 2; retry++) {
+		if (retry && slurm_persist_conn_reopen(ctld_conn, true))
+			break;
+
+		req->conn = ctld_conn;
+		if (resp) {
+			rc = slurm_send_recv_msg(ctld_conn->fd, req, resp, 0);
+			resp->conn = NULL;
+		} else if (slurm_send_node_msg(ctld_conn->fd, req) >= 0) {
+			rc = SLURM_SUCCESS;
+		}
+		req->conn = NULL;
+
+		if (rc == SLURM_SUCCESS)
+			break;
+	}
+
+	if (rc != SLURM_SUCCESS) {
+		_conn_fail();
+	} else if (resp && (resp->msg_type == RESPONSE_SLURM_RC) &&
+		   (((return_code_msg_t *) resp->data)->return_code ==
+		    ESLURM_IN_STANDBY_MODE)) {
+		/* Let the regular path find the controller in charge */
+		slurm_free_return_code_msg(resp->data);
+		resp->data = NULL;
+		_conn_fail();
+		rc = SLURM_ERROR;
+	}
+
+	return rc;
+}
+
+extern int ctld_conn_send_recv_msg(slurm_msg_t *req, slurm_msg_t *resp)
+{
+	/* Do not queue behind another thread, open a regular connection */
+	if (_enabled() && !pthread_mutex_trylock(&ctld_conn_lock)) {
+		int rc = _conn_send(req, resp);
+
+		slurm_mutex_unlock(&ctld_conn_lock);
+		if (rc == SLURM_SUCCESS)
+			return rc;
+	}
+
+	return slurm_send_recv_controller_msg(req, resp, working_cluster_rec);
+}
+
+extern int ctld_conn_send_recv_rc_msg(slurm_msg_t *req, int *rc)
+{
+	slurm_msg_t resp;
+
+	if (ctld_conn_send_recv_msg(req, &resp))
+		return -1;
+
+	*rc = slurm_get_return_code(resp.msg_type, resp.data);
+	slurm_free_msg_data(resp.msg_type, resp.data);
+
+	return 0;
+}
+
+extern int ctld_conn_send_only_msg(slurm_msg_t *req)
+{
+	if (_enabled() && !pthread_mutex_trylock(&ctld_conn_lock)) {
+		int rc = _conn_send(req, NULL);
+
+		slurm_mutex_unlock(&ctld_conn_lock);
+		if (rc == SLURM_SUCCESS)
+			return rc;
+	}
+
+	return slurm_send_only_controller_msg(req, working_cluster_rec);
+}
+
+extern void ctld_conn_fini(void)
+{
+	slurm_mutex_lock(&ctld_conn_lock);
+	slurm_persist_conn_destroy(ctld_conn);
+	ctld_conn = NULL;
+	ctld_conn_retry = 0;
+	slurm_mutex_unlock(&ctld_conn_lock);
+}
@@ -0,0 +1,74 @@
+/*****************************************************************************\
+ *  ctld_conn.h - persistent connection from slurmd to slurmctld
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _SLURMD_CTLD_CONN_H
+#define _SLURMD_CTLD_CONN_H
+
+#include "src/common/slurm_protocol_defs.h"
+
+/*
+ * With CommunicationParameters=SlurmdPersistConn, the messages slurmd sends
+ * to slurmctld on its own behalf share one persistent, authenticated
+ * connection instead of opening a new connection for every message.
+ * Each function falls back to a regular connection to the active controller
+ * if the persistent connection is busy in another thread, can not be
+ * (re)opened or is not supported by slurmctld.
+ */
+
+/*
+ * Send a message to slurmctld and wait for the response.
+ * Same semantics as slurm_send_recv_controller_msg().
+ */
+extern int ctld_conn_send_recv_msg(slurm_msg_t *req, slurm_msg_t *resp);
+
+/*
+ * Send a message to slurmctld and return the response's return code in rc.
+ * Same semantics as slurm_send_recv_controller_rc_msg().
+ */
+extern int ctld_conn_send_recv_rc_msg(slurm_msg_t *req, int *rc);
+
+/*
+ * Send a message for which slurmctld sends no response.
+ * Same semantics as slurm_send_only_controller_msg().
+ */
+extern int ctld_conn_send_only_msg(slurm_msg_t *req);
+
+/*
+ * Close the persistent connection. It is reopened with the current
+ * configuration by the next message. Used on reconfigure and shutdown.
+ */
+extern void ctld_conn_fini(void);
+
+#endif /* _SLURMD_CTLD_CONN_H */
@@ -98,6 +98,7 @@
 
 #include "src/bcast/file_bcast.h"
 
+#include "src/slurmd/slurmd/ctld_conn.h"
 #include "src/slurmd/slurmd/get_mach_stat.h"
 #include "src/slurmd/slurmd/slurmd.h"
 
@@ -133,6 +134,11 @@ typedef struct {
 	uint32_t step_id;
 } starting_step_t;
 
+typedef struct {
+	int to_stepd;		/* write end of the slurmstepd's stdin */
+	int to_slurmd;		/* read end of the slurmstepd's stdout */
+} stepd_pool_ent_t;
+
 typedef struct {
 	uint32_t job_id;
 	uint16_t msg_timeout;
@@ -263,6 +269,15 @@ static pthread_cond_t  file_bcast_cond  = PTHREAD_COND_INITIALIZER;
 static int fb_read_lock = 0, fb_write_wait_lock = 0, fb_write_lock = 0;
 static List file_bcast_list = NULL;
 
+/* Idle slurmstepd waiting for a launch request, see stepd_pool_init() */
+#define MAX_STEPD_POOL 256
+static pthread_mutex_t stepd_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static List stepd_pool = NULL;
+static int stepd_pool_size = 0;
+static uint32_t stepd_pool_gen = 0;
+static bool stepd_pool_refilling = false;
+static pthread_t stepd_pool_tid = 0;	/* refill thread, joined when done */
+
 void
 slurmd_req(slurm_msg_t *msg)
 {
@@ -680,20 +695,18 @@ rwfail:
 
 
 /*
- * Fork and exec the slurmstepd, then send the slurmstepd its
- * initialization data.  Then wait for slurmstepd to send an "ok"
- * message before returning.  When the "ok" message is received,
- * the slurmstepd has created and begun listening on its unix
- * domain socket.
+ * Fork and exec a slurmstepd with its stdin/stdout connected to pipes.
+ * On success the slurmd ends of the pipes are returned in to_stepd_fd and
+ * to_slurmd_fd, and the slurmstepd is blocked waiting for its
+ * initialization data.  type and req are only used for memcheck log names
+ * and may be 0/NULL.
  *
  * Note that this code forks twice and it is the grandchild that
  * becomes the slurmstepd process, so the slurmstepd's parent process
  * will be init, not slurmd.
  */
-static int
-_forkexec_slurmstepd(uint16_t type, void *req,
-		     slurm_addr_t *cli, slurm_addr_t *self,
-		     const hostset_t step_hset, uint16_t protocol_version)
+static int _fork_slurmstepd(uint16_t type, void *req,
+			    int *to_stepd_fd, int *to_slurmd_fd)
 {
 	pid_t pid;
 	int to_stepd[2] = {-1, -1};
@@ -701,11 +714,10 @@ _forkexec_slurmstepd(uint16_t type, void *req,
 
 	if (pipe(to_stepd) < 0 || pipe(to_slurmd) < 0) {
 		error("%s: pipe failed: %m", __func__);
-		return SLURM_ERROR;
-	}
-
-	if (_add_starting_step(type, req)) {
-		error("%s: failed in _add_starting_step: %m", __func__);
+		if (to_stepd[0] >= 0) {
+			close(to_stepd[0]);
+			close(to_stepd[1]);
+		}
 		return SLURM_ERROR;
 	}
 
@@ -715,75 +727,24 @@ _forkexec_slurmstepd(uint16_t type, void *req,
 		close(to_stepd[1]);
 		close(to_slurmd[0]);
 		close(to_slurmd[1]);
-		_remove_starting_step(type, req);
 		return SLURM_ERROR;
 	} else if (pid > 0) {
-		int rc = SLURM_SUCCESS;
-#if (SLURMSTEPD_MEMCHECK == 0)
-		int i;
-		time_t start_time = time(NULL);
-#endif
-		/*
-		 * Parent sends initialization data to the slurmstepd
-		 * over the to_stepd pipe, and waits for the return code
-		 * reply on the to_slurmd pipe.
-		 */
 		if (close(to_stepd[0]) < 0)
 			error("Unable to close read to_stepd in parent: %m");
 		if (close(to_slurmd[1]) < 0)
 			error("Unable to close write to_slurmd in parent: %m");
 
-		if ((rc = _send_slurmstepd_init(to_stepd[1], type,
-						req, cli, self,
-						step_hset,
-						protocol_version)) != 0) {
-			error("Unable to init slurmstepd");
-			goto done;
-		}
-
-		/* If running under valgrind/memcheck, this pipe doesn't work
-		 * correctly so just skip it. */
-#if (SLURMSTEPD_MEMCHECK == 0)
-		i = read(to_slurmd[0], &rc, sizeof(int));
-		if (i < 0) {
-			error("%s: Can not read return code from slurmstepd "
-			      "got %d: %m", __func__, i);
-			rc = SLURM_ERROR;
-		} else if (i != sizeof(int)) {
-			error("%s: slurmstepd failed to send return code "
-			      "got %d: %m", __func__, i);
-			rc = SLURM_ERROR;
-		} else {
-			int delta_time = time(NULL) - start_time;
-			int cc;
-			if (delta_time > 5) {
-				info("Warning: slurmstepd startup took %d sec, "
-				     "possible file system problem or full "
-				     "memory", delta_time);
-			}
-			if (rc != SLURM_SUCCESS)
-				error("slurmstepd return code %d", rc);
-
-			cc = SLURM_SUCCESS;
-			cc = write(to_stepd[1], &cc, sizeof(int));
-			if (cc != sizeof(int)) {
-				error("%s: failed to send ack to stepd %d: %m",
-				      __func__, cc);
-			}
-		}
-#endif
-	done:
-		if (_remove_starting_step(type, req))
-			error("Error cleaning up starting_step list");
-
 		/* Reap child */
 		if (waitpid(pid, NULL, 0) < 0)
 			error("Unable to reap slurmd child process");
-		if (close(to_stepd[1]) < 0)
-			error("close write to_stepd in parent: %m");
-		if (close(to_slurmd[0]) < 0)
-			error("close read to_slurmd in parent: %m");
-		return rc;
+
+		/* Don't leak these into other children (pooled slurmstepd) */
+		fd_set_close_on_exec(to_stepd[1]);
+		fd_set_close_on_exec(to_slurmd[0]);
+
+		*to_stepd_fd = to_stepd[1];
+		*to_slurmd_fd = to_slurmd[0];
+		return SLURM_SUCCESS;
 	} else {
 #if (SLURMSTEPD_MEMCHECK == 1)
 		/* memcheck test of slurmstepd, option #1 */
@@ -931,6 +892,246 @@ _forkexec_slurmstepd(uint16_t type, void *req,
 	}
 }
 
+static void _stepd_pool_ent_free(void *x)
+{
+	stepd_pool_ent_t *ent = x;
+
+	if (ent) {
+		(void) close(ent->to_stepd);
+		(void) close(ent->to_slurmd);
+		xfree(ent);
+	}
+}
+
+/*
+ * Take an idle slurmstepd from the pool.
+ * RET true if one was found, false if a new one has to be forked.
+ */
+static bool _stepd_pool_get(int *to_stepd, int *to_slurmd)
+{
+	stepd_pool_ent_t *ent;
+	struct pollfd pfd;
+	bool found = false;
+
+	slurm_mutex_lock(&stepd_pool_mutex);
+	while (stepd_pool && (ent = list_pop(stepd_pool))) {
+		/*
+		 * An idle slurmstepd never writes to slurmd, so any event
+		 * here means it went away.
+		 */
+		pfd.fd = ent->to_slurmd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		if (poll(&pfd, 1, 0) != 0) {
+			debug("%s: discarding dead pooled slurmstepd",
+			      __func__);
+			_stepd_pool_ent_free(ent);
+			continue;
+		}
+		*to_stepd = ent->to_stepd;
+		*to_slurmd = ent->to_slurmd;
+		xfree(ent);
+		found = true;
+		break;
+	}
+	slurm_mutex_unlock(&stepd_pool_mutex);
+
+	return found;
+}
+
+static void *_stepd_pool_refill(void *arg)
+{
+	stepd_pool_ent_t *ent;
+	int to_stepd, to_slurmd;
+	uint32_t gen;
+
+	slurm_mutex_lock(&stepd_pool_mutex);
+	while (stepd_pool && (list_count(stepd_pool) < stepd_pool_size)) {
+		gen = stepd_pool_gen;
+		/* Don't block launches while forking */
+		slurm_mutex_unlock(&stepd_pool_mutex);
+		if (_fork_slurmstepd(0, NULL, &to_stepd, &to_slurmd) !=
+		    SLURM_SUCCESS) {
+			slurm_mutex_lock(&stepd_pool_mutex);
+			break;
+		}
+		ent = xmalloc(sizeof(*ent));
+		ent->to_stepd = to_stepd;
+		ent->to_slurmd = to_slurmd;
+
+		slurm_mutex_lock(&stepd_pool_mutex);
+		/* Pool was flushed by a reconfigure while we forked */
+		if (!stepd_pool || (gen != stepd_pool_gen)) {
+			_stepd_pool_ent_free(ent);
+			continue;
+		}
+		list_append(stepd_pool, ent);
+	}
+	stepd_pool_refilling = false;
+	slurm_mutex_unlock(&stepd_pool_mutex);
+
+	return NULL;
+}
+
+/* Start refilling the pool in the background if it is short */
+static void _stepd_pool_kick(void)
+{
+	slurm_mutex_lock(&stepd_pool_mutex);
+	if (stepd_pool && !stepd_pool_refilling &&
+	    (list_count(stepd_pool) < stepd_pool_size)) {
+		/* The previous refill thread has finished, reap it */
+		if (stepd_pool_tid)
+			pthread_join(stepd_pool_tid, NULL);
+		stepd_pool_refilling = true;
+		slurm_thread_create(&stepd_pool_tid, _stepd_pool_refill, NULL);
+	}
+	slurm_mutex_unlock(&stepd_pool_mutex);
+}
+
+extern void stepd_pool_init(void)
+{
+	char *tmp, *end_ptr = NULL;
+	long size;
+
+	slurm_mutex_lock(&stepd_pool_mutex);
+	stepd_pool_gen++;
+	if (stepd_pool)
+		list_flush(stepd_pool);
+	else
+		stepd_pool = list_create(_stepd_pool_ent_free);
+
+	stepd_pool_size = 0;
+	if ((tmp = xstrcasestr(slurm_conf.launch_params, "slurmstepd_pool="))) {
+		size = strtol(tmp + 16, &end_ptr, 10);
+		if ((end_ptr == (tmp + 16)) ||
+		    ((end_ptr[0] != '\0') && (end_ptr[0] != ',')) ||
+		    (size < 0)) {
+			error("Invalid LaunchParameters slurmstepd_pool value, disabling the slurmstepd pool");
+			size = 0;
+		} else if (size > MAX_STEPD_POOL) {
+			error("LaunchParameters slurmstepd_pool=%ld exceeds the maximum, using %d",
+			      size, MAX_STEPD_POOL);
+			size = MAX_STEPD_POOL;
+		}
+		stepd_pool_size = size;
+	}
+#if (SLURMSTEPD_MEMCHECK != 0)
+	/* memcheck wants a log file named after the job */
+	stepd_pool_size = 0;
+#endif
+	if (stepd_pool_size)
+		debug("%s: keeping %d idle slurmstepd", __func__,
+		      stepd_pool_size);
+	slurm_mutex_unlock(&stepd_pool_mutex);
+
+	_stepd_pool_kick();
+}
+
+extern void stepd_pool_fini(void)
+{
+	pthread_t tid;
+
+	/* With a size of 0 the refill thread stops after its current fork */
+	slurm_mutex_lock(&stepd_pool_mutex);
+	stepd_pool_size = 0;
+	tid = stepd_pool_tid;
+	stepd_pool_tid = 0;
+	slurm_mutex_unlock(&stepd_pool_mutex);
+	if (tid)
+		pthread_join(tid, NULL);
+
+	slurm_mutex_lock(&stepd_pool_mutex);
+	/* Closing the pipes makes the idle slurmstepd exit */
+	FREE_NULL_LIST(stepd_pool);
+	slurm_mutex_unlock(&stepd_pool_mutex);
+}
+
+/*
+ * Get a slurmstepd from the pool (or fork and exec a new one), then send
+ * the slurmstepd its initialization data.  Then wait for slurmstepd to
+ * send an "ok" message before returning.  When the "ok" message is
+ * received, the slurmstepd has created and begun listening on its unix
+ * domain socket.
+ */
+static int
+_forkexec_slurmstepd(uint16_t type, void *req,
+		     slurm_addr_t *cli, slurm_addr_t *self,
+		     const hostset_t step_hset, uint16_t protocol_version)
+{
+	int to_stepd = -1, to_slurmd = -1;
+	int rc = SLURM_SUCCESS;
+#if (SLURMSTEPD_MEMCHECK == 0)
+	int i;
+	time_t start_time = time(NULL);
+#endif
+
+	if (_add_starting_step(type, req)) {
+		error("%s: failed in _add_starting_step: %m", __func__);
+		return SLURM_ERROR;
+	}
+
+	if (!_stepd_pool_get(&to_stepd, &to_slurmd) &&
+	    (_fork_slurmstepd(type, req, &to_stepd, &to_slurmd) !=
+	     SLURM_SUCCESS)) {
+		_remove_starting_step(type, req);
+		return SLURM_ERROR;
+	}
+
+	/*
+	 * Send initialization data to the slurmstepd over the to_stepd
+	 * pipe, and wait for the return code reply on the to_slurmd pipe.
+	 */
+	if ((rc = _send_slurmstepd_init(to_stepd, type, req, cli, self,
+					step_hset, protocol_version)) != 0) {
+		error("Unable to init slurmstepd");
+		goto done;
+	}
+
+	/* If running under valgrind/memcheck, this pipe doesn't work
+	 * correctly so just skip it. */
+#if (SLURMSTEPD_MEMCHECK == 0)
+	i = read(to_slurmd, &rc, sizeof(int));
+	if (i < 0) {
+		error("%s: Can not read return code from slurmstepd "
+		      "got %d: %m", __func__, i);
+		rc = SLURM_ERROR;
+	} else if (i != sizeof(int)) {
+		error("%s: slurmstepd failed to send return code "
+		      "got %d: %m", __func__, i);
+		rc = SLURM_ERROR;
+	} else {
+		int delta_time = time(NULL) - start_time;
+		int cc;
+		if (delta_time > 5) {
+			info("Warning: slurmstepd startup took %d sec, "
+			     "possible file system problem or full "
+			     "memory", delta_time);
+		}
+		if (rc != SLURM_SUCCESS)
+			error("slurmstepd return code %d", rc);
+
+		cc = SLURM_SUCCESS;
+		cc = write(to_stepd, &cc, sizeof(int));
+		if (cc != sizeof(int)) {
+			error("%s: failed to send ack to stepd %d: %m",
+			      __func__, cc);
+		}
+	}
+#endif
+done:
+	if (_remove_starting_step(type, req))
+		error("Error cleaning up starting_step list");
+
+	if (close(to_stepd) < 0)
+		error("close write to_stepd in parent: %m");
+	if (close(to_slurmd) < 0)
+		error("close read to_slurmd in parent: %m");
+
+	_stepd_pool_kick();
+
+	return rc;
+}
+
 static void _setup_x11_display(uint32_t job_id, uint32_t step_id,
 			       char ***env, uint32_t *envc)
 {
@@ -1927,8 +2128,7 @@ static int _notify_slurmctld_prolog_fini(
 	 * slurm_send_recv_controller_rc_msg since it means there was a
 	 * communication failure and we may need to try again.
 	 */
-	if ((ret_c = slurm_send_recv_controller_rc_msg(
-		     &req_msg, &rc, working_cluster_rec)))
+	if ((ret_c = ctld_conn_send_recv_rc_msg(&req_msg, &rc)))
 		error("Error sending prolog completion notification: %m");
 
 	return ret_c;
@@ -2718,8 +2918,7 @@ _launch_job_fail(uint32_t job_id, uint32_t slurm_rc)
 		comp_msg.jobacct = NULL; /* unused */
 		resp_msg.msg_type = REQUEST_COMPLETE_BATCH_SCRIPT;
 		resp_msg.data = &comp_msg;
-		rpc_rc = slurm_send_recv_controller_rc_msg(&resp_msg, &rc,
-							   working_cluster_rec);
+		rpc_rc = ctld_conn_send_recv_rc_msg(&resp_msg, &rc);
 	}
 
 	return rpc_rc;
@@ -2742,8 +2941,7 @@ _abort_step(uint32_t job_id, uint32_t step_id)
 	resp.jobacct      = jobacctinfo_create(NULL);
 	resp_msg.msg_type = REQUEST_STEP_COMPLETE;
 	resp_msg.data     = &resp;
-	rc2 = slurm_send_recv_controller_rc_msg(&resp_msg, &rc,
-						working_cluster_rec);
+	rc2 = ctld_conn_send_recv_rc_msg(&resp_msg, &rc);
 	/* Note: we are ignoring the RPC return code */
 	jobacctinfo_destroy(resp.jobacct);
 	return rc2;
@@ -2766,26 +2964,32 @@ _rpc_reconfig(slurm_msg_t *msg)
 static void _rpc_reconfig_with_config(slurm_msg_t *msg)
 {
 	uid_t req_uid = g_slurm_auth_get_uid(msg->auth_cred);
+	int rc = SLURM_SUCCESS;
 
-	if (!_slurm_authorized_user(req_uid))
+	if (!_slurm_authorized_user(req_uid)) {
 		error("Security violation, reconfig RPC from uid %d",
 		      req_uid);
-	else {
-		if (conf->conf_cache) {
-			config_response_msg_t *configs =
-				(config_response_msg_t *) msg->data;
-			/*
-			 * Running in "configless" mode as indicated by the
-			 * cache directory's existance. Update those so
-			 * our reconfigure picks up the changes, and so
-			 * client commands see the changes as well.
-			 */
-			write_configs_to_conf_cache(configs, conf->conf_cache);
-		}
-		kill(conf->pid, SIGHUP);
+		rc = ESLURM_USER_ID_MISSING;
+	} else if (conf->conf_cache) {
+		config_response_msg_t *configs =
+			(config_response_msg_t *) msg->data;
+		/*
+		 * Running in "configless" mode as indicated by the
+		 * cache directory's existance. Update those so
+		 * our reconfigure picks up the changes, and so
+		 * client commands see the changes as well.
+		 */
+		write_configs_to_conf_cache(configs, conf->conf_cache);
 	}
-	forward_wait(msg);
-	/* Never return a message, slurmctld does not expect one */
+
+	/*
+	 * The configs reach us through the message forwarding tree, so
+	 * reply once all nodes below us have done so.
+	 */
+	slurm_send_rc_msg(msg, rc);
+
+	if (rc == SLURM_SUCCESS)
+		kill(conf->pid, SIGHUP);
 }
 
 static void
@@ -3144,6 +3348,14 @@ _enforce_job_mem_limit(void)
 	xfree(job_mem_info_ptr);
 }
 
+extern void run_ping_tasks(void)
+{
+	/* Take this opportunity to enforce any job memory limits */
+	_enforce_job_mem_limit();
+	/* Clear up any stalled file transfers as well */
+	_file_bcast_cleanup();
+}
+
 static int
 _rpc_ping(slurm_msg_t *msg)
 {
@@ -3187,10 +3399,7 @@ _rpc_ping(slurm_msg_t *msg)
 		slurm_send_node_msg(msg->conn_fd, &resp_msg);
 	}
 
-	/* Take this opportunity to enforce any job memory limits */
-	_enforce_job_mem_limit();
-	/* Clear up any stalled file transfers as well */
-	_file_bcast_cleanup();
+	run_ping_tasks();
 	return rc;
 }
 
@@ -3221,10 +3430,7 @@ _rpc_health_check(slurm_msg_t *msg)
 	if (rc == SLURM_SUCCESS)
 		rc = run_script_health_check();
 
-	/* Take this opportunity to enforce any job memory limits */
-	_enforce_job_mem_limit();
-	/* Clear up any stalled file transfers as well */
-	_file_bcast_cleanup();
+	run_ping_tasks();
 	return rc;
 }
 
@@ -3552,8 +3758,7 @@ _rpc_step_complete_aggr(slurm_msg_t *msg)
 		slurm_msg_t req;
 		_setup_step_complete_msg(&req, msg->data);
 
-		while (slurm_send_recv_controller_rc_msg(
-			       &req, &rc, working_cluster_rec) < 0) {
+		while (ctld_conn_send_recv_rc_msg(&req, &rc) < 0) {
 			error("Unable to send step complete, "
 			      "trying again in a minute: %m");
 		}
@@ -4792,8 +4997,7 @@ _epilog_complete(uint32_t jobid, int rc)
 
 		/* Note: No return code to message, slurmctld will resend
 		 * TERMINATE_JOB request if message send fails */
-		if (slurm_send_only_controller_msg(&msg, working_cluster_rec)
-		    < 0) {
+		if (ctld_conn_send_only_msg(&msg) < 0) {
 			error("Unable to send epilog complete message: %m");
 			ret = SLURM_ERROR;
 		} else {
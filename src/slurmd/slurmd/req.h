@@ -59,9 +59,24 @@ void gids_cache_purge(void);
 /* Add record for every launched job so we know they are ready for suspend */
 extern void record_launched_jobs(void);
 
+/*
+ * Periodic work done whenever slurmctld pings slurmd: enforce job memory
+ * limits and clean up stalled file transfers. Also run with heartbeats, as
+ * slurmctld does not ping nodes which send them.
+ */
+extern void run_ping_tasks(void);
+
 void file_bcast_init(void);
 void file_bcast_purge(void);
 
+/*
+ * (Re)build the pool of idle slurmstepd processes as configured by
+ * LaunchParameters=slurmstepd_pool=#. Any idle slurmstepd started with the
+ * previous configuration is released.
+ */
+extern void stepd_pool_init(void);
+extern void stepd_pool_fini(void);
+
 /*
  * ume_notify - Notify all jobs and steps on this node that a Uncorrectable
  *	Memory Error (UME) has occured by sending SIG_UME (to log event in
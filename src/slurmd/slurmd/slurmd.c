@@ -117,6 +117,7 @@
 #include "src/slurmd/common/task_plugin.h"
 #include "src/slurmd/common/xcpuinfo.h"
 
+#include "src/slurmd/slurmd/ctld_conn.h"
 #include "src/slurmd/slurmd/get_mach_stat.h"
 #include "src/slurmd/slurmd/req.h"
 #include "src/slurmd/slurmd/slurmd.h"
@@ -157,6 +158,17 @@ typedef struct connection {
 	slurm_addr_t *cli_addr;
 } conn_t;
 
+/*
+ * Accepted connections are queued for a pool of worker threads. Workers
+ * are created on demand, bounded by MAX_THREADS through active_threads,
+ * and exit after WORKER_IDLE_TIME seconds without work.
+ */
+#define WORKER_IDLE_TIME	60
+static List            conn_queue     = NULL;
+static int             idle_workers   = 0;
+static pthread_mutex_t worker_mutex   = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  worker_cond    = PTHREAD_COND_INITIALIZER;
+
 /*
  * Global data for resource specialization
  */
@@ -178,6 +190,7 @@ static sig_atomic_t _reconfig = 0;
 static sig_atomic_t _update_log = 0;
 static pthread_t msg_pthread = (pthread_t) 0;
 static time_t sent_reg_time = (time_t) 0;
+static pthread_t heartbeat_tid;
 
 static void      _atfork_final(void);
 static void      _atfork_prepare(void);
@@ -205,6 +218,8 @@ static void      _print_gres(void);
 static void      _process_cmdline(int ac, char **av);
 static void      _read_config(void);
 static void      _reconfigure(void);
+static void     *_connection_worker(void *arg);
+static void     *_heartbeat_engine(void *arg);
 static void     *_registration_engine(void *arg);
 static void      _resource_spec_fini(void);
 static int       _resource_spec_init(void);
@@ -392,6 +407,7 @@ main (int argc, char **argv)
 	_install_fork_handlers();
 	slurm_conf_install_fork_handlers();
 	record_launched_jobs();
+	stepd_pool_init();
 
 	run_script_health_check();
 
@@ -400,8 +416,10 @@ main (int argc, char **argv)
 			     conf->msg_aggr_window_msgs);
 
 	slurm_thread_create_detached(NULL, _registration_engine, NULL);
+	slurm_thread_create(&heartbeat_tid, _heartbeat_engine, NULL);
 
 	_msg_engine();
+	pthread_join(heartbeat_tid, NULL);
 
 	/*
 	 * Close fd here, otherwise we'll deadlock since create_pidfile()
@@ -414,6 +432,7 @@ main (int argc, char **argv)
 		      slurm_conf.slurmd_pidfile);
 
 	_wait_for_all_threads(120);
+	stepd_pool_fini();
 	_slurmd_fini();
 	_destroy_conf();
 	slurm_cred_fini();	/* must be after _destroy_conf() */
@@ -450,6 +469,64 @@ _registration_engine(void *arg)
 	return NULL;
 }
 
+static void _send_heartbeat_msg(void)
+{
+	node_heartbeat_msg_t msg;
+	slurm_msg_t req;
+
+	memset(&msg, 0, sizeof(msg));
+	get_cpu_load(&msg.cpu_load);
+	get_free_mem(&msg.free_mem);
+	msg.node_name = conf->node_name;
+
+	slurm_msg_t_init(&req);
+	req.msg_type = MESSAGE_NODE_HEARTBEAT;
+	req.data     = &msg;
+
+	if (ctld_conn_send_only_msg(&req) < 0)
+		debug("Unable to send heartbeat: %m");
+}
+
+/*
+ * With CommunicationParameters=SlurmdHeartbeat, push a heartbeat to
+ * slurmctld several times per SlurmdTimeout once registered. slurmctld
+ * then only pings nodes whose heartbeat is overdue.
+ */
+static void *
+_heartbeat_engine(void *arg)
+{
+	time_t now, next_time = 0;
+	int interval;
+
+	/* Not counted in active_threads, reconfigure waits for those */
+	while (!_shutdown) {
+		sleep(1);
+		if (!sent_reg_time || !slurm_conf.slurmd_timeout ||
+		    !xstrcasestr(slurm_conf.comm_params, "SlurmdHeartbeat")) {
+			next_time = 0;
+			continue;
+		}
+
+		/*
+		 * slurmctld pings nodes it has not heard from in the last
+		 * SlurmdTimeout/3 seconds. Spread the first heartbeat of each
+		 * node over one interval.
+		 */
+		interval = MAX(slurm_conf.slurmd_timeout / 4, 1);
+		now = time(NULL);
+		if (!next_time)
+			next_time = now + (random() % interval);
+		if (now < next_time)
+			continue;
+		next_time = now + interval;
+
+		_send_heartbeat_msg();
+		run_ping_tasks();
+	}
+
+	return NULL;
+}
+
 static void
 _msg_engine(void)
 {
@@ -485,6 +562,11 @@ _msg_engine(void)
 	}
 	verbose("got shutdown request");
 	close(conf->lfd);
+
+	/* Let idle workers exit */
+	slurm_mutex_lock(&worker_mutex);
+	slurm_cond_broadcast(&worker_cond);
+	slurm_mutex_unlock(&worker_mutex);
 	return;
 }
 
@@ -554,7 +636,46 @@ static void _handle_connection(int fd, slurm_addr_t *cli)
 	fd_set_close_on_exec(fd);
 
 	_increment_thd_count();
-	slurm_thread_create_detached(NULL, _service_connection, arg);
+
+	slurm_mutex_lock(&worker_mutex);
+	if (!conn_queue)
+		conn_queue = list_create(NULL);
+	list_enqueue(conn_queue, arg);
+	if (list_count(conn_queue) > idle_workers)
+		slurm_thread_create_detached(NULL, _connection_worker, NULL);
+	else
+		slurm_cond_signal(&worker_cond);
+	slurm_mutex_unlock(&worker_mutex);
+}
+
+/* Service queued connections, exit once idle for WORKER_IDLE_TIME */
+static void *_connection_worker(void *arg)
+{
+	conn_t *con;
+	struct timespec ts = {0, 0};
+	int rc;
+
+	while (1) {
+		slurm_mutex_lock(&worker_mutex);
+		while (!(con = list_dequeue(conn_queue))) {
+			if (_shutdown)
+				break;
+			ts.tv_sec = time(NULL) + WORKER_IDLE_TIME;
+			idle_workers++;
+			rc = pthread_cond_timedwait(&worker_cond,
+						    &worker_mutex, &ts);
+			idle_workers--;
+			if ((rc == ETIMEDOUT) && list_is_empty(conn_queue))
+				break;
+		}
+		slurm_mutex_unlock(&worker_mutex);
+
+		if (!con)
+			break;
+		_service_connection(con);
+	}
+
+	return NULL;
 }
 
 static void *
@@ -682,8 +803,7 @@ send_registration_msg(uint32_t status, bool startup)
 		req.msg_type = MESSAGE_NODE_REGISTRATION_STATUS;
 		req.data     = msg;
 
-		ret_val = slurm_send_recv_controller_msg(&req, &resp_msg,
-							 working_cluster_rec);
+		ret_val = ctld_conn_send_recv_msg(&req, &resp_msg);
 		slurm_free_node_registration_status_msg(msg);
 
 		if (ret_val < 0) {
@@ -1121,6 +1241,7 @@ _reconfigure(void)
 
 	msg_aggr_sender_reconfig(conf->msg_aggr_window_time,
 				 conf->msg_aggr_window_msgs);
+	ctld_conn_fini();	/* reopen with the new configuration */
 
 	/*
 	 * In case the administrator changed the cpu frequency set capabilities
@@ -1169,6 +1290,9 @@ _reconfigure(void)
 
 	_build_conf_buf();
 
+	/* idle slurmstepd have read the old slurm.conf */
+	stepd_pool_init();
+
 	send_registration_msg(SLURM_SUCCESS, false);
 
 	acct_gather_reconfig();
@@ -1906,6 +2030,7 @@ cleanup:
 static int
 _slurmd_fini(void)
 {
+	ctld_conn_fini();
 	assoc_mgr_fini(false);
 	node_features_g_fini();
 	core_spec_g_fini();
@@ -56,6 +56,7 @@
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <termios.h>
 #include <unistd.h>
 
@@ -94,6 +95,7 @@ struct io_operations client_ops = {
 };
 
 #define CLIENT_IO_MAGIC 0x10102
+#define CLIENT_WRITE_IOV_MAX 64	/* messages sent per writev() to a client */
 struct client_io_info {
 	int                   magic;
 	stepd_step_rec_t    *job;		 /* pointer back to job data   */
@@ -422,13 +424,20 @@ _client_read(eio_obj_t *obj, List objs)
 
 /*
  * Write outgoing packed messages to the client socket.
+ *
+ * Everything queued (up to CLIENT_WRITE_IOV_MAX messages) is handed to a
+ * single writev(), so tasks writing lots of small chunks don't cost a
+ * poll() and a write() per message.
  */
 static int
 _client_write(eio_obj_t *obj, List objs)
 {
 	struct client_io_info *client = (struct client_io_info *) obj->arg;
-	void *buf;
-	int n;
+	struct iovec iov[CLIENT_WRITE_IOV_MAX];
+	struct io_buf *msg;
+	ListIterator itr;
+	ssize_t n;
+	int cnt = 0;
 
 	xassert(client->magic == CLIENT_IO_MAGIC);
 
@@ -452,12 +461,26 @@ _client_write(eio_obj_t *obj, List objs)
 	debug5("  client->out_remaining = %d", client->out_remaining);
 
 	/*
-	 * Write message to socket.
+	 * Rest of the current message first, then whatever else is queued.
+	 * Queued messages stay in the queue until they are fully written.
 	 */
-	buf = client->out_msg->data +
+	iov[cnt].iov_base = client->out_msg->data +
 		(client->out_msg->length - client->out_remaining);
+	iov[cnt].iov_len = client->out_remaining;
+	cnt++;
+	itr = list_iterator_create(client->msg_queue);
+	while ((cnt < CLIENT_WRITE_IOV_MAX) && (msg = list_next(itr))) {
+		iov[cnt].iov_base = msg->data;
+		iov[cnt].iov_len = msg->length;
+		cnt++;
+	}
+	list_iterator_destroy(itr);
+
+	/*
+	 * Write messages to socket.
+	 */
 again:
-	if ((n = write(obj->fd, buf, client->out_remaining)) < 0) {
+	if ((n = writev(obj->fd, iov, cnt)) < 0) {
 		if (errno == EINTR) {
 			goto again;
 		} else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
@@ -469,18 +492,29 @@ again:
 			return SLURM_SUCCESS;
 		}
 	}
+	debug5("Wrote %zd bytes in %d messages to socket", n, cnt);
+
 	if (n < client->out_remaining) {
-		error("Only wrote %d of %d bytes to socket",
-		      n, client->out_remaining);
-	} else
-		debug5("Wrote %d bytes to socket", n);
-	client->out_remaining -= n;
-	if (client->out_remaining > 0)
+		client->out_remaining -= n;
 		return SLURM_SUCCESS;
-
+	}
+	n -= client->out_remaining;
 	_free_outgoing_msg(client->out_msg, client->job);
 	client->out_msg = NULL;
 
+	/* Release the queued messages that went out, keep a partial one */
+	while (n > 0) {
+		msg = list_dequeue(client->msg_queue);
+		xassert(msg);
+		if (n < msg->length) {
+			client->out_msg = msg;
+			client->out_remaining = msg->length - n;
+			break;
+		}
+		n -= msg->length;
+		_free_outgoing_msg(msg, client->job);
+	}
+
 	return SLURM_SUCCESS;
 }
 
@@ -1543,53 +1543,64 @@ static int exec_wait_signal_child (struct exec_wait_info *e)
 	return (0);
 }
 
-static int exec_wait_signal (struct exec_wait_info *e, stepd_step_rec_t *job)
+/*
+ *  Fork a child which will wait on the shared exec_wait_info 'e'.
+ *   All tasks of a step block on the same pipe, so they can be released
+ *   with a single write rather than one pipe and write per task.
+ */
+static pid_t _fork_child_with_shared_wait (struct exec_wait_info *e)
 {
-	debug3 ("Unblocking %u.%u task %d, writefd = %d",
-		job->jobid, job->stepid, e->id, e->parentfd);
-	exec_wait_signal_child (e);
-	return (0);
+	pid_t pid;
+
+	if ((pid = fork ()) == 0) {
+		close (e->parentfd);
+		e->parentfd = -1;
+	}
+	return (pid);
 }
 
 /*
- *  Send SIGKILL to child in exec_wait_info 'e'
- *  Returns 0 for success, -1 for failure.
+ *  Release 'count' children waiting on the shared exec_wait_info 'e',
+ *   each of them consumes one byte. Closing the pipe without writing
+ *   makes the children exit instead.
  */
-static int exec_wait_kill_child (struct exec_wait_info *e)
+static int exec_wait_release_children (struct exec_wait_info *e, int count)
 {
-	if (e->pid < 0)
-		return (-1);
-	if (kill (e->pid, SIGKILL) < 0)
-		return (-1);
-	e->pid = -1;
+	char buf[1024];
+	int len;
+
+	memset (buf, 0, sizeof (buf));
+	while (count > 0) {
+		len = MIN (count, sizeof (buf));
+		if ((len = write (e->parentfd, buf, len)) < 0) {
+			if (errno == EINTR)
+				continue;
+			return error ("write to unblock %d tasks failed: %m",
+				      count);
+		}
+		count -= len;
+	}
+
 	return (0);
 }
 
 /*
- *  Send all children in exec_wait_list SIGKILL.
- *  Returns 0 for success or  < 0 on failure.
+ *  Send SIGKILL to the first 'count' tasks of the step.
  */
-static int exec_wait_kill_children (List exec_wait_list)
+static void _kill_forked_tasks (stepd_step_rec_t *job, int count)
 {
-	int rc = 0;
-	int count;
-	struct exec_wait_info *e;
-	ListIterator i;
+	int i;
 
-	if ((count = list_count (exec_wait_list)) == 0)
-		return (0);
+	if (count == 0)
+		return;
 
 	verbose ("Killing %d remaining child%s",
 		 count, (count > 1 ? "ren" : ""));
 
-	i = list_iterator_create (exec_wait_list);
-	if (i == NULL)
-		return error ("exec_wait_kill_children: iterator_create: %m");
-
-	while ((e = list_next (i)))
-		rc += exec_wait_kill_child (e);
-	list_iterator_destroy (i);
-	return (rc);
+	for (i = 0; i < count; i++) {
+		if (job->task[i]->pid > 0)
+			kill (job->task[i]->pid, SIGKILL);
+	}
 }
 
 static void prepare_stdio (stepd_step_rec_t *job, stepd_step_task_info_t *task)
@@ -1632,7 +1643,7 @@ _fork_all_tasks(stepd_step_rec_t *job, bool *io_initialized)
 	struct priv_state sprivs;
 	jobacct_id_t jobacct_id;
 	char *oom_value;
-	List exec_wait_list = NULL;
+	struct exec_wait_info *exec_wait = NULL;
 	uint32_t jobid;
 
 	DEF_TIMERS;
@@ -1736,7 +1747,10 @@ _fork_all_tasks(stepd_step_rec_t *job, bool *io_initialized)
 		goto fail4;
 	}
 
-	exec_wait_list = list_create ((ListDelF) _exec_wait_info_destroy);
+	if (!(exec_wait = _exec_wait_info_create (-1))) {
+		rc = SLURM_ERROR;
+		goto fail4;
+	}
 
 	/*
 	 * Fork all of the task processes.
@@ -1745,23 +1759,14 @@ _fork_all_tasks(stepd_step_rec_t *job, bool *io_initialized)
 	for (i = 0; i < job->node_tasks; i++) {
 		char time_stamp[256];
 		pid_t pid;
-		struct exec_wait_info *ei;
 
 		acct_gather_profile_g_task_start(i);
-		if ((ei = _fork_child_with_wait_info (i)) == NULL) {
+		if ((pid = _fork_child_with_shared_wait (exec_wait)) < 0) {
 			error("child fork: %m");
-			exec_wait_kill_children (exec_wait_list);
+			_kill_forked_tasks (job, i);
 			rc = SLURM_ERROR;
 			goto fail4;
-		} else if ((pid = _exec_wait_get_pid (ei)) == 0)  { /* child */
-			/*
-			 *  Destroy exec_wait_list in the child.
-			 *   Only exec_wait_info for previous tasks have been
-			 *   added to the list so far, so everything else
-			 *   can be discarded.
-			 */
-			FREE_NULL_LIST (exec_wait_list);
-
+		} else if (pid == 0)  { /* child */
 			/* jobacctinfo_endpoll();
 			 * closing jobacct files here causes deadlock */
 
@@ -1806,7 +1811,7 @@ _fork_all_tasks(stepd_step_rec_t *job, bool *io_initialized)
 			 *   children in any process groups or containers
 			 *   before they make a call to exec(2).
 			 */
-			if (_exec_wait_child_wait_for_parent (ei) < 0)
+			if (_exec_wait_child_wait_for_parent (exec_wait) < 0)
 				exit (1);
 
 			exec_task(job, i);
@@ -1816,8 +1821,6 @@ _fork_all_tasks(stepd_step_rec_t *job, bool *io_initialized)
 		 * Parent continues:
 		 */
 
-		list_append (exec_wait_list, ei);
-
 		log_timestamp(time_stamp, sizeof(time_stamp));
 		verbose("task %lu (%lu) started %s",
 			(unsigned long) job->task[i]->gtid,
@@ -1913,8 +1916,11 @@ _fork_all_tasks(stepd_step_rec_t *job, bool *io_initialized)
 	/*
 	 * Now it's ok to unblock the tasks, so they may call exec.
 	 */
-	list_for_each (exec_wait_list, (ListForF) exec_wait_signal, job);
-	FREE_NULL_LIST (exec_wait_list);
+	debug3("Unblocking %u.%u tasks, writefd = %d",
+	       job->jobid, job->stepid, exec_wait->parentfd);
+	exec_wait_release_children (exec_wait, job->node_tasks);
+	_exec_wait_info_destroy (exec_wait);
+	exec_wait = NULL;
 
 	for (i = 0; i < job->node_tasks; i++) {
 		/*
@@ -1937,7 +1943,7 @@ fail4:
 fail3:
 	_reclaim_privileges (&sprivs);
 fail2:
-	FREE_NULL_LIST(exec_wait_list);
+	_exec_wait_info_destroy (exec_wait);
 	io_close_task_fds(job);
 fail1:
 	pam_finish();
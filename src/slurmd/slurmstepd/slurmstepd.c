@@ -40,6 +40,7 @@
 
 #include "config.h"
 
+#include <poll.h>
 #include <signal.h>
 #include <stdlib.h>
 #include <sys/mman.h>
@@ -75,6 +76,7 @@
 #include "src/slurmd/slurmstepd/slurmstepd.h"
 #include "src/slurmd/slurmstepd/slurmstepd_job.h"
 
+static int _wait_for_slurmd(int sock);
 static int _init_from_slurmd(int sock, char **argv, slurm_addr_t **_cli,
 			     slurm_addr_t **_self, slurm_msg_t **_msg);
 
@@ -130,6 +132,13 @@ main (int argc, char **argv)
 	if (slurm_auth_init(NULL) != SLURM_SUCCESS)
 		fatal( "failed to initialize authentication plugin" );
 
+	/*
+	 * A pooled slurmstepd may sit here for a long time, and is released
+	 * without a job by slurmd closing the pipe.
+	 */
+	if (_wait_for_slurmd(STDIN_FILENO) != SLURM_SUCCESS)
+		return 0;
+
 	/* Receive job parameters from the slurmd */
 	_init_from_slurmd(STDIN_FILENO, argv, &cli, &self, &msg);
 
@@ -498,6 +507,24 @@ static void _set_job_log_prefix(uint32_t jobid, uint32_t stepid)
 	log_set_fpfx(&buf);
 }
 
+/*
+ * Wait for slurmd to start sending the initialization data.
+ * RET SLURM_ERROR if slurmd closed the pipe without sending anything.
+ */
+static int _wait_for_slurmd(int sock)
+{
+	struct pollfd pfd = { .fd = sock, .events = POLLIN };
+
+	while (poll(&pfd, 1, -1) < 0) {
+		if (errno != EINTR)
+			return SLURM_ERROR;
+	}
+	if (!(pfd.revents & POLLIN))
+		return SLURM_ERROR;
+
+	return SLURM_SUCCESS;
+}
+
 /*
  *  This function handles the initialization information from slurmd
  *  sent by _send_slurmstepd_init() in src/slurmd/slurmd/req.c.
@@ -394,7 +394,7 @@ extern stepd_step_rec_t *stepd_step_rec_create(launch_tasks_request_msg_t *msg,
 			job->array_task_id = atoi(msg->env[i] + 20);
 	}
 
-	job->eio     = eio_handle_create(0);
+	job->eio     = eio_handle_create_epoll(0);
 	job->sruns   = list_create((ListDelF) _srun_info_destructor);
 
 	/*
@@ -582,7 +582,7 @@ batch_stepd_step_rec_create(batch_job_launch_msg_t *msg)
 	job->cwd     = xstrdup(msg->work_dir);
 
 	job->env     = _array_copy(msg->envc, msg->environment);
-	job->eio     = eio_handle_create(0);
+	job->eio     = eio_handle_create_epoll(0);
 	job->sruns   = list_create((ListDelF) _srun_info_destructor);
 	job->envtp   = xmalloc(sizeof(env_t));
 	job->envtp->jobid = -1;
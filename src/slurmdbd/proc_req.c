@@ -1427,12 +1427,147 @@ static int _get_events(slurmdbd_conn_t *slurmdbd_conn,
 	return rc;
 }
 
+/*
+ * Replies to DBD_GET_JOBS_COND kept for JobQueryCacheTime seconds, so the same
+ * query from the same user (e.g. many dashboards polling alike) is answered
+ * without going to the database again. Oldest entries are first.
+ */
+#define JOB_QUERY_CACHE_MAX_SIZE (256 * 1024 * 1024)
+
+typedef struct {
+	char *key;		/* packed slurmdb_job_cond_t */
+	uint32_t key_len;
+	char *reply;		/* packed DBD_GOT_JOBS message */
+	uint32_t reply_len;
+	time_t time;
+	uint32_t uid;
+	uint16_t version;
+} job_query_cache_t;
+
+static List job_query_cache = NULL;
+static uint64_t job_query_cache_size = 0;
+static pthread_mutex_t job_query_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void _job_query_cache_free(void *x)
+{
+	job_query_cache_t *entry = x;
+
+	if (entry) {
+		job_query_cache_size -= entry->key_len + entry->reply_len;
+		xfree(entry->key);
+		xfree(entry->reply);
+		xfree(entry);
+	}
+}
+
+static int _job_query_cache_match(void *x, void *key)
+{
+	job_query_cache_t *entry = x, *want = key;
+
+	return ((entry->uid == want->uid) &&
+		(entry->version == want->version) &&
+		(entry->key_len == want->key_len) &&
+		!memcmp(entry->key, want->key, want->key_len));
+}
+
+/* NOTE: Ensure that job_query_cache_lock is set on function entry */
+static void _job_query_cache_expire(time_t now)
+{
+	job_query_cache_t *entry;
+
+	while ((entry = list_peek(job_query_cache)) &&
+	       (((now - entry->time) >= slurmdbd_conf->job_query_cache_time) ||
+		(job_query_cache_size > JOB_QUERY_CACHE_MAX_SIZE)))
+		_job_query_cache_free(list_pop(job_query_cache));
+}
+
+/* Return a copy of the cached reply matching want, or NULL */
+static Buf _job_query_cache_get(job_query_cache_t *want)
+{
+	job_query_cache_t *entry;
+	Buf buffer = NULL;
+
+	slurm_mutex_lock(&job_query_cache_lock);
+	if (job_query_cache) {
+		_job_query_cache_expire(time(NULL));
+		if ((entry = list_find_first(job_query_cache,
+					     _job_query_cache_match, want))) {
+			char *data = xmalloc_nz(entry->reply_len);
+			memcpy(data, entry->reply, entry->reply_len);
+			buffer = create_buf(data, entry->reply_len);
+			set_buf_offset(buffer, entry->reply_len);
+		}
+	}
+	slurm_mutex_unlock(&job_query_cache_lock);
+
+	return buffer;
+}
+
+/* Keep a copy of reply, taking over want->key */
+static void _job_query_cache_add(job_query_cache_t *want, Buf reply)
+{
+	job_query_cache_t *entry;
+	uint32_t reply_len = get_buf_offset(reply);
+
+	if ((want->key_len + reply_len) > JOB_QUERY_CACHE_MAX_SIZE) {
+		xfree(want->key);
+		return;
+	}
+
+	entry = xmalloc(sizeof(job_query_cache_t));
+	*entry = *want;
+	want->key = NULL;
+	entry->reply_len = reply_len;
+	entry->reply = xmalloc_nz(reply_len);
+	memcpy(entry->reply, get_buf_data(reply), reply_len);
+	entry->time = time(NULL);
+
+	slurm_mutex_lock(&job_query_cache_lock);
+	if (!job_query_cache)
+		job_query_cache = list_create(_job_query_cache_free);
+	list_append(job_query_cache, entry);
+	job_query_cache_size += entry->key_len + entry->reply_len;
+	_job_query_cache_expire(entry->time);
+	slurm_mutex_unlock(&job_query_cache_lock);
+}
+
+/*
+ * Pack a DBD_GOT_JOBS list message the way slurmdbd_pack_list_msg() does,
+ * but free each job record as soon as it is packed. A month of jobs can take
+ * gigabytes both as records and packed, this avoids holding both at once.
+ */
+static void _pack_jobs_list_msg(dbd_list_msg_t *msg, uint16_t rpc_version,
+				Buf buffer)
+{
+	ListIterator itr;
+	slurmdb_job_rec_t *job;
+	uint32_t count_offset = get_buf_offset(buffer);
+
+	pack32(list_count(msg->my_list), buffer);
+	itr = list_iterator_create(msg->my_list);
+	while ((job = list_next(itr))) {
+		slurmdb_pack_job_rec(job, rpc_version, buffer);
+		list_delete_item(itr);
+		if (size_buf(buffer) > REASONABLE_BUF_SIZE) {
+			error("%s: size limit exceeded", __func__);
+			set_buf_offset(buffer, count_offset);
+			pack32(NO_VAL, buffer);
+			msg->return_code = ESLURM_RESULT_TOO_LARGE;
+			break;
+		}
+	}
+	list_iterator_destroy(itr);
+
+	pack32(msg->return_code, buffer);
+}
+
 static int _get_jobs_cond(slurmdbd_conn_t *slurmdbd_conn,
 			  persist_msg_t *msg, Buf *out_buffer, uint32_t *uid)
 {
 	dbd_cond_msg_t *cond_msg = msg->data;
 	dbd_list_msg_t list_msg = { NULL };
 	slurmdb_job_cond_t *job_cond = cond_msg->cond;
+	job_query_cache_t cache_key = { NULL };
 	int rc = SLURM_SUCCESS;
 
 	debug2("DBD_GET_JOBS_COND: called");
@@ -1471,6 +1606,22 @@ static int _get_jobs_cond(slurmdbd_conn_t *slurmdbd_conn,
 		}
 	}
 
+	if (slurmdbd_conf->job_query_cache_time) {
+		Buf key_buf = init_buf(1024);
+
+		slurmdb_pack_job_cond(job_cond, slurmdbd_conn->conn->version,
+				      key_buf);
+		cache_key.key_len = get_buf_offset(key_buf);
+		cache_key.key = xfer_buf_data(key_buf);
+		cache_key.uid = *uid;
+		cache_key.version = slurmdbd_conn->conn->version;
+		if ((*out_buffer = _job_query_cache_get(&cache_key))) {
+			debug2("DBD_GET_JOBS_COND: reply from cache");
+			xfree(cache_key.key);
+			return rc;
+		}
+	}
+
 	list_msg.my_list = jobacct_storage_g_get_jobs_cond(
 		slurmdbd_conn->db_conn, *uid, job_cond);
 
@@ -1479,8 +1630,11 @@ static int _get_jobs_cond(slurmdbd_conn_t *slurmdbd_conn,
 			list_msg.my_list = list_create(NULL);
 		*out_buffer = init_buf(1024);
 		pack16((uint16_t) DBD_GOT_JOBS, *out_buffer);
-		slurmdbd_pack_list_msg(&list_msg, slurmdbd_conn->conn->version,
-				       DBD_GOT_JOBS, *out_buffer);
+		_pack_jobs_list_msg(&list_msg, slurmdbd_conn->conn->version,
+				    *out_buffer);
+		if (cache_key.key &&
+		    (list_msg.return_code == SLURM_SUCCESS))
+			_job_query_cache_add(&cache_key, *out_buffer);
 	} else {
 		*out_buffer = slurm_persist_make_rc_msg(slurmdbd_conn->conn,
 							errno,
@@ -1490,6 +1644,7 @@ static int _get_jobs_cond(slurmdbd_conn_t *slurmdbd_conn,
 	}
 
 	FREE_NULL_LIST(list_msg.my_list);
+	xfree(cache_key.key);
 
 	return rc;
 }
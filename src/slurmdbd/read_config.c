@@ -99,6 +99,8 @@ static void _clear_slurmdbd_conf(void)
 		xfree(slurmdbd_conf->log_file);
 		slurmdbd_conf->syslog_debug = LOG_LEVEL_END;
 		xfree(slurmdbd_conf->parameters);
+		slurmdbd_conf->job_query_cache_time = 0;
+		slurmdbd_conf->archive_compress = false;
 		xfree(slurmdbd_conf->pid_file);
 		slurmdbd_conf->private_data = 0;
 		slurmdbd_conf->purge_event = 0;
@@ -112,6 +114,8 @@ static void _clear_slurmdbd_conf(void)
 		xfree(slurmdbd_conf->storage_host);
 		xfree(slurmdbd_conf->storage_loc);
 		xfree(slurmdbd_conf->storage_pass);
+		xfree(slurmdbd_conf->storage_replica_host);
+		slurmdbd_conf->storage_replica_max_lag = 0;
 		xfree(slurmdbd_conf->storage_user);
 		slurmdbd_conf->track_wckey = 0;
 		slurmdbd_conf->track_ctld = 0;
@@ -177,6 +181,8 @@ extern int read_slurmdbd_conf(void)
 		{"StorageLoc", S_P_STRING},
 		{"StoragePass", S_P_STRING},
 		{"StoragePort", S_P_UINT16},
+		{"StorageReplicaHost", S_P_STRING},
+		{"StorageReplicaMaxLag", S_P_UINT32},
 		{"StorageType", S_P_STRING},
 		{"StorageUser", S_P_STRING},
 		{"TCPTimeout", S_P_UINT16},
@@ -186,6 +192,7 @@ extern int read_slurmdbd_conf(void)
 	s_p_hashtbl_t *tbl = NULL;
 	char *conf_path = NULL;
 	char *temp_str = NULL;
+	char *tmp_ptr;
 	struct stat buf;
 
 	/* Set initial values */
@@ -315,10 +322,17 @@ extern int read_slurmdbd_conf(void)
 
 		s_p_get_string(&slurmdbd_conf->parameters, "Parameters", tbl);
 		if (slurmdbd_conf->parameters) {
+			if (xstrcasestr(slurmdbd_conf->parameters,
+					"ArchiveCompress"))
+				slurmdbd_conf->archive_compress = true;
 			if (xstrcasestr(slurmdbd_conf->parameters,
 					"PreserveCaseUser"))
 				slurmdbd_conf->persist_conn_rc_flags |=
 					PERSIST_FLAG_P_USER_CASE;
+			if ((tmp_ptr = xstrcasestr(slurmdbd_conf->parameters,
+						   "JobQueryCacheTime=")))
+				slurmdbd_conf->job_query_cache_time =
+					atoi(tmp_ptr + 18);
 		}
 
 		s_p_get_string(&slurmdbd_conf->pid_file, "PidFile", tbl);
@@ -507,6 +521,12 @@ extern int read_slurmdbd_conf(void)
 			       "StoragePass", tbl);
 		s_p_get_uint16(&slurm_conf.accounting_storage_port,
 		               "StoragePort", tbl);
+		s_p_get_string(&slurmdbd_conf->storage_replica_host,
+			       "StorageReplicaHost", tbl);
+		if (!s_p_get_uint32(&slurmdbd_conf->storage_replica_max_lag,
+				    "StorageReplicaMaxLag", tbl))
+			slurmdbd_conf->storage_replica_max_lag =
+				DEFAULT_SLURMDBD_REPLICA_MAX_LAG;
 		s_p_get_string(&slurm_conf.accounting_storage_type,
 		               "StorageType", tbl);
 		s_p_get_string(&slurmdbd_conf->storage_user,
@@ -713,6 +733,9 @@ extern void log_config(void)
 	debug2("StorageLoc        = %s", slurmdbd_conf->storage_loc);
 	/* debug2("StoragePass       = %s", slurmdbd_conf->storage_pass); */
 	debug2("StoragePort       = %u", slurm_conf.accounting_storage_port);
+	debug2("StorageReplicaHost = %s", slurmdbd_conf->storage_replica_host);
+	debug2("StorageReplicaMaxLag = %u",
+	       slurmdbd_conf->storage_replica_max_lag);
 	debug2("StorageType       = %s", slurm_conf.accounting_storage_type);
 	debug2("StorageUser       = %s", slurmdbd_conf->storage_user);
 
@@ -1004,6 +1027,17 @@ extern List dump_config(void)
 	                                 slurm_conf.accounting_storage_port);
 	list_append(my_list, key_pair);
 
+	key_pair = xmalloc(sizeof(config_key_pair_t));
+	key_pair->name = xstrdup("StorageReplicaHost");
+	key_pair->value = xstrdup(slurmdbd_conf->storage_replica_host);
+	list_append(my_list, key_pair);
+
+	key_pair = xmalloc(sizeof(config_key_pair_t));
+	key_pair->name = xstrdup("StorageReplicaMaxLag");
+	key_pair->value = xstrdup_printf("%u sec",
+					 slurmdbd_conf->storage_replica_max_lag);
+	list_append(my_list, key_pair);
+
 	key_pair = xmalloc(sizeof(config_key_pair_t));
 	key_pair->name = xstrdup("StorageType");
 	key_pair->value = xstrdup(slurm_conf.accounting_storage_type);
@@ -51,9 +51,11 @@
 #define DEFAULT_SLURMDBD_PIDFILE	"/var/run/slurmdbd.pid"
 #define DEFAULT_SLURMDBD_ARCHIVE_DIR	"/tmp"
 //#define DEFAULT_SLURMDBD_STEP_PURGE	1
+#define DEFAULT_SLURMDBD_REPLICA_MAX_LAG	30
 
 /* SlurmDBD configuration parameters */
 typedef struct {
+	bool		archive_compress; /* gzip archive files		*/
 	char *		archive_dir;    /* location to locally store
 					 * data if not using a script   */
 	char *		archive_script;	/* script to archive old data	*/
@@ -67,6 +69,8 @@ typedef struct {
 	uint16_t	debug_level;	/* Debug level, default=3	*/
 	char *	 	default_qos;	/* default qos setting when
 					 * adding clusters              */
+	uint16_t	job_query_cache_time; /* seconds to reuse job query
+					       * replies, 0 to disable */
 	char *		log_file;	/* Log file			*/
 	uint32_t	max_time_range;	/* max time range for user queries */
 	char *		parameters;	/* parameters to change behavior with
@@ -94,6 +98,10 @@ typedef struct {
 	char *		storage_host;	/* host where DB is running	*/
 	char *		storage_loc;	/* database name		*/
 	char *		storage_pass;   /* password for DB write	*/
+	char *		storage_replica_host; /* read-only replicas for
+					       * query RPCs */
+	uint32_t	storage_replica_max_lag; /* seconds a replica may
+						  * lag behind the primary */
 	char *		storage_user;	/* user authorized to write DB	*/
 	uint16_t	syslog_debug;	/* output to both logfile and syslog*/
 	uint16_t        track_wckey;    /* Whether or not to track wckey*/
@@ -62,7 +62,7 @@
 
 #include "src/slurmrestd/conmgr.h"
 #include "src/slurmrestd/http.h"
-#include "src/slurmrestd/workq.h"
+#include "src/common/workq.h"
 
 #define MAGIC_CON_MGR_FD 0xD23444EF
 #define MAGIC_CON_MGR 0xD232444A
@@ -1191,6 +1191,7 @@ static inline void _poll(con_mgr_t *mgr, poll_args_t *args, List fds,
 	int rc = SLURM_SUCCESS;
 	struct pollfd *fds_ptr = NULL;
 	con_mgr_fd_t *con;
+	bool changed = false;
 
 	rc = poll(args->fds, args->nfds, -1);
 	if (rc == -1)
@@ -1204,10 +1205,12 @@ static inline void _poll(con_mgr_t *mgr, poll_args_t *args, List fds,
 		return;
 	}
 
+	/* rc is the number of fds with events: stop once all are seen */
 	fds_ptr = args->fds;
-	for (int i = 0; i < args->nfds; i++, fds_ptr++) {
+	for (int i = 0; (rc > 0) && (i < args->nfds); i++, fds_ptr++) {
 		if (!fds_ptr->revents)
 			continue;
+		rc--;
 
 		if (fds_ptr->fd == mgr->sigint_fd[0]) {
 			if (!mgr->shutdown)
@@ -1230,16 +1233,19 @@ static inline void _poll(con_mgr_t *mgr, poll_args_t *args, List fds,
 				xfree(flags);
 			}
 			on_poll(mgr, fds_ptr->fd, con, fds_ptr->revents);
-			/*
-			 * signal that something might have happened and to
-			 * restart listening
-			 * */
-			_signal_change(mgr, true);
+			changed = true;
 		} else
 			/* FD probably got closed between poll start and now */
 			log_flag(NET, "%s: [%s] unable to find connection for fd=%u",
 				 __func__, tag, fds_ptr->fd);
 	}
+
+	/*
+	 * signal (once for all events) that something might have happened
+	 * and to restart listening
+	 */
+	if (changed)
+		_signal_change(mgr, true);
 }
 
 /*
@@ -42,7 +42,7 @@
 #include "src/common/list.h"
 #include "src/common/pack.h"
 
-#include "src/slurmrestd/workq.h"
+#include "src/common/workq.h"
 
 /*
  * connection manager will do the follow:
@@ -153,6 +153,7 @@ typedef struct {
 
 typedef struct {
 	entry_t *entries;
+	int entry_count; /* number of entries (excluding terminator) */
 	http_request_method_t method;
 } entry_method_t;
 
@@ -326,6 +327,7 @@ static data_for_each_cmd_t _populate_methods(const char *key,
 
 	xassert(!method->entries);
 	method->entries = xcalloc((count + 1), sizeof(entry_t));
+	method->entry_count = count;
 	/* count is already bounded */
 	memcpy(method->entries, args->entries, (count * sizeof(entry_t)));
 
@@ -424,6 +426,7 @@ extern void unregister_path_tag(int tag)
 typedef struct {
 	bool matched;
 	const data_t *dpath;
+	size_t dpath_count; /* number of components in dpath */
 	path_t *path;
 	data_t *params;
 	http_request_method_t method;
@@ -539,6 +542,10 @@ static int _match_path_from_data(void *x, void *key)
 
 	args->path = path;
 	for (method = path->methods; method->entries; method++) {
+		/* cheap reject before comparing each component */
+		if (method->entry_count != args->dpath_count)
+			continue;
+
 		args->entry = method->entries;
 		data_list_for_each_const(args->dpath, _match_path, args);
 
@@ -571,6 +578,8 @@ extern int find_path_tag(const data_t *dpath, data_t *params,
 	int tag = -1;
 
 	xassert(data_get_type(params) == DATA_TYPE_DICT);
+	args.dpath_count = data_get_list_length(dpath);
+
 	slurm_rwlock_rdlock(&paths_lock);
 
 	path = list_find_first(paths, _match_path_from_data, &args);
@@ -43,6 +43,8 @@
 #include "src/common/list.h"
 #include "src/common/log.h"
 #include "src/common/read_config.h"
+#include "src/common/slurm_protocol_defs.h"
+#include "src/common/uid.h"
 #include "src/common/xassert.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
@@ -58,6 +60,59 @@ typedef enum {
 	URL_TAG_PING,
 } url_tag_t;
 
+static void _dump_rpc_stats(stats_info_response_msg_t *resp, data_t *d)
+{
+	data_t *rpcs = data_set_list(data_key_set(d, "rpcs_by_message_type"));
+	data_t *users = data_set_list(data_key_set(d, "rpcs_by_user"));
+	data_t *pending = data_set_list(data_key_set(d, "pending_rpcs"));
+
+	for (uint32_t i = 0; i < resp->rpc_type_size; i++) {
+		data_t *r = data_set_dict(data_list_append(rpcs));
+
+		data_set_string(data_key_set(r, "message_type"),
+				rpc_num2string(resp->rpc_type_id[i]));
+		data_set_int(data_key_set(r, "type_id"), resp->rpc_type_id[i]);
+		data_set_int(data_key_set(r, "count"), resp->rpc_type_cnt[i]);
+		data_set_int(data_key_set(r, "average_time"),
+			     (resp->rpc_type_cnt[i] ?
+			      (resp->rpc_type_time[i] /
+			       resp->rpc_type_cnt[i]) : 0));
+		if (resp->rpc_type_max)
+			data_set_int(data_key_set(r, "max_time"),
+				     resp->rpc_type_max[i]);
+		data_set_int(data_key_set(r, "total_time"),
+			     resp->rpc_type_time[i]);
+	}
+
+	for (uint32_t i = 0; i < resp->rpc_user_size; i++) {
+		data_t *u = data_set_dict(data_list_append(users));
+		char *user = uid_to_string_or_null(resp->rpc_user_id[i]);
+
+		if (user)
+			data_set_string(data_key_set(u, "user"), user);
+		data_set_int(data_key_set(u, "user_id"), resp->rpc_user_id[i]);
+		data_set_int(data_key_set(u, "count"), resp->rpc_user_cnt[i]);
+		data_set_int(data_key_set(u, "average_time"),
+			     (resp->rpc_user_cnt[i] ?
+			      (resp->rpc_user_time[i] /
+			       resp->rpc_user_cnt[i]) : 0));
+		data_set_int(data_key_set(u, "total_time"),
+			     resp->rpc_user_time[i]);
+		xfree(user);
+	}
+
+	for (uint32_t i = 0; i < resp->rpc_queue_type_count; i++) {
+		data_t *q = data_set_dict(data_list_append(pending));
+
+		data_set_string(data_key_set(q, "message_type"),
+				rpc_num2string(resp->rpc_queue_type_id[i]));
+		data_set_int(data_key_set(q, "type_id"),
+			     resp->rpc_queue_type_id[i]);
+		data_set_int(data_key_set(q, "count"),
+			     resp->rpc_queue_count[i]);
+	}
+}
+
 static int _op_handler_diag(const char *context_id,
 			    http_request_method_t method, data_t *parameters,
 			    data_t *query, int tag, data_t *resp_ptr)
@@ -83,6 +138,8 @@ static int _op_handler_diag(const char *context_id,
 	data_set_int(data_key_set(d, "agent_queue_size"),
 		     resp->agent_queue_size);
 	data_set_int(data_key_set(d, "agent_count"), resp->agent_count);
+	data_set_int(data_key_set(d, "agent_thread_count"),
+		     resp->agent_thread_count);
 	data_set_int(data_key_set(d, "dbd_agent_queue_size"),
 		     resp->dbd_agent_queue_size);
 	data_set_int(data_key_set(d, "gettimeofday_latency"),
@@ -127,9 +184,13 @@ static int _op_handler_diag(const char *context_id,
 	data_set_int(data_key_set(d, "bf_queue_len"), resp->bf_queue_len);
 	data_set_int(data_key_set(d, "bf_queue_len_sum"),
 		     resp->bf_queue_len_sum);
+	data_set_int(data_key_set(d, "bf_table_size"), resp->bf_table_size);
+	data_set_int(data_key_set(d, "bf_table_size_sum"),
+		     resp->bf_table_size_sum);
 	data_set_int(data_key_set(d, "bf_when_last_cycle"),
 		     resp->bf_when_last_cycle);
 	data_set_int(data_key_set(d, "bf_active"), resp->bf_active);
+	_dump_rpc_stats(resp, d);
 
 cleanup:
 	if (rc) {
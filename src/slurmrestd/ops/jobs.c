@@ -66,6 +66,7 @@
 #include "src/slurmrestd/operations.h"
 #include "src/slurmrestd/ops/jobs.h"
 #include "src/slurmrestd/ref.h"
+#include "src/slurmrestd/rest_auth.h"
 #include "src/slurmrestd/xjson.h"
 
 typedef struct {
@@ -74,6 +75,19 @@ typedef struct {
 	bool disabled;
 } params_t;
 
+/* drop cached job info of users that have not asked for it recently */
+#define JOB_CACHE_TIMEOUT 300
+
+/* last job info loaded from slurmctld for one user */
+typedef struct {
+	char *user_name;
+	job_info_msg_t *job_info_ptr;
+	time_t last_used;
+} job_cache_t;
+
+static pthread_mutex_t job_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static List job_cache = NULL;
+
 static struct hsearch_data hash_params = { 0 };
 /* track array of parameter names that have been forced to lower case */
 static char **lower_param_names = NULL;
@@ -1171,6 +1185,73 @@ static data_t *dump_job_info(slurm_job_info_t *job, data_t *jd)
 	return jd;
 }
 
+static void _job_cache_free(void *x)
+{
+	job_cache_t *cache = x;
+
+	xfree(cache->user_name);
+	slurm_free_job_info_msg(cache->job_info_ptr);
+	xfree(cache);
+}
+
+static int _find_job_cache(void *x, void *key)
+{
+	job_cache_t *cache = x;
+
+	return !xstrcmp(cache->user_name, key);
+}
+
+static int _purge_job_cache(void *x, void *key)
+{
+	job_cache_t *cache = x;
+	time_t *now = key;
+
+	return ((*now - cache->last_used) > JOB_CACHE_TIMEOUT);
+}
+
+/*
+ * Load job info for the user of this request. Job info is kept per user
+ * (since PrivateData may differ) and refreshed by passing the last update
+ * time to slurmctld, which only sends the full job list if it changed.
+ * Dashboards polling /jobs then cost the controller little between job
+ * state changes.
+ * NOTE: job_cache_lock must be held while job_info_pptr is used.
+ */
+static int _load_jobs_cached(job_info_msg_t **job_info_pptr)
+{
+	const char *user_name = rest_auth_context_get_user_name();
+	job_info_msg_t *new_job_ptr = NULL;
+	job_cache_t *cache;
+	time_t now = time(NULL), update_time = 0;
+	int rc;
+
+	(void) list_delete_all(job_cache, _purge_job_cache, &now);
+
+	if (!(cache = list_find_first(job_cache, _find_job_cache,
+				      (void *) user_name))) {
+		cache = xmalloc(sizeof(*cache));
+		cache->user_name = xstrdup(user_name);
+		list_append(job_cache, cache);
+	}
+	cache->last_used = now;
+
+	if (cache->job_info_ptr)
+		update_time = cache->job_info_ptr->last_update;
+
+	rc = slurm_load_jobs(update_time, &new_job_ptr, SHOW_ALL);
+	if (rc == SLURM_SUCCESS) {
+		slurm_free_job_info_msg(cache->job_info_ptr);
+		cache->job_info_ptr = new_job_ptr;
+	} else if (cache->job_info_ptr &&
+		   (slurm_get_errno() == SLURM_NO_CHANGE_IN_DATA)) {
+		rc = SLURM_SUCCESS;
+	}
+
+	*job_info_pptr = cache->job_info_ptr;
+
+	return rc;
+}
+
 static int _op_handler_jobs(const char *context_id,
 			    http_request_method_t method,
 			    data_t *parameters, data_t *query, int tag,
@@ -1182,15 +1263,15 @@ static int _op_handler_jobs(const char *context_id,
 	data_set_list(resp);
 	debug4("%s: jobs handler called by %s", __func__, context_id);
 
-	rc = slurm_load_jobs((time_t)NULL, &job_info_ptr, SHOW_ALL);
+	slurm_mutex_lock(&job_cache_lock);
+	rc = _load_jobs_cached(&job_info_ptr);
 
 	if (rc == SLURM_SUCCESS && job_info_ptr &&
 	    job_info_ptr->record_count)
 		for (size_t i = 0; i < job_info_ptr->record_count; ++i)
 			dump_job_info(job_info_ptr->job_array + i,
 				      data_list_append(resp));
-
-	slurm_free_job_info_msg(job_info_ptr);
+	slurm_mutex_unlock(&job_cache_lock);
 
 	return rc;
 }
@@ -1521,6 +1602,7 @@ extern int init_op_jobs(void)
 	int rc;
 
 	lower_param_names = xcalloc(sizeof(char *), param_count);
+	job_cache = list_create(_job_cache_free);
 
 	if (!(rc = hcreate_r(param_count, &hash_params))) {
 		error("%s: unable to create hash table: rc=%u %m",
@@ -1573,4 +1655,8 @@ extern void destroy_op_jobs(void)
 	unbind_operation_handler(_op_handler_submit_job);
 	unbind_operation_handler(_op_handler_job);
 	unbind_operation_handler(_op_handler_jobs);
+
+	slurm_mutex_lock(&job_cache_lock);
+	FREE_NULL_LIST(job_cache);
+	slurm_mutex_unlock(&job_cache_lock);
 }
@@ -45,6 +45,7 @@
 #include "slurm/slurm.h"
 
 #include "src/common/data.h"
+#include "src/common/list.h"
 #include "src/common/uid.h"
 #include "src/common/xassert.h"
 #include "src/common/xmalloc.h"
@@ -53,6 +54,7 @@
 #include "src/slurmrestd/openapi.h"
 #include "src/slurmrestd/operations.h"
 #include "src/slurmrestd/ref.h"
+#include "src/slurmrestd/rest_auth.h"
 #include "src/slurmrestd/xjson.h"
 
 typedef enum {
@@ -61,6 +63,19 @@ typedef enum {
 	URL_TAG_NODES,
 } url_tag_t;
 
+/* drop cached node info of users that have not asked for it recently */
+#define NODE_CACHE_TIMEOUT 300
+
+/* last node info loaded from slurmctld for one user */
+typedef struct {
+	char *user_name;
+	node_info_msg_t *node_info_ptr;
+	time_t last_used;
+} node_cache_t;
+
+static pthread_mutex_t node_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static List node_cache = NULL;
+
 static const char *_get_long_node_state(uint32_t state)
 {
 	switch (state) {
@@ -148,6 +163,71 @@ static int _dump_node(data_t *p, node_info_t *node)
 	return SLURM_SUCCESS;
 }
 
+static void _node_cache_free(void *x)
+{
+	node_cache_t *cache = x;
+
+	xfree(cache->user_name);
+	slurm_free_node_info_msg(cache->node_info_ptr);
+	xfree(cache);
+}
+
+static int _find_node_cache(void *x, void *key)
+{
+	node_cache_t *cache = x;
+
+	return !xstrcmp(cache->user_name, key);
+}
+
+static int _purge_node_cache(void *x, void *key)
+{
+	node_cache_t *cache = x;
+	time_t *now = key;
+
+	return ((*now - cache->last_used) > NODE_CACHE_TIMEOUT);
+}
+
+/*
+ * Load node info for the user of this request, refreshing it from
+ * slurmctld only if the node table changed since the last load, in the
+ * same way as job info is cached for /jobs.
+ * NOTE: node_cache_lock must be held while node_info_pptr is used.
+ */
+static int _load_nodes_cached(node_info_msg_t **node_info_pptr)
+{
+	const char *user_name = rest_auth_context_get_user_name();
+	node_info_msg_t *new_node_ptr = NULL;
+	node_cache_t *cache;
+	time_t now = time(NULL), update_time = 0;
+	int rc;
+
+	(void) list_delete_all(node_cache, _purge_node_cache, &now);
+
+	if (!(cache = list_find_first(node_cache, _find_node_cache,
+				      (void *) user_name))) {
+		cache = xmalloc(sizeof(*cache));
+		cache->user_name = xstrdup(user_name);
+		list_append(node_cache, cache);
+	}
+	cache->last_used = now;
+
+	if (cache->node_info_ptr)
+		update_time = cache->node_info_ptr->last_update;
+
+	rc = slurm_load_node(update_time, &new_node_ptr, SHOW_ALL);
+	if (rc == SLURM_SUCCESS) {
+		slurm_free_node_info_msg(cache->node_info_ptr);
+		cache->node_info_ptr = new_node_ptr;
+	} else if (cache->node_info_ptr &&
+		   (slurm_get_errno() == SLURM_NO_CHANGE_IN_DATA)) {
+		rc = SLURM_SUCCESS;
+	}
+
+	*node_info_pptr = cache->node_info_ptr;
+
+	return rc;
+}
+
 static int _op_handler_nodes(const char *context_id,
 			     http_request_method_t method, data_t *parameters,
 			     data_t *query, int tag, data_t *resp)
@@ -157,10 +237,13 @@ static int _op_handler_nodes(const char *context_id,
 	data_t *errors = data_set_list(data_key_set(d, "errors"));
 	data_t *nodes = data_set_dict(data_key_set(d, "nodes"));
 	node_info_msg_t *node_info_ptr = NULL;
+	bool cached = false;
 
-	if (tag == URL_TAG_NODES)
-		rc = slurm_load_node(0, &node_info_ptr, SHOW_ALL);
-	else if (tag == URL_TAG_NODE) {
+	if (tag == URL_TAG_NODES) {
+		slurm_mutex_lock(&node_cache_lock);
+		rc = _load_nodes_cached(&node_info_ptr);
+		cached = true;
+	} else if (tag == URL_TAG_NODE) {
 		const data_t *node_name = data_key_get_const(parameters,
 							     "node_name");
 		char *name = NULL;
@@ -190,7 +273,10 @@ static int _op_handler_nodes(const char *context_id,
 		data_set_int(data_key_set(e, "errno"), rc);
 	}
 
-	slurm_free_node_info_msg(node_info_ptr);
+	if (cached)
+		slurm_mutex_unlock(&node_cache_lock);
+	else
+		slurm_free_node_info_msg(node_info_ptr);
 	return rc;
 }
 
@@ -198,6 +284,8 @@ extern int init_op_nodes(void)
 {
 	int rc;
 
+	node_cache = list_create(_node_cache_free);
+
 	if ((rc = bind_operation_handler("/slurm/v0.0.35/nodes/",
 					     _op_handler_nodes, URL_TAG_NODES)))
 		/* no-op */;
@@ -211,4 +299,8 @@ extern int init_op_nodes(void)
 extern void destroy_op_nodes(void)
 {
 	unbind_operation_handler(_op_handler_nodes);
+
+	slurm_mutex_lock(&node_cache_lock);
+	FREE_NULL_LIST(node_cache);
+	slurm_mutex_unlock(&node_cache_lock);
 }
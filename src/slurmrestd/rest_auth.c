@@ -59,6 +59,8 @@
 
 /* only set by init_rest_auth() */
 static rest_auth_type_t auth_type = AUTH_TYPE_INVALID;
+/* auth context applied to this thread */
+static __thread rest_auth_context_t *thread_context = NULL;
 
 #define MAGIC 0xDEDEDEDE
 #define HTTP_HEADER_USER_TOKEN "X-SLURM-USER-TOKEN"
@@ -327,13 +329,24 @@ extern void rest_auth_context_apply(rest_auth_context_t *context)
 
 	if (!found)
 		fatal_abort("%s: invalid auth type to apply", __func__);
+
+	thread_context = context;
 }
 
 extern void rest_auth_context_clear(void)
 {
+	thread_context = NULL;
 	g_slurm_auth_thread_clear();
 }
 
+extern const char *rest_auth_context_get_user_name(void)
+{
+	if (!thread_context)
+		return NULL;
+
+	return thread_context->user_name;
+}
+
 extern void rest_auth_context_free(rest_auth_context_t *context)
 {
 	if (!context)
@@ -106,6 +106,12 @@ extern void rest_auth_context_apply(rest_auth_context_t *context);
  */
 extern void rest_auth_context_clear(void);
 
+/*
+ * Get user name of the auth context applied to the current thread
+ * RET user name or NULL if no context is applied (do not xfree())
+ */
+extern const char *rest_auth_context_get_user_name(void);
+
 /*
  * Setup locks and register openapi.
  * 	Only call once!
@@ -36,13 +36,16 @@
 
 #include "config.h"
 
-#if HAVE_JSON
+#include <math.h>
+#include <stdio.h>
 
+#if HAVE_JSON
 #if HAVE_JSON_C_INC
 #include <json-c/json.h>
 #else
 #include <json/json.h>
 #endif
+#endif /* HAVE_JSON */
 
 #include "slurm/slurm.h"
 
@@ -52,7 +55,21 @@
 
 #include "src/slurmrestd/xjson.h"
 
-static json_object *_data_to_json(const data_t *d);
+typedef struct {
+	char *buffer;		/* output string */
+	char *pos;		/* end of output string for appending */
+	bool pretty;		/* indent one member per line */
+	int depth;		/* current nesting depth */
+} dump_state_t;
+
+typedef struct {
+	dump_state_t *state;
+	int count;		/* members already written at this level */
+} dump_level_t;
+
+static void _dump_data(const data_t *d, dump_state_t *state);
+
+#if HAVE_JSON
 
 static json_object *_try_parse(const char *buffer, size_t stringlen,
 			       struct json_tokener *tok)
@@ -140,67 +157,173 @@ extern data_t *parse_json(const char *buffer)
 	return data;
 }
 
-static data_for_each_cmd_t _convert_dict_json(const char *key,
-					      const data_t *data,
-					      void *arg)
+#else /* HAVE_JSON */
+
+extern data_t *parse_json(const char *buf)
+{
+	error("%s: JSON support not compiled", __func__);
+	return NULL;
+}
+
+#endif /* HAVE_JSON */
+
+/*
+ * JSON output is written straight from the data_t tree into one growing
+ * string rather than first building a json-c object tree and then copying
+ * its string, so large responses are only held once more in memory.
+ */
+
+static void _dump_newline(dump_state_t *state)
+{
+	if (state->pretty)
+		xstrfmtcatat(state->buffer, &state->pos, "\n%*s",
+			     (state->depth * 2), "");
+}
+
+static void _dump_string(const char *str, dump_state_t *state)
+{
+	const char *start = str;
+
+	xstrfmtcatat(state->buffer, &state->pos, "\"");
+	for (; str && *str; str++) {
+		const char *esc = NULL;
+		char hex[7];
+
+		switch (*str) {
+		case '"':
+			esc = "\\\"";
+			break;
+		case '\\':
+			esc = "\\\\";
+			break;
+		case '\b':
+			esc = "\\b";
+			break;
+		case '\f':
+			esc = "\\f";
+			break;
+		case '\n':
+			esc = "\\n";
+			break;
+		case '\r':
+			esc = "\\r";
+			break;
+		case '\t':
+			esc = "\\t";
+			break;
+		default:
+			if ((unsigned char) *str < 0x20) {
+				snprintf(hex, sizeof(hex), "\\u%04x",
+					 (unsigned char) *str);
+				esc = hex;
+			}
+		}
+
+		if (esc) {
+			xstrfmtcatat(state->buffer, &state->pos, "%.*s%s",
+				     (int) (str - start), start, esc);
+			start = str + 1;
+		}
+	}
+	xstrfmtcatat(state->buffer, &state->pos, "%s\"", (start ? start : ""));
+}
+
+static void _dump_float(double value, dump_state_t *state)
+{
+	char tmp[64];
+
+	if (isnan(value)) {
+		snprintf(tmp, sizeof(tmp), "NaN");
+	} else if (isinf(value)) {
+		snprintf(tmp, sizeof(tmp), "%sInfinity",
+			 ((value < 0) ? "-" : ""));
+	} else {
+		snprintf(tmp, sizeof(tmp), "%.17g", value);
+		/* keep the value a float when read back */
+		if (!strpbrk(tmp, ".eE"))
+			strncat(tmp, ".0", (sizeof(tmp) - strlen(tmp) - 1));
+	}
+
+	xstrfmtcatat(state->buffer, &state->pos, "%s", tmp);
+}
+
+static void _dump_separator(dump_level_t *level)
+{
+	if (level->count++)
+		xstrfmtcatat(level->state->buffer, &level->state->pos, ",");
+	_dump_newline(level->state);
+}
+
+static data_for_each_cmd_t _dump_dict_json(const char *key,
+					   const data_t *data,
+					   void *arg)
 {
-	json_object *jobj = arg;
-	json_object *jobject = _data_to_json(data);
+	dump_level_t *level = arg;
+
+	_dump_separator(level);
+	_dump_string(key, level->state);
+	xstrfmtcatat(level->state->buffer, &level->state->pos,
+		     (level->state->pretty ? ": " : ":"));
+	_dump_data(data, level->state);
 
-	json_object_object_add(jobj, key, jobject);
 	return DATA_FOR_EACH_CONT;
 }
 
-static data_for_each_cmd_t _convert_list_json(const data_t *data, void *arg)
+static data_for_each_cmd_t _dump_list_json(const data_t *data, void *arg)
 {
-	json_object *jobj = arg;
-	json_object *jarray = _data_to_json(data);
+	dump_level_t *level = arg;
+
+	_dump_separator(level);
+	_dump_data(data, level->state);
 
-	json_object_array_add(jobj, jarray);
 	return DATA_FOR_EACH_CONT;
 }
 
-static json_object *_data_to_json(const data_t *d)
+static void _dump_data(const data_t *d, dump_state_t *state)
 {
-	if (!d)
-		return NULL;
+	dump_level_t level = { .state = state };
+
+	if (!d) {
+		xstrfmtcatat(state->buffer, &state->pos, "null");
+		return;
+	}
 
 	switch (data_get_type(d)) {
 	case DATA_TYPE_NULL:
-		return NULL;
+		xstrfmtcatat(state->buffer, &state->pos, "null");
 		break;
 	case DATA_TYPE_BOOL:
-		return json_object_new_boolean(data_get_bool(d));
+		xstrfmtcatat(state->buffer, &state->pos, "%s",
+			     (data_get_bool(d) ? "true" : "false"));
 		break;
 	case DATA_TYPE_FLOAT:
-		return json_object_new_double(data_get_float(d));
+		_dump_float(data_get_float(d), state);
 		break;
 	case DATA_TYPE_INT_64:
-		return json_object_new_int64(data_get_int(d));
+		xstrfmtcatat(state->buffer, &state->pos, "%"PRId64,
+			     data_get_int(d));
 		break;
 	case DATA_TYPE_DICT:
-	{
-		json_object *jobj = json_object_new_object();
-		int rc = data_dict_for_each_const(d, _convert_dict_json, jobj);
-		xassert(rc >= 0);
-		return jobj;
-	}
+		xstrfmtcatat(state->buffer, &state->pos, "{");
+		state->depth++;
+		(void) data_dict_for_each_const(d, _dump_dict_json, &level);
+		state->depth--;
+		if (level.count)
+			_dump_newline(state);
+		xstrfmtcatat(state->buffer, &state->pos, "}");
+		break;
 	case DATA_TYPE_LIST:
-	{
-		json_object *jobj = json_object_new_array();
-		int rc = data_list_for_each_const(d, _convert_list_json, jobj);
-		xassert(rc >= 0);
-		return jobj;
-	}
+		xstrfmtcatat(state->buffer, &state->pos, "[");
+		state->depth++;
+		(void) data_list_for_each_const(d, _dump_list_json, &level);
+		state->depth--;
+		if (level.count)
+			_dump_newline(state);
+		xstrfmtcatat(state->buffer, &state->pos, "]");
+		break;
 	case DATA_TYPE_STRING:
-	{
-		const char *str = data_get_string(d);
-		if (str)
-			return json_object_new_string(str);
-		else
-			return json_object_new_string("");
+		_dump_string(data_get_string(d), state);
 		break;
-	}
 	default:
 		fatal_abort("%s: unknown type", __func__);
 	};
@@ -208,44 +331,14 @@ static json_object *_data_to_json(const data_t *d)
 
 extern char *dump_json(const data_t *data, dump_json_flags_t flags)
 {
-	struct json_object *jobj = _data_to_json(data);
-	char *buffer = NULL;
-	int jflags = 0;
+	dump_state_t state = { 0 };
 
 	/* can't be pretty and compact at the same time! */
 	xassert((flags & (DUMP_JSON_FLAGS_PRETTY | DUMP_JSON_FLAGS_COMPACT)) !=
 		(DUMP_JSON_FLAGS_PRETTY | DUMP_JSON_FLAGS_COMPACT));
 
-	switch (flags) {
-	case DUMP_JSON_FLAGS_PRETTY:
-		jflags = JSON_C_TO_STRING_SPACED | JSON_C_TO_STRING_PRETTY;
-		break;
-	case DUMP_JSON_FLAGS_COMPACT: /* fallthrough */
-	default:
-		jflags = JSON_C_TO_STRING_PLAIN;
-	}
-
-	/* string will die with jobj */
-	buffer = xstrdup(json_object_to_json_string_ext(jobj, jflags));
-
-	/* put is equiv to free() */
-	json_object_put(jobj);
+	state.pretty = (flags == DUMP_JSON_FLAGS_PRETTY);
+	_dump_data(data, &state);
 
-	return buffer;
+	return state.buffer;
 }
-
-#else /* HAVE_JSON */
-
-extern data_t *parse_json(const char *buf)
-{
-	error("%s: JSON support not compiled", __func__);
-	return NULL;
-}
-
-extern char *dump_json(const data_t *data, dump_json_flags_t flags)
-{
-	error("%s: JSON support not compiled", __func__);
-	return NULL;
-}
-
-#endif /* HAVE_JSON */
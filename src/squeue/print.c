@@ -332,14 +332,23 @@ static int _print_str(char *str, int width, bool right, bool cut_output)
 
 int _print_nodes(char *nodes, int width, bool right, bool cut)
 {
-	hostlist_t hl = hostlist_create(nodes);
-	char *buf = NULL;
-	int retval;
-	buf = hostlist_ranged_string_xmalloc(hl);
-	retval = _print_str(buf, width, right, false);
-	xfree(buf);
-	hostlist_destroy(hl);
-	return retval;
+	/*
+	 * Consecutive jobs often share the same node list (e.g. pending jobs
+	 * or array tasks), so keep the last ranged string to avoid building a
+	 * hostlist for each of them.
+	 */
+	static char *last_nodes = NULL, *last_ranged = NULL;
+
+	if (!last_ranged || xstrcmp(nodes, last_nodes)) {
+		hostlist_t hl = hostlist_create(nodes);
+		xfree(last_ranged);
+		xfree(last_nodes);
+		last_ranged = hostlist_ranged_string_xmalloc(hl);
+		last_nodes = xstrdup(nodes);
+		hostlist_destroy(hl);
+	}
+
+	return _print_str(last_ranged, width, right, false);
 }
 
 
@@ -167,6 +167,31 @@ _get_window_width( void )
 }
 
 
+/*
+ * _load_job_list - load only the jobs named with --jobs, rather than every
+ *	job in the system, when more than one job ID was given
+ */
+static int _load_job_list(job_info_msg_t **job_info_msg_pptr,
+			  uint16_t show_flags)
+{
+	ListIterator iterator;
+	squeue_job_step_t *job_step_id;
+	uint32_t *job_ids;
+	int job_id_cnt = 0, rc;
+
+	job_ids = xcalloc(list_count(params.job_list), sizeof(uint32_t));
+	iterator = list_iterator_create(params.job_list);
+	while ((job_step_id = list_next(iterator)))
+		job_ids[job_id_cnt++] = job_step_id->job_id;
+	list_iterator_destroy(iterator);
+
+	rc = slurm_load_job_list(job_info_msg_pptr, job_ids, job_id_cnt,
+				 show_flags);
+	xfree(job_ids);
+
+	return rc;
+}
+
 /* _print_job - print the specified job's information */
 static int _print_job(bool clear_old, bool log_cluster_name)
 {
@@ -195,6 +220,8 @@ static int _print_job(bool clear_old, bool log_cluster_name)
 			error_code = slurm_load_job(
 				&new_job_ptr, params.job_id,
 				show_flags);
+		} else if (params.job_list && list_count(params.job_list)) {
+			error_code = _load_job_list(&new_job_ptr, show_flags);
 		} else if (params.user_id) {
 			error_code = slurm_load_job_user(&new_job_ptr,
 							 params.user_id,
@@ -215,6 +242,8 @@ static int _print_job(bool clear_old, bool log_cluster_name)
 	} else if (params.job_id) {
 		error_code = slurm_load_job(&new_job_ptr, params.job_id,
 					    show_flags);
+	} else if (params.job_list && list_count(params.job_list)) {
+		error_code = _load_job_list(&new_job_ptr, show_flags);
 	} else if (params.user_id) {
 		error_code = slurm_load_job_user(&new_job_ptr, params.user_id,
 						 show_flags);
@@ -228,7 +257,8 @@ static int _print_job(bool clear_old, bool log_cluster_name)
 		return SLURM_ERROR;
 	}
 	old_job_ptr = new_job_ptr;
-	if (params.job_id || params.user_id)
+	if (params.job_id || params.user_id ||
+	    (params.job_list && list_count(params.job_list)))
 		old_job_ptr->last_update = (time_t) 0;
 
 	if (params.verbose) {
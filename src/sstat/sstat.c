@@ -45,6 +45,18 @@ int _do_stat(uint32_t jobid, uint32_t stepid, char *nodelist,
 	     uint32_t req_cpufreq_gov,
 	     uint16_t use_protocol_ver);
 
+/* Maximum number of steps queried concurrently with --allsteps */
+#define MAX_STAT_THREADS 16
+
+typedef struct {
+	uint32_t jobid;
+	uint32_t stepid;
+	char *nodelist;
+	uint16_t use_protocol_ver;
+	int rc;
+	job_step_stat_response_msg_t *resp;
+} stat_req_t;
+
 /*
  * Globals
  */
@@ -111,12 +123,23 @@ List print_fields_list = NULL;
 ListIterator print_fields_itr = NULL;
 int field_count = 0;
 
-int _do_stat(uint32_t jobid, uint32_t stepid, char *nodelist,
-	     uint32_t req_cpufreq_min, uint32_t req_cpufreq_max,
-	     uint32_t req_cpufreq_gov, uint16_t use_protocol_ver)
+static void *_stat_fetch(void *arg)
+{
+	stat_req_t *req = arg;
+
+	debug("requesting info for job %u.%u", req->jobid, req->stepid);
+	req->rc = slurm_job_step_stat(req->jobid, req->stepid, req->nodelist,
+				      req->use_protocol_ver, &req->resp);
+
+	return NULL;
+}
+
+/* Aggregate and print the stats of one step as returned by _stat_fetch() */
+static int _print_stat(uint32_t jobid, uint32_t stepid,
+		       uint32_t req_cpufreq_min, uint32_t req_cpufreq_max,
+		       uint32_t req_cpufreq_gov, int rc,
+		       job_step_stat_response_msg_t *step_stat_response)
 {
-	job_step_stat_response_msg_t *step_stat_response = NULL;
-	int rc = SLURM_SUCCESS;
 	ListIterator itr;
 	jobacctinfo_t *total_jobacct = NULL;
 	job_step_stat_t *step_stat = NULL;
@@ -125,9 +148,7 @@ int _do_stat(uint32_t jobid, uint32_t stepid, char *nodelist,
 	hostlist_t hl = NULL;
 	char *ave_usage_tmp = NULL;
 
-	debug("requesting info for job %u.%u", jobid, stepid);
-	if ((rc = slurm_job_step_stat(jobid, stepid, nodelist, use_protocol_ver,
-				      &step_stat_response)) != SLURM_SUCCESS) {
+	if (rc != SLURM_SUCCESS) {
 		if (rc == ESLURM_INVALID_JOB_ID) {
 			debug("job step %u.%u has already completed",
 			      jobid, stepid);
@@ -253,6 +274,59 @@ getout:
 	return rc;
 }
 
+int _do_stat(uint32_t jobid, uint32_t stepid, char *nodelist,
+	     uint32_t req_cpufreq_min, uint32_t req_cpufreq_max,
+	     uint32_t req_cpufreq_gov, uint16_t use_protocol_ver)
+{
+	stat_req_t req = {
+		.jobid = jobid,
+		.stepid = stepid,
+		.nodelist = nodelist,
+		.use_protocol_ver = use_protocol_ver,
+	};
+
+	(void) _stat_fetch(&req);
+
+	return _print_stat(jobid, stepid, req_cpufreq_min, req_cpufreq_max,
+			   req_cpufreq_gov, req.rc, req.resp);
+}
+
+/*
+ * Query all steps of a job. The per step fan-outs to the step's nodes are
+ * independent, so up to MAX_STAT_THREADS of them are run concurrently and
+ * the results are then printed in step order.
+ */
+static void _do_stat_all(uint32_t jobid,
+			 job_step_info_response_msg_t *step_ptr)
+{
+	stat_req_t req[MAX_STAT_THREADS];
+	pthread_t tid[MAX_STAT_THREADS];
+	job_step_info_t *step_info;
+	int i, j, cnt;
+
+	for (i = 0; i < step_ptr->job_step_count; i += cnt) {
+		cnt = MIN(MAX_STAT_THREADS, step_ptr->job_step_count - i);
+		for (j = 0; j < cnt; j++) {
+			step_info = &step_ptr->job_steps[i + j];
+			memset(&req[j], 0, sizeof(stat_req_t));
+			req[j].jobid = jobid;
+			req[j].stepid = step_info->step_id;
+			req[j].nodelist = step_info->nodes;
+			req[j].use_protocol_ver = step_info->start_protocol_ver;
+			slurm_thread_create(&tid[j], _stat_fetch, &req[j]);
+		}
+		for (j = 0; j < cnt; j++) {
+			step_info = &step_ptr->job_steps[i + j];
+			pthread_join(tid[j], NULL);
+			_print_stat(jobid, step_info->step_id,
+				    step_info->cpu_freq_min,
+				    step_info->cpu_freq_max,
+				    step_info->cpu_freq_gov,
+				    req[j].rc, req[j].resp);
+		}
+	}
+}
+
 int main(int argc, char **argv)
 {
 	ListIterator itr = NULL;
@@ -317,7 +391,7 @@ int main(int argc, char **argv)
 			stepid = selected_step->stepid;
 		} else if (params.opt_all_steps) {
 			job_step_info_response_msg_t *step_ptr = NULL;
-			int i = 0;
+
 			if (slurm_get_job_steps(
 				    0, selected_step->jobid, NO_VAL,
 				    &step_ptr, SHOW_ALL)) {
@@ -326,16 +400,7 @@ int main(int argc, char **argv)
 				continue;
 			}
 
-			for (i = 0; i < step_ptr->job_step_count; i++) {
-				_do_stat(selected_step->jobid,
-					 step_ptr->job_steps[i].step_id,
-					 step_ptr->job_steps[i].nodes,
-					 step_ptr->job_steps[i].cpu_freq_min,
-					 step_ptr->job_steps[i].cpu_freq_max,
-					 step_ptr->job_steps[i].cpu_freq_gov,
-					 step_ptr->job_steps[i].
-					 start_protocol_ver);
-			}
+			_do_stat_all(selected_step->jobid, step_ptr);
 			slurm_free_job_step_info_response_msg(step_ptr);
 			continue;
 		} else {
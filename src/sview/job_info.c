@@ -38,6 +38,7 @@
 #include "src/sview/sview.h"
 #include "src/common/parse_time.h"
 #include "src/common/proc_args.h"
+#include "src/common/xhash.h"
 #include "src/common/xstring.h"
 
 #define _DEBUG 0
@@ -3010,26 +3011,77 @@ static int _sview_job_sort_aval_dec(void *s1, void *s2)
 	return 0;
 }
 
-static int _task_array_match(void *x, void *key)
+/* Running steps of one job, indexed by job ID */
+typedef struct {
+	uint32_t job_id;
+	List step_list;
+} sview_job_steps_t;
+
+static void _job_info_id(void *item, const char **key, uint32_t *key_len)
 {
-	sview_job_info_t *sview_job_info_ptr = (sview_job_info_t *) x;
-	job_info_t *job_ptr = (job_info_t *) key;
+	sview_job_info_t *sview_job_info_ptr = (sview_job_info_t *) item;
 
-	if (sview_job_info_ptr->job_ptr->array_job_id  == job_ptr->array_job_id)
-		return 1;
+	*key = (const char *) &sview_job_info_ptr->job_id;
+	*key_len = sizeof(uint32_t);
+}
 
-	return 0;
+static void _array_job_id(void *item, const char **key, uint32_t *key_len)
+{
+	sview_job_info_t *sview_job_info_ptr = (sview_job_info_t *) item;
+
+	*key = (const char *) &sview_job_info_ptr->job_ptr->array_job_id;
+	*key_len = sizeof(uint32_t);
 }
 
-static int _het_job_id_match(void *x, void *key)
+static void _het_job_id(void *item, const char **key, uint32_t *key_len)
 {
-	sview_job_info_t *sview_job_info_ptr = (sview_job_info_t *) x;
-	job_info_t *job_ptr = (job_info_t *) key;
+	sview_job_info_t *sview_job_info_ptr = (sview_job_info_t *) item;
 
-	if (sview_job_info_ptr->job_ptr->het_job_id  == job_ptr->het_job_id)
-		return 1;
+	*key = (const char *) &sview_job_info_ptr->job_ptr->het_job_id;
+	*key_len = sizeof(uint32_t);
+}
 
-	return 0;
+static void _job_steps_id(void *item, const char **key, uint32_t *key_len)
+{
+	sview_job_steps_t *job_steps = (sview_job_steps_t *) item;
+
+	*key = (const char *) &job_steps->job_id;
+	*key_len = sizeof(uint32_t);
+}
+
+static void _job_steps_free(void *item)
+{
+	sview_job_steps_t *job_steps = (sview_job_steps_t *) item;
+
+	if (job_steps) {
+		FREE_NULL_LIST(job_steps->step_list);
+		xfree(job_steps);
+	}
+}
+
+/* Index the running steps by job ID */
+static xhash_t *_index_job_steps(job_step_info_response_msg_t *step_info_ptr)
+{
+	xhash_t *steps = xhash_init(_job_steps_id, _job_steps_free);
+	sview_job_steps_t *job_steps;
+	job_step_info_t *step_ptr;
+	int j;
+
+	for (j = 0; j < step_info_ptr->job_step_count; j++) {
+		step_ptr = &(step_info_ptr->job_steps[j]);
+		if (step_ptr->state != JOB_RUNNING)
+			continue;
+		if (!(job_steps = xhash_get(steps, (char *) &step_ptr->job_id,
+					    sizeof(uint32_t)))) {
+			job_steps = xmalloc(sizeof(sview_job_steps_t));
+			job_steps->job_id = step_ptr->job_id;
+			job_steps->step_list = list_create(NULL);
+			xhash_add(steps, job_steps);
+		}
+		list_append(job_steps->step_list, step_ptr);
+	}
+
+	return steps;
 }
 
 static List _create_job_info_list(job_info_msg_t *job_info_ptr,
@@ -3039,13 +3091,17 @@ static List _create_job_info_list(job_info_msg_t *job_info_ptr,
 	static List info_list = NULL;
 	static List odd_info_list = NULL;
 	List last_list = NULL;
-	ListIterator last_list_itr = NULL;
 	static job_info_msg_t *last_job_info_ptr = NULL;
 	static job_step_info_response_msg_t *last_step_info_ptr = NULL;
-	int i = 0, j = 0;
+	int i = 0;
 	sview_job_info_t *sview_job_info_ptr = NULL;
 	job_info_t *job_ptr = NULL;
-	job_step_info_t *step_ptr = NULL;
+	sview_job_steps_t *job_steps;
+	/*
+	 * Lookups by job ID, array job ID and hetjob ID, which would
+	 * otherwise be list scans for every job
+	 */
+	xhash_t *last_jobs, *array_leaders, *het_leaders, *steps;
 
 	if (info_list && (job_info_ptr == last_job_info_ptr)
 	    && (step_info_ptr == last_step_info_ptr))
@@ -3062,8 +3118,17 @@ static List _create_job_info_list(job_info_msg_t *job_info_ptr,
 		info_list = list_create(NULL);
 		odd_info_list = list_create(_job_info_list_del);
 	}
-	if (last_list)
-		last_list_itr = list_iterator_create(last_list);
+	/* Records of the previous pass not reused are freed with the hash */
+	last_jobs = xhash_init(_job_info_id, _job_info_list_del);
+	if (last_list) {
+		while ((sview_job_info_ptr = list_pop(last_list)))
+			xhash_add(last_jobs, sview_job_info_ptr);
+		FREE_NULL_LIST(last_list);
+	}
+	array_leaders = xhash_init(_array_job_id, NULL);
+	het_leaders = xhash_init(_het_job_id, NULL);
+	steps = _index_job_steps(step_info_ptr);
+
 	for (i=0; i<job_info_ptr->record_count; i++) {
 		bool added_task = false;
 
@@ -3071,22 +3136,12 @@ static List _create_job_info_list(job_info_msg_t *job_info_ptr,
 		if (job_ptr->job_id == 0)
 			continue;
 
-		sview_job_info_ptr = NULL;
-
-		if (last_list_itr) {
-			while ((sview_job_info_ptr =
-				list_next(last_list_itr))) {
-				if (sview_job_info_ptr->job_id ==
-				    job_ptr->job_id) {
-					list_remove(last_list_itr);
-					_job_info_free(sview_job_info_ptr);
-					break;
-				}
-			}
-			list_iterator_reset(last_list_itr);
-		}
-
-		if (!sview_job_info_ptr)
+		/* Reuse the record so its tree row is updated in place */
+		if ((sview_job_info_ptr = xhash_pop(last_jobs,
+						    (char *) &job_ptr->job_id,
+						    sizeof(uint32_t))))
+			_job_info_free(sview_job_info_ptr);
+		else
 			sview_job_info_ptr = xmalloc(sizeof(sview_job_info_t));
 
 		sview_job_info_ptr->job_ptr = job_ptr;
@@ -3096,8 +3151,9 @@ static List _create_job_info_list(job_info_msg_t *job_info_ptr,
 		    (job_ptr->array_task_id != NO_VAL)) {
 			char task_str[64];
 			sview_job_info_t *first_job_info_ptr =
-				list_find_first(info_list,
-						_task_array_match, job_ptr);
+				xhash_get(array_leaders,
+					  (char *) &job_ptr->array_job_id,
+					  sizeof(uint32_t));
 			if (job_ptr->array_task_str) {
 				snprintf(task_str, sizeof(task_str), "[%s]",
 					 job_ptr->array_task_str);
@@ -3152,8 +3208,9 @@ static List _create_job_info_list(job_info_msg_t *job_info_ptr,
 			snprintf(comp_str, sizeof(comp_str), "%u",
 				 job_ptr->het_job_offset);
 			sview_job_info_t *first_job_info_ptr =
-				list_find_first(info_list,
-						_het_job_id_match, job_ptr);
+				xhash_get(het_leaders,
+					  (char *) &job_ptr->het_job_id,
+					  sizeof(uint32_t));
 			if (!first_job_info_ptr) {
 				sview_job_info_ptr->task_list =
 					list_create(NULL);
@@ -3185,14 +3242,10 @@ static List _create_job_info_list(job_info_msg_t *job_info_ptr,
 		sview_job_info_ptr->nodes = xstrdup(job_ptr->nodes);
 		sview_job_info_ptr->node_cnt = job_ptr->num_nodes;
 
-		for (j = 0; j < step_info_ptr->job_step_count; j++) {
-			step_ptr = &(step_info_ptr->job_steps[j]);
-			if ((step_ptr->job_id == job_ptr->job_id) &&
-			    (step_ptr->state == JOB_RUNNING)) {
-				list_append(sview_job_info_ptr->step_list,
-					    step_ptr);
-			}
-		}
+		if ((job_steps = xhash_get(steps, (char *) &job_ptr->job_id,
+					   sizeof(uint32_t))))
+			list_transfer(sview_job_info_ptr->step_list,
+				      job_steps->step_list);
 		if (!added_task)
 			list_append(odd_info_list, sview_job_info_ptr);
 
@@ -3203,18 +3256,30 @@ static List _create_job_info_list(job_info_msg_t *job_info_ptr,
 			continue;
 		}
 
-		if (!added_task)
+		if (!added_task) {
 			list_append(info_list, sview_job_info_ptr);
+			/* First of its array or hetjob in info_list leads */
+			if (job_ptr->array_job_id &&
+			    !xhash_get(array_leaders,
+				       (char *) &job_ptr->array_job_id,
+				       sizeof(uint32_t)))
+				xhash_add(array_leaders, sview_job_info_ptr);
+			if (job_ptr->het_job_id &&
+			    !xhash_get(het_leaders,
+				       (char *) &job_ptr->het_job_id,
+				       sizeof(uint32_t)))
+				xhash_add(het_leaders, sview_job_info_ptr);
+		}
 	}
 
 	list_sort(info_list, (ListCmpF)_sview_job_sort_aval_dec);
 
 	list_sort(odd_info_list, (ListCmpF)_sview_job_sort_aval_dec);
 
-	if (last_list) {
-		list_iterator_destroy(last_list_itr);
-		FREE_NULL_LIST(last_list);
-	}
+	xhash_free(last_jobs);
+	xhash_free(array_leaders);
+	xhash_free(het_leaders);
+	xhash_free(steps);
 
 update_color:
 
@@ -0,0 +1,125 @@
+/*****************************************************************************\
+ *  test7.24.prog.c - Test that a job updated and then purged between two
+ *  slurm_load_jobs_delta() calls is reported as removed.
+ *
+ *  Usage: test7.24.prog <job_id> <max_wait_secs>
+ *****************************************************************************
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <slurm/slurm.h>
+#include <slurm/slurm_errno.h>
+
+static job_info_msg_t *mirror = NULL;
+static time_t epoch = 0;
+static uint64_t seq = 0;
+
+static void _poll(void)
+{
+	job_info_delta_msg_t *delta = NULL;
+
+	if (slurm_load_jobs_delta(epoch, seq, SHOW_ALL, &delta)) {
+		slurm_perror("slurm_load_jobs_delta");
+		printf("FAILURE: slurm_load_jobs_delta\n");
+		exit(1);
+	}
+	epoch = delta->epoch;
+	seq = delta->seq;
+	if (slurm_job_info_apply_delta(&mirror, delta)) {
+		slurm_perror("slurm_job_info_apply_delta");
+		printf("FAILURE: slurm_job_info_apply_delta\n");
+		exit(1);
+	}
+	slurm_free_job_info_delta_msg(delta);
+}
+
+static bool _in_mirror(uint32_t job_id)
+{
+	uint32_t i;
+
+	for (i = 0; i < mirror->record_count; i++) {
+		if (mirror->job_array[i].job_id == job_id)
+			return true;
+	}
+	return false;
+}
+
+int main(int argc, char **argv)
+{
+	job_desc_msg_t job_desc;
+	job_info_msg_t *job_msg = NULL;
+	uint32_t job_id;
+	int max_wait, waited = 0;
+
+	if (argc != 3) {
+		printf("Usage: %s <job_id> <max_wait_secs>\n", argv[0]);
+		exit(1);
+	}
+	job_id = atoi(argv[1]);
+	max_wait = atoi(argv[2]);
+
+	_poll();
+	if (!_in_mirror(job_id)) {
+		printf("FAILURE: JobId=%u missing from first delta\n", job_id);
+		exit(1);
+	}
+
+	/* Update and purge the job with no delta request in between */
+	slurm_init_job_desc_msg(&job_desc);
+	job_desc.job_id = job_id;
+	job_desc.time_limit = 2;
+	if (slurm_update_job(&job_desc)) {
+		slurm_perror("slurm_update_job");
+		printf("FAILURE: slurm_update_job\n");
+		exit(1);
+	}
+	if (slurm_kill_job(job_id, SIGKILL, 0)) {
+		slurm_perror("slurm_kill_job");
+		printf("FAILURE: slurm_kill_job\n");
+		exit(1);
+	}
+	while (slurm_load_job(&job_msg, job_id, SHOW_ALL) == SLURM_SUCCESS) {
+		slurm_free_job_info_msg(job_msg);
+		job_msg = NULL;
+		if (waited >= max_wait) {
+			printf("FAILURE: JobId=%u not purged after %d secs\n",
+			       job_id, waited);
+			exit(1);
+		}
+		sleep(5);
+		waited += 5;
+	}
+
+	_poll();
+	if (_in_mirror(job_id)) {
+		printf("FAILURE: purged JobId=%u still in delta mirror\n",
+		       job_id);
+		exit(1);
+	}
+	slurm_free_job_info_msg(mirror);
+
+	printf("SUCCESS\n");
+	exit(0);
+}
@@ -190,6 +190,44 @@ main(int argc, char *argv[])
 		bit_free(bs);
 	}
 
+	note("Testing whole word and partial word operations");
+	{
+		bitstr_t *bs = bit_alloc(200), *bs2 = bit_alloc(200);
+
+		bit_nset(bs, 0, 63);
+		bit_set(bs, 130);
+		TEST(bit_nffc(bs, 64) == 64, "bitstring");
+		TEST(bit_nffc(bs, 66) == 64, "bitstring");
+		TEST(bit_nffc(bs, 67) == 131, "bitstring");
+		TEST(bit_nffc(bs, 70) == -1, "bitstring");
+		TEST(bit_set_count_range(bs, 60, 131) == 5, "bitstring");
+		TEST(bit_set_count_range(bs, 130, 130) == 0, "bitstring");
+
+		bit_not(bs);	/* also sets the unused bits of the last word */
+		TEST(bit_set_count(bs) == 135, "bitstring");
+		TEST(bit_set_count_range(bs, 190, 500) == 10, "bitstring");
+		bit_set(bs2, 199);
+		TEST(bit_overlap(bs, bs2) == 1, "bitstring");
+		bit_clear(bs, 199);
+		TEST(bit_overlap_any(bs, bs2) == 0, "bitstring");
+		TEST(bit_super_set(bs2, bs) == 0, "bitstring");
+
+		bit_clear_all(bs);
+		bit_set(bs, 3);
+		bit_set(bs, 150);
+		TEST(bit_ffs_from_bit(bs, 0) == 3, "bitstring");
+		TEST(bit_ffs_from_bit(bs, 3) == 3, "bitstring");
+		TEST(bit_ffs_from_bit(bs, 4) == 150, "bitstring");
+		TEST(bit_ffs_from_bit(bs, 151) == -1, "bitstring");
+		bit_not(bs);
+		bit_clear(bs, 199);
+		bit_nclear(bs, 0, 190);
+		TEST(bit_ffs_from_bit(bs, 195) == 195, "bitstring");
+
+		bit_free(bs);
+		bit_free(bs2);
+	}
+
 	note("Testing bit_unfmt");
 	{
 		bitstr_t *bs = bit_alloc(1024);